@@ -366,19 +366,16 @@ int main(int argc, const char **argv)
     sId.buildFrom(Id);
 
     // Matrice d'interaction, Hessien, erreur,...
-    vpMatrix Lsd;      // matrice d'interaction a la position desiree
     vpMatrix Hsd;      // hessien a la position desiree
     vpMatrix H;        // Hessien utilise pour le levenberg-Marquartd
+    vpColVector Lsde;  // Lsd^T (I-I*)
     vpColVector error; // Erreur I-I*
 
-    // Compute the interaction matrix
-    // link the variation of image intensity to camera motion
-
-    // here it is computed at the desired position
-    sId.interaction(Lsd);
-
-    // Compute the Hessian H = L^TL
-    Hsd = Lsd.AtA();
+    // Compute the Hessian H = L^TL, the interaction matrix that links the
+    // variation of image intensity to camera motion being computed at the
+    // desired position. The normal equations are accumulated directly from
+    // the images, without forming the interaction matrix.
+    sI.computeNormalEquations(sId, Hsd, Lsde, true);
 
     // Compute the Hessian diagonal for the Levenberg-Marquartd
     // optimization process
@@ -434,8 +431,9 @@ int main(int argc, const char **argv)
       // Compute current visual feature
       sI.buildFrom(I);
 
-      // compute current error
+      // compute current error and Lsd^T error
       sI.error(sId, error);
+      sI.computeNormalEquations(sId, Hsd, Lsde, true);
 
       normeError = (error.sumSquare());
       std::cout << "|e| " << normeError << std::endl;
@@ -454,7 +452,7 @@ int main(int argc, const char **argv)
           H = ((mu * diagHsd) + Hsd).inverseByLU();
         }
         //	compute the control law
-        e = H * Lsd.t() * error;
+        e = H * Lsde;
 
         v = -lambda * e;
       }
@@ -113,9 +113,13 @@ private:
   vpMomentObject *object;
   vpMomentDatabase *moments;
   char _name[255];
+  //! Indexes in the database of the moments read with getMoment(), -1 when
+  //! not searched yet
+  mutable std::vector<int> dependencyIndexes;
 
 protected:
   std::vector<double> values;
+  const vpMoment &getMoment(unsigned int dependency, const char *type, bool &found) const;
   /*!
      Returns the linked moment database.
      \return the moment database
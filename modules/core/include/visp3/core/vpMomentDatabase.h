@@ -47,6 +47,7 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <vector>
 
 class vpMoment;
 class vpMomentObject;
@@ -127,6 +128,27 @@ Centered moments:
 Consequently, a database can contain at most one moment of each type. Often it
 is useful to update all moments with the same object. Shortcuts
 (vpMomentDatabase::updateAll) are provided for that matter.
+
+  The database can also compute the moments itself with compute() and
+computeAll(). In that case, the moments a moment reads with get() while it is
+computed are recorded as its dependencies, and are computed before it. The
+dependency graph found in this way is kept, so that the next computations are
+done directly in the order of the dependencies. Only the moments that are not
+computed yet for the object given to updateAll() are computed: in the example
+above, the two compute() calls can be replaced by
+\code
+  db.compute("vpMomentCentered"); // computes g, then mc
+\endcode
+  With setLazyEvaluation(), get() also computes the requested moment when it
+is not computed yet for the current object. This allows to compute only the
+moments that are used, for example by the moment features of a visual
+servoing task (see vpFeatureMomentDatabase::update()).
+
+  Since the moments are never removed from a database, the position of a
+moment in the database does not change. The moments and the moment features
+read their dependencies at each computation with get(const char *, int &,
+bool &), that searches a moment by its name only the first time and then
+uses the index it returned.
 */
 class VISP_EXPORT vpMomentDatabase
 {
@@ -136,23 +158,60 @@ private:
     bool operator()(char const *a, char const *b) const { return std::strcmp(a, b) < 0; }
   };
 #endif
-  std::map<const char *, vpMoment *, cmp_str> moments;
+  //! Index of the moments in momentList from their name
+  std::map<const char *, unsigned int, cmp_str> moments;
+  //! Moments in their registration order
+  std::vector<vpMoment *> momentList;
+  //! Indexes of the moments each moment depends on
+  mutable std::vector<std::vector<unsigned int> > dependencies;
+  //! Update of the object for which each moment is computed
+  mutable std::vector<unsigned int> computedAt;
+  //! Indexes of the moments being computed by the database
+  mutable std::vector<unsigned int> computing;
+  //! Number of updates of the object, starting at 1
+  unsigned int updateCount;
+  //! If true, get() computes the moments that are not computed yet
+  bool lazyEvaluation;
+
   void add(vpMoment &moment, const char *name);
+  void computeMoment(unsigned int index) const;
+  const vpMoment &getByIndex(unsigned int index) const;
 
 public:
-  vpMomentDatabase() : moments() {}
+  vpMomentDatabase()
+    : moments(), momentList(), dependencies(), computedAt(), computing(), updateCount(1), lazyEvaluation(false)
+  {
+  }
   virtual ~vpMomentDatabase() {}
 
   /** @name Inherited functionalities from vpMomentDatabase */
   //@{
   const vpMoment &get(const char *type, bool &found) const;
+  const vpMoment &get(const char *type, int &index, bool &found) const;
   /*!
     Get the first element in the database.
     May be useful in case an unnamed object is present but is the only element
     in the database. \return the first element in the database.
     */
-  vpMoment &get_first() { return *(moments.begin()->second); }
+  vpMoment &get_first() { return *momentList[moments.begin()->second]; }
+  /*!
+    Tells if get() computes the requested moment when it is not computed yet
+    for the current object.
+    */
+  bool getLazyEvaluation() const { return lazyEvaluation; }
+  /*!
+    Number of calls to updateAll(). A moment is computed by the database at
+    most once per update.
+    */
+  unsigned int getUpdateCount() const { return updateCount; }
+  /*!
+    Enables or disables the computation of the moments by get() when they are
+    not computed yet for the current object. This is disabled by default.
+    */
+  void setLazyEvaluation(bool lazy) { lazyEvaluation = lazy; }
 
+  void compute(const char *type);
+  void computeAll();
   virtual void updateAll(vpMomentObject &object);
   //@}
 
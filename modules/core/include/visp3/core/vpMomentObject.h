@@ -48,6 +48,7 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpMoment.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpRect.h>
 
 class vpCameraParameters;
 
@@ -239,6 +240,16 @@ public:
     WHITE = 1, /*! No functionality as of now */
   } vpCameraImgBckGrndType;
 
+  /*!
+    Horizontal run of pixels of a binary image, from the column \e u_start to
+    the column \e u_end included, on the row \e v. See fromRuns().
+  */
+  typedef struct {
+    unsigned int v;       /*!< Row of the run. */
+    unsigned int u_start; /*!< First column of the run. */
+    unsigned int u_end;   /*!< Last column of the run. */
+  } vpRun;
+
   bool flg_normalize_intensity; // To scale the intensity of each individual
                                 // pixel in the image by the maximum intensity
                                 // value present in it
@@ -258,9 +269,12 @@ public:
 
   void fromImage(const vpImage<unsigned char> &image, unsigned char threshold,
                  const vpCameraParameters &cam); // Binary version
+  void fromImage(const vpImage<unsigned char> &image, unsigned char threshold, const vpCameraParameters &cam,
+                 const vpRect &roi); // Binary version in a region of interest
   void fromImage(const vpImage<unsigned char> &image, const vpCameraParameters &cam, vpCameraImgBckGrndType bg_type,
                  bool normalize_with_pix_size = true); // Photometric version
 
+  void fromRuns(const std::vector<vpRun> &runs, const vpCameraParameters &cam);
   void fromVector(std::vector<vpPoint> &points);
   const std::vector<double> &get() const;
   double get(unsigned int i, unsigned int j) const;
@@ -307,6 +321,10 @@ protected:
   void cacheValues(std::vector<double> &cache, double x, double y);
 
 private:
+  void accumulatePixels(const vpImage<unsigned char> &image, const vpCameraParameters &cam, unsigned int u0,
+                        unsigned int v0, unsigned int n, unsigned int nbRows, const double *lut);
+  void accumulateRowSums(const vpCameraParameters &cam, unsigned int v0, unsigned int nbRows,
+                         const std::vector<double> &rowSums);
   void cacheValues(std::vector<double> &cache, double x, double y, double IntensityNormalized);
   double calc_mom_polygon(unsigned int p, unsigned int q, const std::vector<vpPoint> &points);
 };
@@ -48,7 +48,7 @@
 /*!
   Default constructor
 */
-vpMoment::vpMoment() : object(NULL), moments(NULL), values() {}
+vpMoment::vpMoment() : object(NULL), moments(NULL), dependencyIndexes(), values() {}
 
 /*!
   Links the moment to a database of moment primitives.
@@ -103,10 +103,31 @@ void vpMoment::linkTo(vpMomentDatabase &data_base)
 
   std::strcpy(_name, name());
   this->moments = &data_base;
+  dependencyIndexes.clear();
 
   data_base.add(*this, _name);
 }
 
+/*!
+  Retrieves a moment this moment depends on from the linked database. The
+  moment is searched by its name only at the first call, its index in the
+  database being kept for the next ones.
+
+  \param dependency : Number of the dependency, from 0 to the number of
+  moments read by the derived class minus one, that identifies \e type.
+  \param type : Name of the moment's class.
+  \param found : true if the moment's type exists in the database, false
+  otherwise.
+  \return Moment corresponding to \e type.
+*/
+const vpMoment &vpMoment::getMoment(unsigned int dependency, const char *type, bool &found) const
+{
+  if (dependency >= dependencyIndexes.size()) {
+    dependencyIndexes.resize(dependency + 1, -1);
+  }
+  return moments->get(type, dependencyIndexes[dependency], found);
+}
+
 /*!
   Updates the moment with the current object. This does not compute any
   values. \param moment_object : object descriptor of the current camera
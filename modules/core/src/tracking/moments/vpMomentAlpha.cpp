@@ -77,7 +77,7 @@ void vpMomentAlpha::compute()
   bool found_moment_centered;
 
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(getMoments().get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered)));
 
   if (!found_moment_centered)
     throw vpException(vpException::notInitialized, "vpMomentCentered not found");
@@ -57,7 +57,7 @@ void vpMomentArea::compute()
      * linked to it
      */
     const vpMomentCentered &momentCentered =
-        static_cast<const vpMomentCentered &>(getMoments().get("vpMomentCentered", found_moment_centered));
+        static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered));
     if (!found_moment_centered)
       throw vpException(vpException::notInitialized, "vpMomentCentered not found");
     values[0] = momentCentered.get(2, 0) + momentCentered.get(0, 2);
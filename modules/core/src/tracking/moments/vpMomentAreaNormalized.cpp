@@ -54,7 +54,7 @@ void vpMomentAreaNormalized::compute()
     .get() 		is a member function of vpMomentDatabase that returns
     a specific moment which is linked to it*/
   const vpMomentCentered &momentCentered =
-      static_cast<const vpMomentCentered &>(getMoments().get("vpMomentCentered", found_moment_centered));
+      static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered));
 
   if (!found_moment_centered)
     throw vpException(vpException::notInitialized, "vpMomentCentered not found");
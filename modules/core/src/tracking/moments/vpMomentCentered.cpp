@@ -68,7 +68,7 @@ void vpMomentCentered::compute()
   values.resize((getObject().getOrder() + 1) * (getObject().getOrder() + 1));
 
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(getMoments().get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(0, "vpMomentGravityCenter", found_moment_gravity));
   if (!found_moment_gravity)
     throw vpException(vpException::notInitialized, "vpMomentGravityCenter not found");
 
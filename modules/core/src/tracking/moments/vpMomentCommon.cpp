@@ -71,8 +71,8 @@ vpMomentCommon::vpMomentCommon(double dstSurface, const std::vector<double> &ref
 /*!
 Updates all moments in the database with the object and computes all their
 values. This is possible because this particular database knows the link
-between the moments it contains. The order of computation is as follows:
-vpMomentGravityCenter,vpMomentCentered,vpMomentAlpha,vpMomentCInvariant,vpMomentSInvariant,vpMomentAreaNormalized,vpMomentGravityCenterNormalized
+between the moments it contains: each moment is computed after the moments it
+depends on (see vpMomentDatabase::computeAll()).
 \param object : Moment object.
 
 Example of using a preconfigured database to compute one of the C-invariants:
@@ -127,16 +127,7 @@ void vpMomentCommon::updateAll(vpMomentObject &object)
 {
   try {
     vpMomentDatabase::updateAll(object);
-
-    momentGravity.compute();
-    momentCentered.compute();
-    momentAlpha.compute();
-    momentCInvariant->compute();
-
-    momentSurfaceNormalized.compute();
-    momentGravityNormalized.compute();
-    momentArea.compute();
-
+    computeAll();
   } catch (const char *ex) {
     std::cout << "exception:" << ex << std::endl;
   }
@@ -36,12 +36,30 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
 #include <iostream>
 #include <typeinfo>
+#include <visp3/core/vpException.h>
 #include <visp3/core/vpMoment.h>
 #include <visp3/core/vpMomentDatabase.h>
 #include <visp3/core/vpMomentObject.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Moment returned by vpMomentDatabase::get() for a type that is not in the
+// database
+class vpMomentNotFound : public vpMoment
+{
+public:
+  void compute() {}
+  const char *name() const { return "vpMomentNotFound"; }
+};
+
+const vpMomentNotFound momentNotFound;
+}
+#endif
+
 /*!
         Adds a moment to the database.
         \param moment : moment to add
@@ -52,7 +70,11 @@
 */
 void vpMomentDatabase::add(vpMoment &moment, const char *name)
 {
-  moments.insert(std::pair<const char *, vpMoment *>((const char *)name, &moment));
+  if (moments.insert(std::pair<const char *, unsigned int>(name, (unsigned int)momentList.size())).second) {
+    momentList.push_back(&moment);
+    dependencies.push_back(std::vector<unsigned int>());
+    computedAt.push_back(0);
+  }
 }
 
 /*!
@@ -60,13 +82,133 @@ void vpMomentDatabase::add(vpMoment &moment, const char *name)
   \param type : Name of the moment's class.
   \param found : true if the moment's type exists in the database, false
   otherwise. \return Moment corresponding to \e type.
+
+  When it is called by a moment computed by the database (see compute()), or
+  when the lazy evaluation is enabled (see setLazyEvaluation()), the moment is
+  computed before being returned if it is not computed yet for the current
+  object.
 */
 const vpMoment &vpMomentDatabase::get(const char *type, bool &found) const
 {
-  std::map<const char *, vpMoment *, vpMomentDatabase::cmp_str>::const_iterator it = moments.find(type);
+  std::map<const char *, unsigned int, vpMomentDatabase::cmp_str>::const_iterator it = moments.find(type);
 
   found = (it != moments.end());
-  return *(it->second);
+  if (!found) {
+    return momentNotFound;
+  }
+  return getByIndex(it->second);
+}
+
+/*!
+  Retrieves a moment from the database with an index cached by the caller,
+  to avoid searching the moment by its name at each call.
+
+  \param type : Name of the moment's class.
+  \param index : Index of the moment in the database. When it is negative,
+  the moment is searched by its name and its index is stored in \e index.
+  Otherwise the moment is returned without search: \e index has to be set
+  by a previous call for the same \e type and the same database.
+  \param found : true if the moment's type exists in the database, false
+  otherwise.
+  \return Moment corresponding to \e type.
+
+  The moment is computed as with get(const char *, bool &) const.
+*/
+const vpMoment &vpMomentDatabase::get(const char *type, int &index, bool &found) const
+{
+  if (index < 0 || (size_t)index >= momentList.size()) {
+    std::map<const char *, unsigned int, vpMomentDatabase::cmp_str>::const_iterator it = moments.find(type);
+    found = (it != moments.end());
+    if (!found) {
+      return momentNotFound;
+    }
+    index = (int)it->second;
+  }
+  found = true;
+  return getByIndex((unsigned int)index);
+}
+
+/*!
+  Returns the moment at a given position in the database, after recording
+  it as a dependency of the moment being computed by the database and
+  computing it if needed.
+*/
+const vpMoment &vpMomentDatabase::getByIndex(unsigned int index) const
+{
+  if (!computing.empty()) {
+    std::vector<unsigned int> &deps = dependencies[computing.back()];
+    if (std::find(deps.begin(), deps.end(), index) == deps.end()) {
+      deps.push_back(index);
+    }
+  }
+  if ((lazyEvaluation || !computing.empty()) && computedAt[index] != updateCount) {
+    computeMoment(index);
+  }
+  return *momentList[index];
+}
+
+/*!
+  Computes a moment after the moments it depends on that are not computed yet
+  for the current object.
+*/
+void vpMomentDatabase::computeMoment(unsigned int index) const
+{
+  if (std::find(computing.begin(), computing.end(), index) != computing.end()) {
+    computing.clear();
+    throw vpException(vpException::fatalError, "Cyclic dependency of the moment %s", momentList[index]->name());
+  }
+
+  bool outermost = computing.empty();
+  computing.push_back(index);
+  try {
+    for (size_t i = 0; i < dependencies[index].size(); i++) {
+      unsigned int dep = dependencies[index][i];
+      if (computedAt[dep] != updateCount) {
+        computeMoment(dep);
+      }
+    }
+    momentList[index]->compute();
+  } catch (...) {
+    if (outermost) {
+      computing.clear();
+    }
+    throw;
+  }
+  computedAt[index] = updateCount;
+  computing.pop_back();
+}
+
+/*!
+  Computes a moment of the database and the moments it depends on, if they
+  are not computed yet for the object given to updateAll().
+
+  The moments a moment reads with get() while it is computed are recorded as
+  its dependencies. They are computed before it, now and at the next updates.
+
+  \param type : Name of the moment's class.
+*/
+void vpMomentDatabase::compute(const char *type)
+{
+  std::map<const char *, unsigned int, vpMomentDatabase::cmp_str>::const_iterator it = moments.find(type);
+  if (it == moments.end()) {
+    throw vpException(vpException::badValue, "Moment %s not found in the database", type);
+  }
+  if (computedAt[it->second] != updateCount) {
+    computeMoment(it->second);
+  }
+}
+
+/*!
+  Computes all the moments of the database that are not computed yet for the
+  object given to updateAll(), each one after the moments it depends on.
+*/
+void vpMomentDatabase::computeAll()
+{
+  for (unsigned int i = 0; i < momentList.size(); i++) {
+    if (computedAt[i] != updateCount) {
+      computeMoment(i);
+    }
+  }
 }
 
 /*!
@@ -78,13 +220,15 @@ const vpMoment &vpMomentDatabase::get(const char *type, bool &found) const
   only one moment when this moment depends on other moments. The example
   provided in the header of this class gives an example that shows how to
   compute gravity center moment and the centered moment using a mass update.
+
+  The moments computed by the database before are marked as not computed.
 */
 void vpMomentDatabase::updateAll(vpMomentObject &object)
 {
-  std::map<const char *, vpMoment *, vpMomentDatabase::cmp_str>::const_iterator itr;
-  for (itr = moments.begin(); itr != moments.end(); ++itr) {
-    (*itr).second->update(object);
+  for (size_t i = 0; i < momentList.size(); i++) {
+    momentList[i]->update(object);
   }
+  updateCount++;
 }
 
 /*!
@@ -92,11 +236,11 @@ void vpMomentDatabase::updateAll(vpMomentObject &object)
 */
 VISP_EXPORT std::ostream &operator<<(std::ostream &os, const vpMomentDatabase &m)
 {
-  std::map<const char *, vpMoment *, vpMomentDatabase::cmp_str>::const_iterator itr;
+  std::map<const char *, unsigned int, vpMomentDatabase::cmp_str>::const_iterator itr;
   os << "{";
 
   for (itr = m.moments.begin(); itr != m.moments.end(); ++itr) {
-    os << (*itr).first << ": [" << *((*itr).second) << "],";
+    os << (*itr).first << ": [" << *(m.momentList[(*itr).second]) << "],";
   }
   os << "}";
 
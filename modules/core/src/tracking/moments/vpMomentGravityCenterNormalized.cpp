@@ -52,9 +52,9 @@ void vpMomentGravityCenterNormalized::compute()
   bool found_moment_surface_normalized;
 
   const vpMomentAreaNormalized &momentSurfaceNormalized = static_cast<const vpMomentAreaNormalized &>(
-      getMoments().get("vpMomentAreaNormalized", found_moment_surface_normalized));
+      getMoment(0, "vpMomentAreaNormalized", found_moment_surface_normalized));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(getMoments().get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(1, "vpMomentGravityCenter", found_moment_gravity));
 
   if (!found_moment_surface_normalized)
     throw vpException(vpException::notInitialized, "vpMomentAreaNormalized not found");
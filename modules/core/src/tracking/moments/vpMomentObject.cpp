@@ -43,6 +43,7 @@
 #include <visp3/core/vpMomentObject.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -51,6 +52,158 @@
 #endif
 #include <cassert>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Powers x^i of the abscissa in meter of the columns [u0, u0 + n[, stored as
+// xpow[i * n + k] for the column u0 + k. Without distortion x only depends
+// on u.
+void columnPowers(const vpCameraParameters &cam, unsigned int u0, unsigned int n, unsigned int order,
+                  std::vector<double> &xpow)
+{
+  xpow.resize(order * n);
+  for (unsigned int k = 0; k < n; k++) {
+    double x = 0, y = 0;
+    vpPixelMeterConversion::convertPoint(cam, u0 + k, 0, x, y);
+    double xval = 1.;
+    for (unsigned int i = 0; i < order; i++) {
+      xpow[i * n + k] = xval;
+      xval *= x;
+    }
+  }
+}
+
+// Prefix sums of the powers of the abscissa: prefix[i * (n + 1) + k] is the
+// sum of x^i over the k first columns
+void prefixSums(const std::vector<double> &xpow, unsigned int n, unsigned int order, std::vector<double> &prefix)
+{
+  prefix.resize(order * (n + 1));
+  for (unsigned int i = 0; i < order; i++) {
+    double *p = &prefix[i * (n + 1)];
+    const double *x = &xpow[i * n];
+    p[0] = 0.;
+    for (unsigned int k = 0; k < n; k++) {
+      p[k + 1] = p[k] + x[k];
+    }
+  }
+}
+
+// Add the sums of x^i over the columns [start, end[ of a run to S
+inline void addRun(const double *prefix, unsigned int n, unsigned int order, unsigned int start, unsigned int end,
+                   double *S)
+{
+  for (unsigned int i = 0; i < order; i++) {
+    const double *p = prefix + i * (n + 1);
+    S[i] += p[end] - p[start];
+  }
+}
+
+// Sums S[i] of x^i over the pixels of a row of n pixels greater than the
+// threshold, found by runs
+void binaryRowSums(const unsigned char *row, unsigned int n, unsigned char threshold, const double *prefix,
+                   unsigned int order, double *S)
+{
+  std::fill(S, S + order, 0.);
+  bool inside = false;
+  unsigned int start = 0;
+  unsigned int k = 0;
+#if VISP_HAVE_SSE2
+  // Unsigned comparison of 16 pixels with signed bytes
+  const __m128i bias = _mm_set1_epi8((char)0x80);
+  const __m128i thr = _mm_set1_epi8((char)(threshold ^ 0x80));
+  for (; k + 16 <= n; k += 16) {
+    __m128i pixels = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(row + k)), bias);
+    int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(pixels, thr));
+    if (mask == (inside ? 0xFFFF : 0)) {
+      continue;
+    }
+    for (unsigned int b = 0; b < 16; b++) {
+      bool selected = ((mask >> b) & 1) != 0;
+      if (selected != inside) {
+        if (inside) {
+          addRun(prefix, n, order, start, k + b, S);
+        } else {
+          start = k + b;
+        }
+        inside = selected;
+      }
+    }
+  }
+#endif
+  for (; k < n; k++) {
+    bool selected = row[k] > threshold;
+    if (selected != inside) {
+      if (inside) {
+        addRun(prefix, n, order, start, k, S);
+      } else {
+        start = k;
+      }
+      inside = selected;
+    }
+  }
+  if (inside) {
+    addRun(prefix, n, order, start, n, S);
+  }
+}
+
+// Sums S[i] of w(I) x^i over a row of n pixels, with the weight w given by a
+// look-up table
+void weightedRowSums(const unsigned char *row, unsigned int n, const double *lut, const double *xpow,
+                     unsigned int order, double *S)
+{
+  for (unsigned int i = 0; i < order; i++) {
+    const double *x = xpow + i * n;
+    unsigned int k = 0;
+    double sum = 0.;
+#if VISP_HAVE_SSE2
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; k + 4 <= n; k += 4) {
+      acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_set_pd(lut[row[k + 1]], lut[row[k]]), _mm_loadu_pd(x + k)));
+      acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_set_pd(lut[row[k + 3]], lut[row[k + 2]]), _mm_loadu_pd(x + k + 2)));
+    }
+    double tmp[2];
+    _mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+    sum = tmp[0] + tmp[1];
+#endif
+    for (; k < n; k++) {
+      sum += lut[row[k]] * x[k];
+    }
+    S[i] = sum;
+  }
+}
+
+// Sums of w x^i y^j over the pixels [u0, u0 + n[ of the row v, for cameras
+// with distortion where x and y depend on both u and v
+void distortedRowSums(const vpCameraParameters &cam, const unsigned char *row, unsigned int u0, unsigned int n,
+                      unsigned int v, const double *lut, unsigned int order, double *S)
+{
+  std::fill(S, S + order * order, 0.);
+  for (unsigned int k = 0; k < n; k++) {
+    double w = lut[row[k]];
+    if (w == 0.) {
+      continue;
+    }
+    double x = 0, y = 0;
+    vpPixelMeterConversion::convertPoint(cam, u0 + k, v, x, y);
+    double yval = w;
+    for (unsigned int j = 0; j < order; j++) {
+      double xval = yval;
+      for (unsigned int i = 0; i < order - j; i++) {
+        S[j * order + i] += xval;
+        xval *= x;
+      }
+      yval *= y;
+    }
+  }
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Computes moments from a vector of points describing a polygon.
   The points must be stored in a clockwise order. Used internally.
@@ -289,67 +442,139 @@ image
 void vpMomentObject::fromImage(const vpImage<unsigned char> &image, unsigned char threshold,
                                const vpCameraParameters &cam)
 {
+  fromImage(image, threshold, cam, vpRect(0, 0, image.getWidth(), image.getHeight()));
+}
+
+/*!
+  Computes basic moments from the pixels of a region of interest of an image
+  that are greater than a threshold.
+
+  Each row of the region of interest is cut in runs of pixels greater than the
+  threshold, compared by 16 pixels with SSE2 when available. The sums of
+  \f$x^i\f$ over a run are given by prefix sums of the powers of the
+  abscissa of the columns, and are combined with the powers of the ordinate of
+  the row. The rows are processed in parallel when ViSP is built with OpenMP,
+  and summed in their order so that the moments do not depend on the number
+  of threads. With a camera with distortion, the moments are accumulated
+  pixel by pixel.
+
+  \param image : Image to consider.
+  \param threshold : Pixels with a luminance greater than this threshold
+  belong to the object.
+  \param cam : Camera parameters used to convert pixels coordinates in meters
+  in the image plane.
+  \param roi : Region of interest. The pixels outside this region are
+  ignored.
+
+  \sa fromRuns()
+*/
+void vpMomentObject::fromImage(const vpImage<unsigned char> &image, unsigned char threshold,
+                               const vpCameraParameters &cam, const vpRect &roi)
+{
+  values.assign(order * order, 0.);
+
+  // Region of interest clamped to the image
+  double left = std::max(0., std::ceil(roi.getLeft()));
+  double top = std::max(0., std::ceil(roi.getTop()));
+  double right = std::min((double)image.getWidth() - 1., std::floor(roi.getRight()));
+  double bottom = std::min((double)image.getHeight() - 1., std::floor(roi.getBottom()));
+  if (right >= left && bottom >= top) {
+    unsigned int u0 = (unsigned int)left, v0 = (unsigned int)top;
+    unsigned int n = (unsigned int)(right - left) + 1;
+    int nbRows = (int)(bottom - top) + 1;
+
+    if (cam.get_projModel() == vpCameraParameters::perspectiveProjWithoutDistortion) {
+      std::vector<double> xpow, prefix;
+      columnPowers(cam, u0, n, order, xpow);
+      prefixSums(xpow, n, order, prefix);
+
+      std::vector<double> rowSums((size_t)nbRows * order);
 #ifdef VISP_HAVE_OPENMP
-#pragma omp parallel shared(threshold)
-  {
-    std::vector<double> curvals(order * order);
-    curvals.assign(order * order, 0.);
-
-#pragma omp for nowait // automatically organize loop counter between threads
-    for (int i = 0; i < (int)image.getCols(); i++) {
-      for (int j = 0; j < (int)image.getRows(); j++) {
-        unsigned int i_ = static_cast<unsigned int>(i);
-        unsigned int j_ = static_cast<unsigned int>(j);
-        if (image[j_][i_] > threshold) {
-          double x = 0;
-          double y = 0;
-          vpPixelMeterConversion::convertPoint(cam, i_, j_, x, y);
-
-          double yval = 1.;
-          for (unsigned int k = 0; k < order; k++) {
-            double xval = 1.;
-            for (unsigned int l = 0; l < order - k; l++) {
-              curvals[(k * order + l)] += (xval * yval);
-              xval *= x;
-            }
-            yval *= y;
-          }
-        }
+#pragma omp parallel for schedule(static)
+#endif
+      for (int r = 0; r < nbRows; r++) {
+        binaryRowSums(image[v0 + (unsigned int)r] + u0, n, threshold, &prefix[0], order,
+                      &rowSums[(size_t)r * order]);
       }
+      accumulateRowSums(cam, v0, (unsigned int)nbRows, rowSums);
+    } else {
+      double lut[256];
+      for (unsigned int g = 0; g < 256; g++) {
+        lut[g] = g > threshold ? 1. : 0.;
+      }
+      accumulatePixels(image, cam, u0, v0, n, (unsigned int)nbRows, lut);
     }
+  }
+
+  // Normalisation equivalent to sampling interval/pixel size delX x delY
+  double norm_factor = 1. / (cam.get_px() * cam.get_py());
+  for (std::vector<double>::iterator it = values.begin(); it != values.end(); ++it) {
+    *it = (*it) * norm_factor;
+  }
+}
+
+/*!
+  Computes basic moments from a binary image given as horizontal runs of
+  pixels, as provided by a run-length encoding or a blob tracker.
+
+  The moments are the same as the ones of fromImage() on a binary image where
+  the pixels of the runs are greater than the threshold. The runs must not
+  overlap.
+
+  \param runs : Runs of pixels of the object.
+  \param cam : Camera parameters used to convert pixels coordinates in meters
+  in the image plane.
+
+  \exception vpException::badValue : A run ends before its start.
+*/
+void vpMomentObject::fromRuns(const std::vector<vpRun> &runs, const vpCameraParameters &cam)
+{
+  values.assign(order * order, 0.);
 
-#pragma omp master // only set this variable in master thread
-    {
-      values.assign(order * order, 0.);
+  unsigned int n = 0;
+  for (size_t r = 0; r < runs.size(); r++) {
+    if (runs[r].u_end < runs[r].u_start) {
+      throw vpException(vpException::badValue, "Bad run of pixels from column %u to column %u", runs[r].u_start,
+                        runs[r].u_end);
     }
+    n = std::max(n, runs[r].u_end + 1);
+  }
 
-#pragma omp barrier
-    for (unsigned int k = 0; k < order; k++) {
-      for (unsigned int l = 0; l < order - k; l++) {
-#pragma omp atomic
-        values[k * order + l] += curvals[k * order + l];
+  if (cam.get_projModel() == vpCameraParameters::perspectiveProjWithoutDistortion) {
+    std::vector<double> xpow, prefix;
+    columnPowers(cam, 0, n, order, xpow);
+    prefixSums(xpow, n, order, prefix);
+    std::vector<double> S(order);
+    for (size_t r = 0; r < runs.size(); r++) {
+      std::fill(S.begin(), S.end(), 0.);
+      addRun(&prefix[0], n, order, runs[r].u_start, runs[r].u_end + 1, &S[0]);
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, 0, runs[r].v, x, y);
+      double yval = 1.;
+      for (unsigned int j = 0; j < order; j++) {
+        for (unsigned int i = 0; i < order - j; i++) {
+          values[j * order + i] += yval * S[i];
+        }
+        yval *= y;
       }
     }
-  }
-#else
-  std::vector<double> cache(order * order, 0.);
-  values.assign(order * order, 0);
-  for (unsigned int i = 0; i < image.getCols(); i++) {
-    for (unsigned int j = 0; j < image.getRows(); j++) {
-      if (image[j][i] > threshold) {
-        double x = 0;
-        double y = 0;
-        vpPixelMeterConversion::convertPoint(cam, i, j, x, y);
-        cacheValues(cache, x, y);
-        for (unsigned int k = 0; k < order; k++) {
-          for (unsigned int l = 0; l < order - k; l++) {
-            values[k * order + l] += cache[k * order + l];
+  } else {
+    for (size_t r = 0; r < runs.size(); r++) {
+      for (unsigned int u = runs[r].u_start; u <= runs[r].u_end; u++) {
+        double x = 0, y = 0;
+        vpPixelMeterConversion::convertPoint(cam, u, runs[r].v, x, y);
+        double yval = 1.;
+        for (unsigned int j = 0; j < order; j++) {
+          double xval = yval;
+          for (unsigned int i = 0; i < order - j; i++) {
+            values[j * order + i] += xval;
+            xval *= x;
           }
+          yval *= y;
         }
       }
     }
   }
-#endif
 
   // Normalisation equivalent to sampling interval/pixel size delX x delY
   double norm_factor = 1. / (cam.get_px() * cam.get_py());
@@ -358,6 +583,52 @@ void vpMomentObject::fromImage(const vpImage<unsigned char> &image, unsigned cha
   }
 }
 
+/*!
+  Adds to the moments the sums \f$S_i\f$ of the rows [v0, v0 + nbRows[,
+  multiplied by the powers of the ordinate of the rows. Used internally.
+*/
+void vpMomentObject::accumulateRowSums(const vpCameraParameters &cam, unsigned int v0, unsigned int nbRows,
+                                       const std::vector<double> &rowSums)
+{
+  for (unsigned int r = 0; r < nbRows; r++) {
+    const double *S = &rowSums[(size_t)r * order];
+    double x = 0, y = 0;
+    vpPixelMeterConversion::convertPoint(cam, 0, v0 + r, x, y);
+    double yval = 1.;
+    for (unsigned int j = 0; j < order; j++) {
+      for (unsigned int i = 0; i < order - j; i++) {
+        values[j * order + i] += yval * S[i];
+      }
+      yval *= y;
+    }
+  }
+}
+
+/*!
+  Adds to the moments the pixels of the region [u0, u0 + n[ x [v0, v0 +
+  nbRows[ weighted by a look-up table of the gray levels, pixel by pixel.
+  Used internally for cameras with distortion.
+*/
+void vpMomentObject::accumulatePixels(const vpImage<unsigned char> &image, const vpCameraParameters &cam,
+                                      unsigned int u0, unsigned int v0, unsigned int n, unsigned int nbRows,
+                                      const double *lut)
+{
+  const size_t rowSize = order * order;
+  std::vector<double> rowSums(nbRows * rowSize);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < (int)nbRows; r++) {
+    unsigned int v = v0 + (unsigned int)r;
+    distortedRowSums(cam, image[v] + u0, u0, n, v, lut, order, &rowSums[(size_t)r * rowSize]);
+  }
+  for (unsigned int r = 0; r < nbRows; r++) {
+    for (unsigned int k = 0; k < rowSize; k++) {
+      values[k] += rowSums[r * rowSize + k];
+    }
+  }
+}
+
 /*!
  * Manikandan. B
  * Photometric moments v2
@@ -373,20 +644,8 @@ void vpMomentObject::fromImage(const vpImage<unsigned char> &image, unsigned cha
 void vpMomentObject::fromImage(const vpImage<unsigned char> &image, const vpCameraParameters &cam,
                                vpCameraImgBckGrndType bg_type, bool normalize_with_pix_size)
 {
-  std::vector<double> cache(order * order, 0.);
   values.assign(order * order, 0);
 
-  // (x,y) - Pixel co-ordinates in metres
-  double x = 0;
-  double y = 0;
-  // for indexing into cache[] and values[]
-  unsigned int idx = 0;
-  unsigned int kidx = 0;
-
-  double intensity = 0;
-
-  // double Imax = static_cast<double>(image.getMaxValue());
-
   double iscale = 1.0;
   if (flg_normalize_intensity) { // This makes the image a probability density
                                  // function
@@ -394,52 +653,31 @@ void vpMomentObject::fromImage(const vpImage<unsigned char> &image, const vpCame
     iscale = 1.0 / Imax;
   }
 
-  if (bg_type == vpMomentObject::WHITE) {
-    /////////// WHITE BACKGROUND ///////////
-    for (unsigned int j = 0; j < image.getRows(); j++) {
-      for (unsigned int i = 0; i < image.getCols(); i++) {
-        x = 0;
-        y = 0;
-        intensity = (double)(image[j][i]) * iscale;
-        double intensity_white = 1. - intensity;
-
-        vpPixelMeterConversion::convertPoint(cam, i, j, x, y);
-        cacheValues(cache, x, y, intensity_white); // Modify 'cache' which has
-                                                   // x^p*y^q to x^p*y^q*(1 -
-                                                   // I(x,y))
-
-        // Copy to "values"
-        for (unsigned int k = 0; k < order; k++) {
-          kidx = k * order;
-          for (unsigned int l = 0; l < order - k; l++) {
-            idx = kidx + l;
-            values[idx] += cache[idx];
-          }
-        }
-      }
-    }
-  } else {
-    /////////// BLACK BACKGROUND	///////////
-    for (unsigned int j = 0; j < image.getRows(); j++) {
-      for (unsigned int i = 0; i < image.getCols(); i++) {
-        x = 0;
-        y = 0;
-        intensity = (double)(image[j][i]) * iscale;
-        vpPixelMeterConversion::convertPoint(cam, i, j, x, y);
-
-        // Cache values for fast moment calculation
-        cacheValues(cache, x, y,
-                    intensity); // Modify 'cache' which has x^p*y^q to x^p*y^q*I(x,y)
-
-        // Copy to moments array 'values'
-        for (unsigned int k = 0; k < order; k++) {
-          kidx = k * order;
-          for (unsigned int l = 0; l < order - k; l++) {
-            idx = kidx + l;
-            values[idx] += cache[idx];
-          }
-        }
+  // Weight of the gray levels: I(x,y) on a black background, 1 - I(x,y) on a
+  // white background
+  double lut[256];
+  for (unsigned int g = 0; g < 256; g++) {
+    double intensity = (double)g * iscale;
+    lut[g] = (bg_type == vpMomentObject::WHITE) ? 1. - intensity : intensity;
+  }
+
+  unsigned int n = image.getWidth(), nbRows = image.getHeight();
+  if (n > 0 && nbRows > 0) {
+    if (cam.get_projModel() == vpCameraParameters::perspectiveProjWithoutDistortion) {
+      // The moments are the sums over the rows of y^j times the sums of
+      // I(x,y) x^i over the row
+      std::vector<double> xpow;
+      columnPowers(cam, 0, n, order, xpow);
+      std::vector<double> rowSums((size_t)nbRows * order);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int r = 0; r < (int)nbRows; r++) {
+        weightedRowSums(image[(unsigned int)r], n, lut, &xpow[0], order, &rowSums[(size_t)r * order]);
       }
+      accumulateRowSums(cam, 0, nbRows, rowSums);
+    } else {
+      accumulatePixels(image, cam, 0, 0, n, nbRows, lut);
     }
   }
 
@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the computation of the basic moments from an image.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMomentObject.cpp
+
+  \brief Test the basic moments computed by vpMomentObject from binary and
+  gray level images, in a region of interest and from runs of pixels, against
+  the sums over the pixels.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMomentObject.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
+
+namespace
+{
+const unsigned int order = 5;
+
+// Moments as the sums of w(I) x^i y^j over the pixels of a region, and the
+// sums of their absolute values for the tolerance
+void referenceMoments(const vpImage<unsigned char> &I, const vpCameraParameters &cam, const double *lut,
+                      unsigned int left, unsigned int top, unsigned int right, unsigned int bottom,
+                      std::vector<double> &m, std::vector<double> &mabs)
+{
+  m.assign((order + 1) * (order + 1), 0.);
+  mabs.assign((order + 1) * (order + 1), 0.);
+  for (unsigned int v = top; v <= bottom; v++) {
+    for (unsigned int u = left; u <= right; u++) {
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, u, v, x, y);
+      for (unsigned int j = 0; j <= order; j++) {
+        for (unsigned int i = 0; i + j <= order; i++) {
+          double value = lut[I[v][u]] * pow(x, (int)i) * pow(y, (int)j) / (cam.get_px() * cam.get_py());
+          m[j * (order + 1) + i] += value;
+          mabs[j * (order + 1) + i] += std::fabs(value);
+        }
+      }
+    }
+  }
+}
+
+bool check(const vpMomentObject &obj, const std::vector<double> &m, const std::vector<double> &mabs,
+           const std::string &name)
+{
+  for (unsigned int j = 0; j <= order; j++) {
+    for (unsigned int i = 0; i + j <= order; i++) {
+      double ref = m[j * (order + 1) + i];
+      if (std::fabs(obj.get(i, j) - ref) > 1e-9 * (mabs[j * (order + 1) + i] + 1e-12)) {
+        std::cerr << name << ": bad m" << i << j << " " << obj.get(i, j) << " instead of " << ref << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    const unsigned int height = 480, width = 640;
+    const unsigned char threshold = 128;
+
+    // Ellipse with a hole and noise
+    vpImage<unsigned char> I(height, width);
+    srand(42);
+    for (unsigned int v = 0; v < height; v++) {
+      for (unsigned int u = 0; u < width; u++) {
+        double du = (u - 350.) / 180., dv = (v - 220.) / 120.;
+        double r = du * du + dv * dv;
+        bool inside = r < 1. && r > 0.1;
+        I[v][u] = (unsigned char)(inside ? 160 + rand() % 96 : rand() % 100);
+        if (rand() % 50 == 0) {
+          I[v][u] = (unsigned char)(255 - I[v][u]);
+        }
+      }
+    }
+
+    double binary[256], black[256], white[256];
+    for (unsigned int g = 0; g < 256; g++) {
+      binary[g] = g > threshold ? 1. : 0.;
+      black[g] = g / 255.;
+      white[g] = 1. - g / 255.;
+    }
+
+    vpCameraParameters cams[2];
+    cams[0].initPersProjWithoutDistortion(600, 610, 320, 240);
+    cams[1].initPersProjWithDistortion(600, 610, 320, 240, -0.2, 0.2);
+    for (unsigned int c = 0; c < 2; c++) {
+      const vpCameraParameters &cam = cams[c];
+      std::string camName = c == 0 ? "without distortion" : "with distortion";
+      std::vector<double> m, mabs;
+      vpMomentObject obj(order);
+
+      // Binary image
+      referenceMoments(I, cam, binary, 0, 0, width - 1, height - 1, m, mabs);
+      double t = vpTime::measureTimeMs();
+      obj.fromImage(I, threshold, cam);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Binary image " << camName << ": " << t << " ms" << std::endl;
+      if (!check(obj, m, mabs, "Binary image " + camName)) {
+        return EXIT_FAILURE;
+      }
+
+      // Region of interest, partly outside the image
+      referenceMoments(I, cam, binary, 100, 50, width - 1, 300, m, mabs);
+      obj.fromImage(I, threshold, cam, vpRect(100, 50, 600, 251));
+      if (!check(obj, m, mabs, "Region of interest " + camName)) {
+        return EXIT_FAILURE;
+      }
+
+      // Runs of the binary image
+      std::vector<vpMomentObject::vpRun> runs;
+      for (unsigned int v = 0; v < height; v++) {
+        for (unsigned int u = 0; u < width; u++) {
+          if (I[v][u] > threshold && (u == 0 || I[v][u - 1] <= threshold)) {
+            vpMomentObject::vpRun run;
+            run.v = v;
+            run.u_start = u;
+            run.u_end = u;
+            while (run.u_end + 1 < width && I[v][run.u_end + 1] > threshold) {
+              run.u_end++;
+            }
+            runs.push_back(run);
+          }
+        }
+      }
+      referenceMoments(I, cam, binary, 0, 0, width - 1, height - 1, m, mabs);
+      t = vpTime::measureTimeMs();
+      obj.fromRuns(runs, cam);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << runs.size() << " runs " << camName << ": " << t << " ms" << std::endl;
+      if (!check(obj, m, mabs, "Runs " + camName)) {
+        return EXIT_FAILURE;
+      }
+
+      // Gray level image on a black and a white background
+      referenceMoments(I, cam, black, 0, 0, width - 1, height - 1, m, mabs);
+      t = vpTime::measureTimeMs();
+      obj.fromImage(I, cam, vpMomentObject::BLACK);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Gray level image " << camName << ": " << t << " ms" << std::endl;
+      if (!check(obj, m, mabs, "Black background " + camName)) {
+        return EXIT_FAILURE;
+      }
+      referenceMoments(I, cam, white, 0, 0, width - 1, height - 1, m, mabs);
+      obj.fromImage(I, cam, vpMomentObject::WHITE);
+      if (!check(obj, m, mabs, "White background " + camName)) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testMomentObject is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
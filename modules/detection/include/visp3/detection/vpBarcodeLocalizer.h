@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Fast localization of QR codes and Data Matrix codes.
+ *
+ *****************************************************************************/
+
+#ifndef __vpBarcodeLocalizer_h__
+#define __vpBarcodeLocalizer_h__
+
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/vision/vpHomography.h>
+
+/*!
+  \class vpBarcodeLocalizer
+  \ingroup group_detection_barcode
+
+  \brief Fast localization of QR codes and Data Matrix codes, used to pass
+  only small rectified images to the decoders.
+
+  The bar code decoders scan the whole image, which is slow on large images.
+  This class locates the candidate codes on a downscaled and locally
+  binarized image:
+  - a QR code is located by its three finder patterns: the rows of the image
+    are scanned for the 1:1:3:1:1 dark and light runs of a finder pattern,
+    which are checked along the column of their center; three finder
+    patterns of the same module size forming a right isosceles triangle give
+    a code;
+  - a Data Matrix code is located by its L-pattern: the minimal area
+    rectangle of each dark connected component has to have two adjacent
+    solid dark sides and two alternating sides.
+
+  The rows of the image and the components are processed in parallel when
+  ViSP is built with OpenMP. Each candidate can then be warped by rectify()
+  into a small upright image, with a quiet zone around the code, that is
+  given to the decoder. vpDetectorQRCode and vpDetectorDataMatrixCode use
+  this class when the localization is enabled (see
+  vpDetectorQRCode::setLocalization()).
+
+  \code
+#include <visp3/detection/vpBarcodeLocalizer.h>
+
+int main()
+{
+  vpImage<unsigned char> I;
+  // ... acquire an image
+  vpBarcodeLocalizer localizer(vpBarcodeLocalizer::QR_CODE);
+  std::vector<vpBarcodeLocalizer::vpCandidate> candidates;
+  localizer.locate(I, candidates);
+  for (size_t i = 0; i < candidates.size(); i++) {
+    vpImage<unsigned char> Icode;
+    vpHomography codeToImage;
+    localizer.rectify(I, candidates[i], Icode, codeToImage);
+    // ... decode Icode
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpBarcodeLocalizer
+{
+public:
+  //! Type of the codes to locate
+  typedef enum {
+    QR_CODE,    /*!< QR code, located by its finder patterns. */
+    DATA_MATRIX /*!< Data Matrix code, located by its L-pattern. */
+  } vpBarcodeType;
+
+  //! Candidate code
+  struct vpCandidate {
+    //! Corners of the code. For a QR code, the first corner is the one of
+    //! the finder pattern at the right angle and the corners are clockwise
+    //! in the image. For a Data Matrix code, the first corner is the one of
+    //! the L-pattern and the corners are in the order of libdmtx.
+    vpImagePoint corners[4];
+    //! Estimated size of the modules in pixels
+    double moduleSize;
+    //! Score of the candidate, the lower the better
+    double score;
+  };
+
+  vpBarcodeLocalizer(const vpBarcodeType &type = QR_CODE);
+  virtual ~vpBarcodeLocalizer() {}
+
+  /*!
+    Return the downscaling factor of the image used for the localization.
+  */
+  inline unsigned int getDownscale() const { return m_downscale; }
+  /*!
+    Return the maximal number of candidates returned by locate().
+  */
+  inline unsigned int getMaxCandidates() const { return m_maxCandidates; }
+  /*!
+    Return the maximal number of QR code finder patterns combined by
+    locate().
+  */
+  inline unsigned int getMaxFinderPatterns() const { return m_maxFinderPatterns; }
+  /*!
+    Return the type of the codes to locate.
+  */
+  inline vpBarcodeType getType() const { return m_type; }
+
+  void locate(const vpImage<unsigned char> &I, std::vector<vpCandidate> &candidates);
+
+  void rectify(const vpImage<unsigned char> &I, const vpCandidate &candidate, vpImage<unsigned char> &Icode,
+               vpHomography &codeToImage) const;
+
+  void setDownscale(unsigned int downscale);
+  /*!
+    Set the maximal number of candidates returned by locate(), the
+    candidates with the lowest scores being kept. By default 16.
+  */
+  inline void setMaxCandidates(unsigned int maxCandidates) { m_maxCandidates = maxCandidates; }
+  /*!
+    Set the maximal number of QR code finder patterns combined into triplets
+    by locate(), the patterns found on the most rows being kept. The number
+    of triplets to check grows with the cube of this number. By default 64.
+  */
+  inline void setMaxFinderPatterns(unsigned int maxPatterns) { m_maxFinderPatterns = maxPatterns; }
+  /*!
+    Set the type of the codes to locate.
+  */
+  inline void setType(const vpBarcodeType &type) { m_type = type; }
+
+private:
+  //! Finder pattern of a QR code, in the downscaled image
+  struct vpFinderPattern {
+    double u;
+    double v;
+    double moduleSize;
+    unsigned int count;
+  };
+
+  void binarize(const vpImage<unsigned char> &I);
+  bool checkColumn(double u, double v, double moduleSize, double &vc, double &total) const;
+  bool checkRow(double u, double v, double moduleSize, double &uc, double &total) const;
+  void locateDataMatrix(std::vector<vpCandidate> &candidates);
+  void locateQRCode(std::vector<vpCandidate> &candidates);
+  void scanRow(unsigned int i, std::vector<vpFinderPattern> &patterns) const;
+
+  vpBarcodeType m_type;
+  unsigned int m_downscale;
+  unsigned int m_maxCandidates;
+  unsigned int m_maxFinderPatterns;
+  //! Downscaled image
+  vpImage<unsigned char> m_Ismall;
+  //! Binarized downscaled image, 1 for dark pixels
+  vpImage<unsigned char> m_Ibinary;
+  //! Integral image of the downscaled image
+  std::vector<double> m_integral;
+  //! Labels of the dark components, for the Data Matrix codes
+  std::vector<int> m_labels;
+};
+
+#endif
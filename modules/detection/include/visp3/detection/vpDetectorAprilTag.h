@@ -157,6 +157,18 @@ Tag number 1:
   Tag Id: 1
 \endcode
 
+  The detector is designed to process video streams: the buffers used to
+  wrap the image, to store the polygons, the messages and the poses of the
+  tags are reused from one call to detect() to another, and only the
+  initial poses required by the pose estimation method are computed. The
+  time spent by the last detection in the quad detection, the decoding and
+  the pose estimation is given by getQuadDetectionTime(), getDecodingTime()
+  and getPoseTime().
+
+  In a video, the tags can also be searched only around their location in
+  the previous image, the whole image being processed periodically or when
+  a tag is lost (see setAprilTagRoiTracking()).
+
   Other examples are also provided in tutorial-apriltag-detector.cpp and
   tutorial-apriltag-detector-live.cpp
 */
@@ -205,11 +217,18 @@ public:
   bool detect(const vpImage<unsigned char> &I, const double tagSize, const vpCameraParameters &cam,
               std::vector<vpHomogeneousMatrix> &cMo_vec);
 
+  double getDecodingTime() const;
+
   /*!
     Return the pose estimation method.
   */
   inline vpPoseEstimationMethod getPoseEstimationMethod() const { return m_poseEstimationMethod; }
 
+  double getPoseTime() const;
+  double getQuadDetectionTime() const;
+
+  bool isRoiDetection() const;
+
   void setAprilTagNbThreads(const int nThreads);
   void setAprilTagPoseEstimationMethod(const vpPoseEstimationMethod &poseEstimationMethod);
   void setAprilTagQuadDecimate(const float quadDecimate);
@@ -217,6 +236,8 @@ public:
   void setAprilTagRefineDecode(const bool refineDecode);
   void setAprilTagRefineEdges(const bool refineEdges);
   void setAprilTagRefinePose(const bool refinePose);
+  void setAprilTagRoiTracking(const bool roiTracking, const unsigned int fullFrameInterval = 10,
+                              const double roiMargin = 0.5);
 
   /*! Allow to enable the display of overlay tag information in the windows
    * (vpDisplay) associated to the input image. */
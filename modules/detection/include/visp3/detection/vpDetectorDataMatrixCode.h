@@ -48,6 +48,7 @@
 #ifdef VISP_HAVE_DMTX
 
 #include <visp3/core/vpImage.h>
+#include <visp3/detection/vpBarcodeLocalizer.h>
 #include <visp3/detection/vpDetectorBase.h>
 
 /*!
@@ -109,13 +110,40 @@ Bar code 1:
   Other examples are also provided in tutorial-barcode-detector.cpp and
   tutorial-barcode-detector-live.cpp
 
+  On large images, libdmtx searching the whole image is slow. When the
+  localization is enabled with setLocalization(), the candidate codes are
+  first located by their L-pattern with vpBarcodeLocalizer, and only a small
+  rectified image of each candidate is given to libdmtx. The time spent in
+  the detection can be bounded with setTimeBudget().
+
  */
 class VISP_EXPORT vpDetectorDataMatrixCode : public vpDetectorBase
 {
+protected:
+  vpBarcodeLocalizer m_localizer; //!< Localizer of the candidate codes.
+  bool m_useLocalization;         //!< Decode only the located candidates.
+  double m_timeBudget;            //!< Time budget in ms, 0 if unlimited.
+
 public:
   vpDetectorDataMatrixCode();
   virtual ~vpDetectorDataMatrixCode(){};
   bool detect(const vpImage<unsigned char> &I);
+
+  /*!
+    Return true if only the candidates located by vpBarcodeLocalizer are
+    decoded.
+  */
+  inline bool getLocalization() const { return m_useLocalization; }
+  /*!
+    Return the time budget in ms of the detection, 0 if unlimited.
+  */
+  inline double getTimeBudget() const { return m_timeBudget; }
+
+  void setLocalization(bool useLocalization, unsigned int downscale = 2);
+  void setTimeBudget(double timeBudget);
+
+protected:
+  bool decode(const vpImage<unsigned char> &I, vpHomography &codeToImage, bool singleCode, double t0);
 };
 
 #endif
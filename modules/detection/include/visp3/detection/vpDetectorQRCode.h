@@ -50,6 +50,7 @@
 #include <zbar.h>
 
 #include <visp3/core/vpImage.h>
+#include <visp3/detection/vpBarcodeLocalizer.h>
 #include <visp3/detection/vpDetectorBase.h>
 
 /*!
@@ -110,16 +111,42 @@ Bar code 1:
 
   Other examples are also provided in tutorial-barcode-detector.cpp and
   tutorial-barcode-detector-live.cpp
+
+  On large images, zbar scanning the whole image is slow. When the
+  localization is enabled with setLocalization(), the candidate codes are
+  first located by their finder patterns with vpBarcodeLocalizer, and only a
+  small rectified image of each candidate is given to zbar. A time budget
+  for the decoding of the candidates can be set with setTimeBudget().
  */
 class VISP_EXPORT vpDetectorQRCode : public vpDetectorBase
 {
 protected:
   zbar::ImageScanner m_scanner; //!< QR code detector.
+  vpBarcodeLocalizer m_localizer; //!< Localizer of the candidate codes.
+  bool m_useLocalization;         //!< Decode only the located candidates.
+  double m_timeBudget;            //!< Time budget in ms, 0 if unlimited.
 
 public:
   vpDetectorQRCode();
   virtual ~vpDetectorQRCode(){};
   bool detect(const vpImage<unsigned char> &I);
+
+  /*!
+    Return true if only the candidates located by vpBarcodeLocalizer are
+    decoded.
+  */
+  inline bool getLocalization() const { return m_useLocalization; }
+  /*!
+    Return the time budget in ms of the decoding of the candidates, 0 if
+    unlimited.
+  */
+  inline double getTimeBudget() const { return m_timeBudget; }
+
+  void setLocalization(bool useLocalization, unsigned int downscale = 2);
+  void setTimeBudget(double timeBudget);
+
+protected:
+  bool scan(const vpImage<unsigned char> &I, vpHomography &codeToImage);
 };
 
 #endif
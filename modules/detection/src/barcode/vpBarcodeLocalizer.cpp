@@ -0,0 +1,772 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Fast localization of QR codes and Data Matrix codes.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/detection/vpBarcodeLocalizer.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Number of rows of the downscaled image scanned by a task
+const unsigned int rowsPerTask = 16;
+
+// Dark, light, dark, light and dark runs in the 1:1:3:1:1 ratio of a finder
+// pattern, with a tolerance of half a module
+bool isFinderPattern(const double runs[5])
+{
+  double total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+  if (total < 7.) {
+    return false;
+  }
+  double moduleSize = total / 7., maxVariance = moduleSize / 2.;
+  return std::fabs(moduleSize - runs[0]) < maxVariance && std::fabs(moduleSize - runs[1]) < maxVariance &&
+         std::fabs(3. * moduleSize - runs[2]) < 3. * maxVariance && std::fabs(moduleSize - runs[3]) < maxVariance &&
+         std::fabs(moduleSize - runs[4]) < maxVariance;
+}
+
+struct vpPoint2 {
+  double x;
+  double y;
+};
+
+bool pointOrder(const vpPoint2 &a, const vpPoint2 &b) { return a.x < b.x || (a.x == b.x && a.y < b.y); }
+
+double cross(const vpPoint2 &o, const vpPoint2 &a, const vpPoint2 &b)
+{
+  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+// Convex hull by the monotone chain algorithm, counter-clockwise
+void convexHull(std::vector<vpPoint2> &points, std::vector<vpPoint2> &hull)
+{
+  std::sort(points.begin(), points.end(), pointOrder);
+  hull.assign(2 * points.size(), vpPoint2());
+  size_t k = 0;
+  for (size_t i = 0; i < points.size(); i++) {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+      k--;
+    }
+    hull[k++] = points[i];
+  }
+  for (size_t i = points.size() - 1, t = k + 1; i > 0; i--) {
+    while (k >= t && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) {
+      k--;
+    }
+    hull[k++] = points[i - 1];
+  }
+  hull.resize(k > 0 ? k - 1 : 0);
+}
+
+struct vpTriplet {
+  unsigned int a, b, c; // a at the right angle
+  double score;
+};
+
+bool tripletOrder(const vpTriplet &t1, const vpTriplet &t2) { return t1.score < t2.score; }
+
+// Finder patterns found on the most rows first
+template <typename Type> bool finderPatternOrder(const Type &p1, const Type &p2) { return p1.count > p2.count; }
+
+bool candidateOrder(const vpBarcodeLocalizer::vpCandidate &c1, const vpBarcodeLocalizer::vpCandidate &c2)
+{
+  return c1.score < c2.score;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Constructor.
+
+  \param type : Type of the codes to locate.
+*/
+vpBarcodeLocalizer::vpBarcodeLocalizer(const vpBarcodeType &type)
+  : m_type(type), m_downscale(2), m_maxCandidates(16), m_maxFinderPatterns(64), m_Ismall(), m_Ibinary(), m_integral(),
+    m_labels()
+{
+}
+
+/*!
+  Downscale the image and binarize it with a threshold relative to the mean
+  value of a window around each pixel, whose size is the sixteenth of the
+  image size.
+*/
+void vpBarcodeLocalizer::binarize(const vpImage<unsigned char> &I)
+{
+  unsigned int f = m_downscale;
+  unsigned int w = I.getWidth() / f, h = I.getHeight() / f;
+  m_Ismall.resize(h, w);
+  m_Ibinary.resize(h, w);
+  if (w == 0 || h == 0) {
+    return;
+  }
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)h; i++) {
+    for (unsigned int j = 0; j < w; j++) {
+      unsigned int sum = 0;
+      for (unsigned int di = 0; di < f; di++) {
+        const unsigned char *row = I[i * f + di] + j * f;
+        for (unsigned int dj = 0; dj < f; dj++) {
+          sum += row[dj];
+        }
+      }
+      m_Ismall[i][j] = (unsigned char)(sum / (f * f));
+    }
+  }
+
+  // Integral image, with a row and a column of zeros
+  m_integral.assign((size_t)(w + 1) * (h + 1), 0.);
+  for (unsigned int i = 0; i < h; i++) {
+    double rowSum = 0.;
+    const double *previous = &m_integral[(size_t)i * (w + 1)];
+    double *integral = &m_integral[(size_t)(i + 1) * (w + 1)];
+    for (unsigned int j = 0; j < w; j++) {
+      rowSum += m_Ismall[i][j];
+      integral[j + 1] = previous[j + 1] + rowSum;
+    }
+  }
+
+  int r = (int)std::max(8u, std::max(w, h) / 16);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for
+#endif
+  for (int i = 0; i < (int)h; i++) {
+    int top = std::max(i - r, 0), bottom = std::min(i + r + 1, (int)h);
+    const double *integralTop = &m_integral[(size_t)top * (w + 1)];
+    const double *integralBottom = &m_integral[(size_t)bottom * (w + 1)];
+    for (int j = 0; j < (int)w; j++) {
+      int left = std::max(j - r, 0), right = std::min(j + r + 1, (int)w);
+      double sum = integralBottom[right] - integralBottom[left] - integralTop[right] + integralTop[left];
+      double area = (double)((bottom - top) * (right - left));
+      // Dark when 10% under the local mean
+      m_Ibinary[i][j] = 10. * m_Ismall[i][j] * area < 9. * sum ? 1 : 0;
+    }
+  }
+}
+
+/*!
+  Check the finder pattern along the column of a pixel, and give the
+  vertical center of the pattern and its total size.
+*/
+bool vpBarcodeLocalizer::checkColumn(double u, double v, double moduleSize, double &vc, double &total) const
+{
+  int j = (int)u, i = (int)v, h = (int)m_Ibinary.getHeight();
+  if (j < 0 || j >= (int)m_Ibinary.getWidth() || i < 0 || i >= h || !m_Ibinary[i][j]) {
+    return false;
+  }
+
+  int maxCount = (int)(5. * moduleSize) + 2;
+  double runs[5] = {0., 0., 0., 0., 0.};
+  int k = i;
+  for (; k >= 0 && m_Ibinary[k][j]; k--) {
+    runs[2]++;
+  }
+  int top = k + 1;
+  for (; k >= 0 && !m_Ibinary[k][j] && runs[1] <= maxCount; k--) {
+    runs[1]++;
+  }
+  for (; k >= 0 && m_Ibinary[k][j] && runs[0] <= maxCount; k--) {
+    runs[0]++;
+  }
+  k = i + 1;
+  for (; k < h && m_Ibinary[k][j]; k++) {
+    runs[2]++;
+  }
+  int bottom = k;
+  for (; k < h && !m_Ibinary[k][j] && runs[3] <= maxCount; k++) {
+    runs[3]++;
+  }
+  for (; k < h && m_Ibinary[k][j] && runs[4] <= maxCount; k++) {
+    runs[4]++;
+  }
+
+  total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+  if (!isFinderPattern(runs) || total < 3.5 * moduleSize || total > 14. * moduleSize) {
+    return false;
+  }
+  vc = (top + bottom) / 2.;
+  return true;
+}
+
+/*!
+  Check the finder pattern along the row of a pixel, and give the
+  horizontal center of the pattern and its total size.
+*/
+bool vpBarcodeLocalizer::checkRow(double u, double v, double moduleSize, double &uc, double &total) const
+{
+  int j = (int)u, i = (int)v, w = (int)m_Ibinary.getWidth();
+  if (i < 0 || i >= (int)m_Ibinary.getHeight() || j < 0 || j >= w || !m_Ibinary[i][j]) {
+    return false;
+  }
+
+  const unsigned char *row = m_Ibinary[i];
+  int maxCount = (int)(5. * moduleSize) + 2;
+  double runs[5] = {0., 0., 0., 0., 0.};
+  int k = j;
+  for (; k >= 0 && row[k]; k--) {
+    runs[2]++;
+  }
+  int left = k + 1;
+  for (; k >= 0 && !row[k] && runs[1] <= maxCount; k--) {
+    runs[1]++;
+  }
+  for (; k >= 0 && row[k] && runs[0] <= maxCount; k--) {
+    runs[0]++;
+  }
+  k = j + 1;
+  for (; k < w && row[k]; k++) {
+    runs[2]++;
+  }
+  int right = k;
+  for (; k < w && !row[k] && runs[3] <= maxCount; k++) {
+    runs[3]++;
+  }
+  for (; k < w && row[k] && runs[4] <= maxCount; k++) {
+    runs[4]++;
+  }
+
+  total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+  if (!isFinderPattern(runs) || total < 3.5 * moduleSize || total > 14. * moduleSize) {
+    return false;
+  }
+  uc = (left + right) / 2.;
+  return true;
+}
+
+/*!
+  Locate the candidate codes in an image.
+
+  \param I : Input image.
+  \param candidates : Candidate codes sorted by increasing score, at most
+  getMaxCandidates().
+*/
+void vpBarcodeLocalizer::locate(const vpImage<unsigned char> &I, std::vector<vpCandidate> &candidates)
+{
+  candidates.clear();
+  binarize(I);
+  if (m_Ibinary.getWidth() < 8 || m_Ibinary.getHeight() < 8) {
+    return;
+  }
+
+  if (m_type == QR_CODE) {
+    locateQRCode(candidates);
+  } else {
+    locateDataMatrix(candidates);
+  }
+
+  std::sort(candidates.begin(), candidates.end(), candidateOrder);
+  if (candidates.size() > m_maxCandidates) {
+    candidates.resize(m_maxCandidates);
+  }
+
+  // From the downscaled image to the image
+  double f = (double)m_downscale;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    for (unsigned int k = 0; k < 4; k++) {
+      vpImagePoint &corner = candidates[i].corners[k];
+      corner.set_ij(corner.get_i() * f - 0.5, corner.get_j() * f - 0.5);
+    }
+    candidates[i].moduleSize *= f;
+  }
+}
+
+/*!
+  Locate the Data Matrix codes by the L-pattern of the dark components.
+*/
+void vpBarcodeLocalizer::locateDataMatrix(std::vector<vpCandidate> &candidates)
+{
+  int w = (int)m_Ibinary.getWidth(), h = (int)m_Ibinary.getHeight();
+
+  // Dark components in 8-connectivity
+  m_labels.assign((size_t)w * h, -1);
+  std::vector<int> sizes, lefts, rights, tops, bottoms;
+  std::vector<int> stack;
+  for (int i = 0; i < h; i++) {
+    for (int j = 0; j < w; j++) {
+      if (!m_Ibinary[i][j] || m_labels[(size_t)i * w + j] >= 0) {
+        continue;
+      }
+      int label = (int)sizes.size();
+      sizes.push_back(0);
+      lefts.push_back(j);
+      rights.push_back(j);
+      tops.push_back(i);
+      bottoms.push_back(i);
+      m_labels[(size_t)i * w + j] = label;
+      stack.push_back(i * w + j);
+      while (!stack.empty()) {
+        int p = stack.back();
+        stack.pop_back();
+        int pi = p / w, pj = p % w;
+        sizes[label]++;
+        lefts[label] = std::min(lefts[label], pj);
+        rights[label] = std::max(rights[label], pj);
+        bottoms[label] = std::max(bottoms[label], pi);
+        for (int di = -1; di <= 1; di++) {
+          for (int dj = -1; dj <= 1; dj++) {
+            int ni = pi + di, nj = pj + dj;
+            if (ni >= 0 && ni < h && nj >= 0 && nj < w && m_Ibinary[ni][nj] && m_labels[(size_t)ni * w + nj] < 0) {
+              m_labels[(size_t)ni * w + nj] = label;
+              stack.push_back(ni * w + nj);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<int> components;
+  for (int c = 0; c < (int)sizes.size(); c++) {
+    int bw = rights[c] - lefts[c] + 1, bh = bottoms[c] - tops[c] + 1;
+    if (sizes[c] >= 30 && bw >= 6 && bh >= 6 && bw < w / 2 && bh < h / 2) {
+      components.push_back(c);
+    }
+  }
+
+  std::vector<vpCandidate> found(components.size());
+  std::vector<unsigned char> valid(components.size(), 0);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int n = 0; n < (int)components.size(); n++) {
+    int c = components[n];
+
+    // Outline of the component, then minimal area rectangle of its hull
+    std::vector<vpPoint2> points, hull;
+    for (int i = tops[c]; i <= bottoms[c]; i++) {
+      const int *labels = &m_labels[(size_t)i * w];
+      int left = lefts[c], right = rights[c];
+      while (left <= right && labels[left] != c) {
+        left++;
+      }
+      while (right >= left && labels[right] != c) {
+        right--;
+      }
+      if (left > right) {
+        continue;
+      }
+      vpPoint2 p;
+      p.x = left;
+      p.y = i;
+      points.push_back(p);
+      p.y = i + 1;
+      points.push_back(p);
+      p.x = right + 1;
+      points.push_back(p);
+      p.y = i;
+      points.push_back(p);
+    }
+    convexHull(points, hull);
+
+    double bestArea = -1., rect[4][2] = {{0., 0.}, {0., 0.}, {0., 0.}, {0., 0.}};
+    double sideU = 0., sideV = 0.;
+    for (size_t k = 0; k < hull.size(); k++) {
+      const vpPoint2 &p0 = hull[k], &p1 = hull[(k + 1) % hull.size()];
+      double ux = p1.x - p0.x, uy = p1.y - p0.y, norm = std::sqrt(ux * ux + uy * uy);
+      if (norm <= 0.) {
+        continue;
+      }
+      ux /= norm;
+      uy /= norm;
+      double minU = 0., maxU = 0., minV = 0., maxV = 0.;
+      for (size_t m = 0; m < hull.size(); m++) {
+        double pu = hull[m].x * ux + hull[m].y * uy, pv = -hull[m].x * uy + hull[m].y * ux;
+        if (m == 0 || pu < minU)
+          minU = pu;
+        if (m == 0 || pu > maxU)
+          maxU = pu;
+        if (m == 0 || pv < minV)
+          minV = pv;
+        if (m == 0 || pv > maxV)
+          maxV = pv;
+      }
+      double area = (maxU - minU) * (maxV - minV);
+      if (bestArea < 0. || area < bestArea) {
+        bestArea = area;
+        sideU = maxU - minU;
+        sideV = maxV - minV;
+        double us[4] = {minU, maxU, maxU, minU}, vs[4] = {minV, minV, maxV, maxV};
+        for (int q = 0; q < 4; q++) {
+          rect[q][0] = us[q] * ux - vs[q] * uy;
+          rect[q][1] = us[q] * uy + vs[q] * ux;
+        }
+      }
+    }
+    double fill = bestArea > 0. ? sizes[c] / bestArea : 0.;
+    if (sideU < 6. || sideV < 6. || sideU > 3. * sideV || sideV > 3. * sideU || fill < 0.3 || fill > 0.9) {
+      continue;
+    }
+
+    // Dark ratio and number of transitions along the sides, slightly inside
+    // the rectangle
+    double cx = (rect[0][0] + rect[2][0]) / 2., cy = (rect[0][1] + rect[2][1]) / 2.;
+    double inset = std::max(0.75, 0.03 * std::min(sideU, sideV));
+    double darkRatio[4], length[4];
+    unsigned int transitions[4];
+    for (int k = 0; k < 4; k++) {
+      const double *p0 = rect[k], *p1 = rect[(k + 1) % 4];
+      double dx = p1[0] - p0[0], dy = p1[1] - p0[1];
+      length[k] = std::sqrt(dx * dx + dy * dy);
+      // Inward normal
+      double nx = -dy / length[k], ny = dx / length[k];
+      if (nx * (cx - p0[0]) + ny * (cy - p0[1]) < 0.) {
+        nx = -nx;
+        ny = -ny;
+      }
+      unsigned int nbSamples = (unsigned int)(2. * length[k]) + 1, nbDark = 0, nbValid = 0;
+      transitions[k] = 0;
+      int previous = -1;
+      for (unsigned int s = 0; s < nbSamples; s++) {
+        double t = 0.05 + 0.9 * s / nbSamples;
+        int si = (int)std::floor(p0[1] + t * dy + inset * ny), sj = (int)std::floor(p0[0] + t * dx + inset * nx);
+        if (si < 0 || si >= h || sj < 0 || sj >= w) {
+          continue;
+        }
+        int dark = m_Ibinary[si][sj];
+        nbDark += (unsigned int)dark;
+        nbValid++;
+        if (previous >= 0 && dark != previous) {
+          transitions[k]++;
+        }
+        previous = dark;
+      }
+      darkRatio[k] = nbValid > 0 ? (double)nbDark / nbValid : 0.;
+    }
+
+    for (int k = 0; k < 4; k++) {
+      // Solid sides k-1 and k around corner k, alternating sides k+1 and k+2
+      // A code has at least 8 modules per side, and the same module size
+      // along its two alternating sides
+      int previous = (k + 3) % 4, next = (k + 1) % 4, opposite = (k + 2) % 4;
+      if (darkRatio[previous] < 0.8 || darkRatio[k] < 0.8 || transitions[next] < 6 || transitions[opposite] < 6 ||
+          darkRatio[next] < 0.3 || darkRatio[next] > 0.7 || darkRatio[opposite] < 0.3 ||
+          darkRatio[opposite] > 0.7) {
+        continue;
+      }
+      double moduleNext = length[next] / transitions[next], moduleOpposite = length[opposite] / transitions[opposite];
+      if (moduleNext > 1.3 * moduleOpposite || moduleOpposite > 1.3 * moduleNext) {
+        continue;
+      }
+
+      // In the order of libdmtx: the end of the bottom side of an upright
+      // code comes first
+      int first = next, last = previous;
+      const double *p0 = rect[k], *p1 = rect[first], *p3 = rect[last];
+      if ((p1[0] - p0[0]) * (p3[1] - p0[1]) - (p1[1] - p0[1]) * (p3[0] - p0[0]) > 0.) {
+        std::swap(first, last);
+      }
+      vpCandidate &candidate = found[(size_t)n];
+      int order[4] = {k, first, opposite, last};
+      for (int q = 0; q < 4; q++) {
+        candidate.corners[q].set_ij(rect[order[q]][1], rect[order[q]][0]);
+      }
+      // An alternating side has a transition between each module
+      double nbModules = (transitions[next] + transitions[opposite]) / (2. * 0.9) + 1.;
+      candidate.moduleSize = (length[next] + length[opposite]) / (2. * nbModules);
+      candidate.score = (1. - darkRatio[previous]) + (1. - darkRatio[k]) + std::fabs(0.5 - darkRatio[next]) +
+                        std::fabs(0.5 - darkRatio[opposite]);
+      valid[(size_t)n] = 1;
+      break;
+    }
+  }
+
+  for (size_t n = 0; n < found.size(); n++) {
+    if (valid[n]) {
+      candidates.push_back(found[n]);
+    }
+  }
+}
+
+/*!
+  Locate the QR codes by their finder patterns.
+*/
+void vpBarcodeLocalizer::locateQRCode(std::vector<vpCandidate> &candidates)
+{
+  unsigned int h = m_Ibinary.getHeight();
+  int nbTasks = (int)((h + rowsPerTask - 1) / rowsPerTask);
+  std::vector<std::vector<vpFinderPattern> > taskPatterns((size_t)nbTasks);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int t = 0; t < nbTasks; t++) {
+    for (unsigned int i = t * rowsPerTask; i < std::min(h, (t + 1) * rowsPerTask); i++) {
+      scanRow(i, taskPatterns[(size_t)t]);
+    }
+  }
+
+  // A finder pattern is found on several rows
+  std::vector<vpFinderPattern> patterns;
+  for (size_t t = 0; t < taskPatterns.size(); t++) {
+    for (size_t n = 0; n < taskPatterns[t].size(); n++) {
+      const vpFinderPattern &p = taskPatterns[t][n];
+      bool merged = false;
+      for (size_t k = 0; k < patterns.size() && !merged; k++) {
+        vpFinderPattern &q = patterns[k];
+        double distance = std::max(q.moduleSize, 1.) * 2.;
+        if (std::fabs(q.u - p.u) <= distance && std::fabs(q.v - p.v) <= distance &&
+            p.moduleSize < 1.5 * q.moduleSize && q.moduleSize < 1.5 * p.moduleSize) {
+          double count = q.count;
+          q.u = (q.u * count + p.u) / (count + 1.);
+          q.v = (q.v * count + p.v) / (count + 1.);
+          q.moduleSize = (q.moduleSize * count + p.moduleSize) / (count + 1.);
+          q.count++;
+          merged = true;
+        }
+      }
+      if (!merged) {
+        patterns.push_back(p);
+      }
+    }
+  }
+
+  std::vector<vpFinderPattern> confirmed;
+  for (size_t k = 0; k < patterns.size(); k++) {
+    if (patterns[k].count >= 2) {
+      confirmed.push_back(patterns[k]);
+    }
+  }
+  // Bound the number of triplets, keeping the most reliable patterns
+  if (confirmed.size() > m_maxFinderPatterns) {
+    std::stable_sort(confirmed.begin(), confirmed.end(), finderPatternOrder<vpFinderPattern>);
+    confirmed.resize(m_maxFinderPatterns);
+  }
+
+  // Triplets forming a right isosceles triangle
+  std::vector<vpTriplet> triplets;
+  unsigned int n = (unsigned int)confirmed.size();
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = i + 1; j < n; j++) {
+      for (unsigned int k = j + 1; k < n; k++) {
+        const unsigned int ids[3] = {i, j, k};
+        double mi = confirmed[i].moduleSize, mj = confirmed[j].moduleSize, mk = confirmed[k].moduleSize;
+        double minModule = std::min(mi, std::min(mj, mk)), maxModule = std::max(mi, std::max(mj, mk));
+        if (maxModule > 1.5 * minModule) {
+          continue;
+        }
+        double moduleSize = (mi + mj + mk) / 3.;
+
+        vpTriplet best;
+        best.score = -1.;
+        for (unsigned int r = 0; r < 3; r++) {
+          const vpFinderPattern &a = confirmed[ids[r]], &b = confirmed[ids[(r + 1) % 3]],
+                                &c = confirmed[ids[(r + 2) % 3]];
+          double abx = b.u - a.u, aby = b.v - a.v, acx = c.u - a.u, acy = c.v - a.v;
+          double ab = std::sqrt(abx * abx + aby * aby), ac = std::sqrt(acx * acx + acy * acy);
+          if (ab < 10. * moduleSize || ac < 10. * moduleSize || ab > 180. * moduleSize || ac > 180. * moduleSize) {
+            continue;
+          }
+          double ratio = ab / ac, cosine = (abx * acx + aby * acy) / (ab * ac);
+          if (ratio < 0.75 || ratio > 1. / 0.75 || std::fabs(cosine) > 0.3) {
+            continue;
+          }
+          double score = std::fabs(1. - ratio) + std::fabs(cosine);
+          if (best.score < 0. || score < best.score) {
+            best.a = ids[r];
+            best.b = ids[(r + 1) % 3];
+            best.c = ids[(r + 2) % 3];
+            best.score = score;
+          }
+        }
+        if (best.score >= 0.) {
+          triplets.push_back(best);
+        }
+      }
+    }
+  }
+
+  // Each finder pattern belongs to a single code
+  std::sort(triplets.begin(), triplets.end(), tripletOrder);
+  std::vector<unsigned char> used(n, 0);
+  for (size_t t = 0; t < triplets.size(); t++) {
+    vpTriplet triplet = triplets[t];
+    if (used[triplet.a] || used[triplet.b] || used[triplet.c]) {
+      continue;
+    }
+    used[triplet.a] = used[triplet.b] = used[triplet.c] = 1;
+
+    const vpFinderPattern *a = &confirmed[triplet.a], *b = &confirmed[triplet.b], *c = &confirmed[triplet.c];
+    // Top right finder pattern first: clockwise in the image
+    if ((b->u - a->u) * (c->v - a->v) - (b->v - a->v) * (c->u - a->u) < 0.) {
+      std::swap(b, c);
+    }
+    double abx = b->u - a->u, aby = b->v - a->v, acx = c->u - a->u, acy = c->v - a->v;
+    double ab = std::sqrt(abx * abx + aby * aby), ac = std::sqrt(acx * acx + acy * acy);
+    // The runs along the rows and the columns are longer than the finder
+    // patterns of a rotated code, up to sqrt(2) times at 45 degrees
+    double moduleSize = (a->moduleSize + b->moduleSize + c->moduleSize) / 3. *
+                        std::max(std::fabs(abx) / ab, std::fabs(aby) / ab);
+    // The centers of the finder patterns are 3.5 modules inside the code
+    double d = 3.5 * moduleSize;
+    double ux = abx / ab * d, uy = aby / ab * d, vx = acx / ac * d, vy = acy / ac * d;
+
+    vpCandidate candidate;
+    double topLeftU = a->u - ux - vx, topLeftV = a->v - uy - vy;
+    double topRightU = b->u + ux - vx, topRightV = b->v + uy - vy;
+    double bottomLeftU = c->u - ux + vx, bottomLeftV = c->v - uy + vy;
+    candidate.corners[0].set_ij(topLeftV, topLeftU);
+    candidate.corners[1].set_ij(topRightV, topRightU);
+    candidate.corners[2].set_ij(topRightV + bottomLeftV - topLeftV, topRightU + bottomLeftU - topLeftU);
+    candidate.corners[3].set_ij(bottomLeftV, bottomLeftU);
+    candidate.moduleSize = moduleSize;
+    candidate.score = triplet.score;
+    candidates.push_back(candidate);
+  }
+}
+
+/*!
+  Warp a candidate code into an upright image, with a quiet zone of 4
+  modules for a QR code and 2 modules for a Data Matrix code, at 4 pixels
+  per module.
+
+  \param I : Image where the candidate was located.
+  \param candidate : Candidate code.
+  \param Icode : Rectified image of the code. The pixels outside of \e I are
+  white.
+  \param codeToImage : Homography from the pixel coordinates in \e Icode to
+  the pixel coordinates in \e I, to get the location of the decoded code in
+  \e I.
+*/
+void vpBarcodeLocalizer::rectify(const vpImage<unsigned char> &I, const vpCandidate &candidate,
+                                 vpImage<unsigned char> &Icode, vpHomography &codeToImage) const
+{
+  const double pixelsPerModule = 4., maxSize = 1024.;
+  double quietZone = m_type == QR_CODE ? 4. : 2.;
+  double moduleSize = std::max(candidate.moduleSize, 1.);
+  double nbModulesU = std::max(vpImagePoint::distance(candidate.corners[0], candidate.corners[1]) / moduleSize, 1.);
+  double nbModulesV = std::max(vpImagePoint::distance(candidate.corners[0], candidate.corners[3]) / moduleSize, 1.);
+  double scale = pixelsPerModule;
+  if ((std::max(nbModulesU, nbModulesV) + 2. * quietZone) * scale > maxSize) {
+    scale = maxSize / (std::max(nbModulesU, nbModulesV) + 2. * quietZone);
+  }
+  unsigned int width = (unsigned int)std::ceil((nbModulesU + 2. * quietZone) * scale);
+  unsigned int height = (unsigned int)std::ceil((nbModulesV + 2. * quietZone) * scale);
+
+  // Corners in the rectified image: a QR code is clockwise from the top
+  // left corner, a Data Matrix code from the bottom left corner
+  double left = quietZone * scale - 0.5, top = left;
+  double right = left + nbModulesU * scale, bottom = top + nbModulesV * scale;
+  double codeU[4] = {left, right, right, left}, codeV[4] = {top, top, bottom, bottom};
+  if (m_type == DATA_MATRIX) {
+    codeV[0] = codeV[1] = bottom;
+    codeV[2] = codeV[3] = top;
+  }
+  std::vector<double> xb(codeU, codeU + 4), yb(codeV, codeV + 4), xa(4), ya(4);
+  for (unsigned int k = 0; k < 4; k++) {
+    xa[k] = candidate.corners[k].get_u();
+    ya[k] = candidate.corners[k].get_v();
+  }
+  vpHomography::DLT(xb, yb, xa, ya, codeToImage, true);
+
+  Icode.resize(height, width);
+  int w = (int)I.getWidth(), h = (int)I.getHeight();
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      double z = codeToImage[2][0] * j + codeToImage[2][1] * i + codeToImage[2][2];
+      double u = (codeToImage[0][0] * j + codeToImage[0][1] * i + codeToImage[0][2]) / z;
+      double v = (codeToImage[1][0] * j + codeToImage[1][1] * i + codeToImage[1][2]) / z;
+      int u0 = (int)std::floor(u), v0 = (int)std::floor(v);
+      if (u0 < 0 || v0 < 0 || u0 + 1 >= w || v0 + 1 >= h) {
+        Icode[i][j] = 255;
+        continue;
+      }
+      double du = u - u0, dv = v - v0;
+      double value = (1. - dv) * ((1. - du) * I[v0][u0] + du * I[v0][u0 + 1]) +
+                     dv * ((1. - du) * I[v0 + 1][u0] + du * I[v0 + 1][u0 + 1]);
+      Icode[i][j] = (unsigned char)(value + 0.5);
+    }
+  }
+}
+
+/*!
+  Scan a row of the binarized image for finder patterns.
+*/
+void vpBarcodeLocalizer::scanRow(unsigned int i, std::vector<vpFinderPattern> &patterns) const
+{
+  const unsigned char *row = m_Ibinary[i];
+  unsigned int w = m_Ibinary.getWidth();
+  double runs[5] = {0., 0., 0., 0., 0.};
+  unsigned int nbRuns = 0, length = 0;
+  unsigned char color = row[0];
+  for (unsigned int j = 0; j <= w; j++) {
+    if (j < w && row[j] == color) {
+      length++;
+      continue;
+    }
+
+    // End of a run
+    for (int k = 0; k < 4; k++) {
+      runs[k] = runs[k + 1];
+    }
+    runs[4] = length;
+    nbRuns++;
+    if (color && nbRuns >= 5 && isFinderPattern(runs)) {
+      double total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+      double moduleSize = total / 7., u = j - runs[4] - runs[3] - runs[2] / 2., v = i + 0.5;
+      double uc, vc, totalV, totalH;
+      if (checkColumn(u, v, moduleSize, vc, totalV) && checkRow(u, vc, moduleSize, uc, totalH)) {
+        vpFinderPattern pattern;
+        pattern.u = uc;
+        pattern.v = vc;
+        pattern.moduleSize = (totalV + totalH) / 14.;
+        pattern.count = 1;
+        patterns.push_back(pattern);
+      }
+    }
+    if (j < w) {
+      color = row[j];
+      length = 1;
+    }
+  }
+}
+
+/*!
+  Set the downscaling factor of the image used for the localization. The
+  modules of the codes have to be at least 2 pixels large in the
+  downscaled image. By default 2.
+
+  \exception vpException::badValue : The factor is null.
+*/
+void vpBarcodeLocalizer::setDownscale(unsigned int downscale)
+{
+  if (downscale == 0) {
+    throw vpException(vpException::badValue, "Bad downscaling factor: %u", downscale);
+  }
+  m_downscale = downscale;
+}
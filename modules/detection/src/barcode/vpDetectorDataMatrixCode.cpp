@@ -36,6 +36,7 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
 #include <assert.h>
 
 #include <visp3/core/vpConfig.h>
@@ -44,25 +45,73 @@
 
 #include <dmtx.h>
 
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/detection/vpDetectorDataMatrixCode.h>
 
 /*!
-   Default constructor that does nothing.
+   Default constructor.
  */
-vpDetectorDataMatrixCode::vpDetectorDataMatrixCode() {}
+vpDetectorDataMatrixCode::vpDetectorDataMatrixCode()
+  : m_localizer(vpBarcodeLocalizer::DATA_MATRIX), m_useLocalization(false), m_timeBudget(0.)
+{
+}
 
 /*!
   Detect datamatrix bar codes in the image. Return true if a bar code is
   detected, false otherwise.
 
+  When the localization is enabled (see setLocalization()), only the
+  candidates located by vpBarcodeLocalizer are decoded. The detection stops
+  once the time budget set by setTimeBudget() is spent.
+
   \param I : Input image.
  */
 bool vpDetectorDataMatrixCode::detect(const vpImage<unsigned char> &I)
 {
-  bool detected = false;
   m_message.clear();
   m_polygon.clear();
   m_nb_objects = 0;
+
+  double t0 = vpTime::measureTimeMs();
+  if (!m_useLocalization) {
+    vpHomography identity;
+    return decode(I, identity, false, t0);
+  }
+
+  std::vector<vpBarcodeLocalizer::vpCandidate> candidates;
+  m_localizer.locate(I, candidates);
+
+  bool detected = false;
+  vpImage<unsigned char> Icode;
+  vpHomography codeToImage;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (m_timeBudget > 0. && vpTime::measureTimeMs() - t0 > m_timeBudget) {
+      break;
+    }
+    m_localizer.rectify(I, candidates[i], Icode, codeToImage);
+    if (decode(Icode, codeToImage, true, t0)) {
+      detected = true;
+    }
+  }
+
+  return detected;
+}
+
+/*!
+  Search and decode the codes of an image with libdmtx, and add them to the
+  detected objects. Return true if a code is decoded, false otherwise.
+
+  \param I : Image to decode.
+  \param codeToImage : Homography that maps the decoded image into the
+  input image of detect(), used to express the polygons in the input image.
+  \param singleCode : When true, stop after the first decoded code.
+  \param t0 : Start time in ms of the detection, used with the time budget.
+ */
+bool vpDetectorDataMatrixCode::decode(const vpImage<unsigned char> &I, vpHomography &codeToImage, bool singleCode,
+                                      double t0)
+{
+  bool detected = false;
   DmtxRegion *reg;
   DmtxDecode *dec;
   DmtxImage *img;
@@ -74,9 +123,17 @@ bool vpDetectorDataMatrixCode::detect(const vpImage<unsigned char> &I)
   dec = dmtxDecodeCreate(img, 1);
   assert(dec != NULL);
 
+  // The search of the regions is stopped by libdmtx when the time budget is
+  // spent
+  DmtxTime timeout;
+  if (m_timeBudget > 0.) {
+    double remaining = std::max(m_timeBudget - (vpTime::measureTimeMs() - t0), 0.);
+    timeout = dmtxTimeAdd(dmtxTimeNow(), (long)remaining);
+  }
+
   bool end = false;
   do {
-    reg = dmtxRegionFindNext(dec, 0);
+    reg = dmtxRegionFindNext(dec, m_timeBudget > 0. ? &timeout : NULL);
 
     if (reg != NULL) {
       msg = dmtxDecodeMatrixRegion(dec, reg, DmtxUndefined);
@@ -93,16 +150,17 @@ bool vpDetectorDataMatrixCode::detect(const vpImage<unsigned char> &I)
         dmtxMatrix3VMultiplyBy(&p11, reg->fit2raw);
         dmtxMatrix3VMultiplyBy(&p01, reg->fit2raw);
 
-        polygon.push_back(vpImagePoint(I.getHeight() - p00.Y, p00.X));
-        polygon.push_back(vpImagePoint(I.getHeight() - p10.Y, p10.X));
-        polygon.push_back(vpImagePoint(I.getHeight() - p11.Y, p11.X));
-        polygon.push_back(vpImagePoint(I.getHeight() - p01.Y, p01.X));
+        polygon.push_back(codeToImage.projection(vpImagePoint(I.getHeight() - p00.Y, p00.X)));
+        polygon.push_back(codeToImage.projection(vpImagePoint(I.getHeight() - p10.Y, p10.X)));
+        polygon.push_back(codeToImage.projection(vpImagePoint(I.getHeight() - p11.Y, p11.X)));
+        polygon.push_back(codeToImage.projection(vpImagePoint(I.getHeight() - p01.Y, p01.X)));
 
         m_polygon.push_back(polygon);
         detected = true;
         m_message.push_back((const char *)msg->output);
 
         m_nb_objects++;
+        end = singleCode;
       } else {
         end = true;
       }
@@ -119,6 +177,38 @@ bool vpDetectorDataMatrixCode::detect(const vpImage<unsigned char> &I)
   return detected;
 }
 
+/*!
+  Enable or disable the localization of the candidate codes before their
+  decoding. It speeds up the detection in large images, where libdmtx
+  searching the whole image is slow. By default the localization is
+  disabled.
+
+  \param useLocalization : When true, only the candidates located by
+  vpBarcodeLocalizer are rectified and decoded.
+  \param downscale : Downscaling factor of the image used for the
+  localization (see vpBarcodeLocalizer::setDownscale()).
+ */
+void vpDetectorDataMatrixCode::setLocalization(bool useLocalization, unsigned int downscale)
+{
+  m_localizer.setDownscale(downscale);
+  m_useLocalization = useLocalization;
+}
+
+/*!
+  Set the time budget in ms of the detection. Once the budget is spent,
+  libdmtx stops searching the regions and the remaining candidates are not
+  decoded. By default 0, meaning unlimited.
+
+  \exception vpException::badValue : The time budget is negative.
+ */
+void vpDetectorDataMatrixCode::setTimeBudget(double timeBudget)
+{
+  if (timeBudget < 0.) {
+    throw vpException(vpException::badValue, "Bad time budget: %f", timeBudget);
+  }
+  m_timeBudget = timeBudget;
+}
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning:
 // libvisp_core.a(vpDetectorDataMatrixCode.cpp.o) has no symbols
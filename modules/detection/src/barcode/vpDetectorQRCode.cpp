@@ -40,12 +40,15 @@
 
 #ifdef VISP_HAVE_ZBAR
 
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/detection/vpDetectorQRCode.h>
 
 /*!
    Default constructor.
  */
-vpDetectorQRCode::vpDetectorQRCode() : m_scanner()
+vpDetectorQRCode::vpDetectorQRCode()
+  : m_scanner(), m_localizer(vpBarcodeLocalizer::QR_CODE), m_useLocalization(false), m_timeBudget(0.)
 {
   // configure the reader
   m_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
@@ -55,16 +58,56 @@ vpDetectorQRCode::vpDetectorQRCode() : m_scanner()
   Detect QR codes in the image. Return true if a code is detected, false
   otherwise.
 
+  When the localization is enabled (see setLocalization()), only the
+  candidates located by vpBarcodeLocalizer are decoded, until the time
+  budget set by setTimeBudget() is spent.
+
   \param I : Input image.
  */
 bool vpDetectorQRCode::detect(const vpImage<unsigned char> &I)
 {
-  bool detected = false;
   m_message.clear();
   m_polygon.clear();
   m_nb_objects = 0;
 
   m_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
+
+  if (!m_useLocalization) {
+    vpHomography identity;
+    return scan(I, identity);
+  }
+
+  double t0 = vpTime::measureTimeMs();
+  std::vector<vpBarcodeLocalizer::vpCandidate> candidates;
+  m_localizer.locate(I, candidates);
+
+  bool detected = false;
+  vpImage<unsigned char> Icode;
+  vpHomography codeToImage;
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (m_timeBudget > 0. && vpTime::measureTimeMs() - t0 > m_timeBudget) {
+      break;
+    }
+    m_localizer.rectify(I, candidates[i], Icode, codeToImage);
+    if (scan(Icode, codeToImage)) {
+      detected = true;
+    }
+  }
+
+  return detected;
+}
+
+/*!
+  Scan an image with zbar and add the decoded codes to the detected objects.
+  Return true if a code is decoded, false otherwise.
+
+  \param I : Image to scan.
+  \param codeToImage : Homography that maps the scanned image into the
+  input image of detect(), used to express the polygons in the input image.
+ */
+bool vpDetectorQRCode::scan(const vpImage<unsigned char> &I, vpHomography &codeToImage)
+{
+  bool detected = false;
   unsigned int width = I.getWidth();
   unsigned int height = I.getHeight();
 
@@ -72,7 +115,7 @@ bool vpDetectorQRCode::detect(const vpImage<unsigned char> &I)
   zbar::Image img(width, height, "Y800", I.bitmap, (unsigned long)(width * height));
 
   // scan the image for barcodes
-  m_nb_objects = (size_t)m_scanner.scan(img);
+  m_scanner.scan(img);
 
   // extract results
   for (zbar::Image::SymbolIterator symbol = img.symbol_begin(); symbol != img.symbol_end(); ++symbol) {
@@ -81,9 +124,11 @@ bool vpDetectorQRCode::detect(const vpImage<unsigned char> &I)
 
     std::vector<vpImagePoint> polygon;
     for (unsigned int i = 0; i < (unsigned int)symbol->get_location_size(); i++) {
-      polygon.push_back(vpImagePoint(symbol->get_location_y(i), symbol->get_location_x(i)));
+      vpImagePoint ip(symbol->get_location_y(i), symbol->get_location_x(i));
+      polygon.push_back(codeToImage.projection(ip));
     }
     m_polygon.push_back(polygon);
+    m_nb_objects++;
   }
 
   // clean up
@@ -91,6 +136,39 @@ bool vpDetectorQRCode::detect(const vpImage<unsigned char> &I)
 
   return detected;
 }
+
+/*!
+  Enable or disable the localization of the candidate codes before their
+  decoding. It speeds up the detection in large images, where zbar scanning
+  the whole image is slow. By default the localization is disabled.
+
+  \param useLocalization : When true, only the candidates located by
+  vpBarcodeLocalizer are rectified and decoded.
+  \param downscale : Downscaling factor of the image used for the
+  localization (see vpBarcodeLocalizer::setDownscale()).
+ */
+void vpDetectorQRCode::setLocalization(bool useLocalization, unsigned int downscale)
+{
+  m_localizer.setDownscale(downscale);
+  m_useLocalization = useLocalization;
+}
+
+/*!
+  Set the time budget in ms of the decoding of the located candidates. Once
+  the budget is spent, the remaining candidates are not decoded. The
+  candidates being sorted by score, the most likely codes are decoded
+  first. Only used when the localization is enabled. By default 0, meaning
+  unlimited.
+
+  \exception vpException::badValue : The time budget is negative.
+ */
+void vpDetectorQRCode::setTimeBudget(double timeBudget)
+{
+  if (timeBudget < 0.) {
+    throw vpException(vpException::badValue, "Bad time budget: %f", timeBudget);
+  }
+  m_timeBudget = timeBudget;
+}
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning: libvisp_core.a(vpDetectorQRCode.cpp.o) has
 // no symbols
@@ -35,7 +35,12 @@
 #include <visp3/core/vpConfig.h>
 
 #ifdef VISP_HAVE_APRILTAG
-#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <sstream>
 
 #include <apriltag.h>
 #include <common/homography.h>
@@ -49,16 +54,108 @@
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpRect.h>
+#include <visp3/core/vpTime.h>
 #include <visp3/detection/vpDetectorAprilTag.h>
 #include <visp3/vision/vpPose.h>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Time elapsed in ms between the reset of a time profile, or the stamp
+// \e from, and the stamp \e to
+double getProfileTime(const timeprofile_t *tp, const char *from, const char *to)
+{
+  int64_t utimeFrom = tp->utime, utimeTo = tp->utime;
+  for (int i = 0; i < zarray_size(tp->stamps); i++) {
+    struct timeprofile_entry *stamp;
+    zarray_get_volatile(tp->stamps, i, &stamp);
+    if (from != NULL && strcmp(stamp->name, from) == 0) {
+      utimeFrom = stamp->utime;
+    }
+    if (strcmp(stamp->name, to) == 0) {
+      utimeTo = stamp->utime;
+    }
+  }
+  return (utimeTo - utimeFrom) / 1000.0;
+}
+
+// Pose of a tag from its homography, as homography_to_pose() but without
+// any allocation: the polar decomposition of the rotation is computed with
+// the Newton iterations R = (R + R^-T) / 2 instead of a SVD
+void homographyToPose(const matd_t *H, const vpCameraParameters &cam, double markerScale, vpHomogeneousMatrix &cMo)
+{
+  double fx = cam.get_px(), fy = cam.get_py(), cx = cam.get_u0(), cy = cam.get_v0();
+  double R20 = MATD_EL(H, 2, 0), R21 = MATD_EL(H, 2, 1), TZ = MATD_EL(H, 2, 2);
+  double R00 = (MATD_EL(H, 0, 0) - cx * R20) / fx, R01 = (MATD_EL(H, 0, 1) - cx * R21) / fx;
+  double TX = (MATD_EL(H, 0, 2) - cx * TZ) / fx;
+  double R10 = (MATD_EL(H, 1, 0) - cy * R20) / fy, R11 = (MATD_EL(H, 1, 1) - cy * R21) / fy;
+  double TY = (MATD_EL(H, 1, 2) - cy * TZ) / fy;
+
+  // Scale such that the rotation columns have a unit length, the tag being in
+  // front of the camera that looks in the -Z direction
+  double length1 = sqrt(R00 * R00 + R10 * R10 + R20 * R20);
+  double length2 = sqrt(R01 * R01 + R11 * R11 + R21 * R21);
+  double scale = (TZ > 0 ? -1.0 : 1.0) / sqrt(length1 * length2);
+
+  double R[3][3];
+  R[0][0] = R00 * scale;
+  R[0][1] = R01 * scale;
+  R[1][0] = R10 * scale;
+  R[1][1] = R11 * scale;
+  R[2][0] = R20 * scale;
+  R[2][1] = R21 * scale;
+  // The last column is the cross product of the two others
+  R[0][2] = R[1][0] * R[2][1] - R[2][0] * R[1][1];
+  R[1][2] = R[2][0] * R[0][1] - R[0][0] * R[2][1];
+  R[2][2] = R[0][0] * R[1][1] - R[1][0] * R[0][1];
+
+  for (int iter = 0; iter < 20; iter++) {
+    // The cofactor matrix divided by the determinant is R^-T
+    double C[3][3];
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3, j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+        C[i][j] = R[i1][j1] * R[i2][j2] - R[i1][j2] * R[i2][j1];
+      }
+    }
+    double det = R[0][0] * C[0][0] + R[0][1] * C[0][1] + R[0][2] * C[0][2];
+    if (std::fabs(det) < std::numeric_limits<double>::epsilon()) {
+      break;
+    }
+
+    double change = 0.;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        double r = 0.5 * (R[i][j] + C[i][j] / det);
+        change += std::fabs(r - R[i][j]);
+        R[i][j] = r;
+      }
+    }
+    if (change < 1e-12) {
+      break;
+    }
+  }
+
+  for (unsigned int i = 0; i < 3; i++) {
+    cMo[i][0] = -R[i][0];
+    cMo[i][1] = R[i][1];
+    cMo[i][2] = -R[i][2];
+  }
+  cMo[0][3] = -TX * scale * markerScale;
+  cMo[1][3] = -TY * scale * markerScale;
+  cMo[2][3] = -TZ * scale * markerScale;
+}
+}
+
 class vpDetectorAprilTag::Impl
 {
 public:
   Impl(const vpAprilTagFamily &tagFamily, const vpPoseEstimationMethod &method)
-    : m_cam(), m_poseEstimationMethod(method), m_tagFamily(tagFamily), m_tagPoses(), m_tagSize(1.0), m_td(NULL),
-      m_tf(NULL)
+    : m_cam(), m_decodingTime(0.), m_fullFrameInterval(10), m_messages(), m_nbFramesSinceFullFrame(0), m_pose(),
+      m_poseEstimationMethod(method), m_poseTime(0.), m_quadDetectionTime(0.), m_roiDetection(false),
+      m_roiMargin(0.5), m_roiTracking(false), m_tagFamily(tagFamily), m_tagPoses(), m_tagSize(1.0), m_td(NULL),
+      m_tf(NULL), m_trackedTags()
   {
     switch (m_tagFamily) {
     case TAG_36h11:
@@ -92,9 +189,6 @@ public:
 
     m_td = apriltag_detector_create();
     apriltag_detector_add_family(m_td, m_tf);
-
-    m_mapOfCorrespondingPoseMethods[DEMENTHON_VIRTUAL_VS] = vpPose::DEMENTHON;
-    m_mapOfCorrespondingPoseMethods[LAGRANGE_VIRTUAL_VS] = vpPose::LAGRANGE;
   }
 
   ~Impl()
@@ -136,16 +230,42 @@ public:
               const vpColor color, const unsigned int thickness)
   {
     m_tagPoses.clear();
+    m_poseTime = 0.;
 
+    // The image is wrapped without any copy
     image_u8_t im = {/*.width =*/(int32_t)I.getWidth(),
                      /*.height =*/(int32_t)I.getHeight(),
                      /*.stride =*/(int32_t)I.getWidth(),
                      /*.buf =*/I.bitmap};
 
-    zarray_t *detections = apriltag_detector_detect(m_td, &im);
+    m_quadDetectionTime = 0.;
+    m_decodingTime = 0.;
+    m_roiDetection = false;
+    zarray_t *detections = NULL;
+    if (m_roiTracking && !m_trackedTags.empty() && m_nbFramesSinceFullFrame + 1 < m_fullFrameInterval) {
+      detections = detectInRois(I);
+      if (zarray_size(detections) < (int)m_trackedTags.size()) {
+        // A tag is lost, search it in the whole image
+        apriltag_detections_destroy(detections);
+        detections = NULL;
+      } else {
+        m_roiDetection = true;
+        m_nbFramesSinceFullFrame++;
+      }
+    }
+
+    if (detections == NULL) {
+      detections = apriltag_detector_detect(m_td, &im);
+      m_quadDetectionTime += getProfileTime(m_td->tp, NULL, "quads");
+      m_decodingTime += getProfileTime(m_td->tp, "quads", "cleanup");
+      m_nbFramesSinceFullFrame = 0;
+    }
+
     int nb_detections = zarray_size(detections);
     bool detected = nb_detections > 0;
+    m_trackedTags.resize((size_t)nb_detections);
 
+    // The polygons and the messages of the previous call are reused
     polygons.resize((size_t)nb_detections);
     messages.resize((size_t)nb_detections);
 
@@ -153,14 +273,13 @@ public:
       apriltag_detection_t *det;
       zarray_get(detections, i, &det);
 
-      std::vector<vpImagePoint> polygon;
+      std::vector<vpImagePoint> &polygon = polygons[(size_t)i];
+      polygon.resize(4);
       for (int j = 0; j < 4; j++) {
-        polygon.push_back(vpImagePoint(det->p[j][1], det->p[j][0]));
+        polygon[(size_t)j].set_ij(det->p[j][1], det->p[j][0]);
       }
-      polygons[i] = polygon;
-      std::stringstream ss;
-      ss << m_tagFamily << " id: " << det->id;
-      messages[i] = ss.str();
+      m_trackedTags[(size_t)i] = vpRect(polygon);
+      messages[(size_t)i] = getMessage(det->id);
 
       if (displayTag) {
         vpColor Ox = (color == vpColor::none) ? vpColor::red : color;
@@ -179,109 +298,180 @@ public:
       }
 
       if (computePose) {
+        double t = vpTime::measureTimeMs();
         vpHomogeneousMatrix cMo;
-        if (m_poseEstimationMethod == HOMOGRAPHY || m_poseEstimationMethod == HOMOGRAPHY_VIRTUAL_VS
-            || m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
-          double fx = m_cam.get_px(), fy = m_cam.get_py();
-          double cx = m_cam.get_u0(), cy = m_cam.get_v0();
-
-          matd_t *M = homography_to_pose(det->H, fx, fy, cx, cy, m_tagSize / 2);
-
-          for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-              cMo[i][j] = MATD_EL(M, i, j);
-            }
-            cMo[i][3] = MATD_EL(M, i, 3);
-          }
+        computeTagPose(det, cMo);
+        m_tagPoses.push_back(cMo);
+        m_poseTime += vpTime::measureTimeMs() - t;
+      }
+    }
 
-          matd_destroy(M);
-        }
+    apriltag_detections_destroy(detections);
 
-        // Add marker object points
-        vpPose pose;
-        if (m_poseEstimationMethod != HOMOGRAPHY) {
-          vpPoint pt;
-
-          vpImagePoint imPt;
-          double x = 0.0, y = 0.0;
-          std::vector<vpPoint> pts(4);
-          pt.setWorldCoordinates(-m_tagSize / 2.0, -m_tagSize / 2.0, 0.0);
-          imPt.set_uv(det->p[0][0], det->p[0][1]);
-          vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-          pt.set_x(x);
-          pt.set_y(y);
-          pts[0] = pt;
-
-          pt.setWorldCoordinates(m_tagSize / 2.0, -m_tagSize / 2.0, 0.0);
-          imPt.set_uv(det->p[1][0], det->p[1][1]);
-          vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-          pt.set_x(x);
-          pt.set_y(y);
-          pts[1] = pt;
-
-          pt.setWorldCoordinates(m_tagSize / 2.0, m_tagSize / 2.0, 0.0);
-          imPt.set_uv(det->p[2][0], det->p[2][1]);
-          vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-          pt.set_x(x);
-          pt.set_y(y);
-          pts[2] = pt;
-
-          pt.setWorldCoordinates(-m_tagSize / 2.0, m_tagSize / 2.0, 0.0);
-          imPt.set_uv(det->p[3][0], det->p[3][1]);
-          vpPixelMeterConversion::convertPoint(m_cam, imPt, x, y);
-          pt.set_x(x);
-          pt.set_y(y);
-          pts[3] = pt;
-
-          pose.addPoints(pts);
-        }
+    return detected;
+  }
 
-        if (m_poseEstimationMethod != HOMOGRAPHY && m_poseEstimationMethod != HOMOGRAPHY_VIRTUAL_VS) {
-          if (m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
-            vpHomogeneousMatrix cMo_dementhon, cMo_lagrange, cMo_homography = cMo;
-
-            double residual_dementhon = std::numeric_limits<double>::max(),
-                   residual_lagrange = std::numeric_limits<double>::max();
-            double residual_homography = pose.computeResidual(cMo_homography);
-
-            if (pose.computePose(vpPose::DEMENTHON, cMo_dementhon)) {
-              residual_dementhon = pose.computeResidual(cMo_dementhon);
-            }
-
-            if (pose.computePose(vpPose::LAGRANGE, cMo_lagrange)) {
-              residual_lagrange = pose.computeResidual(cMo_lagrange);
-            }
-
-            if (residual_dementhon < residual_lagrange) {
-              if (residual_dementhon < residual_homography) {
-                cMo = cMo_dementhon;
-              } else {
-                cMo = cMo_homography;
-              }
-            } else if (residual_lagrange < residual_homography) {
-              cMo = cMo_lagrange;
-            } else {
-              //              cMo = cMo_homography; //already the case
-            }
-          } else {
-            pose.computePose(m_mapOfCorrespondingPoseMethods[m_poseEstimationMethod], cMo);
+  // Detect the tags at full resolution in the regions of interest around the
+  // tags of the previous image. The regions are disjoint and wrapped without
+  // copy, and the detections are expressed in the whole image.
+  zarray_t *detectInRois(const vpImage<unsigned char> &I)
+  {
+    int width = (int)I.getWidth(), height = (int)I.getHeight();
+    std::vector<vpRect> rois;
+    for (size_t i = 0; i < m_trackedTags.size(); i++) {
+      const vpRect &bbox = m_trackedTags[i];
+      double margin = m_roiMargin * std::max(bbox.getWidth(), bbox.getHeight());
+      double left = std::max(std::floor(bbox.getLeft() - margin), 0.);
+      double top = std::max(std::floor(bbox.getTop() - margin), 0.);
+      double right = std::min(std::ceil(bbox.getRight() + margin), width - 1.);
+      double bottom = std::min(std::ceil(bbox.getBottom() + margin), height - 1.);
+      if (left < right && top < bottom) {
+        rois.push_back(vpRect(vpImagePoint(top, left), vpImagePoint(bottom, right)));
+      }
+    }
+
+    // Merge the overlapping regions so that a tag is detected only once
+    for (bool merged = true; merged;) {
+      merged = false;
+      for (size_t i = 0; i < rois.size() && !merged; i++) {
+        for (size_t j = i + 1; j < rois.size() && !merged; j++) {
+          if (rois[i].getLeft() <= rois[j].getRight() && rois[j].getLeft() <= rois[i].getRight() &&
+              rois[i].getTop() <= rois[j].getBottom() && rois[j].getTop() <= rois[i].getBottom()) {
+            double left = std::min(rois[i].getLeft(), rois[j].getLeft());
+            double top = std::min(rois[i].getTop(), rois[j].getTop());
+            double right = std::max(rois[i].getRight(), rois[j].getRight());
+            double bottom = std::max(rois[i].getBottom(), rois[j].getBottom());
+            rois[i] = vpRect(vpImagePoint(top, left), vpImagePoint(bottom, right));
+            rois.erase(rois.begin() + (std::ptrdiff_t)j);
+            merged = true;
           }
         }
+      }
+    }
 
-        if (m_poseEstimationMethod != HOMOGRAPHY) {
-          // Compute final pose using VVS
-          pose.computePose(vpPose::VIRTUAL_VS, cMo);
+    zarray_t *detections = zarray_create(sizeof(apriltag_detection_t *));
+    float quadDecimate = m_td->quad_decimate;
+    m_td->quad_decimate = 1.0;
+    for (size_t i = 0; i < rois.size(); i++) {
+      int left = (int)rois[i].getLeft(), top = (int)rois[i].getTop();
+      image_u8_t roi = {/*.width =*/(int)rois[i].getRight() - left + 1,
+                        /*.height =*/(int)rois[i].getBottom() - top + 1,
+                        /*.stride =*/width,
+                        /*.buf =*/I.bitmap + (size_t)top * (size_t)width + (size_t)left};
+
+      zarray_t *roiDetections = apriltag_detector_detect(m_td, &roi);
+      m_quadDetectionTime += getProfileTime(m_td->tp, NULL, "quads");
+      m_decodingTime += getProfileTime(m_td->tp, "quads", "cleanup");
+
+      for (int k = 0; k < zarray_size(roiDetections); k++) {
+        apriltag_detection_t *det;
+        zarray_get(roiDetections, k, &det);
+        det->c[0] += left;
+        det->c[1] += top;
+        for (int j = 0; j < 4; j++) {
+          det->p[j][0] += left;
+          det->p[j][1] += top;
+        }
+        // Translation of the homography from the region to the image
+        for (int j = 0; j < 3; j++) {
+          MATD_EL(det->H, 0, j) += left * MATD_EL(det->H, 2, j);
+          MATD_EL(det->H, 1, j) += top * MATD_EL(det->H, 2, j);
         }
+        zarray_add(detections, &det);
+      }
+      zarray_destroy(roiDetections);
+    }
+    m_td->quad_decimate = quadDecimate;
 
-        m_tagPoses.push_back(cMo);
+    return detections;
+  }
+
+  // Only the initial poses required by the pose estimation method are
+  // computed, the 3D points of the tag being updated in place in m_pose
+  void computeTagPose(const apriltag_detection_t *det, vpHomogeneousMatrix &cMo)
+  {
+    if (m_poseEstimationMethod == HOMOGRAPHY || m_poseEstimationMethod == HOMOGRAPHY_VIRTUAL_VS ||
+        m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
+      homographyToPose(det->H, m_cam, m_tagSize / 2, cMo);
+    }
+
+    if (m_poseEstimationMethod == HOMOGRAPHY) {
+      return;
+    }
+
+    if (m_pose.listP.size() != 4) {
+      m_pose.clearPoint();
+      for (unsigned int i = 0; i < 4; i++) {
+        m_pose.addPoint(vpPoint());
       }
     }
 
-    apriltag_detections_destroy(detections);
+    // Tag corners in the tag frame
+    const double corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    std::list<vpPoint>::iterator it = m_pose.listP.begin();
+    for (unsigned int i = 0; i < 4; i++, ++it) {
+      double x = 0.0, y = 0.0;
+      vpPixelMeterConversion::convertPoint(m_cam, det->p[i][0], det->p[i][1], x, y);
+      it->setWorldCoordinates(corners[i][0] * m_tagSize / 2.0, corners[i][1] * m_tagSize / 2.0, 0.0);
+      it->set_x(x);
+      it->set_y(y);
+    }
 
-    return detected;
+    if (m_poseEstimationMethod == BEST_RESIDUAL_VIRTUAL_VS) {
+      vpHomogeneousMatrix cMo_dementhon, cMo_lagrange, cMo_homography = cMo;
+
+      double residual_dementhon = std::numeric_limits<double>::max(),
+             residual_lagrange = std::numeric_limits<double>::max();
+      double residual_homography = m_pose.computeResidual(cMo_homography);
+
+      if (m_pose.computePose(vpPose::DEMENTHON, cMo_dementhon)) {
+        residual_dementhon = m_pose.computeResidual(cMo_dementhon);
+      }
+
+      if (m_pose.computePose(vpPose::LAGRANGE, cMo_lagrange)) {
+        residual_lagrange = m_pose.computeResidual(cMo_lagrange);
+      }
+
+      if (residual_dementhon < residual_lagrange) {
+        if (residual_dementhon < residual_homography) {
+          cMo = cMo_dementhon;
+        } else {
+          cMo = cMo_homography;
+        }
+      } else if (residual_lagrange < residual_homography) {
+        cMo = cMo_lagrange;
+      }
+    } else if (m_poseEstimationMethod == DEMENTHON_VIRTUAL_VS) {
+      m_pose.computePose(vpPose::DEMENTHON, cMo);
+    } else if (m_poseEstimationMethod == LAGRANGE_VIRTUAL_VS) {
+      m_pose.computePose(vpPose::LAGRANGE, cMo);
+    }
+
+    // Compute final pose using VVS
+    m_pose.computePose(vpPose::VIRTUAL_VS, cMo);
   }
 
+  const std::string &getMessage(int id)
+  {
+    if ((size_t)id >= m_messages.size()) {
+      m_messages.resize((size_t)id + 1);
+    }
+    if (m_messages[(size_t)id].empty()) {
+      std::stringstream ss;
+      ss << m_tagFamily << " id: " << id;
+      m_messages[(size_t)id] = ss.str();
+    }
+    return m_messages[(size_t)id];
+  }
+
+  double getDecodingTime() const { return m_decodingTime; }
+
+  double getPoseTime() const { return m_poseTime; }
+
+  double getQuadDetectionTime() const { return m_quadDetectionTime; }
+
+  bool isRoiDetection() const { return m_roiDetection; }
+
   void getTagPoses(std::vector<vpHomogeneousMatrix> &tagPoses) const { tagPoses = m_tagPoses; }
 
   void setCameraParameters(const vpCameraParameters &cam) { m_cam = cam; }
@@ -290,6 +480,14 @@ public:
 
   void setQuadDecimate(const float quadDecimate) { m_td->quad_decimate = quadDecimate; }
 
+  void setRoiTracking(const bool roiTracking, const unsigned int fullFrameInterval, const double roiMargin)
+  {
+    m_roiTracking = roiTracking;
+    m_fullFrameInterval = fullFrameInterval;
+    m_roiMargin = roiMargin;
+    m_trackedTags.clear();
+  }
+
   void setQuadSigma(const float quadSigma) { m_td->quad_sigma = quadSigma; }
 
   void setRefineDecode(const bool refineDecode) { m_td->refine_decode = refineDecode ? 1 : 0; }
@@ -304,13 +502,29 @@ public:
 
 protected:
   vpCameraParameters m_cam;
-  std::map<vpPoseEstimationMethod, vpPose::vpPoseMethodType> m_mapOfCorrespondingPoseMethods;
+  double m_decodingTime;
+  //! Maximal number of images between two detections in the whole image
+  unsigned int m_fullFrameInterval;
+  //! Messages indexed by the tag id, built once
+  std::vector<std::string> m_messages;
+  unsigned int m_nbFramesSinceFullFrame;
+  //! Pose estimator reused from one tag to another
+  vpPose m_pose;
   vpPoseEstimationMethod m_poseEstimationMethod;
+  double m_poseTime;
+  double m_quadDetectionTime;
+  //! True if the last detection only searched the regions of interest
+  bool m_roiDetection;
+  //! Margin around the tracked tags, as a ratio of their size
+  double m_roiMargin;
+  bool m_roiTracking;
   vpAprilTagFamily m_tagFamily;
   std::vector<vpHomogeneousMatrix> m_tagPoses;
   double m_tagSize;
   apriltag_detector_t *m_td;
   apriltag_family_t *m_tf;
+  //! Bounding boxes of the tags detected in the previous image
+  std::vector<vpRect> m_trackedTags;
 };
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
@@ -339,8 +553,8 @@ vpDetectorAprilTag::~vpDetectorAprilTag() { delete m_impl; }
 */
 bool vpDetectorAprilTag::detect(const vpImage<unsigned char> &I)
 {
-  m_message.clear();
-  m_polygon.clear();
+  // m_polygon and m_message are resized by the detection to reuse their
+  // memory from one image to another
   m_nb_objects = 0;
 
   bool detected = m_impl->detect(I, m_polygon, m_message, false, m_displayTag,
@@ -361,8 +575,6 @@ bool vpDetectorAprilTag::detect(const vpImage<unsigned char> &I)
 bool vpDetectorAprilTag::detect(const vpImage<unsigned char> &I, const double tagSize, const vpCameraParameters &cam,
                                 std::vector<vpHomogeneousMatrix> &cMo_vec)
 {
-  m_message.clear();
-  m_polygon.clear();
   m_nb_objects = 0;
 
   m_impl->setTagSize(tagSize);
@@ -375,6 +587,40 @@ bool vpDetectorAprilTag::detect(const vpImage<unsigned char> &I, const double ta
   return detected;
 }
 
+/*!
+  Return the time in ms spent by the last call to detect() to decode the
+  tags from the quads, including the refinement of the detections.
+
+  \sa getQuadDetectionTime(), getPoseTime()
+*/
+double vpDetectorAprilTag::getDecodingTime() const { return m_impl->getDecodingTime(); }
+
+/*!
+  Return the time in ms spent by the last call to detect() to compute the
+  poses of the tags, 0 if the poses were not requested.
+
+  \sa getQuadDetectionTime(), getDecodingTime()
+*/
+double vpDetectorAprilTag::getPoseTime() const { return m_impl->getPoseTime(); }
+
+/*!
+  Return the time in ms spent by the last call to detect() to detect the
+  quads, including the decimation and the blur of the image, the adaptive
+  thresholding and the fitting of the quads.
+
+  \sa getDecodingTime(), getPoseTime()
+*/
+double vpDetectorAprilTag::getQuadDetectionTime() const { return m_impl->getQuadDetectionTime(); }
+
+/*!
+  Return true if the last call to detect() only searched the regions of
+  interest around the previously detected tags, false if the whole image
+  was processed.
+
+  \sa setAprilTagRoiTracking()
+*/
+bool vpDetectorAprilTag::isRoiDetection() const { return m_impl->isRoiDetection(); }
+
 /*!
   Set the number of threads for April Tag detection (default is 1).
 
@@ -411,6 +657,35 @@ void vpDetectorAprilTag::setAprilTagPoseEstimationMethod(const vpPoseEstimationM
 */
 void vpDetectorAprilTag::setAprilTagQuadDecimate(const float quadDecimate) { m_impl->setQuadDecimate(quadDecimate); }
 
+/*!
+  Enable the detection in regions of interest for video streams.
+
+  When enabled, the tags are first searched at full resolution (without
+  quad decimation) in regions of interest around the tags detected in the
+  previous image: the bounding box of each tag enlarged by \e roiMargin times
+  its size on each side, the overlapping regions being merged. The whole
+  image is processed, as without tracking, when fewer tags than in the
+  previous image are found in the regions, and at least every
+  \e fullFrameInterval images to detect the new tags.
+
+  \param roiTracking : True to enable the detection in regions of interest.
+  \param fullFrameInterval : Maximal number of images between two
+  detections in the whole image. A value lower than 2 processes every image
+  entirely.
+  \param roiMargin : Margin added around the tags, as a ratio of their size.
+  It has to be greater than the motion of the tags between two images.
+
+  \sa isRoiDetection()
+*/
+void vpDetectorAprilTag::setAprilTagRoiTracking(const bool roiTracking, const unsigned int fullFrameInterval,
+                                                const double roiMargin)
+{
+  if (roiMargin < 0.) {
+    throw vpException(vpException::badValue, "Bad margin of the regions of interest: %f", roiMargin);
+  }
+  m_impl->setRoiTracking(roiTracking, fullFrameInterval, roiMargin);
+}
+
 /*!
   From the AprilTag code:
   <blockquote>
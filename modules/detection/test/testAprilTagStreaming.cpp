@@ -0,0 +1,285 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test AprilTag detection on a stream of synthetic images.
+ *
+ *****************************************************************************/
+/*!
+  \example testAprilTagStreaming.cpp
+
+  \brief Test AprilTag detection and pose estimation on a stream of synthetic
+  1080p images, and print the time spent in each step of the detection. Test
+  also the detection in regions of interest around the tags of the previous
+  image.
+*/
+
+#include <cmath>
+#include <iostream>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/detection/vpDetectorAprilTag.h>
+
+#if defined(VISP_HAVE_APRILTAG)
+
+namespace
+{
+// Codes of the first 36h11 tags
+const unsigned long long tag36h11Codes[] = {0xd5d628584ULL, 0xd97f18b49ULL, 0xdd280910eULL};
+
+const unsigned int cellSize = 16; // Size in pixels of a bit of the tags
+const unsigned int tagCells = 8;  // 6x6 bits and a black border
+
+// Draw a 36h11 tag whose top left black corner is at (u0, v0)
+void drawTag(vpImage<unsigned char> &I, unsigned int id, unsigned int u0, unsigned int v0)
+{
+  for (unsigned int i = 0; i < tagCells * cellSize; i++) {
+    for (unsigned int j = 0; j < tagCells * cellSize; j++) {
+      unsigned int x = j / cellSize, y = i / cellSize;
+      bool white = false;
+      if (x > 0 && y > 0 && x < tagCells - 1 && y < tagCells - 1) {
+        unsigned int pos = (5 - (y - 1)) * 6 + (5 - (x - 1));
+        white = ((tag36h11Codes[id] >> pos) & 1) != 0;
+      }
+      I[v0 + i][u0 + j] = white ? 255 : 0;
+    }
+  }
+}
+
+// Check that the detected tags are the expected ones, shifted by (du, dv)
+bool checkTags(vpDetectorAprilTag &detector, const unsigned int positions[][2], const bool visible[3],
+               unsigned int du, unsigned int dv)
+{
+  size_t nbVisible = (visible[0] ? 1 : 0) + (visible[1] ? 1 : 0) + (visible[2] ? 1 : 0);
+  if (detector.getNbObjects() != nbVisible) {
+    std::cerr << "Bad number of tags detected: " << detector.getNbObjects() << std::endl;
+    return false;
+  }
+  for (size_t i = 0; i < detector.getNbObjects(); i++) {
+    std::string message = detector.getMessage(i);
+    unsigned int id = (unsigned int)(message[message.size() - 1] - '0');
+    if (id > 2 || !visible[id]) {
+      std::cerr << "Bad message: " << message << std::endl;
+      return false;
+    }
+    std::vector<vpImagePoint> polygon = detector.getPolygon(i);
+    double left = positions[id][0] + du - 0.5, top = positions[id][1] + dv - 0.5;
+    double right = left + tagCells * cellSize, bottom = top + tagCells * cellSize;
+    for (size_t j = 0; j < polygon.size(); j++) {
+      double u = polygon[j].get_u(), v = polygon[j].get_v();
+      if (std::min(std::fabs(u - left), std::fabs(u - right)) > 1.5 ||
+          std::min(std::fabs(v - top), std::fabs(v - bottom)) > 1.5) {
+        std::cerr << "Bad corner of tag " << id << ": " << polygon[j] << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I(1080, 1920, 255);
+    const unsigned int positions[3][2] = {{300, 200}, {1200, 600}, {900, 150}};
+    for (unsigned int id = 0; id < 3; id++) {
+      drawTag(I, id, positions[id][0], positions[id][1]);
+    }
+
+    vpCameraParameters cam;
+    cam.initPersProjWithoutDistortion(1000., 1000., 960., 540.);
+    double tagSize = 0.08;
+    double Z = cam.get_px() * tagSize / (tagCells * cellSize);
+
+    vpDetectorAprilTag::vpPoseEstimationMethod methods[] = {
+        vpDetectorAprilTag::HOMOGRAPHY, vpDetectorAprilTag::HOMOGRAPHY_VIRTUAL_VS,
+        vpDetectorAprilTag::DEMENTHON_VIRTUAL_VS, vpDetectorAprilTag::LAGRANGE_VIRTUAL_VS,
+        vpDetectorAprilTag::BEST_RESIDUAL_VIRTUAL_VS};
+
+    vpDetectorAprilTag detector(vpDetectorAprilTag::TAG_36h11);
+    for (unsigned int m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+      detector.setAprilTagPoseEstimationMethod(methods[m]);
+
+      // The buffers of a frame are reused by the next ones
+      const unsigned int nbFrames = 5;
+      double quadTime = 0., decodingTime = 0., poseTime = 0., totalTime = 0.;
+      for (unsigned int frame = 0; frame < nbFrames; frame++) {
+        std::vector<vpHomogeneousMatrix> cMo_vec;
+        double t = vpTime::measureTimeMs();
+        bool detected = detector.detect(I, tagSize, cam, cMo_vec);
+        totalTime += vpTime::measureTimeMs() - t;
+        quadTime += detector.getQuadDetectionTime();
+        decodingTime += detector.getDecodingTime();
+        poseTime += detector.getPoseTime();
+
+        if (!detected || detector.getNbObjects() != 3 || cMo_vec.size() != 3) {
+          std::cerr << "Bad number of tags detected with " << methods[m] << ": " << detector.getNbObjects()
+                    << std::endl;
+          return EXIT_FAILURE;
+        }
+        if (detector.getQuadDetectionTime() < 0. || detector.getDecodingTime() < 0. ||
+            detector.getPoseTime() < 0.) {
+          std::cerr << "Bad timings" << std::endl;
+          return EXIT_FAILURE;
+        }
+
+        for (size_t i = 0; i < detector.getNbObjects(); i++) {
+          std::string message = detector.getMessage(i);
+          unsigned int id = (unsigned int)(message[message.size() - 1] - '0');
+          if (message.find("36h11 id: ") != 0 || id > 2) {
+            std::cerr << "Bad message: " << message << std::endl;
+            return EXIT_FAILURE;
+          }
+
+          // Corners on the external border of the black square
+          std::vector<vpImagePoint> polygon = detector.getPolygon(i);
+          double left = positions[id][0] - 0.5, top = positions[id][1] - 0.5;
+          double right = left + tagCells * cellSize, bottom = top + tagCells * cellSize;
+          for (size_t j = 0; j < polygon.size(); j++) {
+            double u = polygon[j].get_u(), v = polygon[j].get_v();
+            if (std::min(std::fabs(u - left), std::fabs(u - right)) > 1.5 ||
+                std::min(std::fabs(v - top), std::fabs(v - bottom)) > 1.5) {
+              std::cerr << "Bad corner of tag " << id << ": " << polygon[j] << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+
+          // Fronto-parallel tag
+          const vpHomogeneousMatrix &cMo = cMo_vec[i];
+          double uc = (left + right) / 2, vc = (top + bottom) / 2;
+          double X = (uc - cam.get_u0()) / cam.get_px() * Z, Y = (vc - cam.get_v0()) / cam.get_py() * Z;
+          if (!cMo.isAnHomogeneousMatrix() || std::fabs(std::fabs(cMo[2][2]) - 1.) > 1e-3 ||
+              std::fabs(cMo[0][3] - X) > 2e-3 || std::fabs(cMo[1][3] - Y) > 2e-3 || std::fabs(cMo[2][3] - Z) > 5e-3) {
+            std::cerr << "Bad pose of tag " << id << " with " << methods[m] << ":\n" << cMo << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+
+      std::cout << methods[m] << ", mean times (ms): quads " << quadTime / nbFrames << ", decoding "
+                << decodingTime / nbFrames << ", pose " << poseTime / nbFrames << ", total " << totalTime / nbFrames
+                << std::endl;
+    }
+
+    // Detection without pose
+    if (!detector.detect(I) || detector.getNbObjects() != 3 || detector.getPoseTime() != 0.) {
+      std::cerr << "Bad detection without pose" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Detection in regions of interest: the tags move of a few pixels in
+    // each image, tag 2 disappears in image 7 and reappears in image 9
+    const unsigned int fullFrameInterval = 5;
+    detector.setAprilTagRoiTracking(true, fullFrameInterval);
+    // The pose only relies on the homography expressed in the whole image
+    detector.setAprilTagPoseEstimationMethod(vpDetectorAprilTag::HOMOGRAPHY);
+    vpImage<unsigned char> I_moving(1080, 1920);
+    double roiTime = 0., fullTime = 0.;
+    unsigned int nbRoiFrames = 0, nbFullFrames = 0;
+    for (unsigned int frame = 0; frame < 15; frame++) {
+      unsigned int du = 6 * frame, dv = 3 * frame;
+      bool visible[3] = {true, true, frame < 7 || frame >= 9};
+      I_moving = 255;
+      for (unsigned int id = 0; id < 3; id++) {
+        if (visible[id]) {
+          drawTag(I_moving, id, positions[id][0] + du, positions[id][1] + dv);
+        }
+      }
+
+      std::vector<vpHomogeneousMatrix> cMo_vec;
+      double t = vpTime::measureTimeMs();
+      detector.detect(I_moving, tagSize, cam, cMo_vec);
+      t = vpTime::measureTimeMs() - t;
+
+      // Full image processed for the first image, periodically, when tag 2
+      // is lost, and the new tag 2 is only found by a full detection
+      bool fullExpected = frame == 0 || frame == fullFrameInterval || frame == 7 || frame == 12;
+      bool expected[3] = {true, true, visible[2] && (frame < 7 || frame >= 12)};
+      if (detector.isRoiDetection() == fullExpected) {
+        std::cerr << "Bad detection mode in image " << frame << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (!checkTags(detector, positions, expected, du, dv) || cMo_vec.size() != detector.getNbObjects()) {
+        std::cerr << "Bad detection in image " << frame << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < cMo_vec.size(); i++) {
+        std::string message = detector.getMessage(i);
+        unsigned int id = (unsigned int)(message[message.size() - 1] - '0');
+        double uc = positions[id][0] + du - 0.5 + tagCells * cellSize / 2.;
+        double vc = positions[id][1] + dv - 0.5 + tagCells * cellSize / 2.;
+        double X = (uc - cam.get_u0()) / cam.get_px() * Z, Y = (vc - cam.get_v0()) / cam.get_py() * Z;
+        if (std::fabs(cMo_vec[i][0][3] - X) > 2e-3 || std::fabs(cMo_vec[i][1][3] - Y) > 2e-3 ||
+            std::fabs(cMo_vec[i][2][3] - Z) > 5e-3) {
+          std::cerr << "Bad pose in image " << frame << ":\n" << cMo_vec[i] << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      if (detector.isRoiDetection()) {
+        roiTime += t;
+        nbRoiFrames++;
+      } else {
+        fullTime += t;
+        nbFullFrames++;
+      }
+    }
+    std::cout << "Mean times (ms): detection in regions of interest " << roiTime / nbRoiFrames
+              << ", detection in the whole image " << fullTime / nbFullFrames << std::endl;
+
+    detector.setAprilTagRoiTracking(false);
+    if (!detector.detect(I_moving) || detector.isRoiDetection()) {
+      std::cerr << "The detection in regions of interest should be disabled" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // An empty image
+    vpImage<unsigned char> I_empty(1080, 1920, 128);
+    if (detector.detect(I_empty) || detector.getNbObjects() != 0 || !detector.getPolygon().empty()) {
+      std::cerr << "Tags detected in an empty image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testAprilTagStreaming succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "Need AprilTag to run this test" << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,319 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the localization of QR codes and Data Matrix codes.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testBarcodeLocalizer.cpp
+
+  \brief Test the localization of synthetic QR codes and Data Matrix codes
+  in a large image, and the rectification of the located codes.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/detection/vpBarcodeLocalizer.h>
+
+namespace
+{
+// Synthetic code of n x n modules drawn in an image
+struct vpSyntheticCode {
+  unsigned int n;
+  std::vector<unsigned char> dark;
+  double u0, v0;     // Image location of the top left corner of the code
+  double angle;      // Rotation of the code
+  double moduleSize; // Size of the modules in pixels
+
+  // Image location of a point given in modules
+  vpImagePoint toImage(double x, double y) const
+  {
+    double c = std::cos(angle), s = std::sin(angle);
+    return vpImagePoint(v0 + moduleSize * (s * x + c * y), u0 + moduleSize * (c * x - s * y));
+  }
+};
+
+void drawFinderPattern(vpSyntheticCode &code, unsigned int x0, unsigned int y0)
+{
+  for (unsigned int y = 0; y < 7; y++) {
+    for (unsigned int x = 0; x < 7; x++) {
+      unsigned int ring = std::min(std::min(x, 6 - x), std::min(y, 6 - y));
+      code.dark[(y0 + y) * code.n + x0 + x] = ring != 1;
+    }
+  }
+}
+
+// QR code like: three finder patterns with their separators, random data
+vpSyntheticCode createQRCode(unsigned int n)
+{
+  vpSyntheticCode code;
+  code.n = n;
+  code.dark.resize(n * n);
+  for (unsigned int i = 0; i < n * n; i++) {
+    code.dark[i] = rand() % 2;
+  }
+  for (unsigned int y = 0; y < 8; y++) {
+    for (unsigned int x = 0; x < 8; x++) {
+      code.dark[y * n + x] = code.dark[y * n + n - 1 - x] = code.dark[(n - 1 - y) * n + x] = 0;
+    }
+  }
+  drawFinderPattern(code, 0, 0);
+  drawFinderPattern(code, n - 7, 0);
+  drawFinderPattern(code, 0, n - 7);
+  return code;
+}
+
+// Data Matrix code like: solid left and bottom sides, alternating top and
+// right sides, random data
+vpSyntheticCode createDataMatrix(unsigned int n)
+{
+  vpSyntheticCode code;
+  code.n = n;
+  code.dark.resize(n * n);
+  for (unsigned int y = 0; y < n; y++) {
+    for (unsigned int x = 0; x < n; x++) {
+      bool d = rand() % 2 != 0;
+      if (x == 0 || y == n - 1) {
+        d = true;
+      } else if (y == 0) {
+        d = x % 2 == 0;
+      } else if (x == n - 1) {
+        d = y % 2 == 1;
+      }
+      code.dark[y * n + x] = d;
+    }
+  }
+  return code;
+}
+
+// Draw a code with a white quiet zone of 2 modules
+void drawCode(vpImage<unsigned char> &I, const vpSyntheticCode &code)
+{
+  double c = std::cos(code.angle), s = std::sin(code.angle);
+  double extent = (code.n + 6) * code.moduleSize * 1.5;
+  for (int v = (int)(code.v0 - extent); v < (int)(code.v0 + extent); v++) {
+    for (int u = (int)(code.u0 - extent); u < (int)(code.u0 + extent); u++) {
+      if (u < 0 || v < 0 || u >= (int)I.getWidth() || v >= (int)I.getHeight()) {
+        continue;
+      }
+      // Pixel center in modules
+      double du = (u - code.u0) / code.moduleSize, dv = (v - code.v0) / code.moduleSize;
+      double x = c * du + s * dv, y = -s * du + c * dv;
+      if (x < -2. || y < -2. || x >= code.n + 2. || y >= code.n + 2.) {
+        continue;
+      }
+      bool dark = x >= 0. && y >= 0. && x < code.n && y < code.n &&
+                  code.dark[(unsigned int)y * code.n + (unsigned int)x];
+      I[v][u] = dark ? 20 : 230;
+    }
+  }
+}
+
+bool checkCorner(const vpImagePoint &corner, const vpImagePoint &expected, double moduleSize)
+{
+  if (vpImagePoint::distance(corner, expected) > 1.5 * moduleSize) {
+    std::cerr << "Bad corner " << corner << " instead of " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    srand(1234);
+    vpImage<unsigned char> I(1080, 1920);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        I[i][j] = (unsigned char)(120. + 50. * std::sin(j * 0.005) * std::cos(i * 0.007) + (rand() % 5));
+      }
+    }
+
+    vpSyntheticCode qrCodes[2] = {createQRCode(25), createQRCode(21)};
+    qrCodes[0].u0 = 300.;
+    qrCodes[0].v0 = 250.;
+    qrCodes[0].angle = 0.35;
+    qrCodes[0].moduleSize = 6.;
+    qrCodes[1].u0 = 1300.;
+    qrCodes[1].v0 = 700.;
+    qrCodes[1].angle = -0.8;
+    qrCodes[1].moduleSize = 9.;
+    vpSyntheticCode dataMatrix = createDataMatrix(16);
+    dataMatrix.u0 = 900.;
+    dataMatrix.v0 = 300.;
+    dataMatrix.angle = 0.2;
+    dataMatrix.moduleSize = 8.;
+    drawCode(I, qrCodes[0]);
+    drawCode(I, qrCodes[1]);
+    drawCode(I, dataMatrix);
+
+    // QR codes
+    vpBarcodeLocalizer localizer(vpBarcodeLocalizer::QR_CODE);
+    std::vector<vpBarcodeLocalizer::vpCandidate> candidates;
+    double t = vpTime::measureTimeMs();
+    localizer.locate(I, candidates);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "QR code localization in a " << I.getWidth() << "x" << I.getHeight() << " image (ms): " << t << ", "
+              << candidates.size() << " candidates" << std::endl;
+    if (candidates.size() != 2) {
+      std::cerr << "Bad number of QR codes located" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int k = 0; k < 2; k++) {
+      const vpSyntheticCode &code = qrCodes[k];
+      // The candidates are not sorted by location
+      const vpBarcodeLocalizer::vpCandidate &candidate =
+          vpImagePoint::distance(candidates[0].corners[0], code.toImage(0, 0)) <
+                  vpImagePoint::distance(candidates[1].corners[0], code.toImage(0, 0))
+              ? candidates[0]
+              : candidates[1];
+      double n = code.n;
+      if (!checkCorner(candidate.corners[0], code.toImage(0, 0), code.moduleSize) ||
+          !checkCorner(candidate.corners[1], code.toImage(n, 0), code.moduleSize) ||
+          !checkCorner(candidate.corners[2], code.toImage(n, n), code.moduleSize) ||
+          !checkCorner(candidate.corners[3], code.toImage(0, n), code.moduleSize) ||
+          std::fabs(candidate.moduleSize - code.moduleSize) > 0.2 * code.moduleSize) {
+        std::cerr << "Bad QR code " << k << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // Upright code at 4 pixels per module with a quiet zone of 4 modules
+      vpImage<unsigned char> Icode;
+      vpHomography codeToImage;
+      localizer.rectify(I, candidate, Icode, codeToImage);
+      for (unsigned int y = 0; y < code.n; y++) {
+        for (unsigned int x = 0; x < code.n; x++) {
+          // Module centers away from the borders of the modules
+          unsigned int i = (unsigned int)((4 + y + 0.5) * Icode.getHeight() / (code.n + 8));
+          unsigned int j = (unsigned int)((4 + x + 0.5) * Icode.getWidth() / (code.n + 8));
+          bool dark = Icode[i][j] < 128;
+          if (x < 7 && y < 7 && dark != (code.dark[y * code.n + x] != 0)) {
+            std::cerr << "Bad rectified QR code " << k << " at module " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // With a bounded number of finder patterns, the patterns found on the
+    // most rows, those of the code with the largest modules, are kept
+    localizer.setMaxFinderPatterns(3);
+    localizer.locate(I, candidates);
+    localizer.setMaxFinderPatterns(64);
+    if (candidates.size() != 1 ||
+        !checkCorner(candidates[0].corners[0], qrCodes[1].toImage(0, 0), qrCodes[1].moduleSize)) {
+      std::cerr << "Bad QR code located with 3 finder patterns" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Data Matrix codes
+    localizer.setType(vpBarcodeLocalizer::DATA_MATRIX);
+    t = vpTime::measureTimeMs();
+    localizer.locate(I, candidates);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Data Matrix localization in a " << I.getWidth() << "x" << I.getHeight() << " image (ms): " << t
+              << ", " << candidates.size() << " candidates" << std::endl;
+    if (candidates.size() != 1) {
+      std::cerr << "Bad number of Data Matrix codes located" << std::endl;
+      return EXIT_FAILURE;
+    }
+    double n = dataMatrix.n, m = dataMatrix.moduleSize;
+    if (!checkCorner(candidates[0].corners[0], dataMatrix.toImage(0, n), m) ||
+        !checkCorner(candidates[0].corners[1], dataMatrix.toImage(n, n), m) ||
+        !checkCorner(candidates[0].corners[2], dataMatrix.toImage(n, 0), m) ||
+        !checkCorner(candidates[0].corners[3], dataMatrix.toImage(0, 0), m) ||
+        std::fabs(candidates[0].moduleSize - m) > 0.2 * m) {
+      std::cerr << "Bad Data Matrix code, module size " << candidates[0].moduleSize << std::endl;
+      return EXIT_FAILURE;
+    }
+    vpImage<unsigned char> Icode;
+    vpHomography codeToImage;
+    localizer.rectify(I, candidates[0], Icode, codeToImage);
+    for (unsigned int y = 0; y < dataMatrix.n; y++) {
+      for (unsigned int x = 0; x < dataMatrix.n; x++) {
+        unsigned int i = (unsigned int)((2 + y + 0.5) * Icode.getHeight() / (dataMatrix.n + 4));
+        unsigned int j = (unsigned int)((2 + x + 0.5) * Icode.getWidth() / (dataMatrix.n + 4));
+        if ((Icode[i][j] < 128) != (dataMatrix.dark[y * dataMatrix.n + x] != 0)) {
+          std::cerr << "Bad rectified Data Matrix code at module " << x << ", " << y << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Location of a point of the rectified code in the image
+    vpImagePoint corner = candidates[0].corners[0];
+    vpColVector p(3);
+    p[0] = 2 * 4 - 0.5;
+    p[1] = Icode.getHeight() - 2 * 4 - 0.5;
+    p[2] = 1.;
+    vpColVector q = codeToImage * p;
+    if (vpImagePoint::distance(vpImagePoint(q[1] / q[2], q[0] / q[2]), corner) > 2.) {
+      std::cerr << "Bad homography of the rectified code" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // 4K image
+    vpImage<unsigned char> I4K(2160, 3840, 128);
+    qrCodes[0].u0 = 3000.;
+    qrCodes[0].v0 = 1500.;
+    drawCode(I4K, qrCodes[0]);
+    localizer.setType(vpBarcodeLocalizer::QR_CODE);
+    localizer.setDownscale(3);
+    t = vpTime::measureTimeMs();
+    localizer.locate(I4K, candidates);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "QR code localization in a " << I4K.getWidth() << "x" << I4K.getHeight() << " image (ms): " << t
+              << std::endl;
+    if (candidates.size() != 1 || !checkCorner(candidates[0].corners[0], qrCodes[0].toImage(0, 0), 6.)) {
+      std::cerr << "Bad QR code in the 4K image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Nothing in an uniform image
+    vpImage<unsigned char> I_empty(480, 640, 128);
+    localizer.locate(I_empty, candidates);
+    if (!candidates.empty()) {
+      std::cerr << "Codes located in an empty image" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testBarcodeLocalizer succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
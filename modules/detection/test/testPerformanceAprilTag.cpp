@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Benchmark of the AprilTag detection for all the tag families.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPerformanceAprilTag.cpp
+
+  \brief Benchmark of the AprilTag detection: synthetic images containing
+  tags of each family are processed at several resolutions, and the time
+  spent in the quad detection, in the decoding and in the whole detection is
+  printed.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/detection/vpDetectorAprilTag.h>
+#include <visp3/io/vpParseArgv.h>
+
+#if defined(VISP_HAVE_APRILTAG)
+
+// List of allowed command line options
+#define GETOPTARGS "cdn:t:h"
+
+namespace
+{
+struct vpTagCode {
+  vpDetectorAprilTag::vpAprilTagFamily family;
+  const char *name;
+  unsigned int nbBits;        // Number of bits per side
+  unsigned long long code; // Code of the tag id 0
+};
+
+const vpTagCode tagCodes[] = {{vpDetectorAprilTag::TAG_36h11, "36h11", 6, 0xd5d628584ULL},
+                              {vpDetectorAprilTag::TAG_36h10, "36h10", 6, 0x1ca92a687ULL},
+                              {vpDetectorAprilTag::TAG_36ARTOOLKIT, "36artoolkit", 6, 0x6dc269c27ULL},
+                              {vpDetectorAprilTag::TAG_25h9, "25h9", 5, 0x155cbf1ULL},
+                              {vpDetectorAprilTag::TAG_25h7, "25h7", 5, 0x4b770dULL},
+                              {vpDetectorAprilTag::TAG_16h5, "16h5", 4, 0x231bULL}};
+
+void usage(const char *name, const char *badparam, unsigned int nbIterations, int nbThreads)
+{
+  fprintf(stdout, "\n\
+Benchmark of the AprilTag detection for all the tag families.\n\
+\n\
+SYNOPSIS\n\
+  %s [-n <nb iterations>] [-t <nb threads>] [-h]\n",
+          name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -n <nb iterations>                                   %u\n\
+     Number of detections in each image.\n\
+\n\
+  -t <nb threads>                                      %d\n\
+     Number of threads of the detector.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+          nbIterations, nbThreads);
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+bool getOptions(int argc, const char **argv, unsigned int &nbIterations, int &nbThreads)
+{
+  const char *optarg_;
+  int c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'n':
+      nbIterations = (unsigned int)atoi(optarg_);
+      break;
+    case 't':
+      nbThreads = atoi(optarg_);
+      break;
+    case 'h':
+      usage(argv[0], NULL, nbIterations, nbThreads);
+      return false;
+      break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, nbIterations, nbThreads);
+      return false;
+      break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, nbIterations, nbThreads);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Draw the tag id 0 of a family with its top left black corner at (u0, v0)
+void drawTag(vpImage<unsigned char> &I, const vpTagCode &tag, unsigned int cellSize, unsigned int u0,
+             unsigned int v0)
+{
+  unsigned int d = tag.nbBits, size = (d + 2) * cellSize;
+  for (unsigned int i = 0; i < size; i++) {
+    for (unsigned int j = 0; j < size; j++) {
+      unsigned int x = j / cellSize, y = i / cellSize;
+      bool white = false;
+      if (x > 0 && y > 0 && x <= d && y <= d) {
+        unsigned int pos = (d - y) * d + (d - x);
+        white = ((tag.code >> pos) & 1) != 0;
+      }
+      I[v0 + i][u0 + j] = white ? 255 : 0;
+    }
+  }
+}
+
+// Smooth textured background with some noise, and a grid of tags
+void drawImage(vpImage<unsigned char> &I, const vpTagCode &tag)
+{
+  srand(1);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double v = 128. + 40. * std::sin(j * 0.004) * std::cos(i * 0.006) + (rand() % 3);
+      I[i][j] = (unsigned char)v;
+    }
+  }
+
+  unsigned int cellSize = std::max(I.getHeight() / 60, 2u);
+  unsigned int tagSize = (tag.nbBits + 2) * cellSize, spacing = 3 * tagSize;
+  for (unsigned int v = tagSize; v + tagSize < I.getHeight(); v += spacing) {
+    for (unsigned int u = tagSize; u + tagSize < I.getWidth(); u += spacing) {
+      // White margin around the tag
+      for (unsigned int i = v - cellSize; i < v + tagSize + cellSize; i++) {
+        for (unsigned int j = u - cellSize; j < u + tagSize + cellSize; j++) {
+          I[i][j] = 255;
+        }
+      }
+      drawTag(I, tag, cellSize, u, v);
+    }
+  }
+}
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    unsigned int nbIterations = 3;
+    int nbThreads = 1;
+    if (!getOptions(argc, argv, nbIterations, nbThreads)) {
+      return EXIT_FAILURE;
+    }
+    nbIterations = std::max(nbIterations, 1u);
+
+    const unsigned int resolutions[][2] = {{640, 480}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+    for (size_t f = 0; f < sizeof(tagCodes) / sizeof(tagCodes[0]); f++) {
+      vpDetectorAprilTag detector(tagCodes[f].family);
+      detector.setAprilTagNbThreads(nbThreads);
+
+      for (size_t r = 0; r < sizeof(resolutions) / sizeof(resolutions[0]); r++) {
+        vpImage<unsigned char> I(resolutions[r][1], resolutions[r][0]);
+        drawImage(I, tagCodes[f]);
+
+        double quadTime = 0., decodingTime = 0., totalTime = 0.;
+        for (unsigned int iter = 0; iter < nbIterations; iter++) {
+          double t = vpTime::measureTimeMs();
+          bool detected = detector.detect(I);
+          totalTime += vpTime::measureTimeMs() - t;
+          quadTime += detector.getQuadDetectionTime();
+          decodingTime += detector.getDecodingTime();
+
+          if (!detected || detector.getMessage(0).find(" id: 0") == std::string::npos) {
+            std::cerr << "Tag " << tagCodes[f].name << " not detected in a " << I.getWidth() << "x"
+                      << I.getHeight() << " image" << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+
+        std::cout << tagCodes[f].name << " " << I.getWidth() << "x" << I.getHeight() << ": "
+                  << detector.getNbObjects() << " tags, mean times (ms): quads " << quadTime / nbIterations
+                  << ", decoding " << decodingTime / nbIterations << ", total " << totalTime / nbIterations
+                  << std::endl;
+      }
+    }
+
+    std::cout << "testPerformanceAprilTag succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "Need AprilTag to run this test" << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -67,6 +67,10 @@
     a calibration stage. We can also consider a custom tool TOOL_CUSTOM and
   set this tool during robot initialisation or using set_eMc().
 
+  To evaluate the model for many articular positions, get_fMe(), get_fMc(),
+  get_eJe() and get_fJe() have overloads taking arrays of positions in
+  structure of arrays layout. They do not allocate any memory.
+
 */
 
 #include <visp3/core/vpCameraParameters.h>
@@ -156,6 +160,11 @@ public:
   void get_eJe(const vpColVector &q, vpMatrix &eJe) const;
   void get_fJe(const vpColVector &q, vpMatrix &fJe) const;
 
+  void get_fMe(unsigned int n, const double *q, double *fMe) const;
+  void get_fMc(unsigned int n, const double *q, double *fMc) const;
+  void get_eJe(unsigned int n, const double *q, double *eJe) const;
+  void get_fJe(unsigned int n, const double *q, double *fJe) const;
+
   //! Get the current tool type
   vpAfma6ToolType getToolType() const { return tool_current; };
   //! Get the current camera model projection type
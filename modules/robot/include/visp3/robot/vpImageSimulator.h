@@ -66,6 +66,12 @@
   be filled in. By default this functionality is not used because it consumes
   lot of time.
 
+  The view is rendered row by row: along a row, the depth and the texture
+  coordinates of the plane are stepped from one pixel to the next, and only
+  the pixels inside the projection of the plane are visited. When ViSP is
+  built with OpenMP, the rows are rendered in parallel. To compose several
+  planes, the z-buffer can be an image of floats.
+
   The  following example explain how to use the class.
 
   \code
@@ -238,6 +244,8 @@ public:
 
   void getImage(vpImage<unsigned char> &I, const vpCameraParameters &cam, vpMatrix &zBuffer);
   void getImage(vpImage<vpRGBa> &I, const vpCameraParameters &cam, vpMatrix &zBuffer);
+  void getImage(vpImage<unsigned char> &I, const vpCameraParameters &cam, vpImage<float> &zBuffer);
+  void getImage(vpImage<vpRGBa> &I, const vpCameraParameters &cam, vpImage<float> &zBuffer);
 
   static void getImage(vpImage<unsigned char> &I, std::list<vpImageSimulator> &list, const vpCameraParameters &cam);
   static void getImage(vpImage<vpRGBa> &I, std::list<vpImageSimulator> &list, const vpCameraParameters &cam);
@@ -302,6 +310,13 @@ private:
 
   void getRoi(const unsigned int &Iwidth, const unsigned int &Iheight, const vpCameraParameters &cam,
               const std::vector<vpPoint> &point, vpRect &rect);
+
+  // rendu du plan ligne par ligne
+  template <class Texture, class Pixel, class Depth>
+  void render(const vpImage<Texture> &texture, vpImage<Pixel> &I, const vpCameraParameters &cam, Depth *zBuffer);
+  template <class Texture, class Pixel, class Depth>
+  void renderRow(const vpImage<Texture> &texture, unsigned int i, unsigned int left, unsigned int right,
+                 const vpCameraParameters &cam, Pixel *row, Depth *zRow) const;
 };
 
 #endif
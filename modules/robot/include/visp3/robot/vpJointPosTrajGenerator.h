@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trajectory generator for joint positioning.
+ *
+ * This code was originally part of libfranka and adapted to use ViSP instead
+ * of Eigen.
+ *
+ *****************************************************************************/
+
+#ifndef vpJointPosTrajGenerator_h
+#define vpJointPosTrajGenerator_h
+
+/*!
+  \file vpJointPosTrajGenerator.h
+  \brief Trajectory generator for joint positioning.
+*/
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpMatrix.h>
+
+/*!
+  \class vpJointPosTrajGenerator
+  \ingroup group_robot_trajectory
+
+  \brief Trajectory generator moving the joints of a robot from a start to
+  a goal position, independent of any robot.
+
+  Each joint follows a smooth velocity profile with an acceleration phase, a
+  constant velocity phase and a deceleration phase, the profiles of all the
+  joints being synchronized to reach the goal at the same time. The profiles
+  are adapted from W. Khalil and E. Dombre, Modeling, Identification and
+  Control of Robots, 2002.
+
+  The buffers are allocated by init(). Then setGoal() and the per tick
+  computePosition() do not allocate any memory, so that they can be called in
+  a real-time control loop. computeProfile() samples the whole trajectory at
+  once.
+
+  \code
+#include <visp3/robot/vpJointPosTrajGenerator.h>
+
+int main()
+{
+  vpColVector dq_max(6, 2.5), ddq_max(6, 5.), q_start(6), q_goal(6, 0.5), q(6);
+
+  vpJointPosTrajGenerator generator;
+  generator.init(dq_max, ddq_max, ddq_max, 0.2);
+  generator.setGoal(q_start, q_goal);
+  for (double t = 0.; !generator.computePosition(t, q); t += 0.001) {
+    // Send q to the robot
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpJointPosTrajGenerator
+{
+public:
+  vpJointPosTrajGenerator();
+  virtual ~vpJointPosTrajGenerator() {}
+
+  bool computePosition(double t, double *q) const;
+  bool computePosition(double t, vpColVector &q) const;
+  unsigned int computeProfile(double delta_t, vpMatrix &Q) const;
+
+  /*!
+    Return the duration of the motion to the goal, in seconds.
+  */
+  double getDuration() const { return m_t_f; }
+  /*!
+    Return the number of joints.
+  */
+  unsigned int getNbJoints() const { return m_q_goal.size(); }
+
+  void init(const vpColVector &dq_max, const vpColVector &ddq_max_start, const vpColVector &ddq_max_goal,
+            double speed_factor = 1.);
+
+  void setGoal(const double *q_start, const double *q_goal);
+  void setGoal(const vpColVector &q_start, const vpColVector &q_goal);
+
+private:
+  vpColVector m_q_goal;
+  vpColVector m_q_start;
+  vpColVector m_delta_q;
+  vpColVector m_dq_max_sync;
+  vpColVector m_t_1_sync;
+  vpColVector m_t_2_sync;
+  vpColVector m_t_f_sync;
+  vpColVector m_q_1;
+
+  vpColVector m_dq_max;
+  vpColVector m_ddq_max_start;
+  vpColVector m_ddq_max_goal;
+
+  double m_t_f;
+};
+
+#endif
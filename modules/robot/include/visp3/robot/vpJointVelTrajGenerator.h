@@ -0,0 +1,147 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trajectory generator for joint velocity control.
+ *
+ *****************************************************************************/
+
+#ifndef vpJointVelTrajGenerator_h
+#define vpJointVelTrajGenerator_h
+
+/*!
+  \file vpJointVelTrajGenerator.h
+  \brief Trajectory generator for joint velocity control.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpMatrix.h>
+
+/*!
+  \class vpJointVelTrajGenerator
+  \ingroup group_robot_trajectory
+
+  \brief Trajectory generator turning desired joint velocities into joint
+  position and velocity commands sent at a fixed period, independent of any
+  robot.
+
+  Each joint reaches its desired velocity with a bounded acceleration. The
+  joints are decelerated to stop before their limits: when a joint comes
+  close to its limit, all the joints are stopped.
+
+  The buffers are allocated by init(). Then the per tick applyVel() does not
+  allocate any memory, so that it can be called in a real-time control loop.
+  computeProfile() applies a whole sequence of desired velocities at once.
+
+  \code
+#include <visp3/robot/vpJointVelTrajGenerator.h>
+
+int main()
+{
+  vpColVector q(6), q_min(6, -2.), q_max(6, 2.), dq_max(6, 1.), ddq_max(6, 5.);
+  vpColVector dq_des(6, 0.2), q_cmd(6), dq_cmd(6);
+
+  vpJointVelTrajGenerator generator;
+  generator.init(q, q_min, q_max, dq_max, ddq_max, 0.001);
+  for (unsigned int k = 0; k < 1000; k++) {
+    generator.applyVel(dq_des, q_cmd, dq_cmd);
+    // Send q_cmd or dq_cmd to the robot
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpJointVelTrajGenerator
+{
+public:
+  vpJointVelTrajGenerator();
+  virtual ~vpJointVelTrajGenerator() {}
+
+  void applyVel(const double *dq_des, double *q_cmd, double *dq_cmd);
+  void applyVel(const vpColVector &dq_des, vpColVector &q_cmd, vpColVector &dq_cmd);
+  void computeProfile(const vpMatrix &dq_des, vpMatrix &q_cmd, vpMatrix &dq_cmd);
+
+  /*!
+    Return the index of the joint that stopped the motion during the last
+    call to applyVel() because it came close to its limit, or -1 if no joint
+    did.
+  */
+  int getJointLimitAxis() const { return m_joint_limit_axis; }
+  /*!
+    Return the number of joints.
+  */
+  unsigned int getNbJoints() const { return m_q_cmd.size(); }
+  /*!
+    Return the period between two commands, in seconds.
+  */
+  double getSamplingTime() const { return m_delta_t; }
+
+  void init(const vpColVector &q, const vpColVector &q_min, const vpColVector &q_max, const vpColVector &dq_max,
+            const vpColVector &ddq_max, double delta_t);
+
+  void limitRate(const double *max_derivatives, const double *desired_values, const double *last_desired_values,
+                 double *limited_values) const;
+
+private:
+  typedef enum {
+    FLAGACC, // Axis in acceleration
+    FLAGCTE, // Axis at constant velocity
+    FLAGDEC, // Axis in deceleration
+    FLAGSTO  // Axis stopped
+  } vpJointStatus;
+
+  void updateDistanceAD(unsigned int i);
+
+  std::vector<vpJointStatus> m_status; // Axis status
+  vpColVector m_delta_q;               // Current position increment
+  vpColVector m_delta_q_max;           // Max position increment
+  vpColVector m_delta_q_acc;           // Increment related to acceleration
+  vpColVector m_q_final;               // Final position before joint limit
+  std::vector<int> m_sign;             // Displacement sign: +1 = increment position
+  vpColVector m_q_cmd;                 // Joint position command
+  vpColVector m_q_cmd_prev;            // Previous joint position command
+  vpColVector m_dist_AD;               // Distance required to accelerate or decelerate
+  vpColVector m_dq_des;                // Desired velocity
+  vpColVector m_dq_des_prev;           // Previous desired velocity
+  std::vector<bool> m_flagSpeed;       // Change of direction in progress
+
+  vpColVector m_q_min;
+  vpColVector m_q_max;
+  vpColVector m_dq_max;
+  vpColVector m_ddq_max;
+
+  double m_delta_t;
+  bool m_flagJointLimit;
+  int m_joint_limit_axis;
+};
+
+#endif
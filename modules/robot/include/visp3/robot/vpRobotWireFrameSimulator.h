@@ -84,6 +84,23 @@
   \warning This class uses threading capabilities. Thus on Unix-like
   platforms, the libpthread third-party library need to be
   installed. On Windows, we use the native threading capabilities.
+
+  By default, a thread moves the robot in real time with the velocity given
+  by setVelocity(). In the lockstep mode enabled by setLockstepMode(), there
+  is no thread: the robot moves only when step() is called, of the sampling
+  time given by setSamplingTime(). The simulation is then deterministic and
+  as fast as possible, which is useful to test a control law on many
+  episodes:
+  \code
+  robot.setLockstepMode(true);
+  robot.setSamplingTime(0.040);
+  for (unsigned int iter = 0; iter < 1000; iter++) {
+    robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+    ... // compute v from the state of the robot
+    robot.setVelocity(vpRobot::CAMERA_FRAME, v);
+    robot.step();
+  }
+  \endcode
 */
 class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, public vpRobotSimulator
 {
@@ -176,6 +193,12 @@ protected:
 
   bool verbose_;
 
+  //! Flag used to move the robot only when step() is called, without thread.
+  //! False by default.
+  bool lockstepMode;
+  //! Simulation time in second in the lockstep mode
+  double simulationTime;
+
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
   //    vpRobotWireFrameSimulator(const vpRobotWireFrameSimulator &)
@@ -247,6 +270,17 @@ public:
   void getInternalView(vpImage<unsigned char> &I);
 
   vpHomogeneousMatrix get_cMo();
+  /*!
+    Tells if the robot moves only when step() is called.
+  */
+  bool getLockstepMode() const { return lockstepMode; }
+  /*!
+    Get the simulation time in the lockstep mode, that is the sum of the
+    sampling times of the calls to step().
+
+    \return The simulation time in second.
+  */
+  double getSimulationTime() const { return simulationTime; }
   /*!
     Get the pose between the object and the fixed world frame.
 
@@ -281,6 +315,8 @@ public:
     constantSamplingTimeMode = _constantSamplingTimeMode;
   }
 
+  void setLockstepMode(bool lockstep);
+
   /*!
     Set the color used to display the object at the current position in the
     robot's camera view.
@@ -337,12 +373,13 @@ public:
     displacement from the velocity applied to the robot during this time.
 
     Since the wireframe simulator is threaded, the sampling time is set to
-    vpTime::getMinTimeForUsleepCall() / 1000 seconds.
+    vpTime::getMinTimeForUsleepCall() / 1000 seconds. There is no such limit
+    in the lockstep mode (see setLockstepMode()).
 
   */
   inline void setSamplingTime(const double &delta_t)
   {
-    if (delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)) {
+    if (!lockstepMode && delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)) {
       this->delta_t_ = static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3);
     } else {
       this->delta_t_ = delta_t;
@@ -362,6 +399,8 @@ public:
     \param fMo_ : The pose between the object and the fixed world frame.
   */
   void set_fMo(const vpHomogeneousMatrix &fMo_) { this->fMo = fMo_; }
+
+  void step();
   //@}
 
 protected:
@@ -386,11 +425,21 @@ protected:
   }
 #endif
 
+  void launchThread();
+  void joinThread();
+
   /* Robot functions */
   void init() { ; }
   /*! Method lauched by the thread to compute the position of the robot in the
    * articular frame. */
   virtual void updateArticularPosition() = 0;
+  /*! Move the robot in the articular frame with the articular velocity during
+   * \e ellapsedTime seconds, and update the external view. */
+  virtual void computeArticularPosition(double ellapsedTime) = 0;
+  /*! Timestamp of the measures: the simulation time in the lockstep mode, the
+   * Unix time otherwise. */
+  double getTimestamp() const { return lockstepMode ? simulationTime : vpTime::measureTimeSecond(); }
+  void stepArticularPosition();
   /*! Method used to check if the robot reached a joint limit. */
   virtual int isInJointLimit() = 0;
   /*! Compute the articular velocity relative to the velocity in another
@@ -266,6 +266,7 @@ protected:
     pthread_mutex_unlock(&mutex_fMi);
 #endif
   }
+  void computeArticularPosition(double ellapsedTime);
   void init();
   void initArms();
   void initDisplay();
@@ -109,6 +109,12 @@
   from joint ones is given and implemented in get_fJw(), get_fJe() and
   get_eJe().
 
+  To evaluate the model for many configurations, for instance to plan a
+  trajectory or to check collisions on samples, get_fMe(), get_fMc(),
+  get_fJe() and get_eJe() have overloads taking arrays of joint
+  configurations in structure of arrays layout. They do not allocate any
+  memory, and they are const so that several threads can share the model.
+
 */
 class VISP_EXPORT vpViper
 {
@@ -136,6 +142,11 @@ public:
   void get_fJe(const vpColVector &q, vpMatrix &fJe) const;
   void get_eJe(const vpColVector &q, vpMatrix &eJe) const;
 
+  void get_fMe(unsigned int n, const double *q, double *fMe) const;
+  void get_fMc(unsigned int n, const double *q, double *fMc) const;
+  void get_fJe(unsigned int n, const double *q, double *fJe) const;
+  void get_eJe(unsigned int n, const double *q, double *eJe) const;
+
   virtual void set_eMc(const vpHomogeneousMatrix &eMc_);
   virtual void set_eMc(const vpTranslationVector &etc_, const vpRxyzVector &erc_);
 
@@ -49,6 +49,7 @@
 #include <list>
 #include <stdio.h>
 #include <string>
+#include <vector>
 #include <visp3/core/vpConfig.h>
 
 #include <visp3/core/vpConfig.h>
@@ -281,6 +282,15 @@ protected:
 private:
   std::string scene_dir;
 
+  // Object at the current position compiled for getInternalImages():
+  // coordinates of the vertices, indexes of the vertices of the faces and
+  // index of the first vertex of each face
+  std::vector<double> sceneVertices;
+  std::vector<unsigned int> sceneFaceVertices;
+  std::vector<unsigned int> sceneFaceStarts;
+  bool cullBackFaces;
+  bool sceneCompiled;
+
 public:
   vpWireFrameSimulator();
   virtual ~vpWireFrameSimulator();
@@ -396,6 +406,10 @@ public:
 
   void getInternalImage(vpImage<unsigned char> &I);
   void getInternalImage(vpImage<vpRGBa> &I);
+  void getInternalImages(std::vector<vpImage<unsigned char> > &I, const std::vector<vpHomogeneousMatrix> &cMo,
+                         const vpCameraParameters &cam, unsigned int height, unsigned int width);
+  void getInternalImages(std::vector<vpImage<vpRGBa> > &I, const std::vector<vpHomogeneousMatrix> &cMo,
+                         const vpCameraParameters &cam, unsigned int height, unsigned int width);
 
   /*!
       Get the pose between the object and the camera.
@@ -604,6 +618,12 @@ protected:
   vpImagePoint projectCameraTrajectory(const vpImage<unsigned char> &I, const vpHomogeneousMatrix &cMo,
                                        const vpHomogeneousMatrix &fMo, const vpHomogeneousMatrix &cMf);
   //@}
+
+private:
+  void compileScene();
+  template <class Type>
+  void renderInternalImages(std::vector<vpImage<Type> > &I, const std::vector<vpHomogeneousMatrix> &cMo,
+                            const vpCameraParameters &cam, unsigned int height, unsigned int width);
 };
 
 #endif
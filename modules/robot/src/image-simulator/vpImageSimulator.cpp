@@ -37,6 +37,9 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpMatrixException.h>
 #include <visp3/core/vpMeterPixelConversion.h>
@@ -49,6 +52,41 @@
 #include <visp3/io/vpImageIo.h>
 #endif
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Pixel of the view of the camera from a pixel of the texture
+inline void convertPixel(const unsigned char &src, unsigned char &dst) { dst = src; }
+
+inline void convertPixel(const vpRGBa &src, unsigned char &dst)
+{
+  dst = (unsigned char)(0.2126 * src.R + 0.7152 * src.G + 0.0722 * src.B);
+}
+
+inline void convertPixel(const unsigned char &src, vpRGBa &dst)
+{
+  dst = vpRGBa();
+  dst.R = src;
+  dst.G = src;
+  dst.B = src;
+}
+
+inline void convertPixel(const vpRGBa &src, vpRGBa &dst) { dst = src; }
+
+// Restricts the range [kmin, kmax[ of the pixels of a row to the ones where
+// a + b k > 0, with a margin of one pixel for the rounding errors
+void clipSpan(double a, double b, double &kmin, double &kmax)
+{
+  if (b > 0)
+    kmin = std::max(kmin, std::floor(-a / b));
+  else if (b < 0)
+    kmax = std::min(kmax, std::ceil(-a / b) + 1.);
+  else if (a <= 0)
+    kmax = kmin;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Basic constructor.
 
@@ -181,6 +219,130 @@ vpImageSimulator &vpImageSimulator::operator=(const vpImageSimulator &sim)
   return *this;
 }
 
+/*!
+  Render the plane in the region of interest of the image, with the texture
+  given as argument. The rows of the image are rendered in parallel.
+
+  \param texture : The image which is projected.
+  \param I : The image used to store the result.
+  \param cam : The parameters of the virtual camera.
+  \param zBuffer : The z coordinates of the pixels of the image \f$ I \f$,
+  updated with the ones of the plane where it hides what was rendered before,
+  or NULL to render the plane over the image.
+*/
+template <class Texture, class Pixel, class Depth>
+void vpImageSimulator::render(const vpImage<Texture> &texture, vpImage<Pixel> &I, const vpCameraParameters &cam,
+                              Depth *zBuffer)
+{
+  if (!needClipping)
+    getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
+  else
+    getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
+
+  unsigned int top = (unsigned int)rect.getTop();
+  unsigned int bottom = (unsigned int)rect.getBottom();
+  unsigned int left = (unsigned int)rect.getLeft();
+  unsigned int right = (unsigned int)rect.getRight();
+  unsigned int width = I.getWidth();
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = (int)top; i < (int)bottom; i++) {
+    renderRow(texture, (unsigned int)i, left, right, cam, I[(unsigned int)i],
+              zBuffer == NULL ? NULL : zBuffer + (size_t)i * width);
+  }
+}
+
+/*!
+  Render the plane in the columns [left, right[ of the row \e i of an image.
+
+  The depth and the texture coordinates of the plane are projective functions
+  of the normalized coordinates of the pixels. Without distortion, their
+  numerators and denominator are stepped from one pixel to the next, and the
+  pixels that can be inside the plane are found from their signs along the
+  row. With distortion, they are computed at each pixel.
+
+  \param texture : The image which is projected.
+  \param i : The row of the image.
+  \param left, right : The columns of the image.
+  \param cam : The parameters of the virtual camera.
+  \param row : The pixels of the row.
+  \param zRow : The z coordinates of the pixels of the row, or NULL.
+*/
+template <class Texture, class Pixel, class Depth>
+void vpImageSimulator::renderRow(const vpImage<Texture> &texture, unsigned int i, unsigned int left,
+                                 unsigned int right, const vpCameraParameters &cam, Pixel *row, Depth *zRow) const
+{
+  if (right <= left)
+    return;
+
+  const double *n = normal_Cam_optim;
+  const double *bu = vbase_u_optim;
+  const double *bv = vbase_v_optim;
+  // Coordinates u and v of the point at (x, y) in the texture, between 0 and
+  // 1, are (Z * (bu . (x, y, 1)) - cu) / nu2 with Z = distance / (n . (x, y, 1))
+  double cu = X0_2_optim[0] * bu[0] + X0_2_optim[1] * bu[1] + X0_2_optim[2] * bu[2];
+  double cv = X0_2_optim[0] * bv[0] + X0_2_optim[1] * bv[1] + X0_2_optim[2] * bv[2];
+  double nu2 = euclideanNorm_u * euclideanNorm_u;
+  double nv2 = euclideanNorm_v * euclideanNorm_v;
+  double textureHeight = texture.getHeight() - 1.;
+  double textureWidth = texture.getWidth() - 1.;
+  bool stepped = cam.get_projModel() == vpCameraParameters::perspectiveProjWithoutDistortion;
+
+  double x = 0, y = 0;
+  vpPixelMeterConversion::convertPoint(cam, (double)left, (double)i, x, y);
+  double den = n[0] * x + n[1] * y + n[2];
+  double numU = bu[0] * x + bu[1] * y + bu[2];
+  double numV = bv[0] * x + bv[1] * y + bv[2];
+  double dx = 1. / cam.get_px();
+  double dDen = n[0] * dx, dNumU = bu[0] * dx, dNumV = bv[0] * dx;
+
+  unsigned int start = left, end = right;
+  if (stepped) {
+    // Pixels where the ray hits the plane in front of the camera and inside
+    // the texture
+    double kmin = 0., kmax = right - left;
+    clipSpan(den, dDen, kmin, kmax);
+    clipSpan(distance * numU - cu * den, distance * dNumU - cu * dDen, kmin, kmax);
+    clipSpan((cu + nu2) * den - distance * numU, (cu + nu2) * dDen - distance * dNumU, kmin, kmax);
+    clipSpan(distance * numV - cv * den, distance * dNumV - cv * dDen, kmin, kmax);
+    clipSpan((cv + nv2) * den - distance * numV, (cv + nv2) * dDen - distance * dNumV, kmin, kmax);
+    if (kmax <= kmin)
+      return;
+    start = left + (unsigned int)kmin;
+    end = left + (unsigned int)kmax;
+    den += kmin * dDen;
+    numU += kmin * dNumU;
+    numV += kmin * dNumV;
+  }
+
+  for (unsigned int j = start; j < end; j++) {
+    if (!stepped) {
+      vpPixelMeterConversion::convertPoint(cam, (double)j, (double)i, x, y);
+      den = n[0] * x + n[1] * y + n[2];
+      numU = bu[0] * x + bu[1] * y + bu[2];
+      numV = bv[0] * x + bv[1] * y + bv[2];
+    }
+    if (den > 0) {
+      double z = distance / den;
+      double u = (z * numU - cu) / nu2;
+      double v = (z * numV - cv) / nv2;
+      if (u > 0 && v > 0 && u < 1. && v < 1. && (zRow == NULL || (Depth)z < zRow[j] || zRow[j] < 0)) {
+        if (interp == BILINEAR_INTERPOLATION)
+          convertPixel(texture.getValue(v * textureHeight, u * textureWidth), row[j]);
+        else
+          convertPixel(texture[(unsigned int)(v * textureHeight)][(unsigned int)(u * textureWidth)], row[j]);
+        if (zRow != NULL)
+          zRow[j] = (Depth)z;
+      }
+    }
+    den += dDen;
+    numU += dNumU;
+    numV += dNumV;
+  }
+}
+
 /*!
   Get the view of the virtual camera. Be careful, the image I is modified. The
   projected image is not added as an overlay! \param I : The image used to
@@ -203,44 +365,10 @@ void vpImageSimulator::getImage(vpImage<unsigned char> &I, const vpCameraParamet
   }
 
   if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        if (colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan = 0;
-          if (getPixel(ip, Ipixelplan)) {
-            *(bitmap + i * width + j) = Ipixelplan;
-            nb_point_dessine++;
-          }
-        } else if (colorI == COLORED) {
-          vpRGBa Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            unsigned char pixelgrey =
-                (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-            *(bitmap + i * width + j) = pixelgrey;
-            nb_point_dessine++;
-          }
-        }
-      }
-    }
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, (float *)NULL);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, (float *)NULL);
   }
 }
 
@@ -263,36 +391,8 @@ void vpImageSimulator::getImage(vpImage<unsigned char> &I, vpImage<unsigned char
       }
     }
   }
-  if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        unsigned char Ipixelplan = 0;
-        if (getPixel(Isrc, ip, Ipixelplan)) {
-          *(bitmap + i * width + j) = Ipixelplan;
-          nb_point_dessine++;
-        }
-      }
-    }
-  }
+  if (visible)
+    render(Isrc, I, cam, (float *)NULL);
 }
 
 /*!
@@ -325,51 +425,45 @@ void vpImageSimulator::getImage(vpImage<unsigned char> &I, const vpCameraParamet
     }
   }
   if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        if (colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0) {
-              *(bitmap + i * width + j) = Ipixelplan;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        } else if (colorI == COLORED) {
-          vpRGBa Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0) {
-              unsigned char pixelgrey =
-                  (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-              *(bitmap + i * width + j) = pixelgrey;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, zBuffer.data);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, zBuffer.data);
+  }
+}
+
+/*!
+  Get the view of the virtual camera, as getImage(vpImage<unsigned char> &, const
+  vpCameraParameters &, vpMatrix &), with a z-buffer of floats that takes
+  half the memory of a vpMatrix.
+
+  The pixels of \f$ zBuffer \f$ with a negative value are the ones where
+  nothing has been projected yet.
+
+  \param I : The image used to store the result.
+  \param cam : The parameters of the virtual camera.
+  \param zBuffer : An image containing the z coordinates of the pixels of
+  the image \f$ I \f$.
+*/
+void vpImageSimulator::getImage(vpImage<unsigned char> &I, const vpCameraParameters &cam, vpImage<float> &zBuffer)
+{
+  if (I.getWidth() != zBuffer.getWidth() || I.getHeight() != zBuffer.getHeight())
+    throw(vpException(vpException::dimensionError, "zBuffer must have the same size as the image I"));
+
+  if (cleanPrevImage) {
+    unsigned char col = (unsigned char)(0.2126 * bgColor.R + 0.7152 * bgColor.G + 0.0722 * bgColor.B);
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        I[i][j] = col;
       }
     }
   }
+  if (visible) {
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, zBuffer.bitmap);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, zBuffer.bitmap);
+  }
 }
 
 /*!
@@ -390,46 +484,10 @@ void vpImageSimulator::getImage(vpImage<vpRGBa> &I, const vpCameraParameters &ca
   }
 
   if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        if (colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            vpRGBa pixelcolor;
-            pixelcolor.R = Ipixelplan;
-            pixelcolor.G = Ipixelplan;
-            pixelcolor.B = Ipixelplan;
-            *(bitmap + i * width + j) = pixelcolor;
-            nb_point_dessine++;
-          }
-        } else if (colorI == COLORED) {
-          vpRGBa Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            *(bitmap + i * width + j) = Ipixelplan;
-            nb_point_dessine++;
-          }
-        }
-      }
-    }
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, (float *)NULL);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, (float *)NULL);
   }
 }
 
@@ -452,36 +510,8 @@ void vpImageSimulator::getImage(vpImage<vpRGBa> &I, vpImage<vpRGBa> &Isrc, const
     }
   }
 
-  if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        vpRGBa Ipixelplan;
-        if (getPixel(Isrc, ip, Ipixelplan)) {
-          *(bitmap + i * width + j) = Ipixelplan;
-          nb_point_dessine++;
-        }
-      }
-    }
-  }
+  if (visible)
+    render(Isrc, I, cam, (float *)NULL);
 }
 
 /*!
@@ -513,53 +543,44 @@ void vpImageSimulator::getImage(vpImage<vpRGBa> &I, const vpCameraParameters &ca
     }
   }
   if (visible) {
-    if (!needClipping)
-      getRoi(I.getWidth(), I.getHeight(), cam, pt, rect);
-    else
-      getRoi(I.getWidth(), I.getHeight(), cam, ptClipped, rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right = rect.getRight();
-
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++) {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++) {
-        double x = 0, y = 0;
-        ip.set_ij(i, j);
-        vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-        ip.set_ij(y, x);
-        if (colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0) {
-              vpRGBa pixelcolor;
-              pixelcolor.R = Ipixelplan;
-              pixelcolor.G = Ipixelplan;
-              pixelcolor.B = Ipixelplan;
-              *(bitmap + i * width + j) = pixelcolor;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        } else if (colorI == COLORED) {
-          vpRGBa Ipixelplan;
-          if (getPixel(ip, Ipixelplan)) {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0) {
-              *(bitmap + i * width + j) = Ipixelplan;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, zBuffer.data);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, zBuffer.data);
+  }
+}
+
+/*!
+  Get the view of the virtual camera, as getImage(vpImage<vpRGBa> &, const
+  vpCameraParameters &, vpMatrix &), with a z-buffer of floats that takes
+  half the memory of a vpMatrix.
+
+  The pixels of \f$ zBuffer \f$ with a negative value are the ones where
+  nothing has been projected yet.
+
+  \param I : The image used to store the result.
+  \param cam : The parameters of the virtual camera.
+  \param zBuffer : An image containing the z coordinates of the pixels of
+  the image \f$ I \f$.
+*/
+void vpImageSimulator::getImage(vpImage<vpRGBa> &I, const vpCameraParameters &cam, vpImage<float> &zBuffer)
+{
+  if (I.getWidth() != zBuffer.getWidth() || I.getHeight() != zBuffer.getHeight())
+    throw(vpException(vpException::dimensionError, "zBuffer must have the same size as the image I"));
+
+  if (cleanPrevImage) {
+    for (unsigned int i = 0; i < I.getHeight(); i++) {
+      for (unsigned int j = 0; j < I.getWidth(); j++) {
+        I[i][j] = bgColor;
       }
     }
   }
+  if (visible) {
+    if (colorI == GRAY_SCALED)
+      render(Ig, I, cam, zBuffer.bitmap);
+    else if (colorI == COLORED)
+      render(Ic, I, cam, zBuffer.bitmap);
+  }
 }
 
 /*!
@@ -683,15 +704,13 @@ void vpImageSimulator::getImage(vpImage<unsigned char> &I, std::list<vpImageSimu
   double topFinal = height + 1;
   ;
   double bottomFinal = -1;
-  double leftFinal = width + 1;
-  double rightFinal = -1;
 
   unsigned int unvisible = 0;
   unsigned int indexSimu = 0;
-  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it, ++indexSimu) {
+  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it) {
     vpImageSimulator *sim = &(*it);
     if (sim->visible)
-      simList[indexSimu] = sim;
+      simList[indexSimu++] = sim;
     else
       unvisible++;
   }
@@ -712,46 +731,25 @@ void vpImageSimulator::getImage(vpImage<unsigned char> &I, std::list<vpImageSimu
       topFinal = simList[i]->rect.getTop();
     if (bottomFinal < simList[i]->rect.getBottom())
       bottomFinal = simList[i]->rect.getBottom();
-    if (leftFinal > simList[i]->rect.getLeft())
-      leftFinal = simList[i]->rect.getLeft();
-    if (rightFinal < simList[i]->rect.getRight())
-      rightFinal = simList[i]->rect.getRight();
   }
 
-  double zmin = -1;
-  int indice = -1;
-  unsigned char *bitmap = I.bitmap;
-  vpImagePoint ip;
-
-  for (unsigned int i = (unsigned int)topFinal; i < (unsigned int)bottomFinal; i++) {
-    for (unsigned int j = (unsigned int)leftFinal; j < (unsigned int)rightFinal; j++) {
-      zmin = -1;
-      double x = 0, y = 0;
-      ip.set_ij(i, j);
-      vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-      ip.set_ij(y, x);
-      for (int k = 0; k < (int)nbsimList; k++) {
-        double z = 0;
-        if (simList[k]->getPixelDepth(ip, z)) {
-          if (z < zmin || zmin < 0) {
-            zmin = z;
-            indice = k;
-          }
-        }
-      }
-      if (indice >= 0) {
-        if (simList[indice]->colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan = 255;
-          simList[indice]->getPixel(ip, Ipixelplan);
-          *(bitmap + i * width + j) = Ipixelplan;
-        } else if (simList[indice]->colorI == COLORED) {
-          vpRGBa Ipixelplan(255, 255, 255);
-          simList[indice]->getPixel(ip, Ipixelplan);
-          unsigned char pixelgrey =
-              (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-          *(bitmap + i * width + j) = pixelgrey;
-        }
-      }
+  // The planes are rendered one after the other in each row of their region
+  // of interest, the nearest one hiding the others
+  vpImage<float> zBuffer(height, width, -1.f);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = (int)topFinal; i < (int)bottomFinal; i++) {
+    for (unsigned int k = 0; k < nbsimList; k++) {
+      const vpImageSimulator *sim = simList[k];
+      if (i < (int)sim->rect.getTop() || i >= (int)sim->rect.getBottom())
+        continue;
+      unsigned int left = (unsigned int)sim->rect.getLeft(), right = (unsigned int)sim->rect.getRight();
+      if (sim->colorI == GRAY_SCALED)
+        sim->renderRow(sim->Ig, (unsigned int)i, left, right, cam, I[(unsigned int)i], zBuffer[(unsigned int)i]);
+      else if (sim->colorI == COLORED)
+        sim->renderRow(sim->Ic, (unsigned int)i, left, right, cam, I[(unsigned int)i], zBuffer[(unsigned int)i]);
     }
   }
 
@@ -880,15 +878,13 @@ void vpImageSimulator::getImage(vpImage<vpRGBa> &I, std::list<vpImageSimulator>
   double topFinal = height + 1;
   ;
   double bottomFinal = -1;
-  double leftFinal = width + 1;
-  double rightFinal = -1;
 
   unsigned int unvisible = 0;
   unsigned int indexSimu = 0;
-  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it, ++indexSimu) {
+  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it) {
     vpImageSimulator *sim = &(*it);
     if (sim->visible)
-      simList[indexSimu] = sim;
+      simList[indexSimu++] = sim;
     else
       unvisible++;
   }
@@ -910,50 +906,25 @@ void vpImageSimulator::getImage(vpImage<vpRGBa> &I, std::list<vpImageSimulator>
       topFinal = simList[i]->rect.getTop();
     if (bottomFinal < simList[i]->rect.getBottom())
       bottomFinal = simList[i]->rect.getBottom();
-    if (leftFinal > simList[i]->rect.getLeft())
-      leftFinal = simList[i]->rect.getLeft();
-    if (rightFinal < simList[i]->rect.getRight())
-      rightFinal = simList[i]->rect.getRight();
   }
 
-  double zmin = -1;
-  int indice = -1;
-  vpRGBa *bitmap = I.bitmap;
-  vpImagePoint ip;
-
-  for (unsigned int i = (unsigned int)topFinal; i < (unsigned int)bottomFinal; i++) {
-    for (unsigned int j = (unsigned int)leftFinal; j < (unsigned int)rightFinal; j++) {
-      zmin = -1;
-      double x = 0, y = 0;
-      ip.set_ij(i, j);
-      vpPixelMeterConversion::convertPoint(cam, ip, x, y);
-      ip.set_ij(y, x);
-      for (int k = 0; k < (int)nbsimList; k++) {
-        double z = 0;
-        if (simList[k]->getPixelDepth(ip, z)) {
-          if (z < zmin || zmin < 0) {
-            zmin = z;
-            indice = k;
-          }
-        }
-      }
-      if (indice >= 0) {
-        if (simList[indice]->colorI == GRAY_SCALED) {
-          unsigned char Ipixelplan = 255;
-          simList[indice]->getPixel(ip, Ipixelplan);
-          vpRGBa pixelcolor;
-          pixelcolor.R = Ipixelplan;
-          pixelcolor.G = Ipixelplan;
-          pixelcolor.B = Ipixelplan;
-          *(bitmap + i * width + j) = pixelcolor;
-        } else if (simList[indice]->colorI == COLORED) {
-          vpRGBa Ipixelplan(255, 255, 255);
-          simList[indice]->getPixel(ip, Ipixelplan);
-          // unsigned char pixelgrey = 0.2126 * Ipixelplan.R + 0.7152 *
-          // Ipixelplan.G + 0.0722 * Ipixelplan.B;
-          *(bitmap + i * width + j) = Ipixelplan;
-        }
-      }
+  // The planes are rendered one after the other in each row of their region
+  // of interest, the nearest one hiding the others
+  vpImage<float> zBuffer(height, width, -1.f);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i = (int)topFinal; i < (int)bottomFinal; i++) {
+    for (unsigned int k = 0; k < nbsimList; k++) {
+      const vpImageSimulator *sim = simList[k];
+      if (i < (int)sim->rect.getTop() || i >= (int)sim->rect.getBottom())
+        continue;
+      unsigned int left = (unsigned int)sim->rect.getLeft(), right = (unsigned int)sim->rect.getRight();
+      if (sim->colorI == GRAY_SCALED)
+        sim->renderRow(sim->Ig, (unsigned int)i, left, right, cam, I[(unsigned int)i], zBuffer[(unsigned int)i]);
+      else if (sim->colorI == COLORED)
+        sim->renderRow(sim->Ic, (unsigned int)i, left, right, cam, I[(unsigned int)i], zBuffer[(unsigned int)i]);
     }
   }
 
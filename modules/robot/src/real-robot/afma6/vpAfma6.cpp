@@ -964,6 +964,191 @@ void vpAfma6::get_fJe(const vpColVector &q, vpMatrix &fJe) const
   return;
 }
 
+/*!
+
+  Compute the forward kinematics \f${^f}{\bf M}_e\f$ for a batch of
+  articular positions, without any memory allocation.
+
+  The positions are stored in structure of arrays layout: the joint \e j of
+  the position \e i is \e q[j * n + i]. The matrices are stored in the same
+  layout without their last row: the element \e (r, c) of the matrix of the
+  position \e i is \e fMe[(4 * r + c) * n + i].
+
+  \param n : Number of articular positions.
+
+  \param q : Array of 6 x \e n joint positions, the 3 translations
+  expressed in meter, then the 3 rotations expressed in radians.
+
+  \param fMe : Array of 12 x \e n elements, filled with the first 3 rows of
+  the homogeneous matrices \f${^f}{\bf M}_e\f$.
+
+  \sa get_fMe(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void vpAfma6::get_fMe(unsigned int n, const double *q, double *fMe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    double c1 = cos(q[3 * n + i]);
+    double s1 = sin(q[3 * n + i]);
+    double c2 = cos(q[4 * n + i]);
+    double s2 = sin(q[4 * n + i]);
+    double q5 = q[5 * n + i] - this->_coupl_56 * q[4 * n + i];
+    double c3 = cos(q5);
+    double s3 = sin(q5);
+
+    double *M = fMe + i;
+    M[0] = s1 * s2 * c3 + c1 * s3;
+    M[n] = -s1 * s2 * s3 + c1 * c3;
+    M[2 * n] = -s1 * c2;
+    M[3 * n] = q[i] + this->_long_56 * c1;
+
+    M[4 * n] = -c1 * s2 * c3 + s1 * s3;
+    M[5 * n] = c1 * s2 * s3 + s1 * c3;
+    M[6 * n] = c1 * c2;
+    M[7 * n] = q[n + i] + this->_long_56 * s1;
+
+    M[8 * n] = c2 * c3;
+    M[9 * n] = -c2 * s3;
+    M[10 * n] = s2;
+    M[11 * n] = q[2 * n + i];
+  }
+}
+
+/*!
+
+  Compute the forward kinematics \f${^f}{\bf M}_c\f$ for a batch of
+  articular positions, without any memory allocation.
+
+  \param n : Number of articular positions.
+
+  \param q : Array of 6 x \e n joint positions, in the layout described in
+  get_fMe(unsigned int, const double *, double *) const.
+
+  \param fMc : Array of 12 x \e n elements, filled with the first 3 rows of
+  the homogeneous matrices \f${^f}{\bf M}_c\f$.
+
+  \sa get_fMc(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void vpAfma6::get_fMc(unsigned int n, const double *q, double *fMc) const
+{
+  get_fMe(n, q, fMc);
+
+  double E[12];
+  for (unsigned int k = 0; k < 12; k++) {
+    E[k] = _eMc[k / 4][k % 4];
+  }
+  for (unsigned int i = 0; i < n; i++) {
+    double *M = fMc + i;
+    for (unsigned int r = 0; r < 3; r++) {
+      double m0 = M[(4 * r) * n], m1 = M[(4 * r + 1) * n], m2 = M[(4 * r + 2) * n];
+      for (unsigned int c = 0; c < 4; c++) {
+        M[(4 * r + c) * n] = m0 * E[c] + m1 * E[4 + c] + m2 * E[8 + c] + (c == 3 ? M[(4 * r + 3) * n] : 0.);
+      }
+    }
+  }
+}
+
+/*!
+
+  Compute the robot jacobian expressed in the end-effector frame for a batch
+  of articular positions, without any memory allocation.
+
+  \param n : Number of articular positions.
+
+  \param q : Array of 6 x \e n joint positions, in the layout described in
+  get_fMe(unsigned int, const double *, double *) const.
+
+  \param eJe : Array of 36 x \e n elements: the element \e (r, c) of the
+  jacobian of the position \e i is \e eJe[(6 * r + c) * n + i].
+
+  \sa get_eJe(const vpColVector &, vpMatrix &) const
+*/
+void vpAfma6::get_eJe(unsigned int n, const double *q, double *eJe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    double s4 = sin(q[3 * n + i]);
+    double c4 = cos(q[3 * n + i]);
+    double s5 = sin(q[4 * n + i]);
+    double c5 = cos(q[4 * n + i]);
+    double s6 = sin(q[5 * n + i] - this->_coupl_56 * q[4 * n + i]);
+    double c6 = cos(q[5 * n + i] - this->_coupl_56 * q[4 * n + i]);
+
+    double *J = eJe + i;
+    J[0] = s4 * s5 * c6 + c4 * s6;
+    J[n] = -c4 * s5 * c6 + s4 * s6;
+    J[2 * n] = c5 * c6;
+    J[3 * n] = -this->_long_56 * s5 * c6;
+    J[4 * n] = J[5 * n] = 0;
+
+    J[6 * n] = -s4 * s5 * s6 + c4 * c6;
+    J[7 * n] = c4 * s5 * s6 + s4 * c6;
+    J[8 * n] = -c5 * s6;
+    J[9 * n] = this->_long_56 * s5 * s6;
+    J[10 * n] = J[11 * n] = 0;
+
+    J[12 * n] = -s4 * c5;
+    J[13 * n] = c4 * c5;
+    J[14 * n] = s5;
+    J[15 * n] = this->_long_56 * c5;
+    J[16 * n] = J[17 * n] = 0;
+
+    J[18 * n] = J[19 * n] = J[20 * n] = 0;
+    J[21 * n] = c5 * c6;
+    J[22 * n] = s6;
+    J[23 * n] = 0;
+
+    J[24 * n] = J[25 * n] = J[26 * n] = 0;
+    J[27 * n] = -c5 * s6;
+    J[28 * n] = c6;
+    J[29 * n] = 0;
+
+    J[30 * n] = J[31 * n] = J[32 * n] = 0;
+    J[33 * n] = s5;
+    J[34 * n] = -this->_coupl_56;
+    J[35 * n] = 1;
+  }
+}
+
+/*!
+
+  Compute the robot jacobian expressed in the robot reference frame for a
+  batch of articular positions, without any memory allocation.
+
+  \param n : Number of articular positions.
+
+  \param q : Array of 6 x \e n joint positions, in the layout described in
+  get_fMe(unsigned int, const double *, double *) const.
+
+  \param fJe : Array of 36 x \e n elements: the element \e (r, c) of the
+  jacobian of the position \e i is \e fJe[(6 * r + c) * n + i].
+
+  \sa get_fJe(const vpColVector &, vpMatrix &) const
+*/
+void vpAfma6::get_fJe(unsigned int n, const double *q, double *fJe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    double s4 = sin(q[3 * n + i]);
+    double c4 = cos(q[3 * n + i]);
+    double s5 = sin(q[4 * n + i]);
+    double c5 = cos(q[4 * n + i]);
+
+    double *J = fJe + i;
+    for (unsigned int k = 0; k < 36; k++) {
+      J[k * n] = 0;
+    }
+    J[0] = J[7 * n] = J[14 * n] = 1;
+    J[3 * n] = -this->_long_56 * s4;
+    J[9 * n] = this->_long_56 * c4;
+
+    J[22 * n] = c4 + this->_coupl_56 * s4 * c5;
+    J[23 * n] = -s4 * c5;
+    J[28 * n] = s4 - this->_coupl_56 * c4 * c5;
+    J[29 * n] = c4 * c5;
+    J[33 * n] = 1;
+    J[34 * n] = -this->_coupl_56 * s5;
+    J[35 * n] = s5;
+  }
+}
+
 /*!
   Get min joint values.
 
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Franka adapter of the trajectory generator for joint positioning.
+ *
+ * This code was originally part of libfranka and adapted to use ViSP instead
+ * of Eigen.
+ *
+ * Authors:
+ * Fabien Spindler
+ *
+ *****************************************************************************/
+
+#include <visp3/core/vpConfig.h>
+
+#ifdef VISP_HAVE_FRANKA
+
+#include "vpFrankaJointPosTrajGenerator_impl.h"
+
+vpFrankaJointPosTrajGenerator::vpFrankaJointPosTrajGenerator(double speed_factor, const std::array<double, 7> &q_goal)
+  : m_generator(), m_q_goal(q_goal)
+{
+  m_generator.init(vpColVector(7, 2.5), vpColVector(7, 5.), vpColVector(7, 5.), speed_factor);
+}
+
+franka::JointPositions vpFrankaJointPosTrajGenerator::operator()(const franka::RobotState& robot_state,
+                                                                 franka::Duration period) {
+  m_time += period.toSec();
+
+  if (m_time == 0.0) {
+    m_generator.setGoal(robot_state.q_d.data(), m_q_goal.data());
+  }
+
+  std::array<double, 7> joint_positions;
+  bool motion_finished = m_generator.computePosition(m_time, joint_positions.data());
+
+  franka::JointPositions output(joint_positions);
+  output.motion_finished = motion_finished;
+  return output;
+}
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_robot.a(vpFrankaJointPosTrajGenerator_impl.cpp.o) has no symbols
+void dummy_vpFrankaJointPosTrajGenerator(){};
+#endif
@@ -29,7 +29,7 @@
  * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
  *
  * Description:
- * Trajectory generator for joint positioning.
+ * Franka adapter of the trajectory generator for joint positioning.
  *
  * This code was originally part of libfranka and adapted to use ViSP instead
  * of Eigen.
@@ -38,31 +38,25 @@
  * Fabien Spindler
  *
  *****************************************************************************/
-#ifndef __vpJointPosTrajGenerator_impl_h_
-#define __vpJointPosTrajGenerator_impl_h_
+#ifndef __vpFrankaJointPosTrajGenerator_impl_h_
+#define __vpFrankaJointPosTrajGenerator_impl_h_
 
 #include <array>
-#include <iostream>
-#include <atomic>
 
 #include <visp3/core/vpConfig.h>
 
-#include <visp3/core/vpColVector.h>
-
 #ifdef VISP_HAVE_FRANKA
-#include <franka/exception.h>
-#include <franka/robot.h>
-
 #include <franka/control_types.h>
 #include <franka/duration.h>
 #include <franka/robot_state.h>
 
+#include <visp3/robot/vpJointPosTrajGenerator.h>
+
 /**
- * An example showing how to generate a joint pose motion to a goal position. Adapted from:
- * Wisama Khalil and Etienne Dombre. 2002. Modeling, Identification and Control of Robots
- * (Kogan Page Science Paper edition).
+ * Motion generator moving the joints of the Franka robot to a goal position, using
+ * the synchronized profiles of vpJointPosTrajGenerator.
  */
-class vpJointPosTrajGenerator {
+class vpFrankaJointPosTrajGenerator {
  public:
   /**
    * Creates a new MotionGenerator instance for a target q.
@@ -70,7 +64,7 @@ class vpJointPosTrajGenerator {
    * @param[in] speed_factor General speed factor in range [0, 1].
    * @param[in] q_goal Target joint positions.
    */
-  vpJointPosTrajGenerator(double speed_factor, const std::array<double, 7> &q_goal);
+  vpFrankaJointPosTrajGenerator(double speed_factor, const std::array<double, 7> &q_goal);
 
   /**
    * Sends joint position calculations
@@ -83,23 +77,8 @@ class vpJointPosTrajGenerator {
   franka::JointPositions operator()(const franka::RobotState& robot_state, franka::Duration period);
 
  private:
-  bool calculateDesiredValues(double t, vpColVector &delta_q_d) const;
-  void calculateSynchronizedValues();
-
-  static constexpr double kDeltaQMotionFinished = 1e-6;
-  vpColVector m_q_goal;
-  vpColVector m_q_start;
-  vpColVector m_delta_q;
-  vpColVector m_dq_max_sync;
-  vpColVector m_t_1_sync;
-  vpColVector m_t_2_sync;
-  vpColVector m_t_f_sync;
-  vpColVector m_q_1;
-
-  vpColVector m_dq_max;
-  vpColVector m_ddq_max_start;
-  vpColVector m_ddq_max_goal;
-
+  vpJointPosTrajGenerator m_generator;
+  std::array<double, 7> m_q_goal;
   double m_time = 0.0;
 };
 
@@ -36,12 +36,13 @@
  *
  *****************************************************************************/
 
-#include "vpJointVelTrajGenerator_impl.h"
+#include "vpFrankaJointVelTrajGenerator_impl.h"
 
 #include <visp3/core/vpConfig.h>
 
 #ifdef VISP_HAVE_FRANKA
 #include <cmath>
+#include <cstdio>
 #include <iomanip>
 #include <algorithm>
 
@@ -52,20 +53,35 @@
 #include <visp3/core/vpException.h>
 #include <visp3/core/vpTime.h>
 #include <visp3/core/vpMatrix.h>
+#include <visp3/robot/vpJointVelTrajGenerator.h>
 
-void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
-                                             std::atomic_bool &stop,
-                                             const std::string &log_folder,
-                                             const vpRobot::vpControlFrameType &frame,
-                                             const vpHomogeneousMatrix &eMc,
-                                             const vpColVector &v_cart_des, // end-effector velocity
-                                             const std::array<double, 7> &dq_des, // joint velocity
-                                             const std::array<double, 7> &q_min,
-                                             const std::array<double, 7> &q_max,
-                                             const std::array<double, 7> &dq_max,
-                                             const std::array<double, 7> &ddq_max,
-                                             franka::RobotState &robot_state,
-                                             std::mutex &mutex)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+vpColVector toColVector(const std::array<double, 7> &a)
+{
+  vpColVector v(7);
+  for (size_t i = 0; i < 7; i++) {
+    v[i] = a[i];
+  }
+  return v;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+void vpFrankaJointVelTrajGenerator::control_thread(franka::Robot *robot,
+                                                   std::atomic_bool &stop,
+                                                   const std::string &log_folder,
+                                                   const vpRobot::vpControlFrameType &frame,
+                                                   const vpHomogeneousMatrix &eMc,
+                                                   const vpColVector &v_cart_des, // end-effector velocity
+                                                   const std::array<double, 7> &dq_des, // joint velocity
+                                                   const std::array<double, 7> &q_min,
+                                                   const std::array<double, 7> &q_max,
+                                                   const std::array<double, 7> &dq_max,
+                                                   const std::array<double, 7> &ddq_max,
+                                                   franka::RobotState &robot_state,
+                                                   std::mutex &mutex)
 {
   double time = 0.0;
   double delta_t = 0.001;
@@ -73,6 +89,7 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
   franka::Model model = robot->loadModel();
   vpMatrix eJe(6, 7), fJe(6, 7);
   vpVelocityTwistMatrix cVe(eMc.inverse());
+  vpJointVelTrajGenerator joint_vel_traj_generator;
 
   std::ofstream log_time;
   std::ofstream log_q_mes;
@@ -81,13 +98,11 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
   std::ofstream log_dq_cmd;
   std::ofstream log_v_des;
 
-  auto joint_velocity_callback = [=, &log_time, &log_q_mes, &log_dq_mes, &log_dq_des, &log_dq_cmd, &time, &q_prev, &dq_des, &stop, &robot_state, &mutex]
+  auto joint_velocity_callback = [=, &log_time, &log_q_mes, &log_dq_mes, &log_dq_des, &log_dq_cmd, &time, &q_prev, &dq_des, &joint_vel_traj_generator, &stop, &robot_state, &mutex]
       (const franka::RobotState& state, franka::Duration period) -> franka::JointVelocities {
 
     time += period.toSec();
 
-    static vpJointVelTrajGenerator joint_vel_traj_generator;
-
     if (time == 0.0) {
       if (! log_folder.empty()) {
         std::cout << "Save franka logs in \"" << log_folder << "\" folder" << std::endl;
@@ -98,7 +113,8 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
         log_dq_cmd.open(log_folder + "/dq-cmd.log");
       }
       q_prev = state.q_d;
-      joint_vel_traj_generator.init(state.q_d, q_min, q_max, dq_max, ddq_max, delta_t);
+      joint_vel_traj_generator.init(toColVector(state.q_d), toColVector(q_min), toColVector(q_max), toColVector(dq_max),
+                                    toColVector(ddq_max), delta_t);
     }
 
     {
@@ -116,7 +132,10 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
       }
     }
 
-    joint_vel_traj_generator.applyVel(dq_des_, q_cmd, dq_cmd);
+    joint_vel_traj_generator.applyVel(dq_des_.data(), q_cmd.data(), dq_cmd.data());
+    if (joint_vel_traj_generator.getJointLimitAxis() >= 0) {
+      printf("Joint limit axis %d\n", joint_vel_traj_generator.getJointLimitAxis());
+    }
 
     if (! log_folder.empty()) {
       log_time << time << std::endl;
@@ -161,16 +180,16 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
     // by the robot will prevent from getting discontinuity errors.
     // Note that if the robot does not receive a command it will try to extrapolate
     // the desired behavior assuming a constant acceleration model
-    return limitRate(ddq_max, velocities.dq, state.dq_d);
+    std::array<double, 7> dq_limited;
+    joint_vel_traj_generator.limitRate(ddq_max.data(), velocities.dq.data(), state.dq_d.data(), dq_limited.data());
+    return dq_limited;
   };
 
-  auto cartesian_velocity_callback = [=, &log_time, &log_q_mes, &log_dq_mes, &log_dq_des,  &log_dq_cmd, &log_v_des, &time, &model, &q_prev, &v_cart_des, &stop, &robot_state, &mutex]
+  auto cartesian_velocity_callback = [=, &log_time, &log_q_mes, &log_dq_mes, &log_dq_des,  &log_dq_cmd, &log_v_des, &time, &model, &q_prev, &v_cart_des, &joint_vel_traj_generator, &stop, &robot_state, &mutex]
       (const franka::RobotState& state, franka::Duration period) -> franka::JointVelocities {
 
     time += period.toSec();
 
-    static vpJointVelTrajGenerator joint_vel_traj_generator;
-
     if (time == 0.0) {
       if (! log_folder.empty()) {
         std::cout << "Save franka logs in \"" << log_folder << "\" folder" << std::endl;
@@ -182,7 +201,8 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
         log_v_des.open(log_folder + "v-des.log");
       }
       q_prev = state.q_d;
-      joint_vel_traj_generator.init(state.q_d, q_min, q_max, dq_max, ddq_max, delta_t);
+      joint_vel_traj_generator.init(toColVector(state.q_d), toColVector(q_min), toColVector(q_max), toColVector(dq_max),
+                                    toColVector(ddq_max), delta_t);
     }
 
     {
@@ -236,7 +256,10 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
       }
     }
 
-    joint_vel_traj_generator.applyVel(dq_des_, q_cmd, dq_cmd);
+    joint_vel_traj_generator.applyVel(dq_des_.data(), q_cmd.data(), dq_cmd.data());
+    if (joint_vel_traj_generator.getJointLimitAxis() >= 0) {
+      printf("Joint limit axis %d\n", joint_vel_traj_generator.getJointLimitAxis());
+    }
 
     if (! log_folder.empty()) {
       log_time << time << std::endl;
@@ -282,7 +305,9 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
     // by the robot will prevent from getting discontinuity errors.
     // Note that if the robot does not receive a command it will try to extrapolate
     // the desired behavior assuming a constant acceleration model
-    return limitRate(ddq_max, velocities.dq, state.dq_d);
+    std::array<double, 7> dq_limited;
+    joint_vel_traj_generator.limitRate(ddq_max.data(), velocities.dq.data(), state.dq_d.data(), dq_limited.data());
+    return dq_limited;
   };
 
   switch (frame) {
@@ -302,256 +327,8 @@ void vpJointVelTrajGenerator::control_thread(franka::Robot *robot,
   }
 }
 
-void vpJointVelTrajGenerator::init(const std::array<double, 7> &q,
-                                   const std::array<double, 7> &q_min,
-                                   const std::array<double, 7> &q_max,
-                                   const std::array<double, 7> &dq_max,
-                                   const std::array<double, 7> &ddq_max,
-                                   const double delta_t)
-{
-  if (m_njoints != q_min.size() || m_njoints != q_max.size()
-      || m_njoints != dq_max.size() || m_njoints != ddq_max.size()) {
-    throw(vpException(vpException::dimensionError, "Inconsistent number of joints"));
-  }
-  m_q_min = q_min;
-  m_q_max = q_max;
-  m_dq_max = dq_max;
-  m_ddq_max = ddq_max;
-
-  m_delta_t = delta_t;
-
-  m_q_final = m_q_cmd = q;
-  m_q_cmd_prev = m_q_cmd;
-
-  m_dq_des        = {0, 0, 0, 0, 0, 0, 0};
-  m_dq_des_prev   = {0, 0, 0, 0, 0, 0, 0};
-  m_delta_q       = {0, 0, 0, 0, 0, 0, 0};
-  m_delta_q_max   = {0, 0, 0, 0, 0, 0, 0};
-  m_sign          = {0, 0, 0, 0, 0, 0, 0};
-  m_dist_to_final = {0, 0, 0, 0, 0, 0, 0};
-  m_dist_AD       = {0, 0, 0, 0, 0, 0, 0};
-  m_flagSpeed     = {false, false, false, false, false, false, false};
-  m_status        = {FLAGSTO, FLAGSTO, FLAGSTO, FLAGSTO, FLAGSTO, FLAGSTO, FLAGSTO};
-
-  for (size_t i=0; i<m_njoints; i++) {
-    m_delta_q_acc[i] = m_ddq_max[i] * m_delta_t * m_delta_t;
-  }
-}
-
-
-/*!
- * Compute the joint position and velocity to reach desired joint velocity.
- * \param dq_des : Desired joint velocity
- * \param q_cmd : Position to apply.
- * \param dq_cmd : Velocity to apply.
- */
-void vpJointVelTrajGenerator::applyVel(const std::array<double, 7> &dq_des,
-                                       std::array<double, 7> &q_cmd,
-                                       std::array<double, 7> &dq_cmd)
-{
-  for (size_t i=0; i < m_njoints; i++) {
-    m_dq_des[i] = dq_des[i];
-
-    if (m_dq_des[i] != m_dq_des_prev[i]) {
-
-      m_flagJointLimit = false;
-
-      if (m_dq_des[i] > m_dq_max[i]) {
-        m_dq_des[i] = m_dq_max[i];
-      }
-      else if (m_dq_des[i] < (-m_dq_max[i])) {
-        m_dq_des[i] = -m_dq_max[i];
-      }
-
-      if (m_flagSpeed[i] == false) {
-        // Change from stop to new vel with acc control
-        if ( m_status[i] == FLAGSTO) // If stop
-        {
-          if (m_dq_des[i] > 0)
-          {
-            m_delta_q_max[i] = m_dq_des[i]*m_delta_t;
-            m_sign[i] = 1;
-            m_q_final[i] = m_q_max[i] - m_offset_joint_limit;
-            m_delta_q[i] = 0;
-            m_status[i] = FLAGACC;
-          }
-          else if (m_dq_des[i] < 0)
-          {
-            m_delta_q_max[i] = - m_dq_des[i]*m_delta_t;
-            m_sign[i] = -1;
-            m_q_final[i] = m_q_min[i] + m_offset_joint_limit;
-            m_delta_q[i] = 0;
-            m_status[i] = FLAGACC;
-          }
-        }
-
-        // Change of direction
-        else if ( (m_dq_des[i] * m_sign[i]) < 0) {
-          m_flagSpeed[i] = true;
-          m_status[i] = FLAGDEC;
-          m_delta_q_max[i] = 0;
-        }
-        else {
-          // Acceleration or deceleration
-          if ( m_sign[i] == 1) {
-            if ( m_dq_des[i] > m_dq_des_prev[i])
-              m_status[i] = FLAGACC;
-            else
-              m_status[i] = FLAGDEC;
-            m_delta_q_max[i] = m_dq_des[i]*m_delta_t;
-          }
-          else {
-            if ( m_dq_des[i] > m_dq_des_prev[i])
-              m_status[i] = FLAGDEC;
-            else
-              m_status[i] = FLAGACC;
-            m_delta_q_max[i] = - m_dq_des[i]*m_delta_t;
-          }
-        }
-
-        // Update distance to accelerate or decelerate
-        int n = (int) (m_delta_q_max[i] / m_delta_q_acc[i]);
-        m_dist_AD[i]=n*(m_delta_q_max[i]-(n+1)*m_delta_q_acc[i]/2);
-      }
-      m_dq_des_prev[i] = m_dq_des[i];
-    }
-  }
-
-  /*
-   * Compute new command in case of
-   *		- acceleration
-   *		- deceleration
-   *		- stop
-   */
-  for (size_t i=0; i < m_njoints; i++) {
-    // Security joint limit
-    m_dist_to_final[i] = ( m_q_final[i] - m_q_cmd[i]) * m_sign[i];
-    if ((m_dist_to_final[i] - m_delta_q_max[i]) <=  m_dist_AD[i]) {
-      if (m_dist_AD[i] > 0) {
-        if (!m_flagJointLimit) printf("Joint limit flag axis %lu\n", (unsigned long)i);
-        m_flagJointLimit = true;
-        for(size_t k=0; k < m_njoints; k++)
-        {
-          if (m_status[k] != FLAGSTO) m_status[k] = FLAGDEC;
-          m_delta_q_max[k] = 0;
-        }
-      }
-    }
-    /*
-     * Deceleration.
-     */
-    if ( m_status[i] == FLAGDEC) {
-      m_delta_q[i] -=  m_delta_q_acc[i];
-      if (m_delta_q[i] <=  m_delta_q_max[i]) {
-        if (m_delta_q_max[i] < m_delta_q_min)  {
-          m_status[i] = FLAGSTO;
-          m_delta_q[i] = 0.0;
-          // Test if change of direction
-          if (m_flagSpeed[i] == true) {
-            if (m_dq_des[i] > 0) {
-              m_delta_q_max[i] = m_dq_des[i]*m_delta_t;
-              m_sign[i] = 1;
-              m_q_final[i] = m_q_max[i] - m_offset_joint_limit;
-            }
-            else if (m_dq_des[i] < 0) {
-              m_delta_q_max[i] = -m_dq_des[i]*m_delta_t;
-              m_sign[i] = -1;
-              m_q_final[i] = m_q_min[i] + m_offset_joint_limit;
-            }
-            m_status[i] = FLAGACC;
-            m_flagSpeed[i] = false;
-
-            int n = (int) (m_delta_q_max[i] / m_delta_q_acc[i]);
-            m_dist_AD[i]=n*(m_delta_q_max[i]-(n+1)*m_delta_q_acc[i]/2);
-          }
-        }
-        else if ((m_delta_q_max[i] > 0) && !m_flagJointLimit)  {
-          if (m_delta_q_max[i] < (m_delta_q[i] + 2*m_delta_q_acc[i])) {
-            m_delta_q[i] = m_delta_q_max[i];
-            m_status[i] = FLAGCTE;
-          }
-          else if (!m_flagJointLimit) {
-            /* acceleration moins rapide*/
-            m_delta_q[i] += (2*m_delta_q_acc[i]);
-            m_status[i] = FLAGACC;
-          }
-        }
-      }
-    }
-    /*
-     * Acceleration.
-     */
-    else if (m_status[i] == FLAGACC) {
-      m_delta_q[i] += m_delta_q_acc[i];
-
-      if (m_delta_q[i] >= m_delta_q_max[i]) {
-        m_delta_q[i] = m_delta_q_max[i];
-        m_status[i] = FLAGCTE;
-      }
-    }
-    /*
-     * Constant velocity
-     */
-    m_q_cmd[i] += m_sign[i] * m_delta_q[i];
-  }
-
-  // Test si un axe arrive pres des butees. Si oui, arret de tous les axes
-  for (size_t i=0; i < m_njoints;i++) {
-    double butee = m_q_min[i] + m_offset_joint_limit;
-    if (m_q_cmd[i] < butee) {
-      for (size_t j=0; j < m_njoints;j++) {
-        m_q_cmd[j] -= m_sign[j]*m_delta_q[j];
-      }
-      m_q_cmd[i] = butee;
-      printf("Joint limit axis %lu\n", (unsigned long)i);
-      break;
-    }
-    butee = (float) (m_q_max[i] - m_offset_joint_limit);
-    if (m_q_cmd[i] > butee) {
-      for (size_t j=0; j < m_njoints; j++) {
-        m_q_cmd[j] -= m_sign[j]*m_delta_q[j];
-      }
-      m_q_cmd[i] = butee;
-      printf("Joint limit axis %lu\n", (unsigned long)i);
-      break;
-    }
-  }
-
-  q_cmd = m_q_cmd;
-
-  // Compute velocity command
-  for (size_t i = 0; i < m_q_cmd.size(); i++) {
-    dq_cmd[i] = (m_q_cmd[i] - m_q_cmd_prev[i]) / m_delta_t;
-  }
-
-  m_q_cmd_prev = m_q_cmd;
-}
-
-/**
- * Limits the rate of an input vector of per-joint commands considering the maximum allowed time
- * derivatives.
- *
- * @param[in] max_derivatives Per-joint maximum allowed time derivative.
- * @param[in] desired_values Desired values of the current time step.
- * @param[in] last_desired_values Desired values of the previous time step.
- *
- * @return Rate-limited vector of desired values.
- */
-std::array<double, 7> vpJointVelTrajGenerator::limitRate(const std::array<double, 7>& max_derivatives,
-                                                         const std::array<double, 7>& desired_values,
-                                                         const std::array<double, 7>& last_desired_values) {
-  std::array<double, 7> limited_values{};
-  for (size_t i = 0; i < 7; i++) {
-    double desired_difference = (desired_values[i] - last_desired_values[i]) / 1e-3;
-    limited_values[i] =
-        last_desired_values[i] +
-        std::max(std::min(desired_difference, max_derivatives[i]), -max_derivatives[i]) * 1e-3;
-  }
-  return limited_values;
-}
-
 #elif !defined(VISP_BUILD_SHARED_LIBS)
-// Work arround to avoid warning: libvisp_robot.a(vpJointVelTrajGenerator.cpp.o) has no symbols
-void dummy_vpJointVelTrajGenerator(){};
+// Work arround to avoid warning: libvisp_robot.a(vpFrankaJointVelTrajGenerator_impl.cpp.o) has no symbols
+void dummy_vpFrankaJointVelTrajGenerator(){};
 #endif // VISP_HAVE_FRANKA
 
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Interface for the Franka robot.
+ *
+ * Authors:
+ * Fabien Spindler
+ *
+ *****************************************************************************/
+
+#ifndef __vpFrankaJointVelTrajGenerator_impl_h_
+#define __vpFrankaJointVelTrajGenerator_impl_h_
+
+#include <visp3/core/vpConfig.h>
+
+#ifdef VISP_HAVE_FRANKA
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <franka/robot.h>
+#include <franka/robot_state.h>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/robot/vpRobot.h>
+
+/**
+ * Velocity control loop of the Franka robot, using vpJointVelTrajGenerator to
+ * turn the desired velocities into joint velocity commands.
+ */
+class vpFrankaJointVelTrajGenerator {
+public:
+  vpFrankaJointVelTrajGenerator() {}
+  ~vpFrankaJointVelTrajGenerator() {}
+
+  void control_thread(franka::Robot *robot, std::atomic_bool &stop,
+                      const std::string &log_folder,
+                      const vpRobot::vpControlFrameType &frame,
+                      const vpHomogeneousMatrix &eMc,
+                      const vpColVector &v_cart_des,
+                      const std::array<double, 7> &dq_des,
+                      const std::array<double, 7> &q_min,
+                      const std::array<double, 7> &q_max,
+                      const std::array<double, 7> &dq_max,
+                      const std::array<double, 7> &ddq_max,
+                      franka::RobotState &robot_state,
+                      std::mutex &mutex);
+};
+
+#endif
+#endif
@@ -44,8 +44,8 @@
 #include <visp3/robot/vpRobotFranka.h>
 #include <visp3/core/vpIoTools.h>
 
-#include "vpJointPosTrajGenerator_impl.h"
-#include "vpJointVelTrajGenerator_impl.h"
+#include "vpFrankaJointPosTrajGenerator_impl.h"
+#include "vpFrankaJointVelTrajGenerator_impl.h"
 
 /*!
 
@@ -395,7 +395,7 @@ void vpRobotFranka::setPosition(const vpRobot::vpControlFrameType frame, const v
       q_goal[i] = position[i];
     }
 
-    vpJointPosTrajGenerator joint_pos_traj_generator(speed_factor, q_goal);
+    vpFrankaJointPosTrajGenerator joint_pos_traj_generator(speed_factor, q_goal);
     m_handler->control(joint_pos_traj_generator);
   }
   else {
@@ -577,7 +577,7 @@ void vpRobotFranka::setVelocity(const vpRobot::vpControlFrameType frame, const v
 
   if(! m_controlThreadIsRunning) {
     m_controlThreadIsRunning = true;
-    m_controlThread = std::thread(&vpJointVelTrajGenerator::control_thread, vpJointVelTrajGenerator(),
+    m_controlThread = std::thread(&vpFrankaJointVelTrajGenerator::control_thread, vpFrankaJointVelTrajGenerator(),
                                   std::ref(m_handler), std::ref(m_controlThreadStopAsked), m_log_folder,
                                   frame, m_eMc, std::ref(m_v_cart_des), std::ref(m_dq_des),
                                   std::cref(m_q_min), std::cref(m_q_max), std::cref(m_dq_max), std::cref(m_ddq_max),
@@ -57,6 +57,83 @@
 
 const unsigned int vpViper::njoint = 6;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Sines and cosines of the joint positions of a configuration stored in
+// structure of arrays layout
+struct vpViperJoints {
+  double c1, s1, c2, s2, c4, s4, c5, s5, c6, s6, c23, s23;
+
+  vpViperJoints(const double *q, unsigned int n)
+    : c1(cos(q[0])), s1(sin(q[0])), c2(cos(q[n])), s2(sin(q[n])), c4(cos(q[3 * n])), s4(sin(q[3 * n])),
+      c5(cos(q[4 * n])), s5(sin(q[4 * n])), c6(cos(q[5 * n])), s6(sin(q[5 * n])), c23(cos(q[n] + q[2 * n])),
+      s23(sin(q[n] + q[2 * n]))
+  {
+  }
+};
+
+// Rotation fRe, equal to fRw, as in vpViper::get_fMe()
+inline void viperRotation(const vpViperJoints &j, double R[9])
+{
+  R[0] = j.c1 * (j.c23 * (j.c4 * j.c5 * j.c6 - j.s4 * j.s6) - j.s23 * j.s5 * j.c6) -
+         j.s1 * (j.s4 * j.c5 * j.c6 + j.c4 * j.s6);
+  R[3] = -j.s1 * (j.c23 * (-j.c4 * j.c5 * j.c6 + j.s4 * j.s6) + j.s23 * j.s5 * j.c6) +
+         j.c1 * (j.s4 * j.c5 * j.c6 + j.c4 * j.s6);
+  R[6] = j.s23 * (j.s4 * j.s6 - j.c4 * j.c5 * j.c6) - j.c23 * j.s5 * j.c6;
+
+  R[1] = -j.c1 * (j.c23 * (j.c4 * j.c5 * j.s6 + j.s4 * j.c6) - j.s23 * j.s5 * j.s6) +
+         j.s1 * (j.s4 * j.c5 * j.s6 - j.c4 * j.c6);
+  R[4] = -j.s1 * (j.c23 * (j.c4 * j.c5 * j.s6 + j.s4 * j.c6) - j.s23 * j.s5 * j.s6) -
+         j.c1 * (j.s4 * j.c5 * j.s6 - j.c4 * j.c6);
+  R[7] = j.s23 * (j.c4 * j.c5 * j.s6 + j.s4 * j.c6) + j.c23 * j.s5 * j.s6;
+
+  R[2] = j.c1 * (j.c23 * j.c4 * j.s5 + j.s23 * j.c5) - j.s1 * j.s4 * j.s5;
+  R[5] = j.s1 * (j.c23 * j.c4 * j.s5 + j.s23 * j.c5) + j.c1 * j.s4 * j.s5;
+  R[8] = -j.s23 * j.c4 * j.s5 + j.c23 * j.c5;
+}
+
+// Linear and angular parts of the columns of the jacobian fJw, as in
+// vpViper::get_fJw() where s2c3+c2s3 = s23 and c2c3-s2s3 = c23
+inline void viperWristJacobian(const vpViperJoints &j, double a1, double a2, double a3, double d4, double Jv[3][6],
+                               double Jw[3][6])
+{
+  double r = -j.c23 * a3 + j.s23 * d4 + a1 + a2 * j.c2;
+  double h = j.s23 * a3 + j.c23 * d4 - a2 * j.s2;
+  double h3 = a3 * j.s23 + j.c23 * d4;
+
+  Jv[0][0] = -j.s1 * r;
+  Jv[1][0] = j.c1 * r;
+  Jv[2][0] = 0;
+  Jv[0][1] = j.c1 * h;
+  Jv[1][1] = j.s1 * h;
+  Jv[2][1] = j.c23 * a3 - j.s23 * d4 - a2 * j.c2;
+  Jv[0][2] = j.c1 * h3;
+  Jv[1][2] = j.s1 * h3;
+  Jv[2][2] = a3 * j.c23 - d4 * j.s23;
+  for (unsigned int k = 0; k < 3; k++) {
+    Jv[k][3] = Jv[k][4] = Jv[k][5] = 0;
+  }
+
+  Jw[0][0] = 0;
+  Jw[1][0] = 0;
+  Jw[2][0] = 1;
+  Jw[0][1] = Jw[0][2] = -j.s1;
+  Jw[1][1] = Jw[1][2] = j.c1;
+  Jw[2][1] = Jw[2][2] = 0;
+  Jw[0][3] = j.c1 * j.s23;
+  Jw[1][3] = j.s1 * j.s23;
+  Jw[2][3] = j.c23;
+  Jw[0][4] = -j.c23 * j.c1 * j.s4 - j.s1 * j.c4;
+  Jw[1][4] = j.c1 * j.c4 - j.c23 * j.s1 * j.s4;
+  Jw[2][4] = j.s23 * j.s4;
+  Jw[0][5] = (j.c1 * j.c23 * j.c4 - j.s1 * j.s4) * j.s5 + j.c1 * j.s23 * j.c5;
+  Jw[1][5] = (j.s1 * j.c23 * j.c4 + j.c1 * j.s4) * j.s5 + j.s1 * j.s23 * j.c5;
+  Jw[2][5] = -j.s23 * j.c4 * j.s5 + j.c23 * j.c5;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 
   Default constructor.
@@ -1189,6 +1266,156 @@ void vpViper::get_fJe(const vpColVector &q, vpMatrix &fJe) const
   return;
 }
 
+/*!
+
+  Compute the forward kinematics \f${^f}{\bf M}_e\f$ for a batch of joint
+  configurations, without any memory allocation.
+
+  The configurations are stored in structure of arrays layout: the joint \e j
+  of the configuration \e i is \e q[j * n + i]. The matrices are stored in
+  the same layout without their last row: the element \e (r, c) of the
+  matrix of the configuration \e i is \e fMe[(4 * r + c) * n + i].
+
+  \param n : Number of configurations.
+
+  \param q : Array of 6 x \e n joint positions expressed in radians.
+
+  \param fMe : Array of 12 x \e n elements, filled with the first 3 rows of
+  the homogeneous matrices \f${^f}{\bf M}_e\f$.
+
+  \sa get_fMe(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void vpViper::get_fMe(unsigned int n, const double *q, double *fMe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    vpViperJoints j(q + i, n);
+    double R[9];
+    viperRotation(j, R);
+    double r = j.c23 * (j.c4 * j.s5 * d6 - a3) + j.s23 * (j.c5 * d6 + d4) + a1 + a2 * j.c2;
+    double *M = fMe + i;
+    for (unsigned int k = 0; k < 3; k++) {
+      M[(4 * k) * n] = R[3 * k];
+      M[(4 * k + 1) * n] = R[3 * k + 1];
+      M[(4 * k + 2) * n] = R[3 * k + 2];
+    }
+    M[3 * n] = j.c1 * r - j.s1 * j.s4 * j.s5 * d6;
+    M[7 * n] = j.s1 * r + j.c1 * j.s4 * j.s5 * d6;
+    M[11 * n] = j.s23 * (a3 - j.c4 * j.s5 * d6) + j.c23 * (j.c5 * d6 + d4) - a2 * j.s2 + d1;
+  }
+}
+
+/*!
+
+  Compute the forward kinematics \f${^f}{\bf M}_c\f$ for a batch of joint
+  configurations, without any memory allocation.
+
+  \param n : Number of configurations.
+
+  \param q : Array of 6 x \e n joint positions expressed in radians, in the
+  layout described in get_fMe(unsigned int, const double *, double *) const.
+
+  \param fMc : Array of 12 x \e n elements, filled with the first 3 rows of
+  the homogeneous matrices \f${^f}{\bf M}_c\f$.
+
+  \sa get_fMc(const vpColVector &, vpHomogeneousMatrix &) const
+*/
+void vpViper::get_fMc(unsigned int n, const double *q, double *fMc) const
+{
+  get_fMe(n, q, fMc);
+
+  double E[12];
+  for (unsigned int k = 0; k < 12; k++) {
+    E[k] = eMc[k / 4][k % 4];
+  }
+  for (unsigned int i = 0; i < n; i++) {
+    double *M = fMc + i;
+    for (unsigned int r = 0; r < 3; r++) {
+      double m0 = M[(4 * r) * n], m1 = M[(4 * r + 1) * n], m2 = M[(4 * r + 2) * n];
+      for (unsigned int c = 0; c < 4; c++) {
+        M[(4 * r + c) * n] = m0 * E[c] + m1 * E[4 + c] + m2 * E[8 + c] + (c == 3 ? M[(4 * r + 3) * n] : 0.);
+      }
+    }
+  }
+}
+
+/*!
+
+  Compute the robot jacobian \f${^f}{\bf J}_e\f$ for a batch of joint
+  configurations, without any memory allocation.
+
+  \param n : Number of configurations.
+
+  \param q : Array of 6 x \e n joint positions expressed in radians, in the
+  layout described in get_fMe(unsigned int, const double *, double *) const.
+
+  \param fJe : Array of 36 x \e n elements: the element \e (r, c) of the
+  jacobian of the configuration \e i is \e fJe[(6 * r + c) * n + i].
+
+  \sa get_fJe(const vpColVector &, vpMatrix &) const
+*/
+void vpViper::get_fJe(unsigned int n, const double *q, double *fJe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    vpViperJoints j(q + i, n);
+    double Jv[3][6], Jw[3][6];
+    viperWristJacobian(j, a1, a2, a3, d4, Jv, Jw);
+    // Translation from the wrist to the end-effector in the fix frame
+    double t[3] = {-d6 * (j.c1 * (j.c23 * j.c4 * j.s5 + j.s23 * j.c5) - j.s1 * j.s4 * j.s5),
+                   -d6 * (j.s1 * (j.c23 * j.c4 * j.s5 + j.s23 * j.c5) + j.c1 * j.s4 * j.s5),
+                   -d6 * (-j.s23 * j.c4 * j.s5 + j.c23 * j.c5)};
+    double *J = fJe + i;
+    for (unsigned int c = 0; c < 6; c++) {
+      J[c * n] = Jv[0][c] + t[1] * Jw[2][c] - t[2] * Jw[1][c];
+      J[(6 + c) * n] = Jv[1][c] + t[2] * Jw[0][c] - t[0] * Jw[2][c];
+      J[(12 + c) * n] = Jv[2][c] + t[0] * Jw[1][c] - t[1] * Jw[0][c];
+      J[(18 + c) * n] = Jw[0][c];
+      J[(24 + c) * n] = Jw[1][c];
+      J[(30 + c) * n] = Jw[2][c];
+    }
+  }
+}
+
+/*!
+
+  Compute the robot jacobian \f${^e}{\bf J}_e\f$ for a batch of joint
+  configurations, without any memory allocation.
+
+  \param n : Number of configurations.
+
+  \param q : Array of 6 x \e n joint positions expressed in radians, in the
+  layout described in get_fMe(unsigned int, const double *, double *) const.
+
+  \param eJe : Array of 36 x \e n elements: the element \e (r, c) of the
+  jacobian of the configuration \e i is \e eJe[(6 * r + c) * n + i].
+
+  \sa get_eJe(const vpColVector &, vpMatrix &) const
+*/
+void vpViper::get_eJe(unsigned int n, const double *q, double *eJe) const
+{
+  for (unsigned int i = 0; i < n; i++) {
+    vpViperJoints j(q + i, n);
+    double R[9], Jv[3][6], Jw[3][6];
+    viperRotation(j, R);
+    viperWristJacobian(j, a1, a2, a3, d4, Jv, Jw);
+    double *J = eJe + i;
+    for (unsigned int c = 0; c < 6; c++) {
+      // Velocities expressed in the wrist frame, then at the origin of the
+      // end-effector frame that is translated by d6 along z
+      double v[3], w[3];
+      for (unsigned int k = 0; k < 3; k++) {
+        v[k] = R[k] * Jv[0][c] + R[3 + k] * Jv[1][c] + R[6 + k] * Jv[2][c];
+        w[k] = R[k] * Jw[0][c] + R[3 + k] * Jw[1][c] + R[6 + k] * Jw[2][c];
+      }
+      J[c * n] = v[0] + d6 * w[1];
+      J[(6 + c) * n] = v[1] - d6 * w[0];
+      J[(12 + c) * n] = v[2];
+      J[(18 + c) * n] = w[0];
+      J[(24 + c) * n] = w[1];
+      J[(30 + c) * n] = w[2];
+    }
+  }
+}
+
 /*!
   Get minimal joint values.
 
@@ -62,7 +62,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator()
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(true), constantSamplingTimeMode(false), setVelocityCalled(false),
-    verbose_(false)
+    verbose_(false), lockstepMode(false), simulationTime(0.)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -94,7 +94,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator(bool do_display)
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(do_display), constantSamplingTimeMode(false), setVelocityCalled(false),
-    verbose_(false)
+    verbose_(false), lockstepMode(false), simulationTime(0.)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -372,6 +372,107 @@ vpHomogeneousMatrix vpRobotWireFrameSimulator::get_cMo()
   return cMoTemp;
 }
 
+/*!
+  Launch the thread which moves the robot.
+*/
+void vpRobotWireFrameSimulator::launchThread()
+{
+  robotStop = false;
+  tcur = vpTime::measureTimeMs();
+#if defined(_WIN32)
+  DWORD dwThreadIdArray;
+  hThread = CreateThread(NULL,              // default security attributes
+                         0,                 // use default stack size
+                         launcher,          // thread function name
+                         this,              // argument to thread function
+                         0,                 // use default creation flags
+                         &dwThreadIdArray); // returns the thread identifier
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_create(&thread, NULL, launcher, (void *)this);
+#endif
+}
+
+/*!
+  Stop the thread which moves the robot and wait for its end.
+*/
+void vpRobotWireFrameSimulator::joinThread()
+{
+  robotStop = true;
+#if defined(_WIN32)
+#if defined(WINRT_8_1)
+  WaitForSingleObjectEx(hThread, INFINITE, FALSE);
+#else // pure win32
+  WaitForSingleObject(hThread, INFINITE);
+#endif
+  CloseHandle(hThread);
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_join(thread, NULL);
+#endif
+}
+
+/*!
+  Enable or disable the lockstep mode.
+
+  In the lockstep mode, the thread which moves the robot in real time is
+  stopped. The robot moves only when step() is called, of the sampling time
+  given by setSamplingTime(), with the velocity given by setVelocity(). The
+  blocking positioning methods (setPosition()) move the robot by steps of the
+  sampling time until the position is reached, without waiting. Since nothing
+  depends on the wall-clock time or on the scheduling of a thread, the
+  simulation is deterministic and runs as fast as possible. The timestamps of
+  the measures are the simulation time (see getSimulationTime()).
+
+  \param lockstep : When true, enables the lockstep mode. When false, the
+  thread moving the robot in real time is launched again.
+*/
+void vpRobotWireFrameSimulator::setLockstepMode(bool lockstep)
+{
+  if (lockstep == lockstepMode) {
+    return;
+  }
+  if (lockstep) {
+    joinThread();
+    setVelocityCalled = false;
+    lockstepMode = true;
+  } else {
+    lockstepMode = false;
+    launchThread();
+  }
+}
+
+/*!
+  Move the robot during the sampling time given by setSamplingTime(), with
+  the velocity given by setVelocity(), and update the external view if it is
+  displayed.
+
+  \exception vpRobotException::wrongStateError : If the lockstep mode is not
+  enabled (see setLockstepMode()).
+*/
+void vpRobotWireFrameSimulator::step()
+{
+  if (!lockstepMode) {
+    throw vpRobotException(vpRobotException::wrongStateError, "Cannot step the simulator: the lockstep mode is "
+                                                              "not enabled");
+  }
+  setVelocityCalled = false;
+  computeArticularVelocity();
+  computeArticularPosition(getSamplingTime());
+  simulationTime += getSamplingTime();
+}
+
+/*!
+  In the lockstep mode, move the robot during the sampling time with the
+  current articular velocity. Does nothing otherwise, the thread moving the
+  robot.
+*/
+void vpRobotWireFrameSimulator::stepArticularPosition()
+{
+  if (lockstepMode) {
+    computeArticularPosition(getSamplingTime());
+    simulationTime += getSamplingTime();
+  }
+}
+
 #elif !defined(VISP_BUILD_SHARED_LIBS)
 // Work arround to avoid warning:
 // libvisp_robot.a(vpRobotWireFrameSimulator.cpp.o) has no symbols
@@ -83,13 +83,6 @@ vpSimulatorAfma6::vpSimulatorAfma6()
   mutex_display = CreateMutex(NULL, FALSE, NULL);
 #endif
 
-  DWORD dwThreadIdArray;
-  hThread = CreateThread(NULL,              // default security attributes
-                         0,                 // use default stack size
-                         launcher,          // thread function name
-                         this,              // argument to thread function
-                         0,                 // use default creation flags
-                         &dwThreadIdArray); // returns the thread identifier
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -99,10 +92,10 @@ vpSimulatorAfma6::vpSimulatorAfma6()
 
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  pthread_create(&thread, NULL, launcher, (void *)this);
 #endif
 
+  launchThread();
+
   compute_fMi();
 }
 
@@ -136,13 +129,6 @@ vpSimulatorAfma6::vpSimulatorAfma6(bool do_display)
   mutex_display = CreateMutex(NULL, FALSE, NULL);
 #endif
 
-  DWORD dwThreadIdArray;
-  hThread = CreateThread(NULL,              // default security attributes
-                         0,                 // use default stack size
-                         launcher,          // thread function name
-                         this,              // argument to thread function
-                         0,                 // use default creation flags
-                         &dwThreadIdArray); // returns the thread identifier
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -152,10 +138,10 @@ vpSimulatorAfma6::vpSimulatorAfma6(bool do_display)
 
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  pthread_create(&thread, NULL, launcher, (void *)this);
 #endif
 
+  launchThread();
+
   compute_fMi();
 }
 
@@ -164,15 +150,11 @@ vpSimulatorAfma6::vpSimulatorAfma6(bool do_display)
 */
 vpSimulatorAfma6::~vpSimulatorAfma6()
 {
-  robotStop = true;
+  if (!lockstepMode) {
+    joinThread();
+  }
 
 #if defined(_WIN32)
-#if defined(WINRT_8_1)
-  WaitForSingleObjectEx(hThread, INFINITE, FALSE);
-#else // pure win32
-  WaitForSingleObject(hThread, INFINITE);
-#endif
-  CloseHandle(hThread);
   CloseHandle(mutex_fMi);
   CloseHandle(mutex_artVel);
   CloseHandle(mutex_artCoord);
@@ -180,7 +162,6 @@ vpSimulatorAfma6::~vpSimulatorAfma6()
   CloseHandle(mutex_display);
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_attr_destroy(&attr);
-  pthread_join(thread, NULL);
   pthread_mutex_destroy(&mutex_fMi);
   pthread_mutex_destroy(&mutex_artVel);
   pthread_mutex_destroy(&mutex_artCoord);
@@ -520,101 +501,113 @@ void vpSimulatorAfma6::updateArticularPosition()
         ellapsedTime = getSamplingTime(); // in second
       }
 
-      vpColVector articularCoordinates = get_artCoord();
-      vpColVector articularVelocities = get_artVel();
-
-      if (jointLimit) {
-        double art = articularCoordinates[jointLimitArt - 1] + ellapsedTime * articularVelocities[jointLimitArt - 1];
-        if (art <= _joint_min[jointLimitArt - 1] || art >= _joint_max[jointLimitArt - 1]) {
-          if (verbose_) {
-            std::cout << "Joint " << jointLimitArt - 1
-                      << " reaches a limit: " << vpMath::deg(_joint_min[jointLimitArt - 1]) << " < " << vpMath::deg(art)
-                      << " < " << vpMath::deg(_joint_max[jointLimitArt - 1]) << std::endl;
-          }
-
-          articularVelocities = 0.0;
-        } else
-          jointLimit = false;
-      }
+      computeArticularPosition(ellapsedTime);
 
-      articularCoordinates[0] = articularCoordinates[0] + ellapsedTime * articularVelocities[0];
-      articularCoordinates[1] = articularCoordinates[1] + ellapsedTime * articularVelocities[1];
-      articularCoordinates[2] = articularCoordinates[2] + ellapsedTime * articularVelocities[2];
-      articularCoordinates[3] = articularCoordinates[3] + ellapsedTime * articularVelocities[3];
-      articularCoordinates[4] = articularCoordinates[4] + ellapsedTime * articularVelocities[4];
-      articularCoordinates[5] = articularCoordinates[5] + ellapsedTime * articularVelocities[5];
+      vpTime::wait(tcur, 1000 * getSamplingTime());
+      tcur_1 = tcur;
+    } else {
+      vpTime::wait(tcur, vpTime::getMinTimeForUsleepCall());
+    }
+  }
+}
 
-      int jl = isInJointLimit();
+/*!
+  Move the robot in the articular frame with the articular velocity during
+  the given time, stopping it at the joint limits, and update the external
+  view.
 
-      if (jl != 0 && jointLimit == false) {
-        if (jl < 0)
-          ellapsedTime = (_joint_min[(unsigned int)(-jl - 1)] - articularCoordinates[(unsigned int)(-jl - 1)]) /
-                         (articularVelocities[(unsigned int)(-jl - 1)]);
-        else
-          ellapsedTime = (_joint_max[(unsigned int)(jl - 1)] - articularCoordinates[(unsigned int)(jl - 1)]) /
-                         (articularVelocities[(unsigned int)(jl - 1)]);
+  \param ellapsedTime : Duration of the motion in second.
+*/
+void vpSimulatorAfma6::computeArticularPosition(double ellapsedTime)
+{
+  vpColVector articularCoordinates = get_artCoord();
+  vpColVector articularVelocities = get_artVel();
+
+  if (jointLimit) {
+    double art = articularCoordinates[jointLimitArt - 1] + ellapsedTime * articularVelocities[jointLimitArt - 1];
+    if (art <= _joint_min[jointLimitArt - 1] || art >= _joint_max[jointLimitArt - 1]) {
+      if (verbose_) {
+        std::cout << "Joint " << jointLimitArt - 1
+                  << " reaches a limit: " << vpMath::deg(_joint_min[jointLimitArt - 1]) << " < " << vpMath::deg(art)
+                  << " < " << vpMath::deg(_joint_max[jointLimitArt - 1]) << std::endl;
+      }
 
-        for (unsigned int i = 0; i < 6; i++)
-          articularCoordinates[i] = articularCoordinates[i] + ellapsedTime * articularVelocities[i];
+      articularVelocities = 0.0;
+    } else
+      jointLimit = false;
+  }
 
-        jointLimit = true;
-        jointLimitArt = (unsigned int)fabs((double)jl);
-      }
+  articularCoordinates[0] = articularCoordinates[0] + ellapsedTime * articularVelocities[0];
+  articularCoordinates[1] = articularCoordinates[1] + ellapsedTime * articularVelocities[1];
+  articularCoordinates[2] = articularCoordinates[2] + ellapsedTime * articularVelocities[2];
+  articularCoordinates[3] = articularCoordinates[3] + ellapsedTime * articularVelocities[3];
+  articularCoordinates[4] = articularCoordinates[4] + ellapsedTime * articularVelocities[4];
+  articularCoordinates[5] = articularCoordinates[5] + ellapsedTime * articularVelocities[5];
 
-      set_artCoord(articularCoordinates);
-      set_artVel(articularVelocities);
+  int jl = isInJointLimit();
 
-      compute_fMi();
+  if (jl != 0 && jointLimit == false) {
+    if (jl < 0)
+      ellapsedTime = (_joint_min[(unsigned int)(-jl - 1)] - articularCoordinates[(unsigned int)(-jl - 1)]) /
+                     (articularVelocities[(unsigned int)(-jl - 1)]);
+    else
+      ellapsedTime = (_joint_max[(unsigned int)(jl - 1)] - articularCoordinates[(unsigned int)(jl - 1)]) /
+                     (articularVelocities[(unsigned int)(jl - 1)]);
 
-      if (displayAllowed) {
-        vpDisplay::display(I);
-        vpDisplay::displayFrame(I, getExternalCameraPosition(), cameraParam, 0.2, vpColor::none, thickness_);
-        vpDisplay::displayFrame(I, getExternalCameraPosition() * fMi[7], cameraParam, 0.1, vpColor::none, thickness_);
-      }
+    for (unsigned int i = 0; i < 6; i++)
+      articularCoordinates[i] = articularCoordinates[i] + ellapsedTime * articularVelocities[i];
 
-      if (displayType == MODEL_3D && displayAllowed) {
-        while (get_displayBusy())
-          vpTime::wait(2);
-        vpSimulatorAfma6::getExternalImage(I);
-        set_displayBusy(false);
-      }
+    jointLimit = true;
+    jointLimitArt = (unsigned int)fabs((double)jl);
+  }
 
-      if (0 /*displayType == MODEL_DH && displayAllowed*/) {
-        vpHomogeneousMatrix fMit[8];
-        get_fMi(fMit);
+  set_artCoord(articularCoordinates);
+  set_artVel(articularVelocities);
 
-        // vpDisplay::displayFrame(I,getExternalCameraPosition
-        // ()*fMi[6],cameraParam,0.2,vpColor::none);
+  compute_fMi();
 
-        vpImagePoint iP, iP_1;
-        vpPoint pt(0, 0, 0);
+  if (displayAllowed) {
+    vpDisplay::display(I);
+    vpDisplay::displayFrame(I, getExternalCameraPosition(), cameraParam, 0.2, vpColor::none, thickness_);
+    vpDisplay::displayFrame(I, getExternalCameraPosition() * fMi[7], cameraParam, 0.1, vpColor::none, thickness_);
+  }
 
-        pt.track(getExternalCameraPosition());
-        vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
-        pt.track(getExternalCameraPosition() * fMit[0]);
-        vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
-        vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
-        for (unsigned int k = 1; k < 7; k++) {
-          pt.track(getExternalCameraPosition() * fMit[k - 1]);
-          vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
+  if (displayType == MODEL_3D && displayAllowed) {
+    while (get_displayBusy())
+      vpTime::wait(2);
+    vpSimulatorAfma6::getExternalImage(I);
+    set_displayBusy(false);
+  }
 
-          pt.track(getExternalCameraPosition() * fMit[k]);
-          vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
+  if (0 /*displayType == MODEL_DH && displayAllowed*/) {
+    vpHomogeneousMatrix fMit[8];
+    get_fMi(fMit);
 
-          vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
-        }
-        vpDisplay::displayCamera(I, getExternalCameraPosition() * fMit[7], cameraParam, 0.1, vpColor::green,
-                                 thickness_);
-      }
+    // vpDisplay::displayFrame(I,getExternalCameraPosition
+    // ()*fMi[6],cameraParam,0.2,vpColor::none);
 
-      vpDisplay::flush(I);
+    vpImagePoint iP, iP_1;
+    vpPoint pt(0, 0, 0);
 
-      vpTime::wait(tcur, 1000 * getSamplingTime());
-      tcur_1 = tcur;
-    } else {
-      vpTime::wait(tcur, vpTime::getMinTimeForUsleepCall());
+    pt.track(getExternalCameraPosition());
+    vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
+    pt.track(getExternalCameraPosition() * fMit[0]);
+    vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
+    vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
+    for (unsigned int k = 1; k < 7; k++) {
+      pt.track(getExternalCameraPosition() * fMit[k - 1]);
+      vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
+
+      pt.track(getExternalCameraPosition() * fMit[k]);
+      vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
+
+      vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
     }
+    vpDisplay::displayCamera(I, getExternalCameraPosition() * fMit[7], cameraParam, 0.1, vpColor::green,
+                             thickness_);
   }
+
+  vpDisplay::flush(I);
 }
 
 /*!
@@ -1146,7 +1139,8 @@ void vpSimulatorAfma6::getVelocity(const vpRobot::vpControlFrameType frame, vpCo
   \param vel : Measured velocities. Translations are expressed in m/s
   and rotations in rad/s.
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \warning In camera frame, reference frame and mixt frame, the representation
   of the rotation is ThetaU. In that cases, \f$velocity = [\dot x, \dot y,
@@ -1156,7 +1150,7 @@ void vpSimulatorAfma6::getVelocity(const vpRobot::vpControlFrameType frame, vpCo
 */
 void vpSimulatorAfma6::getVelocity(const vpRobot::vpControlFrameType frame, vpColVector &vel, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getVelocity(frame, vel);
 }
 
@@ -1215,7 +1209,8 @@ vpColVector vpSimulatorAfma6::getVelocity(vpRobot::vpControlFrameType frame)
 
   \param frame : Frame in wich velocities are mesured.
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \return Measured velocities. Translations are expressed in m/s
   and rotations in rad/s.
@@ -1224,7 +1219,7 @@ vpColVector vpSimulatorAfma6::getVelocity(vpRobot::vpControlFrameType frame)
 */
 vpColVector vpSimulatorAfma6::getVelocity(vpRobot::vpControlFrameType frame, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   vpColVector vel(6);
   getVelocity(frame, vel);
 
@@ -1368,6 +1363,7 @@ void vpSimulatorAfma6::setPosition(const vpRobot::vpControlFrameType frame, cons
           set_velocity(error);
           break;
         }
+        stepArticularPosition();
       } else {
         vpERROR_TRACE("Positionning error.");
         throw vpRobotException(vpRobotException::positionOutOfRangeError, "Position out of range.");
@@ -1392,6 +1388,7 @@ void vpSimulatorAfma6::setPosition(const vpRobot::vpControlFrameType frame, cons
         set_velocity(error);
         break;
       }
+      stepArticularPosition();
     } while (errsqr > 1e-8);
     break;
   }
@@ -1427,6 +1424,7 @@ void vpSimulatorAfma6::setPosition(const vpRobot::vpControlFrameType frame, cons
           set_velocity(error);
           break;
         }
+        stepArticularPosition();
       } else
         vpERROR_TRACE("Positionning error. Position unreachable");
     } while (errsqr > 1e-8 && nbSol > 0);
@@ -1703,13 +1701,14 @@ void vpSimulatorAfma6::getPosition(const vpRobot::vpControlFrameType frame, vpCo
   last 3 values to the rx, ry, rz rotation (like a vpRxyzVector). The code
   below show how to convert this position into a vpHomogeneousMatrix:
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \sa getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q)
  */
 void vpSimulatorAfma6::getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, q);
 }
 
@@ -1753,7 +1752,7 @@ void vpSimulatorAfma6::getPosition(const vpRobot::vpControlFrameType frame, vpPo
  */
 void vpSimulatorAfma6::getPosition(const vpRobot::vpControlFrameType frame, vpPoseVector &position, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, position);
 }
 
@@ -2481,7 +2480,11 @@ bool vpSimulatorAfma6::setPosition(const vpHomogeneousMatrix &cdMo_, vpImage<uns
     setVelocity(vpRobot::CAMERA_FRAME, vel);
 
     // wait for it
-    vpTime::wait(t, 10);
+    if (lockstepMode) {
+      step();
+    } else {
+      vpTime::wait(t, 10);
+    }
   }
   vel = 0.;
   set_velocity(vel);
@@ -83,13 +83,6 @@ vpSimulatorViper850::vpSimulatorViper850()
   mutex_display = CreateMutex(NULL, FALSE, NULL);
 #endif
 
-  DWORD dwThreadIdArray;
-  hThread = CreateThread(NULL,              // default security attributes
-                         0,                 // use default stack size
-                         launcher,          // thread function name
-                         this,              // argument to thread function
-                         0,                 // use default creation flags
-                         &dwThreadIdArray); // returns the thread identifier
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -99,10 +92,10 @@ vpSimulatorViper850::vpSimulatorViper850()
 
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  pthread_create(&thread, NULL, launcher, (void *)this);
 #endif
 
+  launchThread();
+
   compute_fMi();
 }
 
@@ -136,13 +129,6 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
   mutex_display = CreateMutex(NULL, FALSE, NULL);
 #endif
 
-  DWORD dwThreadIdArray;
-  hThread = CreateThread(NULL,              // default security attributes
-                         0,                 // use default stack size
-                         launcher,          // thread function name
-                         this,              // argument to thread function
-                         0,                 // use default creation flags
-                         &dwThreadIdArray); // returns the thread identifier
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_mutex_init(&mutex_fMi, NULL);
   pthread_mutex_init(&mutex_artVel, NULL);
@@ -152,10 +138,10 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
 
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  pthread_create(&thread, NULL, launcher, (void *)this);
 #endif
 
+  launchThread();
+
   compute_fMi();
 }
 
@@ -164,15 +150,11 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
 */
 vpSimulatorViper850::~vpSimulatorViper850()
 {
-  robotStop = true;
+  if (!lockstepMode) {
+    joinThread();
+  }
 
 #if defined(_WIN32)
-#if defined(WINRT_8_1)
-  WaitForSingleObjectEx(hThread, INFINITE, FALSE);
-#else // pure win32
-  WaitForSingleObject(hThread, INFINITE);
-#endif
-  CloseHandle(hThread);
   CloseHandle(mutex_fMi);
   CloseHandle(mutex_artVel);
   CloseHandle(mutex_artCoord);
@@ -180,7 +162,6 @@ vpSimulatorViper850::~vpSimulatorViper850()
   CloseHandle(mutex_display);
 #elif defined(VISP_HAVE_PTHREAD)
   pthread_attr_destroy(&attr);
-  pthread_join(thread, NULL);
   pthread_mutex_destroy(&mutex_fMi);
   pthread_mutex_destroy(&mutex_artVel);
   pthread_mutex_destroy(&mutex_artCoord);
@@ -465,100 +446,112 @@ void vpSimulatorViper850::updateArticularPosition()
         ellapsedTime = getSamplingTime(); // in second
       }
 
-      vpColVector articularCoordinates = get_artCoord();
-      vpColVector articularVelocities = get_artVel();
-
-      if (jointLimit) {
-        double art = articularCoordinates[jointLimitArt - 1] + ellapsedTime * articularVelocities[jointLimitArt - 1];
-        if (art <= joint_min[jointLimitArt - 1] || art >= joint_max[jointLimitArt - 1]) {
-          if (verbose_) {
-            std::cout << "Joint " << jointLimitArt - 1
-                      << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt - 1]) << " < " << vpMath::deg(art)
-                      << " < " << vpMath::deg(joint_max[jointLimitArt - 1]) << std::endl;
-          }
-          articularVelocities = 0.0;
-        } else
-          jointLimit = false;
-      }
+      computeArticularPosition(ellapsedTime);
 
-      articularCoordinates[0] = articularCoordinates[0] + ellapsedTime * articularVelocities[0];
-      articularCoordinates[1] = articularCoordinates[1] + ellapsedTime * articularVelocities[1];
-      articularCoordinates[2] = articularCoordinates[2] + ellapsedTime * articularVelocities[2];
-      articularCoordinates[3] = articularCoordinates[3] + ellapsedTime * articularVelocities[3];
-      articularCoordinates[4] = articularCoordinates[4] + ellapsedTime * articularVelocities[4];
-      articularCoordinates[5] = articularCoordinates[5] + ellapsedTime * articularVelocities[5];
+      vpTime::wait(tcur, 1000 * getSamplingTime());
+      tcur_1 = tcur;
+    } else {
+      vpTime::wait(tcur, vpTime::getMinTimeForUsleepCall());
+    }
+  }
+}
+
+/*!
+  Move the robot in the articular frame with the articular velocity during
+  the given time, stopping it at the joint limits, and update the external
+  view.
 
-      int jl = isInJointLimit();
+  \param ellapsedTime : Duration of the motion in second.
+*/
+void vpSimulatorViper850::computeArticularPosition(double ellapsedTime)
+{
+  vpColVector articularCoordinates = get_artCoord();
+  vpColVector articularVelocities = get_artVel();
+
+  if (jointLimit) {
+    double art = articularCoordinates[jointLimitArt - 1] + ellapsedTime * articularVelocities[jointLimitArt - 1];
+    if (art <= joint_min[jointLimitArt - 1] || art >= joint_max[jointLimitArt - 1]) {
+      if (verbose_) {
+        std::cout << "Joint " << jointLimitArt - 1
+                  << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt - 1]) << " < " << vpMath::deg(art)
+                  << " < " << vpMath::deg(joint_max[jointLimitArt - 1]) << std::endl;
+      }
+      articularVelocities = 0.0;
+    } else
+      jointLimit = false;
+  }
 
-      if (jl != 0 && jointLimit == false) {
-        if (jl < 0)
-          ellapsedTime = (joint_min[(unsigned int)(-jl - 1)] - articularCoordinates[(unsigned int)(-jl - 1)]) /
-                         (articularVelocities[(unsigned int)(-jl - 1)]);
-        else
-          ellapsedTime = (joint_max[(unsigned int)(jl - 1)] - articularCoordinates[(unsigned int)(jl - 1)]) /
-                         (articularVelocities[(unsigned int)(jl - 1)]);
+  articularCoordinates[0] = articularCoordinates[0] + ellapsedTime * articularVelocities[0];
+  articularCoordinates[1] = articularCoordinates[1] + ellapsedTime * articularVelocities[1];
+  articularCoordinates[2] = articularCoordinates[2] + ellapsedTime * articularVelocities[2];
+  articularCoordinates[3] = articularCoordinates[3] + ellapsedTime * articularVelocities[3];
+  articularCoordinates[4] = articularCoordinates[4] + ellapsedTime * articularVelocities[4];
+  articularCoordinates[5] = articularCoordinates[5] + ellapsedTime * articularVelocities[5];
 
-        for (unsigned int i = 0; i < 6; i++)
-          articularCoordinates[i] = articularCoordinates[i] + ellapsedTime * articularVelocities[i];
+  int jl = isInJointLimit();
 
-        jointLimit = true;
-        jointLimitArt = (unsigned int)fabs((double)jl);
-      }
+  if (jl != 0 && jointLimit == false) {
+    if (jl < 0)
+      ellapsedTime = (joint_min[(unsigned int)(-jl - 1)] - articularCoordinates[(unsigned int)(-jl - 1)]) /
+                     (articularVelocities[(unsigned int)(-jl - 1)]);
+    else
+      ellapsedTime = (joint_max[(unsigned int)(jl - 1)] - articularCoordinates[(unsigned int)(jl - 1)]) /
+                     (articularVelocities[(unsigned int)(jl - 1)]);
 
-      set_artCoord(articularCoordinates);
-      set_artVel(articularVelocities);
+    for (unsigned int i = 0; i < 6; i++)
+      articularCoordinates[i] = articularCoordinates[i] + ellapsedTime * articularVelocities[i];
 
-      compute_fMi();
+    jointLimit = true;
+    jointLimitArt = (unsigned int)fabs((double)jl);
+  }
 
-      if (displayAllowed) {
-        vpDisplay::display(I);
-        vpDisplay::displayFrame(I, getExternalCameraPosition(), cameraParam, 0.2, vpColor::none, thickness_);
-        vpDisplay::displayFrame(I, getExternalCameraPosition() * fMi[7], cameraParam, 0.1, vpColor::none, thickness_);
-      }
+  set_artCoord(articularCoordinates);
+  set_artVel(articularVelocities);
 
-      if (displayType == MODEL_3D && displayAllowed) {
-        while (get_displayBusy())
-          vpTime::wait(2);
-        vpSimulatorViper850::getExternalImage(I);
-        set_displayBusy(false);
-      }
+  compute_fMi();
 
-      if (displayType == MODEL_DH && displayAllowed) {
-        vpHomogeneousMatrix fMit[8];
-        get_fMi(fMit);
+  if (displayAllowed) {
+    vpDisplay::display(I);
+    vpDisplay::displayFrame(I, getExternalCameraPosition(), cameraParam, 0.2, vpColor::none, thickness_);
+    vpDisplay::displayFrame(I, getExternalCameraPosition() * fMi[7], cameraParam, 0.1, vpColor::none, thickness_);
+  }
 
-        // vpDisplay::displayFrame(I,getExternalCameraPosition
-        // ()*fMi[6],cameraParam,0.2,vpColor::none);
+  if (displayType == MODEL_3D && displayAllowed) {
+    while (get_displayBusy())
+      vpTime::wait(2);
+    vpSimulatorViper850::getExternalImage(I);
+    set_displayBusy(false);
+  }
 
-        vpImagePoint iP, iP_1;
-        vpPoint pt(0, 0, 0);
+  if (displayType == MODEL_DH && displayAllowed) {
+    vpHomogeneousMatrix fMit[8];
+    get_fMi(fMit);
 
-        pt.track(getExternalCameraPosition());
-        vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
-        pt.track(getExternalCameraPosition() * fMit[0]);
-        vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
-        vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
-        for (int k = 1; k < 7; k++) {
-          pt.track(getExternalCameraPosition() * fMit[k - 1]);
-          vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
+    // vpDisplay::displayFrame(I,getExternalCameraPosition
+    // ()*fMi[6],cameraParam,0.2,vpColor::none);
 
-          pt.track(getExternalCameraPosition() * fMit[k]);
-          vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
+    vpImagePoint iP, iP_1;
+    vpPoint pt(0, 0, 0);
 
-          vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
-        }
-        vpDisplay::displayCamera(I, getExternalCameraPosition() * fMit[7], cameraParam, 0.1, vpColor::green,
-                                 thickness_);
-      }
+    pt.track(getExternalCameraPosition());
+    vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
+    pt.track(getExternalCameraPosition() * fMit[0]);
+    vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
+    vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
+    for (int k = 1; k < 7; k++) {
+      pt.track(getExternalCameraPosition() * fMit[k - 1]);
+      vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP_1);
 
-      vpDisplay::flush(I);
+      pt.track(getExternalCameraPosition() * fMit[k]);
+      vpMeterPixelConversion::convertPoint(cameraParam, pt.get_x(), pt.get_y(), iP);
 
-      vpTime::wait(tcur, 1000 * getSamplingTime());
-      tcur_1 = tcur;
-    } else {
-      vpTime::wait(tcur, vpTime::getMinTimeForUsleepCall());
+      vpDisplay::displayLine(I, iP_1, iP, vpColor::green, thickness_);
     }
+    vpDisplay::displayCamera(I, getExternalCameraPosition() * fMit[7], cameraParam, 0.1, vpColor::green,
+                             thickness_);
   }
+
+  vpDisplay::flush(I);
 }
 
 /*!
@@ -1097,7 +1090,8 @@ void vpSimulatorViper850::getVelocity(const vpRobot::vpControlFrameType frame, v
   \param vel : Measured velocities. Translations are expressed in m/s
   and rotations in rad/s.
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \warning In camera frame, reference frame and mixt frame, the representation
   of the rotation is ThetaU. In that cases, \f$velocity = [\dot x, \dot y,
@@ -1107,7 +1101,7 @@ void vpSimulatorViper850::getVelocity(const vpRobot::vpControlFrameType frame, v
 */
 void vpSimulatorViper850::getVelocity(const vpRobot::vpControlFrameType frame, vpColVector &vel, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getVelocity(frame, vel);
 }
 
@@ -1166,7 +1160,8 @@ vpColVector vpSimulatorViper850::getVelocity(vpRobot::vpControlFrameType frame)
 
   \param frame : Frame in wich velocities are mesured.
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \return Measured velocities. Translations are expressed in m/s
   and rotations in rad/s.
@@ -1175,7 +1170,7 @@ vpColVector vpSimulatorViper850::getVelocity(vpRobot::vpControlFrameType frame)
 */
 vpColVector vpSimulatorViper850::getVelocity(vpRobot::vpControlFrameType frame, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   vpColVector vel(6);
   getVelocity(frame, vel);
 
@@ -1319,6 +1314,7 @@ void vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame, c
           set_velocity(error);
           break;
         }
+        stepArticularPosition();
       } else {
         vpERROR_TRACE("Positionning error.");
         throw vpRobotException(vpRobotException::positionOutOfRangeError, "Position out of range.");
@@ -1343,6 +1339,7 @@ void vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame, c
         set_velocity(error);
         break;
       }
+      stepArticularPosition();
     } while (errsqr > 1e-8);
     break;
   }
@@ -1378,6 +1375,7 @@ void vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame, c
           set_velocity(error);
           break;
         }
+        stepArticularPosition();
       } else
         vpERROR_TRACE("Positionning error. Position unreachable");
     } while (errsqr > 1e-8 && nbSol > 0);
@@ -1654,13 +1652,14 @@ void vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, v
   last 3 values to the rx, ry, rz rotation (like a vpRxyzVector). The code
   below show how to convert this position into a vpHomogeneousMatrix:
 
-  \param timestamp : Unix time in second since January 1st 1970.
+  \param timestamp : Unix time in second since January 1st 1970, or
+  simulation time in the lockstep mode (see setLockstepMode()).
 
   \sa getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q)
  */
 void vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, q);
 }
 
@@ -1705,7 +1704,7 @@ void vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, v
 void vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpPoseVector &position,
                                       double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, position);
 }
 
@@ -0,0 +1,286 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trajectory generator for joint positioning.
+ *
+ * This code was originally part of libfranka and adapted to use ViSP instead
+ * of Eigen.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpJointPosTrajGenerator.cpp
+  \brief Trajectory generator for joint positioning.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/robot/vpJointPosTrajGenerator.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Displacement under which a joint does not move (rad)
+const double kDeltaQMotionFinished = 1e-6;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. init() has to be called before setting a goal.
+*/
+vpJointPosTrajGenerator::vpJointPosTrajGenerator()
+  : m_q_goal(), m_q_start(), m_delta_q(), m_dq_max_sync(), m_t_1_sync(), m_t_2_sync(), m_t_f_sync(), m_q_1(),
+    m_dq_max(), m_ddq_max_start(), m_ddq_max_goal(), m_t_f(0.)
+{
+}
+
+/*!
+  Set the velocity and acceleration limits of the joints, and allocate all
+  the buffers used to compute the trajectory.
+
+  \param dq_max : Maximum velocity of each joint.
+  \param ddq_max_start : Maximum acceleration of each joint at the start of
+  the motion.
+  \param ddq_max_goal : Maximum deceleration of each joint at the end of the
+  motion.
+  \param speed_factor : Factor in ]0, 1] applied to the velocity and
+  acceleration limits.
+
+  \exception vpException::dimensionError : If the limits have not the same
+  number of joints.
+  \exception vpException::badValue : If the speed factor or a limit is not
+  positive.
+*/
+void vpJointPosTrajGenerator::init(const vpColVector &dq_max, const vpColVector &ddq_max_start,
+                                   const vpColVector &ddq_max_goal, double speed_factor)
+{
+  unsigned int n = dq_max.size();
+  if (n == 0 || ddq_max_start.size() != n || ddq_max_goal.size() != n) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot initialize the joint trajectory generator with %d velocity limits, %d acceleration "
+                      "limits and %d deceleration limits",
+                      dq_max.size(), ddq_max_start.size(), ddq_max_goal.size()));
+  }
+  if (speed_factor <= 0.) {
+    throw(vpException(vpException::badValue, "Bad speed factor %f of the joint trajectory generator", speed_factor));
+  }
+  for (unsigned int i = 0; i < n; i++) {
+    if (dq_max[i] <= 0. || ddq_max_start[i] <= 0. || ddq_max_goal[i] <= 0.) {
+      throw(vpException(vpException::badValue, "Bad velocity or acceleration limit of joint %d", i));
+    }
+  }
+
+  m_dq_max = dq_max * speed_factor;
+  m_ddq_max_start = ddq_max_start * speed_factor;
+  m_ddq_max_goal = ddq_max_goal * speed_factor;
+
+  m_q_goal.resize(n);
+  m_q_start.resize(n);
+  m_delta_q.resize(n);
+  m_dq_max_sync.resize(n);
+  m_t_1_sync.resize(n);
+  m_t_2_sync.resize(n);
+  m_t_f_sync.resize(n);
+  m_q_1.resize(n);
+  m_t_f = 0.;
+}
+
+/*!
+  Compute the synchronized profiles of the joints from a start to a goal
+  position, without memory allocation.
+
+  \param q_start : Start position of the joints, with getNbJoints() values.
+  \param q_goal : Goal position of the joints, with getNbJoints() values.
+*/
+void vpJointPosTrajGenerator::setGoal(const double *q_start, const double *q_goal)
+{
+  unsigned int n = m_q_goal.size();
+
+  // Duration of the motion of each joint at its maximum velocity
+  m_t_f = 0.;
+  for (unsigned int i = 0; i < n; i++) {
+    m_q_start[i] = q_start[i];
+    m_q_goal[i] = q_goal[i];
+    m_delta_q[i] = q_goal[i] - q_start[i];
+    double delta_q = std::fabs(m_delta_q[i]);
+    if (delta_q > kDeltaQMotionFinished) {
+      double dq_max_reach = m_dq_max[i];
+      if (delta_q < 0.75 * (m_dq_max[i] * m_dq_max[i] / m_ddq_max_start[i]) +
+                        0.75 * (m_dq_max[i] * m_dq_max[i] / m_ddq_max_goal[i])) {
+        dq_max_reach = sqrt(4.0 / 3.0 * delta_q * (m_ddq_max_start[i] * m_ddq_max_goal[i]) /
+                            (m_ddq_max_start[i] + m_ddq_max_goal[i]));
+      }
+      double t_1 = 1.5 * dq_max_reach / m_ddq_max_start[i];
+      double delta_t_2 = 1.5 * dq_max_reach / m_ddq_max_goal[i];
+      m_t_f = std::max(m_t_f, t_1 / 2.0 + delta_t_2 / 2.0 + delta_q / dq_max_reach);
+    }
+  }
+
+  // Slow down the joints to reach the goal at the same time than the slowest
+  double max_t_f = m_t_f;
+  m_t_f = 0.;
+  for (unsigned int i = 0; i < n; i++) {
+    double delta_q = std::fabs(m_delta_q[i]);
+    if (delta_q > kDeltaQMotionFinished) {
+      double a = 1.5 / 2.0 * (m_ddq_max_goal[i] + m_ddq_max_start[i]);
+      double b = -1.0 * max_t_f * m_ddq_max_goal[i] * m_ddq_max_start[i];
+      double c = delta_q * m_ddq_max_goal[i] * m_ddq_max_start[i];
+      double delta = b * b - 4.0 * a * c;
+      if (delta < 0.0) {
+        delta = 0.0;
+      }
+      m_dq_max_sync[i] = (-1.0 * b - sqrt(delta)) / (2.0 * a);
+      m_t_1_sync[i] = 1.5 * m_dq_max_sync[i] / m_ddq_max_start[i];
+      double delta_t_2_sync = 1.5 * m_dq_max_sync[i] / m_ddq_max_goal[i];
+      m_t_f_sync[i] = m_t_1_sync[i] / 2.0 + delta_t_2_sync / 2.0 + delta_q / m_dq_max_sync[i];
+      m_t_2_sync[i] = m_t_f_sync[i] - delta_t_2_sync;
+      m_q_1[i] = m_dq_max_sync[i] * vpMath::sign(m_delta_q[i]) * (0.5 * m_t_1_sync[i]);
+      m_t_f = std::max(m_t_f, m_t_f_sync[i]);
+    } else {
+      m_dq_max_sync[i] = m_t_1_sync[i] = m_t_2_sync[i] = m_t_f_sync[i] = m_q_1[i] = 0.;
+    }
+  }
+}
+
+/*!
+  Compute the synchronized profiles of the joints from a start to a goal
+  position.
+
+  \param q_start : Start position of the joints.
+  \param q_goal : Goal position of the joints.
+
+  \exception vpException::dimensionError : If the positions have not the
+  number of joints given to init().
+*/
+void vpJointPosTrajGenerator::setGoal(const vpColVector &q_start, const vpColVector &q_goal)
+{
+  if (q_start.size() != getNbJoints() || q_goal.size() != getNbJoints()) {
+    throw(vpException(vpException::dimensionError,
+                      "Cannot move %d joints from a %d-dimension start position to a %d-dimension goal position",
+                      getNbJoints(), q_start.size(), q_goal.size()));
+  }
+  setGoal(q_start.data, q_goal.data);
+}
+
+/*!
+  Compute the position of the joints at a given time of the trajectory,
+  without memory allocation.
+
+  \param t : Time since the start of the motion, in seconds.
+  \param q : Position of the joints, with getNbJoints() values.
+
+  \return true when all the joints reached the goal.
+*/
+bool vpJointPosTrajGenerator::computePosition(double t, double *q) const
+{
+  unsigned int n = m_q_goal.size();
+  bool motion_finished = true;
+  for (unsigned int i = 0; i < n; i++) {
+    double delta_q_d;
+    if (std::fabs(m_delta_q[i]) < kDeltaQMotionFinished) {
+      delta_q_d = 0.;
+    } else {
+      double dq_max_sync = m_dq_max_sync[i] * vpMath::sign(m_delta_q[i]);
+      if (t < m_t_1_sync[i]) {
+        // Acceleration
+        double t_1 = m_t_1_sync[i];
+        delta_q_d = -1.0 / (t_1 * t_1 * t_1) * dq_max_sync * (0.5 * t - t_1) * (t * t * t);
+        motion_finished = false;
+      } else if (t < m_t_2_sync[i]) {
+        // Constant velocity
+        delta_q_d = m_q_1[i] + (t - m_t_1_sync[i]) * dq_max_sync;
+        motion_finished = false;
+      } else if (t < m_t_f_sync[i]) {
+        // Deceleration
+        double t_d = m_t_2_sync[i] - m_t_1_sync[i];
+        double delta_t_2_sync = m_t_f_sync[i] - m_t_2_sync[i];
+        double t_2 = t - m_t_1_sync[i] - t_d;
+        delta_q_d = m_delta_q[i] + 0.5 *
+                                       (1.0 / (delta_t_2_sync * delta_t_2_sync * delta_t_2_sync) *
+                                            (t_2 - 2.0 * delta_t_2_sync) * (t_2 * t_2 * t_2) +
+                                        (2.0 * t_2 - delta_t_2_sync)) *
+                                       dq_max_sync;
+        motion_finished = false;
+      } else {
+        delta_q_d = m_delta_q[i];
+      }
+    }
+    q[i] = m_q_start[i] + delta_q_d;
+  }
+  return motion_finished;
+}
+
+/*!
+  Compute the position of the joints at a given time of the trajectory.
+
+  \param t : Time since the start of the motion, in seconds.
+  \param q : Position of the joints. It is resized to getNbJoints() values
+  if needed, so that no memory is allocated when it has already this size.
+
+  \return true when all the joints reached the goal.
+*/
+bool vpJointPosTrajGenerator::computePosition(double t, vpColVector &q) const
+{
+  q.resize(getNbJoints(), false);
+  return computePosition(t, q.data);
+}
+
+/*!
+  Sample the whole trajectory from the start to the goal in a batch.
+
+  \param delta_t : Sampling period, in seconds.
+  \param Q : Position of the joints, with a row per sample at time k *
+  delta_t, up to the first sample where the goal is reached, and a column per
+  joint.
+
+  \return The number of samples.
+
+  \exception vpException::badValue : If the sampling period is not positive.
+*/
+unsigned int vpJointPosTrajGenerator::computeProfile(double delta_t, vpMatrix &Q) const
+{
+  if (delta_t <= 0.) {
+    throw(vpException(vpException::badValue, "Bad sampling period %f of the joint trajectory", delta_t));
+  }
+  // The motion is finished at the first sample after the duration
+  unsigned int n = (unsigned int)(m_t_f / delta_t);
+  while (n * delta_t < m_t_f) {
+    n++;
+  }
+  Q.resize(n + 1, getNbJoints(), false);
+  for (unsigned int k = 0; k <= n; k++) {
+    computePosition(k * delta_t, Q[k]);
+  }
+  return n + 1;
+}
@@ -0,0 +1,343 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trajectory generator for joint velocity control.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpJointVelTrajGenerator.cpp
+  \brief Trajectory generator for joint velocity control.
+*/
+
+#include <algorithm>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/robot/vpJointVelTrajGenerator.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Margin to stop before the joint limits (rad)
+const double kOffsetJointLimit = vpMath::rad(1.);
+// Position increment under which a joint is stopped (rad)
+const double kDeltaQMin = 1e-9;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. init() has to be called before applying velocities.
+*/
+vpJointVelTrajGenerator::vpJointVelTrajGenerator()
+  : m_status(), m_delta_q(), m_delta_q_max(), m_delta_q_acc(), m_q_final(), m_sign(), m_q_cmd(), m_q_cmd_prev(),
+    m_dist_AD(), m_dq_des(), m_dq_des_prev(), m_flagSpeed(), m_q_min(), m_q_max(), m_dq_max(), m_ddq_max(),
+    m_delta_t(0.001), m_flagJointLimit(false), m_joint_limit_axis(-1)
+{
+}
+
+/*!
+  Set the current position and the limits of the joints, and allocate all
+  the buffers used to compute the commands. The joints are considered
+  stopped.
+
+  \param q : Current position of the joints.
+  \param q_min, q_max : Lower and upper limits of the joints.
+  \param dq_max : Maximum velocity of each joint.
+  \param ddq_max : Maximum acceleration of each joint.
+  \param delta_t : Period between two commands, in seconds.
+
+  \exception vpException::dimensionError : If the parameters have not the
+  same number of joints.
+  \exception vpException::badValue : If the period is not positive.
+*/
+void vpJointVelTrajGenerator::init(const vpColVector &q, const vpColVector &q_min, const vpColVector &q_max,
+                                   const vpColVector &dq_max, const vpColVector &ddq_max, double delta_t)
+{
+  unsigned int n = q.size();
+  if (n == 0 || q_min.size() != n || q_max.size() != n || dq_max.size() != n || ddq_max.size() != n) {
+    throw(vpException(vpException::dimensionError, "Inconsistent number of joints"));
+  }
+  if (delta_t <= 0.) {
+    throw(vpException(vpException::badValue, "Bad period %f of the joint commands", delta_t));
+  }
+  m_q_min = q_min;
+  m_q_max = q_max;
+  m_dq_max = dq_max;
+  m_ddq_max = ddq_max;
+
+  m_delta_t = delta_t;
+
+  m_q_final = m_q_cmd = q;
+  m_q_cmd_prev = m_q_cmd;
+
+  m_dq_des.resize(n);
+  m_dq_des_prev.resize(n);
+  m_delta_q.resize(n);
+  m_delta_q_max.resize(n);
+  m_dist_AD.resize(n);
+  m_sign.assign(n, 0);
+  m_flagSpeed.assign(n, false);
+  m_status.assign(n, FLAGSTO);
+  m_flagJointLimit = false;
+  m_joint_limit_axis = -1;
+
+  m_delta_q_acc = m_ddq_max * (m_delta_t * m_delta_t);
+}
+
+// Update the distance required by a joint to accelerate or decelerate
+void vpJointVelTrajGenerator::updateDistanceAD(unsigned int i)
+{
+  int n = (int)(m_delta_q_max[i] / m_delta_q_acc[i]);
+  m_dist_AD[i] = n * (m_delta_q_max[i] - (n + 1) * m_delta_q_acc[i] / 2);
+}
+
+/*!
+  Compute the joint position and velocity commands to reach the desired
+  joint velocities, without memory allocation.
+
+  \param dq_des : Desired velocity of the joints, with getNbJoints() values.
+  \param q_cmd : Position command of the joints, with getNbJoints() values.
+  \param dq_cmd : Velocity command of the joints, with getNbJoints() values.
+*/
+void vpJointVelTrajGenerator::applyVel(const double *dq_des, double *q_cmd, double *dq_cmd)
+{
+  unsigned int njoints = m_q_cmd.size();
+  m_joint_limit_axis = -1;
+
+  for (unsigned int i = 0; i < njoints; i++) {
+    m_dq_des[i] = dq_des[i];
+
+    if (m_dq_des[i] != m_dq_des_prev[i]) {
+      m_flagJointLimit = false;
+
+      if (m_dq_des[i] > m_dq_max[i]) {
+        m_dq_des[i] = m_dq_max[i];
+      } else if (m_dq_des[i] < (-m_dq_max[i])) {
+        m_dq_des[i] = -m_dq_max[i];
+      }
+
+      if (m_flagSpeed[i] == false) {
+        // Change from stop to new vel with acc control
+        if (m_status[i] == FLAGSTO) {
+          if (m_dq_des[i] > 0) {
+            m_delta_q_max[i] = m_dq_des[i] * m_delta_t;
+            m_sign[i] = 1;
+            m_q_final[i] = m_q_max[i] - kOffsetJointLimit;
+            m_delta_q[i] = 0;
+            m_status[i] = FLAGACC;
+          } else if (m_dq_des[i] < 0) {
+            m_delta_q_max[i] = -m_dq_des[i] * m_delta_t;
+            m_sign[i] = -1;
+            m_q_final[i] = m_q_min[i] + kOffsetJointLimit;
+            m_delta_q[i] = 0;
+            m_status[i] = FLAGACC;
+          }
+        }
+        // Change of direction
+        else if ((m_dq_des[i] * m_sign[i]) < 0) {
+          m_flagSpeed[i] = true;
+          m_status[i] = FLAGDEC;
+          m_delta_q_max[i] = 0;
+        } else {
+          // Acceleration or deceleration
+          if (m_sign[i] == 1) {
+            m_status[i] = m_dq_des[i] > m_dq_des_prev[i] ? FLAGACC : FLAGDEC;
+            m_delta_q_max[i] = m_dq_des[i] * m_delta_t;
+          } else {
+            m_status[i] = m_dq_des[i] > m_dq_des_prev[i] ? FLAGDEC : FLAGACC;
+            m_delta_q_max[i] = -m_dq_des[i] * m_delta_t;
+          }
+        }
+
+        updateDistanceAD(i);
+      }
+      m_dq_des_prev[i] = m_dq_des[i];
+    }
+  }
+
+  // Compute new command in case of acceleration, deceleration or stop
+  for (unsigned int i = 0; i < njoints; i++) {
+    // Security joint limit
+    double dist_to_final = (m_q_final[i] - m_q_cmd[i]) * m_sign[i];
+    if ((dist_to_final - m_delta_q_max[i]) <= m_dist_AD[i]) {
+      if (m_dist_AD[i] > 0) {
+        if (!m_flagJointLimit) {
+          m_joint_limit_axis = (int)i;
+        }
+        m_flagJointLimit = true;
+        for (unsigned int k = 0; k < njoints; k++) {
+          if (m_status[k] != FLAGSTO) {
+            m_status[k] = FLAGDEC;
+          }
+          m_delta_q_max[k] = 0;
+        }
+      }
+    }
+
+    if (m_status[i] == FLAGDEC) {
+      // Deceleration
+      m_delta_q[i] -= m_delta_q_acc[i];
+      if (m_delta_q[i] <= m_delta_q_max[i]) {
+        if (m_delta_q_max[i] < kDeltaQMin) {
+          m_status[i] = FLAGSTO;
+          m_delta_q[i] = 0.0;
+          // Test if change of direction
+          if (m_flagSpeed[i] == true) {
+            if (m_dq_des[i] > 0) {
+              m_delta_q_max[i] = m_dq_des[i] * m_delta_t;
+              m_sign[i] = 1;
+              m_q_final[i] = m_q_max[i] - kOffsetJointLimit;
+            } else if (m_dq_des[i] < 0) {
+              m_delta_q_max[i] = -m_dq_des[i] * m_delta_t;
+              m_sign[i] = -1;
+              m_q_final[i] = m_q_min[i] + kOffsetJointLimit;
+            }
+            m_status[i] = FLAGACC;
+            m_flagSpeed[i] = false;
+
+            updateDistanceAD(i);
+          }
+        } else if ((m_delta_q_max[i] > 0) && !m_flagJointLimit) {
+          if (m_delta_q_max[i] < (m_delta_q[i] + 2 * m_delta_q_acc[i])) {
+            m_delta_q[i] = m_delta_q_max[i];
+            m_status[i] = FLAGCTE;
+          } else {
+            // Slower acceleration
+            m_delta_q[i] += (2 * m_delta_q_acc[i]);
+            m_status[i] = FLAGACC;
+          }
+        }
+      }
+    } else if (m_status[i] == FLAGACC) {
+      // Acceleration
+      m_delta_q[i] += m_delta_q_acc[i];
+
+      if (m_delta_q[i] >= m_delta_q_max[i]) {
+        m_delta_q[i] = m_delta_q_max[i];
+        m_status[i] = FLAGCTE;
+      }
+    }
+    // Constant velocity
+    m_q_cmd[i] += m_sign[i] * m_delta_q[i];
+  }
+
+  // Stop all the joints if one of them reaches its limit
+  for (unsigned int i = 0; i < njoints; i++) {
+    double q_low = m_q_min[i] + kOffsetJointLimit;
+    double q_high = m_q_max[i] - kOffsetJointLimit;
+    if (m_q_cmd[i] < q_low || m_q_cmd[i] > q_high) {
+      double q_limit = m_q_cmd[i] < q_low ? q_low : q_high;
+      for (unsigned int j = 0; j < njoints; j++) {
+        m_q_cmd[j] -= m_sign[j] * m_delta_q[j];
+      }
+      m_q_cmd[i] = q_limit;
+      m_joint_limit_axis = (int)i;
+      break;
+    }
+  }
+
+  // Compute velocity command
+  for (unsigned int i = 0; i < njoints; i++) {
+    q_cmd[i] = m_q_cmd[i];
+    dq_cmd[i] = (m_q_cmd[i] - m_q_cmd_prev[i]) / m_delta_t;
+    m_q_cmd_prev[i] = m_q_cmd[i];
+  }
+}
+
+/*!
+  Compute the joint position and velocity commands to reach the desired
+  joint velocities.
+
+  \param dq_des : Desired velocity of the joints.
+  \param q_cmd : Position command of the joints.
+  \param dq_cmd : Velocity command of the joints.
+
+  The commands are resized to getNbJoints() values if needed, so that no
+  memory is allocated when they have already this size.
+
+  \exception vpException::dimensionError : If the desired velocity has not
+  the number of joints given to init().
+*/
+void vpJointVelTrajGenerator::applyVel(const vpColVector &dq_des, vpColVector &q_cmd, vpColVector &dq_cmd)
+{
+  if (dq_des.size() != getNbJoints()) {
+    throw(vpException(vpException::dimensionError, "Cannot apply a %d-dimension velocity to %d joints",
+                      dq_des.size(), getNbJoints()));
+  }
+  q_cmd.resize(getNbJoints(), false);
+  dq_cmd.resize(getNbJoints(), false);
+  applyVel(dq_des.data, q_cmd.data, dq_cmd.data);
+}
+
+/*!
+  Compute the commands of a sequence of desired joint velocities in a batch,
+  as successive calls to applyVel().
+
+  \param dq_des : Desired velocity of the joints, with a row per period and a
+  column per joint.
+  \param q_cmd : Position command of the joints, with the size of \e dq_des.
+  \param dq_cmd : Velocity command of the joints, with the size of \e dq_des.
+
+  \exception vpException::dimensionError : If the desired velocities have not
+  the number of joints given to init().
+*/
+void vpJointVelTrajGenerator::computeProfile(const vpMatrix &dq_des, vpMatrix &q_cmd, vpMatrix &dq_cmd)
+{
+  if (dq_des.getCols() != getNbJoints()) {
+    throw(vpException(vpException::dimensionError, "Cannot apply %d-dimension velocities to %d joints",
+                      dq_des.getCols(), getNbJoints()));
+  }
+  q_cmd.resize(dq_des.getRows(), getNbJoints(), false);
+  dq_cmd.resize(dq_des.getRows(), getNbJoints(), false);
+  for (unsigned int k = 0; k < dq_des.getRows(); k++) {
+    applyVel(dq_des[k], q_cmd[k], dq_cmd[k]);
+  }
+}
+
+/*!
+  Limit the rate of per joint commands with respect to the maximum allowed
+  time derivatives, the period being the one given to init().
+
+  \param max_derivatives : Maximum allowed time derivative of each joint.
+  \param desired_values : Desired values of the current period.
+  \param last_desired_values : Desired values of the previous period.
+  \param limited_values : Rate-limited desired values.
+*/
+void vpJointVelTrajGenerator::limitRate(const double *max_derivatives, const double *desired_values,
+                                        const double *last_desired_values, double *limited_values) const
+{
+  for (unsigned int i = 0; i < getNbJoints(); i++) {
+    double desired_difference = (desired_values[i] - last_desired_values[i]) / m_delta_t;
+    limited_values[i] = last_desired_values[i] +
+                        std::max(std::min(desired_difference, max_derivatives[i]), -max_derivatives[i]) * m_delta_t;
+  }
+}
@@ -41,6 +41,8 @@
   \brief Implementation of a wire frame simulator.
 */
 
+#include <algorithm>
+#include <cmath>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
@@ -72,6 +74,86 @@
 extern Point2i *point2i;
 extern Point2i *listpoint2i;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Depth of the near clipping plane of the batch rendering
+const double zNear = 1e-3;
+
+inline void convertColor(const vpColor &color, unsigned char &value)
+{
+  value = (unsigned char)(0.2126 * color.R + 0.7152 * color.G + 0.0722 * color.B);
+}
+
+inline void convertColor(const vpColor &color, vpRGBa &value) { value = color; }
+
+// Draws the segment between two points in pixel coordinates, clipped by the
+// borders of the image
+template <class Type>
+void drawLine(vpImage<Type> &I, double u0, double v0, double u1, double v1, const Type &color,
+              unsigned int thickness)
+{
+  // Liang-Barsky clipping
+  double du = u1 - u0, dv = v1 - v0;
+  double p[4] = {-du, du, -dv, dv};
+  double q[4] = {u0 + 0.5, I.getWidth() - 0.5 - u0, v0 + 0.5, I.getHeight() - 0.5 - v0};
+  double t0 = 0., t1 = 1.;
+  for (unsigned int k = 0; k < 4; k++) {
+    if (p[k] == 0.) {
+      if (q[k] < 0.)
+        return;
+    } else {
+      double t = q[k] / p[k];
+      if (p[k] < 0.)
+        t0 = std::max(t0, t);
+      else
+        t1 = std::min(t1, t);
+    }
+  }
+  if (t0 > t1)
+    return;
+
+  double us = u0 + t0 * du, vs = v0 + t0 * dv;
+  double ue = u0 + t1 * du, ve = v0 + t1 * dv;
+  unsigned int n = (unsigned int)std::ceil(std::max(std::fabs(ue - us), std::fabs(ve - vs)));
+  double stepU = n > 0 ? (ue - us) / n : 0., stepV = n > 0 ? (ve - vs) / n : 0.;
+  int width = (int)I.getWidth(), height = (int)I.getHeight();
+  int before = ((int)thickness - 1) / 2, after = (int)thickness / 2;
+  for (unsigned int k = 0; k <= n; k++) {
+    int u = vpMath::round(us + k * stepU), v = vpMath::round(vs + k * stepV);
+    for (int i = std::max(0, v - before); i <= std::min(height - 1, v + after); i++) {
+      for (int j = std::max(0, u - before); j <= std::min(width - 1, u + after); j++) {
+        I[(unsigned int)i][(unsigned int)j] = color;
+      }
+    }
+  }
+}
+
+// Draws the segment between two points in the camera frame, clipped by the
+// near plane
+template <class Type>
+void drawSegment(vpImage<Type> &I, const vpCameraParameters &cam, const double *P0, const double *P1,
+                 const Type &color, unsigned int thickness)
+{
+  double A[3] = {P0[0], P0[1], P0[2]}, B[3] = {P1[0], P1[1], P1[2]};
+  if (A[2] < zNear && B[2] < zNear)
+    return;
+  if (A[2] < zNear || B[2] < zNear) {
+    double *C = A[2] < zNear ? A : B;
+    double t = (zNear - A[2]) / (B[2] - A[2]);
+    for (unsigned int k = 0; k < 3; k++) {
+      C[k] = A[k] + t * (B[k] - A[k]);
+    }
+    C[2] = zNear;
+  }
+  double u0 = 0, v0 = 0, u1 = 0, v1 = 0;
+  vpMeterPixelConversion::convertPoint(cam, A[0] / A[2], A[1] / A[2], u0, v0);
+  vpMeterPixelConversion::convertPoint(cam, B[0] / B[2], B[1] / B[2], u1, v1);
+  drawLine(I, u0, v0, u1, v1, color, thickness);
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*
   Copy the scene corresponding to the registeresd parameters in the image.
 */
@@ -179,7 +261,8 @@ vpWireFrameSimulator::vpWireFrameSimulator()
     fMoList(), nbrPtLimit(1000), old_iPr(), old_iPz(), old_iPt(), blockedr(false), blockedz(false), blockedt(false),
     blocked(false), camMf2(), f2Mf(), px_int(1), py_int(1), px_ext(1), py_ext(1), displayObject(false),
     displayDesiredObject(false), displayCamera(false), displayImageSimulator(false), cameraFactor(1.),
-    camTrajType(CT_LINE), extCamChanged(false), rotz(), thickness_(1), scene_dir()
+    camTrajType(CT_LINE), extCamChanged(false), rotz(), thickness_(1), scene_dir(), sceneVertices(),
+    sceneFaceVertices(), sceneFaceStarts(), cullBackFaces(true), sceneCompiled(false)
 {
   // set scene_dir from #define VISP_SCENE_DIR if it exists
   // VISP_SCENES_DIR may contain multiple locations separated by ";"
@@ -385,6 +468,7 @@ void vpWireFrameSimulator::initScene(const vpSceneObject &obj, const vpSceneDesi
   add_vwstack("start", "type", PERSPECTIVE);
 
   sceneInitialized = true;
+  sceneCompiled = false;
   displayObject = true;
   displayDesiredObject = true;
   displayCamera = true;
@@ -482,6 +566,7 @@ void vpWireFrameSimulator::initScene(const char *obj, const char *desired_object
   add_vwstack("start", "type", PERSPECTIVE);
 
   sceneInitialized = true;
+  sceneCompiled = false;
   displayObject = true;
   displayDesiredObject = true;
   displayCamera = true;
@@ -622,6 +707,7 @@ void vpWireFrameSimulator::initScene(const vpSceneObject &obj)
   add_vwstack("start", "type", PERSPECTIVE);
 
   sceneInitialized = true;
+  sceneCompiled = false;
   displayObject = true;
   displayCamera = true;
 
@@ -700,6 +786,7 @@ void vpWireFrameSimulator::initScene(const char *obj)
   add_vwstack("start", "type", PERSPECTIVE);
 
   sceneInitialized = true;
+  sceneCompiled = false;
   displayObject = true;
   displayCamera = true;
 }
@@ -1061,6 +1148,168 @@ void vpWireFrameSimulator::getInternalImage(vpImage<unsigned char> &I)
   }
 }
 
+/*!
+  Render the views of the main camera at several poses relative to the
+  object into off-screen images, without display.
+
+  The scene is compiled once into flat buffers of vertices and faces, then
+  the views are rendered in parallel when ViSP is built with OpenMP. Each
+  view is rendered as getInternalImage() does, except that the object at the
+  desired position is not drawn: the images projected with vpImageSimulator,
+  then the edges of the faces of the object at the current position that are
+  not culled, drawn in the color set with setCurrentViewColor().
+
+  \param I : The views, resized to the number of poses, each one of size
+  \e height x \e width.
+  \param cMo : The poses of the camera relative to the object.
+  \param cam : The parameters of the camera.
+  \param height, width : The size of the views.
+
+  \sa setCameraPositionRelObj(), getInternalImage()
+*/
+void vpWireFrameSimulator::getInternalImages(std::vector<vpImage<unsigned char> > &I,
+                                             const std::vector<vpHomogeneousMatrix> &cMo,
+                                             const vpCameraParameters &cam, unsigned int height, unsigned int width)
+{
+  renderInternalImages(I, cMo, cam, height, width);
+}
+
+/*!
+  Render the views of the main camera at several poses relative to the
+  object into off-screen color images, without display.
+
+  \param I : The views, resized to the number of poses, each one of size
+  \e height x \e width.
+  \param cMo : The poses of the camera relative to the object.
+  \param cam : The parameters of the camera.
+  \param height, width : The size of the views.
+
+  \sa getInternalImages(std::vector<vpImage<unsigned char> > &, const
+  std::vector<vpHomogeneousMatrix> &, const vpCameraParameters &, unsigned
+  int, unsigned int)
+*/
+void vpWireFrameSimulator::getInternalImages(std::vector<vpImage<vpRGBa> > &I,
+                                             const std::vector<vpHomogeneousMatrix> &cMo,
+                                             const vpCameraParameters &cam, unsigned int height, unsigned int width)
+{
+  renderInternalImages(I, cMo, cam, height, width);
+}
+
+/*!
+  Compile the object at the current position into the flat buffers used by
+  getInternalImages(): the coordinates of the vertices, the indexes of the
+  vertices of the faces and the index of the first vertex of each face.
+*/
+void vpWireFrameSimulator::compileScene()
+{
+  sceneVertices.clear();
+  sceneFaceVertices.clear();
+  sceneFaceStarts.assign(1, 0);
+
+  Bound *bp = scene.bound.ptr;
+  Bound *bend = bp + scene.bound.nbr;
+  for (; bp < bend; bp++) {
+    unsigned int first = (unsigned int)(sceneVertices.size() / 3);
+    for (Index k = 0; k < bp->point.nbr; k++) {
+      sceneVertices.push_back(bp->point.ptr[k].x);
+      sceneVertices.push_back(bp->point.ptr[k].y);
+      sceneVertices.push_back(bp->point.ptr[k].z);
+    }
+    Face *fp = bp->face.ptr;
+    Face *fend = fp + bp->face.nbr;
+    for (; fp < fend; fp++) {
+      for (Index k = 0; k < fp->vertex.nbr; k++) {
+        sceneFaceVertices.push_back(first + fp->vertex.ptr[k]);
+      }
+      sceneFaceStarts.push_back((unsigned int)sceneFaceVertices.size());
+    }
+  }
+  cullBackFaces = (*get_rfstack() & IS_BACK) != 0;
+  sceneCompiled = true;
+}
+
+template <class Type>
+void vpWireFrameSimulator::renderInternalImages(std::vector<vpImage<Type> > &I,
+                                                const std::vector<vpHomogeneousMatrix> &cMo,
+                                                const vpCameraParameters &cam, unsigned int height,
+                                                unsigned int width)
+{
+  if (!sceneInitialized)
+    throw(vpException(vpException::notInitialized, "The scene has to be initialized"));
+  if (!sceneCompiled)
+    compileScene();
+
+  I.resize(cMo.size());
+  Type color;
+  convertColor(curColor, color);
+  unsigned int nbFaces = (unsigned int)sceneFaceStarts.size() - 1;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    // Vertices in the camera frame, and images projected in the view, of
+    // the thread
+    std::vector<double> Xc(sceneVertices.size());
+    std::list<vpImageSimulator> images;
+    if (displayImageSimulator)
+      images = objectImage;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int n = 0; n < (int)cMo.size(); n++) {
+      const vpHomogeneousMatrix &M = cMo[(size_t)n];
+      vpImage<Type> &In = I[(size_t)n];
+      In.resize(height, width);
+      In = Type(255);
+
+      // getInternalImage() projects the images with rotz * cMo, where
+      // setCameraPositionRelObj() stored cMo = rotz * M: as rotz * rotz is
+      // the identity, the images are projected with M
+      for (std::list<vpImageSimulator>::iterator it = images.begin(); it != images.end(); ++it) {
+        it->setCameraPosition(M);
+        it->getImage(In, cam);
+      }
+      if (!displayObject)
+        continue;
+
+      for (size_t k = 0; k < sceneVertices.size(); k += 3) {
+        for (unsigned int r = 0; r < 3; r++) {
+          Xc[k + r] = M[r][0] * sceneVertices[k] + M[r][1] * sceneVertices[k + 1] + M[r][2] * sceneVertices[k + 2] +
+                      M[r][3];
+        }
+      }
+      for (unsigned int f = 0; f < nbFaces; f++) {
+        unsigned int start = sceneFaceStarts[f], end = sceneFaceStarts[f + 1];
+        if (end - start < 2)
+          continue;
+        if (cullBackFaces) {
+          // Orientation of the projection of the face, given by its first,
+          // second and last vertices. The faces of null area, seen edge-on,
+          // are kept.
+          const double *P0 = &Xc[3 * sceneFaceVertices[start]];
+          const double *P1 = &Xc[3 * sceneFaceVertices[start + 1]];
+          const double *P2 = &Xc[3 * sceneFaceVertices[end - 1]];
+          double det = P0[0] * (P1[1] * P2[2] - P1[2] * P2[1]) - P0[1] * (P1[0] * P2[2] - P1[2] * P2[0]) +
+                       P0[2] * (P1[0] * P2[1] - P1[1] * P2[0]);
+          double norm = std::sqrt((P0[0] * P0[0] + P0[1] * P0[1] + P0[2] * P0[2]) *
+                                  (P1[0] * P1[0] + P1[1] * P1[1] + P1[2] * P1[2]) *
+                                  (P2[0] * P2[0] + P2[1] * P2[1] + P2[2] * P2[2]));
+          if (det > 1e-9 * norm)
+            continue;
+        }
+        for (unsigned int k = start + 1; k < end; k++) {
+          drawSegment(In, cam, &Xc[3 * sceneFaceVertices[k - 1]], &Xc[3 * sceneFaceVertices[k]], color, thickness_);
+        }
+        if (end - start > 2)
+          drawSegment(In, cam, &Xc[3 * sceneFaceVertices[end - 1]], &Xc[3 * sceneFaceVertices[start]], color,
+                      thickness_);
+      }
+    }
+  }
+}
+
 /*!
   Get the external view. It corresponds to the view of the scene from a
   reference frame you have to set.
@@ -0,0 +1,359 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the rendering of textured planes by vpImageSimulator.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageSimulator.cpp
+
+  \brief Test the views rendered by vpImageSimulator against the intersection
+  of the rays of the pixels with the textured planes, with and without
+  distortion, and the composition of several planes with a z-buffer.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpImageSimulator.h>
+
+namespace
+{
+const unsigned int height = 480, width = 640;
+
+// Rectangle of 0.6 x 0.4 meter centered on the origin of its frame
+void rectangle(vpColVector *X, double z = 0.)
+{
+  for (unsigned int i = 0; i < 4; i++) {
+    X[i].resize(3);
+    X[i][0] = (i == 0 || i == 3) ? -0.3 : 0.3;
+    X[i][1] = (i < 2) ? -0.2 : 0.2;
+    X[i][2] = z;
+  }
+}
+
+// Coordinates in the texture and depth of the intersection of the ray of a
+// pixel with the rectangle
+class vpRayIntersection
+{
+public:
+  vpRayIntersection(const vpColVector *X, const vpHomogeneousMatrix &cMt) : m_X0(3), m_eu(3), m_ev(3), m_N(3)
+  {
+    vpColVector Xc[4];
+    for (unsigned int k = 0; k < 4; k++) {
+      vpColVector XH(4, 1.);
+      for (unsigned int l = 0; l < 3; l++) {
+        XH[l] = X[k][l];
+      }
+      Xc[k] = (cMt * XH).extract(0, 3);
+    }
+    m_X0 = Xc[0];
+    m_eu = Xc[1] - Xc[0];
+    m_ev = Xc[3] - Xc[0];
+    m_N = vpColVector::crossProd(m_eu, m_ev);
+  }
+
+  bool operator()(const vpCameraParameters &cam, unsigned int i, unsigned int j, double &u, double &v,
+                  double &Z) const
+  {
+    double x = 0, y = 0;
+    vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+    double den = m_N[0] * x + m_N[1] * y + m_N[2];
+    u = v = -1.;
+    if (den == 0.) {
+      return false;
+    }
+    Z = (m_N[0] * m_X0[0] + m_N[1] * m_X0[1] + m_N[2] * m_X0[2]) / den;
+    if (Z <= 0.) {
+      return false;
+    }
+    double d[3] = {x * Z - m_X0[0], y * Z - m_X0[1], Z - m_X0[2]};
+    u = (d[0] * m_eu[0] + d[1] * m_eu[1] + d[2] * m_eu[2]) / m_eu.sumSquare();
+    v = (d[0] * m_ev[0] + d[1] * m_ev[1] + d[2] * m_ev[2]) / m_ev.sumSquare();
+    return u > 0 && v > 0 && u < 1. && v < 1.;
+  }
+
+private:
+  vpColVector m_X0, m_eu, m_ev, m_N;
+};
+
+// Rows and columns of the image where the rectangle can be rendered
+void roi(const vpColVector *X, const vpHomogeneousMatrix &cMt, const vpCameraParameters &cam, unsigned int &top,
+         unsigned int &bottom, unsigned int &left, unsigned int &right)
+{
+  double t = height + 1, b = -1, l = width + 1, r = -1;
+  for (unsigned int k = 0; k < 4; k++) {
+    vpPoint p(X[k][0], X[k][1], X[k][2]);
+    p.track(cMt);
+    double pu = 0, pv = 0;
+    vpMeterPixelConversion::convertPoint(cam, p.get_x(), p.get_y(), pu, pv);
+    t = std::min(t, pv);
+    b = std::max(b, pv);
+    l = std::min(l, pu);
+    r = std::max(r, pu);
+  }
+  top = (unsigned int)std::max(0., std::min(t, height - 1.));
+  bottom = (unsigned int)std::max(0., std::min(b, height - 1.));
+  left = (unsigned int)std::max(0., std::min(l, width - 1.));
+  right = (unsigned int)std::max(0., std::min(r, width - 1.));
+}
+
+// View of the rectangle computed pixel by pixel, with the depth of the pixels
+// where it is rendered and -1 elsewhere
+void reference(const vpImage<unsigned char> &texture, const vpColVector *X, const vpHomogeneousMatrix &cMt,
+               const vpCameraParameters &cam, bool bilinear, vpImage<unsigned char> &I, vpImage<double> &Z)
+{
+  I.resize(height, width, 0);
+  Z.resize(height, width, -1.);
+  unsigned int top, bottom, left, right;
+  roi(X, cMt, cam, top, bottom, left, right);
+  vpRayIntersection intersect(X, cMt);
+  for (unsigned int i = top; i < bottom; i++) {
+    for (unsigned int j = left; j < right; j++) {
+      double u, v, z;
+      if (intersect(cam, i, j, u, v, z)) {
+        double ti = v * (texture.getHeight() - 1), tj = u * (texture.getWidth() - 1);
+        I[i][j] = bilinear ? texture.getValue(ti, tj) : texture[(unsigned int)ti][(unsigned int)tj];
+        Z[i][j] = z;
+      }
+    }
+  }
+}
+
+// Number of pixels of the rendered image that differ from the reference,
+// and number of pixels of the reference showing the rectangle
+void compare(const vpImage<unsigned char> &I, const vpImage<unsigned char> &Iref, unsigned int &nbDifferent,
+             unsigned int &nbRendered)
+{
+  nbDifferent = 0;
+  nbRendered = 0;
+  for (unsigned int i = 0; i < height; i++) {
+    for (unsigned int j = 0; j < width; j++) {
+      if (I[i][j] != Iref[i][j]) {
+        nbDifferent++;
+      }
+      if (Iref[i][j] != 0) {
+        nbRendered++;
+      }
+    }
+  }
+}
+
+// The texture values are never 0, the color of the background
+void texture(vpImage<unsigned char> &I, vpImage<vpRGBa> &Ic)
+{
+  I.resize(60, 80);
+  Ic.resize(60, 80);
+  srand(7);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      I[i][j] = (unsigned char)(1 + rand() % 255);
+      Ic[i][j] = vpRGBa(I[i][j], I[i][j], I[i][j]);
+    }
+  }
+}
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> Itexture;
+    vpImage<vpRGBa> Ictexture;
+    texture(Itexture, Ictexture);
+    vpColVector X[4];
+    rectangle(X);
+
+    vpCameraParameters cams[2];
+    cams[0].initPersProjWithoutDistortion(600, 610, 320, 240);
+    cams[1].initPersProjWithDistortion(600, 610, 320, 240, -0.2, 0.2);
+    vpHomogeneousMatrix poses[3];
+    poses[0].buildFrom(0.05, -0.02, 1.0, vpMath::rad(20), vpMath::rad(-30), vpMath::rad(10));
+    poses[1].buildFrom(0.1, 0.05, 0.6, vpMath::rad(-10), vpMath::rad(15), vpMath::rad(80));
+    poses[2].buildFrom(-0.2, 0.1, 0.3, vpMath::rad(5), vpMath::rad(-5), vpMath::rad(-30));
+
+    // Views of a gray level and a colored texture against the reference
+    for (unsigned int c = 0; c < 2; c++) {
+      for (unsigned int p = 0; p < 3; p++) {
+        for (unsigned int bilinear = 0; bilinear < 2; bilinear++) {
+          vpImageSimulator sim(vpImageSimulator::GRAY_SCALED), simc(vpImageSimulator::COLORED);
+          sim.init(Itexture, X);
+          simc.init(Ictexture, X);
+          vpImageSimulator::vpInterpolationType interp =
+              bilinear ? vpImageSimulator::BILINEAR_INTERPOLATION : vpImageSimulator::SIMPLE;
+          sim.setInterpolationType(interp);
+          simc.setInterpolationType(interp);
+          sim.setCleanPreviousImage(true, vpColor::black);
+          simc.setCleanPreviousImage(true, vpColor::black);
+          sim.setCameraPosition(poses[p]);
+          simc.setCameraPosition(poses[p]);
+
+          vpImage<unsigned char> I(height, width), Iref;
+          vpImage<vpRGBa> Ic(height, width);
+          vpImage<double> Zref;
+          double t = vpTime::measureTimeMs();
+          sim.getImage(I, cams[c]);
+          t = vpTime::measureTimeMs() - t;
+          double tref = vpTime::measureTimeMs();
+          reference(Itexture, X, poses[p], cams[c], bilinear != 0, Iref, Zref);
+          tref = vpTime::measureTimeMs() - tref;
+          simc.getImage(Ic, cams[c]);
+
+          unsigned int nbDifferent, nbRendered;
+          compare(I, Iref, nbDifferent, nbRendered);
+          std::cout << "Camera " << c << ", pose " << p << (bilinear ? ", bilinear" : "") << ": " << nbRendered
+                    << " pixels rendered in " << t << " ms (" << tref << " ms for the reference), " << nbDifferent
+                    << " different pixels" << std::endl;
+          if (nbRendered < 10000 || nbDifferent > nbRendered / 1000) {
+            std::cerr << "Bad view of the gray level texture" << std::endl;
+            return EXIT_FAILURE;
+          }
+          vpImage<unsigned char> Ig(height, width);
+          for (unsigned int i = 0; i < height; i++) {
+            for (unsigned int j = 0; j < width; j++) {
+              Ig[i][j] = Ic[i][j].R;
+            }
+          }
+          compare(Ig, Iref, nbDifferent, nbRendered);
+          if (nbDifferent > nbRendered / 1000) {
+            std::cerr << "Bad view of the colored texture" << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // Plane crossing the image plane of the camera, only in front of it
+    {
+      vpHomogeneousMatrix cMt(0., 0., 0.1, vpMath::rad(70), 0., 0.);
+      vpImageSimulator sim(vpImageSimulator::GRAY_SCALED);
+      sim.init(Itexture, X);
+      sim.setCleanPreviousImage(true, vpColor::black);
+      sim.setCameraPosition(cMt);
+      vpImage<unsigned char> I(height, width);
+      sim.getImage(I, cams[0]);
+      vpRayIntersection intersect(X, cMt);
+      unsigned int nbRendered = 0;
+      for (unsigned int i = 0; i < height; i++) {
+        for (unsigned int j = 0; j < width; j++) {
+          double u, v, z;
+          bool inside = intersect(cams[0], i, j, u, v, z);
+          if (I[i][j] != 0) {
+            nbRendered++;
+            if (!inside && std::min(std::min(u, 1. - u), std::min(v, 1. - v)) < -1e-6) {
+              std::cerr << "Pixel (" << i << ", " << j << ") rendered outside the plane" << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+      std::cout << "Clipped plane: " << nbRendered << " pixels rendered" << std::endl;
+      if (nbRendered < 10000) {
+        std::cerr << "Bad view of the clipped plane" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Composition of a plane hidden by another one, after a plane that is
+    // not visible: the z-buffer of floats gives the same view as the
+    // z-buffer of doubles and as the list of planes
+    {
+      vpColVector Xfront[4];
+      rectangle(Xfront, -0.2);
+      std::list<vpImageSimulator> list;
+      vpImageSimulator back(vpImageSimulator::GRAY_SCALED), front(vpImageSimulator::GRAY_SCALED),
+          hidden(vpImageSimulator::GRAY_SCALED);
+      hidden.init(Itexture, X);
+      hidden.setCameraPosition(vpHomogeneousMatrix(0., 0., 1., M_PI, 0., 0.));
+      back.init(Itexture, X);
+      back.setCameraPosition(poses[0]);
+      front.init(Itexture, Xfront);
+      front.setCameraPosition(poses[0] * vpHomogeneousMatrix(0.2, 0.1, 0., 0., 0., 0.));
+      list.push_back(hidden);
+      list.push_back(back);
+      list.push_back(front);
+
+      vpImage<unsigned char> Ilist(height, width, 0), Ifloat(height, width, 0), Idouble(height, width, 0);
+      double t = vpTime::measureTimeMs();
+      vpImageSimulator::getImage(Ilist, list, cams[0]);
+      t = vpTime::measureTimeMs() - t;
+      vpImage<float> zFloat(height, width, -1.f);
+      vpMatrix zDouble(height, width);
+      zDouble = -1.;
+      back.getImage(Ifloat, cams[0], zFloat);
+      front.getImage(Ifloat, cams[0], zFloat);
+      back.getImage(Idouble, cams[0], zDouble);
+      front.getImage(Idouble, cams[0], zDouble);
+      std::cout << "Composition of 3 planes in " << t << " ms" << std::endl;
+
+      vpImage<unsigned char> Iback, Ifront;
+      vpImage<double> Zback, Zfront;
+      reference(Itexture, X, poses[0], cams[0], false, Iback, Zback);
+      reference(Itexture, Xfront, poses[0] * vpHomogeneousMatrix(0.2, 0.1, 0., 0., 0., 0.), cams[0], false, Ifront,
+                Zfront);
+      unsigned int nbHidden = 0;
+      for (unsigned int i = 0; i < height; i++) {
+        for (unsigned int j = 0; j < width; j++) {
+          if (Ilist[i][j] != Ifloat[i][j] || Idouble[i][j] != Ifloat[i][j]) {
+            std::cerr << "Different compositions at pixel (" << i << ", " << j << ")" << std::endl;
+            return EXIT_FAILURE;
+          }
+          double zref = Zfront[i][j] > 0 ? Zfront[i][j] : Zback[i][j];
+          if (zref > 0 && (std::fabs(zFloat[i][j] - zref) > 1e-5 * zref || std::fabs(zDouble[i][j] - zref) > 1e-9)) {
+            std::cerr << "Bad depth at pixel (" << i << ", " << j << ")" << std::endl;
+            return EXIT_FAILURE;
+          }
+          if (Zfront[i][j] > 0 && Zback[i][j] > 0) {
+            nbHidden++;
+          }
+        }
+      }
+      if (nbHidden < 1000) {
+        std::cerr << "The front plane does not hide the back plane" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testImageSimulator is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
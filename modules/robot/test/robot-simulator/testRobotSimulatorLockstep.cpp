@@ -0,0 +1,226 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the lockstep mode of the robot simulators.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRobotSimulatorLockstep.cpp
+
+  \brief Test that the robot simulators in lockstep mode integrate the
+  velocities with the sampling time at each step, and give the same
+  trajectories from one run to another.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpRobotException.h>
+#include <visp3/robot/vpSimulatorAfma6.h>
+#include <visp3/robot/vpSimulatorViper850.h>
+
+#if defined(VISP_HAVE_MODULE_GUI) && ((defined(_WIN32) && !defined(WINRT_8_0)) || defined(VISP_HAVE_PTHREAD))
+
+namespace
+{
+const unsigned int nbSteps = 500;
+const double samplingTime = 0.01;
+
+// Joint servo of a Viper 850 toward qd, with the joint positions of all the
+// steps
+void servoViper850(const vpColVector &q0, const vpColVector &qd, std::vector<vpColVector> &trajectory,
+                   double &simulationTime)
+{
+  vpSimulatorViper850 robot(false);
+  robot.setLockstepMode(true);
+  robot.setSamplingTime(samplingTime);
+  robot.setRobotState(vpRobot::STATE_POSITION_CONTROL);
+  robot.setPosition(vpRobot::ARTICULAR_FRAME, q0);
+  double t0 = robot.getSimulationTime();
+
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+  trajectory.clear();
+  vpColVector q;
+  for (unsigned int i = 0; i < nbSteps; i++) {
+    double timestamp;
+    robot.getPosition(vpRobot::ARTICULAR_FRAME, q, timestamp);
+    if (timestamp != robot.getSimulationTime()) {
+      throw vpException(vpException::fatalError, "Bad timestamp %f instead of %f", timestamp,
+                        robot.getSimulationTime());
+    }
+    trajectory.push_back(q);
+    robot.setVelocity(vpRobot::ARTICULAR_FRAME, -0.5 * (q - qd));
+    robot.step();
+  }
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+  trajectory.push_back(q);
+  simulationTime = robot.getSimulationTime() - t0;
+}
+
+// Camera velocity servo of an Afma6, with the camera poses of all the steps
+void servoAfma6(std::vector<vpColVector> &trajectory)
+{
+  vpSimulatorAfma6 robot(false);
+  robot.setLockstepMode(true);
+  robot.setSamplingTime(samplingTime);
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+  trajectory.clear();
+  vpColVector v(6);
+  for (unsigned int i = 0; i < nbSteps; i++) {
+    vpPoseVector r;
+    robot.getPosition(vpRobot::REFERENCE_FRAME, r);
+    trajectory.push_back(r);
+    v[0] = 0.05 * cos(0.01 * i);
+    v[1] = 0.05 * sin(0.01 * i);
+    v[5] = 0.1;
+    robot.setVelocity(vpRobot::CAMERA_FRAME, v);
+    robot.step();
+  }
+}
+
+bool equal(const std::vector<vpColVector> &a, const std::vector<vpColVector> &b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].size() != b[i].size()) {
+      return false;
+    }
+    for (unsigned int j = 0; j < a[i].size(); j++) {
+      if (a[i][j] != b[i][j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpColVector q0(6), qd(6);
+    q0[0] = 0.1;
+    q0[1] = -1.2;
+    q0[2] = 2.5;
+    q0[3] = 0.2;
+    q0[4] = 1.2;
+    q0[5] = 0.1;
+    for (unsigned int j = 0; j < 6; j++) {
+      qd[j] = q0[j] + 0.2;
+    }
+
+    // The steps of the joint servo follow the Euler integration of the
+    // velocities with the sampling time
+    std::vector<vpColVector> trajectory[2];
+    double simulationTime;
+    double t = vpTime::measureTimeMs();
+    servoViper850(q0, qd, trajectory[0], simulationTime);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Viper 850: " << nbSteps << " steps of " << simulationTime / nbSteps << " s simulated in " << t
+              << " ms" << std::endl;
+    if (std::fabs(simulationTime - nbSteps * samplingTime) > 1e-9) {
+      std::cerr << "Bad simulation time " << simulationTime << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i <= nbSteps; i++) {
+      double ratio = pow(1. - 0.5 * samplingTime, (double)i);
+      for (unsigned int j = 0; j < 6; j++) {
+        double qref = qd[j] + ratio * (q0[j] - qd[j]);
+        if (std::fabs(trajectory[0][i][j] - qref) > 1e-9) {
+          std::cerr << "Bad joint " << j << " position at step " << i << ": " << trajectory[0][i][j]
+                    << " instead of " << qref << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // The trajectories are the same from one run to another
+    servoViper850(q0, qd, trajectory[1], simulationTime);
+    if (!equal(trajectory[0], trajectory[1])) {
+      std::cerr << "Different Viper 850 trajectories" << std::endl;
+      return EXIT_FAILURE;
+    }
+    t = vpTime::measureTimeMs();
+    servoAfma6(trajectory[0]);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Afma6: " << nbSteps << " steps simulated in " << t << " ms" << std::endl;
+    servoAfma6(trajectory[1]);
+    if (!equal(trajectory[0], trajectory[1])) {
+      std::cerr << "Different Afma6 trajectories" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The robot moves with its thread when the lockstep mode is disabled,
+    // where step() is not allowed
+    vpSimulatorViper850 robot(false);
+    robot.setLockstepMode(true);
+    robot.setLockstepMode(false);
+    robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+    vpColVector q, qvel(6);
+    robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+    qvel[0] = 0.1;
+    robot.setVelocity(vpRobot::ARTICULAR_FRAME, qvel);
+    vpTime::wait(200);
+    robot.getPosition(vpRobot::ARTICULAR_FRAME, q0);
+    if (q0[0] - q[0] < 0.005) {
+      std::cerr << "The robot does not move without the lockstep mode" << std::endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      robot.step();
+      std::cerr << "step() is allowed without the lockstep mode" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const vpRobotException &) {
+    }
+
+    std::cout << "testRobotSimulatorLockstep is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "The robot simulators are not available: they need the gui module and threads." << std::endl;
+  return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,287 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the batch rendering of the internal view of the wire frame simulator.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testWireFrameSimulator.cpp
+
+  \brief Test the views rendered without display by
+  vpWireFrameSimulator::getInternalImages() against the projection of the
+  edges of the front faces of the object, and against the views rendered one
+  by one.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpWireFrameSimulator.h>
+
+namespace
+{
+// Wire frame simulator giving the edges of the front faces of the object
+class vpWireFrameSimulatorEdges : public vpWireFrameSimulator
+{
+public:
+  void getFrontEdges(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam, std::vector<vpImagePoint> &edges)
+  {
+    edges.clear();
+    for (Index b = 0; b < scene.bound.nbr; b++) {
+      const Bound &bound = scene.bound.ptr[b];
+      std::vector<vpImagePoint> ip(bound.point.nbr);
+      for (Index k = 0; k < bound.point.nbr; k++) {
+        vpPoint P(bound.point.ptr[k].x, bound.point.ptr[k].y, bound.point.ptr[k].z);
+        P.track(cMo);
+        vpMeterPixelConversion::convertPoint(cam, P.get_x(), P.get_y(), ip[k]);
+      }
+      for (Index f = 0; f < bound.face.nbr; f++) {
+        const Face &face = bound.face.ptr[f];
+        // Signed area of the projection of the face
+        double area = 0.;
+        for (Index k = 0; k < face.vertex.nbr; k++) {
+          const vpImagePoint &p0 = ip[face.vertex.ptr[k]];
+          const vpImagePoint &p1 = ip[face.vertex.ptr[(k + 1) % face.vertex.nbr]];
+          area += p0.get_u() * p1.get_v() - p1.get_u() * p0.get_v();
+        }
+        if (area > 0.) {
+          continue;
+        }
+        for (Index k = 0; k < face.vertex.nbr; k++) {
+          edges.push_back(ip[face.vertex.ptr[k]]);
+          edges.push_back(ip[face.vertex.ptr[(k + 1) % face.vertex.nbr]]);
+        }
+      }
+    }
+  }
+};
+
+double distance(const vpImagePoint &a, const vpImagePoint &b, double u, double v)
+{
+  double du = b.get_u() - a.get_u(), dv = b.get_v() - a.get_v();
+  double t = du * du + dv * dv > 0. ? ((u - a.get_u()) * du + (v - a.get_v()) * dv) / (du * du + dv * dv) : 0.;
+  t = std::max(0., std::min(1., t));
+  return sqrt(vpMath::sqr(a.get_u() + t * du - u) + vpMath::sqr(a.get_v() + t * dv - v));
+}
+
+// Check that the drawn pixels are on the edges, and the edges drawn in the
+// image
+bool checkEdges(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &edges)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      if (I[i][j] == 255) {
+        continue;
+      }
+      double d = 1e9;
+      for (size_t e = 0; e < edges.size(); e += 2) {
+        d = std::min(d, distance(edges[e], edges[e + 1], j, i));
+      }
+      if (d > 1.) {
+        std::cerr << "Pixel (" << i << ", " << j << ") drawn at " << d << " pixel from the edges" << std::endl;
+        return false;
+      }
+    }
+  }
+  for (size_t e = 0; e < edges.size(); e += 2) {
+    for (unsigned int s = 0; s <= 10; s++) {
+      double u = edges[e].get_u() + s * (edges[e + 1].get_u() - edges[e].get_u()) / 10.;
+      double v = edges[e].get_v() + s * (edges[e + 1].get_v() - edges[e].get_v()) / 10.;
+      if (u < 0. || v < 0. || u > I.getWidth() - 1. || v > I.getHeight() - 1.) {
+        continue;
+      }
+      bool drawn = false;
+      for (int i = vpMath::round(v) - 1; i <= vpMath::round(v) + 1; i++) {
+        for (int j = vpMath::round(u) - 1; j <= vpMath::round(u) + 1; j++) {
+          drawn = drawn || (i >= 0 && j >= 0 && i < (int)I.getHeight() && j < (int)I.getWidth() &&
+                            I[(unsigned int)i][(unsigned int)j] != 255);
+        }
+      }
+      if (!drawn) {
+        std::cerr << "Edge not drawn at (" << u << ", " << v << ")" << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <class Type> bool equal(std::vector<vpImage<Type> > &I1, std::vector<vpImage<Type> > &I2)
+{
+  if (I1.size() != I2.size()) {
+    return false;
+  }
+  for (size_t n = 0; n < I1.size(); n++) {
+    if (!(I1[n] == I2[n])) {
+      std::cerr << "Different view " << n << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Render the views in a batch, then one by one
+template <class Type>
+bool checkBatch(vpWireFrameSimulator &sim, const std::vector<vpHomogeneousMatrix> &cMo, const vpCameraParameters &cam,
+                const std::string &name)
+{
+  std::vector<vpImage<Type> > I, Iserial(cMo.size());
+  double t = vpTime::measureTimeMs();
+  sim.getInternalImages(I, cMo, cam, 480, 640);
+  t = vpTime::measureTimeMs() - t;
+  double tSerial = vpTime::measureTimeMs();
+  for (size_t n = 0; n < cMo.size(); n++) {
+    std::vector<vpImage<Type> > In;
+    sim.getInternalImages(In, std::vector<vpHomogeneousMatrix>(1, cMo[n]), cam, 480, 640);
+    Iserial[n] = In[0];
+  }
+  tSerial = vpTime::measureTimeMs() - tSerial;
+  std::cout << name << ": " << cMo.size() << " views in " << t << " ms in a batch, " << tSerial
+            << " ms one by one" << std::endl;
+  return equal(I, Iserial);
+}
+}
+
+int main()
+{
+  try {
+    vpCameraParameters cam(600, 610, 320, 240);
+    vpWireFrameSimulatorEdges sim;
+
+    bool thrown = false;
+    try {
+      std::vector<vpImage<unsigned char> > I;
+      sim.getInternalImages(I, std::vector<vpHomogeneousMatrix>(1), cam, 480, 640);
+    } catch (vpException &e) {
+      thrown = e.getCode() == vpException::notInitialized;
+    }
+    if (!thrown) {
+      std::cerr << "No exception when the scene is not initialized" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Poses looking at the object
+    std::vector<vpHomogeneousMatrix> cMo;
+    for (unsigned int n = 0; n < 64; n++) {
+      cMo.push_back(vpHomogeneousMatrix(0.01 * (n % 5) - 0.02, 0.01 * (n % 3) - 0.01, 0.5 + 0.01 * n,
+                                        vpMath::rad(5. * n), vpMath::rad(30. - 7. * (n % 9)),
+                                        vpMath::rad(11. * n)));
+    }
+
+    // Edges of the front faces of a cube and of a plate
+    vpWireFrameSimulator::vpSceneObject objects[2] = {vpWireFrameSimulator::CUBE, vpWireFrameSimulator::PLATE};
+    for (unsigned int o = 0; o < 2; o++) {
+      sim.initScene(objects[o]);
+      std::vector<vpImage<unsigned char> > I;
+      sim.getInternalImages(I, cMo, cam, 480, 640);
+      for (size_t n = 0; n < cMo.size(); n++) {
+        std::vector<vpImagePoint> edges;
+        sim.getFrontEdges(cMo[n], cam, edges);
+        if (!checkEdges(I[n], edges)) {
+          std::cerr << "Bad view " << n << " of object " << o << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Views crossing the plane of the camera
+    cMo.push_back(vpHomogeneousMatrix(0., 0., 0.05, vpMath::rad(80), 0., 0.));
+    cMo.push_back(vpHomogeneousMatrix(0., 0., -0.5, 0., 0., 0.));
+
+    // The batch gives the views rendered one by one, with thick lines and
+    // projected images
+    sim.initScene(vpWireFrameSimulator::CYLINDER);
+    sim.setGraphicsThickness(3);
+    sim.setCurrentViewColor(vpColor::darkRed);
+    if (!checkBatch<unsigned char>(sim, cMo, cam, "Cylinder") || !checkBatch<vpRGBa>(sim, cMo, cam, "Cylinder")) {
+      return EXIT_FAILURE;
+    }
+
+    // Checkerboard whose dark squares get lighter along the rows and the
+    // columns, so that the texture has no symmetry
+    vpImage<unsigned char> texture(200, 200);
+    for (unsigned int i = 0; i < texture.getHeight(); i++) {
+      for (unsigned int j = 0; j < texture.getWidth(); j++) {
+        texture[i][j] = (unsigned char)((i / 20 + j / 20) % 2 ? 20 + 15 * (i / 20) + 5 * (j / 20) : 240);
+      }
+    }
+    std::vector<vpPoint> corners;
+    corners.push_back(vpPoint(-0.1, -0.1, 0.));
+    corners.push_back(vpPoint(0.1, -0.1, 0.));
+    corners.push_back(vpPoint(0.1, 0.1, 0.));
+    corners.push_back(vpPoint(-0.1, 0.1, 0.));
+    vpImageSimulator imageSim;
+    imageSim.init(texture, corners);
+    std::list<vpImageSimulator> images(1, imageSim);
+    sim.initScene(vpWireFrameSimulator::PLATE, images);
+    if (!checkBatch<unsigned char>(sim, cMo, cam, "Plate with an image") ||
+        !checkBatch<vpRGBa>(sim, cMo, cam, "Plate with an image")) {
+      return EXIT_FAILURE;
+    }
+
+    // The projected image is below the wire frame, with the same pose as in
+    // getInternalImage()
+    std::vector<vpImage<vpRGBa> > I;
+    sim.getInternalImages(I, std::vector<vpHomogeneousMatrix>(1, cMo[0]), cam, 480, 640);
+    vpImage<vpRGBa> Iimage(480, 640);
+    sim.setInternalCameraParameters(cam);
+    sim.setCameraPositionRelObj(cMo[0]);
+    sim.getInternalImage(Iimage);
+    unsigned int nbImage = 0;
+    for (unsigned int i = 0; i < 480; i++) {
+      for (unsigned int j = 0; j < 640; j++) {
+        if (I[0][i][j] == Iimage[i][j]) {
+          nbImage++;
+        }
+      }
+    }
+    if (nbImage < 0.95 * 480 * 640) {
+      std::cerr << "The projected image is not rendered" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testWireFrameSimulator is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
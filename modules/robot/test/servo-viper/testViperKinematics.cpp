@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the batch kinematics of the Viper robots.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testViperKinematics.cpp
+
+  \brief Test the forward kinematics and the jacobians of vpViper computed
+  for a batch of joint configurations against the ones computed one by one,
+  and compare their computation times.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpViper850.h>
+
+namespace
+{
+bool check(const std::vector<double> &batch, unsigned int n, unsigned int i, const vpArray2D<double> &M,
+           unsigned int rows, const std::string &name)
+{
+  for (unsigned int r = 0; r < rows; r++) {
+    for (unsigned int c = 0; c < M.getCols(); c++) {
+      double value = batch[(r * M.getCols() + c) * n + i];
+      if (std::fabs(value - M[r][c]) > 1e-12) {
+        std::cerr << "Bad " << name << "[" << r << "][" << c << "] of configuration " << i << ": " << value
+                  << " instead of " << M[r][c] << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpViper850 robot;
+    robot.set_eMc(vpTranslationVector(0.01, -0.02, 0.1), vpRxyzVector(0.1, -0.2, 0.3));
+
+    // Random joint configurations in structure of arrays layout
+    const unsigned int n = 20000;
+    vpColVector qmin = robot.getJointMin(), qmax = robot.getJointMax();
+    std::vector<double> q(6 * n);
+    srand(42);
+    for (unsigned int j = 0; j < 6; j++) {
+      for (unsigned int i = 0; i < n; i++) {
+        q[j * n + i] = qmin[j] + (qmax[j] - qmin[j]) * (rand() % 10000) / 10000.;
+      }
+    }
+
+    std::vector<double> fMe(12 * n), fMc(12 * n), fJe(36 * n), eJe(36 * n);
+    double t[4];
+    t[0] = vpTime::measureTimeMs();
+    robot.get_fMe(n, &q[0], &fMe[0]);
+    t[1] = vpTime::measureTimeMs();
+    robot.get_fMc(n, &q[0], &fMc[0]);
+    t[2] = vpTime::measureTimeMs();
+    robot.get_fJe(n, &q[0], &fJe[0]);
+    t[3] = vpTime::measureTimeMs();
+    robot.get_eJe(n, &q[0], &eJe[0]);
+    double tBatch[4] = {t[1] - t[0], t[2] - t[1], t[3] - t[2], vpTime::measureTimeMs() - t[3]};
+
+    // Same model computed one by one
+    std::vector<vpColVector> qi(n, vpColVector(6));
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j < 6; j++) {
+        qi[i][j] = q[j * n + i];
+      }
+    }
+    vpHomogeneousMatrix M;
+    vpMatrix J;
+    double tSingle[4];
+    t[0] = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < n; i++) {
+      robot.get_fMe(qi[i], M);
+    }
+    t[1] = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < n; i++) {
+      robot.get_fMc(qi[i], M);
+    }
+    t[2] = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < n; i++) {
+      robot.get_fJe(qi[i], J);
+    }
+    t[3] = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < n; i++) {
+      robot.get_eJe(qi[i], J);
+    }
+    tSingle[0] = t[1] - t[0];
+    tSingle[1] = t[2] - t[1];
+    tSingle[2] = t[3] - t[2];
+    tSingle[3] = vpTime::measureTimeMs() - t[3];
+
+    for (unsigned int i = 0; i < n; i++) {
+      robot.get_fMe(qi[i], M);
+      if (!check(fMe, n, i, M, 3, "fMe")) {
+        return EXIT_FAILURE;
+      }
+      robot.get_fMc(qi[i], M);
+      if (!check(fMc, n, i, M, 3, "fMc")) {
+        return EXIT_FAILURE;
+      }
+      robot.get_fJe(qi[i], J);
+      if (!check(fJe, n, i, J, 6, "fJe")) {
+        return EXIT_FAILURE;
+      }
+      robot.get_eJe(qi[i], J);
+      if (!check(eJe, n, i, J, 6, "eJe")) {
+        return EXIT_FAILURE;
+      }
+    }
+
+    const char *names[4] = {"fMe", "fMc", "fJe", "eJe"};
+    for (unsigned int k = 0; k < 4; k++) {
+      std::cout << names[k] << " of " << n << " configurations: " << tBatch[k] << " ms in a batch, " << tSingle[k]
+                << " ms one by one" << std::endl;
+    }
+
+    std::cout << "testViperKinematics is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,393 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the joint trajectory generators.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testJointTrajGenerator.cpp
+
+  \brief Test the joint positioning trajectories of vpJointPosTrajGenerator
+  and the joint commands of vpJointVelTrajGenerator against their velocity,
+  acceleration and joint limits, compare the profiles computed in a batch to
+  the ones computed period by period, and measure the worst-case computation
+  time of a period.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpJointPosTrajGenerator.h>
+#include <visp3/robot/vpJointVelTrajGenerator.h>
+
+namespace
+{
+const unsigned int njoints = 7;
+const double delta_t = 0.001;
+
+// Position of a joint along the synchronized profile, computed as in libfranka
+double referencePosition(double t, double q_start, double delta_q, double ddq_max_start, double ddq_max_goal,
+                         double max_t_f)
+{
+  if (std::fabs(delta_q) < 1e-6) {
+    return q_start;
+  }
+  double a = 1.5 / 2.0 * (ddq_max_goal + ddq_max_start);
+  double b = -1.0 * max_t_f * ddq_max_goal * ddq_max_start;
+  double c = std::fabs(delta_q) * ddq_max_goal * ddq_max_start;
+  double dq_max_sync = (-1.0 * b - sqrt(std::max(0., b * b - 4.0 * a * c))) / (2.0 * a);
+  double t_1_sync = 1.5 * dq_max_sync / ddq_max_start;
+  double delta_t_2_sync = 1.5 * dq_max_sync / ddq_max_goal;
+  double t_f_sync = t_1_sync / 2.0 + delta_t_2_sync / 2.0 + std::fabs(delta_q / dq_max_sync);
+  double t_2_sync = t_f_sync - delta_t_2_sync;
+  double t_d = t_2_sync - t_1_sync;
+  double q_1 = dq_max_sync * vpMath::sign(delta_q) * (0.5 * t_1_sync);
+  double sign = vpMath::sign(delta_q);
+
+  if (t < t_1_sync) {
+    return q_start - 1.0 / pow(t_1_sync, 3.0) * dq_max_sync * sign * (0.5 * t - t_1_sync) * pow(t, 3.0);
+  } else if (t < t_2_sync) {
+    return q_start + q_1 + (t - t_1_sync) * dq_max_sync * sign;
+  } else if (t < t_f_sync) {
+    return q_start + delta_q +
+           0.5 *
+               (1.0 / pow(delta_t_2_sync, 3.0) * (t - t_1_sync - 2.0 * delta_t_2_sync - t_d) *
+                    pow((t - t_1_sync - t_d), 3.0) +
+                (2.0 * t - 2.0 * t_1_sync - delta_t_2_sync - 2.0 * t_d)) *
+               dq_max_sync * sign;
+  }
+  return q_start + delta_q;
+}
+
+// Duration of the motion of the slowest joint, computed as in libfranka
+double referenceDuration(const vpColVector &delta_q, const vpColVector &dq_max, const vpColVector &ddq_max_start,
+                         const vpColVector &ddq_max_goal)
+{
+  double max_t_f = 0.;
+  for (unsigned int i = 0; i < delta_q.size(); i++) {
+    if (std::fabs(delta_q[i]) > 1e-6) {
+      double dq_max_reach = dq_max[i];
+      if (std::fabs(delta_q[i]) < 3.0 / 4.0 * (pow(dq_max[i], 2.0) / ddq_max_start[i]) +
+                                      3.0 / 4.0 * (pow(dq_max[i], 2.0) / ddq_max_goal[i])) {
+        dq_max_reach = sqrt(4.0 / 3.0 * std::fabs(delta_q[i]) * (ddq_max_start[i] * ddq_max_goal[i]) /
+                            (ddq_max_start[i] + ddq_max_goal[i]));
+      }
+      double t_1 = 1.5 * dq_max_reach / ddq_max_start[i];
+      double delta_t_2 = 1.5 * dq_max_reach / ddq_max_goal[i];
+      max_t_f = std::max(max_t_f, t_1 / 2.0 + delta_t_2 / 2.0 + std::fabs(delta_q[i]) / dq_max_reach);
+    }
+  }
+  return max_t_f;
+}
+
+bool testPosition()
+{
+  vpColVector dq_max(njoints), ddq_max_start(njoints), ddq_max_goal(njoints), q_start(njoints), q_goal(njoints);
+  for (unsigned int i = 0; i < njoints; i++) {
+    dq_max[i] = 2. + 0.1 * i;
+    ddq_max_start[i] = 5. - 0.2 * i;
+    ddq_max_goal[i] = 4. + 0.3 * i;
+    q_start[i] = -0.5 + 0.2 * i;
+  }
+  // Short and long motions in both directions, and a joint that does not
+  // move
+  q_goal[0] = q_start[0] + 1.2;
+  q_goal[1] = q_start[1] - 0.8;
+  q_goal[2] = q_start[2] + 0.05;
+  q_goal[3] = q_start[3];
+  q_goal[4] = q_start[4] - 2.5;
+  q_goal[5] = q_start[5] + 0.3;
+  q_goal[6] = q_start[6] - 0.001;
+
+  const double speed_factor = 0.5;
+  vpJointPosTrajGenerator generator;
+  generator.init(dq_max, ddq_max_start, ddq_max_goal, speed_factor);
+  generator.setGoal(q_start, q_goal);
+
+  double max_t_f = referenceDuration(q_goal - q_start, dq_max * speed_factor, ddq_max_start * speed_factor,
+                                     ddq_max_goal * speed_factor);
+  if (std::fabs(generator.getDuration() - max_t_f) > 1e-9) {
+    std::cerr << "Bad duration " << generator.getDuration() << " instead of " << max_t_f << std::endl;
+    return false;
+  }
+
+  vpColVector q(njoints), q_prev(q_start);
+  bool finished = false;
+  unsigned int k = 0;
+  for (; !finished; k++) {
+    double t = k * delta_t;
+    finished = generator.computePosition(t, q);
+    if (finished != (t >= generator.getDuration())) {
+      std::cerr << "Bad end of motion at time " << t << std::endl;
+      return false;
+    }
+    for (unsigned int i = 0; i < njoints; i++) {
+      double q_ref = referencePosition(t, q_start[i], q_goal[i] - q_start[i], ddq_max_start[i] * speed_factor,
+                                       ddq_max_goal[i] * speed_factor, max_t_f);
+      if (std::fabs(q[i] - q_ref) > 1e-9) {
+        std::cerr << "Bad position " << q[i] << " of joint " << i << " at time " << t << " instead of " << q_ref
+                  << std::endl;
+        return false;
+      }
+      double dq = (q[i] - q_prev[i]) / delta_t;
+      if (std::fabs(dq) > dq_max[i] * speed_factor * (1. + 1e-6)) {
+        std::cerr << "Velocity " << dq << " of joint " << i << " at time " << t << " over the limit" << std::endl;
+        return false;
+      }
+      // The joints are synchronized and reach their goal at the end
+      if (!finished && t < 0.9 * max_t_f && std::fabs(q_goal[i] - q_start[i]) > 1e-6 &&
+          std::fabs(q[i] - q_goal[i]) < 1e-3 * std::fabs(q_goal[i] - q_start[i])) {
+        std::cerr << "Joint " << i << " reached its goal before the others" << std::endl;
+        return false;
+      }
+    }
+    q_prev = q;
+  }
+  if ((q - q_goal).euclideanNorm() > 1e-12) {
+    std::cerr << "Goal not reached: " << (q - q_goal).euclideanNorm() << std::endl;
+    return false;
+  }
+
+  // Profile computed in a batch
+  vpMatrix Q;
+  unsigned int n = generator.computeProfile(delta_t, Q);
+  if (n != k || Q.getRows() != k || Q.getCols() != njoints) {
+    std::cerr << "Bad number of samples " << n << " of the profile instead of " << k << std::endl;
+    return false;
+  }
+  for (unsigned int s = 0; s < n; s++) {
+    generator.computePosition(s * delta_t, q);
+    for (unsigned int i = 0; i < njoints; i++) {
+      if (Q[s][i] != q[i]) {
+        std::cerr << "Bad sample " << s << " of joint " << i << " in the profile" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  // A goal equal to the start is reached at once
+  generator.setGoal(q_goal, q_goal);
+  if (!generator.computePosition(0., q) || q != q_goal || generator.computeProfile(delta_t, Q) != 1) {
+    std::cerr << "Bad motion to the current position" << std::endl;
+    return false;
+  }
+
+  bool thrown = false;
+  try {
+    generator.setGoal(vpColVector(6), q_goal);
+  } catch (vpException &e) {
+    thrown = e.getCode() == vpException::dimensionError;
+  }
+  if (!thrown) {
+    std::cerr << "No exception for a bad number of joints" << std::endl;
+    return false;
+  }
+
+  std::cout << "Joint positioning in " << max_t_f << " s over " << k << " periods" << std::endl;
+  return true;
+}
+
+bool testVelocity()
+{
+  vpColVector q(njoints), q_min(njoints, -1.), q_max(njoints, 1.), dq_max(njoints, 1.), ddq_max(njoints);
+  for (unsigned int i = 0; i < njoints; i++) {
+    ddq_max[i] = 3. + 0.5 * i;
+  }
+  vpJointVelTrajGenerator generator, generatorBatch;
+  generator.init(q, q_min, q_max, dq_max, ddq_max, delta_t);
+  generatorBatch.init(q, q_min, q_max, dq_max, ddq_max, delta_t);
+
+  // Desired velocities: start, change of direction, over the velocity limit,
+  // then a joint running to its limit
+  const unsigned int n = 6000;
+  vpMatrix dq_des(n, njoints);
+  for (unsigned int k = 0; k < n; k++) {
+    for (unsigned int i = 0; i < njoints; i++) {
+      if (k < 1000) {
+        dq_des[k][i] = 0.3 * (i % 2 ? 1. : -1.);
+      } else if (k < 2000) {
+        dq_des[k][i] = -0.2 * (i % 2 ? 1. : -1.);
+      } else if (k < 2500) {
+        dq_des[k][i] = 2.;
+      } else if (k < 3000) {
+        dq_des[k][i] = 0.;
+      } else {
+        dq_des[k][i] = i == 2 ? 0.8 : 0.1;
+      }
+    }
+  }
+
+  vpMatrix Q, dQ;
+  generatorBatch.computeProfile(dq_des, Q, dQ);
+
+  vpColVector q_cmd(njoints), dq_cmd(njoints), dq_cmd_prev(njoints);
+  bool jointLimitReached = false;
+  for (unsigned int k = 0; k < n; k++) {
+    generator.applyVel(dq_des.getRow(k).t(), q_cmd, dq_cmd);
+    if (generator.getJointLimitAxis() >= 0) {
+      if (generator.getJointLimitAxis() != 2) {
+        std::cerr << "Joint " << generator.getJointLimitAxis() << " reached its limit instead of joint 2" << std::endl;
+        return false;
+      }
+      jointLimitReached = true;
+    }
+    for (unsigned int i = 0; i < njoints; i++) {
+      if (Q[k][i] != q_cmd[i] || dQ[k][i] != dq_cmd[i]) {
+        std::cerr << "Bad command " << k << " of joint " << i << " in the batch" << std::endl;
+        return false;
+      }
+      if (std::fabs(dq_cmd[i]) > dq_max[i] * (1. + 1e-9)) {
+        std::cerr << "Velocity " << dq_cmd[i] << " of joint " << i << " over the limit" << std::endl;
+        return false;
+      }
+      double ddq = (dq_cmd[i] - dq_cmd_prev[i]) / delta_t;
+      if (std::fabs(ddq) > ddq_max[i] * (1. + 1e-6)) {
+        std::cerr << "Acceleration " << ddq << " of joint " << i << " at period " << k << " over the limit"
+                  << std::endl;
+        return false;
+      }
+      if (q_cmd[i] < q_min[i] + vpMath::rad(1.) - 1e-12 || q_cmd[i] > q_max[i] - vpMath::rad(1.) + 1e-12) {
+        std::cerr << "Joint " << i << " at " << q_cmd[i] << " over its limit" << std::endl;
+        return false;
+      }
+      // The desired velocity is reached
+      double dq_expected = std::max(-dq_max[i], std::min(dq_max[i], dq_des[k][i]));
+      if ((k == 999 || k == 1999 || k == 2499 || k == 2999) && std::fabs(dq_cmd[i] - dq_expected) > 1e-6) {
+        std::cerr << "Velocity " << dq_cmd[i] << " of joint " << i << " at period " << k << " instead of "
+                  << dq_expected << std::endl;
+        return false;
+      }
+    }
+    dq_cmd_prev = dq_cmd;
+  }
+  if (!jointLimitReached || dq_cmd.euclideanNorm() > 1e-9) {
+    std::cerr << "The joints are not stopped before the joint limit" << std::endl;
+    return false;
+  }
+
+  bool thrown = false;
+  try {
+    generator.applyVel(vpColVector(6), q_cmd, dq_cmd);
+  } catch (vpException &e) {
+    thrown = e.getCode() == vpException::dimensionError;
+  }
+  if (!thrown) {
+    std::cerr << "No exception for a bad number of joints" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Joint positioning period of the control loop, with a new goal every
+// second
+void positionPeriod(vpJointPosTrajGenerator &generator, unsigned int k, const vpColVector &q_start,
+                    const vpColVector &q_goal, vpColVector &q)
+{
+  if (k % 1000 == 0) {
+    generator.setGoal(q_start.data, q_goal.data);
+  }
+  generator.computePosition((k % 1000) * delta_t, q.data);
+}
+
+// Joint velocity control period of the control loop
+void velocityPeriod(vpJointVelTrajGenerator &generator, unsigned int k, vpColVector &dq_des, vpColVector &q_cmd,
+                    vpColVector &dq_cmd)
+{
+  for (unsigned int i = 0; i < njoints; i++) {
+    dq_des[i] = 0.5 * sin(2. * M_PI * (k * delta_t + 0.1 * i));
+  }
+  generator.applyVel(dq_des.data, q_cmd.data, dq_cmd.data);
+}
+
+// Mean computation time of a period of the control loop, from the whole
+// loop, and worst-case computation time, from each period
+void benchmark()
+{
+  const unsigned int n = 100000;
+  vpColVector dq_max(njoints, 2.5), ddq_max(njoints, 5.), q_start(njoints), q_goal(njoints), q(njoints);
+  for (unsigned int i = 0; i < njoints; i++) {
+    q_goal[i] = 0.2 + 0.1 * i;
+  }
+  vpJointPosTrajGenerator posGenerator;
+  posGenerator.init(dq_max, ddq_max, ddq_max, 0.5);
+
+  double mean = vpTime::measureTimeMicros();
+  for (unsigned int k = 0; k < n; k++) {
+    positionPeriod(posGenerator, k, q_start, q_goal, q);
+  }
+  mean = (vpTime::measureTimeMicros() - mean) / n;
+  double worst = 0.;
+  for (unsigned int k = 0; k < n; k++) {
+    double t = vpTime::measureTimeMicros();
+    positionPeriod(posGenerator, k, q_start, q_goal, q);
+    worst = std::max(worst, vpTime::measureTimeMicros() - t);
+  }
+  std::cout << "vpJointPosTrajGenerator period: " << mean << " us mean, " << worst << " us worst case" << std::endl;
+
+  vpColVector q_min(njoints, -2.), q_max(njoints, 2.), dq_des(njoints), q_cmd(njoints), dq_cmd(njoints);
+  vpJointVelTrajGenerator velGenerator;
+  velGenerator.init(q_start, q_min, q_max, dq_max, ddq_max, delta_t);
+  mean = vpTime::measureTimeMicros();
+  for (unsigned int k = 0; k < n; k++) {
+    velocityPeriod(velGenerator, k, dq_des, q_cmd, dq_cmd);
+  }
+  mean = (vpTime::measureTimeMicros() - mean) / n;
+  worst = 0.;
+  for (unsigned int k = 0; k < n; k++) {
+    double t = vpTime::measureTimeMicros();
+    velocityPeriod(velGenerator, k, dq_des, q_cmd, dq_cmd);
+    worst = std::max(worst, vpTime::measureTimeMicros() - t);
+  }
+  std::cout << "vpJointVelTrajGenerator period: " << mean << " us mean, " << worst << " us worst case" << std::endl;
+}
+}
+
+int main()
+{
+  try {
+    if (!testPosition() || !testVelocity()) {
+      return EXIT_FAILURE;
+    }
+    benchmark();
+
+    std::cout << "testJointTrajGenerator is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -121,10 +121,14 @@
   A line by line explanation of this last example is also provided in
   \ref tutorial-tracking-blob, section \ref tracking_blob_tracking.
 
-  \sa vpDot
+  To track many dots in the same image, see vpDot2Group.
+
+  \sa vpDot, vpDot2Group
 */
 class VISP_EXPORT vpDot2 : public vpTracker
 {
+  friend class vpDot2Group;
+
 public:
   vpDot2();
   explicit vpDot2(const vpImagePoint &ip);
@@ -425,6 +429,11 @@ private:
 
   bool computeParameters(const vpImage<unsigned char> &I, const double &u = -1.0, const double &v = -1.0);
 
+  bool trackFromPreviousCog(const vpImage<unsigned char> &I);
+  vpRect getSearchWindow() const;
+  void updateFromCandidate(const vpDot2 &movingDot);
+  void updateGrayLevelBounds();
+
   bool findFirstBorder(const vpImage<unsigned char> &I, const unsigned int &u, const unsigned int &v,
                        unsigned int &border_u, unsigned int &border_v);
   void computeMeanGrayLevel(const vpImage<unsigned char> &I);
@@ -0,0 +1,160 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Track a set of white dots sharing the same image.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDot2Group.h
+  \brief Track a set of vpDot2 blobs in one pass over an image.
+*/
+
+#ifndef vpDot2Group_hh
+#define vpDot2Group_hh
+
+#include <visp3/blob/vpDot2.h>
+#include <visp3/core/vpColor.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+
+#include <vector>
+
+/*!
+  \class vpDot2Group
+
+  \ingroup module_blob
+
+  \brief Track a set of blobs (see vpDot2) that are visible in the same
+  image.
+
+  Compared to a loop calling vpDot2::track() for each dot, this class:
+  - tracks the dots in parallel when OpenMP is available (see
+    setNbThreads());
+  - does not throw an exception when a dot is lost, but reports a
+    per-dot status (see getStatus() and isTracked());
+  - shares the search of lost dots: the search windows of the lost dots that
+    overlap are merged and scanned only once, the found blobs being then
+    assigned to the lost dots they match. Blobs that belong to a dot already
+    tracked are never assigned to another dot.
+
+  The following example shows how to track dots that were previously
+  initialized:
+  \code
+  vpDot2Group group;
+  for (size_t i = 0; i < dots.size(); i++)
+    group.addDot(dots[i]);
+
+  while (...) {
+    // acquire I
+    unsigned int nb_tracked = group.track(I);
+    for (unsigned int i = 0; i < group.getNbDots(); i++) {
+      if (group.isTracked(i))
+        std::cout << "Dot " << i << " cog: " << group.getDot(i).getCog() << std::endl;
+    }
+  }
+  \endcode
+
+  \sa vpDot2
+*/
+class VISP_EXPORT vpDot2Group
+{
+public:
+  /*! Tracking status of a dot after the last call to track(). */
+  typedef enum {
+    DOT_TRACKED,   /*!< The dot was found around its previous position. */
+    DOT_RECOVERED, /*!< The dot was lost and found again in its search window. */
+    DOT_LOST       /*!< The dot was not found. Its parameters are the ones of the previous image. */
+  } vpDot2StatusType;
+
+  vpDot2Group();
+  virtual ~vpDot2Group();
+
+  void addDot(const vpDot2 &dot);
+  void clear();
+
+  void display(const vpImage<unsigned char> &I, const vpColor &colorTracked = vpColor::green,
+               const vpColor &colorLost = vpColor::red, unsigned int thickness = 1) const;
+
+  std::vector<vpImagePoint> getCogs() const;
+  vpDot2 &getDot(unsigned int i);
+  const vpDot2 &getDot(unsigned int i) const;
+  /*!
+    Return the number of dots handled by the group.
+  */
+  inline unsigned int getNbDots() const { return (unsigned int)m_dots.size(); }
+  unsigned int getNbTracked() const;
+  /*!
+    Return the number of threads used to track the dots.
+
+    \sa setNbThreads()
+  */
+  inline int getNbThreads() const { return m_nbThreads; }
+  vpDot2StatusType getStatus(unsigned int i) const;
+  /*!
+    Return true if the search of the lost dots is shared between dots
+    with overlapping search windows.
+
+    \sa setSharedSearch()
+  */
+  inline bool getSharedSearch() const { return m_sharedSearch; }
+
+  bool isTracked(unsigned int i) const;
+
+  /*!
+    Set the number of threads used to track the dots. A value of 0 lets
+    OpenMP choose the number of threads. This parameter is only used when
+    ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(int nbThreads) { m_nbThreads = nbThreads; }
+  /*!
+    Enable or disable the shared search of the lost dots. When disabled,
+    each lost dot is searched in its own search window like in
+    vpDot2::track().
+  */
+  inline void setSharedSearch(bool shared) { m_sharedSearch = shared; }
+
+  unsigned int track(const vpImage<unsigned char> &I);
+
+private:
+  void searchLostDots(const vpImage<unsigned char> &I, const std::vector<unsigned int> &lost);
+
+  //! Dots to track
+  std::vector<vpDot2> m_dots;
+  //! Status of each dot after the last call to track()
+  std::vector<vpDot2StatusType> m_status;
+  //! Number of threads used to track the dots
+  int m_nbThreads;
+  //! If true, merge the overlapping search windows of the lost dots
+  bool m_sharedSearch;
+};
+
+#endif
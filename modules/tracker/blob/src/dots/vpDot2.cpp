@@ -438,33 +438,8 @@ void vpDot2::initTracking(const vpImage<unsigned char> &I, const vpImagePoint &i
 */
 void vpDot2::track(const vpImage<unsigned char> &I)
 {
-  m00 = m11 = m02 = m20 = m10 = m01 = 0;
-
   // First, we will estimate the position of the tracked point
-
-  // Set the search area to the entire image
-  setArea(I);
-
-  // create a copy of the dot to search
-  // This copy can be saw as the previous dot used to check if the current one
-  // found with computeParameters() is similar to the previous one (see
-  // isValid() function). If the found dot is not similar (or valid), we use
-  // this copy to set the current found dot to the previous one (see below).
-  vpDot2 wantedDot(*this);
-
-  //   vpDEBUG_TRACE(0, "Previous dot: ");
-  //   vpDEBUG_TRACE(0, "u: %f v: %f", get_u(), get_v());
-  //   vpDEBUG_TRACE(0, "w: %f h: %f", getWidth(), getHeight());
-  bool found = computeParameters(I, cog.get_u(), cog.get_v());
-
-  if (found) {
-    // test if the found dot is valid (ie similar to the previous one)
-    found = isValid(I, wantedDot);
-    if (!found) {
-      *this = wantedDot;
-      // std::cout << "The found dot is not valid" << std::endl;
-    }
-  }
+  bool found = trackFromPreviousCog(I);
 
   if (!found) {
     //     vpDEBUG_TRACE(0, "Search the dot in a biggest window around the
@@ -476,22 +451,10 @@ void vpDot2::track(const vpImage<unsigned char> &I)
     // closest from the estimation,
     // i.e. search for dots in an a region of interest around the this dot and
     // get the first element in the area.
-
-    // first get the size of the search window from the dot size
-    double searchWindowWidth, searchWindowHeight;
-    // if( getWidth() == 0 || getHeight() == 0 )
-    if (std::fabs(getWidth()) <= std::numeric_limits<double>::epsilon() ||
-        std::fabs(getHeight()) <= std::numeric_limits<double>::epsilon()) {
-      searchWindowWidth = 80.;
-      searchWindowHeight = 80.;
-    } else {
-      searchWindowWidth = getWidth() * 5;
-      searchWindowHeight = getHeight() * 5;
-    }
     std::list<vpDot2> candidates;
-    searchDotsInArea(I, (int)(this->cog.get_u() - searchWindowWidth / 2.0),
-                     (int)(this->cog.get_v() - searchWindowHeight / 2.0), (unsigned int)searchWindowWidth,
-                     (unsigned int)searchWindowHeight, candidates);
+    vpRect searchWindow = getSearchWindow();
+    searchDotsInArea(I, (int)searchWindow.getLeft(), (int)searchWindow.getTop(), (unsigned int)searchWindow.getWidth(),
+                     (unsigned int)searchWindow.getHeight(), candidates);
 
     // if the vector is empty, that mean we didn't find any candidate
     // in the area, return an error tracking.
@@ -501,26 +464,7 @@ void vpDot2::track(const vpImage<unsigned char> &I)
     }
 
     // otherwise we've got our dot, update this dot's parameters
-    vpDot2 movingDot = candidates.front();
-
-    setCog(movingDot.getCog());
-    setArea(movingDot.getArea());
-    setWidth(movingDot.getWidth());
-    setHeight(movingDot.getHeight());
-
-    // Update the moments
-    m00 = movingDot.m00;
-    m01 = movingDot.m01;
-    m10 = movingDot.m10;
-    m11 = movingDot.m11;
-    m20 = movingDot.m20;
-    m02 = movingDot.m02;
-
-    // Update the bounding box
-    bbox_u_min = movingDot.bbox_u_min;
-    bbox_u_max = movingDot.bbox_u_max;
-    bbox_v_min = movingDot.bbox_v_min;
-    bbox_v_max = movingDot.bbox_v_max;
+    updateFromCandidate(candidates.front());
   }
   //   else {
   //     // test if the found dot is valid,
@@ -548,25 +492,8 @@ void vpDot2::track(const vpImage<unsigned char> &I)
                               "The center of gravity of the dot is not in the image"));
   }
 
-  // Get dots center of gravity
-  // unsigned int u = (unsigned int) this->cog.get_u();
-  // unsigned int v = (unsigned int) this->cog.get_v();
   // Updates the min and max gray levels for the next iteration
-  // double Ip = pow((double)I[v][u]/255,1/gamma);
-  double Ip = pow(getMeanGrayLevel() / 255, 1 / gamma);
-  // printf("current value of gray level center : %i\n", I[v][u]);
-
-  // getMeanGrayLevel(I);
-  if (Ip - (1 - grayLevelPrecision) < 0) {
-    gray_level_min = 0;
-  } else {
-    gray_level_min = (unsigned int)(255 * pow(Ip - (1 - grayLevelPrecision), gamma));
-    if (gray_level_min > 255)
-      gray_level_min = 255;
-  }
-  gray_level_max = (unsigned int)(255 * pow(Ip + (1 - grayLevelPrecision), gamma));
-  if (gray_level_max > 255)
-    gray_level_max = 255;
+  updateGrayLevelBounds();
 
   // printf("%i %i \n",gray_level_max,gray_level_min);
   if (graphics) {
@@ -602,6 +529,130 @@ void vpDot2::track(const vpImage<unsigned char> &I, vpImagePoint &ip)
   ip = this->cog;
 }
 
+/*!
+
+  Estimate the new dot parameters from its previous center of gravity. This
+  is the first step of track(): the dot characteristics are computed from
+  the previous position and compared to the previous dot using isValid().
+
+  \param I : Image to process.
+
+  \return true if a valid dot was found at the previous position, false
+  otherwise. In that case all the dot parameters, including its moments and
+  its bounding box, are restored to the previous ones.
+
+  \sa track()
+*/
+bool vpDot2::trackFromPreviousCog(const vpImage<unsigned char> &I)
+{
+  // Set the search area to the entire image
+  setArea(I);
+
+  // create a copy of the dot to search
+  // This copy can be saw as the previous dot used to check if the current one
+  // found with computeParameters() is similar to the previous one (see
+  // isValid() function). If no dot is found or if the found dot is not
+  // similar (or valid), we use this copy to set the current found dot to the
+  // previous one (see below).
+  vpDot2 wantedDot(*this);
+
+  m00 = m11 = m02 = m20 = m10 = m01 = 0;
+
+  bool found = computeParameters(I, cog.get_u(), cog.get_v());
+
+  if (found) {
+    // test if the found dot is valid (ie similar to the previous one)
+    found = isValid(I, wantedDot);
+  }
+  if (!found) {
+    *this = wantedDot;
+  }
+
+  return found;
+}
+
+/*!
+
+  Return the window centered on the dot center of gravity in which the dot
+  is searched when it is lost. Its size is five times the dot size, or 80 by
+  80 pixels if the dot size is unknown.
+
+  \sa track()
+*/
+vpRect vpDot2::getSearchWindow() const
+{
+  // first get the size of the search window from the dot size
+  double searchWindowWidth, searchWindowHeight;
+  // if( getWidth() == 0 || getHeight() == 0 )
+  if (std::fabs(getWidth()) <= std::numeric_limits<double>::epsilon() ||
+      std::fabs(getHeight()) <= std::numeric_limits<double>::epsilon()) {
+    searchWindowWidth = 80.;
+    searchWindowHeight = 80.;
+  } else {
+    searchWindowWidth = getWidth() * 5;
+    searchWindowHeight = getHeight() * 5;
+  }
+
+  return vpRect(this->cog.get_u() - searchWindowWidth / 2.0, this->cog.get_v() - searchWindowHeight / 2.0,
+                searchWindowWidth, searchWindowHeight);
+}
+
+/*!
+
+  Update the dot position, size, moments and bounding box from a dot found
+  by searchDotsInArea().
+
+  \param movingDot : Dot that is considered as the new location of this dot.
+*/
+void vpDot2::updateFromCandidate(const vpDot2 &movingDot)
+{
+  setCog(movingDot.getCog());
+  setArea(movingDot.getArea());
+  setWidth(movingDot.getWidth());
+  setHeight(movingDot.getHeight());
+
+  // Update the moments
+  m00 = movingDot.m00;
+  m01 = movingDot.m01;
+  m10 = movingDot.m10;
+  m11 = movingDot.m11;
+  m20 = movingDot.m20;
+  m02 = movingDot.m02;
+
+  // Update the bounding box
+  bbox_u_min = movingDot.bbox_u_min;
+  bbox_u_max = movingDot.bbox_u_max;
+  bbox_v_min = movingDot.bbox_v_min;
+  bbox_v_max = movingDot.bbox_v_max;
+}
+
+/*!
+
+  Update the min and max gray levels used for the next iteration from the
+  mean gray level of the dot and the gray level precision.
+*/
+void vpDot2::updateGrayLevelBounds()
+{
+  // Get dots center of gravity
+  // unsigned int u = (unsigned int) this->cog.get_u();
+  // unsigned int v = (unsigned int) this->cog.get_v();
+  // double Ip = pow((double)I[v][u]/255,1/gamma);
+  double Ip = pow(getMeanGrayLevel() / 255, 1 / gamma);
+  // printf("current value of gray level center : %i\n", I[v][u]);
+
+  // getMeanGrayLevel(I);
+  if (Ip - (1 - grayLevelPrecision) < 0) {
+    gray_level_min = 0;
+  } else {
+    gray_level_min = (unsigned int)(255 * pow(Ip - (1 - grayLevelPrecision), gamma));
+    if (gray_level_min > 255)
+      gray_level_min = 255;
+  }
+  gray_level_max = (unsigned int)(255 * pow(Ip + (1 - grayLevelPrecision), gamma));
+  if (gray_level_max > 255)
+    gray_level_max = 255;
+}
+
 ///// GET METHODS
 ////////////////////////////////////////////////////////////////
 
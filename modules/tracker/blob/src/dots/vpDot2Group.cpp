@@ -0,0 +1,445 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Track a set of white dots sharing the same image.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpDot2Group.cpp
+  \brief Track a set of vpDot2 blobs in one pass over an image.
+*/
+
+#include <visp3/blob/vpDot2Group.h>
+#include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpException.h>
+
+#include <algorithm>
+#include <list>
+
+#ifdef VISP_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Candidate blob that may be assigned to a lost dot
+struct vpDot2Assignment {
+  double distance;
+  unsigned int dot;
+  unsigned int candidate;
+
+  bool operator<(const vpDot2Assignment &other) const { return distance < other.distance; }
+};
+
+bool overlap(const vpRect &a, const vpRect &b)
+{
+  return a.getLeft() <= b.getRight() && b.getLeft() <= a.getRight() && a.getTop() <= b.getBottom() &&
+         b.getTop() <= a.getBottom();
+}
+
+vpRect merge(const vpRect &a, const vpRect &b)
+{
+  double left = (std::min)(a.getLeft(), b.getLeft());
+  double top = (std::min)(a.getTop(), b.getTop());
+  double right = (std::max)(a.getLeft() + a.getWidth(), b.getLeft() + b.getWidth());
+  double bottom = (std::max)(a.getTop() + a.getHeight(), b.getTop() + b.getHeight());
+  return vpRect(left, top, right - left, bottom - top);
+}
+
+unsigned int findRoot(std::vector<unsigned int> &parent, unsigned int i)
+{
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+bool isOwned(const std::vector<vpRect> &trackedBBoxes, const vpImagePoint &cog)
+{
+  for (size_t i = 0; i < trackedBBoxes.size(); i++) {
+    if (trackedBBoxes[i].isInside(cog)) {
+      return true;
+    }
+  }
+  return false;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. The group contains no dot, the shared search of the
+  lost dots is enabled and the number of threads is chosen by OpenMP.
+*/
+vpDot2Group::vpDot2Group() : m_dots(), m_status(), m_nbThreads(0), m_sharedSearch(true) {}
+
+/*!
+  Destructor.
+*/
+vpDot2Group::~vpDot2Group() {}
+
+/*!
+  Add a dot to the group. The dot should already be initialized (see
+  vpDot2::initTracking()) or its characteristics set to be found in its
+  search window.
+
+  \param dot : Dot to add.
+*/
+void vpDot2Group::addDot(const vpDot2 &dot)
+{
+  m_dots.push_back(dot);
+  m_status.push_back(DOT_TRACKED);
+}
+
+/*!
+  Remove all the dots from the group.
+*/
+void vpDot2Group::clear()
+{
+  m_dots.clear();
+  m_status.clear();
+}
+
+/*!
+  Display a cross at the center of gravity of each dot.
+
+  \param I : Image used as background.
+  \param colorTracked : Color of the dots that are tracked or recovered.
+  \param colorLost : Color of the dots that are lost.
+  \param thickness : Thickness of the crosses.
+*/
+void vpDot2Group::display(const vpImage<unsigned char> &I, const vpColor &colorTracked, const vpColor &colorLost,
+                          unsigned int thickness) const
+{
+  for (size_t i = 0; i < m_dots.size(); i++) {
+    vpDisplay::displayCross(I, m_dots[i].getCog(), 3 * thickness + 8,
+                            m_status[i] == DOT_LOST ? colorLost : colorTracked, thickness);
+  }
+}
+
+/*!
+  Return the center of gravity of all the dots, lost dots included.
+*/
+std::vector<vpImagePoint> vpDot2Group::getCogs() const
+{
+  std::vector<vpImagePoint> cogs(m_dots.size());
+  for (size_t i = 0; i < m_dots.size(); i++) {
+    cogs[i] = m_dots[i].getCog();
+  }
+  return cogs;
+}
+
+/*!
+  Return the dot with index \e i.
+
+  \exception vpException::dimensionError : If \e i is out of range.
+*/
+vpDot2 &vpDot2Group::getDot(unsigned int i)
+{
+  if (i >= m_dots.size()) {
+    throw(vpException(vpException::dimensionError, "Dot index %d out of range [0, %d[", i,
+                      (unsigned int)m_dots.size()));
+  }
+  return m_dots[i];
+}
+
+/*!
+  Return the dot with index \e i.
+
+  \exception vpException::dimensionError : If \e i is out of range.
+*/
+const vpDot2 &vpDot2Group::getDot(unsigned int i) const
+{
+  if (i >= m_dots.size()) {
+    throw(vpException(vpException::dimensionError, "Dot index %d out of range [0, %d[", i,
+                      (unsigned int)m_dots.size()));
+  }
+  return m_dots[i];
+}
+
+/*!
+  Return the number of dots that were tracked or recovered by the last call
+  to track().
+*/
+unsigned int vpDot2Group::getNbTracked() const
+{
+  unsigned int nb = 0;
+  for (size_t i = 0; i < m_status.size(); i++) {
+    if (m_status[i] != DOT_LOST) {
+      nb++;
+    }
+  }
+  return nb;
+}
+
+/*!
+  Return the status of the dot with index \e i after the last call to
+  track().
+
+  \exception vpException::dimensionError : If \e i is out of range.
+*/
+vpDot2Group::vpDot2StatusType vpDot2Group::getStatus(unsigned int i) const
+{
+  if (i >= m_status.size()) {
+    throw(vpException(vpException::dimensionError, "Dot index %d out of range [0, %d[", i,
+                      (unsigned int)m_status.size()));
+  }
+  return m_status[i];
+}
+
+/*!
+  Return true if the dot with index \e i was tracked or recovered by the last
+  call to track().
+
+  \exception vpException::dimensionError : If \e i is out of range.
+*/
+bool vpDot2Group::isTracked(unsigned int i) const { return getStatus(i) != DOT_LOST; }
+
+/*!
+  Search the lost dots in their search window (see vpDot2::track()).
+
+  When the shared search is enabled, the overlapping search windows are merged
+  and each merged window is scanned only once using the characteristics of
+  the first lost dot of the window, the gray level interval being enlarged to
+  cover the one of all the lost dots. The blobs that are found are then
+  assigned to the closest lost dot they are valid for. The dots that remain
+  unassigned are searched individually.
+
+  \param I : Image to process.
+  \param lost : Indexes of the lost dots.
+*/
+void vpDot2Group::searchLostDots(const vpImage<unsigned char> &I, const std::vector<unsigned int> &lost)
+{
+  // Bounding boxes of the dots that are already tracked; a blob inside one of
+  // them can not be assigned to a lost dot
+  std::vector<vpRect> trackedBBoxes;
+  for (size_t i = 0; i < m_dots.size(); i++) {
+    if (m_status[i] == DOT_TRACKED) {
+      trackedBBoxes.push_back(m_dots[i].getBBox());
+    }
+  }
+
+  std::vector<vpRect> windows(lost.size());
+  std::vector<unsigned int> parent(lost.size());
+  for (unsigned int i = 0; i < lost.size(); i++) {
+    windows[i] = m_dots[lost[i]].getSearchWindow();
+    parent[i] = i;
+  }
+
+  if (m_sharedSearch) {
+    for (unsigned int i = 0; i < lost.size(); i++) {
+      for (unsigned int j = i + 1; j < lost.size(); j++) {
+        if (overlap(windows[i], windows[j])) {
+          unsigned int ri = findRoot(parent, i);
+          unsigned int rj = findRoot(parent, j);
+          if (ri != rj) {
+            parent[(std::max)(ri, rj)] = (std::min)(ri, rj);
+          }
+        }
+      }
+    }
+  }
+
+  // Group the lost dots by merged search window
+  std::vector<std::vector<unsigned int> > clusters;
+  std::vector<int> clusterIndex(lost.size(), -1);
+  for (unsigned int i = 0; i < lost.size(); i++) {
+    unsigned int root = findRoot(parent, i);
+    if (clusterIndex[root] < 0) {
+      clusterIndex[root] = (int)clusters.size();
+      clusters.push_back(std::vector<unsigned int>());
+    }
+    clusters[(size_t)clusterIndex[root]].push_back(i);
+  }
+
+  int nbClusters = (int)clusters.size();
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_nbThreads > 0 ? m_nbThreads : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+#endif
+  for (int c = 0; c < nbClusters; c++) {
+    const std::vector<unsigned int> &cluster = clusters[(size_t)c];
+
+    vpDot2 reference(m_dots[lost[cluster[0]]]);
+    vpRect window = windows[cluster[0]];
+    for (size_t k = 1; k < cluster.size(); k++) {
+      const vpDot2 &dot = m_dots[lost[cluster[k]]];
+      reference.setGrayLevelMin((std::min)(reference.getGrayLevelMin(), dot.getGrayLevelMin()));
+      reference.setGrayLevelMax((std::max)(reference.getGrayLevelMax(), dot.getGrayLevelMax()));
+      window = merge(window, windows[cluster[k]]);
+    }
+
+    std::list<vpDot2> found;
+    reference.searchDotsInArea(I, (int)window.getLeft(), (int)window.getTop(), (unsigned int)window.getWidth(),
+                               (unsigned int)window.getHeight(), found);
+
+    std::vector<vpDot2> candidates;
+    for (std::list<vpDot2>::const_iterator it = found.begin(); it != found.end(); ++it) {
+      if (!isOwned(trackedBBoxes, it->getCog())) {
+        candidates.push_back(*it);
+      }
+    }
+
+    // Assign the closest valid candidates to the lost dots of the cluster
+    std::vector<vpDot2Assignment> assignments;
+    for (unsigned int k = 0; k < cluster.size(); k++) {
+      const vpDot2 &dot = m_dots[lost[cluster[k]]];
+      for (unsigned int j = 0; j < candidates.size(); j++) {
+        vpImagePoint cog = candidates[j].getCog();
+        if (!windows[cluster[k]].isInside(cog)) {
+          continue;
+        }
+        if (k > 0) {
+          // The candidates were only validated against the reference dot
+          if (candidates[j].getMeanGrayLevel() < dot.getGrayLevelMin() ||
+              candidates[j].getMeanGrayLevel() > dot.getGrayLevelMax()) {
+            continue;
+          }
+          vpDot2 candidate(candidates[j]);
+          if (!candidate.isValid(I, dot)) {
+            continue;
+          }
+        }
+        vpDot2Assignment a;
+        a.distance = vpImagePoint::sqrDistance(cog, dot.getCog());
+        a.dot = k;
+        a.candidate = j;
+        assignments.push_back(a);
+      }
+    }
+    std::sort(assignments.begin(), assignments.end());
+
+    std::vector<bool> dotAssigned(cluster.size(), false);
+    std::vector<bool> candidateAssigned(candidates.size(), false);
+    for (size_t a = 0; a < assignments.size(); a++) {
+      if (dotAssigned[assignments[a].dot] || candidateAssigned[assignments[a].candidate]) {
+        continue;
+      }
+      dotAssigned[assignments[a].dot] = true;
+      candidateAssigned[assignments[a].candidate] = true;
+      unsigned int index = lost[cluster[assignments[a].dot]];
+      m_dots[index].updateFromCandidate(candidates[assignments[a].candidate]);
+      m_status[index] = DOT_RECOVERED;
+    }
+
+    // A dot with a different appearance than the reference may have been
+    // missed by the shared scan: search it in its own window
+    for (unsigned int k = 1; k < cluster.size(); k++) {
+      if (dotAssigned[k]) {
+        continue;
+      }
+      unsigned int index = lost[cluster[k]];
+      const vpRect &w = windows[cluster[k]];
+      std::list<vpDot2> own;
+      m_dots[index].searchDotsInArea(I, (int)w.getLeft(), (int)w.getTop(), (unsigned int)w.getWidth(),
+                                     (unsigned int)w.getHeight(), own);
+      for (std::list<vpDot2>::const_iterator it = own.begin(); it != own.end(); ++it) {
+        bool alreadyUsed = isOwned(trackedBBoxes, it->getCog());
+        for (size_t j = 0; j < candidates.size() && !alreadyUsed; j++) {
+          alreadyUsed = candidateAssigned[j] && vpImagePoint::sqrDistance(candidates[j].getCog(), it->getCog()) < 9.;
+        }
+        if (!alreadyUsed) {
+          m_dots[index].updateFromCandidate(*it);
+          m_status[index] = DOT_RECOVERED;
+          break;
+        }
+      }
+    }
+  }
+}
+
+/*!
+  Track all the dots in the image.
+
+  For each dot, the behavior is the one of vpDot2::track(): the dot is first
+  searched from its previous center of gravity, then in a window around it if
+  it is lost. Contrary to vpDot2::track(), no exception is thrown when a dot
+  is lost; the status of each dot is available using getStatus() or
+  isTracked(). A lost dot keeps the parameters it had in the previous image.
+
+  \param I : Image to process.
+
+  \return The number of dots that are tracked or recovered.
+
+  \sa getStatus(), getNbTracked()
+*/
+unsigned int vpDot2Group::track(const vpImage<unsigned char> &I)
+{
+  int nbDots = (int)m_dots.size();
+
+  // Display is not thread safe: graphics are done once the dots are tracked
+  std::vector<bool> graphics((size_t)nbDots);
+  for (int i = 0; i < nbDots; i++) {
+    graphics[(size_t)i] = m_dots[(size_t)i].graphics;
+    m_dots[(size_t)i].graphics = false;
+  }
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_nbThreads > 0 ? m_nbThreads : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+#endif
+  for (int i = 0; i < nbDots; i++) {
+    m_status[(size_t)i] = m_dots[(size_t)i].trackFromPreviousCog(I) ? DOT_TRACKED : DOT_LOST;
+  }
+
+  std::vector<unsigned int> lost;
+  for (int i = 0; i < nbDots; i++) {
+    if (m_status[(size_t)i] == DOT_LOST) {
+      lost.push_back((unsigned int)i);
+    }
+  }
+  if (!lost.empty()) {
+    searchLostDots(I, lost);
+  }
+
+  unsigned int nbTracked = 0;
+  for (int i = 0; i < nbDots; i++) {
+    vpDot2 &dot = m_dots[(size_t)i];
+    dot.graphics = graphics[(size_t)i];
+
+    if (m_status[(size_t)i] != DOT_LOST) {
+      if (!dot.isInImage(I)) {
+        m_status[(size_t)i] = DOT_LOST;
+        continue;
+      }
+      dot.updateGrayLevelBounds();
+      nbTracked++;
+
+      if (dot.graphics) {
+        vpDisplay::displayCross(I, dot.getCog(), 3 * dot.thickness + 8, vpColor::red, dot.thickness);
+      }
+    }
+  }
+
+  return nbTracked;
+}
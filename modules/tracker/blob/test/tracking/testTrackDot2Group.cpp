@@ -0,0 +1,191 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test tracking of a group of dots on synthetic images.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testTrackDot2Group.cpp
+
+  \brief Test vpDot2Group on synthetic images with many dots.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/blob/vpDot2.h>
+#include <visp3/blob/vpDot2Group.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+
+namespace
+{
+const unsigned int nb_rows = 5;
+const unsigned int nb_cols = 8;
+const double spacing = 60.;
+const double radius = 8.;
+
+// Draw white disks on a black background; disk \e skip is not drawn
+void drawDots(vpImage<unsigned char> &I, double offset_u, double offset_v, int skip = -1)
+{
+  I = 0;
+  for (unsigned int r = 0; r < nb_rows; r++) {
+    for (unsigned int c = 0; c < nb_cols; c++) {
+      if ((int)(r * nb_cols + c) == skip)
+        continue;
+      double u0 = 60. + c * spacing + offset_u;
+      double v0 = 60. + r * spacing + offset_v;
+      for (int v = (int)(v0 - radius - 1); v <= (int)(v0 + radius + 1); v++) {
+        for (int u = (int)(u0 - radius - 1); u <= (int)(u0 + radius + 1); u++) {
+          if ((u - u0) * (u - u0) + (v - v0) * (v - v0) <= radius * radius)
+            I[v][u] = 255;
+        }
+      }
+    }
+  }
+}
+
+bool checkCogs(const vpDot2Group &group, double offset_u, double offset_v, int skip = -1)
+{
+  for (unsigned int i = 0; i < group.getNbDots(); i++) {
+    if ((int)i == skip) {
+      if (group.isTracked(i)) {
+        std::cout << "Dot " << i << " should be lost" << std::endl;
+        return false;
+      }
+      continue;
+    }
+    if (!group.isTracked(i)) {
+      std::cout << "Dot " << i << " is lost" << std::endl;
+      return false;
+    }
+    vpImagePoint expected(60. + (i / nb_cols) * spacing + offset_v, 60. + (i % nb_cols) * spacing + offset_u);
+    if (vpImagePoint::distance(expected, group.getDot(i).getCog()) > 0.5) {
+      std::cout << "Dot " << i << " cog " << group.getDot(i).getCog() << " differs from expected " << expected
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool sameDot(const vpDot2 &d1, const vpDot2 &d2)
+{
+  return d1.getCog() == d2.getCog() && d1.getWidth() == d2.getWidth() && d1.getHeight() == d2.getHeight() &&
+         d1.getArea() == d2.getArea() && d1.getBBox() == d2.getBBox() && d1.m00 == d2.m00 && d1.m10 == d2.m10 &&
+         d1.m01 == d2.m01 && d1.m11 == d2.m11 && d1.m20 == d2.m20 && d1.m02 == d2.m02;
+}
+}
+
+int main()
+{
+  try {
+    vpImage<unsigned char> I(480, 640);
+    drawDots(I, 0, 0);
+
+    vpDot2Group group;
+    for (unsigned int i = 0; i < nb_rows * nb_cols; i++) {
+      vpDot2 d;
+      d.setGraphics(false);
+      d.initTracking(I, vpImagePoint(60. + (i / nb_cols) * spacing, 60. + (i % nb_cols) * spacing));
+      group.addDot(d);
+    }
+
+    // Small motion: all the dots are tracked from their previous position
+    drawDots(I, 3, 2);
+    unsigned int nb = group.track(I);
+    std::cout << "Small motion: " << nb << " dots tracked" << std::endl;
+    if (nb != group.getNbDots() || !checkCogs(group, 3, 2)) {
+      return EXIT_FAILURE;
+    }
+    for (unsigned int i = 0; i < group.getNbDots(); i++) {
+      if (group.getStatus(i) != vpDot2Group::DOT_TRACKED) {
+        std::cout << "Dot " << i << " should be tracked without search" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Large motion: the dots have to be searched in their window
+    drawDots(I, 20, 14);
+    nb = group.track(I);
+    std::cout << "Large motion: " << nb << " dots tracked" << std::endl;
+    if (nb != group.getNbDots() || !checkCogs(group, 20, 14)) {
+      return EXIT_FAILURE;
+    }
+
+    // Same motion without shared search
+    drawDots(I, 5, 5);
+    group.setSharedSearch(false);
+    nb = group.track(I);
+    std::cout << "Large motion (no shared search): " << nb << " dots tracked" << std::endl;
+    if (nb != group.getNbDots() || !checkCogs(group, 5, 5)) {
+      return EXIT_FAILURE;
+    }
+    group.setSharedSearch(true);
+
+    // A missing dot is reported as lost without exception
+    int missing = 13;
+    vpDot2 previous = group.getDot((unsigned int)missing);
+    drawDots(I, 5, 5, missing);
+    nb = group.track(I);
+    std::cout << "Missing dot: " << nb << " dots tracked" << std::endl;
+    if (nb != group.getNbDots() - 1 || !checkCogs(group, 5, 5, missing)) {
+      return EXIT_FAILURE;
+    }
+    // The lost dot keeps its parameters of the previous image
+    if (!sameDot(group.getDot((unsigned int)missing), previous)) {
+      std::cout << "The lost dot parameters changed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A dot with moments that disappears keeps its parameters
+    vpDot2 dot;
+    dot.setGraphics(false);
+    dot.setComputeMoments(true);
+    drawDots(I, 0, 0);
+    dot.initTracking(I, vpImagePoint(60., 60.));
+    vpDot2Group single;
+    single.addDot(dot);
+    I = 0;
+    if (single.track(I) != 0 || !sameDot(single.getDot(0), dot)) {
+      std::cout << "The disappeared dot parameters changed" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "vpDot2Group test succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
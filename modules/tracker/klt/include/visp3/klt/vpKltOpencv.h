@@ -103,9 +103,21 @@ public:
   void getFeature(const int &index, long &id, float &x, float &y) const;
   //! Get the list of current features.
   std::vector<cv::Point2f> getFeatures() const { return m_points[1]; }
+  /*!
+    Get a reference to the list of current features, without copy. The
+    referenced list is modified in place by the next call to track() or to a
+    method that sets the features.
+  */
+  const std::vector<cv::Point2f> &getFeaturesRef() const { return m_points[1]; }
   // CvPoint2D32f* getFeatures() const {return features;}
   //! Get the unique id of each feature.
   std::vector<long> getFeaturesId() const { return m_points_id; }
+  /*!
+    Get a reference to the unique id of each feature, without copy. The
+    referenced list is modified in place by the next call to track() or to a
+    method that sets the features.
+  */
+  const std::vector<long> &getFeaturesIdRef() const { return m_points_id; }
   // long* getFeaturesId() const {return featuresid;}
   //! Get the free parameter of the Harris detector.
   double getHarrisFreeParameter() const { return m_harris_k; }
@@ -123,6 +135,12 @@ public:
   // void getPrevFeature(int index, int &id, float &x, float &y) const;
   //! Get the list of previous features
   std::vector<cv::Point2f> getPrevFeatures() const { return m_points[0]; }
+  /*!
+    Get a reference to the list of previous features, without copy. The
+    referenced list is modified in place by the next call to track() or to a
+    method that sets the features.
+  */
+  const std::vector<cv::Point2f> &getPrevFeaturesRef() const { return m_points[0]; }
   // CvPoint2D32f* getPrevFeatures() const {return prev_features;}
   //! Get the list of features id
   // long* getPrevFeaturesId() const {return prev_featuresid;}
@@ -173,6 +191,11 @@ protected:
   int m_pyrMaxLevel;
   long m_next_points_id;
   bool m_initial_guess;
+  //! Pyramids of the previous [0] and current [1] images, swapped between
+  //! two calls to track() so that the pyramid of an image is built once
+  std::vector<cv::Mat> m_pyramid[2];
+  std::vector<uchar> m_status; //!< Tracking status of the keypoints
+  std::vector<float> m_err;    //!< Tracking error of the keypoints
 };
 
 #elif defined(VISP_HAVE_OPENCV)
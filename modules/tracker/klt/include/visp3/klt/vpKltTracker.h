@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Native pyramidal Lucas-Kanade feature tracker.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKltTracker.h
+  \brief Native pyramidal Lucas-Kanade (KLT) feature tracker working on
+  vpImage, without third party library.
+*/
+
+#ifndef vpKltTracker_h
+#define vpKltTracker_h
+
+#include <vector>
+
+#include <visp3/core/vpColor.h>
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+
+/*!
+  \class vpKltTracker
+  \ingroup module_klt
+
+  \brief Pyramidal Lucas-Kanade (KLT) feature tracker working directly on
+  vpImage<unsigned char>, available without OpenCV.
+
+  The class follows the interface of vpKltOpencv and the algorithm of the
+  OpenCV pyramidal Lucas-Kanade tracker:
+  - the image pyramids are built once per image and kept for the next call
+    to track(), where they are the pyramids of the previous image;
+  - the image gradients are computed with a Scharr kernel, vectorized with
+    SSE2 when available;
+  - the windows around the features are interpolated with fixed-point
+    bilinear weights;
+  - the features are tracked in parallel when ViSP is built with OpenMP
+    (see setNbThreads()).
+
+  A forward-backward check can be enabled with
+  setForwardBackwardThreshold(): each feature is tracked back from the new
+  image to the previous one, and is lost when it does not come back close to
+  its previous location.
+
+  The features are either given to initTracking(), or detected as the
+  corners with the largest minimal eigenvalue of the gradient covariance
+  matrix (Shi-Tomasi corners).
+
+  \code
+#include <visp3/klt/vpKltTracker.h>
+
+int main()
+{
+  vpImage<unsigned char> I;
+  // ... acquire the first image
+  vpKltTracker tracker;
+  tracker.setForwardBackwardThreshold(1.);
+  tracker.initTracking(I);
+  while (true) {
+    // ... acquire a new image
+    tracker.track(I);
+    for (int i = 0; i < tracker.getNbFeatures(); i++) {
+      long id;
+      float x, y;
+      tracker.getFeature(i, id, x, y);
+    }
+  }
+}
+  \endcode
+
+  vpMbKltTracker can use this tracker instead of vpKltOpencv to track its
+  points between two images (see vpMbKltTracker::setUseNativeKlt()). The
+  model-based tracker still requires OpenCV, since its points are detected by
+  vpKltOpencv and given back to it.
+*/
+class VISP_EXPORT vpKltTracker
+{
+public:
+  vpKltTracker();
+  virtual ~vpKltTracker() {}
+
+  void addFeature(const float &x, const float &y);
+  void addFeature(const long &id, const float &x, const float &y);
+
+  void display(const vpImage<unsigned char> &I, const vpColor &color = vpColor::red,
+               unsigned int thickness = 1) const;
+
+  /*!
+    Get the displacement in pixels under which the iterations at a pyramid
+    level stop.
+  */
+  double getEpsilon() const { return m_epsilon; }
+  void getFeature(const int &index, long &id, float &x, float &y) const;
+  //! Get the list of current features.
+  const std::vector<vpImagePoint> &getFeatures() const { return m_points[1]; }
+  //! Get the unique id of each current feature.
+  const std::vector<long> &getFeaturesId() const { return m_points_id; }
+  /*!
+    Get the distance in pixels above which a feature tracked back to the
+    previous image is lost, 0 if the forward-backward check is disabled.
+  */
+  double getForwardBackwardThreshold() const { return m_fbThreshold; }
+  //! Get the maximum number of features detected by initTracking().
+  int getMaxFeatures() const { return m_maxCount; }
+  //! Get the maximal number of iterations per pyramid level.
+  int getMaxIterations() const { return m_maxIterations; }
+  //! Get the minimal distance between the detected features.
+  double getMinDistance() const { return m_minDistance; }
+  //! Get the minimal eigenvalue threshold under which a feature is lost.
+  double getMinEigThreshold() const { return m_minEigThreshold; }
+  //! Get the number of current features.
+  int getNbFeatures() const { return (int)m_points[1].size(); }
+  //! Get the number of previous features.
+  int getNbPrevFeatures() const { return (int)m_points[0].size(); }
+  /*!
+    Get the number of threads used to track the features, 0 to let OpenMP
+    choose.
+  */
+  int getNbThreads() const { return m_nbThreads; }
+  //! Get the list of previous features.
+  const std::vector<vpImagePoint> &getPrevFeatures() const { return m_points[0]; }
+  //! Get the maximal pyramid level.
+  int getPyramidLevels() const { return m_pyrMaxLevel; }
+  //! Get the quality of the detected features.
+  double getQuality() const { return m_qualityLevel; }
+  //! Get the size of the window used to track the features.
+  int getWindowSize() const { return m_winSize; }
+
+  void initTracking(const vpImage<unsigned char> &I, const vpImage<bool> *mask = NULL);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts);
+  void initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                    const std::vector<long> &ids);
+
+  void setEpsilon(double epsilon);
+  void setForwardBackwardThreshold(double threshold);
+  void setInitialGuess(const std::vector<vpImagePoint> &guess_pts);
+  void setInitialGuess(const std::vector<vpImagePoint> &init_pts, const std::vector<vpImagePoint> &guess_pts,
+                       const std::vector<long> &fid);
+  /*!
+    Set the maximum number of features detected by initTracking(). By
+    default 500.
+  */
+  void setMaxFeatures(const int maxCount) { m_maxCount = maxCount; }
+  void setMaxIterations(const int maxIterations);
+  /*!
+    Set the minimal Euclidean distance between the detected features. By
+    default 15 pixels.
+  */
+  void setMinDistance(double minDistance) { m_minDistance = minDistance; }
+  /*!
+    Set the threshold on the minimal eigenvalue of the normalized gradient
+    covariance matrix of a window, under which the feature is lost. By
+    default 1e-4.
+  */
+  void setMinEigThreshold(double minEigThreshold) { m_minEigThreshold = minEigThreshold; }
+  /*!
+    Set the number of threads used to track the features. A value of 0 lets
+    OpenMP choose the number of threads. This parameter is only used when
+    ViSP is built with OpenMP.
+  */
+  void setNbThreads(int nbThreads) { m_nbThreads = nbThreads; }
+  void setPyramidLevels(const int pyrMaxLevel);
+  /*!
+    Set the quality of the detected features: the corners whose minimal
+    eigenvalue is lower than the quality times the largest one are
+    rejected. By default 0.01.
+  */
+  void setQuality(double qualityLevel) { m_qualityLevel = qualityLevel; }
+  void setWindowSize(const int winSize);
+
+  void suppressFeature(const int &index);
+
+  void track(const vpImage<unsigned char> &I);
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  //! Level of a pyramid, with a border around the image and its gradients
+  struct vpLevel {
+    unsigned int width;
+    unsigned int height;
+    unsigned int border;
+    unsigned int stride;
+    //! Image with a reflected border
+    std::vector<unsigned char> image;
+    //! Interleaved Scharr gradients along u and v, null in the border
+    std::vector<short> gradient;
+  };
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+  void buildPyramid(const vpImage<unsigned char> &I, std::vector<vpLevel> &pyramid) const;
+  void computeGradient(vpLevel &level) const;
+  void detectFeatures(const vpImage<bool> *mask);
+  bool trackFeature(const std::vector<vpLevel> &prevPyramid, const std::vector<vpLevel> &nextPyramid,
+                    const vpImagePoint &prevPoint, const vpImagePoint &guess, vpImagePoint &nextPoint,
+                    short *buffer) const;
+
+  //! Previous [0] and current [1] feature locations
+  std::vector<vpImagePoint> m_points[2];
+  //! Feature ids
+  std::vector<long> m_points_id;
+  int m_maxCount;
+  int m_winSize;
+  int m_maxIterations;
+  double m_epsilon;
+  double m_qualityLevel;
+  double m_minDistance;
+  double m_minEigThreshold;
+  int m_pyrMaxLevel;
+  double m_fbThreshold;
+  int m_nbThreads;
+  long m_next_points_id;
+  bool m_initial_guess;
+  //! Pyramids of the previous [0] and current [1] images
+  std::vector<vpLevel> m_pyramid[2];
+  //! Tracking status of the features
+  std::vector<unsigned char> m_status;
+  //! Window buffers of the threads
+  std::vector<short> m_buffers;
+};
+
+#endif
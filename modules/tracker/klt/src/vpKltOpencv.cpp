@@ -61,7 +61,7 @@
 vpKltOpencv::vpKltOpencv()
   : m_gray(), m_prevGray(), m_points_id(), m_maxCount(500), m_termcrit(), m_winSize(10), m_qualityLevel(0.01),
     m_minDistance(15), m_minEigThreshold(1e-4), m_harris_k(0.04), m_blockSize(3), m_useHarrisDetector(1),
-    m_pyrMaxLevel(3), m_next_points_id(0), m_initial_guess(false)
+    m_pyrMaxLevel(3), m_next_points_id(0), m_initial_guess(false), m_status(), m_err()
 {
   m_termcrit = cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 20, 0.03);
 }
@@ -72,7 +72,7 @@ vpKltOpencv::vpKltOpencv()
 vpKltOpencv::vpKltOpencv(const vpKltOpencv &copy)
   : m_gray(), m_prevGray(), m_points_id(), m_maxCount(500), m_termcrit(), m_winSize(10), m_qualityLevel(0.01),
     m_minDistance(15), m_minEigThreshold(1e-4), m_harris_k(0.04), m_blockSize(3), m_useHarrisDetector(1),
-    m_pyrMaxLevel(3), m_next_points_id(0), m_initial_guess(false)
+    m_pyrMaxLevel(3), m_next_points_id(0), m_initial_guess(false), m_status(), m_err()
 {
   *this = copy;
 }
@@ -99,6 +99,9 @@ vpKltOpencv &vpKltOpencv::operator=(const vpKltOpencv &copy)
   m_pyrMaxLevel = copy.m_pyrMaxLevel;
   m_next_points_id = copy.m_next_points_id;
   m_initial_guess = copy.m_initial_guess;
+  // The pyramids are built again from the copied images
+  m_pyramid[0].clear();
+  m_pyramid[1].clear();
 
   return *this;
 }
@@ -117,10 +120,12 @@ vpKltOpencv::~vpKltOpencv() {}
 */
 void vpKltOpencv::initTracking(const cv::Mat &I, const cv::Mat &mask)
 {
+  m_initial_guess = false;
   m_next_points_id = 0;
 
   // cvtColor(I, m_gray, cv::COLOR_BGR2GRAY);
   I.copyTo(m_gray);
+  m_pyramid[1].clear();
 
   for (size_t i = 0; i < 2; i++) {
     m_points[i].clear();
@@ -142,6 +147,11 @@ void vpKltOpencv::initTracking(const cv::Mat &I, const cv::Mat &mask)
 /*!
    Track KLT keypoints using the iterative Lucas-Kanade method with pyramids.
 
+   The pyramid of the image is kept for the next call, where it is the
+   pyramid of the previous image, so that only one pyramid is built per
+   image. The pyramids, the tracking status and the keypoint vectors reuse
+   their memory from one image to the next.
+
    \param I : Input image.
  */
 void vpKltOpencv::track(const cv::Mat &I)
@@ -149,10 +159,10 @@ void vpKltOpencv::track(const cv::Mat &I)
   if (m_points[1].size() == 0)
     throw vpTrackingException(vpTrackingException::fatalError, "Not enough key points to track.");
 
-  std::vector<float> err;
   int flags = 0;
 
   cv::swap(m_prevGray, m_gray);
+  m_pyramid[0].swap(m_pyramid[1]);
 
   if (m_initial_guess) {
     flags |= cv::OPTFLOW_USE_INITIAL_FLOW;
@@ -166,21 +176,31 @@ void vpKltOpencv::track(const cv::Mat &I)
 
   if (m_prevGray.empty()) {
     m_gray.copyTo(m_prevGray);
+    m_pyramid[0].clear();
   }
 
-  std::vector<uchar> status;
+  cv::Size winSize(m_winSize, m_winSize);
+  if (m_pyramid[0].empty()) {
+    cv::buildOpticalFlowPyramid(m_prevGray, m_pyramid[0], winSize, m_pyrMaxLevel);
+  }
+  cv::buildOpticalFlowPyramid(m_gray, m_pyramid[1], winSize, m_pyrMaxLevel);
 
-  cv::calcOpticalFlowPyrLK(m_prevGray, m_gray, m_points[0], m_points[1], status, err, cv::Size(m_winSize, m_winSize),
+  cv::calcOpticalFlowPyrLK(m_pyramid[0], m_pyramid[1], m_points[0], m_points[1], m_status, m_err, winSize,
                            m_pyrMaxLevel, m_termcrit, flags, m_minEigThreshold);
 
-  // Remove points that are lost
-  for (int i = (int)status.size() - 1; i >= 0; i--) {
-    if (status[(size_t)i] == 0) { // point is lost
-      m_points[0].erase(m_points[0].begin() + i);
-      m_points[1].erase(m_points[1].begin() + i);
-      m_points_id.erase(m_points_id.begin() + i);
+  // Remove points that are lost, keeping the order of the others
+  size_t nbTracked = 0;
+  for (size_t i = 0; i < m_status.size(); i++) {
+    if (m_status[i] != 0) {
+      m_points[0][nbTracked] = m_points[0][i];
+      m_points[1][nbTracked] = m_points[1][i];
+      m_points_id[nbTracked] = m_points_id[i];
+      nbTracked++;
     }
   }
+  m_points[0].resize(nbTracked);
+  m_points[1].resize(nbTracked);
+  m_points_id.resize(nbTracked);
 }
 
 /*!
@@ -340,7 +360,13 @@ void vpKltOpencv::setMaxFeatures(const int maxCount) { m_maxCount = maxCount; }
   is set to 10. For example, if \e winSize=5 , then a 5*2+1 \f$\times\f$ 5*2+1
   = 11 \f$\times\f$ 11 search window is used.
 */
-void vpKltOpencv::setWindowSize(const int winSize) { m_winSize = winSize; }
+void vpKltOpencv::setWindowSize(const int winSize)
+{
+  m_winSize = winSize;
+  // The border of the pyramids depends on the window size
+  m_pyramid[0].clear();
+  m_pyramid[1].clear();
+}
 
 /*!
   Set the parameter characterizing the minimal accepted quality of image
@@ -406,7 +432,12 @@ void vpKltOpencv::setBlockSize(const int blockSize) { m_blockSize = blockSize; }
   pyramids are not used (single level), if set to 1, two levels are used, and
   so on. Default value is set to 3.
 */
-void vpKltOpencv::setPyramidLevels(const int pyrMaxLevel) { m_pyrMaxLevel = pyrMaxLevel; }
+void vpKltOpencv::setPyramidLevels(const int pyrMaxLevel)
+{
+  m_pyrMaxLevel = pyrMaxLevel;
+  m_pyramid[0].clear();
+  m_pyramid[1].clear();
+}
 
 /*!
   Set the points that will be used as initial guess during the next call to
@@ -482,6 +513,7 @@ void vpKltOpencv::initTracking(const cv::Mat &I, const std::vector<cv::Point2f>
   }
 
   I.copyTo(m_gray);
+  m_pyramid[1].clear();
 }
 
 void vpKltOpencv::initTracking(const cv::Mat &I, const std::vector<cv::Point2f> &pts, const std::vector<long> &ids)
@@ -505,6 +537,7 @@ void vpKltOpencv::initTracking(const cv::Mat &I, const std::vector<cv::Point2f>
   }
 
   I.copyTo(m_gray);
+  m_pyramid[1].clear();
 }
 
 /*!
@@ -0,0 +1,890 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Native pyramidal Lucas-Kanade feature tracker.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+
+#include <visp3/core/vpDisplay.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTrackingException.h>
+#include <visp3/klt/vpKltTracker.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
+#ifdef VISP_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Number of fractional bits of the bilinear weights
+const int W_BITS = 14;
+// Scale of the sums of products of gradients stored with 5 fractional bits
+const float FLT_SCALE = 1.f / (1 << 20);
+
+inline int descale(int x, int n) { return (x + (1 << (n - 1))) >> n; }
+
+// Index of a pixel in [0, n[ with the border reflected without duplicating
+// the edge pixels (gfedcb|abcdefgh|gfedcba)
+int reflect101(int i, int n)
+{
+  if (n == 1) {
+    return 0;
+  }
+  while (i < 0 || i >= n) {
+    i = i < 0 ? -i : 2 * n - 2 - i;
+  }
+  return i;
+}
+
+// Fill the border of an image whose pixels are stored from data + border *
+// (stride + 1)
+void fillBorder(unsigned char *data, int width, int height, int border, int stride)
+{
+  for (int y = 0; y < height; y++) {
+    unsigned char *row = data + (y + border) * stride + border;
+    for (int x = 1; x <= border; x++) {
+      row[-x] = row[reflect101(-x, width)];
+      row[width - 1 + x] = row[reflect101(width - 1 + x, width)];
+    }
+  }
+  for (int y = 1; y <= border; y++) {
+    std::copy(data + (reflect101(-y, height) + border) * stride, data + (reflect101(-y, height) + border + 1) * stride,
+              data + (border - y) * stride);
+    int src = reflect101(height - 1 + y, height) + border;
+    std::copy(data + src * stride, data + (src + 1) * stride, data + (height - 1 + y + border) * stride);
+  }
+}
+
+// Candidate feature of the corner detector
+struct vpCorner {
+  float eig;
+  int x;
+  int y;
+};
+
+bool cornerOrder(const vpCorner &a, const vpCorner &b)
+{
+  return a.eig > b.eig || (a.eig == b.eig && (a.y < b.y || (a.y == b.y && a.x < b.x)));
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor.
+*/
+vpKltTracker::vpKltTracker()
+  : m_points_id(), m_maxCount(500), m_winSize(10), m_maxIterations(20), m_epsilon(0.03), m_qualityLevel(0.01),
+    m_minDistance(15), m_minEigThreshold(1e-4), m_pyrMaxLevel(3), m_fbThreshold(0.), m_nbThreads(0),
+    m_next_points_id(0), m_initial_guess(false), m_status(), m_buffers()
+{
+}
+
+/*!
+  Add a feature at the end of the feature list, with a new id.
+
+  \param x,y : Coordinates of the feature in the image.
+*/
+void vpKltTracker::addFeature(const float &x, const float &y)
+{
+  m_points[1].push_back(vpImagePoint(y, x));
+  m_points_id.push_back(m_next_points_id++);
+}
+
+/*!
+  Add a feature at the end of the feature list.
+
+  \warning This function doesn't ensure that the id of the feature is unique.
+
+  \param id : Feature id. Should be unique.
+  \param x,y : Coordinates of the feature in the image.
+*/
+void vpKltTracker::addFeature(const long &id, const float &x, const float &y)
+{
+  m_points[1].push_back(vpImagePoint(y, x));
+  m_points_id.push_back(id);
+}
+
+/*!
+  Build the pyramid of an image, reusing the memory of the levels.
+
+  The levels are built down to the maximal pyramid level, or down to the
+  size of the window. Each level is stored with a reflected border wider
+  than the window so that the windows partially outside the image are
+  interpolated without bound checks.
+*/
+void vpKltTracker::buildPyramid(const vpImage<unsigned char> &I, std::vector<vpLevel> &pyramid) const
+{
+  unsigned int width = I.getWidth(), height = I.getHeight();
+  size_t nbLevels = 1;
+  while ((int)nbLevels <= m_pyrMaxLevel) {
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+    if (width <= (unsigned int)m_winSize || height <= (unsigned int)m_winSize) {
+      break;
+    }
+    nbLevels++;
+  }
+
+  pyramid.resize(nbLevels);
+  width = I.getWidth();
+  height = I.getHeight();
+  for (size_t l = 0; l < nbLevels; l++) {
+    vpLevel &level = pyramid[l];
+    level.width = width;
+    level.height = height;
+    level.border = (unsigned int)m_winSize + 2;
+    level.stride = width + 2 * level.border;
+    level.image.resize((size_t)level.stride * (height + 2 * level.border));
+    level.gradient.resize(2 * level.image.size());
+    unsigned char *dst = &level.image[0] + level.border * (level.stride + 1);
+
+    if (l == 0) {
+      for (unsigned int y = 0; y < height; y++) {
+        std::copy(I[y], I[y] + width, dst + y * level.stride);
+      }
+    } else {
+      // Gaussian 5x5 kernel [1 4 6 4 1]^T [1 4 6 4 1] / 256 on the even
+      // pixels of the previous level, whose border is already filled
+      const vpLevel &src = pyramid[l - 1];
+      const int srcStride = (int)src.stride;
+      const int w = (int)width, h = (int)height;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+      {
+        std::vector<int> row((size_t)src.width + 4);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int y = 0; y < h; y++) {
+          const unsigned char *r2 = &src.image[0] + (2 * y + src.border) * srcStride + src.border;
+          const unsigned char *r0 = r2 - 2 * srcStride, *r1 = r2 - srcStride;
+          const unsigned char *r3 = r2 + srcStride, *r4 = r2 + 2 * srcStride;
+          int *t = &row[2];
+          for (int x = -2; x < 2 * w + 1 && x < (int)src.width + 2; x++) {
+            t[x] = r0[x] + r4[x] + 4 * (r1[x] + r3[x]) + 6 * r2[x];
+          }
+          unsigned char *d = dst + y * level.stride;
+          for (int x = 0; x < w; x++) {
+            const int *c = t + 2 * x;
+            d[x] = (unsigned char)((c[-2] + c[2] + 4 * (c[-1] + c[1]) + 6 * c[0] + 128) >> 8);
+          }
+        }
+      }
+    }
+    fillBorder(&level.image[0], (int)width, (int)height, (int)level.border, (int)level.stride);
+    computeGradient(level);
+
+    width = (width + 1) / 2;
+    height = (height + 1) / 2;
+  }
+}
+
+/*!
+  Compute the Scharr gradients of a pyramid level with the separable kernels
+  [3 10 3]^T [-1 0 1] and [-1 0 1]^T [3 10 3]. The gradients are null in the
+  border.
+*/
+void vpKltTracker::computeGradient(vpLevel &level) const
+{
+  const int w = (int)level.width, h = (int)level.height;
+  const int border = (int)level.border, stride = (int)level.stride;
+  short *grad = &level.gradient[0];
+  std::fill(grad, grad + 2 * border * stride, (short)0);
+  std::fill(grad + 2 * (h + border) * stride, grad + level.gradient.size(), (short)0);
+  for (int y = border; y < h + border; y++) {
+    std::fill(grad + 2 * y * stride, grad + 2 * (y * stride + border), (short)0);
+    std::fill(grad + 2 * (y * stride + border + w), grad + 2 * (y + 1) * stride, (short)0);
+  }
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+    // Vertical smoothing and derivative of the row, from x = -1 to x = w
+    std::vector<short> buffer(2 * ((size_t)w + 2));
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int y = 0; y < h; y++) {
+      const unsigned char *b = &level.image[0] + (y + border) * stride + border - 1;
+      const unsigned char *a = b - stride, *c = b + stride;
+      short *s = &buffer[0], *d = s + w + 2;
+      int x = 0;
+#if VISP_HAVE_SSE2
+      const __m128i zero = _mm_setzero_si128(), three = _mm_set1_epi16(3), ten = _mm_set1_epi16(10);
+      for (; x + 8 <= w + 2; x += 8) {
+        __m128i va = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(a + x)), zero);
+        __m128i vb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(b + x)), zero);
+        __m128i vc = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(c + x)), zero);
+        __m128i vs = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(va, vc), three), _mm_mullo_epi16(vb, ten));
+        _mm_storeu_si128((__m128i *)(s + x), vs);
+        _mm_storeu_si128((__m128i *)(d + x), _mm_sub_epi16(vc, va));
+      }
+#endif
+      for (; x < w + 2; x++) {
+        s[x] = (short)(3 * (a[x] + c[x]) + 10 * b[x]);
+        d[x] = (short)(c[x] - a[x]);
+      }
+
+      // Horizontal derivative and smoothing, interleaved in the gradient
+      short *g = grad + 2 * ((y + border) * stride + border);
+      x = 0;
+#if VISP_HAVE_SSE2
+      for (; x + 8 <= w; x += 8) {
+        __m128i ix = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(s + x + 2)),
+                                   _mm_loadu_si128((const __m128i *)(s + x)));
+        __m128i dl = _mm_loadu_si128((const __m128i *)(d + x));
+        __m128i dc = _mm_loadu_si128((const __m128i *)(d + x + 1));
+        __m128i dr = _mm_loadu_si128((const __m128i *)(d + x + 2));
+        __m128i iy = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(dl, dr), three), _mm_mullo_epi16(dc, ten));
+        _mm_storeu_si128((__m128i *)(g + 2 * x), _mm_unpacklo_epi16(ix, iy));
+        _mm_storeu_si128((__m128i *)(g + 2 * x + 8), _mm_unpackhi_epi16(ix, iy));
+      }
+#endif
+      for (; x < w; x++) {
+        g[2 * x] = (short)(s[x + 2] - s[x]);
+        g[2 * x + 1] = (short)(3 * (d[x] + d[x + 2]) + 10 * d[x + 1]);
+      }
+    }
+  }
+}
+
+/*!
+  Detect the features of the current image as the local maxima of the
+  minimal eigenvalue of the gradient covariance matrix over 3x3 blocks.
+*/
+void vpKltTracker::detectFeatures(const vpImage<bool> *mask)
+{
+  const vpLevel &level = m_pyramid[1][0];
+  const int w = (int)level.width, h = (int)level.height;
+  if (mask != NULL && (mask->getWidth() != level.width || mask->getHeight() != level.height)) {
+    throw vpException(vpException::dimensionError, "Mask size %dx%d differs from the image size %dx%d",
+                      mask->getWidth(), mask->getHeight(), w, h);
+  }
+  if (w < 5 || h < 5 || m_maxCount <= 0) {
+    return;
+  }
+
+  // Products of the gradients from x = -1 to x = w, then their vertical and
+  // horizontal sums over 3 pixels. The gradients are null outside the image.
+  const int pw = w + 2;
+  std::vector<float> products(3 * (size_t)pw * (h + 2)), sums(3 * (size_t)pw);
+  const int border = (int)level.border, stride = (int)level.stride;
+  for (int y = -1; y <= h; y++) {
+    const short *g = &level.gradient[0] + 2 * ((y + border) * stride + border - 1);
+    float *p = &products[3 * (size_t)(y + 1) * pw];
+    for (int x = 0; x < pw; x++) {
+      float gx = g[2 * x], gy = g[2 * x + 1];
+      p[3 * x] = gx * gx;
+      p[3 * x + 1] = gx * gy;
+      p[3 * x + 2] = gy * gy;
+    }
+  }
+
+  std::vector<float> eig((size_t)w * h);
+  float maxEig = 0.f;
+  for (int y = 0; y < h; y++) {
+    const float *p0 = &products[3 * (size_t)y * pw], *p1 = p0 + 3 * pw, *p2 = p1 + 3 * pw;
+    for (int k = 0; k < 3 * pw; k++) {
+      sums[k] = p0[k] + p1[k] + p2[k];
+    }
+    for (int x = 0; x < w; x++) {
+      const float *c = &sums[3 * x];
+      float a = c[0] + c[3] + c[6], b = c[1] + c[4] + c[7], d = c[2] + c[5] + c[8];
+      float e = 0.5f * (a + d - std::sqrt((a - d) * (a - d) + 4.f * b * b));
+      eig[(size_t)y * w + x] = e;
+      maxEig = std::max(maxEig, e);
+    }
+  }
+  if (maxEig <= 0.f) {
+    return;
+  }
+
+  // Local maxima above the quality threshold, whose block does not overlap
+  // the border of the image
+  const float threshold = (float)(m_qualityLevel * maxEig);
+  std::vector<vpCorner> corners;
+  for (int y = 2; y < h - 2; y++) {
+    const float *e = &eig[(size_t)y * w];
+    for (int x = 2; x < w - 2; x++) {
+      float v = e[x];
+      if (v <= threshold || (mask != NULL && !(*mask)[y][x])) {
+        continue;
+      }
+      if (v >= e[x - 1] && v >= e[x + 1] && v >= e[x - w - 1] && v >= e[x - w] && v >= e[x - w + 1] &&
+          v >= e[x + w - 1] && v >= e[x + w] && v >= e[x + w + 1]) {
+        vpCorner corner;
+        corner.eig = v;
+        corner.x = x;
+        corner.y = y;
+        corners.push_back(corner);
+      }
+    }
+  }
+  std::sort(corners.begin(), corners.end(), cornerOrder);
+
+  // Strongest corners at the minimal distance of each other, found in a grid
+  // of cells of the size of the minimal distance
+  const double cellSize = std::max(m_minDistance, 1.);
+  const double minDist2 = m_minDistance * m_minDistance;
+  const int gridCols = (int)(w / cellSize) + 1, gridRows = (int)(h / cellSize) + 1;
+  std::vector<std::vector<size_t> > grid((size_t)gridCols * gridRows);
+  for (size_t i = 0; i < corners.size() && (int)m_points[1].size() < m_maxCount; i++) {
+    const vpCorner &corner = corners[i];
+    int cx = (int)(corner.x / cellSize), cy = (int)(corner.y / cellSize);
+    bool accepted = true;
+    for (int gy = std::max(cy - 1, 0); gy <= std::min(cy + 1, gridRows - 1) && accepted; gy++) {
+      for (int gx = std::max(cx - 1, 0); gx <= std::min(cx + 1, gridCols - 1) && accepted; gx++) {
+        const std::vector<size_t> &cell = grid[(size_t)gy * gridCols + gx];
+        for (size_t k = 0; k < cell.size(); k++) {
+          double du = m_points[1][cell[k]].get_u() - corner.x, dv = m_points[1][cell[k]].get_v() - corner.y;
+          if (du * du + dv * dv < minDist2) {
+            accepted = false;
+            break;
+          }
+        }
+      }
+    }
+    if (accepted) {
+      grid[(size_t)cy * gridCols + cx].push_back(m_points[1].size());
+      m_points[1].push_back(vpImagePoint(corner.y, corner.x));
+      m_points_id.push_back(m_next_points_id++);
+    }
+  }
+}
+
+/*!
+  Display the current features.
+
+  \param I : Image used as background. Display should be initialized on it.
+  \param color : Color used to display the features.
+  \param thickness : Thickness of the drawings.
+*/
+void vpKltTracker::display(const vpImage<unsigned char> &I, const vpColor &color, unsigned int thickness) const
+{
+  for (size_t i = 0; i < m_points[1].size(); i++) {
+    vpImagePoint ip(vpMath::round(m_points[1][i].get_v()), vpMath::round(m_points[1][i].get_u()));
+    vpDisplay::displayCross(I, ip, 10 + thickness, color, thickness);
+    char id[10];
+    sprintf(id, "%ld", m_points_id[i]);
+    ip.set_u(ip.get_u() + 5);
+    vpDisplay::displayText(I, ip, id, color);
+  }
+}
+
+/*!
+  Get the 'index'th feature image coordinates. Beware that
+  getFeature(i,...) may not represent the same feature before and
+  after a tracking iteration (if a feature is lost, features are
+  shifted in the array).
+
+  \param index : Index of feature.
+  \param id : id of the feature.
+  \param x : x coordinate.
+  \param y : y coordinate.
+*/
+void vpKltTracker::getFeature(const int &index, long &id, float &x, float &y) const
+{
+  if (index < 0 || (size_t)index >= m_points[1].size()) {
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  x = (float)m_points[1][(size_t)index].get_u();
+  y = (float)m_points[1][(size_t)index].get_v();
+  id = m_points_id[(size_t)index];
+}
+
+/*!
+  Initialise the tracking by detecting the features of an image.
+
+  \param I : Input image.
+  \param mask : Image mask used to restrict the detection. The features are
+  only detected where the mask is true. If NULL, the features are detected in
+  the whole image.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const vpImage<bool> *mask)
+{
+  m_initial_guess = false;
+  m_next_points_id = 0;
+  for (size_t i = 0; i < 2; i++) {
+    m_points[i].clear();
+  }
+  m_points_id.clear();
+
+  buildPyramid(I, m_pyramid[1]);
+  detectFeatures(mask);
+}
+
+/*!
+  Initialise the tracking with a list of features.
+
+  \param I : Input image.
+  \param pts : Features to track in the next images.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts)
+{
+  std::vector<long> ids;
+  initTracking(I, pts, ids);
+}
+
+/*!
+  Initialise the tracking with a list of features and their ids.
+
+  \param I : Input image.
+  \param pts : Features to track in the next images.
+  \param ids : Ids of the features. If the size of this vector differs from
+  the number of features, new ids are given to the features.
+*/
+void vpKltTracker::initTracking(const vpImage<unsigned char> &I, const std::vector<vpImagePoint> &pts,
+                                const std::vector<long> &ids)
+{
+  m_initial_guess = false;
+  m_points[0].clear();
+  m_points[1] = pts;
+  m_points_id.clear();
+
+  if (ids.size() != pts.size()) {
+    m_next_points_id = 0;
+    for (size_t i = 0; i < m_points[1].size(); i++)
+      m_points_id.push_back(m_next_points_id++);
+  } else {
+    long max = 0;
+    for (size_t i = 0; i < m_points[1].size(); i++) {
+      m_points_id.push_back(ids[i]);
+      if (ids[i] > max)
+        max = ids[i];
+    }
+    m_next_points_id = max + 1;
+  }
+
+  buildPyramid(I, m_pyramid[1]);
+}
+
+/*!
+  Set the displacement in pixels under which the iterations at a pyramid
+  level stop. By default 0.03.
+
+  \exception vpException::badValue : The displacement is negative.
+*/
+void vpKltTracker::setEpsilon(double epsilon)
+{
+  if (epsilon < 0.) {
+    throw vpException(vpException::badValue, "Bad epsilon: %f", epsilon);
+  }
+  m_epsilon = epsilon;
+}
+
+/*!
+  Enable the forward-backward check of the tracked features: each feature is
+  tracked back from the new image to the previous one, and is lost when it
+  comes back farther than \e threshold pixels from its previous location.
+  The check doubles the tracking time. By default 0, which disables the
+  check.
+
+  \exception vpException::badValue : The threshold is negative.
+*/
+void vpKltTracker::setForwardBackwardThreshold(double threshold)
+{
+  if (threshold < 0.) {
+    throw vpException(vpException::badValue, "Bad forward-backward threshold: %f", threshold);
+  }
+  m_fbThreshold = threshold;
+}
+
+/*!
+  Set the locations in the next image from which the current features are
+  searched by the next call to track(). A typical usage of this function is
+  to predict the position of the features from the motion of the camera.
+
+  \param guess_pts : Predicted locations of the features. The size of this
+  vector has to be the number of features. The ids of the features are not
+  modified.
+*/
+void vpKltTracker::setInitialGuess(const std::vector<vpImagePoint> &guess_pts)
+{
+  if (guess_pts.size() != m_points[1].size()) {
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size feature vector [%d] "
+                      "and guess vector [%d] doesn't match",
+                      m_points[1].size(), guess_pts.size()));
+  }
+
+  m_points[0] = m_points[1];
+  m_points[1] = guess_pts;
+  m_initial_guess = true;
+}
+
+/*!
+  Set the features of the current image and their predicted locations in the
+  next image, used by the next call to track().
+
+  \param init_pts : Features of the current image.
+  \param guess_pts : Predicted locations of the features. The size of this
+  vector must be the same as the size of the vector of features.
+  \param fid : Identifiers of the features.
+*/
+void vpKltTracker::setInitialGuess(const std::vector<vpImagePoint> &init_pts,
+                                   const std::vector<vpImagePoint> &guess_pts, const std::vector<long> &fid)
+{
+  if (guess_pts.size() != init_pts.size() || fid.size() != init_pts.size()) {
+    throw(vpException(vpException::badValue,
+                      "Cannot set initial guess: size init vector [%d], "
+                      "guess vector [%d] and id vector [%d] don't match",
+                      init_pts.size(), guess_pts.size(), fid.size()));
+  }
+
+  m_points[0] = init_pts;
+  m_points[1] = guess_pts;
+  m_points_id = fid;
+  m_initial_guess = true;
+}
+
+/*!
+  Set the maximal number of iterations per pyramid level. By default 20.
+
+  \exception vpException::badValue : The number is not positive.
+*/
+void vpKltTracker::setMaxIterations(const int maxIterations)
+{
+  if (maxIterations <= 0) {
+    throw vpException(vpException::badValue, "Bad maximal number of iterations: %d", maxIterations);
+  }
+  m_maxIterations = maxIterations;
+}
+
+/*!
+  Set the maximal pyramid level. If the level is zero, then no pyramid is
+  computed for the optical flow.
+
+  \param pyrMaxLevel : 0-based maximal pyramid level number; if set to 0,
+  pyramids are not used (single level), if set to 1, two levels are used, and
+  so on. Default value is set to 3.
+
+  \exception vpException::badValue : The level is negative.
+*/
+void vpKltTracker::setPyramidLevels(const int pyrMaxLevel)
+{
+  if (pyrMaxLevel < 0) {
+    throw vpException(vpException::badValue, "Bad maximal pyramid level: %d", pyrMaxLevel);
+  }
+  m_pyrMaxLevel = pyrMaxLevel;
+}
+
+/*!
+  Set the size of the window used to track the features. By default 10, for
+  a window of 10x10 pixels.
+
+  \exception vpException::badValue : The size is lower than 3.
+*/
+void vpKltTracker::setWindowSize(const int winSize)
+{
+  if (winSize < 3) {
+    throw vpException(vpException::badValue, "Bad window size: %d", winSize);
+  }
+  m_winSize = winSize;
+}
+
+/*!
+  Remove a feature from the list of current features.
+
+  \param index : Index of the feature to remove.
+*/
+void vpKltTracker::suppressFeature(const int &index)
+{
+  if (index < 0 || (size_t)index >= m_points[1].size()) {
+    throw(vpException(vpException::badValue, "Feature [%d] doesn't exist", index));
+  }
+
+  m_points[1].erase(m_points[1].begin() + index);
+  m_points_id.erase(m_points_id.begin() + index);
+  if ((size_t)index < m_points[0].size()) {
+    m_points[0].erase(m_points[0].begin() + index);
+  }
+}
+
+/*!
+  Track the features in a new image with the iterative Lucas-Kanade method
+  with pyramids.
+
+  The features are lost when their window leaves the image, when the
+  gradients of their window are too weak (see setMinEigThreshold()), or
+  when they fail the forward-backward check (see
+  setForwardBackwardThreshold()). The lost features are removed, the order
+  of the others is kept.
+
+  \param I : New image, of the same size as the previous one.
+
+  \exception vpTrackingException::fatalError : There is no feature to track.
+  \exception vpTrackingException::initializationError : initTracking() was
+  not called.
+  \exception vpException::dimensionError : The size of the image changed.
+*/
+void vpKltTracker::track(const vpImage<unsigned char> &I)
+{
+  if (m_points[1].size() == 0) {
+    throw vpTrackingException(vpTrackingException::fatalError, "Not enough key points to track.");
+  }
+  if (m_pyramid[1].empty()) {
+    throw vpTrackingException(vpTrackingException::initializationError, "The tracking is not initialized.");
+  }
+  if (I.getWidth() != m_pyramid[1][0].width || I.getHeight() != m_pyramid[1][0].height) {
+    throw vpException(vpException::dimensionError, "Image size %dx%d differs from the previous image size %dx%d",
+                      I.getWidth(), I.getHeight(), m_pyramid[1][0].width, m_pyramid[1][0].height);
+  }
+
+  m_pyramid[0].swap(m_pyramid[1]);
+  buildPyramid(I, m_pyramid[1]);
+  if (m_pyramid[0][0].border != m_pyramid[1][0].border || m_pyramid[0].size() != m_pyramid[1].size()) {
+    // The window size or the number of levels changed since the previous
+    // image: its pyramid is built again from its first level
+    const vpLevel &level = m_pyramid[0][0];
+    vpImage<unsigned char> prev(level.height, level.width);
+    for (unsigned int y = 0; y < level.height; y++) {
+      const unsigned char *src = &level.image[0] + (y + level.border) * level.stride + level.border;
+      std::copy(src, src + level.width, prev[y]);
+    }
+    buildPyramid(prev, m_pyramid[0]);
+  }
+
+  if (m_initial_guess) {
+    m_initial_guess = false;
+  } else {
+    m_points[0] = m_points[1];
+  }
+
+  const int nbPoints = (int)m_points[1].size();
+  int nbThreads = 1;
+#ifdef VISP_HAVE_OPENMP
+  nbThreads = m_nbThreads > 0 ? m_nbThreads : omp_get_max_threads();
+#endif
+  const size_t bufferSize = 3 * (size_t)m_winSize * m_winSize;
+  m_buffers.resize(nbThreads * bufferSize);
+  m_status.resize((size_t)nbPoints);
+  const double fbThreshold2 = m_fbThreshold * m_fbThreshold;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+#endif
+  for (int i = 0; i < nbPoints; i++) {
+    size_t thread = 0;
+#ifdef VISP_HAVE_OPENMP
+    thread = (size_t)omp_get_thread_num();
+#endif
+    short *buffer = &m_buffers[thread * bufferSize];
+    vpImagePoint next;
+    bool tracked = trackFeature(m_pyramid[0], m_pyramid[1], m_points[0][i], m_points[1][i], next, buffer);
+    if (tracked && m_fbThreshold > 0.) {
+      vpImagePoint back;
+      tracked = trackFeature(m_pyramid[1], m_pyramid[0], next, next, back, buffer) &&
+                vpImagePoint::sqrDistance(back, m_points[0][i]) <= fbThreshold2;
+    }
+    m_points[1][i] = next;
+    m_status[i] = tracked ? 1 : 0;
+  }
+
+  // Remove points that are lost, keeping the order of the others
+  size_t nbTracked = 0;
+  for (size_t i = 0; i < m_status.size(); i++) {
+    if (m_status[i] != 0) {
+      m_points[0][nbTracked] = m_points[0][i];
+      m_points[1][nbTracked] = m_points[1][i];
+      m_points_id[nbTracked] = m_points_id[i];
+      nbTracked++;
+    }
+  }
+  m_points[0].resize(nbTracked);
+  m_points[1].resize(nbTracked);
+  m_points_id.resize(nbTracked);
+}
+
+/*!
+  Track a feature from an image to another one, from the coarsest to the
+  finest pyramid level.
+
+  \param prevPyramid : Pyramid of the image of the feature.
+  \param nextPyramid : Pyramid of the image in which the feature is tracked.
+  \param prevPoint : Location of the feature.
+  \param guess : Initial location of the feature in the next image.
+  \param nextPoint : Location of the feature in the next image.
+  \param buffer : Buffer of 3 window sizes used to store the window and its
+  gradients.
+
+  \return false if the feature is lost.
+*/
+bool vpKltTracker::trackFeature(const std::vector<vpLevel> &prevPyramid, const std::vector<vpLevel> &nextPyramid,
+                                const vpImagePoint &prevPoint, const vpImagePoint &guess, vpImagePoint &nextPoint,
+                                short *buffer) const
+{
+  const int winSize = m_winSize, winArea = winSize * winSize;
+  const float halfWin = (winSize - 1) * 0.5f;
+  const float epsilon2 = (float)(m_epsilon * m_epsilon);
+  const int maxLevel = (int)std::min(prevPyramid.size(), nextPyramid.size()) - 1;
+  short *Iwin = buffer, *dIwin = buffer + winArea;
+  float nextX = 0.f, nextY = 0.f;
+
+  for (int l = maxLevel; l >= 0; l--) {
+    const vpLevel &prev = prevPyramid[(size_t)l], &next = nextPyramid[(size_t)l];
+    const float scale = 1.f / (1 << l);
+    if (l == maxLevel) {
+      nextX = (float)guess.get_u() * scale;
+      nextY = (float)guess.get_v() * scale;
+    } else {
+      nextX *= 2.f;
+      nextY *= 2.f;
+    }
+
+    // Window around the feature in the previous image, interpolated with
+    // fixed-point weights, the image with 5 fractional bits
+    float prevX = (float)prevPoint.get_u() * scale - halfWin, prevY = (float)prevPoint.get_v() * scale - halfWin;
+    int ix = (int)std::floor(prevX), iy = (int)std::floor(prevY);
+    if (ix < -winSize || ix >= (int)prev.width || iy < -winSize || iy >= (int)prev.height) {
+      if (l == 0) {
+        return false;
+      }
+      continue;
+    }
+    float a = prevX - ix, b = prevY - iy;
+    int iw00 = vpMath::round((1.f - a) * (1.f - b) * (1 << W_BITS));
+    int iw01 = vpMath::round(a * (1.f - b) * (1 << W_BITS));
+    int iw10 = vpMath::round((1.f - a) * b * (1 << W_BITS));
+    int iw11 = (1 << W_BITS) - iw00 - iw01 - iw10;
+
+    int stride = (int)prev.stride, gstride = 2 * stride;
+    const unsigned char *I0 = &prev.image[0] + (iy + (int)prev.border) * stride + ix + (int)prev.border;
+    const short *dI0 = &prev.gradient[0] + 2 * ((iy + (int)prev.border) * stride + ix + (int)prev.border);
+    float A11 = 0.f, A12 = 0.f, A22 = 0.f;
+    for (int y = 0; y < winSize; y++) {
+      const unsigned char *src = I0 + y * stride;
+      const short *dsrc = dI0 + y * gstride;
+      short *Iptr = Iwin + y * winSize, *dIptr = dIwin + 2 * y * winSize;
+      for (int x = 0; x < winSize; x++, dsrc += 2, dIptr += 2) {
+        int ival = descale(src[x] * iw00 + src[x + 1] * iw01 + src[x + stride] * iw10 + src[x + stride + 1] * iw11,
+                           W_BITS - 5);
+        int ixval = descale(dsrc[0] * iw00 + dsrc[2] * iw01 + dsrc[gstride] * iw10 + dsrc[gstride + 2] * iw11, W_BITS);
+        int iyval =
+            descale(dsrc[1] * iw00 + dsrc[3] * iw01 + dsrc[gstride + 1] * iw10 + dsrc[gstride + 3] * iw11, W_BITS);
+        Iptr[x] = (short)ival;
+        dIptr[0] = (short)ixval;
+        dIptr[1] = (short)iyval;
+        A11 += (float)(ixval * ixval);
+        A12 += (float)(ixval * iyval);
+        A22 += (float)(iyval * iyval);
+      }
+    }
+    A11 *= FLT_SCALE;
+    A12 *= FLT_SCALE;
+    A22 *= FLT_SCALE;
+
+    float D = A11 * A22 - A12 * A12;
+    float minEig = (A22 + A11 - std::sqrt((A11 - A22) * (A11 - A22) + 4.f * A12 * A12)) / (2 * winArea);
+    if (minEig < m_minEigThreshold || D < FLT_EPSILON) {
+      if (l == 0) {
+        return false;
+      }
+      continue;
+    }
+    D = 1.f / D;
+
+    // Gauss-Newton iterations on the translation of the window
+    nextX -= halfWin;
+    nextY -= halfWin;
+    float prevDeltaX = 0.f, prevDeltaY = 0.f;
+    stride = (int)next.stride;
+    for (int j = 0; j < m_maxIterations; j++) {
+      ix = (int)std::floor(nextX);
+      iy = (int)std::floor(nextY);
+      if (ix < -winSize || ix >= (int)next.width || iy < -winSize || iy >= (int)next.height) {
+        if (l == 0) {
+          return false;
+        }
+        break;
+      }
+      a = nextX - ix;
+      b = nextY - iy;
+      iw00 = vpMath::round((1.f - a) * (1.f - b) * (1 << W_BITS));
+      iw01 = vpMath::round(a * (1.f - b) * (1 << W_BITS));
+      iw10 = vpMath::round((1.f - a) * b * (1 << W_BITS));
+      iw11 = (1 << W_BITS) - iw00 - iw01 - iw10;
+
+      const unsigned char *J0 = &next.image[0] + (iy + (int)next.border) * stride + ix + (int)next.border;
+      float b1 = 0.f, b2 = 0.f;
+      for (int y = 0; y < winSize; y++) {
+        const unsigned char *src = J0 + y * stride;
+        const short *Iptr = Iwin + y * winSize, *dIptr = dIwin + 2 * y * winSize;
+        int ib1 = 0, ib2 = 0;
+        for (int x = 0; x < winSize; x++, dIptr += 2) {
+          int diff = descale(src[x] * iw00 + src[x + 1] * iw01 + src[x + stride] * iw10 + src[x + stride + 1] * iw11,
+                             W_BITS - 5) -
+                     Iptr[x];
+          ib1 += diff * dIptr[0];
+          ib2 += diff * dIptr[1];
+        }
+        b1 += (float)ib1;
+        b2 += (float)ib2;
+      }
+      b1 *= FLT_SCALE;
+      b2 *= FLT_SCALE;
+
+      float deltaX = (A12 * b2 - A22 * b1) * D, deltaY = (A12 * b1 - A11 * b2) * D;
+      nextX += deltaX;
+      nextY += deltaY;
+      if (deltaX * deltaX + deltaY * deltaY <= epsilon2) {
+        break;
+      }
+      // The window oscillates between two locations: take the middle
+      if (j > 0 && std::fabs(deltaX + prevDeltaX) < 0.01f && std::fabs(deltaY + prevDeltaY) < 0.01f) {
+        nextX -= deltaX * 0.5f;
+        nextY -= deltaY * 0.5f;
+        break;
+      }
+      prevDeltaX = deltaX;
+      prevDeltaY = deltaY;
+    }
+    nextX += halfWin;
+    nextY += halfWin;
+  }
+
+  nextPoint.set_uv(nextX, nextY);
+  return true;
+}
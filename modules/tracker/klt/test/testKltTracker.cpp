@@ -0,0 +1,225 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the native pyramidal Lucas-Kanade tracker.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKltTracker.cpp
+
+  \brief Test the native pyramidal Lucas-Kanade tracker on synthetic images
+  translated by a known motion.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/klt/vpKltTracker.h>
+
+namespace
+{
+// Smooth random texture made of sinusoids
+class vpTexture
+{
+public:
+  explicit vpTexture(unsigned int seed)
+  {
+    srand(seed);
+    for (unsigned int i = 0; i < 12; i++) {
+      m_fu.push_back((rand() % 1000) / 1000. * 0.25 - 0.125);
+      m_fv.push_back((rand() % 1000) / 1000. * 0.25 - 0.125);
+      m_phase.push_back((rand() % 1000) / 1000. * 2. * M_PI);
+    }
+  }
+
+  double operator()(double u, double v) const
+  {
+    double value = 128.;
+    for (size_t i = 0; i < m_fu.size(); i++) {
+      value += 20. * std::sin(m_fu[i] * u + m_fv[i] * v + m_phase[i]);
+    }
+    return std::max(0., std::min(255., value));
+  }
+
+private:
+  std::vector<double> m_fu, m_fv, m_phase;
+};
+
+// Image of a texture translated by (du, dv), with a rectangle [left, right[
+// x [top, bottom[ showing another texture
+void render(const vpTexture &texture, double du, double dv, vpImage<unsigned char> &I,
+            const vpTexture *occluder = NULL, unsigned int left = 0, unsigned int right = 0, unsigned int top = 0,
+            unsigned int bottom = 0)
+{
+  for (unsigned int v = 0; v < I.getHeight(); v++) {
+    for (unsigned int u = 0; u < I.getWidth(); u++) {
+      bool occluded = occluder != NULL && u >= left && u < right && v >= top && v < bottom;
+      double value = occluded ? (*occluder)(u, v) : texture(u - du, v - dv);
+      I[v][u] = (unsigned char)vpMath::round(value);
+    }
+  }
+}
+}
+
+int main()
+{
+  try {
+    const unsigned int width = 640, height = 480;
+    const double du = 7.35, dv = -4.6;
+    vpTexture texture(1234), occluder(4321);
+    vpImage<unsigned char> I0(height, width), I1(height, width);
+    render(texture, 0., 0., I0);
+    render(texture, du, dv, I1);
+
+    // Detected features, kept when their window stays in the translated
+    // image
+    vpKltTracker tracker;
+    tracker.setMaxFeatures(300);
+    tracker.setWindowSize(15);
+    tracker.initTracking(I0);
+    std::cout << "Detected features: " << tracker.getNbFeatures() << std::endl;
+    std::vector<vpImagePoint> init;
+    std::vector<long> initIds;
+    for (int i = 0; i < tracker.getNbFeatures(); i++) {
+      const vpImagePoint &ip = tracker.getFeatures()[(size_t)i];
+      if (ip.get_u() + du > 15 && ip.get_u() + du < width - 15 && ip.get_v() + dv > 15 &&
+          ip.get_v() + dv < height - 15) {
+        initIds.push_back((long)init.size());
+        init.push_back(ip);
+      }
+    }
+    int nbFeatures = (int)init.size();
+    if (nbFeatures < 100) {
+      std::cerr << "Not enough detected features" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Features tracked in the translated image
+    tracker.initTracking(I0, init, initIds);
+
+    double t = vpTime::measureTimeMs();
+    tracker.track(I1);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Tracked features: " << tracker.getNbFeatures() << " in " << t << " ms" << std::endl;
+    if (tracker.getNbFeatures() < 0.95 * nbFeatures) {
+      std::cerr << "Too many lost features" << std::endl;
+      return EXIT_FAILURE;
+    }
+    double meanError = 0.;
+    for (int i = 0; i < tracker.getNbFeatures(); i++) {
+      const vpImagePoint &prev = tracker.getPrevFeatures()[(size_t)i];
+      const vpImagePoint &next = tracker.getFeatures()[(size_t)i];
+      meanError += sqrt(vpMath::sqr(next.get_u() - prev.get_u() - du) + vpMath::sqr(next.get_v() - prev.get_v() - dv));
+    }
+    meanError /= tracker.getNbFeatures();
+    std::cout << "Mean tracking error: " << meanError << " pixel" << std::endl;
+    if (meanError > 0.05) {
+      std::cerr << "Bad tracking accuracy" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Large motion without pyramid, given by an initial guess
+    tracker.setPyramidLevels(0);
+    tracker.initTracking(I0, init, initIds);
+    std::vector<vpImagePoint> guess = init;
+    for (size_t i = 0; i < guess.size(); i++) {
+      guess[i].set_uv(guess[i].get_u() + vpMath::round(du), guess[i].get_v() + vpMath::round(dv));
+    }
+    tracker.setInitialGuess(guess);
+    tracker.track(I1);
+    if (tracker.getNbFeatures() < 0.95 * nbFeatures) {
+      std::cerr << "Too many lost features with an initial guess" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (int i = 0; i < tracker.getNbFeatures(); i++) {
+      long id;
+      float x, y;
+      tracker.getFeature(i, id, x, y);
+      const vpImagePoint &prev = init[(size_t)id];
+      if (std::fabs(x - prev.get_u() - du) > 0.2 || std::fabs(y - prev.get_v() - dv) > 0.2) {
+        std::cerr << "Bad tracking of feature " << id << " with an initial guess" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Occluded features, lost with the forward-backward check
+    const unsigned int left = 200, right = 420, top = 150, bottom = 330;
+    render(texture, du, dv, I1, &occluder, left, right, top, bottom);
+    tracker.setPyramidLevels(3);
+    unsigned int nbOccluded[2] = {0, 0}, nbVisible[2] = {0, 0};
+    for (unsigned int fb = 0; fb < 2; fb++) {
+      tracker.setForwardBackwardThreshold(fb ? 0.5 : 0.);
+      tracker.initTracking(I0, init, initIds);
+      tracker.track(I1);
+      for (int i = 0; i < tracker.getNbFeatures(); i++) {
+        const vpImagePoint &prev = tracker.getPrevFeatures()[(size_t)i];
+        // The window of the feature overlaps the occluder in the new image
+        if (prev.get_u() + du > left - 8 && prev.get_u() + du < right + 8 && prev.get_v() + dv > top - 8 &&
+            prev.get_v() + dv < bottom + 8) {
+          nbOccluded[fb]++;
+        } else {
+          nbVisible[fb]++;
+        }
+      }
+    }
+    unsigned int nbInitOccluded = 0;
+    for (size_t i = 0; i < init.size(); i++) {
+      if (init[i].get_u() + du > left - 8 && init[i].get_u() + du < right + 8 && init[i].get_v() + dv > top - 8 &&
+          init[i].get_v() + dv < bottom + 8) {
+        nbInitOccluded++;
+      }
+    }
+    std::cout << "Occluded features: " << nbInitOccluded << ", tracked without check: " << nbOccluded[0]
+              << ", tracked with check: " << nbOccluded[1] << std::endl;
+    std::cout << "Visible features: " << init.size() - nbInitOccluded << ", tracked without check: " << nbVisible[0]
+              << ", tracked with check: " << nbVisible[1] << std::endl;
+    if (nbOccluded[1] > 0.2 * nbInitOccluded || nbOccluded[1] >= nbOccluded[0]) {
+      std::cerr << "The forward-backward check does not reject the occluded features" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (nbVisible[1] < 0.95 * (init.size() - nbInitOccluded)) {
+      std::cerr << "The forward-backward check rejects visible features" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testKltTracker is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
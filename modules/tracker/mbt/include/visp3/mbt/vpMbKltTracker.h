@@ -54,6 +54,7 @@
 #include <visp3/core/vpSubColVector.h>
 #include <visp3/core/vpSubMatrix.h>
 #include <visp3/klt/vpKltOpencv.h>
+#include <visp3/klt/vpKltTracker.h>
 #include <visp3/mbt/vpMbTracker.h>
 #include <visp3/mbt/vpMbtDistanceCircle.h>
 #include <visp3/mbt/vpMbtDistanceKltCylinder.h>
@@ -279,6 +280,19 @@ protected:
   vpColVector m_weightedError_klt;
   //! Robust
   vpRobust m_robust_klt;
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  //! Native points tracker, used instead of the OpenCV one
+  vpKltTracker m_nativeKlt;
+  //! Use the native points tracker from the next initialisation
+  bool m_useNativeKlt;
+  //! The points are tracked by the native tracker since the last
+  //! initialisation
+  bool m_nativeKltActive;
+  //! Points exchanged with the native points tracker
+  std::vector<vpImagePoint> m_nativeKltPoints[2];
+  //! Points exchanged with the OpenCV points tracker
+  std::vector<cv::Point2f> m_nativeKltCvPoints[2];
+#endif
 
 public:
   vpMbKltTracker();
@@ -371,6 +385,15 @@ public:
 
   virtual void setKltOpencv(const vpKltOpencv &t);
 
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  /*!
+    Return true if the points are tracked by the native tracker vpKltTracker
+    instead of vpKltOpencv.
+  */
+  inline bool getUseNativeKlt() const { return m_useNativeKlt; }
+  void setUseNativeKlt(const bool &useNativeKlt, double fbThreshold = 0.);
+#endif
+
   /*!
     Set the threshold for the acceptation of a point.
 
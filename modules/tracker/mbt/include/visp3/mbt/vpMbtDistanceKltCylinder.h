@@ -44,6 +44,7 @@
 #if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
 
 #include <map>
+#include <vector>
 
 #include <visp3/core/vpCircle.h>
 #include <visp3/core/vpCylinder.h>
@@ -84,10 +85,21 @@ private:
   std::map<int, vpImagePoint> initPoints;
   //! Initial points and their ID
   std::map<int, vpPoint> initPoints3D;
-  //! Current points and their ID
+  //! Current points and their ID, built on demand from the flat arrays
   std::map<int, vpImagePoint> curPoints;
-  //! Current points ID and their indexes
+  //! Current points ID and their indexes, built on demand from the flat
+  //! arrays
   std::map<int, int> curPointsInd;
+  //! True when curPoints and curPointsInd match the flat arrays
+  bool curPointsMapsUpToDate;
+  //! ID of the current points, in the order of the KLT features
+  std::vector<int> curIds;
+  //! Current points
+  std::vector<vpImagePoint> curImagePoints;
+  //! Indexes of the current points in the KLT tracker
+  std::vector<int> curIndexes;
+  //! Initial 3D points corresponding to the current points
+  std::vector<vpPoint> curInitPoints3D;
   //! number of points detected
   unsigned int nbPointsCur;
   //! initial number of points
@@ -112,6 +124,7 @@ public:
 private:
   double computeZ(const double &x, const double &y);
   bool isTrackedFeature(const int id);
+  void updateCurrentPointsMaps();
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -155,9 +168,9 @@ public:
   */
   inline vpCameraParameters &getCameraParameters() { return cam; }
 
-  inline std::map<int, vpImagePoint> &getCurrentPoints() { return curPoints; }
+  std::map<int, vpImagePoint> &getCurrentPoints();
 
-  inline std::map<int, int> &getCurrentPointsInd() { return curPointsInd; }
+  std::map<int, int> &getCurrentPointsInd();
 
   inline vpCylinder getCylinder() const { return cylinder; }
 
@@ -45,6 +45,7 @@
 #if defined(VISP_HAVE_MODULE_KLT) && (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100))
 
 #include <map>
+#include <vector>
 
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpGEMM.h>
@@ -80,10 +81,21 @@ private:
   vpColVector cRc0_0n;
   //! Initial points and their ID
   std::map<int, vpImagePoint> initPoints;
-  //! Current points and their ID
+  //! Current points and their ID, built on demand from the flat arrays
   std::map<int, vpImagePoint> curPoints;
-  //! Current points ID and their indexes
+  //! Current points ID and their indexes, built on demand from the flat
+  //! arrays
   std::map<int, int> curPointsInd;
+  //! True when curPoints and curPointsInd match the flat arrays
+  bool curPointsMapsUpToDate;
+  //! ID of the current points, in the order of the KLT features
+  std::vector<int> curIds;
+  //! Current points
+  std::vector<vpImagePoint> curImagePoints;
+  //! Indexes of the current points in the KLT tracker
+  std::vector<int> curIndexes;
+  //! Initial points corresponding to the current points
+  std::vector<vpImagePoint> curInitPoints;
   //! number of points detected
   unsigned int nbPointsCur;
   //! initial number of points
@@ -113,6 +125,7 @@ private:
   double compute_1_over_Z(const double x, const double y);
   void computeP_mu_t(const double x_in, const double y_in, double &x_out, double &y_out, const vpMatrix &cHc0);
   bool isTrackedFeature(const int id);
+  void updateCurrentPointsMaps();
 
   // private:
   //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -158,9 +171,9 @@ public:
 
   inline vpColVector getCurrentNormal() const { return N_cur; }
 
-  inline std::map<int, vpImagePoint> &getCurrentPoints() { return curPoints; }
+  std::map<int, vpImagePoint> &getCurrentPoints();
 
-  inline std::map<int, int> &getCurrentPointsInd() { return curPointsInd; }
+  std::map<int, int> &getCurrentPointsInd();
 
   /*!
     Get the number of point that was belonging to the face at the
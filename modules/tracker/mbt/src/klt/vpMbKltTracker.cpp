@@ -48,6 +48,28 @@
 #include <TargetConditionals.h>             // To detect OSX or IOS using TARGET_OS_IPHONE or TARGET_OS_IOS macro
 #endif
 
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408) && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+namespace
+{
+void toImagePoints(const std::vector<cv::Point2f> &src, std::vector<vpImagePoint> &dst)
+{
+  dst.resize(src.size());
+  for (size_t i = 0; i < src.size(); i++) {
+    dst[i].set_uv(src[i].x, src[i].y);
+  }
+}
+
+void toCvPoints(const std::vector<vpImagePoint> &src, std::vector<cv::Point2f> &dst)
+{
+  dst.resize(src.size());
+  for (size_t i = 0; i < src.size(); i++) {
+    dst[i].x = (float)src[i].get_u();
+    dst[i].y = (float)src[i].get_v();
+  }
+}
+}
+#endif
+
 vpMbKltTracker::vpMbKltTracker()
   :
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
@@ -58,6 +80,9 @@ vpMbKltTracker::vpMbKltTracker()
     c0Mo(), firstInitialisation(true), maskBorder(5), threshold_outlier(0.5), percentGood(0.6), ctTc0(), tracker(),
     kltPolygons(), kltCylinders(), circles_disp(), m_nbInfos(0), m_nbFaceUsed(0), m_L_klt(), m_error_klt(), m_w_klt(),
     m_weightedError_klt(), m_robust_klt()
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+    , m_nativeKlt(), m_useNativeKlt(false), m_nativeKltActive(false), m_nativeKltPoints(), m_nativeKltCvPoints()
+#endif
 {
   tracker.setTrackerId(1);
   tracker.setUseHarris(1);
@@ -212,6 +237,16 @@ void vpMbKltTracker::reinit(const vpImage<unsigned char> &I)
   }
 
   tracker.initTracking(cur, mask);
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  m_nativeKltActive = m_useNativeKlt;
+  if (m_nativeKltActive) {
+    // The points detected by OpenCV are tracked by the native tracker
+    m_nativeKlt.setWindowSize(tracker.getWindowSize());
+    m_nativeKlt.setPyramidLevels(tracker.getPyramidLevels());
+    toImagePoints(tracker.getFeaturesRef(), m_nativeKltPoints[1]);
+    m_nativeKlt.initTracking(I, m_nativeKltPoints[1], tracker.getFeaturesIdRef());
+  }
+#endif
   //  tracker.track(cur); // AY: Not sure to be usefull but makes sure that
   //  the points are valid for tracking and avoid too fast reinitialisations.
   //  vpCTRACE << "init klt. detected " << tracker.getNbFeatures() << "
@@ -383,6 +418,34 @@ void vpMbKltTracker::setKltOpencv(const vpKltOpencv &t)
   tracker.setPyramidLevels(t.getPyramidLevels());
 }
 
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+/*!
+  Track the points with the native tracker vpKltTracker instead of
+  vpKltOpencv. The points are still detected by vpKltOpencv, with the
+  parameters given by setKltOpencv(), and then tracked by vpKltTracker with
+  the same window size and pyramid levels.
+
+  \warning This mode still requires OpenCV. Only the tracking of the points
+  between two images is done by vpKltTracker: the detection is done by
+  vpKltOpencv, and the tracked points are given back to vpKltOpencv with
+  vpKltOpencv::setInitialGuess(), from which the faces get them.
+
+  The choice takes effect at the next initialisation of the points, that is
+  at the next call to initFromPose(), initClick(), setPose() with a model
+  containing cylinders, or when too many points are lost.
+
+  \param useNativeKlt : True to use the native tracker.
+  \param fbThreshold : Threshold in pixels of the forward-backward check of
+  the native tracker, 0 to disable the check (see
+  vpKltTracker::setForwardBackwardThreshold()).
+*/
+void vpMbKltTracker::setUseNativeKlt(const bool &useNativeKlt, double fbThreshold)
+{
+  m_nativeKlt.setForwardBackwardThreshold(fbThreshold);
+  m_useNativeKlt = useNativeKlt;
+}
+#endif
+
 /*!
   Set the camera parameters.
 
@@ -549,6 +612,11 @@ void vpMbKltTracker::setPose(const vpImage<unsigned char> &I, const vpHomogeneou
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     tracker.setInitialGuess(init_pts, guess_pts, init_ids);
+    if (m_nativeKltActive) {
+      toImagePoints(init_pts, m_nativeKltPoints[0]);
+      toImagePoints(guess_pts, m_nativeKltPoints[1]);
+      m_nativeKlt.setInitialGuess(m_nativeKltPoints[0], m_nativeKltPoints[1], init_ids);
+    }
 #else
     tracker.setInitialGuess(&init_pts, &guess_pts, init_ids, iter_pts);
 
@@ -636,8 +704,23 @@ void vpMbKltTracker::initFaceFromLines(vpMbtPolygon &polygon)
 */
 void vpMbKltTracker::preTracking(const vpImage<unsigned char> &I)
 {
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
+  if (m_nativeKltActive) {
+    // The points tracked by the native tracker are given to the OpenCV one,
+    // from which the faces get them
+    m_nativeKlt.track(I);
+    toCvPoints(m_nativeKlt.getPrevFeatures(), m_nativeKltCvPoints[0]);
+    toCvPoints(m_nativeKlt.getFeatures(), m_nativeKltCvPoints[1]);
+    tracker.setInitialGuess(m_nativeKltCvPoints[0], m_nativeKltCvPoints[1], m_nativeKlt.getFeaturesId());
+  } else {
+    // The KLT tracker copies the image, it only has to be wrapped
+    vpImageConvert::convert(I, cur, false);
+    tracker.track(cur);
+  }
+#else
   vpImageConvert::convert(I, cur);
   tracker.track(cur);
+#endif
 
   m_nbInfos = 0;
   m_nbFaceUsed = 0;
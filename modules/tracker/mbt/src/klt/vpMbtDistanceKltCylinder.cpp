@@ -56,7 +56,8 @@
 */
 vpMbtDistanceKltCylinder::vpMbtDistanceKltCylinder()
   : c0Mo(), p1Ext(), p2Ext(), cylinder(), circle1(), circle2(), initPoints(), initPoints3D(), curPoints(),
-    curPointsInd(), nbPointsCur(0), nbPointsInit(0), minNbPoint(4), enoughPoints(false), cam(),
+    curPointsInd(), curPointsMapsUpToDate(true), curIds(), curImagePoints(), curIndexes(), curInitPoints3D(),
+    nbPointsCur(0), nbPointsInit(0), minNbPoint(4), enoughPoints(false), cam(),
     isTrackedKltCylinder(true), listIndicesCylinderBBox(), hiddenface(NULL), useScanLine(false)
 {
 }
@@ -113,8 +114,11 @@ void vpMbtDistanceKltCylinder::init(const vpKltOpencv &_tracker, const vpHomogen
   nbPointsCur = 0;
   initPoints = std::map<int, vpImagePoint>();
   initPoints3D = std::map<int, vpPoint>();
-  curPoints = std::map<int, vpImagePoint>();
-  curPointsInd = std::map<int, int>();
+  curIds.clear();
+  curImagePoints.clear();
+  curIndexes.clear();
+  curInitPoints3D.clear();
+  curPointsMapsUpToDate = false;
 
   for (unsigned int i = 0; i < static_cast<unsigned int>(_tracker.getNbFeatures()); i++) {
     long id;
@@ -151,25 +155,17 @@ void vpMbtDistanceKltCylinder::init(const vpKltOpencv &_tracker, const vpHomogen
       vpPixelMeterConversion::convertPoint(cam, x_tmp, y_tmp, xm, ym);
       double Z = computeZ(xm, ym);
       if (!vpMath::isNaN(Z)) {
-#if TARGET_OS_IPHONE
         initPoints[(int)id] = vpImagePoint(y_tmp, x_tmp);
-        curPoints[(int)id] = vpImagePoint(y_tmp, x_tmp);
-        curPointsInd[(int)id] = (int)i;
-#else
-        initPoints[id] = vpImagePoint(y_tmp, x_tmp);
-        curPoints[id] = vpImagePoint(y_tmp, x_tmp);
-        curPointsInd[id] = (int)i;
-#endif
+        curIds.push_back((int)id);
+        curImagePoints.push_back(vpImagePoint(y_tmp, x_tmp));
+        curIndexes.push_back((int)i);
         nbPointsInit++;
         nbPointsCur++;
 
         vpPoint p;
         p.setWorldCoordinates(xm * Z, ym * Z, Z);
-#if TARGET_OS_IPHONE
         initPoints3D[(int)id] = p;
-#else
-        initPoints3D[id] = p;
-#endif
+        curInitPoints3D.push_back(p);
         // std::cout << "Computed Z for : " << xm << "," << ym << " : " <<
         // computeZ(xm,ym) << std::endl;
       }
@@ -198,19 +194,20 @@ unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltOpenc
   long id;
   float x, y;
   nbPointsCur = 0;
-  curPoints = std::map<int, vpImagePoint>();
-  curPointsInd = std::map<int, int>();
+  // The flat arrays keep their capacity from one image to the next
+  curIds.clear();
+  curImagePoints.clear();
+  curIndexes.clear();
+  curInitPoints3D.clear();
+  curPointsMapsUpToDate = false;
 
   for (unsigned int i = 0; i < static_cast<unsigned int>(_tracker.getNbFeatures()); i++) {
     _tracker.getFeature((int)i, id, x, y);
     if (isTrackedFeature((int)id)) {
-#if TARGET_OS_IPHONE
-      curPoints[(int)id] = vpImagePoint(static_cast<double>(y), static_cast<double>(x));
-      curPointsInd[(int)id] = (int)i;
-#else
-      curPoints[id] = vpImagePoint(static_cast<double>(y), static_cast<double>(x));
-      curPointsInd[id] = (int)i;
-#endif
+      curIds.push_back((int)id);
+      curImagePoints.push_back(vpImagePoint(static_cast<double>(y), static_cast<double>(x)));
+      curIndexes.push_back((int)i);
+      curInitPoints3D.push_back(initPoints3D[(int)id]);
       nbPointsCur++;
     }
   }
@@ -233,33 +230,33 @@ unsigned int vpMbtDistanceKltCylinder::computeNbDetectedCurrent(const vpKltOpenc
 */
 void vpMbtDistanceKltCylinder::removeOutliers(const vpColVector &_w, const double &threshold_outlier)
 {
-  std::map<int, vpImagePoint> tmp;
-  std::map<int, int> tmp2;
   unsigned int nbSupp = 0;
   unsigned int k = 0;
 
+  // The inliers are moved in place to the front of the flat arrays
   nbPointsCur = 0;
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
+  for (size_t i = 0; i < curIds.size(); i++) {
     if (_w[k] > threshold_outlier && _w[k + 1] > threshold_outlier) {
       //     if(_w[k] > threshold_outlier || _w[k+1] > threshold_outlier){
-      tmp[iter->first] = vpImagePoint(iter->second.get_i(), iter->second.get_j());
-      tmp2[iter->first] = curPointsInd[iter->first];
+      curIds[nbPointsCur] = curIds[i];
+      curImagePoints[nbPointsCur] = curImagePoints[i];
+      curIndexes[nbPointsCur] = curIndexes[i];
+      curInitPoints3D[nbPointsCur] = curInitPoints3D[i];
       nbPointsCur++;
     } else {
       nbSupp++;
-      initPoints.erase(iter->first);
+      initPoints.erase(curIds[i]);
     }
 
     k += 2;
   }
 
   if (nbSupp != 0) {
-    curPoints = std::map<int, vpImagePoint>();
-    curPointsInd = std::map<int, int>();
-
-    curPoints = tmp;
-    curPointsInd = tmp2;
+    curIds.resize(nbPointsCur);
+    curImagePoints.resize(nbPointsCur);
+    curIndexes.resize(nbPointsCur);
+    curInitPoints3D.resize(nbPointsCur);
+    curPointsMapsUpToDate = false;
     if (nbPointsCur >= minNbPoint)
       enoughPoints = true;
     else
@@ -285,15 +282,13 @@ void vpMbtDistanceKltCylinder::computeInteractionMatrixAndResidu(const vpHomogen
 
   cylinder.changeFrame(_cMc0 * c0Mo);
 
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    double i_cur(iter->second.get_i()), j_cur(iter->second.get_j());
+  for (size_t k = 0; k < curIds.size(); k++) {
+    double i_cur(curImagePoints[k].get_i()), j_cur(curImagePoints[k].get_j());
 
     double x_cur(0), y_cur(0);
     vpPixelMeterConversion::convertPoint(cam, j_cur, i_cur, x_cur, y_cur);
 
-    vpPoint p0 = initPoints3D[id];
+    vpPoint p0 = curInitPoints3D[k];
     p0.changeFrame(_cMc0);
     p0.project();
 
@@ -364,6 +359,44 @@ bool vpMbtDistanceKltCylinder::isTrackedFeature(const int _id)
   return false;
 }
 
+/*!
+  Return the current points and their ID. The map is built from the flat
+  arrays of the current points when they changed since the last call.
+*/
+std::map<int, vpImagePoint> &vpMbtDistanceKltCylinder::getCurrentPoints()
+{
+  updateCurrentPointsMaps();
+  return curPoints;
+}
+
+/*!
+  Return the ID of the current points and their indexes in the KLT tracker.
+  The map is built from the flat arrays of the current points when they
+  changed since the last call.
+*/
+std::map<int, int> &vpMbtDistanceKltCylinder::getCurrentPointsInd()
+{
+  updateCurrentPointsMaps();
+  return curPointsInd;
+}
+
+/*!
+  Rebuild the maps of the current points from the flat arrays, if needed.
+*/
+void vpMbtDistanceKltCylinder::updateCurrentPointsMaps()
+{
+  if (curPointsMapsUpToDate) {
+    return;
+  }
+  curPoints.clear();
+  curPointsInd.clear();
+  for (size_t k = 0; k < curIds.size(); k++) {
+    curPoints[curIds[k]] = curImagePoints[k];
+    curPointsInd[curIds[k]] = curIndexes[k];
+  }
+  curPointsMapsUpToDate = true;
+}
+
 /*!
   Modification of all the pixels that are in the roi to the value of _nb (
   default is 255).
@@ -531,12 +564,9 @@ void vpMbtDistanceKltCylinder::updateMask(
 */
 void vpMbtDistanceKltCylinder::displayPrimitive(const vpImage<unsigned char> &_I)
 {
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    vpImagePoint iP;
-    iP.set_i(static_cast<double>(iter->second.get_i()));
-    iP.set_j(static_cast<double>(iter->second.get_j()));
+  for (size_t k = 0; k < curIds.size(); k++) {
+    int id(curIds[k]);
+    vpImagePoint iP = curImagePoints[k];
 
     vpDisplay::displayCross(_I, iP, 10, vpColor::red);
 
@@ -555,12 +585,9 @@ void vpMbtDistanceKltCylinder::displayPrimitive(const vpImage<unsigned char> &_I
 */
 void vpMbtDistanceKltCylinder::displayPrimitive(const vpImage<vpRGBa> &_I)
 {
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    vpImagePoint iP;
-    iP.set_i(static_cast<double>(iter->second.get_i()));
-    iP.set_j(static_cast<double>(iter->second.get_j()));
+  for (size_t k = 0; k < curIds.size(); k++) {
+    int id(curIds[k]);
+    vpImagePoint iP = curImagePoints[k];
 
     vpDisplay::displayCross(_I, iP, 10, vpColor::red);
 
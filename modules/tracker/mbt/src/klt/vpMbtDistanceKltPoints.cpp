@@ -57,7 +57,8 @@
 */
 vpMbtDistanceKltPoints::vpMbtDistanceKltPoints()
   : H(), N(), N_cur(), invd0(1.), cRc0_0n(), initPoints(std::map<int, vpImagePoint>()),
-    curPoints(std::map<int, vpImagePoint>()), curPointsInd(std::map<int, int>()), nbPointsCur(0), nbPointsInit(0),
+    curPoints(std::map<int, vpImagePoint>()), curPointsInd(std::map<int, int>()), curPointsMapsUpToDate(true),
+    curIds(), curImagePoints(), curIndexes(), curInitPoints(), nbPointsCur(0), nbPointsInit(0),
     minNbPoint(4), enoughPoints(false), dt(1.), d0(1.), cam(), isTrackedKltPoints(true), polygon(NULL),
     hiddenface(NULL), useScanLine(false)
 {
@@ -83,8 +84,11 @@ void vpMbtDistanceKltPoints::init(const vpKltOpencv &_tracker, const vpImage<boo
   nbPointsInit = 0;
   nbPointsCur = 0;
   initPoints = std::map<int, vpImagePoint>();
-  curPoints = std::map<int, vpImagePoint>();
-  curPointsInd = std::map<int, int>();
+  curIds.clear();
+  curImagePoints.clear();
+  curIndexes.clear();
+  curInitPoints.clear();
+  curPointsMapsUpToDate = false;
   std::vector<vpImagePoint> roi;
   polygon->getRoiClipped(cam, roi);
 
@@ -110,20 +114,17 @@ void vpMbtDistanceKltPoints::init(const vpKltOpencv &_tracker, const vpImage<boo
     }
 
     if (add) {
-#if TARGET_OS_IPHONE
-      initPoints[(int)id] = vpImagePoint(y_tmp, x_tmp);
-      curPoints[(int)id] = vpImagePoint(y_tmp, x_tmp);
-      curPointsInd[(int)id] = (int)i;
-#else
-      initPoints[id] = vpImagePoint(y_tmp, x_tmp);
-      curPoints[id] = vpImagePoint(y_tmp, x_tmp);
-      curPointsInd[id] = (int)i;
-#endif
+      vpImagePoint ip(y_tmp, x_tmp);
+      initPoints[(int)id] = ip;
+      curIds.push_back((int)id);
+      curImagePoints.push_back(ip);
+      curIndexes.push_back((int)i);
+      curInitPoints.push_back(ip);
     }
   }
 
   nbPointsInit = (unsigned int)initPoints.size();
-  nbPointsCur = (unsigned int)curPoints.size();
+  nbPointsCur = (unsigned int)curIds.size();
 
   if (nbPointsCur >= minNbPoint)
     enoughPoints = true;
@@ -155,23 +156,25 @@ unsigned int vpMbtDistanceKltPoints::computeNbDetectedCurrent(const vpKltOpencv
   long id;
   float x, y;
   nbPointsCur = 0;
-  curPoints = std::map<int, vpImagePoint>();
-  curPointsInd = std::map<int, int>();
+  // The flat arrays keep their capacity from one image to the next
+  curIds.clear();
+  curImagePoints.clear();
+  curIndexes.clear();
+  curInitPoints.clear();
+  curPointsMapsUpToDate = false;
 
   for (unsigned int i = 0; i < static_cast<unsigned int>(_tracker.getNbFeatures()); i++) {
     _tracker.getFeature((int)i, id, x, y);
-    if (isTrackedFeature((int)id) && vpMeTracker::inMask(mask, (unsigned int) y, (unsigned int) x)) {
-#if TARGET_OS_IPHONE
-      curPoints[(int)id] = vpImagePoint(static_cast<double>(y), static_cast<double>(x));
-      curPointsInd[(int)id] = (int)i;
-#else
-      curPoints[id] = vpImagePoint(static_cast<double>(y), static_cast<double>(x));
-      curPointsInd[id] = (int)i;
-#endif
+    std::map<int, vpImagePoint>::const_iterator init = initPoints.find((int)id);
+    if (init != initPoints.end() && vpMeTracker::inMask(mask, (unsigned int) y, (unsigned int) x)) {
+      curIds.push_back((int)id);
+      curImagePoints.push_back(vpImagePoint(static_cast<double>(y), static_cast<double>(x)));
+      curIndexes.push_back((int)i);
+      curInitPoints.push_back(init->second);
     }
   }
 
-  nbPointsCur = (unsigned int)curPoints.size();
+  nbPointsCur = (unsigned int)curIds.size();
 
   if (nbPointsCur >= minNbPoint)
     enoughPoints = true;
@@ -195,17 +198,14 @@ void vpMbtDistanceKltPoints::computeInteractionMatrixAndResidu(vpColVector &_R,
 {
   unsigned int index_ = 0;
 
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    double i_cur(iter->second.get_i()), j_cur(iter->second.get_j());
+  for (size_t k = 0; k < curIds.size(); k++) {
+    double i_cur(curImagePoints[k].get_i()), j_cur(curImagePoints[k].get_j());
 
     double x_cur(0), y_cur(0);
     vpPixelMeterConversion::convertPoint(cam, j_cur, i_cur, x_cur, y_cur);
 
-    vpImagePoint iP0 = initPoints[id];
     double x0(0), y0(0);
-    vpPixelMeterConversion::convertPoint(cam, iP0, x0, y0);
+    vpPixelMeterConversion::convertPoint(cam, curInitPoints[k], x0, y0);
 
     double x0_transform,
         y0_transform; // equivalent x and y in the first image (reference)
@@ -342,6 +342,44 @@ bool vpMbtDistanceKltPoints::isTrackedFeature(const int _id)
   return false;
 }
 
+/*!
+  Return the current points and their ID. The map is built from the flat
+  arrays of the current points when they changed since the last call.
+*/
+std::map<int, vpImagePoint> &vpMbtDistanceKltPoints::getCurrentPoints()
+{
+  updateCurrentPointsMaps();
+  return curPoints;
+}
+
+/*!
+  Return the ID of the current points and their indexes in the KLT tracker.
+  The map is built from the flat arrays of the current points when they
+  changed since the last call.
+*/
+std::map<int, int> &vpMbtDistanceKltPoints::getCurrentPointsInd()
+{
+  updateCurrentPointsMaps();
+  return curPointsInd;
+}
+
+/*!
+  Rebuild the maps of the current points from the flat arrays, if needed.
+*/
+void vpMbtDistanceKltPoints::updateCurrentPointsMaps()
+{
+  if (curPointsMapsUpToDate) {
+    return;
+  }
+  curPoints.clear();
+  curPointsInd.clear();
+  for (size_t k = 0; k < curIds.size(); k++) {
+    curPoints[curIds[k]] = curImagePoints[k];
+    curPointsInd[curIds[k]] = curIndexes[k];
+  }
+  curPointsMapsUpToDate = true;
+}
+
 /*!
   Modification of all the pixels that are in the roi to the value of _nb (
   default is 255).
@@ -506,30 +544,33 @@ void vpMbtDistanceKltPoints::updateMask(
 */
 void vpMbtDistanceKltPoints::removeOutliers(const vpColVector &_w, const double &threshold_outlier)
 {
-  std::map<int, vpImagePoint> tmp;
-  std::map<int, int> tmp2;
   unsigned int nbSupp = 0;
   unsigned int k = 0;
 
+  // The inliers are moved in place to the front of the flat arrays
   nbPointsCur = 0;
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
+  for (size_t i = 0; i < curIds.size(); i++) {
     if (_w[k] > threshold_outlier && _w[k + 1] > threshold_outlier) {
       //     if(_w[k] > threshold_outlier || _w[k+1] > threshold_outlier){
-      tmp[iter->first] = vpImagePoint(iter->second.get_i(), iter->second.get_j());
-      tmp2[iter->first] = curPointsInd[iter->first];
+      curIds[nbPointsCur] = curIds[i];
+      curImagePoints[nbPointsCur] = curImagePoints[i];
+      curIndexes[nbPointsCur] = curIndexes[i];
+      curInitPoints[nbPointsCur] = curInitPoints[i];
       nbPointsCur++;
     } else {
       nbSupp++;
-      initPoints.erase(iter->first);
+      initPoints.erase(curIds[i]);
     }
 
     k += 2;
   }
 
   if (nbSupp != 0) {
-    curPoints = tmp;
-    curPointsInd = tmp2;
+    curIds.resize(nbPointsCur);
+    curImagePoints.resize(nbPointsCur);
+    curIndexes.resize(nbPointsCur);
+    curInitPoints.resize(nbPointsCur);
+    curPointsMapsUpToDate = false;
     if (nbPointsCur >= minNbPoint)
       enoughPoints = true;
     else
@@ -544,12 +585,9 @@ void vpMbtDistanceKltPoints::removeOutliers(const vpColVector &_w, const double
 */
 void vpMbtDistanceKltPoints::displayPrimitive(const vpImage<unsigned char> &_I)
 {
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    vpImagePoint iP;
-    iP.set_i(static_cast<double>(iter->second.get_i()));
-    iP.set_j(static_cast<double>(iter->second.get_j()));
+  for (size_t k = 0; k < curIds.size(); k++) {
+    int id(curIds[k]);
+    vpImagePoint iP = curImagePoints[k];
 
     vpDisplay::displayCross(_I, iP, 10, vpColor::red);
 
@@ -568,12 +606,9 @@ void vpMbtDistanceKltPoints::displayPrimitive(const vpImage<unsigned char> &_I)
 */
 void vpMbtDistanceKltPoints::displayPrimitive(const vpImage<vpRGBa> &_I)
 {
-  std::map<int, vpImagePoint>::const_iterator iter = curPoints.begin();
-  for (; iter != curPoints.end(); ++iter) {
-    int id(iter->first);
-    vpImagePoint iP;
-    iP.set_i(static_cast<double>(iter->second.get_i()));
-    iP.set_j(static_cast<double>(iter->second.get_j()));
+  for (size_t k = 0; k < curIds.size(); k++) {
+    int id(curIds[k]);
+    vpImagePoint iP = curImagePoints[k];
 
     vpDisplay::displayCross(_I, iP, 10, vpColor::red);
 
@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Hamming distance matcher for binary descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpBinaryDescriptorMatcher.h
+  \brief Hamming distance matcher for binary descriptors (ORB, BRISK,
+  FREAK...).
+*/
+
+#ifndef vpBinaryDescriptorMatcher_h
+#define vpBinaryDescriptorMatcher_h
+
+#include <visp3/core/vpConfig.h>
+
+#include <vector>
+
+/*!
+  \class vpBinaryDescriptorMatcher
+  \ingroup group_vision_keypoints
+
+  \brief Match binary descriptors (ORB, BRISK, FREAK, AKAZE...) with the
+  Hamming distance.
+
+  The train descriptors are stored contiguously. Each query descriptor is
+  matched against them:
+  - by brute force, the Hamming distances being computed with SSSE3
+    instructions when available, or with a 64-bit population count;
+  - with multi-index hashing \cite Norouzi:2012 when the number of train
+    descriptors is large (see setMultiIndexHashing()). Each descriptor is cut
+    into 16-bit substrings indexed in as many hash tables. The tables are
+    searched with an increasing radius until the k nearest neighbors are
+    guaranteed to be found; when the maximal radius is reached, the query is
+    matched by brute force. The result is thus always the exact one.
+    The hashing is efficient when the searched neighbors are close to the
+    queries. match() takes advantage of the maximal distance and of the ratio
+    test to stop the search as soon as the result of the filters is known.
+
+  The queries are distributed over several threads when ViSP is built with
+  OpenMP (see setNbThreads()).
+
+  match() keeps the best match of each query and filters the matches with a
+  maximal distance, the ratio test proposed by Lowe and a cross check (see
+  setMaxDistance(), setRatioThreshold() and setCrossCheck()), while
+  knnMatch() returns the k nearest neighbors without filtering.
+
+  The descriptors are given as rows of bytes, like in a \c cv::Mat of type
+  \c CV_8U:
+  \code
+  vpBinaryDescriptorMatcher matcher;
+  matcher.addTrainDescriptors(trainDescriptors.data, trainDescriptors.rows, trainDescriptors.cols,
+                              (unsigned int)trainDescriptors.step);
+  matcher.setRatioThreshold(0.8);
+
+  std::vector<vpBinaryDescriptorMatcher::vpDescriptorMatch> matches;
+  matcher.match(queryDescriptors.data, queryDescriptors.rows, (unsigned int)queryDescriptors.step, matches);
+  \endcode
+
+  This matcher can be selected in vpKeyPoint with the "HammingViSP" matcher
+  name (see vpKeyPoint::setMatcher()).
+*/
+class VISP_EXPORT vpBinaryDescriptorMatcher
+{
+public:
+  /*! Match between a query descriptor and a train descriptor. */
+  struct vpDescriptorMatch {
+    unsigned int queryIdx; //!< Index of the query descriptor
+    unsigned int trainIdx; //!< Index of the train descriptor
+    unsigned int distance; //!< Hamming distance between both descriptors
+  };
+
+  vpBinaryDescriptorMatcher();
+  virtual ~vpBinaryDescriptorMatcher() {}
+
+  void addTrainDescriptors(const unsigned char *descriptors, unsigned int nbDescriptors,
+                           unsigned int descriptorSize, unsigned int step = 0);
+  void clear();
+
+  /*!
+    Return true if the matches are filtered with a cross check.
+  */
+  inline bool getCrossCheck() const { return m_crossCheck; }
+  /*!
+    Return the size in bytes of the descriptors, 0 if there is no train
+    descriptor.
+  */
+  inline unsigned int getDescriptorSize() const { return m_descriptorSize; }
+  /*!
+    Return the maximal Hamming distance of a match.
+  */
+  inline unsigned int getMaxDistance() const { return m_maxDistance; }
+  /*!
+    Return the number of train descriptors.
+  */
+  inline unsigned int getNbTrainDescriptors() const { return m_nbTrainDescriptors; }
+  /*!
+    Return the number of threads used to match the queries.
+
+    \sa setNbThreads()
+  */
+  inline int getNbThreads() const { return m_nbThreads; }
+  /*!
+    Return the ratio threshold of the ratio test, 0 if the test is
+    disabled.
+  */
+  inline double getRatioThreshold() const { return m_ratioThreshold; }
+
+  static unsigned int hammingDistance(const unsigned char *a, const unsigned char *b, unsigned int size);
+
+  /*!
+    Return true if the multi-index hash tables are used to match the
+    queries.
+  */
+  inline bool isHashingUsed() const
+  {
+    return m_useHashing && m_nbTrainDescriptors >= m_hashingMinNbDescriptors && m_descriptorSize % 2 == 0;
+  }
+
+  void knnMatch(const unsigned char *queries, unsigned int nbQueries, unsigned int step, unsigned int k,
+                std::vector<std::vector<vpDescriptorMatch> > &matches);
+  void match(const unsigned char *queries, unsigned int nbQueries, unsigned int step,
+             std::vector<vpDescriptorMatch> &matches);
+
+  /*!
+    Keep a match only if the query descriptor is also the best match of the
+    train descriptor among all the query descriptors.
+  */
+  inline void setCrossCheck(bool crossCheck) { m_crossCheck = crossCheck; }
+  /*!
+    Set the maximal radius, expressed as the Hamming distance of a 16-bit
+    substring, searched in the hash tables before falling back to brute
+    force. The number of buckets visited per table grows with the binomial
+    coefficient of this radius. By default 2.
+  */
+  inline void setMaxHashingRadius(unsigned int radius) { m_maxHashingRadius = radius; }
+  /*!
+    Reject the matches with a Hamming distance greater than \e maxDistance.
+    By default all the matches are kept.
+  */
+  inline void setMaxDistance(unsigned int maxDistance) { m_maxDistance = maxDistance; }
+  void setMultiIndexHashing(bool useHashing, unsigned int minNbTrainDescriptors = 20000);
+  /*!
+    Set the number of threads used to match the queries. A value of 0 lets
+    OpenMP choose the number of threads. This parameter is only used when
+    ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(int nbThreads) { m_nbThreads = nbThreads; }
+  /*!
+    Keep a match only if the distance of the best match is lower than
+    \e ratio times the distance of the second best match. A value of 0
+    disables the ratio test.
+  */
+  inline void setRatioThreshold(double ratio) { m_ratioThreshold = ratio; }
+
+  void train();
+
+private:
+  void buildHashTables();
+  void knnMatchBruteForce(const unsigned char *query, unsigned int queryIdx, unsigned int k,
+                          std::vector<vpDescriptorMatch> &knn) const;
+  bool knnMatchHashing(const unsigned char *query, unsigned int queryIdx, unsigned int k,
+                       std::vector<unsigned int> &visited, unsigned int &stamp,
+                       std::vector<vpDescriptorMatch> &knn, unsigned int &lowerBound) const;
+
+  //! Train descriptors stored contiguously
+  std::vector<unsigned char> m_trainDescriptors;
+  //! Size in bytes of a descriptor
+  unsigned int m_descriptorSize;
+  //! Number of train descriptors
+  unsigned int m_nbTrainDescriptors;
+  //! Filtering with a cross check
+  bool m_crossCheck;
+  //! Maximal Hamming distance of a match
+  unsigned int m_maxDistance;
+  //! Ratio test threshold, 0 to disable the test
+  double m_ratioThreshold;
+  //! Number of threads
+  int m_nbThreads;
+  //! Use multi-index hashing
+  bool m_useHashing;
+  //! Minimal number of train descriptors to use multi-index hashing
+  unsigned int m_hashingMinNbDescriptors;
+  //! Maximal search radius in a hash table
+  unsigned int m_maxHashingRadius;
+  //! True when the hash tables correspond to the train descriptors
+  bool m_hashTablesUpToDate;
+  //! Offsets of the 65536 buckets of each hash table (size nbTables * 65537)
+  std::vector<unsigned int> m_bucketOffsets;
+  //! Train indexes sorted by bucket for each hash table (size nbTables * nbTrainDescriptors)
+  std::vector<unsigned int> m_bucketIndexes;
+  //! 16-bit masks sorted by number of bits set
+  std::vector<unsigned short> m_radiusMasks;
+  //! Offset of the masks with a given number of bits set in m_radiusMasks
+  std::vector<unsigned int> m_radiusOffsets;
+  //! True if SSSE3 instructions can be used
+  bool m_useSSSE3;
+};
+
+#endif
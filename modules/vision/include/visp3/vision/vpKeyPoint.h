@@ -55,6 +55,10 @@
 #include <visp3/core/vpPlane.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/vision/vpBasicKeyPoint.h>
+#include <visp3/vision/vpBinaryDescriptorMatcher.h>
+#include <visp3/vision/vpKeyPointDatabase.h>
+#include <visp3/vision/vpKeyPointPrediction.h>
+#include <visp3/vision/vpKeyPointTiling.h>
 #include <visp3/vision/vpPose.h>
 #ifdef VISP_HAVE_MODULE_IO
 #  include <visp3/io/vpImageIo.h>
@@ -577,6 +581,44 @@ public:
   */
   inline cv::Ptr<cv::DescriptorMatcher> getMatcher() const { return m_matcher; }
 
+  /*!
+    Get the native Hamming distance matcher used when the matcher name is
+    "HammingViSP", to set its number of threads or its multi-index hashing
+    parameters.
+
+    \return The native binary descriptor matcher.
+  */
+  inline vpBinaryDescriptorMatcher &getBinaryMatcher() { return m_binaryMatcher; }
+
+  /*!
+    Get the tiling used when the tiled detection is enabled, to set the
+    number of tiles, their overlap, the number of keypoints per tile or the
+    radius of the non-maximum suppression.
+
+    \return The tiling of the images.
+    \sa setUseTiledDetection()
+  */
+  inline vpKeyPointTiling &getTiling() { return m_tiling; }
+
+  /*!
+    Get the spatial index of the predicted keypoint locations used by the
+    tracking mode, to set the search radius around the predicted locations
+    or the size of the cells of the regions of interest.
+
+    \return The index of the predicted keypoint locations.
+    \sa setUseTracking()
+  */
+  inline vpKeyPointPrediction &getPrediction() { return m_prediction; }
+
+  /*!
+    Get the minimal number of matches found around the predicted locations
+    to use them to compute the pose in the tracking mode.
+
+    \return The minimal number of matches.
+    \sa setUseTracking()
+  */
+  inline unsigned int getTrackingMinNbMatches() const { return m_trackingMinNbMatches; }
+
   /*!
     Get the list of matches (correspondences between the indexes of the
     detected keypoints and the train keypoints).
@@ -649,7 +691,9 @@ public:
      Get the train descriptors matrix.
 
      \return : Matrix with descriptors values at each row for each train
-     keypoints (or reference keypoints).
+     keypoints (or reference keypoints). After loadLearningDatabase(), the
+     matrix may refer to the read-only mapping of the database, that it keeps
+     open: clone it before modifying it.
    */
   inline cv::Mat getTrainDescriptors() const { return m_trainDescriptors; }
 
@@ -670,6 +714,8 @@ public:
 #endif
 
   void loadLearningData(const std::string &filename, const bool binaryMode = false, const bool append = false);
+  void loadLearningDatabase(const std::string &filename, const std::vector<int> &classIds = std::vector<int>(),
+                            const std::vector<int> &imageIds = std::vector<int>());
 
   void match(const cv::Mat &trainDescriptors, const cv::Mat &queryDescriptors, std::vector<cv::DMatch> &matches,
              double &elapsedTime);
@@ -696,8 +742,18 @@ public:
 
   void reset();
 
+  /*!
+    Forget the previous poses used by the tracking mode: the keypoints are
+    detected in the whole image by the next call to matchPoint(). It has to
+    be called when the tracked object or the camera parameters change.
+
+    \sa setUseTracking()
+  */
+  inline void resetTracking() { m_trackingNbPoses = 0; }
+
   void saveLearningData(const std::string &filename, const bool binaryMode = false,
                         const bool saveTrainingImages = true);
+  void saveLearningDatabase(const std::string &filename, const bool saveTrainingImages = true);
 
   /*!
     Set if the covariance matrix has to be computed in the Virtual Visual
@@ -858,11 +914,17 @@ public:
        - BruteForce-Hamming
        - BruteForce-Hamming(2)
        - FlannBased
+       - HammingViSP (see vpBinaryDescriptorMatcher)
 
      L1 and L2 norms are preferable choices for SIFT and SURF descriptors,
      NORM_HAMMING should be used with ORB, BRISK and BRIEF, NORM_HAMMING2
      should be used with ORB when WTA_K==3 or 4.
 
+     HammingViSP is a native Hamming distance matcher for binary
+     descriptors. It is multi-threaded with OpenMP and uses multi-index
+     hashing for large learning databases, see getBinaryMatcher() to tune
+     it.
+
      \param matcherName : Name of the matcher.
    */
   inline void setMatcher(const std::string &matcherName)
@@ -1060,6 +1122,66 @@ public:
   */
   inline void setUseAffineDetection(const bool useAffine) { m_useAffineDetection = useAffine; }
 
+  /*!
+    Set if the keypoints must be detected and extracted in overlapping tiles
+    processed in parallel. The number of keypoints kept per tile gives a
+    better spatial distribution of the keypoints, and the keypoints of the
+    different tiles are merged with a non-maximum suppression (see
+    getTiling()). The descriptors are computed per tile only when a single
+    extractor is used.
+
+    As with the affine detection (see setUseAffineDetection()), the detectors
+    and the extractor are called at the same time from the OpenMP threads,
+    each thread on its own tile.
+
+    \param useTiles : True to use the tiled detection, false otherwise.
+  */
+  inline void setUseTiledDetection(const bool useTiles) { m_useTiledDetection = useTiles; }
+
+  /*!
+    Set the minimal number of matches found around the predicted locations
+    to use them to compute the pose in the tracking mode. With fewer
+    matches, the keypoints are detected in the whole image. By default 30.
+
+    \param minNbMatches : Minimal number of matches.
+    \sa setUseTracking()
+  */
+  inline void setTrackingMinNbMatches(const unsigned int minNbMatches) { m_trackingMinNbMatches = minNbMatches; }
+
+  /*!
+    Set if the object has to be tracked in a video by matchPoint() with the
+    camera parameters.
+
+    In the tracking mode, once a pose has been computed, the locations of the
+    train keypoints in the next image are predicted by projecting their 3D
+    points with a constant velocity model of the pose. The keypoints are
+    then detected only in the regions of interest around the predicted
+    locations, and each detected keypoint is only matched against the train
+    keypoints predicted in its neighborhood (see getPrediction()). The
+    regions of interest are processed in parallel as the tiles of the tiled
+    detection, with the overlap, the number of keypoints per region, the
+    non-maximum suppression and the number of threads of getTiling(). The
+    query keypoints are matched in parallel with the same number of threads.
+
+    A matching is accepted when the ratio between the distances of the best
+    and the second best candidates is lower than the ratio threshold (see
+    setMatchingRatioThreshold()). When fewer than getTrackingMinNbMatches()
+    matches are found or when the pose cannot be computed, the keypoints are
+    detected and matched in the whole image as without tracking, and the
+    tracking is lost until a new pose is computed.
+
+    The tracking mode requires 3D train points and is not used with the
+    affine detection.
+
+    \param useTracking : True to track the object, false otherwise.
+    \sa resetTracking()
+  */
+  inline void setUseTracking(const bool useTracking)
+  {
+    m_useTracking = useTracking;
+    resetTracking();
+  }
+
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   /*!
     Set if cross check method must be used to eliminate some false matches
@@ -1119,6 +1241,8 @@ public:
   inline void setUseSingleMatchFilter(const bool singleMatchFilter) { m_useSingleMatchFilter = singleMatchFilter; }
 
 private:
+  //! Native Hamming distance matcher used with the "HammingViSP" matcher name
+  vpBinaryDescriptorMatcher m_binaryMatcher;
   //! If true, compute covariance matrix if the user select the pose
   //! estimation method using ViSP
   bool m_computeCovariance;
@@ -1193,6 +1317,8 @@ private:
   std::vector<cv::Point3f> m_objectFilteredPoints;
   //! Elapsed time to compute the pose.
   double m_poseTime;
+  //! Predicted locations of the train keypoints used by the tracking mode
+  vpKeyPointPrediction m_prediction;
   /*! Matrix of descriptors (each row contains the descriptors values for each
      keypoints detected in the current image). */
   cv::Mat m_queryDescriptors;
@@ -1219,6 +1345,16 @@ private:
   //! Maximum error (in meter for the ViSP method) to decide if a point is an
   //! inlier or not.
   double m_ransacThreshold;
+  //! Tiling of the images used when m_useTiledDetection is true
+  vpKeyPointTiling m_tiling;
+  //! Last pose computed in the tracking mode
+  vpHomogeneousMatrix m_trackingcMo;
+  //! Pose computed before m_trackingcMo in the tracking mode
+  vpHomogeneousMatrix m_trackingcMoPrevious;
+  //! Minimal number of matches around the predicted locations
+  unsigned int m_trackingMinNbMatches;
+  //! Number of valid poses among m_trackingcMo and m_trackingcMoPrevious
+  unsigned int m_trackingNbPoses;
   //! Matrix of descriptors (each row contains the descriptors values for each
   //! keypoints
   // detected in the train images).
@@ -1234,6 +1370,8 @@ private:
   //! If true, use multiple affine transformations to cober the 6 affine
   //! parameters
   bool m_useAffineDetection;
+  //! If true, the matching is done with m_binaryMatcher instead of m_matcher
+  bool m_useBinaryMatcher;
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   //! If true, some false matches will be eliminate by keeping only pairs
   //! (i,j) such that for i-th query descriptor the j-th descriptor in the
@@ -1255,12 +1393,22 @@ private:
   //! If true, keep only pairs of keypoints where each train keypoint is
   //! matched to a single query keypoint
   bool m_useSingleMatchFilter;
+  //! If true, detect and extract the keypoints in tiles processed in parallel
+  bool m_useTiledDetection;
+  //! If true, detect and match the keypoints around the locations predicted
+  //! from the previous poses
+  bool m_useTracking;
 
   void affineSkew(double tilt, double phi, cv::Mat &img, cv::Mat &mask, cv::Mat &Ai);
 
   double computePoseEstimationError(const std::vector<std::pair<cv::KeyPoint, cv::Point3f> > &matchKeyPoints,
                                     const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo_est);
 
+  void detectTiled(const cv::Mat &matImg, const std::vector<vpKeyPointTiling::vpTile> &tiles,
+                   std::vector<cv::KeyPoint> &keyPoints, const cv::Mat &mask);
+  void extractTiled(const cv::Mat &matImg, const std::vector<vpKeyPointTiling::vpTile> &tiles,
+                    std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors);
+
   void filterMatches();
 
   void init();
@@ -1272,6 +1420,12 @@ private:
 
   void initFeatureNames();
 
+  bool matchPredictedPoints(const vpImage<unsigned char> &I, const vpCameraParameters &cam, const vpRect &rectangle);
+
+  void updateBinaryMatcher();
+
+  void writeTrainingImages(const std::string &parent, std::map<int, std::string> &mapOfImgPath);
+
   inline size_t myKeypointHash(const cv::KeyPoint &kp)
   {
     size_t _Val = 2166136261U, scale = 16777619U;
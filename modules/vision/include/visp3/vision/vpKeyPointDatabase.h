@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory-mapped database of learned keypoints.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKeyPointDatabase.h
+  \brief Memory-mapped database of learned keypoints, descriptors and 3D
+  points.
+*/
+
+#ifndef vpKeyPointDatabase_h
+#define vpKeyPointDatabase_h
+
+#include <visp3/core/vpConfig.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*!
+  \class vpKeyPointDatabase
+  \ingroup group_vision_keypoints
+
+  \brief Binary database of learned keypoints that is memory-mapped when
+  opened.
+
+  The file starts with a versioned header followed by sections aligned on
+  64 bytes:
+  - the keypoints (see vpKeyPointRecord);
+  - the descriptors, one row per keypoint, each row being padded to a
+    multiple of 16 bytes;
+  - the optional 3D coordinates (X, Y, Z as floats) of the keypoints;
+  - the group table: the keypoints are sorted by class id then by image
+    id, and each group (see vpGroupRecord) gives the contiguous range of the
+    keypoints sharing the same class id and image id;
+  - the optional relative paths of the training images.
+
+  Opening a database only maps the file and checks its header, so that it
+  does not depend on the number of keypoints. The mapping is read-only and
+  several processes opening the same database share the same physical
+  pages. When memory mapping is not
+  available, the file is read in memory.
+
+  getRanges() selects the keypoints of some classes or images without
+  reading the other ones, which allows to load only a part of a large
+  database. The descriptors are stored in the byte order of the machine that
+  wrote the database; open() throws an exception when it differs.
+
+  The database is written by vpKeyPoint::saveLearningDatabase() and read by
+  vpKeyPoint::loadLearningDatabase(), but it can also be used directly:
+  \code
+  vpKeyPointDatabase db;
+  db.open("learning.bin");
+  std::vector<int> classIds(1, 2);
+  std::vector<std::pair<unsigned int, unsigned int> > ranges;
+  db.getRanges(classIds, std::vector<int>(), ranges);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    for (unsigned int j = ranges[i].first; j < ranges[i].first + ranges[i].second; j++) {
+      const vpKeyPointDatabase::vpKeyPointRecord &kpt = db.getKeyPoints()[j];
+      const unsigned char *descriptor = db.getDescriptors() + j * db.getDescriptorStep();
+      // ...
+    }
+  }
+  \endcode
+*/
+class VISP_EXPORT vpKeyPointDatabase
+{
+public:
+  /*! Keypoint stored in the database (32 bytes). */
+  struct vpKeyPointRecord {
+    float u;        //!< Column coordinate of the keypoint
+    float v;        //!< Row coordinate of the keypoint
+    float size;     //!< Diameter of the keypoint neighborhood
+    float angle;    //!< Orientation of the keypoint
+    float response; //!< Detector response
+    int octave;     //!< Pyramid octave of the keypoint
+    int classId;    //!< Class id of the keypoint
+    int imageId;    //!< Training image id, -1 if there is no training image
+  };
+
+  /*! Contiguous range of keypoints sharing the same class and image ids. */
+  struct vpGroupRecord {
+    int classId;        //!< Class id of the keypoints
+    int imageId;        //!< Training image id of the keypoints
+    unsigned int first; //!< Index of the first keypoint
+    unsigned int count; //!< Number of keypoints
+  };
+
+  //! Version of the file format written by write()
+  static const unsigned int version = 1;
+
+  vpKeyPointDatabase();
+  virtual ~vpKeyPointDatabase();
+
+  void close();
+
+  /*!
+    Return the number of columns of a descriptor.
+  */
+  inline unsigned int getDescriptorCols() const { return m_descriptorCols; }
+  /*!
+    Return the descriptors, one row every getDescriptorStep() bytes.
+  */
+  inline const unsigned char *getDescriptors() const { return m_descriptors; }
+  /*!
+    Return the number of useful bytes of a descriptor.
+  */
+  inline unsigned int getDescriptorRowSize() const { return m_descriptorRowSize; }
+  /*!
+    Return the number of bytes between two consecutive descriptors.
+  */
+  inline unsigned int getDescriptorStep() const { return m_descriptorStep; }
+  /*!
+    Return the type of the descriptors given to write() (the OpenCV type
+    when the database is written by vpKeyPoint).
+  */
+  inline int getDescriptorType() const { return m_descriptorType; }
+  /*!
+    Return the class ids and image ids of the groups of keypoints.
+  */
+  inline const vpGroupRecord *getGroups() const { return m_groups; }
+  std::string getImagePath(int imageId) const;
+  void getImagePaths(std::map<int, std::string> &imagePaths) const;
+  /*!
+    Return the keypoints.
+  */
+  inline const vpKeyPointRecord *getKeyPoints() const { return m_keyPoints; }
+  /*!
+    Return the number of groups of keypoints.
+  */
+  inline unsigned int getNbGroups() const { return m_nbGroups; }
+  /*!
+    Return the number of keypoints.
+  */
+  inline unsigned int getNbKeyPoints() const { return m_nbKeyPoints; }
+  /*!
+    Return the 3D coordinates (X, Y, Z) of the keypoints, or NULL if the
+    database does not contain 3D points.
+  */
+  inline const float *getPoints() const { return m_points; }
+  void getRanges(const std::vector<int> &classIds, const std::vector<int> &imageIds,
+                 std::vector<std::pair<unsigned int, unsigned int> > &ranges) const;
+
+  /*!
+    Return true if the database contains the 3D coordinates of the
+    keypoints.
+  */
+  inline bool has3DPoints() const { return m_points != NULL; }
+  /*!
+    Return true if a database has been opened.
+  */
+  inline bool isOpen() const { return m_data != NULL; }
+  /*!
+    Return true if the database is memory-mapped, false if it has been read
+    in memory.
+  */
+  inline bool isMapped() const { return m_mapped; }
+
+  void open(const std::string &filename);
+
+  static void write(const std::string &filename, const std::vector<vpKeyPointRecord> &keyPoints,
+                    const unsigned char *descriptors, unsigned int descriptorRowSize, unsigned int descriptorStep,
+                    unsigned int descriptorCols, int descriptorType, const float *points = NULL,
+                    const std::map<int, std::string> &imagePaths = std::map<int, std::string>());
+
+private:
+  vpKeyPointDatabase(const vpKeyPointDatabase &);
+  vpKeyPointDatabase &operator=(const vpKeyPointDatabase &);
+
+  //! Mapped or read file
+  unsigned char *m_data;
+  //! Size of the file in bytes
+  size_t m_size;
+  //! True if m_data is a memory mapping
+  bool m_mapped;
+  //! Buffer used when memory mapping is not available
+  std::vector<double> m_buffer;
+  //! Keypoints section
+  const vpKeyPointRecord *m_keyPoints;
+  //! Number of keypoints
+  unsigned int m_nbKeyPoints;
+  //! Descriptors section
+  const unsigned char *m_descriptors;
+  //! Number of columns of a descriptor
+  unsigned int m_descriptorCols;
+  //! Number of useful bytes of a descriptor
+  unsigned int m_descriptorRowSize;
+  //! Number of bytes between two descriptors
+  unsigned int m_descriptorStep;
+  //! Type of the descriptors
+  int m_descriptorType;
+  //! 3D points section, NULL if there is no 3D point
+  const float *m_points;
+  //! Groups section
+  const vpGroupRecord *m_groups;
+  //! Number of groups
+  unsigned int m_nbGroups;
+  //! Images section: image id, offset and length of the path
+  const int *m_images;
+  //! Number of images
+  unsigned int m_nbImages;
+  //! Strings section
+  const char *m_strings;
+  //! Size of the strings section
+  size_t m_stringsSize;
+};
+
+#endif
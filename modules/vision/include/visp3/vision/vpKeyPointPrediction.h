@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Spatial index of the predicted locations of train keypoints.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKeyPointPrediction.h
+  \brief Spatial index of the predicted image locations of train keypoints,
+  used to track an object with keypoints.
+*/
+
+#ifndef vpKeyPointPrediction_h
+#define vpKeyPointPrediction_h
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/vision/vpKeyPointTiling.h>
+
+#include <vector>
+
+/*!
+  \class vpKeyPointPrediction
+  \ingroup group_vision_keypoints
+
+  \brief Index the predicted image locations of train keypoints to detect
+  and match the keypoints only around these locations.
+
+  When an object is tracked in a video, the location of its train keypoints
+  in the next image can be predicted from the previous poses. This class
+  stores the predicted locations in a regular grid:
+  - computeRois() gives the regions of the image that contain a predicted
+    location, enlarged by the search radius. The keypoints only have to be
+    detected in these regions;
+  - getCandidates() gives the train keypoints predicted in the search radius
+    of a detected keypoint. A detected keypoint only has to be matched
+    against these train keypoints.
+
+  vpKeyPoint uses this class in its tracking mode (see
+  vpKeyPoint::setUseTracking()).
+*/
+class VISP_EXPORT vpKeyPointPrediction
+{
+public:
+  vpKeyPointPrediction(double searchRadius = 20., unsigned int roiCellSize = 32);
+  virtual ~vpKeyPointPrediction() {}
+
+  void clear();
+
+  void computeRois(unsigned int overlap, std::vector<vpKeyPointTiling::vpTile> &rois) const;
+
+  void getCandidates(double u, double v, std::vector<unsigned int> &trainIndexes) const;
+  /*!
+    Return the number of predicted locations inside the image.
+  */
+  inline unsigned int getNbPredictions() const { return (unsigned int)m_trainIndexes.size(); }
+  /*!
+    Return the size in pixels of the cells used to build the regions of
+    interest.
+  */
+  inline unsigned int getRoiCellSize() const { return m_roiCellSize; }
+  /*!
+    Return the search radius in pixels around the predicted locations.
+  */
+  inline double getSearchRadius() const { return m_searchRadius; }
+
+  void setPredictions(unsigned int width, unsigned int height, const std::vector<double> &u,
+                      const std::vector<double> &v, const std::vector<unsigned int> &trainIndexes);
+  void setRoiCellSize(unsigned int cellSize);
+  void setSearchRadius(double radius);
+
+private:
+  //! Image width
+  unsigned int m_width;
+  //! Image height
+  unsigned int m_height;
+  //! Search radius around the predicted locations
+  double m_searchRadius;
+  //! Size of the cells of the regions of interest
+  unsigned int m_roiCellSize;
+  //! Column coordinates of the predicted locations inside the image
+  std::vector<double> m_u;
+  //! Row coordinates of the predicted locations inside the image
+  std::vector<double> m_v;
+  //! Train keypoint indexes of the predicted locations
+  std::vector<unsigned int> m_trainIndexes;
+  //! Size of the cells of the search grid
+  double m_gridCellSize;
+  //! Number of columns of the search grid
+  unsigned int m_gridCols;
+  //! Number of rows of the search grid
+  unsigned int m_gridRows;
+  //! Offsets of the cells of the search grid in m_gridIndexes
+  std::vector<unsigned int> m_gridOffsets;
+  //! Indexes of the predicted locations sorted by cell
+  std::vector<unsigned int> m_gridIndexes;
+};
+
+#endif
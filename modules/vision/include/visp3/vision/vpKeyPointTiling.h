@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tiling of an image for keypoint detection.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpKeyPointTiling.h
+  \brief Tiling of an image for parallel keypoint detection, with per tile
+  budgets and non-maximum suppression.
+*/
+
+#ifndef vpKeyPointTiling_h
+#define vpKeyPointTiling_h
+
+#include <visp3/core/vpConfig.h>
+
+#include <vector>
+
+/*!
+  \class vpKeyPointTiling
+  \ingroup group_vision_keypoints
+
+  \brief Split an image in overlapping tiles in which the keypoints are
+  detected and described independently.
+
+  The image is partitioned in getNbTilesX() x getNbTilesY() core regions.
+  Each tile is the core region enlarged by getOverlap() pixels on each side
+  (and clipped to the image), so that a detector or a descriptor working on
+  the tile sees the neighborhood of the keypoints of the core region. The
+  overlap has to be greater than the border used by the detector and than
+  the radius of the descriptor patch.
+
+  A keypoint detected in a tile is kept only if it lies in the core region
+  of the tile, and only the getMaxKeyPointsPerTile() keypoints with the
+  highest response are kept per tile (see selectKeyPoints()). This spreads
+  the keypoints over the whole image instead of concentrating them in the
+  most textured areas. Finally, the keypoints of all the tiles are merged
+  with a non-maximum suppression (see nonMaximumSuppression()) that removes
+  the duplicates found by two adjacent tiles.
+
+  This class is used by vpKeyPoint when the tiled detection is enabled (see
+  vpKeyPoint::setUseTiledDetection()), the tiles being processed in
+  parallel when ViSP is built with OpenMP.
+*/
+class VISP_EXPORT vpKeyPointTiling
+{
+public:
+  /*! Tile of an image: the detection window and its core region. */
+  struct vpTile {
+    int left;       //!< First column of the tile
+    int top;        //!< First row of the tile
+    int right;      //!< Column after the last column of the tile
+    int bottom;     //!< Row after the last row of the tile
+    int coreLeft;   //!< First column of the core region
+    int coreTop;    //!< First row of the core region
+    int coreRight;  //!< Column after the last column of the core region
+    int coreBottom; //!< Row after the last row of the core region
+  };
+
+  /*! Minimal description of a keypoint. */
+  struct vpTileKeyPoint {
+    float u;        //!< Column coordinate in the image
+    float v;        //!< Row coordinate in the image
+    float response; //!< Detector response, the highest the best
+  };
+
+  vpKeyPointTiling(unsigned int nbTilesX = 4, unsigned int nbTilesY = 4, unsigned int overlap = 32);
+  virtual ~vpKeyPointTiling() {}
+
+  void computeTiles(unsigned int width, unsigned int height, std::vector<vpTile> &tiles) const;
+
+  /*!
+    Return the maximal number of keypoints kept per tile, 0 if the number of
+    keypoints is not limited.
+  */
+  inline unsigned int getMaxKeyPointsPerTile() const { return m_maxKeyPointsPerTile; }
+  /*!
+    Return the number of columns of tiles.
+  */
+  inline unsigned int getNbTilesX() const { return m_nbTilesX; }
+  /*!
+    Return the number of rows of tiles.
+  */
+  inline unsigned int getNbTilesY() const { return m_nbTilesY; }
+  /*!
+    Return the number of threads used to process the tiles.
+
+    \sa setNbThreads()
+  */
+  inline int getNbThreads() const { return m_nbThreads; }
+  /*!
+    Return the minimal distance in pixels between two merged keypoints.
+  */
+  inline double getNmsRadius() const { return m_nmsRadius; }
+  /*!
+    Return the number of pixels added on each side of the core region of a
+    tile.
+  */
+  inline unsigned int getOverlap() const { return m_overlap; }
+
+  void nonMaximumSuppression(const std::vector<vpTileKeyPoint> &keyPoints, std::vector<unsigned int> &kept) const;
+
+  void selectKeyPoints(const vpTile &tile, const std::vector<vpTileKeyPoint> &keyPoints,
+                       std::vector<unsigned int> &selected) const;
+
+  /*!
+    Set the maximal number of keypoints kept per tile, 0 to keep all the
+    keypoints of the core regions. By default 0.
+  */
+  inline void setMaxKeyPointsPerTile(unsigned int maxKeyPoints) { m_maxKeyPointsPerTile = maxKeyPoints; }
+  void setNbTiles(unsigned int nbTilesX, unsigned int nbTilesY);
+  /*!
+    Set the number of threads used to process the tiles. A value of 0 lets
+    OpenMP choose the number of threads. This parameter is only used when
+    ViSP is built with OpenMP.
+  */
+  inline void setNbThreads(int nbThreads) { m_nbThreads = nbThreads; }
+  /*!
+    Set the minimal distance in pixels between two merged keypoints: a
+    keypoint closer than \e radius to a keypoint with a higher response is
+    removed. A value of 0 disables the suppression. By default 2 pixels.
+  */
+  inline void setNmsRadius(double radius) { m_nmsRadius = radius; }
+  /*!
+    Set the number of pixels added on each side of the core region of a
+    tile. By default 32 pixels.
+  */
+  inline void setOverlap(unsigned int overlap) { m_overlap = overlap; }
+
+private:
+  //! Number of columns of tiles
+  unsigned int m_nbTilesX;
+  //! Number of rows of tiles
+  unsigned int m_nbTilesY;
+  //! Number of pixels added on each side of the core regions
+  unsigned int m_overlap;
+  //! Maximal number of keypoints per tile, 0 if not limited
+  unsigned int m_maxKeyPointsPerTile;
+  //! Radius of the non-maximum suppression
+  double m_nmsRadius;
+  //! Number of threads
+  int m_nbThreads;
+};
+
+#endif
@@ -52,6 +52,7 @@
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpRGBa.h>
+#include <visp3/core/vpRobust.h>
 #include <visp3/vision/vpHomography.h>
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
 #include <visp3/core/vpList.h>
@@ -98,8 +99,14 @@ public:
                              initialization from Lagrange or Dementhon aproach */
     DEMENTHON_VIRTUAL_VS, /*!< Non linear virtual visual servoing approach
                              initialized by Dementhon approach */
-    LAGRANGE_VIRTUAL_VS   /*!< Non linear virtual visual servoing approach
+    LAGRANGE_VIRTUAL_VS,  /*!< Non linear virtual visual servoing approach
                              initialized by Lagrange approach */
+    P3P,                  /*!< Closed-form perspective-3-point solver applied on the three first
+                             points, the other points being used to select the solution among
+                             the up to four ones (does't need an initialization) */
+    EPNP,                 /*!< Linear O(n) EPnP approach (does't need an initialization) */
+    EPNP_VIRTUAL_VS       /*!< Non linear virtual visual servoing approach
+                             initialized by EPnP approach */
   } vpPoseMethodType;
 
   enum RANSAC_FILTER_FLAGS {
@@ -152,6 +159,46 @@ private:
   //! epsilon
   double vvsEpsilon;
 
+  //! If true, stop the RANSAC as soon as the number of trials ensures with
+  //! probability ransacProbability that an outlier free sample was drawn
+  bool useAdaptiveRansac;
+  //! Probability used by the adaptive RANSAC termination criterion
+  double ransacProbability;
+  //! Matching score of each point (the higher the better), used for PROSAC
+  //! ordered sampling
+  std::vector<double> ransacScores;
+  //! If true, the RANSAC hypotheses are computed with P3P and the final pose
+  //! is initialized with EPnP
+  bool useP3PRansac;
+
+  //! Coordinates (oX, oY, oZ, x, y) of the points stored contiguously for
+  //! the virtual visual servoing; reused between calls to avoid allocations
+  std::vector<double> vvsPoints;
+  //! Residuals and weights of the points for the robust virtual visual
+  //! servoing
+  vpColVector vvsResiduals, vvsWeights;
+  //! M-estimator of the robust virtual visual servoing
+  vpRobust vvsRobust;
+
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+  // State shared between the parallel RANSAC workers
+  struct RansacSharedState {
+    explicit RansacSharedState(int maxTrials)
+      : m_abort(false), m_bestNbInliers(0), m_nbTrials(0), m_maxTrials(maxTrials)
+    {
+    }
+
+    //! Set when a worker reached the consensus
+    std::atomic<bool> m_abort;
+    //! Best number of inliers found by all the workers
+    std::atomic<unsigned int> m_bestNbInliers;
+    //! Number of trials started by all the workers
+    std::atomic<int> m_nbTrials;
+    //! Number of trials to perform, decreased by the adaptive termination
+    std::atomic<int> m_maxTrials;
+  };
+#endif
+
   // For parallel RANSAC
   class RansacFunctor
   {
@@ -161,18 +208,9 @@ private:
                   const bool checkDegeneratePoints_, const std::vector<vpPoint> &listOfUniquePoints_,
                   bool (*func_)(const vpHomogeneousMatrix &)
               #ifdef VISP_HAVE_CPP11_COMPATIBILITY
-                  , std::atomic<bool> &abort
+                  , RansacSharedState *sharedState = NULL
               #endif
-                  )
-      :
-    #ifdef VISP_HAVE_CPP11_COMPATIBILITY
-        m_abort(abort),
-    #endif
-        m_best_consensus(), m_checkDegeneratePoints(checkDegeneratePoints_), m_cMo(cMo_), m_foundSolution(false),
-        m_func(func_), m_initial_seed(initial_seed_), m_listOfUniquePoints(listOfUniquePoints_), m_nbInliers(0),
-        m_ransacMaxTrials(ransacMaxTrials_), m_ransacNbInlierConsensus(ransacNbInlierConsensus_),
-        m_ransacThreshold(ransacThreshold_)
-    { }
+                  );
 
     void operator()() { m_foundSolution = poseRansacImpl(); }
 
@@ -185,9 +223,13 @@ private:
 
     unsigned int getNbInliers() const { return m_nbInliers; }
 
+    void setAdaptiveTermination(double probability);
+    void setP3PHypotheses(bool useP3P);
+    void setProsacSampling(const std::vector<int> &growth);
+
   private:
 #ifdef VISP_HAVE_CPP11_COMPATIBILITY
-    std::atomic<bool> &m_abort;
+    RansacSharedState *m_sharedState;
 #endif
     std::vector<unsigned int> m_best_consensus;
     bool m_checkDegeneratePoints;
@@ -200,6 +242,24 @@ private:
     int m_ransacMaxTrials;
     unsigned int m_ransacNbInlierConsensus;
     double m_ransacThreshold;
+    // Coordinates of the points stored as structure of arrays for the
+    // consensus evaluation
+    std::vector<double> m_oX, m_oY, m_oZ, m_x, m_y;
+    bool m_adaptive;
+    double m_probability;
+    // PROSAC growth function: m_prosacGrowth[n] is the trial index from which
+    // the n+1 first points are sampled. Empty for a uniform sampling.
+    std::vector<int> m_prosacGrowth;
+    int m_nbTrials;
+    int m_maxTrials;
+    // If true, compute the hypotheses with P3P instead of Lagrange and Dementhon
+    bool m_useP3P;
+
+    bool drawSample(int trial, std::vector<bool> &usedPt, vpPose &poseMin);
+    unsigned int getBestNbInliers() const;
+    int nextTrial();
+    unsigned int randomIndex(unsigned int size);
+    void updateBestNbInliers(unsigned int nbInliers);
 
     bool poseRansacImpl();
   };
@@ -210,6 +270,10 @@ protected:
   // method used in poseDementhonPlan()
   int calculArbreDementhon(vpMatrix &b, vpColVector &U, vpHomogeneousMatrix &cMo);
 
+  // methods used in poseVirtualVS() and poseVirtualVSrobust()
+  void computeInteractionMatrixVVS(const vpHomogeneousMatrix &cMo, vpMatrix &L, vpColVector &error);
+  unsigned int initVirtualVS();
+
 public:
   vpPose();
   virtual ~vpPose();
@@ -225,9 +289,11 @@ public:
   void init();
   void poseDementhonPlan(vpHomogeneousMatrix &cMo);
   void poseDementhonNonPlan(vpHomogeneousMatrix &cMo);
+  void poseEPnP(vpHomogeneousMatrix &cMo);
   void poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type = 0);
   void poseLagrangeNonPlan(vpHomogeneousMatrix &cMo);
   void poseLowe(vpHomogeneousMatrix &cMo);
+  void poseP3P(vpHomogeneousMatrix &cMo);
   bool poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneousMatrix &) = NULL);
   void poseVirtualVSrobust(vpHomogeneousMatrix &cMo);
   void poseVirtualVS(vpHomogeneousMatrix &cMo);
@@ -329,6 +395,73 @@ public:
   */
   inline void setUseParallelRansac(const bool use) { useParallelRansac = use; }
 
+  /*!
+    \return True if the adaptive RANSAC termination criterion is used.
+
+    \sa setUseAdaptiveRansac
+  */
+  inline bool getUseAdaptiveRansac() const { return useAdaptiveRansac; }
+
+  /*!
+    Enable or disable the adaptive RANSAC termination criterion. Each time a
+    better consensus set is found, the number of trials is reduced to the
+    number of trials ensuring, with the probability set by
+    setRansacProbability(), that at least one outlier free sample was drawn
+    (see computeRansacIterations()). The maximum number of trials set with
+    setRansacMaxTrials() remains an upper bound.
+
+    With the parallel RANSAC, the best consensus and the number of trials are
+    shared between the threads.
+
+    \note By default the adaptive termination is disabled.
+    \sa setRansacProbability, setUseParallelRansac
+  */
+  inline void setUseAdaptiveRansac(const bool use) { useAdaptiveRansac = use; }
+
+  /*!
+    Get the probability used by the adaptive RANSAC termination criterion.
+
+    \sa setRansacProbability
+  */
+  inline double getRansacProbability() const { return ransacProbability; }
+
+  /*!
+    Set the probability that at least one of the random samples is free from
+    outliers, used by the adaptive RANSAC termination criterion.
+
+    \param p : Probability in ]0, 1[. Default value is 0.99.
+    \sa setUseAdaptiveRansac
+  */
+  void setRansacProbability(const double p)
+  {
+    if (p > 0. && p < 1.) {
+      ransacProbability = p;
+    } else {
+      throw vpException(vpException::badValue, "The RANSAC probability must be in ]0, 1[.");
+    }
+  }
+
+  void setRansacScores(const std::vector<double> &scores);
+
+  /*!
+    \return True if the RANSAC hypotheses are computed with the P3P solver.
+
+    \sa setUseP3PRansac
+  */
+  inline bool getUseP3PRansac() const { return useP3PRansac; }
+
+  /*!
+    Set if the RANSAC should use the minimal solvers. When enabled, each
+    hypothesis is computed with the closed-form P3P solver (see poseP3P())
+    from three points of the sample, the fourth one being used to select the
+    right solution, instead of computing both a Lagrange and a Dementhon pose.
+    The final pose is then initialized with EPnP (see poseEPnP()) on the
+    consensus set before the virtual visual servoing refinement.
+
+    \note By default the Lagrange and Dementhon approaches are used.
+  */
+  inline void setUseP3PRansac(const bool use) { useP3PRansac = use; }
+
   /*!
     Get the vector of points.
 
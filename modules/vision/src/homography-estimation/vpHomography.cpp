@@ -601,17 +601,12 @@ void vpHomography::robust(const std::vector<double> &xb, const std::vector<doubl
     vpMatrix A(nbLinesA * n, 8);
     vpColVector X(8);
     vpColVector Y(nbLinesA * n);
-    vpMatrix W(nbLinesA * n, nbLinesA * n); // Weight matrix
 
     vpColVector w(nbLinesA * n);
 
     // All the weights are set to 1 at the beginning to use a classical least
     // square scheme
     w = 1;
-    // Update the square matrix associated to the weights
-    for (unsigned int i = 0; i < nbLinesA * n; i++) {
-      W[i][i] = w[i];
-    }
 
     // build matrix A
     for (unsigned int i = 0; i < n; i++) {
@@ -637,34 +632,37 @@ void vpHomography::robust(const std::vector<double> &xb, const std::vector<doubl
       Y[nbLinesA * i + 1] = yan[i];
     }
 
-    vpMatrix WA;
-    vpMatrix WAp;
+    // The weight matrix W is diagonal: W * A and W * Y are computed by
+    // scaling the rows instead of building a (2n x 2n) matrix
+    vpMatrix WA(nbLinesA * n, 8);
+    vpColVector WY(nbLinesA * n);
+    vpColVector residu(nbLinesA * n);
     unsigned int iter = 0;
     vpRobust r(nbLinesA * n); // M-Estimator
 
     while (iter < niter) {
-      WA = W * A;
+      for (unsigned int i = 0; i < nbLinesA * n; i++) {
+        for (unsigned int j = 0; j < 8; j++) {
+          WA[i][j] = w[i] * A[i][j];
+        }
+        WY[i] = w[i] * Y[i];
+      }
 
-      X = WA.pseudoInverse(1e-26) * W * Y;
-      vpColVector residu;
-      residu = Y - A * X;
+      X = WA.pseudoInverse(1e-26) * WY;
+      for (unsigned int i = 0; i < nbLinesA * n; i++) {
+        residu[i] = Y[i];
+        for (unsigned int j = 0; j < 8; j++) {
+          residu[i] -= A[i][j] * X[j];
+        }
+      }
 
       // Compute the weights using the Tukey biweight M-Estimator
       r.setIteration(iter);
       r.MEstimator(vpRobust::TUKEY, residu, w);
-
-      // Update the weights matrix
-      for (unsigned int i = 0; i < n * nbLinesA; i++) {
-        W[i][i] = w[i];
-      }
       // Build the homography
       for (unsigned int i = 0; i < 8; i++)
         aHbn.data[i] = X[i];
       aHbn[2][2] = 1;
-      {
-        vpMatrix aHbnorm = aHbn.convert();
-        aHbnorm /= aHbnorm[2][2];
-      }
 
       iter++;
     }
@@ -687,19 +685,12 @@ void vpHomography::robust(const std::vector<double> &xb, const std::vector<doubl
     }
 
     residual = 0;
-    vpColVector a(3), b(3), c(3);
     for (unsigned int i = 0; i < n; i++) {
       if (inliers[i]) {
-        a[0] = xa[i];
-        a[1] = ya[i];
-        a[2] = 1;
-        b[0] = xb[i];
-        b[1] = yb[i];
-        b[2] = 1;
-
-        c = aHb * b;
-        c /= c[2];
-        residual += (a - c).sumSquare();
+        double z = aHb[2][0] * xb[i] + aHb[2][1] * yb[i] + aHb[2][2];
+        double ex = xa[i] - (aHb[0][0] * xb[i] + aHb[0][1] * yb[i] + aHb[0][2]) / z;
+        double ey = ya[i] - (aHb[1][0] * xb[i] + aHb[1][1] * yb[i] + aHb[1][2]) / z;
+        residual += ex * ex + ey * ey;
       }
     }
 
@@ -152,22 +152,19 @@ void vpHomography::HartleyDenormalization(vpHomography &aHbn, vpHomography &aHb,
   // en fonction des deux normalisations effectuees au debut sur
   // les points: aHb = T2^ aHbn T1
   vpMatrix T1(3, 3);
-  vpMatrix T2(3, 3);
   vpMatrix T2T(3, 3);
 
   T1.eye();
-  T2.eye();
   T2T.eye();
 
   T1[0][0] = T1[1][1] = coef1;
   T1[0][2] = -coef1 * xg1;
   T1[1][2] = -coef1 * yg1;
 
-  T2[0][0] = T2[1][1] = coef2;
-  T2[0][2] = -coef2 * xg2;
-  T2[1][2] = -coef2 * yg2;
-
-  T2T = T2.pseudoInverse(1e-16);
+  // Inverse of T2 = [coef2 0 -coef2*xg2; 0 coef2 -coef2*yg2; 0 0 1]
+  T2T[0][0] = T2T[1][1] = 1. / coef2;
+  T2T[0][2] = xg2;
+  T2T[1][2] = yg2;
 
   vpMatrix aHbn_(3, 3);
   for (unsigned int i = 0; i < 3; i++)
@@ -36,6 +36,7 @@
  *
  *****************************************************************************/
 
+#include <visp3/core/vpCPUFeatures.h>
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpRansac.h>
 #include <visp3/vision/vpHomography.h>
@@ -44,6 +45,20 @@
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpMeterPixelConversion.h>
 
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+
+#ifdef VISP_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
 #define vpEps 1e-6
 
 /*!
@@ -271,6 +286,211 @@ double vpHomography::computeResidual(vpColVector &x, vpColVector &M, vpColVector
 
   return 0;
 }
+
+namespace
+{
+/*
+  Same test as iscolinear() on the 2D points (x1,y1), (x2,y2), (x3,y3).
+*/
+inline bool isColinear2D(double x1, double y1, double x2, double y2, double x3, double y3)
+{
+  double z = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+  return (z * z < vpEps);
+}
+
+/*
+  Return true if 3 of the 4 points given by their indexes are colinear in
+  image a or in image b.
+*/
+bool isDegenerateSample(const std::vector<double> &xb, const std::vector<double> &yb, const std::vector<double> &xa,
+                        const std::vector<double> &ya, const unsigned int *ind)
+{
+  for (unsigned int i = 0; i < 2; i++) {
+    for (unsigned int j = i + 1; j < 3; j++) {
+      for (unsigned int k = j + 1; k < 4; k++) {
+        if (isColinear2D(xa[ind[i]], ya[ind[i]], xa[ind[j]], ya[ind[j]], xa[ind[k]], ya[ind[k]]) ||
+            isColinear2D(xb[ind[i]], yb[ind[i]], xb[ind[j]], yb[ind[j]], xb[ind[k]], yb[ind[k]])) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/*
+  Compute the row major 3x3 matrix S that maps the corners (0,0), (1,0),
+  (1,1) and (0,1) of the unit square to the 4 given points (Heckbert's
+  square to quadrilateral mapping). Return false when the 4 points are
+  degenerate.
+*/
+bool squareToQuad(const double *x, const double *y, double *S)
+{
+  double dx1 = x[1] - x[2], dx2 = x[3] - x[2], dx3 = x[0] - x[1] + x[2] - x[3];
+  double dy1 = y[1] - y[2], dy2 = y[3] - y[2], dy3 = y[0] - y[1] + y[2] - y[3];
+  double den = dx1 * dy2 - dx2 * dy1;
+  if (std::fabs(den) <= std::numeric_limits<double>::epsilon()) {
+    return false;
+  }
+  double g = (dx3 * dy2 - dx2 * dy3) / den;
+  double h = (dx1 * dy3 - dx3 * dy1) / den;
+
+  S[0] = x[1] - x[0] + g * x[1];
+  S[1] = x[3] - x[0] + h * x[3];
+  S[2] = x[0];
+  S[3] = y[1] - y[0] + g * y[1];
+  S[4] = y[3] - y[0] + h * y[3];
+  S[5] = y[0];
+  S[6] = g;
+  S[7] = h;
+  S[8] = 1.;
+  return true;
+}
+
+/*
+  C = A * B for row major 3x3 matrices.
+*/
+inline void multiply3x3(const double *A, const double *B, double *C)
+{
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      C[3 * i + j] = A[3 * i] * B[j] + A[3 * i + 1] * B[3 + j] + A[3 * i + 2] * B[6 + j];
+    }
+  }
+}
+
+/*
+  Closed form homography aHb (row major, aHb[8] = 1) that maps the 4 points
+  (xb,yb) to the 4 points (xa,ya). Return false if the configuration is
+  degenerate.
+*/
+bool homographyFrom4Points(const double *xb, const double *yb, const double *xa, const double *ya, double *aHb)
+{
+  double Sb[9], Sa[9];
+  if (!squareToQuad(xb, yb, Sb) || !squareToQuad(xa, ya, Sa)) {
+    return false;
+  }
+
+  // The adjugate of Sb is proportional to its inverse
+  double adj[9];
+  adj[0] = Sb[4] * Sb[8] - Sb[5] * Sb[7];
+  adj[1] = Sb[2] * Sb[7] - Sb[1] * Sb[8];
+  adj[2] = Sb[1] * Sb[5] - Sb[2] * Sb[4];
+  adj[3] = Sb[5] * Sb[6] - Sb[3] * Sb[8];
+  adj[4] = Sb[0] * Sb[8] - Sb[2] * Sb[6];
+  adj[5] = Sb[2] * Sb[3] - Sb[0] * Sb[5];
+  adj[6] = Sb[3] * Sb[7] - Sb[4] * Sb[6];
+  adj[7] = Sb[1] * Sb[6] - Sb[0] * Sb[7];
+  adj[8] = Sb[0] * Sb[4] - Sb[1] * Sb[3];
+
+  multiply3x3(Sa, adj, aHb);
+  if (std::fabs(aHb[8]) <= std::numeric_limits<double>::epsilon()) {
+    return false;
+  }
+  double inv = 1. / aHb[8];
+  for (unsigned int i = 0; i < 9; i++) {
+    aHb[i] *= inv;
+  }
+  return true;
+}
+
+/*
+  Squared transfer error of the point i.
+*/
+inline double transferError(const double *H, double xb, double yb, double xa, double ya)
+{
+  double w = H[6] * xb + H[7] * yb + H[8];
+  double ex = xa - (H[0] * xb + H[1] * yb + H[2]) / w;
+  double ey = ya - (H[3] * xb + H[4] * yb + H[5]) / w;
+  return ex * ex + ey * ey;
+}
+
+/*
+  Number of couples of points whose transfer error is lower or equal to
+  the threshold. th2 is the squared threshold.
+*/
+unsigned int countInliers(const double *H, const double *xb, const double *yb, const double *xa, const double *ya,
+                          unsigned int n, double th2)
+{
+  unsigned int nbInliers = 0;
+  unsigned int i = 0;
+
+#if VISP_HAVE_SSE2
+  if (vpCPUFeatures::checkSSE2() && n >= 2) {
+    const __m128d h0 = _mm_set1_pd(H[0]), h1 = _mm_set1_pd(H[1]), h2 = _mm_set1_pd(H[2]);
+    const __m128d h3 = _mm_set1_pd(H[3]), h4 = _mm_set1_pd(H[4]), h5 = _mm_set1_pd(H[5]);
+    const __m128d h6 = _mm_set1_pd(H[6]), h7 = _mm_set1_pd(H[7]), h8 = _mm_set1_pd(H[8]);
+    const __m128d v_th2 = _mm_set1_pd(th2);
+
+    for (; i <= n - 2; i += 2) {
+      __m128d v_xb = _mm_loadu_pd(xb + i);
+      __m128d v_yb = _mm_loadu_pd(yb + i);
+      __m128d v_w = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h6, v_xb), _mm_mul_pd(h7, v_yb)), h8);
+      __m128d v_u = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h0, v_xb), _mm_mul_pd(h1, v_yb)), h2);
+      __m128d v_v = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h3, v_xb), _mm_mul_pd(h4, v_yb)), h5);
+      __m128d v_ex = _mm_sub_pd(_mm_loadu_pd(xa + i), _mm_div_pd(v_u, v_w));
+      __m128d v_ey = _mm_sub_pd(_mm_loadu_pd(ya + i), _mm_div_pd(v_v, v_w));
+      __m128d v_e2 = _mm_add_pd(_mm_mul_pd(v_ex, v_ex), _mm_mul_pd(v_ey, v_ey));
+      int mask = _mm_movemask_pd(_mm_cmple_pd(v_e2, v_th2));
+      nbInliers += (unsigned int)((mask & 1) + (mask >> 1));
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (transferError(H, xb[i], yb[i], xa[i], ya[i]) <= th2) {
+      nbInliers++;
+    }
+  }
+  return nbInliers;
+}
+
+/*
+  Return a random index in [0, size[.
+*/
+inline unsigned int randomIndex(unsigned int size, unsigned int &seed)
+{
+#if defined(_WIN32) && (defined(_MSC_VER) || defined(__MINGW32__)) || defined(ANDROID)
+  (void)seed;
+  return (unsigned int)rand() % size;
+#else
+  return (unsigned int)rand_r(&seed) % size;
+#endif
+}
+
+/*
+  Read and set a flag shared by the RANSAC threads. Atomic accesses need
+  OpenMP 3.1; older versions use a critical section.
+*/
+inline bool readSharedFlag(const bool &flag)
+{
+  bool value;
+#if defined _OPENMP && _OPENMP >= 201107 // OpenMP 3.1
+#pragma omp atomic read
+  value = flag;
+#elif defined(VISP_HAVE_OPENMP)
+#pragma omp critical(vpHomographyRansacFlag)
+  value = flag;
+#else
+  value = flag;
+#endif
+  return value;
+}
+
+inline void setSharedFlag(bool &flag)
+{
+#if defined _OPENMP && _OPENMP >= 201107 // OpenMP 3.1
+#pragma omp atomic write
+  flag = true;
+#elif defined(VISP_HAVE_OPENMP)
+#pragma omp critical(vpHomographyRansacFlag)
+  flag = true;
+#else
+  flag = true;
+#endif
+}
+}
+
 #endif //#ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 void vpHomography::initRansac(unsigned int n, double *xb, double *yb, double *xa, double *ya, vpColVector &x)
@@ -286,6 +506,7 @@ void vpHomography::initRansac(unsigned int n, double *xb, double *yb, double *xa
   }
 }
 
+
 /*!
 
   From couples of matched points \f$^a{\bf p}=(x_a,y_a,1)\f$ in image a
@@ -293,14 +514,24 @@ void vpHomography::initRansac(unsigned int n, double *xb, double *yb, double *xa
   computes the homography matrix by resolving \f$^a{\bf p} = ^a{\bf H}_b\;
   ^b{\bf p}\f$ using Ransac algorithm.
 
+  Each Ransac hypothesis is computed from 4 randomly selected couples of
+  points using a closed form solution (the composition of the two unit
+  square to quadrilateral mappings), without building any linear system.
+  When \e normalization is set, the points are normalized only once before
+  the trials. The hypotheses are scored over all the points using SSE2
+  instructions when available and the trials are shared between threads when
+  ViSP is built with OpenMP. The final homography is then estimated with
+  DLT() from the largest consensus.
+
   \param xb, yb : Coordinates vector of matched points in image b. These
   coordinates are expressed in meters. \param xa, ya : Coordinates vector of
   matched points in image a. These coordinates are expressed in meters. \param
   aHb : Estimated homography that relies the transformation from image a to
   image b. \param inliers : Vector that indicates if a matched point is an
-  inlier (true) or an outlier (false). \param residual : Global residual
-  computed as \f$r = \sqrt{1/n \sum_{inliers} {\| {^a{\bf p} - {\hat{^a{\bf
-  H}_b}} {^b{\bf p}}} \|}^{2}}\f$ with \f$n\f$ the number of inliers.
+  inlier (true) or an outlier (false) of the largest consensus. \param
+  residual : Global residual computed as \f$r = \sqrt{1/n \sum_{inliers} {\|
+  {^a{\bf p} - {\hat{^a{\bf H}_b}} {^b{\bf p}}} \|}^{2}}\f$ with \f$n\f$ the
+  number of inliers.
 
   \param nbInliersConsensus : Minimal number of points requested to fit the
   estimated homography.
@@ -327,174 +558,162 @@ bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<doubl
   if (n < 4)
     throw(vpException(vpException::fatalError, "There must be at least 4 matched points"));
 
-  vpUniRand random((const long)time(NULL));
-
-  std::vector<unsigned int> best_consensus;
-  std::vector<unsigned int> cur_consensus;
-  std::vector<unsigned int> cur_outliers;
-  std::vector<unsigned int> cur_randoms;
-
-  std::vector<unsigned int> rand_ind;
-
-  unsigned int nbMinRandom = 4;
-  unsigned int ransacMaxTrials = 1000;
-  unsigned int maxDegenerateIter = 1000;
-
-  unsigned int nbTrials = 0;
-  unsigned int nbDegenerateIter = 0;
-  unsigned int nbInliers = 0;
-
-  bool foundSolution = false;
-
-  std::vector<double> xa_rand(nbMinRandom);
-  std::vector<double> ya_rand(nbMinRandom);
-  std::vector<double> xb_rand(nbMinRandom);
-  std::vector<double> yb_rand(nbMinRandom);
-
-  if (inliers.size() != n)
-    inliers.resize(n);
-
-  while (nbTrials < ransacMaxTrials && nbInliers < nbInliersConsensus) {
-    cur_outliers.clear();
-    cur_randoms.clear();
-
-    bool degenerate = true;
-    while (degenerate == true) {
-      std::vector<bool> usedPt(n, false);
+  const unsigned int nbMinRandom = 4;
+  const int ransacMaxTrials = 1000;
+  const unsigned int maxDegenerateIter = 1000;
+  const double th2 = threshold * threshold;
+
+  // Normalize the points once for all the hypotheses
+  std::vector<double> xbn, ybn, xan, yan;
+  double xg1 = 0., yg1 = 0., coef1 = 1., xg2 = 0., yg2 = 0., coef2 = 1.;
+  if (normalization) {
+    vpHomography::HartleyNormalization(xb, yb, xbn, ybn, xg1, yg1, coef1);
+    vpHomography::HartleyNormalization(xa, ya, xan, yan, xg2, yg2, coef2);
+  }
+  const std::vector<double> &xb_h = normalization ? xbn : xb;
+  const std::vector<double> &yb_h = normalization ? ybn : yb;
+  const std::vector<double> &xa_h = normalization ? xan : xa;
+  const std::vector<double> &ya_h = normalization ? yan : ya;
+
+  // aHb = Ta^-1 aHbn Tb
+  const double Tb[9] = {coef1, 0., -coef1 * xg1, 0., coef1, -coef1 * yg1, 0., 0., 1.};
+  const double Ta_inv[9] = {1. / coef2, 0., xg2, 0., 1. / coef2, yg2, 0., 0., 1.};
+
+  double bestH[9];
+  unsigned int bestNbInliers = 0;
+  bool stop = false;
+  bool degenerateError = false;
+  unsigned int seed = (unsigned int)time(NULL);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel
+#endif
+  {
+#ifdef VISP_HAVE_OPENMP
+    unsigned int thread_seed = seed + 7919 * (unsigned int)omp_get_thread_num();
+#else
+    unsigned int thread_seed = seed;
+#endif
+    unsigned int localBestNbInliers = 0;
+    unsigned int ind[4];
+    double xb_rand[4], yb_rand[4], xa_rand[4], ya_rand[4];
+    double Hn[9], HnTb[9], H[9];
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic, 8)
+#endif
+    for (int trial = 0; trial < ransacMaxTrials; trial++) {
+      if (readSharedFlag(stop)) {
+        continue;
+      }
 
-      rand_ind.clear();
-      for (unsigned int i = 0; i < nbMinRandom; i++) {
-        // Generate random indicies in the range 0..n
-        unsigned int r = (unsigned int)ceil(random() * n) - 1;
-        while (usedPt[r]) {
-          r = (unsigned int)ceil(random() * n) - 1;
+      bool degenerate = true;
+      unsigned int nbDegenerateIter = 0;
+      while (degenerate) {
+        for (unsigned int i = 0; i < nbMinRandom; i++) {
+          bool used = true;
+          while (used) {
+            ind[i] = randomIndex(n, thread_seed);
+            used = false;
+            for (unsigned int j = 0; j < i; j++) {
+              used = used || (ind[j] == ind[i]);
+            }
+          }
+          xb_rand[i] = xb_h[ind[i]];
+          yb_rand[i] = yb_h[ind[i]];
+          xa_rand[i] = xa_h[ind[i]];
+          ya_rand[i] = ya_h[ind[i]];
         }
-        usedPt[r] = true;
-        rand_ind.push_back(r);
 
-        xa_rand[i] = xa[r];
-        ya_rand[i] = ya[r];
-        xb_rand[i] = xb[r];
-        yb_rand[i] = yb[r];
+        degenerate = isDegenerateSample(xb, yb, xa, ya, ind) || !homographyFrom4Points(xb_rand, yb_rand, xa_rand,
+                                                                                       ya_rand, Hn);
+        if (degenerate && ++nbDegenerateIter > maxDegenerateIter) {
+          break;
+        }
+      }
+      if (degenerate) {
+        setSharedFlag(degenerateError);
+        setSharedFlag(stop);
+        continue;
       }
 
-      try {
-        if (!vpHomography::degenerateConfiguration(xb_rand, yb_rand, xa_rand, ya_rand)) {
-          vpHomography::DLT(xb_rand, yb_rand, xa_rand, ya_rand, aHb, normalization);
-          degenerate = false;
+      if (normalization) {
+        multiply3x3(Hn, Tb, HnTb);
+        multiply3x3(Ta_inv, HnTb, H);
+        double inv = 1. / H[8];
+        for (unsigned int i = 0; i < 9; i++) {
+          H[i] *= inv;
+        }
+      } else {
+        for (unsigned int i = 0; i < 9; i++) {
+          H[i] = Hn[i];
         }
-      } catch (...) {
-        degenerate = true;
       }
 
-      nbDegenerateIter++;
-
-      if (nbDegenerateIter > maxDegenerateIter) {
-        vpERROR_TRACE("Unable to select a nondegenerate data set");
-        throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
+      // Residual of the random points
+      double r = 0;
+      for (unsigned int i = 0; i < nbMinRandom; i++) {
+        r += transferError(H, xb[ind[i]], yb[ind[i]], xa[ind[i]], ya[ind[i]]);
+      }
+      r = sqrt(r / nbMinRandom);
+      if (!(r < threshold)) {
+        continue;
       }
-    }
-
-    aHb /= aHb[2][2];
-
-    // Computing Residual
-    double r = 0;
-    vpColVector a(3), b(3), c(3);
-    for (unsigned int i = 0; i < nbMinRandom; i++) {
-      a[0] = xa_rand[i];
-      a[1] = ya_rand[i];
-      a[2] = 1;
-      b[0] = xb_rand[i];
-      b[1] = yb_rand[i];
-      b[2] = 1;
-
-      c = aHb * b;
-      c /= c[2];
-      r += (a - c).sumSquare();
-      // cout << "point " <<i << "  " << (a-c).sumSquare()  <<endl ;;
-    }
 
-    // Finding inliers & ouliers
-    r = sqrt(r / nbMinRandom);
-    // std::cout << "Candidate residual: " << r << std::endl;
-    if (r < threshold) {
-      unsigned int nbInliersCur = 0;
-      for (unsigned int i = 0; i < n; i++) {
-        a[0] = xa[i];
-        a[1] = ya[i];
-        a[2] = 1;
-        b[0] = xb[i];
-        b[1] = yb[i];
-        b[2] = 1;
-
-        c = aHb * b;
-        c /= c[2];
-        double error = sqrt((a - c).sumSquare());
-        if (error <= threshold) {
-          nbInliersCur++;
-          cur_consensus.push_back(i);
-          inliers[i] = true;
-        } else {
-          cur_outliers.push_back(i);
-          inliers[i] = false;
+      unsigned int nbInliersCur = countInliers(H, &xb[0], &yb[0], &xa[0], &ya[0], n, th2);
+      if (nbInliersCur > localBestNbInliers) {
+#ifdef VISP_HAVE_OPENMP
+#pragma omp critical(vpHomographyRansac)
+#endif
+        {
+          if (nbInliersCur > bestNbInliers) {
+            bestNbInliers = nbInliersCur;
+            for (unsigned int i = 0; i < 9; i++) {
+              bestH[i] = H[i];
+            }
+            if (bestNbInliers >= nbInliersConsensus) {
+              setSharedFlag(stop);
+            }
+          }
+          localBestNbInliers = bestNbInliers;
         }
       }
-      // std::cout << "nb inliers that matches: " << nbInliersCur <<
-      // std::endl;
-      if (nbInliersCur > nbInliers) {
-        foundSolution = true;
-        best_consensus = cur_consensus;
-        nbInliers = nbInliersCur;
-      }
-
-      cur_consensus.clear();
-    }
-
-    nbTrials++;
-    if (nbTrials >= ransacMaxTrials) {
-      vpERROR_TRACE("Ransac reached the maximum number of trials");
-      foundSolution = true;
     }
   }
 
-  if (foundSolution) {
-    if (nbInliers >= nbInliersConsensus) {
-      std::vector<double> xa_best(best_consensus.size());
-      std::vector<double> ya_best(best_consensus.size());
-      std::vector<double> xb_best(best_consensus.size());
-      std::vector<double> yb_best(best_consensus.size());
-
-      for (unsigned i = 0; i < best_consensus.size(); i++) {
-        xa_best[i] = xa[best_consensus[i]];
-        ya_best[i] = ya[best_consensus[i]];
-        xb_best[i] = xb[best_consensus[i]];
-        yb_best[i] = yb[best_consensus[i]];
-      }
+  if (degenerateError && bestNbInliers == 0) {
+    vpERROR_TRACE("Unable to select a nondegenerate data set");
+    throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
+  }
 
-      vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization);
-      aHb /= aHb[2][2];
-
-      residual = 0;
-      vpColVector a(3), b(3), c(3);
-      for (unsigned int i = 0; i < best_consensus.size(); i++) {
-        a[0] = xa_best[i];
-        a[1] = ya_best[i];
-        a[2] = 1;
-        b[0] = xb_best[i];
-        b[1] = yb_best[i];
-        b[2] = 1;
-
-        c = aHb * b;
-        c /= c[2];
-        residual += (a - c).sumSquare();
-      }
+  if (bestNbInliers < nbInliersConsensus || bestNbInliers == 0) {
+    return false;
+  }
 
-      residual = sqrt(residual / best_consensus.size());
-      return true;
-    } else {
-      return false;
+  inliers.resize(n);
+  std::vector<double> xa_best, ya_best, xb_best, yb_best;
+  xa_best.reserve(bestNbInliers);
+  ya_best.reserve(bestNbInliers);
+  xb_best.reserve(bestNbInliers);
+  yb_best.reserve(bestNbInliers);
+  for (unsigned int i = 0; i < n; i++) {
+    inliers[i] = (transferError(bestH, xb[i], yb[i], xa[i], ya[i]) <= th2);
+    if (inliers[i]) {
+      xa_best.push_back(xa[i]);
+      ya_best.push_back(ya[i]);
+      xb_best.push_back(xb[i]);
+      yb_best.push_back(yb[i]);
     }
-  } else {
-    return false;
   }
+
+  vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization);
+  aHb /= aHb[2][2];
+
+  residual = 0;
+  for (unsigned int i = 0; i < xa_best.size(); i++) {
+    residual += transferError(aHb.data, xb_best[i], yb_best[i], xa_best[i], ya_best[i]);
+  }
+  residual = sqrt(residual / xa_best.size());
+
+  return true;
 }
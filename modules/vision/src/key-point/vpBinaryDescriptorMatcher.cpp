@@ -0,0 +1,560 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Hamming distance matcher for binary descriptors.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <visp3/core/vpCPUFeatures.h>
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpBinaryDescriptorMatcher.h>
+
+#include <stdint.h> // for uint64_t ; works also with >= VS2010 / _MSC_VER >= 1600
+
+#ifdef VISP_HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+
+#if defined __SSSE3__ || (defined _MSC_VER && _MSC_VER >= 1500)
+#include <tmmintrin.h>
+#define VISP_HAVE_SSSE3 1
+#endif
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+inline unsigned int popCount64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned int)__builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  return (unsigned int)__popcnt64(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+unsigned int hammingScalar(const unsigned char *a, const unsigned char *b, unsigned int size)
+{
+  unsigned int distance = 0;
+  unsigned int i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t va, vb;
+    memcpy(&va, a + i, sizeof(uint64_t));
+    memcpy(&vb, b + i, sizeof(uint64_t));
+    distance += popCount64(va ^ vb);
+  }
+  for (; i < size; i++) {
+    distance += popCount64((uint64_t)(a[i] ^ b[i]));
+  }
+  return distance;
+}
+
+#if VISP_HAVE_SSSE3
+// Population count of 16 bytes at once with a 4-bit lookup table
+unsigned int hammingSSSE3(const unsigned char *a, const unsigned char *b, unsigned int size)
+{
+  const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m128i low_mask = _mm_set1_epi8(0x0f);
+  __m128i sum = _mm_setzero_si128();
+
+  unsigned int i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+    __m128i lo = _mm_and_si128(x, low_mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), low_mask);
+    __m128i cnt = _mm_add_epi8(_mm_shuffle_epi8(lut, lo), _mm_shuffle_epi8(lut, hi));
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(cnt, _mm_setzero_si128()));
+  }
+
+  uint64_t res[2];
+  _mm_storeu_si128((__m128i *)res, sum);
+  unsigned int distance = (unsigned int)(res[0] + res[1]);
+  if (i < size) {
+    distance += hammingScalar(a + i, b + i, size - i);
+  }
+  return distance;
+}
+#endif
+
+inline unsigned int hamming(const unsigned char *a, const unsigned char *b, unsigned int size, bool useSSSE3)
+{
+#if VISP_HAVE_SSSE3
+  if (useSSSE3) {
+    return hammingSSSE3(a, b, size);
+  }
+#else
+  (void)useSSSE3;
+#endif
+  return hammingScalar(a, b, size);
+}
+
+// Matches are sorted by distance, then by train index
+inline bool isBetter(unsigned int distance, unsigned int trainIdx,
+                     const vpBinaryDescriptorMatcher::vpDescriptorMatch &match)
+{
+  return distance < match.distance || (distance == match.distance && trainIdx < match.trainIdx);
+}
+
+inline void insertMatch(std::vector<vpBinaryDescriptorMatcher::vpDescriptorMatch> &knn, unsigned int k,
+                        unsigned int queryIdx, unsigned int trainIdx, unsigned int distance)
+{
+  if (knn.size() == k && !isBetter(distance, trainIdx, knn.back())) {
+    return;
+  }
+
+  vpBinaryDescriptorMatcher::vpDescriptorMatch m;
+  m.queryIdx = queryIdx;
+  m.trainIdx = trainIdx;
+  m.distance = distance;
+  if (knn.size() < k) {
+    knn.push_back(m);
+  } else {
+    knn.back() = m;
+  }
+  for (size_t i = knn.size() - 1; i > 0 && isBetter(knn[i].distance, knn[i].trainIdx, knn[i - 1]); i--) {
+    std::swap(knn[i], knn[i - 1]);
+  }
+}
+
+inline unsigned int substring(const unsigned char *descriptor, unsigned int table)
+{
+  return (unsigned int)descriptor[2 * table] | ((unsigned int)descriptor[2 * table + 1] << 8);
+}
+
+const unsigned int nbBuckets = 65536;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. The multi-index hashing is used when there are at
+  least 20000 train descriptors, the matches are not filtered.
+*/
+vpBinaryDescriptorMatcher::vpBinaryDescriptorMatcher()
+  : m_trainDescriptors(), m_descriptorSize(0), m_nbTrainDescriptors(0), m_crossCheck(false), m_maxDistance(~0U),
+    m_ratioThreshold(0.), m_nbThreads(0), m_useHashing(true), m_hashingMinNbDescriptors(20000),
+    m_maxHashingRadius(2), m_hashTablesUpToDate(false), m_bucketOffsets(), m_bucketIndexes(), m_radiusMasks(),
+    m_radiusOffsets(), m_useSSSE3(vpCPUFeatures::checkSSSE3())
+{
+}
+
+/*!
+  Append train descriptors.
+
+  \param descriptors : Pointer to the first byte of the first descriptor.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Size in bytes of a descriptor (32 for ORB, 64 for
+  BRISK...). It must be the same for all the train descriptors.
+  \param step : Number of bytes between two consecutive descriptors. A value of
+  0 means that the descriptors are contiguous.
+*/
+void vpBinaryDescriptorMatcher::addTrainDescriptors(const unsigned char *descriptors, unsigned int nbDescriptors,
+                                                    unsigned int descriptorSize, unsigned int step)
+{
+  if (nbDescriptors == 0) {
+    return;
+  }
+  if (descriptorSize == 0) {
+    throw(vpException(vpException::dimensionError, "Descriptor size should not be null"));
+  }
+  if (m_nbTrainDescriptors > 0 && descriptorSize != m_descriptorSize) {
+    throw(vpException(vpException::dimensionError, "Cannot add descriptors of %d bytes to descriptors of %d bytes",
+                      descriptorSize, m_descriptorSize));
+  }
+  if (step == 0) {
+    step = descriptorSize;
+  }
+
+  m_descriptorSize = descriptorSize;
+  size_t offset = m_trainDescriptors.size();
+  m_trainDescriptors.resize(offset + (size_t)nbDescriptors * descriptorSize);
+  for (unsigned int i = 0; i < nbDescriptors; i++) {
+    memcpy(&m_trainDescriptors[offset + (size_t)i * descriptorSize], descriptors + (size_t)i * step, descriptorSize);
+  }
+  m_nbTrainDescriptors += nbDescriptors;
+  m_hashTablesUpToDate = false;
+}
+
+/*!
+  Build the multi-index hash tables from the train descriptors.
+*/
+void vpBinaryDescriptorMatcher::buildHashTables()
+{
+  unsigned int nbTables = m_descriptorSize / 2;
+  m_bucketOffsets.assign((size_t)nbTables * (nbBuckets + 1), 0);
+  m_bucketIndexes.resize((size_t)nbTables * m_nbTrainDescriptors);
+
+  for (unsigned int t = 0; t < nbTables; t++) {
+    unsigned int *offsets = &m_bucketOffsets[(size_t)t * (nbBuckets + 1)];
+    for (unsigned int i = 0; i < m_nbTrainDescriptors; i++) {
+      offsets[substring(&m_trainDescriptors[(size_t)i * m_descriptorSize], t) + 1]++;
+    }
+    for (unsigned int b = 0; b < nbBuckets; b++) {
+      offsets[b + 1] += offsets[b];
+    }
+
+    std::vector<unsigned int> cursor(offsets, offsets + nbBuckets);
+    unsigned int *indexes = &m_bucketIndexes[(size_t)t * m_nbTrainDescriptors];
+    for (unsigned int i = 0; i < m_nbTrainDescriptors; i++) {
+      indexes[cursor[substring(&m_trainDescriptors[(size_t)i * m_descriptorSize], t)]++] = i;
+    }
+  }
+
+  // Masks used to enumerate the buckets at a given Hamming distance of a key
+  m_radiusMasks.clear();
+  m_radiusOffsets.resize(m_maxHashingRadius + 2);
+  for (unsigned int r = 0; r <= m_maxHashingRadius; r++) {
+    m_radiusOffsets[r] = (unsigned int)m_radiusMasks.size();
+    for (unsigned int mask = 0; mask < nbBuckets; mask++) {
+      if (popCount64(mask) == r) {
+        m_radiusMasks.push_back((unsigned short)mask);
+      }
+    }
+  }
+  m_radiusOffsets[m_maxHashingRadius + 1] = (unsigned int)m_radiusMasks.size();
+
+  m_hashTablesUpToDate = true;
+}
+
+/*!
+  Remove all the train descriptors.
+*/
+void vpBinaryDescriptorMatcher::clear()
+{
+  m_trainDescriptors.clear();
+  m_descriptorSize = 0;
+  m_nbTrainDescriptors = 0;
+  m_bucketOffsets.clear();
+  m_bucketIndexes.clear();
+  m_hashTablesUpToDate = false;
+}
+
+/*!
+  Compute the Hamming distance between two binary descriptors.
+
+  \param a, b : Descriptors.
+  \param size : Size in bytes of the descriptors.
+  \return The number of bits that differ between both descriptors.
+*/
+unsigned int vpBinaryDescriptorMatcher::hammingDistance(const unsigned char *a, const unsigned char *b,
+                                                        unsigned int size)
+{
+  return hamming(a, b, size, vpCPUFeatures::checkSSSE3());
+}
+
+void vpBinaryDescriptorMatcher::knnMatchBruteForce(const unsigned char *query, unsigned int queryIdx, unsigned int k,
+                                                   std::vector<vpDescriptorMatch> &knn) const
+{
+  knn.clear();
+  const unsigned char *train = m_trainDescriptors.empty() ? NULL : &m_trainDescriptors[0];
+  for (unsigned int i = 0; i < m_nbTrainDescriptors; i++, train += m_descriptorSize) {
+    insertMatch(knn, k, queryIdx, i, hamming(query, train, m_descriptorSize, m_useSSSE3));
+  }
+}
+
+/*
+  Search the k nearest neighbors in the hash tables with an increasing
+  radius. Return false when they cannot be guaranteed within the maximal
+  radius. In that case, lowerBound is a lower bound of the distance of the
+  train descriptors that were not visited.
+*/
+bool vpBinaryDescriptorMatcher::knnMatchHashing(const unsigned char *query, unsigned int queryIdx, unsigned int k,
+                                                std::vector<unsigned int> &visited, unsigned int &stamp,
+                                                std::vector<vpDescriptorMatch> &knn, unsigned int &lowerBound) const
+{
+  knn.clear();
+  if (++stamp == 0) {
+    std::fill(visited.begin(), visited.end(), 0);
+    stamp = 1;
+  }
+
+  unsigned int nbTables = m_descriptorSize / 2;
+  for (unsigned int r = 0; r <= m_maxHashingRadius; r++) {
+    for (unsigned int t = 0; t < nbTables; t++) {
+      unsigned int key = substring(query, t);
+      const unsigned int *offsets = &m_bucketOffsets[(size_t)t * (nbBuckets + 1)];
+      const unsigned int *indexes = &m_bucketIndexes[(size_t)t * m_nbTrainDescriptors];
+
+      for (unsigned int j = m_radiusOffsets[r]; j < m_radiusOffsets[r + 1]; j++) {
+        unsigned int bucket = key ^ m_radiusMasks[j];
+        for (unsigned int p = offsets[bucket]; p < offsets[bucket + 1]; p++) {
+          unsigned int idx = indexes[p];
+          if (visited[idx] == stamp) {
+            continue;
+          }
+          visited[idx] = stamp;
+          insertMatch(knn, k, queryIdx, idx,
+                      hamming(query, &m_trainDescriptors[(size_t)idx * m_descriptorSize], m_descriptorSize,
+                              m_useSSSE3));
+        }
+      }
+    }
+
+    // A descriptor that was not found differs from at least r+1 bits in each
+    // substring
+    lowerBound = nbTables * (r + 1);
+    if (knn.size() == k && knn.back().distance < lowerBound) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*!
+  Find the k nearest train descriptors of each query descriptor.
+
+  \param queries : Pointer to the first byte of the first query descriptor.
+  The query descriptors must have the same size as the train descriptors.
+  \param nbQueries : Number of query descriptors.
+  \param step : Number of bytes between two consecutive query descriptors. A
+  value of 0 means that the descriptors are contiguous.
+  \param k : Number of neighbors.
+  \param matches : For each query, the min(k, getNbTrainDescriptors())
+  nearest neighbors sorted by increasing distance.
+*/
+void vpBinaryDescriptorMatcher::knnMatch(const unsigned char *queries, unsigned int nbQueries, unsigned int step,
+                                         unsigned int k, std::vector<std::vector<vpDescriptorMatch> > &matches)
+{
+  matches.resize(nbQueries);
+  if (m_nbTrainDescriptors == 0 || k == 0) {
+    for (unsigned int i = 0; i < nbQueries; i++) {
+      matches[i].clear();
+    }
+    return;
+  }
+  if (step == 0) {
+    step = m_descriptorSize;
+  }
+
+  train();
+  bool useHashing = isHashingUsed();
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_nbThreads > 0 ? m_nbThreads : omp_get_max_threads();
+#pragma omp parallel num_threads(nbThreads)
+#endif
+  {
+    std::vector<unsigned int> visited;
+    unsigned int stamp = 0;
+    if (useHashing) {
+      visited.resize(m_nbTrainDescriptors, 0);
+    }
+    bool threadUseHashing = useHashing;
+    unsigned int nbHashingSearches = 0, nbHashingFailures = 0;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < (int)nbQueries; i++) {
+      const unsigned char *query = queries + (size_t)i * step;
+      std::vector<vpDescriptorMatch> &knn = matches[(size_t)i];
+      knn.reserve(k);
+
+      unsigned int lowerBound;
+      bool found = false;
+      if (threadUseHashing) {
+        found = knnMatchHashing(query, (unsigned int)i, k, visited, stamp, knn, lowerBound);
+        // When the neighbors are too far from the queries, the hash tables
+        // only add their cost to the brute force search
+        nbHashingSearches++;
+        nbHashingFailures += found ? 0 : 1;
+        if (nbHashingSearches >= 16 && 4 * nbHashingFailures > 3 * nbHashingSearches) {
+          threadUseHashing = false;
+        }
+      }
+      if (!found) {
+        knnMatchBruteForce(query, (unsigned int)i, k, knn);
+      }
+    }
+  }
+}
+
+/*!
+  Find the best train descriptor of each query descriptor and filter the
+  matches with the maximal distance, the ratio test and the cross check when
+  they are enabled.
+
+  \param queries : Pointer to the first byte of the first query descriptor.
+  \param nbQueries : Number of query descriptors.
+  \param step : Number of bytes between two consecutive query descriptors. A
+  value of 0 means that the descriptors are contiguous.
+  \param matches : Matches that pass the filters, sorted by query index.
+
+  \sa setMaxDistance(), setRatioThreshold(), setCrossCheck()
+*/
+void vpBinaryDescriptorMatcher::match(const unsigned char *queries, unsigned int nbQueries, unsigned int step,
+                                      std::vector<vpDescriptorMatch> &matches)
+{
+  if (step == 0) {
+    step = m_descriptorSize;
+  }
+
+  matches.clear();
+  if (m_nbTrainDescriptors == 0) {
+    return;
+  }
+
+  train();
+  bool useHashing = isHashingUsed();
+  unsigned int k = m_ratioThreshold > 0. ? 2 : 1;
+  std::vector<vpDescriptorMatch> bestMatches(nbQueries);
+  std::vector<unsigned char> valid(nbQueries, 0);
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_nbThreads > 0 ? m_nbThreads : omp_get_max_threads();
+#pragma omp parallel num_threads(nbThreads)
+#endif
+  {
+    std::vector<unsigned int> visited;
+    unsigned int stamp = 0;
+    if (useHashing) {
+      visited.resize(m_nbTrainDescriptors, 0);
+    }
+    std::vector<vpDescriptorMatch> knn;
+    knn.reserve(k);
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int i = 0; i < (int)nbQueries; i++) {
+      const unsigned char *query = queries + (size_t)i * step;
+      unsigned int lowerBound;
+      bool exact = true;
+      if (useHashing && !knnMatchHashing(query, (unsigned int)i, k, visited, stamp, knn, lowerBound)) {
+        // The filters can often be decided without the exact neighbors
+        exact = false;
+        if (knn.empty() || knn[0].distance >= lowerBound) {
+          // The best match is at least at lowerBound
+          if (lowerBound > m_maxDistance) {
+            continue;
+          }
+        } else if (knn[0].distance > m_maxDistance) {
+          continue;
+        } else {
+          // The best match is exact, the second one is at least at lowerBound
+          unsigned int d2 = (knn.size() > 1 && knn[1].distance < lowerBound) ? knn[1].distance : lowerBound;
+          if (knn[0].distance < m_ratioThreshold * d2) {
+            bestMatches[(size_t)i] = knn[0];
+            valid[(size_t)i] = 1;
+            continue;
+          }
+        }
+      }
+      if (!useHashing || !exact) {
+        knnMatchBruteForce(query, (unsigned int)i, k, knn);
+      }
+
+      if (knn.empty() || knn[0].distance > m_maxDistance) {
+        continue;
+      }
+      if (k > 1 && knn.size() > 1 && !(knn[0].distance < m_ratioThreshold * knn[1].distance)) {
+        continue;
+      }
+      bestMatches[(size_t)i] = knn[0];
+      valid[(size_t)i] = 1;
+    }
+  }
+
+  for (unsigned int i = 0; i < nbQueries; i++) {
+    if (valid[i]) {
+      matches.push_back(bestMatches[i]);
+    }
+  }
+
+  if (m_crossCheck && !matches.empty()) {
+    // The query must also be the best match of its train descriptor
+    std::vector<unsigned char> keep(matches.size(), 1);
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(nbThreads)
+#endif
+    for (int i = 0; i < (int)matches.size(); i++) {
+      const vpDescriptorMatch &m = matches[(size_t)i];
+      const unsigned char *train = &m_trainDescriptors[(size_t)m.trainIdx * m_descriptorSize];
+      for (unsigned int j = 0; j < nbQueries; j++) {
+        unsigned int d = hamming(queries + (size_t)j * step, train, m_descriptorSize, m_useSSSE3);
+        if (d < m.distance || (d == m.distance && j < m.queryIdx)) {
+          keep[(size_t)i] = 0;
+          break;
+        }
+      }
+    }
+
+    size_t nbKept = 0;
+    for (size_t i = 0; i < matches.size(); i++) {
+      if (keep[i]) {
+        matches[nbKept++] = matches[i];
+      }
+    }
+    matches.resize(nbKept);
+  }
+}
+
+/*!
+  Enable or disable the multi-index hashing.
+
+  \param useHashing : If true, the hash tables are used when there are at
+  least \e minNbTrainDescriptors train descriptors and when the descriptor
+  size is a multiple of 2 bytes.
+  \param minNbTrainDescriptors : Minimal number of train descriptors to use
+  the hash tables. Below this number the brute force matching is faster.
+*/
+void vpBinaryDescriptorMatcher::setMultiIndexHashing(bool useHashing, unsigned int minNbTrainDescriptors)
+{
+  m_useHashing = useHashing;
+  m_hashingMinNbDescriptors = minNbTrainDescriptors;
+}
+
+/*!
+  Build the hash tables when needed. This function is called by knnMatch()
+  and match(), it can be called explicitly after adding the train descriptors
+  to avoid the cost of building the tables during the first matching.
+*/
+void vpBinaryDescriptorMatcher::train()
+{
+  if (isHashingUsed() && (!m_hashTablesUpToDate || m_radiusOffsets.size() != m_maxHashingRadius + 2)) {
+    buildHashTables();
+  }
+}
@@ -36,12 +36,17 @@
  *
  *****************************************************************************/
 
+#include <cstring>
 #include <iomanip>
 #include <limits>
 
 #include <visp3/core/vpIoTools.h>
 #include <visp3/vision/vpKeyPoint.h>
 
+#ifdef VISP_HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
@@ -65,6 +70,59 @@ inline vpImagePoint matchRansacToVpImage(const std::pair<cv::KeyPoint, cv::Point
   return vpImagePoint(pair.first.pt.y, pair.first.pt.x);
 }
 
+#if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
+// Allocator of the matrices referring to the descriptors of a learning
+// database: the database is closed when the last matrix is released
+class vpDatabaseAllocator : public cv::MatAllocator
+{
+public:
+#if (VISP_HAVE_OPENCV_VERSION >= 0x040000)
+  typedef cv::AccessFlag vpAccessFlag;
+#else
+  typedef int vpAccessFlag;
+#endif
+
+  // Reallocated matrices use the default allocator
+  cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, vpAccessFlag flags,
+                         cv::UMatUsageFlags usageFlags) const
+  {
+    return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+  }
+
+  bool allocate(cv::UMatData *u, vpAccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const
+  {
+    return cv::Mat::getStdAllocator()->allocate(u, accessFlags, usageFlags);
+  }
+
+  void deallocate(cv::UMatData *u) const
+  {
+    if (u != NULL && u->refcount == 0 && u->urefcount == 0) {
+      delete static_cast<cv::Ptr<vpKeyPointDatabase> *>(u->userdata);
+      delete u;
+    }
+  }
+};
+
+// Never destroyed, since matrices may be released after the end of main()
+const vpDatabaseAllocator *const databaseAllocator = new vpDatabaseAllocator;
+
+// Return a matrix referring to the descriptors of a database, that keeps
+// the database open as long as the matrix or one of its copies exists
+cv::Mat wrapDescriptors(const cv::Ptr<vpKeyPointDatabase> &database, int rows, int cols, int type,
+                        const unsigned char *data, size_t step)
+{
+  // The matrix is read-only since the database is mapped read-only
+  cv::Mat descriptors(rows, cols, type, const_cast<unsigned char *>(data), step);
+  cv::UMatData *u = new cv::UMatData(databaseAllocator);
+  u->data = u->origdata = descriptors.data;
+  u->size = (size_t)rows * step;
+  u->userdata = new cv::Ptr<vpKeyPointDatabase>(database);
+  descriptors.u = u;
+  descriptors.allocator = const_cast<vpDatabaseAllocator *>(databaseAllocator);
+  descriptors.addref();
+  return descriptors;
+}
+#endif
 }
 
 /*!
@@ -78,22 +136,24 @@ inline vpImagePoint matchRansacToVpImage(const std::pair<cv::KeyPoint, cv::Point
  */
 vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatureDescriptorType &descriptorType,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_binaryMatcher(), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(), m_detectors(),
     m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
     m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(), m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85),
     m_matchingTime(0.), m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100),
-    m_objectFilteredPoints(), m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
-    m_ransacConsensusPercentage(20.0), m_ransacFilterFlag(vpPose::NO_FILTER), m_ransacInliers(), m_ransacOutliers(),
-    m_ransacParallel(false), m_ransacParallelNbThreads(0), m_ransacReprojectionError(6.0),
-    m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(),
-    m_useAffineDetection(false),
+    m_objectFilteredPoints(), m_poseTime(0.), m_prediction(), m_queryDescriptors(), m_queryFilteredKeyPoints(),
+    m_queryKeyPoints(), m_ransacConsensusPercentage(20.0), m_ransacFilterFlag(vpPose::NO_FILTER), m_ransacInliers(),
+    m_ransacOutliers(), m_ransacParallel(false), m_ransacParallelNbThreads(0), m_ransacReprojectionError(6.0),
+    m_ransacThreshold(0.01), m_tiling(), m_trackingcMo(), m_trackingcMoPrevious(), m_trackingMinNbMatches(30),
+    m_trackingNbPoses(0), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(),
+    m_useAffineDetection(false), m_useBinaryMatcher(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
     m_useConsensusPercentage(false), m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true),
-    m_useSingleMatchFilter(true)
+    m_useSingleMatchFilter(true), m_useTiledDetection(false), m_useTracking(false)
 {
   initFeatureNames();
 
@@ -114,22 +174,24 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
  */
 vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extractorName,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_binaryMatcher(), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(), m_detectors(),
     m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
     m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(), m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85),
     m_matchingTime(0.), m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100),
-    m_objectFilteredPoints(), m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
-    m_ransacConsensusPercentage(20.0), m_ransacFilterFlag(vpPose::NO_FILTER), m_ransacInliers(), m_ransacOutliers(),
-    m_ransacParallel(false), m_ransacParallelNbThreads(0), m_ransacReprojectionError(6.0),
-    m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(),
-    m_useAffineDetection(false),
+    m_objectFilteredPoints(), m_poseTime(0.), m_prediction(), m_queryDescriptors(), m_queryFilteredKeyPoints(),
+    m_queryKeyPoints(), m_ransacConsensusPercentage(20.0), m_ransacFilterFlag(vpPose::NO_FILTER), m_ransacInliers(),
+    m_ransacOutliers(), m_ransacParallel(false), m_ransacParallelNbThreads(0), m_ransacReprojectionError(6.0),
+    m_ransacThreshold(0.01), m_tiling(), m_trackingcMo(), m_trackingcMoPrevious(), m_trackingMinNbMatches(30),
+    m_trackingNbPoses(0), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(),
+    m_useAffineDetection(false), m_useBinaryMatcher(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
     m_useConsensusPercentage(false), m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true),
-    m_useSingleMatchFilter(true)
+    m_useSingleMatchFilter(true), m_useTiledDetection(false), m_useTracking(false)
 {
   initFeatureNames();
 
@@ -150,21 +212,24 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
  */
 vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std::vector<std::string> &extractorNames,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_binaryMatcher(), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0),
+    m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(detectorNames),
     m_detectors(), m_extractionTime(0.), m_extractorNames(extractorNames), m_extractors(), m_filteredMatches(),
     m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0),
     m_matchingRatioThreshold(0.85), m_matchingTime(0.), m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200),
-    m_nbRansacMinInlierCount(100), m_objectFilteredPoints(), m_poseTime(0.), m_queryDescriptors(),
+    m_nbRansacMinInlierCount(100), m_objectFilteredPoints(), m_poseTime(0.), m_prediction(), m_queryDescriptors(),
     m_queryFilteredKeyPoints(), m_queryKeyPoints(), m_ransacConsensusPercentage(20.0), m_ransacFilterFlag(vpPose::NO_FILTER), m_ransacInliers(),
     m_ransacOutliers(), m_ransacParallel(false), m_ransacParallelNbThreads(0), m_ransacReprojectionError(6.0), m_ransacThreshold(0.01),
-    m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(), m_useAffineDetection(false),
+    m_tiling(), m_trackingcMo(), m_trackingcMoPrevious(), m_trackingMinNbMatches(30), m_trackingNbPoses(0),
+    m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(), m_trainVpPoints(),
+    m_useAffineDetection(false), m_useBinaryMatcher(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
     m_useConsensusPercentage(false), m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true),
-    m_useSingleMatchFilter(true)
+    m_useSingleMatchFilter(true), m_useTiledDetection(false), m_useTracking(false)
 {
   initFeatureNames();
   init();
@@ -286,13 +351,15 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const v
          ++it) {
       if (first) {
         first = false;
-        it->copyTo(m_trainDescriptors);
+        m_trainDescriptors = it->clone();
       } else {
         m_trainDescriptors.push_back(*it);
       }
     }
   } else {
     detect(I, m_trainKeyPoints, m_detectionTime, rectangle);
+    // Never overwrite in place the descriptors of a read-only database
+    m_trainDescriptors.release();
     extract(I, m_trainKeyPoints, m_trainDescriptors, m_extractionTime);
   }
 
@@ -313,6 +380,7 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const v
   // Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateBinaryMatcher();
 
   return static_cast<unsigned int>(m_trainKeyPoints.size());
 }
@@ -409,7 +477,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   // Append reference lists
   this->m_trainKeyPoints.insert(this->m_trainKeyPoints.end(), trainKeyPoints_tmp.begin(), trainKeyPoints_tmp.end());
   if (!append) {
-    trainDescriptors.copyTo(this->m_trainDescriptors);
+    this->m_trainDescriptors = trainDescriptors.clone();
   } else {
     this->m_trainDescriptors.push_back(trainDescriptors);
   }
@@ -422,6 +490,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   // Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateBinaryMatcher();
 
   _reference_computed = true;
 }
@@ -1155,16 +1224,98 @@ void vpKeyPoint::detect(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPoi
   double t = vpTime::measureTimeMs();
   keyPoints.clear();
 
-  for (std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin();
-       it != m_detectors.end(); ++it) {
-    std::vector<cv::KeyPoint> kp;
-    it->second->detect(matImg, kp, mask);
-    keyPoints.insert(keyPoints.end(), kp.begin(), kp.end());
+  if (m_useTiledDetection) {
+    std::vector<vpKeyPointTiling::vpTile> tiles;
+    m_tiling.computeTiles((unsigned int)matImg.cols, (unsigned int)matImg.rows, tiles);
+    detectTiled(matImg, tiles, keyPoints, mask);
+  } else {
+    for (std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin();
+         it != m_detectors.end(); ++it) {
+      std::vector<cv::KeyPoint> kp;
+      it->second->detect(matImg, kp, mask);
+      keyPoints.insert(keyPoints.end(), kp.begin(), kp.end());
+    }
   }
 
   elapsedTime = vpTime::measureTimeMs() - t;
 }
 
+/*!
+   Detect keypoints in overlapping tiles processed in parallel, keep the
+   best keypoints of the core region of each tile and merge them with a
+   non-maximum suppression (see getTiling()). As in the affine detection,
+   the detectors are called from the OpenMP threads, each on its own tile.
+
+   \param matImg : Input image.
+   \param tiles : Tiles in which the keypoints are detected, the tiles of
+   getTiling() or the regions of interest of the tracking mode.
+   \param keyPoints : Output list of the detected keypoints.
+   \param mask : Optional 8-bit integer mask to detect only where mask[i][j]
+   != 0.
+ */
+void vpKeyPoint::detectTiled(const cv::Mat &matImg, const std::vector<vpKeyPointTiling::vpTile> &tiles,
+                             std::vector<cv::KeyPoint> &keyPoints, const cv::Mat &mask)
+{
+  std::vector<std::vector<cv::KeyPoint> > listOfTileKeyPoints(tiles.size());
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_tiling.getNbThreads() > 0 ? m_tiling.getNbThreads() : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+#endif
+  for (int cpt = 0; cpt < static_cast<int>(tiles.size()); cpt++) {
+    const vpKeyPointTiling::vpTile &tile = tiles[(size_t)cpt];
+    cv::Rect roi(tile.left, tile.top, tile.right - tile.left, tile.bottom - tile.top);
+    cv::Mat tileImg = matImg(roi);
+    cv::Mat tileMask = mask.empty() ? cv::Mat() : mask(roi);
+
+    std::vector<cv::KeyPoint> tileKeyPoints;
+    for (std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin();
+         it != m_detectors.end(); ++it) {
+      std::vector<cv::KeyPoint> kp;
+      it->second->detect(tileImg, kp, tileMask);
+      tileKeyPoints.insert(tileKeyPoints.end(), kp.begin(), kp.end());
+    }
+
+    std::vector<vpKeyPointTiling::vpTileKeyPoint> candidates(tileKeyPoints.size());
+    for (size_t i = 0; i < tileKeyPoints.size(); i++) {
+      tileKeyPoints[i].pt.x += tile.left;
+      tileKeyPoints[i].pt.y += tile.top;
+      candidates[i].u = tileKeyPoints[i].pt.x;
+      candidates[i].v = tileKeyPoints[i].pt.y;
+      candidates[i].response = tileKeyPoints[i].response;
+    }
+
+    std::vector<unsigned int> selected;
+    m_tiling.selectKeyPoints(tile, candidates, selected);
+    std::vector<cv::KeyPoint> &kps = listOfTileKeyPoints[(size_t)cpt];
+    kps.reserve(selected.size());
+    for (size_t i = 0; i < selected.size(); i++) {
+      kps.push_back(tileKeyPoints[selected[i]]);
+    }
+  }
+
+  // Merge the keypoints of the tiles
+  std::vector<cv::KeyPoint> mergedKeyPoints;
+  for (size_t i = 0; i < listOfTileKeyPoints.size(); i++) {
+    mergedKeyPoints.insert(mergedKeyPoints.end(), listOfTileKeyPoints[i].begin(), listOfTileKeyPoints[i].end());
+  }
+
+  std::vector<vpKeyPointTiling::vpTileKeyPoint> candidates(mergedKeyPoints.size());
+  for (size_t i = 0; i < mergedKeyPoints.size(); i++) {
+    candidates[i].u = mergedKeyPoints[i].pt.x;
+    candidates[i].v = mergedKeyPoints[i].pt.y;
+    candidates[i].response = mergedKeyPoints[i].response;
+  }
+  std::vector<unsigned int> kept;
+  m_tiling.nonMaximumSuppression(candidates, kept);
+
+  keyPoints.clear();
+  keyPoints.reserve(kept.size());
+  for (size_t i = 0; i < kept.size(); i++) {
+    keyPoints.push_back(mergedKeyPoints[kept[i]]);
+  }
+}
+
 /*!
    Display the reference and the detected keypoints in the images.
 
@@ -1427,6 +1578,14 @@ void vpKeyPoint::extract(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPo
                          double &elapsedTime, std::vector<cv::Point3f> *trainPoints)
 {
   double t = vpTime::measureTimeMs();
+  if (m_useTiledDetection && m_extractors.size() == 1 && (trainPoints == NULL || trainPoints->empty())) {
+    std::vector<vpKeyPointTiling::vpTile> tiles;
+    m_tiling.computeTiles((unsigned int)matImg.cols, (unsigned int)matImg.rows, tiles);
+    extractTiled(matImg, tiles, keyPoints, descriptors);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   bool first = true;
 
   for (std::map<std::string, cv::Ptr<cv::DescriptorExtractor> >::const_iterator itd = m_extractors.begin();
@@ -1524,6 +1683,78 @@ void vpKeyPoint::extract(const cv::Mat &matImg, std::vector<cv::KeyPoint> &keyPo
   elapsedTime = vpTime::measureTimeMs() - t;
 }
 
+/*!
+   Extract the descriptors of the keypoints in overlapping tiles processed in
+   parallel. Each keypoint is described in the tile whose core region
+   contains it, the overlap of the tiles giving the neighborhood of the
+   keypoint to the extractor. The keypoints that cannot be described or
+   that are outside the core regions are removed, and the keypoints are
+   sorted by tile.
+
+   \param matImg : Input image.
+   \param tiles : Tiles whose core regions contain the keypoints.
+   \param keyPoints : List of keypoints we want to extract their descriptors.
+   \param descriptors : Descriptors matrix with at each row the descriptors
+   values for each keypoint.
+ */
+void vpKeyPoint::extractTiled(const cv::Mat &matImg, const std::vector<vpKeyPointTiling::vpTile> &tiles,
+                              std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors)
+{
+  // Dispatch the keypoints in the tiles
+  std::vector<std::vector<cv::KeyPoint> > listOfTileKeyPoints(tiles.size());
+  for (size_t i = 0; i < keyPoints.size(); i++) {
+    float u = std::min(std::max(keyPoints[i].pt.x, 0.f), (float)(matImg.cols - 1));
+    float v = std::min(std::max(keyPoints[i].pt.y, 0.f), (float)(matImg.rows - 1));
+    for (size_t j = 0; j < tiles.size(); j++) {
+      if (u >= tiles[j].coreLeft && u < tiles[j].coreRight && v >= tiles[j].coreTop && v < tiles[j].coreBottom) {
+        cv::KeyPoint kpt = keyPoints[i];
+        kpt.pt.x -= tiles[j].left;
+        kpt.pt.y -= tiles[j].top;
+        listOfTileKeyPoints[j].push_back(kpt);
+        break;
+      }
+    }
+  }
+
+  std::vector<cv::Mat> listOfTileDescriptors(tiles.size());
+  cv::Ptr<cv::DescriptorExtractor> extractor = m_extractors.begin()->second;
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_tiling.getNbThreads() > 0 ? m_tiling.getNbThreads() : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+#endif
+  for (int cpt = 0; cpt < static_cast<int>(tiles.size()); cpt++) {
+    std::vector<cv::KeyPoint> &kps = listOfTileKeyPoints[(size_t)cpt];
+    if (kps.empty()) {
+      continue;
+    }
+
+    const vpKeyPointTiling::vpTile &tile = tiles[(size_t)cpt];
+    cv::Rect roi(tile.left, tile.top, tile.right - tile.left, tile.bottom - tile.top);
+    extractor->compute(matImg(roi), kps, listOfTileDescriptors[(size_t)cpt]);
+
+    for (size_t i = 0; i < kps.size(); i++) {
+      kps[i].pt.x += tile.left;
+      kps[i].pt.y += tile.top;
+    }
+  }
+
+  keyPoints.clear();
+  std::vector<cv::Mat> nonEmptyDescriptors;
+  for (size_t i = 0; i < tiles.size(); i++) {
+    if (!listOfTileKeyPoints[i].empty() && !listOfTileDescriptors[i].empty()) {
+      keyPoints.insert(keyPoints.end(), listOfTileKeyPoints[i].begin(), listOfTileKeyPoints[i].end());
+      nonEmptyDescriptors.push_back(listOfTileDescriptors[i]);
+    }
+  }
+
+  if (nonEmptyDescriptors.empty()) {
+    descriptors = cv::Mat();
+  } else {
+    cv::vconcat(nonEmptyDescriptors, descriptors);
+  }
+}
+
 /*!
    Filter the matches using the desired filtering method.
  */
@@ -2206,10 +2437,19 @@ void vpKeyPoint::initMatcher(const std::string &matcherName)
       m_matcher = new cv::FlannBasedMatcher(new cv::flann::KDTreeIndexParams());
 #endif
     }
+  } else if (matcherName == "HammingViSP") {
+    if (!m_extractors.empty() && descriptorType != CV_8U) {
+      throw vpException(vpException::fatalError, "The HammingViSP matcher requires binary descriptors (CV_8U) !");
+    }
+    // The OpenCV matcher is kept for the functions that rely on it
+    m_matcher = cv::DescriptorMatcher::create("BruteForce-Hamming");
   } else {
     m_matcher = cv::DescriptorMatcher::create(matcherName);
   }
 
+  m_useBinaryMatcher = (matcherName == "HammingViSP");
+  updateBinaryMatcher();
+
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   if (m_matcher != NULL && !m_useKnn && matcherName == "BruteForce") {
     m_matcher->set("crossCheck", m_useBruteForceCrossCheck);
@@ -2224,6 +2464,24 @@ void vpKeyPoint::initMatcher(const std::string &matcherName)
   }
 }
 
+/*!
+   Copy the train descriptors in the native binary descriptor matcher when
+   the matcher name is "HammingViSP".
+ */
+void vpKeyPoint::updateBinaryMatcher()
+{
+  m_binaryMatcher.clear();
+  if (m_useBinaryMatcher && !m_trainDescriptors.empty()) {
+    if (m_trainDescriptors.type() != CV_8U) {
+      throw vpException(vpException::fatalError, "The HammingViSP matcher requires binary descriptors (CV_8U) !");
+    }
+    m_binaryMatcher.addTrainDescriptors(m_trainDescriptors.data, (unsigned int)m_trainDescriptors.rows,
+                                        (unsigned int)m_trainDescriptors.cols,
+                                        (unsigned int)m_trainDescriptors.step[0]);
+    m_binaryMatcher.train();
+  }
+}
+
 /*!
    Insert a reference image and a current image side-by-side.
 
@@ -2582,7 +2840,7 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     }
 
     if (!append || m_trainDescriptors.empty()) {
-      trainDescriptorsTmp.copyTo(m_trainDescriptors);
+      m_trainDescriptors = trainDescriptorsTmp.clone();
     } else {
       cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
     }
@@ -2782,7 +3040,7 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     }
 
     if (!append || m_trainDescriptors.empty()) {
-      trainDescriptorsTmp.copyTo(m_trainDescriptors);
+      m_trainDescriptors = trainDescriptorsTmp.clone();
     } else {
       cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
     }
@@ -2807,6 +3065,135 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
   // Add train descriptors in matcher object
   m_matcher->clear();
   m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateBinaryMatcher();
+
+  // Set _reference_computed to true as we load a learning file
+  _reference_computed = true;
+
+  // Set m_currentImageId
+  m_currentImageId = (int)m_mapOfImages.size();
+}
+
+/*!
+   Load a learning database saved by saveLearningDatabase(). The database is
+   memory-mapped: opening it does not depend on its size and the train
+   descriptors are used in place when all the selected keypoints are
+   contiguous (with OpenCV 3 or higher), so that several processes loading the
+   same database share the same memory. The keypoints of the database are
+   sorted by class id then by training image id: selecting a set of classes
+   gives contiguous keypoints.
+
+   The database stays open as long as the train descriptors (see
+   getTrainDescriptors()) or a copy of their matrix header exist, even after
+   reset() or the loading of another learning data. Since the database is
+   mapped read-only, the train descriptors must not be modified in place.
+
+   \param filename : Path of the database.
+   \param classIds : Class ids of the keypoints to load, all the keypoints if
+   empty.
+   \param imageIds : Training image ids of the keypoints to load, all the
+   keypoints if empty.
+ */
+void vpKeyPoint::loadLearningDatabase(const std::string &filename, const std::vector<int> &classIds,
+                                      const std::vector<int> &imageIds)
+{
+  cv::Ptr<vpKeyPointDatabase> database(new vpKeyPointDatabase);
+  database->open(filename);
+
+  int descriptorType = database->getDescriptorType();
+  int descriptorCols = (int)database->getDescriptorCols();
+  if (database->getNbKeyPoints() > 0 &&
+      database->getDescriptorRowSize() != (unsigned int)(descriptorCols * CV_ELEM_SIZE(descriptorType))) {
+    throw vpException(vpException::ioError, "Bad descriptor type in the learning database \"%s\"", filename.c_str());
+  }
+
+  std::vector<std::pair<unsigned int, unsigned int> > ranges;
+  database->getRanges(classIds, imageIds, ranges);
+  int nbKeyPoints = 0;
+  for (size_t i = 0; i < ranges.size(); i++) {
+    nbKeyPoints += (int)ranges[i].second;
+  }
+
+  // Release the references to the previous database
+  m_matcher->clear();
+  m_trainDescriptors = cv::Mat();
+  m_trainKeyPoints.clear();
+  m_trainKeyPoints.reserve((size_t)nbKeyPoints);
+  m_trainPoints.clear();
+  m_mapOfImageId.clear();
+  m_mapOfImages.clear();
+
+  const vpKeyPointDatabase::vpKeyPointRecord *records = database->getKeyPoints();
+  const float *points = database->getPoints();
+  for (size_t i = 0; i < ranges.size(); i++) {
+    for (unsigned int j = ranges[i].first; j < ranges[i].first + ranges[i].second; j++) {
+      const vpKeyPointDatabase::vpKeyPointRecord &record = records[j];
+      m_trainKeyPoints.push_back(cv::KeyPoint(cv::Point2f(record.u, record.v), record.size, record.angle,
+                                              record.response, record.octave, record.classId));
+      if (record.imageId != -1) {
+#ifdef VISP_HAVE_MODULE_IO
+        // No training images if image_id == -1
+        m_mapOfImageId[record.classId] = record.imageId;
+#endif
+      }
+
+      if (points != NULL) {
+        m_trainPoints.push_back(cv::Point3f(points[3 * j], points[3 * j + 1], points[3 * j + 2]));
+      }
+    }
+  }
+
+  size_t step = database->getDescriptorStep();
+  const unsigned char *descriptors = database->getDescriptors();
+  bool inPlace = false;
+#if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
+  if (ranges.size() == 1) {
+    // Contiguous descriptors are used in place, the matrix and its copies
+    // keeping the database open
+    m_trainDescriptors = wrapDescriptors(database, nbKeyPoints, descriptorCols, descriptorType,
+                                         descriptors + ranges[0].first * step, step);
+    inPlace = true;
+  }
+#endif
+  if (!inPlace && nbKeyPoints > 0) {
+    m_trainDescriptors.create(nbKeyPoints, descriptorCols, descriptorType);
+    int row = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      for (unsigned int j = ranges[i].first; j < ranges[i].first + ranges[i].second; j++, row++) {
+        memcpy(m_trainDescriptors.ptr(row), descriptors + j * step, database->getDescriptorRowSize());
+      }
+    }
+  }
+
+#ifdef VISP_HAVE_MODULE_IO
+  // Load the training images of the selected keypoints
+  std::string parent = vpIoTools::getParent(filename);
+  if (!parent.empty()) {
+    parent += "/";
+  }
+  std::map<int, std::string> mapOfImgPath;
+  database->getImagePaths(mapOfImgPath);
+  for (std::map<int, int>::const_iterator it = m_mapOfImageId.begin(); it != m_mapOfImageId.end(); ++it) {
+    std::map<int, std::string>::const_iterator it_path = mapOfImgPath.find(it->second);
+    if (it_path != mapOfImgPath.end() && m_mapOfImages.find(it->second) == m_mapOfImages.end()) {
+      vpImage<unsigned char> I;
+      if (vpIoTools::isAbsolutePathname(it_path->second)) {
+        vpImageIo::read(I, it_path->second);
+      } else {
+        vpImageIo::read(I, parent + it_path->second);
+      }
+      m_mapOfImages[it->second] = I;
+    }
+  }
+#endif
+
+  // Convert OpenCV type to ViSP type for compatibility
+  vpConvert::convertFromOpenCV(m_trainKeyPoints, referenceImagePointsList);
+  vpConvert::convertFromOpenCV(this->m_trainPoints, m_trainVpPoints);
+
+  // Add train descriptors in matcher object
+  m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  updateBinaryMatcher();
 
   // Set _reference_computed to true as we load a learning file
   _reference_computed = true;
@@ -2828,6 +3215,48 @@ void vpKeyPoint::match(const cv::Mat &trainDescriptors, const cv::Mat &queryDesc
 {
   double t = vpTime::measureTimeMs();
 
+  if (m_useBinaryMatcher) {
+    std::vector<std::vector<vpBinaryDescriptorMatcher::vpDescriptorMatch> > knnMatches;
+    unsigned int k = m_useKnn ? 2 : 1;
+
+    if (m_useMatchTrainToQuery) {
+      // Match train descriptors to query descriptors
+      vpBinaryDescriptorMatcher matcherTmp;
+      matcherTmp.setNbThreads(m_binaryMatcher.getNbThreads());
+      matcherTmp.addTrainDescriptors(queryDescriptors.data, (unsigned int)queryDescriptors.rows,
+                                     (unsigned int)queryDescriptors.cols, (unsigned int)queryDescriptors.step[0]);
+      matcherTmp.knnMatch(trainDescriptors.data, (unsigned int)trainDescriptors.rows,
+                          (unsigned int)trainDescriptors.step[0], k, knnMatches);
+    } else {
+      // Match query descriptors to train descriptors
+      m_binaryMatcher.knnMatch(queryDescriptors.data, (unsigned int)queryDescriptors.rows,
+                               (unsigned int)queryDescriptors.step[0], k, knnMatches);
+    }
+
+    m_knnMatches.clear();
+    matches.clear();
+    for (size_t i = 0; i < knnMatches.size(); i++) {
+      std::vector<cv::DMatch> tmp;
+      for (size_t j = 0; j < knnMatches[i].size(); j++) {
+        const vpBinaryDescriptorMatcher::vpDescriptorMatch &m = knnMatches[i][j];
+        if (m_useMatchTrainToQuery) {
+          tmp.push_back(cv::DMatch((int)m.trainIdx, (int)m.queryIdx, (float)m.distance));
+        } else {
+          tmp.push_back(cv::DMatch((int)m.queryIdx, (int)m.trainIdx, (float)m.distance));
+        }
+      }
+      if (m_useKnn) {
+        m_knnMatches.push_back(tmp);
+        matches.push_back(knnToDMatch(tmp));
+      } else if (!tmp.empty()) {
+        matches.push_back(tmp[0]);
+      }
+    }
+
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   if (m_useKnn) {
     m_knnMatches.clear();
 
@@ -3023,6 +3452,9 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
    estimation, if we want to eliminate the poses which do not respect some criterion
    \param rectangle : Rectangle corresponding to the ROI (Region of Interest) to consider
    \return True if the matching and the pose estimation are OK, false otherwise
+
+   \sa setUseTracking() to detect and match the keypoints only around their
+   locations predicted from the previous poses in a video.
  */
 bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParameters &cam, vpHomogeneousMatrix &cMo,
                             double &error, double &elapsedTime, bool (*func)(const vpHomogeneousMatrix &),
@@ -3039,71 +3471,86 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
     return false;
   }
 
-  if (m_useAffineDetection) {
-    std::vector<std::vector<cv::KeyPoint> > listOfQueryKeyPoints;
-    std::vector<cv::Mat> listOfQueryDescriptors;
-
-    // Detect keypoints and extract descriptors on multiple images
-    detectExtractAffine(I, listOfQueryKeyPoints, listOfQueryDescriptors);
-
-    // Flatten the different train lists
-    m_queryKeyPoints.clear();
-    for (std::vector<std::vector<cv::KeyPoint> >::const_iterator it = listOfQueryKeyPoints.begin();
-         it != listOfQueryKeyPoints.end(); ++it) {
-      m_queryKeyPoints.insert(m_queryKeyPoints.end(), it->begin(), it->end());
-    }
-
-    bool first = true;
-    for (std::vector<cv::Mat>::const_iterator it = listOfQueryDescriptors.begin(); it != listOfQueryDescriptors.end();
-         ++it) {
-      if (first) {
-        first = false;
-        it->copyTo(m_queryDescriptors);
-      } else {
-        m_queryDescriptors.push_back(*it);
-      }
+  // In the tracking mode, detect and match the keypoints around their
+  // predicted locations
+  double predictionTime = 0.;
+  bool tracked = false;
+  if (m_useTracking && m_trackingNbPoses > 0 && !m_useAffineDetection && !m_trainPoints.empty()) {
+    tracked = matchPredictedPoints(I, cam, rectangle);
+    if (!tracked) {
+      // Tracking lost, the keypoints are detected in the whole image
+      predictionTime = m_detectionTime + m_extractionTime + m_matchingTime;
+      m_trackingNbPoses = 0;
     }
-  } else {
-    detect(I, m_queryKeyPoints, m_detectionTime, rectangle);
-    extract(I, m_queryKeyPoints, m_queryDescriptors, m_extractionTime);
   }
 
-  match(m_trainDescriptors, m_queryDescriptors, m_matches, m_matchingTime);
+  if (!tracked) {
+    if (m_useAffineDetection) {
+      std::vector<std::vector<cv::KeyPoint> > listOfQueryKeyPoints;
+      std::vector<cv::Mat> listOfQueryDescriptors;
 
-  elapsedTime = m_detectionTime + m_extractionTime + m_matchingTime;
+      // Detect keypoints and extract descriptors on multiple images
+      detectExtractAffine(I, listOfQueryKeyPoints, listOfQueryDescriptors);
 
-  if (m_filterType != noFilterMatching) {
-    m_queryFilteredKeyPoints.clear();
-    m_objectFilteredPoints.clear();
-    m_filteredMatches.clear();
+      // Flatten the different train lists
+      m_queryKeyPoints.clear();
+      for (std::vector<std::vector<cv::KeyPoint> >::const_iterator it = listOfQueryKeyPoints.begin();
+           it != listOfQueryKeyPoints.end(); ++it) {
+        m_queryKeyPoints.insert(m_queryKeyPoints.end(), it->begin(), it->end());
+      }
 
-    filterMatches();
-  } else {
-    if (m_useMatchTrainToQuery) {
-      // Add only query keypoints matched with a train keypoints
-      m_queryFilteredKeyPoints.clear();
-      m_filteredMatches.clear();
-      for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
-        m_filteredMatches.push_back(cv::DMatch((int)m_queryFilteredKeyPoints.size(), it->trainIdx, it->distance));
-        m_queryFilteredKeyPoints.push_back(m_queryKeyPoints[(size_t)it->queryIdx]);
+      bool first = true;
+      for (std::vector<cv::Mat>::const_iterator it = listOfQueryDescriptors.begin(); it != listOfQueryDescriptors.end();
+           ++it) {
+        if (first) {
+          first = false;
+          it->copyTo(m_queryDescriptors);
+        } else {
+          m_queryDescriptors.push_back(*it);
+        }
       }
     } else {
-      m_queryFilteredKeyPoints = m_queryKeyPoints;
-      m_filteredMatches = m_matches;
+      detect(I, m_queryKeyPoints, m_detectionTime, rectangle);
+      extract(I, m_queryKeyPoints, m_queryDescriptors, m_extractionTime);
     }
 
-    if (!m_trainPoints.empty()) {
+    match(m_trainDescriptors, m_queryDescriptors, m_matches, m_matchingTime);
+
+    if (m_filterType != noFilterMatching) {
+      m_queryFilteredKeyPoints.clear();
       m_objectFilteredPoints.clear();
-      // Add 3D object points such as the same index in
-      // m_queryFilteredKeyPoints and in m_objectFilteredPoints
-      // matches to the same train object
-      for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
-        // m_matches is normally ordered following the queryDescriptor index
-        m_objectFilteredPoints.push_back(m_trainPoints[(size_t)it->trainIdx]);
+      m_filteredMatches.clear();
+
+      filterMatches();
+    } else {
+      if (m_useMatchTrainToQuery) {
+        // Add only query keypoints matched with a train keypoints
+        m_queryFilteredKeyPoints.clear();
+        m_filteredMatches.clear();
+        for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
+          m_filteredMatches.push_back(cv::DMatch((int)m_queryFilteredKeyPoints.size(), it->trainIdx, it->distance));
+          m_queryFilteredKeyPoints.push_back(m_queryKeyPoints[(size_t)it->queryIdx]);
+        }
+      } else {
+        m_queryFilteredKeyPoints = m_queryKeyPoints;
+        m_filteredMatches = m_matches;
+      }
+
+      if (!m_trainPoints.empty()) {
+        m_objectFilteredPoints.clear();
+        // Add 3D object points such as the same index in
+        // m_queryFilteredKeyPoints and in m_objectFilteredPoints
+        // matches to the same train object
+        for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
+          // m_matches is normally ordered following the queryDescriptor index
+          m_objectFilteredPoints.push_back(m_trainPoints[(size_t)it->trainIdx]);
+        }
       }
     }
   }
 
+  elapsedTime = predictionTime + m_detectionTime + m_extractionTime + m_matchingTime;
+
   // Convert OpenCV type to ViSP type for compatibility
   vpConvert::convertFromOpenCV(m_queryFilteredKeyPoints, currentImagePointsList);
   vpConvert::convertFromOpenCV(m_filteredMatches, matchedReferencePoints);
@@ -3114,6 +3561,7 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
   m_ransacInliers.clear();
   m_ransacOutliers.clear();
 
+  bool res = false;
   if (m_useRansacVVS) {
     std::vector<vpPoint> objectVpPoints(m_objectFilteredPoints.size());
     size_t cpt = 0;
@@ -3137,7 +3585,7 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
     std::vector<vpPoint> inliers;
     std::vector<unsigned int> inlierIndex;
 
-    bool res = computePose(objectVpPoints, cMo, inliers, inlierIndex, m_poseTime, func);
+    res = computePose(objectVpPoints, cMo, inliers, inlierIndex, m_poseTime, func);
 
     std::map<unsigned int, bool> mapOfInlierIndex;
     m_matchRansacKeyPointsToPoints.clear();
@@ -3159,15 +3607,11 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
     m_ransacInliers.resize(m_matchRansacKeyPointsToPoints.size());
     std::transform(m_matchRansacKeyPointsToPoints.begin(), m_matchRansacKeyPointsToPoints.end(),
                    m_ransacInliers.begin(), matchRansacToVpImage);
-
-    elapsedTime += m_poseTime;
-
-    return res;
   } else {
     std::vector<cv::Point2f> imageFilteredPoints;
     cv::KeyPoint::convert(m_queryFilteredKeyPoints, imageFilteredPoints);
     std::vector<int> inlierIndex;
-    bool res = computePose(imageFilteredPoints, m_objectFilteredPoints, cam, cMo, inlierIndex, m_poseTime);
+    res = computePose(imageFilteredPoints, m_objectFilteredPoints, cam, cMo, inlierIndex, m_poseTime);
 
     std::map<int, bool> mapOfInlierIndex;
     m_matchRansacKeyPointsToPoints.clear();
@@ -3189,11 +3633,27 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
     m_ransacInliers.resize(m_matchRansacKeyPointsToPoints.size());
     std::transform(m_matchRansacKeyPointsToPoints.begin(), m_matchRansacKeyPointsToPoints.end(),
                    m_ransacInliers.begin(), matchRansacToVpImage);
+  }
 
-    elapsedTime += m_poseTime;
+  elapsedTime += m_poseTime;
 
-    return res;
+  if (m_useTracking) {
+    if (res) {
+      m_trackingcMoPrevious = m_trackingcMo;
+      m_trackingcMo = cMo;
+      m_trackingNbPoses = std::min(m_trackingNbPoses + 1, 2u);
+    } else {
+      m_trackingNbPoses = 0;
+      if (tracked) {
+        // The predicted matches do not give a pose, retry in the whole image
+        double retryTime = 0.;
+        res = matchPoint(I, cam, cMo, error, retryTime, func, rectangle);
+        elapsedTime += retryTime;
+      }
+    }
   }
+
+  return res;
 }
 
 /*!
@@ -3393,6 +3853,162 @@ bool vpKeyPoint::matchPointAndDetect(const vpImage<unsigned char> &I, const vpCa
   return isMatchOk;
 }
 
+/*!
+   Detect and match the keypoints around the locations of the train
+   keypoints predicted from the previous poses, in the tracking mode (see
+   setUseTracking()).
+
+   The 3D train points are projected with the pose predicted by a constant
+   velocity model, the keypoints are detected and described in the regions
+   of interest around the predicted locations, and each query keypoint is
+   matched against the train keypoints predicted in its search radius with
+   a ratio test. The filtered matches are stored as by filterMatches().
+
+   The regions of interest are detected and described in parallel as the
+   tiles of the tiled detection (see detectTiled()), and the query keypoints
+   are matched in parallel, with the number of threads set by
+   vpKeyPointTiling::setNbThreads().
+
+   \param I : Input image.
+   \param cam : Camera parameters.
+   \param rectangle : Rectangle corresponding to the ROI (Region of Interest)
+   to consider.
+   \return True if at least getTrackingMinNbMatches() matches are found,
+   false otherwise.
+ */
+bool vpKeyPoint::matchPredictedPoints(const vpImage<unsigned char> &I, const vpCameraParameters &cam,
+                                      const vpRect &rectangle)
+{
+  double t = vpTime::measureTimeMs();
+
+  // Constant velocity model when the two previous poses are known
+  vpHomogeneousMatrix cMo = m_trackingcMo;
+  if (m_trackingNbPoses > 1) {
+    cMo = m_trackingcMo * m_trackingcMoPrevious.inverse() * m_trackingcMo;
+  }
+
+  bool useRectangle = rectangle.getWidth() > 0 && rectangle.getHeight() > 0;
+  std::vector<double> u, v;
+  std::vector<unsigned int> trainIndexes;
+  u.reserve(m_trainPoints.size());
+  v.reserve(m_trainPoints.size());
+  trainIndexes.reserve(m_trainPoints.size());
+  for (size_t i = 0; i < m_trainPoints.size(); i++) {
+    const cv::Point3f &P = m_trainPoints[i];
+    double Z = cMo[2][0] * P.x + cMo[2][1] * P.y + cMo[2][2] * P.z + cMo[2][3];
+    if (Z <= 0.) {
+      continue;
+    }
+    double x = (cMo[0][0] * P.x + cMo[0][1] * P.y + cMo[0][2] * P.z + cMo[0][3]) / Z;
+    double y = (cMo[1][0] * P.x + cMo[1][1] * P.y + cMo[1][2] * P.z + cMo[1][3]) / Z;
+    double ui = 0., vi = 0.;
+    vpMeterPixelConversion::convertPoint(cam, x, y, ui, vi);
+    if (useRectangle && !rectangle.isInside(vpImagePoint(vi, ui))) {
+      continue;
+    }
+    u.push_back(ui);
+    v.push_back(vi);
+    trainIndexes.push_back((unsigned int)i);
+  }
+  m_prediction.setPredictions(I.getWidth(), I.getHeight(), u, v, trainIndexes);
+
+  // Detection and extraction in the regions of interest
+  std::vector<vpKeyPointTiling::vpTile> rois;
+  m_prediction.computeRois(m_tiling.getOverlap(), rois);
+  cv::Mat matImg;
+  vpImageConvert::convert(I, matImg, false);
+  m_queryKeyPoints.clear();
+  detectTiled(matImg, rois, m_queryKeyPoints, cv::Mat());
+  m_detectionTime = vpTime::measureTimeMs() - t;
+
+  t = vpTime::measureTimeMs();
+  if (m_extractors.size() == 1) {
+    extractTiled(matImg, rois, m_queryKeyPoints, m_queryDescriptors);
+  } else {
+    extract(matImg, m_queryKeyPoints, m_queryDescriptors);
+  }
+  m_extractionTime = vpTime::measureTimeMs() - t;
+
+  // Match each query keypoint against the train keypoints predicted in its
+  // neighborhood
+  t = vpTime::measureTimeMs();
+  bool binary = m_trainDescriptors.type() == CV_8U;
+  std::vector<int> bestIndexes((size_t)m_queryDescriptors.rows, -1);
+  std::vector<double> bestDistances((size_t)m_queryDescriptors.rows, DBL_MAX);
+
+#ifdef VISP_HAVE_OPENMP
+  int nbThreads = m_tiling.getNbThreads() > 0 ? m_tiling.getNbThreads() : omp_get_max_threads();
+#pragma omp parallel num_threads(nbThreads)
+#endif
+  {
+    std::vector<unsigned int> candidates;
+#ifdef VISP_HAVE_OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i = 0; i < m_queryDescriptors.rows; i++) {
+      m_prediction.getCandidates(m_queryKeyPoints[(size_t)i].pt.x, m_queryKeyPoints[(size_t)i].pt.y, candidates);
+      const cv::Mat queryDescriptor = m_queryDescriptors.row(i);
+
+      int bestIdx = -1;
+      double bestDist = DBL_MAX, secondDist = DBL_MAX;
+      for (size_t j = 0; j < candidates.size(); j++) {
+        double dist = 0.;
+        if (binary) {
+          dist = vpBinaryDescriptorMatcher::hammingDistance(queryDescriptor.ptr<unsigned char>(0),
+                                                            m_trainDescriptors.ptr<unsigned char>((int)candidates[j]),
+                                                            (unsigned int)m_trainDescriptors.cols);
+        } else {
+          dist = cv::norm(queryDescriptor, m_trainDescriptors.row((int)candidates[j]), cv::NORM_L2);
+        }
+
+        if (dist < bestDist) {
+          secondDist = bestDist;
+          bestDist = dist;
+          bestIdx = (int)candidates[j];
+        } else if (dist < secondDist) {
+          secondDist = dist;
+        }
+      }
+
+      if (bestIdx >= 0 && (secondDist == DBL_MAX || bestDist < m_matchingRatioThreshold * secondDist)) {
+        bestIndexes[(size_t)i] = bestIdx;
+        bestDistances[(size_t)i] = bestDist;
+      }
+    }
+  }
+
+  // Gather the matches in the order of the query keypoints
+  m_matches.clear();
+  for (int i = 0; i < m_queryDescriptors.rows; i++) {
+    if (bestIndexes[(size_t)i] >= 0) {
+      m_matches.push_back(cv::DMatch(i, bestIndexes[(size_t)i], (float)bestDistances[(size_t)i]));
+    }
+  }
+
+  // Keep the matches with a single query keypoint per train keypoint, as
+  // filterMatches()
+  std::map<int, int> mapOfTrainIdx;
+  if (m_useSingleMatchFilter) {
+    for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
+      mapOfTrainIdx[it->trainIdx]++;
+    }
+  }
+
+  m_queryFilteredKeyPoints.clear();
+  m_objectFilteredPoints.clear();
+  m_filteredMatches.clear();
+  for (std::vector<cv::DMatch>::const_iterator it = m_matches.begin(); it != m_matches.end(); ++it) {
+    if (!m_useSingleMatchFilter || mapOfTrainIdx[it->trainIdx] == 1) {
+      m_filteredMatches.push_back(cv::DMatch((int)m_queryFilteredKeyPoints.size(), it->trainIdx, it->distance));
+      m_objectFilteredPoints.push_back(m_trainPoints[(size_t)it->trainIdx]);
+      m_queryFilteredKeyPoints.push_back(m_queryKeyPoints[(size_t)it->queryIdx]);
+    }
+  }
+  m_matchingTime = vpTime::measureTimeMs() - t;
+
+  return m_filteredMatches.size() >= m_trackingMinNbMatches;
+}
+
 /*!
     Apply a set of affine transormations to the image, detect keypoints and
     reproject them into initial image coordinates.
@@ -3565,6 +4181,7 @@ void vpKeyPoint::reset()
   m_knnMatches.clear();
   m_mapOfImageId.clear();
   m_mapOfImages.clear();
+  m_binaryMatcher.clear();
   m_matcher = cv::Ptr<cv::DescriptorMatcher>();
   m_matcherName = "BruteForce-Hamming";
   m_matches.clear();
@@ -3576,6 +4193,7 @@ void vpKeyPoint::reset()
   m_nbRansacMinInlierCount = 100;
   m_objectFilteredPoints.clear();
   m_poseTime = 0.0;
+  m_prediction = vpKeyPointPrediction();
   m_queryDescriptors = cv::Mat();
   m_queryFilteredKeyPoints.clear();
   m_queryKeyPoints.clear();
@@ -3587,11 +4205,15 @@ void vpKeyPoint::reset()
   m_ransacParallelNbThreads = 0;
   m_ransacReprojectionError = 6.0;
   m_ransacThreshold = 0.01;
+  m_tiling = vpKeyPointTiling();
+  m_trackingMinNbMatches = 30;
+  m_trackingNbPoses = 0;
   m_trainDescriptors = cv::Mat();
   m_trainKeyPoints.clear();
   m_trainPoints.clear();
   m_trainVpPoints.clear();
   m_useAffineDetection = false;
+  m_useBinaryMatcher = false;
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   m_useBruteForceCrossCheck = true;
 #endif
@@ -3600,6 +4222,8 @@ void vpKeyPoint::reset()
   m_useMatchTrainToQuery = false;
   m_useRansacVVS = true;
   m_useSingleMatchFilter = true;
+  m_useTiledDetection = false;
+  m_useTracking = false;
 
   m_detectorNames.push_back("ORB");
   m_extractorNames.push_back("ORB");
@@ -3624,51 +4248,7 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
 
   std::map<int, std::string> mapOfImgPath;
   if (saveTrainingImages) {
-#ifdef VISP_HAVE_MODULE_IO
-    // Save the training image files in the same directory
-    unsigned int cpt = 0;
-
-    for (std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end();
-         ++it, cpt++) {
-      if (cpt > 999) {
-        throw vpException(vpException::fatalError, "The number of training images to save is too big !");
-      }
-
-      std::stringstream ss;
-      ss << "train_image_" << std::setfill('0') << std::setw(3) << cpt;
-
-      switch (m_imageFormat) {
-      case jpgImageFormat:
-        ss << ".jpg";
-        break;
-
-      case pngImageFormat:
-        ss << ".png";
-        break;
-
-      case ppmImageFormat:
-        ss << ".ppm";
-        break;
-
-      case pgmImageFormat:
-        ss << ".pgm";
-        break;
-
-      default:
-        ss << ".png";
-        break;
-      }
-
-      std::string imgFilename = ss.str();
-      mapOfImgPath[it->first] = imgFilename;
-      vpImageIo::write(it->second, parent + (!parent.empty() ? "/" : "") + imgFilename);
-    }
-#else
-    std::cout << "Warning: in vpKeyPoint::saveLearningData() training images "
-                 "are not saved because "
-                 "visp_io module is not available !"
-              << std::endl;
-#endif
+    writeTrainingImages(parent, mapOfImgPath);
   }
 
   bool have3DInfo = m_trainPoints.size() > 0;
@@ -4003,6 +4583,125 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
   }
 }
 
+/*!
+   Save the learning data in a memory-mappable database (see
+   vpKeyPointDatabase) that can be loaded with loadLearningDatabase().
+
+   \param filename : Path of the database.
+   \param saveTrainingImages : If true, save also the training images on
+   disk, next to the database.
+ */
+void vpKeyPoint::saveLearningDatabase(const std::string &filename, const bool saveTrainingImages)
+{
+  std::string parent = vpIoTools::getParent(filename);
+  if (!parent.empty()) {
+    vpIoTools::makeDirectory(parent);
+  }
+
+  std::map<int, std::string> mapOfImgPath;
+  if (saveTrainingImages) {
+    writeTrainingImages(parent, mapOfImgPath);
+  }
+
+  bool have3DInfo = m_trainPoints.size() > 0;
+  if (have3DInfo && m_trainPoints.size() != m_trainKeyPoints.size()) {
+    throw vpException(vpException::fatalError, "List of keypoints and list of 3D points have different size !");
+  }
+  if ((size_t)m_trainDescriptors.rows != m_trainKeyPoints.size()) {
+    throw vpException(vpException::fatalError, "List of keypoints and train descriptors have different size !");
+  }
+
+  std::vector<vpKeyPointDatabase::vpKeyPointRecord> keyPoints(m_trainKeyPoints.size());
+  std::vector<float> points(have3DInfo ? 3 * m_trainPoints.size() : 0);
+  for (size_t i = 0; i < m_trainKeyPoints.size(); i++) {
+    const cv::KeyPoint &kpt = m_trainKeyPoints[i];
+    vpKeyPointDatabase::vpKeyPointRecord &record = keyPoints[i];
+    record.u = kpt.pt.x;
+    record.v = kpt.pt.y;
+    record.size = kpt.size;
+    record.angle = kpt.angle;
+    record.response = kpt.response;
+    record.octave = kpt.octave;
+    record.classId = kpt.class_id;
+    record.imageId = -1;
+#ifdef VISP_HAVE_MODULE_IO
+    std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(kpt.class_id);
+    if (saveTrainingImages && it_findImgId != m_mapOfImageId.end()) {
+      record.imageId = it_findImgId->second;
+    }
+#endif
+
+    if (have3DInfo) {
+      points[3 * i] = m_trainPoints[i].x;
+      points[3 * i + 1] = m_trainPoints[i].y;
+      points[3 * i + 2] = m_trainPoints[i].z;
+    }
+  }
+
+  unsigned int rowSize = (unsigned int)(m_trainDescriptors.cols * m_trainDescriptors.elemSize());
+  vpKeyPointDatabase::write(filename, keyPoints, m_trainDescriptors.data, rowSize,
+                            (unsigned int)m_trainDescriptors.step[0], (unsigned int)m_trainDescriptors.cols,
+                            m_trainDescriptors.type(), have3DInfo ? &points[0] : NULL, mapOfImgPath);
+}
+
+/*!
+   Save the training images in the directory \e parent.
+
+   \param parent : Directory of the training images.
+   \param mapOfImgPath : Relative path of the saved images, indexed by
+   training image id.
+ */
+void vpKeyPoint::writeTrainingImages(const std::string &parent, std::map<int, std::string> &mapOfImgPath)
+{
+#ifdef VISP_HAVE_MODULE_IO
+  // Save the training image files in the same directory
+  unsigned int cpt = 0;
+
+  for (std::map<int, vpImage<unsigned char> >::const_iterator it = m_mapOfImages.begin(); it != m_mapOfImages.end();
+       ++it, cpt++) {
+    if (cpt > 999) {
+      throw vpException(vpException::fatalError, "The number of training images to save is too big !");
+    }
+
+    std::stringstream ss;
+    ss << "train_image_" << std::setfill('0') << std::setw(3) << cpt;
+
+    switch (m_imageFormat) {
+    case jpgImageFormat:
+      ss << ".jpg";
+      break;
+
+    case pngImageFormat:
+      ss << ".png";
+      break;
+
+    case ppmImageFormat:
+      ss << ".ppm";
+      break;
+
+    case pgmImageFormat:
+      ss << ".pgm";
+      break;
+
+    default:
+      ss << ".png";
+      break;
+    }
+
+    std::string imgFilename = ss.str();
+    mapOfImgPath[it->first] = imgFilename;
+    vpImageIo::write(it->second, parent + (!parent.empty() ? "/" : "") + imgFilename);
+  }
+#else
+  (void)parent;
+  (void)mapOfImgPath;
+  std::cout << "Warning: in vpKeyPoint::saveLearningData() training images "
+               "are not saved because "
+               "visp_io module is not available !"
+            << std::endl;
+#endif
+}
+
 #if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x030000)
 // From OpenCV 2.4.11 source code.
 struct KeypointResponseGreaterThanThreshold {
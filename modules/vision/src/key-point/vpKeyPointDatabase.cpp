@@ -0,0 +1,517 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Memory-mapped database of learned keypoints.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdint.h> // for uint32_t related types ; works also with >= VS2010 / _MSC_VER >= 1600
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpKeyPointDatabase.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VISP_KEYPOINT_DATABASE_MMAP 1
+#elif defined(_WIN32) && !defined(WINRT)
+#include <windows.h>
+#define VISP_KEYPOINT_DATABASE_MMAP 1
+#endif
+
+const unsigned int vpKeyPointDatabase::version;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+const char databaseMagic[8] = {'V', 'I', 'S', 'P', 'K', 'P', 'D', 'B'};
+const uint32_t databaseByteOrder = 0x01020304;
+const uint64_t sectionAlignment = 64;
+const unsigned int descriptorAlignment = 16;
+
+// Header at the beginning of the file, padded to headerSize bytes
+struct vpDatabaseHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t headerSize;
+  uint32_t nbKeyPoints;
+  uint32_t nbGroups;
+  uint32_t nbImages;
+  int32_t descriptorType;
+  uint32_t descriptorCols;
+  uint32_t descriptorRowSize;
+  uint32_t descriptorStep;
+  uint64_t keyPointsOffset;
+  uint64_t descriptorsOffset;
+  uint64_t pointsOffset; // 0 if there is no 3D point
+  uint64_t groupsOffset;
+  uint64_t imagesOffset;
+  uint64_t stringsOffset;
+  uint64_t stringsSize;
+  uint64_t fileSize;
+};
+
+const uint64_t headerSize = 128;
+
+// The records are written as is: their layout must not depend on the compiler
+typedef char checkKeyPointRecordSize[sizeof(vpKeyPointDatabase::vpKeyPointRecord) == 32 ? 1 : -1];
+typedef char checkGroupRecordSize[sizeof(vpKeyPointDatabase::vpGroupRecord) == 16 ? 1 : -1];
+typedef char checkHeaderSize[sizeof(vpDatabaseHeader) <= 128 ? 1 : -1];
+
+uint64_t alignOffset(uint64_t offset, uint64_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+
+void writePadding(std::ofstream &file, uint64_t &position, uint64_t offset)
+{
+  static const char zeros[sectionAlignment] = {0};
+  while (position < offset) {
+    uint64_t n = std::min<uint64_t>(offset - position, sectionAlignment);
+    file.write(zeros, (std::streamsize)n);
+    position += n;
+  }
+}
+
+void writeData(std::ofstream &file, uint64_t &position, const void *data, size_t size)
+{
+  file.write(static_cast<const char *>(data), (std::streamsize)size);
+  position += size;
+}
+
+// Stable order of the keypoints by class id then by image id
+class vpGroupOrder
+{
+public:
+  explicit vpGroupOrder(const std::vector<vpKeyPointDatabase::vpKeyPointRecord> &keyPoints) : m_keyPoints(keyPoints)
+  {
+  }
+
+  bool operator()(unsigned int a, unsigned int b) const
+  {
+    const vpKeyPointDatabase::vpKeyPointRecord &ka = m_keyPoints[a], &kb = m_keyPoints[b];
+    return ka.classId < kb.classId || (ka.classId == kb.classId && ka.imageId < kb.imageId);
+  }
+
+private:
+  const std::vector<vpKeyPointDatabase::vpKeyPointRecord> &m_keyPoints;
+};
+
+bool checkSection(uint64_t offset, uint64_t size, uint64_t fileSize)
+{
+  return offset % 4 == 0 && offset <= fileSize && size <= fileSize - offset;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Default constructor. No database is opened.
+*/
+vpKeyPointDatabase::vpKeyPointDatabase()
+  : m_data(NULL), m_size(0), m_mapped(false), m_buffer(), m_keyPoints(NULL), m_nbKeyPoints(0),
+    m_descriptors(NULL), m_descriptorCols(0), m_descriptorRowSize(0), m_descriptorStep(0), m_descriptorType(0),
+    m_points(NULL), m_groups(NULL), m_nbGroups(0), m_images(NULL), m_nbImages(0), m_strings(NULL), m_stringsSize(0)
+{
+}
+
+/*!
+  Destructor. Unmap the database.
+*/
+vpKeyPointDatabase::~vpKeyPointDatabase() { close(); }
+
+/*!
+  Unmap or free the opened database. The pointers returned by the accessors
+  are no more valid.
+*/
+void vpKeyPointDatabase::close()
+{
+  if (m_data != NULL && m_mapped) {
+#if !defined(_WIN32) && defined(VISP_KEYPOINT_DATABASE_MMAP)
+    munmap(m_data, m_size);
+#elif defined(VISP_KEYPOINT_DATABASE_MMAP)
+    UnmapViewOfFile(m_data);
+#endif
+  }
+  m_buffer.clear();
+  m_data = NULL;
+  m_size = 0;
+  m_mapped = false;
+  m_keyPoints = NULL;
+  m_nbKeyPoints = 0;
+  m_descriptors = NULL;
+  m_descriptorCols = 0;
+  m_descriptorRowSize = 0;
+  m_descriptorStep = 0;
+  m_descriptorType = 0;
+  m_points = NULL;
+  m_groups = NULL;
+  m_nbGroups = 0;
+  m_images = NULL;
+  m_nbImages = 0;
+  m_strings = NULL;
+  m_stringsSize = 0;
+}
+
+/*!
+  Return the path of a training image as given to write(), or an empty
+  string if the database does not contain this image.
+
+  \param imageId : Id of the training image.
+*/
+std::string vpKeyPointDatabase::getImagePath(int imageId) const
+{
+  for (unsigned int i = 0; i < m_nbImages; i++) {
+    if (m_images[4 * i] == imageId) {
+      return std::string(m_strings + m_images[4 * i + 1], (size_t)m_images[4 * i + 2]);
+    }
+  }
+  return std::string();
+}
+
+/*!
+  Get the paths of all the training images of the database.
+
+  \param imagePaths : Map between the training image ids and their path.
+*/
+void vpKeyPointDatabase::getImagePaths(std::map<int, std::string> &imagePaths) const
+{
+  imagePaths.clear();
+  for (unsigned int i = 0; i < m_nbImages; i++) {
+    imagePaths[m_images[4 * i]] = std::string(m_strings + m_images[4 * i + 1], (size_t)m_images[4 * i + 2]);
+  }
+}
+
+/*!
+  Select the keypoints of some classes and training images. Only the group
+  table is read, its size being the number of different (class id, image id)
+  pairs.
+
+  \param classIds : Class ids of the selected keypoints, all the classes if
+  empty.
+  \param imageIds : Training image ids of the selected keypoints, all the
+  images if empty.
+  \param ranges : Contiguous ranges of selected keypoints, as pairs of first
+  index and number of keypoints. Adjacent groups are merged in the same
+  range.
+*/
+void vpKeyPointDatabase::getRanges(const std::vector<int> &classIds, const std::vector<int> &imageIds,
+                                   std::vector<std::pair<unsigned int, unsigned int> > &ranges) const
+{
+  ranges.clear();
+  std::vector<int> sortedClassIds(classIds), sortedImageIds(imageIds);
+  std::sort(sortedClassIds.begin(), sortedClassIds.end());
+  std::sort(sortedImageIds.begin(), sortedImageIds.end());
+
+  for (unsigned int i = 0; i < m_nbGroups; i++) {
+    const vpGroupRecord &group = m_groups[i];
+    if (group.count == 0 ||
+        (!sortedClassIds.empty() &&
+         !std::binary_search(sortedClassIds.begin(), sortedClassIds.end(), group.classId)) ||
+        (!sortedImageIds.empty() &&
+         !std::binary_search(sortedImageIds.begin(), sortedImageIds.end(), group.imageId))) {
+      continue;
+    }
+
+    if (!ranges.empty() && ranges.back().first + ranges.back().second == group.first) {
+      ranges.back().second += group.count;
+    } else {
+      ranges.push_back(std::make_pair(group.first, group.count));
+    }
+  }
+}
+
+/*!
+  Open a database written by write(). The file is memory-mapped when the
+  platform allows it, otherwise it is read in memory. The previously opened
+  database is closed.
+
+  \param filename : Path of the database.
+
+  \exception vpException::ioError : The file cannot be opened or is not a
+  valid database.
+*/
+void vpKeyPointDatabase::open(const std::string &filename)
+{
+  close();
+
+#if !defined(_WIN32) && defined(VISP_KEYPOINT_DATABASE_MMAP)
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= headerSize) {
+      // A read-only mapping: the pages are shared with the other processes
+      void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        m_data = static_cast<unsigned char *>(data);
+        m_size = (size_t)st.st_size;
+        m_mapped = true;
+      }
+    }
+    ::close(fd);
+  }
+#elif defined(VISP_KEYPOINT_DATABASE_MMAP)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && (uint64_t)fileSize.QuadPart >= headerSize) {
+      HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping != NULL) {
+        // The view keeps a reference on the mapping object
+        void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data != NULL) {
+          m_data = static_cast<unsigned char *>(data);
+          m_size = (size_t)fileSize.QuadPart;
+          m_mapped = true;
+        }
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+  }
+#endif
+
+  if (m_data == NULL) {
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    if (!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot open the keypoint database \"%s\"", filename.c_str());
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size < (std::streamoff)headerSize) {
+      throw vpException(vpException::ioError, "\"%s\" is not a keypoint database", filename.c_str());
+    }
+    // The buffer of doubles ensures the alignment of the records
+    m_buffer.resize(((size_t)size + sizeof(double) - 1) / sizeof(double));
+    file.read(reinterpret_cast<char *>(&m_buffer[0]), size);
+    if (!file) {
+      m_buffer.clear();
+      throw vpException(vpException::ioError, "Cannot read the keypoint database \"%s\"", filename.c_str());
+    }
+    m_data = reinterpret_cast<unsigned char *>(&m_buffer[0]);
+    m_size = (size_t)size;
+  }
+
+  vpDatabaseHeader header;
+  memcpy(&header, m_data, sizeof(header));
+  const char *error = NULL;
+  if (memcmp(header.magic, databaseMagic, sizeof(databaseMagic)) != 0) {
+    error = "is not a keypoint database";
+  } else if (header.byteOrder != databaseByteOrder) {
+    error = "has been written on a machine with a different byte order";
+  } else if (header.version > version || header.version == 0) {
+    error = "has an unsupported version";
+  } else if (header.headerSize < headerSize || header.fileSize > m_size ||
+             header.descriptorStep < header.descriptorRowSize ||
+             !checkSection(header.keyPointsOffset, (uint64_t)header.nbKeyPoints * sizeof(vpKeyPointRecord), m_size) ||
+             !checkSection(header.descriptorsOffset, (uint64_t)header.nbKeyPoints * header.descriptorStep, m_size) ||
+             (header.pointsOffset != 0 &&
+              !checkSection(header.pointsOffset, (uint64_t)header.nbKeyPoints * 3 * sizeof(float), m_size)) ||
+             !checkSection(header.groupsOffset, (uint64_t)header.nbGroups * sizeof(vpGroupRecord), m_size) ||
+             !checkSection(header.imagesOffset, (uint64_t)header.nbImages * 4 * sizeof(int), m_size) ||
+             !checkSection(header.stringsOffset, header.stringsSize, m_size)) {
+    error = "is truncated or corrupted";
+  }
+
+  if (error == NULL) {
+    m_keyPoints = reinterpret_cast<const vpKeyPointRecord *>(m_data + header.keyPointsOffset);
+    m_nbKeyPoints = header.nbKeyPoints;
+    m_descriptors = m_data + header.descriptorsOffset;
+    m_descriptorCols = header.descriptorCols;
+    m_descriptorRowSize = header.descriptorRowSize;
+    m_descriptorStep = header.descriptorStep;
+    m_descriptorType = header.descriptorType;
+    m_points = header.pointsOffset != 0 ? reinterpret_cast<const float *>(m_data + header.pointsOffset) : NULL;
+    m_groups = reinterpret_cast<const vpGroupRecord *>(m_data + header.groupsOffset);
+    m_nbGroups = header.nbGroups;
+    m_images = reinterpret_cast<const int *>(m_data + header.imagesOffset);
+    m_nbImages = header.nbImages;
+    m_strings = reinterpret_cast<const char *>(m_data + header.stringsOffset);
+    m_stringsSize = (size_t)header.stringsSize;
+
+    // The small group and image tables are checked to make the accessors safe
+    for (unsigned int i = 0; i < m_nbGroups && error == NULL; i++) {
+      if (m_groups[i].first > m_nbKeyPoints || m_groups[i].count > m_nbKeyPoints - m_groups[i].first) {
+        error = "has a corrupted group table";
+      }
+    }
+    for (unsigned int i = 0; i < m_nbImages && error == NULL; i++) {
+      if (m_images[4 * i + 1] < 0 || m_images[4 * i + 2] < 0 ||
+          (size_t)m_images[4 * i + 1] + (size_t)m_images[4 * i + 2] > m_stringsSize) {
+        error = "has a corrupted image table";
+      }
+    }
+  }
+
+  if (error != NULL) {
+    close();
+    throw vpException(vpException::ioError, "The keypoint database \"%s\" %s", filename.c_str(), error);
+  }
+}
+
+/*!
+  Write a keypoint database. The keypoints are sorted by class id then by
+  training image id; the order of the keypoints sharing the same class and
+  image ids is kept.
+
+  \param filename : Path of the database.
+  \param keyPoints : Keypoints to save.
+  \param descriptors : Descriptors of the keypoints.
+  \param descriptorRowSize : Number of bytes of a descriptor.
+  \param descriptorStep : Number of bytes between two consecutive
+  descriptors in \e descriptors.
+  \param descriptorCols : Number of columns of a descriptor.
+  \param descriptorType : Type of the descriptors, returned by
+  getDescriptorType().
+  \param points : 3D coordinates (X, Y, Z) of the keypoints, or NULL.
+  \param imagePaths : Paths of the training images, indexed by image id.
+
+  \exception vpException::badValue : The size of the descriptors is not
+  consistent.
+  \exception vpException::ioError : The file cannot be written.
+*/
+void vpKeyPointDatabase::write(const std::string &filename, const std::vector<vpKeyPointRecord> &keyPoints,
+                               const unsigned char *descriptors, unsigned int descriptorRowSize,
+                               unsigned int descriptorStep, unsigned int descriptorCols, int descriptorType,
+                               const float *points, const std::map<int, std::string> &imagePaths)
+{
+  if (descriptorStep < descriptorRowSize || (!keyPoints.empty() && descriptorRowSize > 0 && descriptors == NULL)) {
+    throw vpException(vpException::badValue, "Bad descriptors of size %u with a step of %u", descriptorRowSize,
+                      descriptorStep);
+  }
+
+  unsigned int nbKeyPoints = (unsigned int)keyPoints.size();
+  std::vector<unsigned int> order(nbKeyPoints);
+  for (unsigned int i = 0; i < nbKeyPoints; i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), vpGroupOrder(keyPoints));
+
+  std::vector<vpGroupRecord> groups;
+  for (unsigned int i = 0; i < nbKeyPoints; i++) {
+    const vpKeyPointRecord &kpt = keyPoints[order[i]];
+    if (groups.empty() || groups.back().classId != kpt.classId || groups.back().imageId != kpt.imageId) {
+      vpGroupRecord group;
+      group.classId = kpt.classId;
+      group.imageId = kpt.imageId;
+      group.first = i;
+      group.count = 0;
+      groups.push_back(group);
+    }
+    groups.back().count++;
+  }
+
+  std::vector<int> images;
+  std::string strings;
+  for (std::map<int, std::string>::const_iterator it = imagePaths.begin(); it != imagePaths.end(); ++it) {
+    images.push_back(it->first);
+    images.push_back((int)strings.size());
+    images.push_back((int)it->second.size());
+    images.push_back(0);
+    strings += it->second;
+  }
+
+  vpDatabaseHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, databaseMagic, sizeof(databaseMagic));
+  header.version = version;
+  header.byteOrder = databaseByteOrder;
+  header.headerSize = (uint32_t)headerSize;
+  header.nbKeyPoints = nbKeyPoints;
+  header.nbGroups = (uint32_t)groups.size();
+  header.nbImages = (uint32_t)imagePaths.size();
+  header.descriptorType = descriptorType;
+  header.descriptorCols = descriptorCols;
+  header.descriptorRowSize = descriptorRowSize;
+  header.descriptorStep = (descriptorRowSize + descriptorAlignment - 1) / descriptorAlignment * descriptorAlignment;
+  header.keyPointsOffset = headerSize;
+  header.descriptorsOffset =
+      alignOffset(header.keyPointsOffset + (uint64_t)nbKeyPoints * sizeof(vpKeyPointRecord), sectionAlignment);
+  uint64_t offset =
+      alignOffset(header.descriptorsOffset + (uint64_t)nbKeyPoints * header.descriptorStep, sectionAlignment);
+  if (points != NULL) {
+    header.pointsOffset = offset;
+    offset = alignOffset(offset + (uint64_t)nbKeyPoints * 3 * sizeof(float), sectionAlignment);
+  }
+  header.groupsOffset = offset;
+  header.imagesOffset = alignOffset(header.groupsOffset + groups.size() * sizeof(vpGroupRecord), sectionAlignment);
+  header.stringsOffset = alignOffset(header.imagesOffset + images.size() * sizeof(int), sectionAlignment);
+  header.stringsSize = strings.size();
+  header.fileSize = alignOffset(header.stringsOffset + header.stringsSize, sectionAlignment);
+
+  std::ofstream file(filename.c_str(), std::ofstream::binary);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot create the keypoint database \"%s\"", filename.c_str());
+  }
+
+  uint64_t position = 0;
+  writeData(file, position, &header, sizeof(header));
+
+  writePadding(file, position, header.keyPointsOffset);
+  for (unsigned int i = 0; i < nbKeyPoints; i++) {
+    writeData(file, position, &keyPoints[order[i]], sizeof(vpKeyPointRecord));
+  }
+
+  writePadding(file, position, header.descriptorsOffset);
+  for (unsigned int i = 0; i < nbKeyPoints; i++) {
+    writeData(file, position, descriptors + (size_t)order[i] * descriptorStep, descriptorRowSize);
+    writePadding(file, position, header.descriptorsOffset + (uint64_t)(i + 1) * header.descriptorStep);
+  }
+
+  if (points != NULL) {
+    writePadding(file, position, header.pointsOffset);
+    for (unsigned int i = 0; i < nbKeyPoints; i++) {
+      writeData(file, position, points + 3 * (size_t)order[i], 3 * sizeof(float));
+    }
+  }
+
+  writePadding(file, position, header.groupsOffset);
+  if (!groups.empty()) {
+    writeData(file, position, &groups[0], groups.size() * sizeof(vpGroupRecord));
+  }
+
+  writePadding(file, position, header.imagesOffset);
+  if (!images.empty()) {
+    writeData(file, position, &images[0], images.size() * sizeof(int));
+  }
+
+  writePadding(file, position, header.stringsOffset);
+  writeData(file, position, strings.data(), strings.size());
+  writePadding(file, position, header.fileSize);
+
+  if (!file) {
+    throw vpException(vpException::ioError, "Cannot write the keypoint database \"%s\"", filename.c_str());
+  }
+}
@@ -0,0 +1,305 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Spatial index of the predicted locations of train keypoints.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpKeyPointPrediction.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Rectangle of cells [left, right[ x [top, bottom[ still growing downward
+struct vpCellRect {
+  unsigned int left;
+  unsigned int right;
+  unsigned int top;
+};
+
+bool tileOrder(const vpKeyPointTiling::vpTile &a, const vpKeyPointTiling::vpTile &b)
+{
+  return a.coreTop < b.coreTop || (a.coreTop == b.coreTop && a.coreLeft < b.coreLeft);
+}
+
+int clampCell(double coord, double cellSize, unsigned int nbCells)
+{
+  int cell = (int)std::floor(coord / cellSize);
+  return std::min(std::max(cell, 0), (int)nbCells - 1);
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Constructor.
+
+  \param searchRadius : Search radius in pixels around the predicted
+  locations.
+  \param roiCellSize : Size in pixels of the cells used to build the regions
+  of interest.
+*/
+vpKeyPointPrediction::vpKeyPointPrediction(double searchRadius, unsigned int roiCellSize)
+  : m_width(0), m_height(0), m_searchRadius(20.), m_roiCellSize(32), m_u(), m_v(), m_trainIndexes(),
+    m_gridCellSize(1.), m_gridCols(0), m_gridRows(0), m_gridOffsets(), m_gridIndexes()
+{
+  setSearchRadius(searchRadius);
+  setRoiCellSize(roiCellSize);
+}
+
+/*!
+  Remove all the predicted locations.
+*/
+void vpKeyPointPrediction::clear()
+{
+  m_u.clear();
+  m_v.clear();
+  m_trainIndexes.clear();
+  m_gridCols = 0;
+  m_gridRows = 0;
+  m_gridOffsets.clear();
+  m_gridIndexes.clear();
+}
+
+/*!
+  Compute the regions of the image in which the keypoints have to be
+  detected.
+
+  The image is divided in cells of getRoiCellSize() pixels. A cell is
+  selected when it intersects the square of half size getSearchRadius()
+  centered on a predicted location. The selected cells are grouped in
+  disjoint rectangles that are returned as the core regions of the tiles;
+  the detection window of a tile is its core region enlarged by \e overlap
+  pixels, exactly as for vpKeyPointTiling, so that the keypoints can be
+  selected with vpKeyPointTiling::selectKeyPoints().
+
+  \param overlap : Number of pixels added on each side of the core regions.
+  It has to be greater than the border used by the detector and than the
+  radius of the descriptor patch.
+  \param rois : Regions of interest, sorted by rows then columns. Empty if
+  there is no predicted location.
+*/
+void vpKeyPointPrediction::computeRois(unsigned int overlap, std::vector<vpKeyPointTiling::vpTile> &rois) const
+{
+  rois.clear();
+  if (m_trainIndexes.empty()) {
+    return;
+  }
+
+  double cellSize = (double)m_roiCellSize;
+  unsigned int nbCols = (m_width + m_roiCellSize - 1) / m_roiCellSize;
+  unsigned int nbRows = (m_height + m_roiCellSize - 1) / m_roiCellSize;
+  std::vector<unsigned char> selected((size_t)nbCols * nbRows, 0);
+  for (size_t i = 0; i < m_trainIndexes.size(); i++) {
+    int left = clampCell(m_u[i] - m_searchRadius, cellSize, nbCols);
+    int right = clampCell(m_u[i] + m_searchRadius, cellSize, nbCols);
+    int top = clampCell(m_v[i] - m_searchRadius, cellSize, nbRows);
+    int bottom = clampCell(m_v[i] + m_searchRadius, cellSize, nbRows);
+    for (int y = top; y <= bottom; y++) {
+      for (int x = left; x <= right; x++) {
+        selected[(size_t)y * nbCols + x] = 1;
+      }
+    }
+  }
+
+  // Runs of selected cells, merged with the rectangle of the previous row
+  // when they span the same columns
+  std::vector<vpCellRect> open, next;
+  int w = (int)m_width, h = (int)m_height, o = (int)overlap;
+  for (unsigned int y = 0; y <= nbRows; y++) {
+    next.clear();
+    size_t k = 0;
+    for (unsigned int x = 0; y < nbRows && x < nbCols; x++) {
+      if (!selected[(size_t)y * nbCols + x]) {
+        continue;
+      }
+      vpCellRect run;
+      run.left = x;
+      while (x < nbCols && selected[(size_t)y * nbCols + x]) {
+        x++;
+      }
+      run.right = x;
+      run.top = y;
+      // The open rectangles are sorted by column, as the runs
+      while (k < open.size() && open[k].right <= run.left) {
+        k++;
+      }
+      if (k < open.size() && open[k].left == run.left && open[k].right == run.right) {
+        run.top = open[k].top;
+        open[k].right = 0; // Continued
+      }
+      next.push_back(run);
+    }
+
+    for (size_t i = 0; i < open.size(); i++) {
+      if (open[i].right == 0) {
+        continue;
+      }
+      vpKeyPointTiling::vpTile roi;
+      roi.coreLeft = (int)(open[i].left * m_roiCellSize);
+      roi.coreRight = std::min((int)(open[i].right * m_roiCellSize), w);
+      roi.coreTop = (int)(open[i].top * m_roiCellSize);
+      roi.coreBottom = std::min((int)(y * m_roiCellSize), h);
+      roi.left = std::max(roi.coreLeft - o, 0);
+      roi.right = std::min(roi.coreRight + o, w);
+      roi.top = std::max(roi.coreTop - o, 0);
+      roi.bottom = std::min(roi.coreBottom + o, h);
+      rois.push_back(roi);
+    }
+    open.swap(next);
+  }
+
+  std::sort(rois.begin(), rois.end(), tileOrder);
+}
+
+/*!
+  Get the train keypoints whose predicted location is at most
+  getSearchRadius() pixels away from an image point.
+
+  \param u : Column coordinate of the image point.
+  \param v : Row coordinate of the image point.
+  \param trainIndexes : Indexes of the train keypoints.
+*/
+void vpKeyPointPrediction::getCandidates(double u, double v, std::vector<unsigned int> &trainIndexes) const
+{
+  trainIndexes.clear();
+  if (m_gridIndexes.empty()) {
+    return;
+  }
+
+  int left = clampCell(u - m_searchRadius, m_gridCellSize, m_gridCols);
+  int right = clampCell(u + m_searchRadius, m_gridCellSize, m_gridCols);
+  int top = clampCell(v - m_searchRadius, m_gridCellSize, m_gridRows);
+  int bottom = clampCell(v + m_searchRadius, m_gridCellSize, m_gridRows);
+  double radius2 = m_searchRadius * m_searchRadius;
+  for (int y = top; y <= bottom; y++) {
+    size_t cell = (size_t)y * m_gridCols;
+    for (unsigned int n = m_gridOffsets[cell + left]; n < m_gridOffsets[cell + right + 1]; n++) {
+      unsigned int i = m_gridIndexes[n];
+      double du = m_u[i] - u, dv = m_v[i] - v;
+      if (du * du + dv * dv <= radius2) {
+        trainIndexes.push_back(m_trainIndexes[i]);
+      }
+    }
+  }
+}
+
+/*!
+  Set the predicted locations of the train keypoints. The locations farther
+  than getSearchRadius() from the image are ignored.
+
+  \param width : Width of the image.
+  \param height : Height of the image.
+  \param u : Predicted column coordinates.
+  \param v : Predicted row coordinates.
+  \param trainIndexes : Indexes of the corresponding train keypoints.
+
+  \exception vpException::dimensionError : The vectors do not have the same
+  size.
+*/
+void vpKeyPointPrediction::setPredictions(unsigned int width, unsigned int height, const std::vector<double> &u,
+                                          const std::vector<double> &v, const std::vector<unsigned int> &trainIndexes)
+{
+  if (u.size() != v.size() || u.size() != trainIndexes.size()) {
+    throw vpException(vpException::dimensionError, "Bad number of predictions: %u, %u and %u", (unsigned int)u.size(),
+                      (unsigned int)v.size(), (unsigned int)trainIndexes.size());
+  }
+
+  clear();
+  m_width = width;
+  m_height = height;
+  for (size_t i = 0; i < u.size(); i++) {
+    if (u[i] >= -m_searchRadius && u[i] < width + m_searchRadius && v[i] >= -m_searchRadius &&
+        v[i] < height + m_searchRadius) {
+      m_u.push_back(u[i]);
+      m_v.push_back(v[i]);
+      m_trainIndexes.push_back(trainIndexes[i]);
+    }
+  }
+  if (m_trainIndexes.empty()) {
+    return;
+  }
+
+  // Cells of the size of the search radius, the locations outside the image
+  // being stored in the border cells. The cells of a row are contiguous so
+  // that a row of cells is scanned as a single range of m_gridIndexes.
+  m_gridCellSize = std::max(m_searchRadius, 1.);
+  m_gridCols = (unsigned int)(width / m_gridCellSize) + 1;
+  m_gridRows = (unsigned int)(height / m_gridCellSize) + 1;
+  m_gridOffsets.assign((size_t)m_gridCols * m_gridRows + 1, 0);
+  std::vector<unsigned int> cells(m_trainIndexes.size());
+  for (size_t i = 0; i < m_trainIndexes.size(); i++) {
+    cells[i] = (unsigned int)clampCell(m_v[i], m_gridCellSize, m_gridRows) * m_gridCols +
+               (unsigned int)clampCell(m_u[i], m_gridCellSize, m_gridCols);
+    m_gridOffsets[cells[i] + 1]++;
+  }
+  for (size_t c = 1; c < m_gridOffsets.size(); c++) {
+    m_gridOffsets[c] += m_gridOffsets[c - 1];
+  }
+  m_gridIndexes.resize(m_trainIndexes.size());
+  std::vector<unsigned int> fill(m_gridOffsets.begin(), m_gridOffsets.end() - 1);
+  for (size_t i = 0; i < m_trainIndexes.size(); i++) {
+    m_gridIndexes[fill[cells[i]]++] = (unsigned int)i;
+  }
+}
+
+/*!
+  Set the size in pixels of the cells used to build the regions of interest.
+  Smaller cells give tighter regions but more regions. By default 32 pixels.
+
+  \exception vpException::badValue : The size is null.
+*/
+void vpKeyPointPrediction::setRoiCellSize(unsigned int cellSize)
+{
+  if (cellSize == 0) {
+    throw vpException(vpException::badValue, "Bad size of the cells of the regions of interest: %u", cellSize);
+  }
+  m_roiCellSize = cellSize;
+}
+
+/*!
+  Set the search radius in pixels around the predicted locations. It has to
+  be greater than the expected prediction error. By default 20 pixels.
+
+  The new radius is used by the next call to setPredictions().
+
+  \exception vpException::badValue : The radius is not positive.
+*/
+void vpKeyPointPrediction::setSearchRadius(double radius)
+{
+  if (radius <= 0.) {
+    throw vpException(vpException::badValue, "Bad search radius: %f", radius);
+  }
+  m_searchRadius = radius;
+}
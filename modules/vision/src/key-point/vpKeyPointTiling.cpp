@@ -0,0 +1,226 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tiling of an image for keypoint detection.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <visp3/core/vpException.h>
+#include <visp3/vision/vpKeyPointTiling.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Decreasing response, ties broken by the lowest index
+class vpResponseOrder
+{
+public:
+  explicit vpResponseOrder(const std::vector<vpKeyPointTiling::vpTileKeyPoint> &keyPoints) : m_keyPoints(keyPoints) {}
+
+  bool operator()(unsigned int a, unsigned int b) const
+  {
+    return m_keyPoints[a].response > m_keyPoints[b].response ||
+           (m_keyPoints[a].response == m_keyPoints[b].response && a < b);
+  }
+
+private:
+  const std::vector<vpKeyPointTiling::vpTileKeyPoint> &m_keyPoints;
+};
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Constructor.
+
+  \param nbTilesX : Number of columns of tiles.
+  \param nbTilesY : Number of rows of tiles.
+  \param overlap : Number of pixels added on each side of the core region
+  of a tile.
+*/
+vpKeyPointTiling::vpKeyPointTiling(unsigned int nbTilesX, unsigned int nbTilesY, unsigned int overlap)
+  : m_nbTilesX(1), m_nbTilesY(1), m_overlap(overlap), m_maxKeyPointsPerTile(0), m_nmsRadius(2.), m_nbThreads(0)
+{
+  setNbTiles(nbTilesX, nbTilesY);
+}
+
+/*!
+  Compute the tiles of an image. The core regions of the tiles are a
+  partition of the image. When the image is smaller than the number of
+  tiles, the number of tiles is reduced.
+
+  \param width : Width of the image.
+  \param height : Height of the image.
+  \param tiles : Tiles, row by row.
+*/
+void vpKeyPointTiling::computeTiles(unsigned int width, unsigned int height, std::vector<vpTile> &tiles) const
+{
+  tiles.clear();
+  unsigned int nbTilesX = std::min<unsigned int>(m_nbTilesX, width);
+  unsigned int nbTilesY = std::min<unsigned int>(m_nbTilesY, height);
+  int overlap = (int)m_overlap;
+
+  for (unsigned int i = 0; i < nbTilesY; i++) {
+    for (unsigned int j = 0; j < nbTilesX; j++) {
+      vpTile tile;
+      tile.coreLeft = (int)(j * width / nbTilesX);
+      tile.coreRight = (int)((j + 1) * width / nbTilesX);
+      tile.coreTop = (int)(i * height / nbTilesY);
+      tile.coreBottom = (int)((i + 1) * height / nbTilesY);
+      tile.left = std::max(tile.coreLeft - overlap, 0);
+      tile.right = std::min(tile.coreRight + overlap, (int)width);
+      tile.top = std::max(tile.coreTop - overlap, 0);
+      tile.bottom = std::min(tile.coreBottom + overlap, (int)height);
+      tiles.push_back(tile);
+    }
+  }
+}
+
+/*!
+  Merge the keypoints of the tiles: the keypoints are visited by decreasing
+  response and a keypoint is removed when it is closer than getNmsRadius()
+  to a kept keypoint. The neighbors are searched in a regular grid, so that
+  the complexity is linear in the number of keypoints.
+
+  \param keyPoints : Keypoints of all the tiles, in image coordinates.
+  \param kept : Sorted indexes of the kept keypoints.
+*/
+void vpKeyPointTiling::nonMaximumSuppression(const std::vector<vpTileKeyPoint> &keyPoints,
+                                             std::vector<unsigned int> &kept) const
+{
+  unsigned int nbKeyPoints = (unsigned int)keyPoints.size();
+  kept.clear();
+  if (m_nmsRadius <= 0. || nbKeyPoints < 2) {
+    kept.resize(nbKeyPoints);
+    for (unsigned int i = 0; i < nbKeyPoints; i++) {
+      kept[i] = i;
+    }
+    return;
+  }
+
+  float minU = keyPoints[0].u, maxU = keyPoints[0].u, minV = keyPoints[0].v, maxV = keyPoints[0].v;
+  for (unsigned int i = 1; i < nbKeyPoints; i++) {
+    minU = std::min(minU, keyPoints[i].u);
+    maxU = std::max(maxU, keyPoints[i].u);
+    minV = std::min(minV, keyPoints[i].v);
+    maxV = std::max(maxV, keyPoints[i].v);
+  }
+
+  // Cells of about one keypoint, but not smaller than the radius so that
+  // only the 3x3 neighboring cells have to be visited
+  double cellSize = std::max(m_nmsRadius, std::sqrt((double)(maxU - minU + 1) * (maxV - minV + 1) / nbKeyPoints));
+  int nbCellsX = (int)((maxU - minU) / cellSize) + 1;
+  int nbCellsY = (int)((maxV - minV) / cellSize) + 1;
+  std::vector<int> cellHeads((size_t)nbCellsX * nbCellsY, -1), nextInCell(nbKeyPoints, -1);
+
+  std::vector<unsigned int> order(nbKeyPoints);
+  for (unsigned int i = 0; i < nbKeyPoints; i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), vpResponseOrder(keyPoints));
+
+  double radius2 = m_nmsRadius * m_nmsRadius;
+  for (unsigned int k = 0; k < nbKeyPoints; k++) {
+    unsigned int idx = order[k];
+    const vpTileKeyPoint &kpt = keyPoints[idx];
+    int cx = (int)((kpt.u - minU) / cellSize), cy = (int)((kpt.v - minV) / cellSize);
+
+    bool suppressed = false;
+    for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, nbCellsY - 1) && !suppressed; y++) {
+      for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, nbCellsX - 1) && !suppressed; x++) {
+        for (int n = cellHeads[(size_t)y * nbCellsX + x]; n != -1; n = nextInCell[(size_t)n]) {
+          double du = keyPoints[(size_t)n].u - kpt.u, dv = keyPoints[(size_t)n].v - kpt.v;
+          if (du * du + dv * dv < radius2) {
+            suppressed = true;
+            break;
+          }
+        }
+      }
+    }
+
+    if (!suppressed) {
+      size_t cell = (size_t)cy * nbCellsX + cx;
+      nextInCell[idx] = cellHeads[cell];
+      cellHeads[cell] = (int)idx;
+      kept.push_back(idx);
+    }
+  }
+
+  std::sort(kept.begin(), kept.end());
+}
+
+/*!
+  Select the keypoints detected in a tile: only the keypoints of the core
+  region are kept, and at most getMaxKeyPointsPerTile() keypoints with the
+  highest response.
+
+  \param tile : Tile in which the keypoints have been detected.
+  \param keyPoints : Keypoints detected in the tile, in image coordinates.
+  \param selected : Indexes of the selected keypoints, by decreasing
+  response when the number of keypoints is limited, in increasing order
+  otherwise.
+*/
+void vpKeyPointTiling::selectKeyPoints(const vpTile &tile, const std::vector<vpTileKeyPoint> &keyPoints,
+                                       std::vector<unsigned int> &selected) const
+{
+  selected.clear();
+  for (unsigned int i = 0; i < (unsigned int)keyPoints.size(); i++) {
+    const vpTileKeyPoint &kpt = keyPoints[i];
+    if (kpt.u >= tile.coreLeft && kpt.u < tile.coreRight && kpt.v >= tile.coreTop && kpt.v < tile.coreBottom) {
+      selected.push_back(i);
+    }
+  }
+
+  if (m_maxKeyPointsPerTile > 0 && selected.size() > m_maxKeyPointsPerTile) {
+    std::partial_sort(selected.begin(), selected.begin() + m_maxKeyPointsPerTile, selected.end(),
+                      vpResponseOrder(keyPoints));
+    selected.resize(m_maxKeyPointsPerTile);
+  }
+}
+
+/*!
+  Set the number of tiles.
+
+  \param nbTilesX : Number of columns of tiles.
+  \param nbTilesY : Number of rows of tiles.
+
+  \exception vpException::badValue : A number of tiles is null.
+*/
+void vpKeyPointTiling::setNbTiles(unsigned int nbTilesX, unsigned int nbTilesY)
+{
+  if (nbTilesX == 0 || nbTilesY == 0) {
+    throw vpException(vpException::badValue, "Bad number of tiles: %ux%u", nbTilesX, nbTilesY);
+  }
+  m_nbTilesX = nbTilesX;
+  m_nbTilesY = nbTilesY;
+}
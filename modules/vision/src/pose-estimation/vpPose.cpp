@@ -84,6 +84,10 @@ void vpPose::init()
   useParallelRansac = false;
   nbParallelRansacThreads = 0;
   vvsEpsilon = 1e-8;
+  useAdaptiveRansac = false;
+  ransacProbability = 0.99;
+  ransacScores.clear();
+  useP3PRansac = false;
 
 #if (DEBUG_LEVEL1)
   std::cout << "end vpPose::Init() " << std::endl;
@@ -97,7 +101,8 @@ vpPose::vpPose()
     distanceToPlaneForCoplanarityTest(0.001), ransacFlag(vpPose::NO_FILTER), listOfPoints(),
     useParallelRansac(false),
     nbParallelRansacThreads(0), // 0 means that we use C++11 (if available) to get the number of threads
-    vvsEpsilon(1e-8)
+    vvsEpsilon(1e-8), useAdaptiveRansac(false), ransacProbability(0.99), ransacScores(),
+    useP3PRansac(false), vvsPoints(), vvsResiduals(), vvsWeights(), vvsRobust()
 {
 }
 
@@ -123,6 +128,7 @@ void vpPose::clearPoint()
 {
   listP.clear();
   listOfPoints.clear();
+  ransacScores.clear();
   npt = 0;
 }
 
@@ -357,6 +363,11 @@ double vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
   - vpPose::LAGRANGE_VIRTUAL_VS: Non linear virtual visual servoing approach
   initialized by Lagrange approach
   - vpPose::RANSAC: Robust Ransac aproach (does't need an initialization)
+  - vpPose::P3P: Closed-form perspective-3-point solver applied on the three
+  first points, the other points being used to select the solution
+  - vpPose::EPNP: Linear O(n) EPnP approach
+  - vpPose::EPNP_VIRTUAL_VS: Non linear virtual visual servoing approach
+  initialized by EPnP approach
 
 */
 bool vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneousMatrix &))
@@ -456,6 +467,13 @@ bool vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix &cMo, bool
       throw;
     }
     break;
+  case P3P:
+    poseP3P(cMo);
+    break;
+  case EPNP:
+  case EPNP_VIRTUAL_VS:
+    poseEPnP(cMo);
+    break;
   case LOWE:
   case VIRTUAL_VS:
     break;
@@ -465,10 +483,13 @@ bool vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix &cMo, bool
   case LAGRANGE:
   case DEMENTHON:
   case RANSAC:
+  case P3P:
+  case EPNP:
     break;
   case VIRTUAL_VS:
   case LAGRANGE_VIRTUAL_VS:
-  case DEMENTHON_VIRTUAL_VS: {
+  case DEMENTHON_VIRTUAL_VS:
+  case EPNP_VIRTUAL_VS: {
     try {
       poseVirtualVS(cMo);
     } catch (...) {
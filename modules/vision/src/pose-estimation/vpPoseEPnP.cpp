@@ -0,0 +1,406 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation with the EPnP approach.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseEPnP.cpp
+  \brief Pose computation with the EPnP approach.
+*/
+
+#include <algorithm> // std::swap
+#include <cmath>
+#include <float.h> // DBL_MAX
+#include <vector>
+
+#include <visp3/core/vpColVector.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+/*
+  Least-squares solution x of A x = b, with A a rows x cols matrix stored by
+  rows (cols <= 6), obtained from the normal equations with a Gaussian
+  elimination. Return false if A^T A is singular.
+*/
+bool solveLeastSquares(const double *A, unsigned int rows, unsigned int cols, const double *b, double *x)
+{
+  double N[6][7];
+  for (unsigned int r = 0; r < cols; r++) {
+    for (unsigned int c = 0; c <= cols; c++) {
+      double v = 0;
+      for (unsigned int k = 0; k < rows; k++) {
+        v += A[k * cols + r] * (c < cols ? A[k * cols + c] : b[k]);
+      }
+      N[r][c] = v;
+    }
+  }
+
+  for (unsigned int c = 0; c < cols; c++) {
+    unsigned int pivot = c;
+    for (unsigned int r = c + 1; r < cols; r++) {
+      if (std::fabs(N[r][c]) > std::fabs(N[pivot][c])) {
+        pivot = r;
+      }
+    }
+    if (std::fabs(N[pivot][c]) < 1e-300) {
+      return false;
+    }
+    for (unsigned int k = c; k <= cols; k++) {
+      std::swap(N[c][k], N[pivot][k]);
+    }
+    for (unsigned int r = c + 1; r < cols; r++) {
+      double f = N[r][c] / N[c][c];
+      for (unsigned int k = c; k <= cols; k++) {
+        N[r][k] -= f * N[c][k];
+      }
+    }
+  }
+  for (int r = (int)cols - 1; r >= 0; r--) {
+    double v = N[r][cols];
+    for (unsigned int k = (unsigned int)r + 1; k < cols; k++) {
+      v -= N[r][k] * x[k];
+    }
+    x[r] = v / N[r][r];
+  }
+  return true;
+}
+
+/*
+  Rigid transformation cMo that best aligns the n object points oP on the n
+  camera points cP (points stored as x, y, z triplets), see K.S. Arun et al.,
+  Least-squares fitting of two 3-D point sets, PAMI 1987.
+*/
+void computeRigidTransformation(const std::vector<double> &oP, const std::vector<double> &cP, unsigned int n,
+                                vpHomogeneousMatrix &cMo)
+{
+  double oc[3] = {0, 0, 0}, cc[3] = {0, 0, 0};
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int k = 0; k < 3; k++) {
+      oc[k] += oP[3 * i + k];
+      cc[k] += cP[3 * i + k];
+    }
+  }
+  for (unsigned int k = 0; k < 3; k++) {
+    oc[k] /= n;
+    cc[k] /= n;
+  }
+
+  // H = sum (cP - cc) (oP - oc)^T
+  vpMatrix H(3, 3, 0.);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        H[r][c] += (cP[3 * i + r] - cc[r]) * (oP[3 * i + c] - oc[c]);
+      }
+    }
+  }
+
+  // H = U S V^T, cRo = U diag(1, 1, det(U V^T)) V^T
+  vpColVector w;
+  vpMatrix V;
+  H.svd(w, V);
+  vpMatrix R = H * V.t();
+  double det = R[0][0] * (R[1][1] * R[2][2] - R[1][2] * R[2][1]) - R[0][1] * (R[1][0] * R[2][2] - R[1][2] * R[2][0]) +
+               R[0][2] * (R[1][0] * R[2][1] - R[1][1] * R[2][0]);
+  if (det < 0) {
+    for (unsigned int r = 0; r < 3; r++) {
+      H[r][2] = -H[r][2];
+    }
+    R = H * V.t();
+  }
+
+  for (unsigned int r = 0; r < 3; r++) {
+    for (unsigned int c = 0; c < 3; c++) {
+      cMo[r][c] = R[r][c];
+    }
+    cMo[r][3] = cc[r] - (R[r][0] * oc[0] + R[r][1] * oc[1] + R[r][2] * oc[2]);
+  }
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Compute the pose using the EPnP approach (see V. Lepetit, F. Moreno-Noguer
+  and P. Fua, EPnP: An Accurate O(n) Solution to the PnP Problem, IJCV 2009).
+
+  Each point is expressed as a weighted sum of four control points (three
+  when the points are coplanar) placed at the centroid and along the
+  principal axes of the point cloud. The coordinates of the control points
+  in the camera frame are a combination of the null vectors of a 12x12
+  matrix (9x9 in the planar case) accumulated in a single pass over the
+  points. The coefficients of the combination are estimated from the
+  distances between the control points, refined with a Gauss-Newton scheme,
+  and the solution with the smallest residual is kept.
+
+  The complexity is linear in the number of points, which makes this method
+  well suited to initialize a non linear refinement on large point sets
+  (see vpPose::EPNP_VIRTUAL_VS).
+
+  \param cMo : Computed pose.
+
+  \exception vpPoseException::notEnoughPointError : Less than four points or
+  collinear points.
+  \exception vpPoseException::poseError : No solution was found.
+*/
+void vpPose::poseEPnP(vpHomogeneousMatrix &cMo)
+{
+  if (npt < 4) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError, "Not enough point (%d) to compute the pose with EPnP",
+                          npt));
+  }
+
+  const unsigned int n = npt;
+  std::vector<double> oP(3 * n), xy(2 * n);
+  unsigned int i = 0;
+  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it, i++) {
+    oP[3 * i] = it->get_oX();
+    oP[3 * i + 1] = it->get_oY();
+    oP[3 * i + 2] = it->get_oZ();
+    xy[2 * i] = it->get_x();
+    xy[2 * i + 1] = it->get_y();
+  }
+
+  // Control points: centroid and principal axes of the points
+  double c0[3] = {0, 0, 0};
+  for (i = 0; i < n; i++) {
+    for (unsigned int k = 0; k < 3; k++) {
+      c0[k] += oP[3 * i + k];
+    }
+  }
+  for (unsigned int k = 0; k < 3; k++) {
+    c0[k] /= n;
+  }
+  vpMatrix C(3, 3, 0.);
+  for (i = 0; i < n; i++) {
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        C[r][c] += (oP[3 * i + r] - c0[r]) * (oP[3 * i + c] - c0[c]);
+      }
+    }
+  }
+  C /= n;
+  vpColVector lambdas;
+  vpMatrix axes;
+  C.svd(lambdas, axes); // decreasing order
+
+  if (lambdas[1] <= 1e-12 * lambdas[0]) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError, "Points are collinear"));
+  }
+  // Planar case: only three control points
+  const unsigned int nc = lambdas[2] <= 1e-8 * lambdas[0] ? 3 : 4;
+
+  double cw[4][3];
+  for (unsigned int k = 0; k < 3; k++) {
+    cw[0][k] = c0[k];
+  }
+  for (unsigned int j = 1; j < nc; j++) {
+    double s = sqrt(lambdas[j - 1]);
+    for (unsigned int k = 0; k < 3; k++) {
+      cw[j][k] = c0[k] + s * axes[k][j - 1];
+    }
+  }
+
+  // Barycentric coordinates of the points and M^T M accumulation
+  const unsigned int dim = 3 * nc;
+  std::vector<double> alphas(nc * n);
+  vpMatrix MtM(dim, dim, 0.);
+  double r1[12], r2[12];
+  for (i = 0; i < n; i++) {
+    double *alpha = &alphas[nc * i];
+    alpha[0] = 1.;
+    for (unsigned int j = 1; j < nc; j++) {
+      double d = 0;
+      for (unsigned int k = 0; k < 3; k++) {
+        d += (oP[3 * i + k] - c0[k]) * axes[k][j - 1];
+      }
+      alpha[j] = d / sqrt(lambdas[j - 1]);
+      alpha[0] -= alpha[j];
+    }
+
+    for (unsigned int j = 0; j < nc; j++) {
+      r1[3 * j] = alpha[j];
+      r1[3 * j + 1] = 0;
+      r1[3 * j + 2] = -alpha[j] * xy[2 * i];
+      r2[3 * j] = 0;
+      r2[3 * j + 1] = alpha[j];
+      r2[3 * j + 2] = -alpha[j] * xy[2 * i + 1];
+    }
+    for (unsigned int r = 0; r < dim; r++) {
+      double *MtM_r = MtM[r];
+      for (unsigned int c = r; c < dim; c++) {
+        MtM_r[c] += r1[r] * r1[c] + r2[r] * r2[c];
+      }
+    }
+  }
+  for (unsigned int r = 0; r < dim; r++) {
+    for (unsigned int c = 0; c < r; c++) {
+      MtM[r][c] = MtM[c][r];
+    }
+  }
+
+  // Null vectors: right singular vectors of the smallest singular values
+  vpColVector sv;
+  vpMatrix Vn;
+  MtM.svd(sv, Vn);
+
+  // Pairs of control points and their squared distances
+  const unsigned int nb_pairs = nc * (nc - 1) / 2;
+  unsigned int pairs[6][2];
+  double dc[6];
+  unsigned int p = 0;
+  for (unsigned int a = 0; a < nc; a++) {
+    for (unsigned int b = a + 1; b < nc; b++, p++) {
+      pairs[p][0] = a;
+      pairs[p][1] = b;
+      dc[p] = vpMath::sqr(cw[a][0] - cw[b][0]) + vpMath::sqr(cw[a][1] - cw[b][1]) + vpMath::sqr(cw[a][2] - cw[b][2]);
+    }
+  }
+
+  const unsigned int max_nb_vectors = nc == 4 ? 3 : 2;
+  double best_residual = DBL_MAX;
+  std::vector<double> cP(3 * n);
+  for (unsigned int N = 1; N <= max_nb_vectors; N++) {
+    // dv[k][p]: difference of the control points of pair p in null vector k
+    double dv[3][6][3];
+    for (unsigned int k = 0; k < N; k++) {
+      unsigned int col = dim - 1 - k;
+      for (p = 0; p < nb_pairs; p++) {
+        for (unsigned int l = 0; l < 3; l++) {
+          dv[k][p][l] = Vn[3 * pairs[p][0] + l][col] - Vn[3 * pairs[p][1] + l][col];
+        }
+      }
+    }
+
+    // Linearized estimation of the betas from the products beta_k beta_l
+    unsigned int nb_products = N * (N + 1) / 2;
+    double L[6 * 6];
+    for (p = 0; p < nb_pairs; p++) {
+      unsigned int col = 0;
+      for (unsigned int k = 0; k < N; k++) {
+        for (unsigned int l = k; l < N; l++, col++) {
+          double d = dv[k][p][0] * dv[l][p][0] + dv[k][p][1] * dv[l][p][1] + dv[k][p][2] * dv[l][p][2];
+          L[p * nb_products + col] = k == l ? d : 2. * d;
+        }
+      }
+    }
+    double B[6];
+    if (!solveLeastSquares(L, nb_pairs, nb_products, dc, B)) {
+      continue;
+    }
+
+    double beta[3] = {0, 0, 0};
+    beta[0] = sqrt(std::fabs(B[0]));
+    if (beta[0] > DBL_EPSILON) {
+      for (unsigned int k = 1; k < N; k++) {
+        beta[k] = B[k] / beta[0];
+      }
+    }
+
+    // Gauss-Newton refinement of the betas on the distance constraints
+    for (unsigned int iter = 0; iter < 5; iter++) {
+      double Jb[6 * 3], err[6], delta[3];
+      for (p = 0; p < nb_pairs; p++) {
+        double D[3] = {0, 0, 0};
+        for (unsigned int k = 0; k < N; k++) {
+          for (unsigned int l = 0; l < 3; l++) {
+            D[l] += beta[k] * dv[k][p][l];
+          }
+        }
+        err[p] = D[0] * D[0] + D[1] * D[1] + D[2] * D[2] - dc[p];
+        for (unsigned int k = 0; k < N; k++) {
+          Jb[p * N + k] = 2. * (D[0] * dv[k][p][0] + D[1] * dv[k][p][1] + D[2] * dv[k][p][2]);
+        }
+      }
+      if (!solveLeastSquares(Jb, nb_pairs, N, err, delta)) {
+        break;
+      }
+      for (unsigned int k = 0; k < N; k++) {
+        beta[k] -= delta[k];
+      }
+    }
+
+    // Control points and points in the camera frame
+    double cc[4][3];
+    for (unsigned int j = 0; j < nc; j++) {
+      for (unsigned int l = 0; l < 3; l++) {
+        cc[j][l] = 0;
+        for (unsigned int k = 0; k < N; k++) {
+          cc[j][l] += beta[k] * Vn[3 * j + l][dim - 1 - k];
+        }
+      }
+    }
+    double mean_z = 0;
+    for (i = 0; i < n; i++) {
+      for (unsigned int l = 0; l < 3; l++) {
+        double v = 0;
+        for (unsigned int j = 0; j < nc; j++) {
+          v += alphas[nc * i + j] * cc[j][l];
+        }
+        cP[3 * i + l] = v;
+      }
+      mean_z += cP[3 * i + 2];
+    }
+    if (mean_z < 0) {
+      for (i = 0; i < 3 * n; i++) {
+        cP[i] = -cP[i];
+      }
+    }
+
+    vpHomogeneousMatrix cMo_tmp;
+    computeRigidTransformation(oP, cP, n, cMo_tmp);
+
+    // Residual, see computeResidual()
+    double r = 0;
+    const double *M = cMo_tmp.data;
+    for (i = 0; i < n; i++) {
+      const double *P = &oP[3 * i];
+      double X = M[0] * P[0] + M[1] * P[1] + M[2] * P[2] + M[3];
+      double Y = M[4] * P[0] + M[5] * P[1] + M[6] * P[2] + M[7];
+      double Z = M[8] * P[0] + M[9] * P[1] + M[10] * P[2] + M[11];
+      r += vpMath::sqr(X / Z - xy[2 * i]) + vpMath::sqr(Y / Z - xy[2 * i + 1]);
+    }
+    if (!vpMath::isNaN(r) && r < best_residual) {
+      best_residual = r;
+      cMo = cMo_tmp;
+    }
+  }
+
+  if (best_residual == DBL_MAX) {
+    throw(vpPoseException(vpPoseException::poseError, "No solution found with EPnP"));
+  }
+}
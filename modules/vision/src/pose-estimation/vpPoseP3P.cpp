@@ -0,0 +1,537 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation from three points (P3P).
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseP3P.cpp
+  \brief Closed-form pose computation from three points.
+*/
+
+#include <algorithm> // std::sort
+#include <cmath>
+#include <float.h> // DBL_MAX
+
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Value of the polynomial c[0] x^deg + c[1] x^(deg-1) + ... + c[deg]
+double evalPolynomial(const double *c, unsigned int deg, double x)
+{
+  double p = c[0];
+  for (unsigned int k = 1; k <= deg; k++) {
+    p = p * x + c[k];
+  }
+  return p;
+}
+
+/*
+  Real roots of the polynomial c[0] x^deg + c[1] x^(deg-1) + ... + c[deg]
+  with deg <= 4. The real roots of the derivative split the real axis in
+  intervals where the polynomial is monotonic; the roots are isolated in
+  these intervals and refined with a safeguarded Newton scheme. A root of the
+  derivative where the polynomial nearly vanishes is returned as a multiple
+  root. Leading coefficients close to zero are dropped.
+*/
+unsigned int solvePolynomial(const double *c, unsigned int deg, double *roots)
+{
+  double max_coef = 0;
+  for (unsigned int i = 0; i <= deg; i++) {
+    max_coef = (std::max)(max_coef, std::fabs(c[i]));
+  }
+  while (deg > 0 && std::fabs(c[0]) <= 1e-14 * max_coef) {
+    c++;
+    deg--;
+  }
+  if (deg == 0) {
+    return 0;
+  }
+  if (deg == 1) {
+    roots[0] = -c[1] / c[0];
+    return 1;
+  }
+
+  double dc[4];
+  for (unsigned int i = 0; i < deg; i++) {
+    dc[i] = c[i] * (deg - i);
+  }
+  double crit[3];
+  unsigned int nb_crit = solvePolynomial(dc, deg - 1, crit);
+
+  // Cauchy bound on the roots
+  double bound = 0;
+  for (unsigned int i = 1; i <= deg; i++) {
+    bound = (std::max)(bound, std::fabs(c[i] / c[0]));
+  }
+  bound += 1.;
+
+  // Sorted bounds of the monotonic intervals
+  double pts[5];
+  unsigned int nb_pts = 0;
+  pts[nb_pts++] = -bound;
+  std::sort(crit, crit + nb_crit);
+  for (unsigned int i = 0; i < nb_crit; i++) {
+    if (crit[i] > pts[nb_pts - 1] && crit[i] < bound) {
+      pts[nb_pts++] = crit[i];
+    }
+  }
+  pts[nb_pts++] = bound;
+
+  unsigned int nb_roots = 0;
+  for (unsigned int i = 1; i + 1 < nb_pts; i++) {
+    // Multiple root
+    double x = pts[i], scale = 0, xn = 1.;
+    for (unsigned int k = 0; k <= deg; k++, xn *= std::fabs(x)) {
+      scale += std::fabs(c[deg - k]) * xn;
+    }
+    if (std::fabs(evalPolynomial(c, deg, x)) <= 1e-10 * scale) {
+      roots[nb_roots++] = x;
+    }
+  }
+  for (unsigned int i = 0; i + 1 < nb_pts; i++) {
+    double a = pts[i], b = pts[i + 1];
+    double fa = evalPolynomial(c, deg, a), fb = evalPolynomial(c, deg, b);
+    if ((fa < 0) == (fb < 0)) {
+      continue;
+    }
+    double x = 0.5 * (a + b);
+    for (unsigned int iter = 0; iter < 100; iter++) {
+      double f = evalPolynomial(c, deg, x);
+      if (f == 0.) {
+        break;
+      }
+      if ((f < 0) == (fa < 0)) {
+        a = x;
+      } else {
+        b = x;
+      }
+      double df = evalPolynomial(dc, deg - 1, x);
+      double x_new = df != 0. ? x - f / df : a;
+      if (x_new <= a || x_new >= b) {
+        x_new = 0.5 * (a + b);
+      }
+      if (std::fabs(x_new - x) <= 1e-15 * (1. + std::fabs(x))) {
+        x = x_new;
+        break;
+      }
+      x = x_new;
+    }
+    // Skip the roots already found as a multiple root
+    bool duplicate = false;
+    for (unsigned int k = 0; k < nb_roots; k++) {
+      if (std::fabs(roots[k] - x) <= 1e-10 * (1. + std::fabs(x))) {
+        duplicate = true;
+      }
+    }
+    if (!duplicate) {
+      roots[nb_roots++] = x;
+    }
+  }
+
+  return nb_roots;
+}
+
+// Determinant of a 3x3 matrix
+double det3(const double M[3][3])
+{
+  return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1]) - M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0]) +
+         M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+}
+
+// tr(adj(A) B), such that det(A + x B) = det(A) + x tr(adj(A) B) + x^2 tr(adj(B) A) + x^3 det(B)
+double traceAdjugateProduct(const double A[3][3], const double B[3][3])
+{
+  double t = 0;
+  for (unsigned int i = 0; i < 3; i++) {
+    unsigned int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+    for (unsigned int j = 0; j < 3; j++) {
+      unsigned int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+      // Cofactor (i, j) of A times B[i][j]
+      t += (A[i1][j1] * A[i2][j2] - A[i1][j2] * A[i2][j1]) * B[i][j];
+    }
+  }
+  return t;
+}
+
+// Unit vector spanning the null space of the rank 2 symmetric matrix M
+bool nullVector(const double M[3][3], double e[3])
+{
+  double best = 0;
+  for (unsigned int i = 0; i < 3; i++) {
+    const double *r1 = M[i], *r2 = M[(i + 1) % 3];
+    double c[3] = {r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0]};
+    double n = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+    if (n > best) {
+      best = n;
+      for (unsigned int k = 0; k < 3; k++) {
+        e[k] = c[k];
+      }
+    }
+  }
+  if (best <= 0) {
+    return false;
+  }
+  best = sqrt(best);
+  for (unsigned int k = 0; k < 3; k++) {
+    e[k] /= best;
+  }
+  return true;
+}
+
+/*
+  Orthonormal frame attached to the triangle (P1, P2, P3), stored by columns
+  in F.
+*/
+bool triangleFrame(const double P[3][3], double F[3][3])
+{
+  double e1[3], e2[3], e3[3], u[3];
+  for (unsigned int k = 0; k < 3; k++) {
+    e1[k] = P[1][k] - P[0][k];
+    u[k] = P[2][k] - P[0][k];
+  }
+  e3[0] = e1[1] * u[2] - e1[2] * u[1];
+  e3[1] = e1[2] * u[0] - e1[0] * u[2];
+  e3[2] = e1[0] * u[1] - e1[1] * u[0];
+
+  double n1 = sqrt(e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
+  double n3 = sqrt(e3[0] * e3[0] + e3[1] * e3[1] + e3[2] * e3[2]);
+  double nu = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  if (n3 <= 1e-10 * n1 * nu) {
+    return false;
+  }
+  for (unsigned int k = 0; k < 3; k++) {
+    e1[k] /= n1;
+    e3[k] /= n3;
+  }
+  e2[0] = e3[1] * e1[2] - e3[2] * e1[1];
+  e2[1] = e3[2] * e1[0] - e3[0] * e1[2];
+  e2[2] = e3[0] * e1[1] - e3[1] * e1[0];
+
+  for (unsigned int k = 0; k < 3; k++) {
+    F[k][0] = e1[k];
+    F[k][1] = e2[k];
+    F[k][2] = e3[k];
+  }
+  return true;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Compute the pose from the three first points using a closed-form
+  perspective-3-point solver, the other points being used to select the
+  solution.
+
+  The distances between the camera center and the three points are computed
+  with the Lambda Twist approach (see M. Persson and K. Nordberg, Lambda
+  Twist: An Accurate Fast Robust Perspective Three Point (P3P) Solver, ECCV
+  2018) that only requires the root of a cubic polynomial and remains
+  accurate when the points are at similar distances from the camera. The
+  distances are refined with a few Newton iterations. Up to four poses are
+  consistent with the three points. The one that minimizes the residual
+  computed over all the points (see computeResidual()) is returned. With only
+  three points, the returned pose is one of the solutions.
+
+  Since this solver only requires three points and no large matrix
+  decomposition, it is well suited to generate the hypotheses of a RANSAC
+  scheme (see setUseP3PRansac()).
+
+  \param cMo : Computed pose.
+
+  \exception vpPoseException::notEnoughPointError : Less than three points or
+  collinear points.
+  \exception vpPoseException::poseError : No solution was found.
+*/
+void vpPose::poseP3P(vpHomogeneousMatrix &cMo)
+{
+  if (npt < 3) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError, "Not enough point (%d) to compute the pose with P3P",
+                          npt));
+  }
+
+  // Object points and unit bearing vectors of the three first points
+  double oP[3][3], J[3][3];
+  std::list<vpPoint>::const_iterator it = listP.begin();
+  for (unsigned int i = 0; i < 3; i++, ++it) {
+    oP[i][0] = it->get_oX();
+    oP[i][1] = it->get_oY();
+    oP[i][2] = it->get_oZ();
+    double norm = sqrt(it->get_x() * it->get_x() + it->get_y() * it->get_y() + 1.);
+    J[i][0] = it->get_x() / norm;
+    J[i][1] = it->get_y() / norm;
+    J[i][2] = 1. / norm;
+  }
+
+  double oF[3][3];
+  if (!triangleFrame(oP, oF)) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError, "Points are collinear"));
+  }
+
+  // The distances l = (l0, l1, l2) to the points satisfy, for the pairs
+  // (i, j) = (0, 1), (0, 2) and (1, 2),
+  // li^2 + lj^2 + bij li lj = l^T Mij l = aij
+  // with aij the squared distance between the points and bij = -2 cos(yi, yj)
+  const unsigned int pairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+  double a[3], b[3], M[3][3][3];
+  for (unsigned int p = 0; p < 3; p++) {
+    unsigned int i = pairs[p][0], j = pairs[p][1];
+    a[p] = vpMath::sqr(oP[i][0] - oP[j][0]) + vpMath::sqr(oP[i][1] - oP[j][1]) + vpMath::sqr(oP[i][2] - oP[j][2]);
+    b[p] = -2. * (J[i][0] * J[j][0] + J[i][1] * J[j][1] + J[i][2] * J[j][2]);
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        M[p][r][c] = 0;
+      }
+    }
+    M[p][i][i] = M[p][j][j] = 1.;
+    M[p][i][j] = M[p][j][i] = 0.5 * b[p];
+  }
+
+  // Homogeneous constraints l^T D1 l = 0 and l^T D2 l = 0
+  double D1[3][3], D2[3][3];
+  for (unsigned int r = 0; r < 3; r++) {
+    for (unsigned int c = 0; c < 3; c++) {
+      D1[r][c] = M[0][r][c] * a[2] - M[2][r][c] * a[0];
+      D2[r][c] = M[1][r][c] * a[2] - M[2][r][c] * a[1];
+    }
+  }
+
+  // gamma such that D0 = D1 + gamma D2 is singular
+  double cubic[4] = {det3(D2), traceAdjugateProduct(D2, D1), traceAdjugateProduct(D1, D2), det3(D1)};
+  double gammas[3];
+  unsigned int nb_gammas = solvePolynomial(cubic, 3, gammas);
+
+  // Candidate distances
+  double lambdas[4][3];
+  unsigned int nb_candidates = 0;
+  for (unsigned int g = 0; g < nb_gammas && nb_candidates == 0; g++) {
+    double D0[3][3];
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        D0[r][c] = D1[r][c] + gammas[g] * D2[r][c];
+      }
+    }
+
+    // D0 = sigma0 e0 e0^T + sigma1 e1 e1^T is indefinite, such that
+    // l^T D0 l = 0 gives the two planes (e0 -/+ s e1)^T l = 0
+    double tr = D0[0][0] + D0[1][1] + D0[2][2];
+    double minors = D0[0][0] * D0[1][1] - D0[0][1] * D0[1][0] + D0[0][0] * D0[2][2] - D0[0][2] * D0[2][0] +
+                    D0[1][1] * D0[2][2] - D0[1][2] * D0[2][1];
+    if (minors >= 0) {
+      continue;
+    }
+    double disc = sqrt(tr * tr - 4. * minors);
+    double sigma[2];
+    sigma[0] = tr >= 0 ? 0.5 * (tr + disc) : 0.5 * (tr - disc); // largest magnitude
+    sigma[1] = minors / sigma[0];
+    double e[2][3];
+    bool valid = true;
+    for (unsigned int k = 0; k < 2 && valid; k++) {
+      double S[3][3];
+      for (unsigned int r = 0; r < 3; r++) {
+        for (unsigned int c = 0; c < 3; c++) {
+          S[r][c] = D0[r][c] - (r == c ? sigma[k] : 0.);
+        }
+      }
+      valid = nullVector(S, e[k]);
+    }
+    if (!valid) {
+      continue;
+    }
+    double s = sqrt(-sigma[1] / sigma[0]);
+
+    for (int sign = -1; sign <= 1; sign += 2) {
+      double n[3];
+      for (unsigned int k = 0; k < 3; k++) {
+        n[k] = e[0][k] + sign * s * e[1][k];
+      }
+      // Express the distance with the largest coefficient from the two
+      // others: l = tau u + v with u and v in the plane
+      unsigned int k0 = 0;
+      for (unsigned int k = 1; k < 3; k++) {
+        if (std::fabs(n[k]) > std::fabs(n[k0])) {
+          k0 = k;
+        }
+      }
+      unsigned int k1 = (k0 + 1) % 3, k2 = (k0 + 2) % 3;
+      double u[3], v[3];
+      u[k0] = -n[k1] / n[k0];
+      u[k1] = 1.;
+      u[k2] = 0.;
+      v[k0] = -n[k2] / n[k0];
+      v[k1] = 0.;
+      v[k2] = 1.;
+
+      // l^T D1 l = 0 gives a quadratic in tau
+      double Du[3], Dv[3];
+      for (unsigned int r = 0; r < 3; r++) {
+        Du[r] = D1[r][0] * u[0] + D1[r][1] * u[1] + D1[r][2] * u[2];
+        Dv[r] = D1[r][0] * v[0] + D1[r][1] * v[1] + D1[r][2] * v[2];
+      }
+      double quadratic[3] = {u[0] * Du[0] + u[1] * Du[1] + u[2] * Du[2],
+                             2. * (u[0] * Dv[0] + u[1] * Dv[1] + u[2] * Dv[2]),
+                             v[0] * Dv[0] + v[1] * Dv[1] + v[2] * Dv[2]};
+      double taus[2];
+      unsigned int nb_taus = solvePolynomial(quadratic, 2, taus);
+      for (unsigned int t = 0; t < nb_taus; t++) {
+        double l[3];
+        for (unsigned int k = 0; k < 3; k++) {
+          l[k] = taus[t] * u[k] + v[k];
+        }
+        // Scale given by l^T M12 l = a12
+        double q = l[1] * l[1] + l[2] * l[2] + b[2] * l[1] * l[2];
+        if (q <= 0) {
+          continue;
+        }
+        double scale = sqrt(a[2] / q);
+        if (l[0] < 0 && l[1] < 0 && l[2] < 0) {
+          scale = -scale;
+        }
+        for (unsigned int k = 0; k < 3; k++) {
+          lambdas[nb_candidates][k] = scale * l[k];
+        }
+        if (lambdas[nb_candidates][0] > 0 && lambdas[nb_candidates][1] > 0 && lambdas[nb_candidates][2] > 0) {
+          nb_candidates++;
+        }
+      }
+    }
+  }
+
+  double best_residual = DBL_MAX;
+  bool found = false;
+  for (unsigned int i = 0; i < nb_candidates; i++) {
+    double *s = lambdas[i];
+
+    // Newton refinement of the distances. A step is only kept if it
+    // decreases the error.
+    double s_prev[3] = {s[0], s[1], s[2]};
+    double err_prev = DBL_MAX;
+    for (unsigned int iter = 0; iter < 5; iter++) {
+      double f[3], Jf[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+      double err = 0;
+      for (unsigned int p = 0; p < 3; p++) {
+        double sa = s[pairs[p][0]], sb = s[pairs[p][1]];
+        f[p] = sa * sa + sb * sb + b[p] * sa * sb - a[p];
+        err += f[p] * f[p];
+        Jf[p][pairs[p][0]] = 2. * sa + b[p] * sb;
+        Jf[p][pairs[p][1]] = 2. * sb + b[p] * sa;
+      }
+      if (err >= err_prev) {
+        for (unsigned int k = 0; k < 3; k++) {
+          s[k] = s_prev[k];
+        }
+        break;
+      }
+      err_prev = err;
+      for (unsigned int k = 0; k < 3; k++) {
+        s_prev[k] = s[k];
+      }
+
+      double det = det3(Jf);
+      if (std::fabs(det) < DBL_EPSILON) {
+        break;
+      }
+      // Cramer's rule on Jf ds = -f
+      double max_step = 0;
+      double ds[3];
+      for (unsigned int k = 0; k < 3; k++) {
+        double Mk[3][3];
+        for (unsigned int r = 0; r < 3; r++) {
+          for (unsigned int c = 0; c < 3; c++) {
+            Mk[r][c] = (c == k) ? -f[r] : Jf[r][c];
+          }
+        }
+        ds[k] = det3(Mk) / det;
+        max_step = (std::max)(max_step, std::fabs(ds[k]) / s[k]);
+      }
+      for (unsigned int k = 0; k < 3; k++) {
+        s[k] += ds[k];
+      }
+      if (max_step < 1e-15) {
+        break;
+      }
+    }
+
+    // Points in the camera frame
+    double cP[3][3], cF[3][3];
+    for (unsigned int j = 0; j < 3; j++) {
+      for (unsigned int k = 0; k < 3; k++) {
+        cP[j][k] = s[j] * J[j][k];
+      }
+    }
+    if (!triangleFrame(cP, cF)) {
+      continue;
+    }
+
+    // cRo = cF oF^T and cto = cP - cRo oP, computed at the centroid
+    double R[3][3], t[3];
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++) {
+        R[r][c] = cF[r][0] * oF[c][0] + cF[r][1] * oF[c][1] + cF[r][2] * oF[c][2];
+      }
+      t[r] = 0;
+      for (unsigned int j = 0; j < 3; j++) {
+        t[r] += cP[j][r] - (R[r][0] * oP[j][0] + R[r][1] * oP[j][1] + R[r][2] * oP[j][2]);
+      }
+      t[r] /= 3.;
+    }
+
+    // Residual over all the points, see computeResidual()
+    double r = 0;
+    for (std::list<vpPoint>::const_iterator it_pt = listP.begin(); it_pt != listP.end(); ++it_pt) {
+      double oX = it_pt->get_oX(), oY = it_pt->get_oY(), oZ = it_pt->get_oZ();
+      double X = R[0][0] * oX + R[0][1] * oY + R[0][2] * oZ + t[0];
+      double Y = R[1][0] * oX + R[1][1] * oY + R[1][2] * oZ + t[1];
+      double Z = R[2][0] * oX + R[2][1] * oY + R[2][2] * oZ + t[2];
+      r += vpMath::sqr(X / Z - it_pt->get_x()) + vpMath::sqr(Y / Z - it_pt->get_y());
+    }
+
+    if (r < best_residual) {
+      best_residual = r;
+      for (unsigned int k = 0; k < 3; k++) {
+        for (unsigned int c = 0; c < 3; c++) {
+          cMo[k][c] = R[k][c];
+        }
+        cMo[k][3] = t[k];
+      }
+      found = true;
+    }
+  }
+
+  if (!found) {
+    throw(vpPoseException(vpPoseException::poseError, "No solution found with P3P"));
+  }
+}
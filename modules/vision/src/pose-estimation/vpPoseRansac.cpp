@@ -49,6 +49,7 @@
 #include <iostream>
 #include <limits> // numeric_limits
 #include <map>
+#include <utility> // std::pair
 
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpMath.h>
@@ -118,31 +119,249 @@ struct FindDegeneratePoint {
 
   vpPoint m_pt;
 };
+
+// PROSAC growth function (see Chum and Matas, Matching with PROSAC -
+// Progressive Sample Consensus, CVPR 2005): growth[k] is the trial from which
+// the k+1 best points are used to draw the samples
+void computeProsacGrowth(unsigned int nbPoints, int maxTrials, std::vector<int> &growth)
+{
+  const unsigned int nbMinRandom = 4;
+  growth.assign(nbPoints, 0);
+
+  double T_n = (double)maxTrials;
+  for (unsigned int i = 0; i < nbMinRandom; i++) {
+    T_n *= (double)(nbMinRandom - i) / (double)(nbPoints - i);
+  }
+
+  int T_prime = 1;
+  for (unsigned int n = nbMinRandom; n < nbPoints; n++) {
+    double T_n1 = T_n * (double)(n + 1) / (double)(n + 1 - nbMinRandom);
+    T_prime += (int)ceil(T_n1 - T_n);
+    growth[n] = T_prime - 1;
+    T_n = T_n1;
+  }
+}
+}
+
+vpPose::RansacFunctor::RansacFunctor(const vpHomogeneousMatrix &cMo_, const unsigned int ransacNbInlierConsensus_,
+                                     const int ransacMaxTrials_, const double ransacThreshold_,
+                                     const unsigned int initial_seed_, const bool checkDegeneratePoints_,
+                                     const std::vector<vpPoint> &listOfUniquePoints_,
+                                     bool (*func_)(const vpHomogeneousMatrix &)
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+                                     , RansacSharedState *sharedState
+#endif
+                                     )
+  :
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+    m_sharedState(sharedState),
+#endif
+    m_best_consensus(), m_checkDegeneratePoints(checkDegeneratePoints_), m_cMo(cMo_), m_foundSolution(false),
+    m_func(func_), m_initial_seed(initial_seed_), m_listOfUniquePoints(listOfUniquePoints_), m_nbInliers(0),
+    m_ransacMaxTrials(ransacMaxTrials_), m_ransacNbInlierConsensus(ransacNbInlierConsensus_),
+    m_ransacThreshold(ransacThreshold_), m_oX(), m_oY(), m_oZ(), m_x(), m_y(), m_adaptive(false), m_probability(0.99),
+    m_prosacGrowth(), m_nbTrials(0), m_maxTrials(ransacMaxTrials_), m_useP3P(false)
+{
+  size_t size = m_listOfUniquePoints.size();
+  m_oX.resize(size);
+  m_oY.resize(size);
+  m_oZ.resize(size);
+  m_x.resize(size);
+  m_y.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    m_oX[i] = m_listOfUniquePoints[i].get_oX();
+    m_oY[i] = m_listOfUniquePoints[i].get_oY();
+    m_oZ[i] = m_listOfUniquePoints[i].get_oZ();
+    m_x[i] = m_listOfUniquePoints[i].get_x();
+    m_y[i] = m_listOfUniquePoints[i].get_y();
+  }
+}
+
+/*!
+  Enable the adaptive termination: each time a better consensus is found, the
+  number of trials is decreased to the one ensuring with the given
+  probability that an outlier free sample was drawn.
+*/
+void vpPose::RansacFunctor::setAdaptiveTermination(double probability)
+{
+  m_adaptive = true;
+  m_probability = probability;
+}
+
+/*!
+  If true, compute the hypotheses with the P3P solver instead of the Lagrange
+  and Dementhon approaches.
+*/
+void vpPose::RansacFunctor::setP3PHypotheses(bool useP3P) { m_useP3P = useP3P; }
+
+/*!
+  Enable the PROSAC ordered sampling. The points have to be sorted by
+  decreasing matching score.
+
+  \param growth : Growth function of the sampling set; growth[n] is the trial
+  from which the n+1 first points are used.
+*/
+void vpPose::RansacFunctor::setProsacSampling(const std::vector<int> &growth) { m_prosacGrowth = growth; }
+
+/*!
+  Return the index of the next trial, or -1 if the RANSAC has to stop.
+*/
+int vpPose::RansacFunctor::nextTrial()
+{
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+  if (m_sharedState != NULL) {
+    if (m_sharedState->m_abort) {
+      return -1;
+    }
+    int trial = m_sharedState->m_nbTrials++;
+    return trial < m_sharedState->m_maxTrials ? trial : -1;
+  }
+#endif
+  if (m_nbTrials >= m_maxTrials || m_nbInliers >= m_ransacNbInlierConsensus) {
+    return -1;
+  }
+  return m_nbTrials++;
+}
+
+/*!
+  Return the best number of inliers found so far, by all the threads in the
+  parallel case.
+*/
+unsigned int vpPose::RansacFunctor::getBestNbInliers() const
+{
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+  if (m_sharedState != NULL) {
+    return (std::max)(m_nbInliers, m_sharedState->m_bestNbInliers.load());
+  }
+#endif
+  return m_nbInliers;
+}
+
+/*!
+  Update the best number of inliers and, with the adaptive termination, the
+  number of trials to perform.
+*/
+void vpPose::RansacFunctor::updateBestNbInliers(unsigned int nbInliers)
+{
+  int maxTrials = m_ransacMaxTrials;
+  if (m_adaptive) {
+    double epsilon = 1.0 - (double)nbInliers / (double)m_listOfUniquePoints.size();
+    maxTrials = vpPose::computeRansacIterations(m_probability, epsilon, 4, m_ransacMaxTrials);
+  }
+
+#ifdef VISP_HAVE_CPP11_COMPATIBILITY
+  if (m_sharedState != NULL) {
+    unsigned int best = m_sharedState->m_bestNbInliers.load();
+    while (best < nbInliers && !m_sharedState->m_bestNbInliers.compare_exchange_weak(best, nbInliers)) {
+    }
+    int current = m_sharedState->m_maxTrials.load();
+    while (maxTrials < current && !m_sharedState->m_maxTrials.compare_exchange_weak(current, maxTrials)) {
+    }
+    if (nbInliers >= m_ransacNbInlierConsensus) {
+      m_sharedState->m_abort = true;
+    }
+    return;
+  }
+#endif
+  m_maxTrials = (std::min)(m_maxTrials, maxTrials);
+}
+
+/*!
+  Return a random index in [0, size[.
+*/
+unsigned int vpPose::RansacFunctor::randomIndex(unsigned int size)
+{
+#if defined(_WIN32) && (defined(_MSC_VER) || defined(__MINGW32__)) || defined(ANDROID)
+  return (unsigned int)rand() % size;
+#else
+  return (unsigned int)rand_r(&m_initial_seed) % size;
+#endif
+}
+
+/*!
+  Draw the minimal sample used to compute a pose hypothesis.
+
+  With a uniform sampling, the points are drawn among all the points. With
+  the PROSAC sampling, the sample is made of the last point of the current
+  sampling set and of points drawn among the previous ones; once the whole
+  set is reached, the sampling is uniform.
+
+  \return true if a non degenerate sample was drawn.
+*/
+bool vpPose::RansacFunctor::drawSample(int trial, std::vector<bool> &usedPt, vpPose &poseMin)
+{
+  const unsigned int nbMinRandom = 4;
+  unsigned int size = (unsigned int)m_listOfUniquePoints.size();
+
+  if (!m_prosacGrowth.empty() && trial < m_prosacGrowth.back()) {
+    // Size of the sampling set for this trial
+    unsigned int n = (unsigned int)(std::upper_bound(m_prosacGrowth.begin(), m_prosacGrowth.end(), trial) -
+                                    m_prosacGrowth.begin());
+    n = (std::max)(n, nbMinRandom);
+    usedPt[n - 1] = true;
+    poseMin.addPoint(m_listOfUniquePoints[n - 1]);
+    size = n - 1;
+  }
+
+  unsigned int nbUsed = 0;
+  for (unsigned int i = poseMin.npt; i < nbMinRandom;) {
+    if (nbUsed == size) {
+      // All points was picked once, break otherwise we stay in an infinite loop
+      break;
+    }
+
+    // Pick a point randomly
+    unsigned int r_ = randomIndex(size);
+    while (usedPt[r_]) {
+      // If already picked, pick another point randomly
+      r_ = randomIndex(size);
+    }
+    // Mark this point as already picked
+    usedPt[r_] = true;
+    nbUsed++;
+    const vpPoint &pt = m_listOfUniquePoints[r_];
+
+    bool degenerate = false;
+    if (m_checkDegeneratePoints) {
+      if (std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=
+          poseMin.listOfPoints.end()) {
+        degenerate = true;
+      }
+    }
+
+    if (!degenerate) {
+      poseMin.addPoint(pt);
+      // Increment the number of points picked
+      i++;
+    }
+  }
+
+  return poseMin.npt >= nbMinRandom;
 }
 
 bool vpPose::RansacFunctor::poseRansacImpl()
 {
   const unsigned int size = (unsigned int)m_listOfUniquePoints.size();
   const unsigned int nbMinRandom = 4;
-  int nbTrials = 0;
 
 #if defined(_WIN32) && (defined(_MSC_VER) || defined(__MINGW32__))
   srand(m_initial_seed);
 #endif
 
-  vpPoint p; // Point used to project using the estimated pose
+  // Hold the list of the index of the inliers (points in the consensus set)
+  std::vector<unsigned int> cur_consensus;
+  cur_consensus.reserve(size);
+  // Hold the list of the current inliers points to avoid to add a
+  // degenerate point if the flag is set
+  std::vector<vpPoint> cur_inliers;
+  // Vector of used points
+  std::vector<bool> usedPt(size);
 
   bool foundSolution = false;
-  while (nbTrials < m_ransacMaxTrials && m_nbInliers < m_ransacNbInlierConsensus) {
-    // Hold the list of the index of the inliers (points in the consensus set)
-    std::vector<unsigned int> cur_consensus;
-    // Hold the list of the index of the outliers
-    std::vector<unsigned int> cur_outliers;
-    // Hold the list of the index of the points randomly picked
-    std::vector<unsigned int> cur_randoms;
-    // Hold the list of the current inliers points to avoid to add a
-    // degenerate point if the flag is set
-    std::vector<vpPoint> cur_inliers;
+  int trial;
+  while ((trial = nextTrial()) >= 0) {
+    cur_consensus.clear();
+    cur_inliers.clear();
 
     vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
     // Use a temporary variable because if not, the cMo passed in parameters
@@ -153,97 +372,70 @@ bool vpPose::RansacFunctor::poseRansacImpl()
     vpHomogeneousMatrix cMo_tmp;
 
     // Vector of used points, initialized at false for all points
-    std::vector<bool> usedPt(size, false);
+    std::fill(usedPt.begin(), usedPt.end(), false);
 
     vpPose poseMin;
-    for (unsigned int i = 0; i < nbMinRandom;) {
-      if ((size_t)std::count(usedPt.begin(), usedPt.end(), true) == usedPt.size()) {
-        // All points was picked once, break otherwise we stay in an infinite loop
-        break;
-      }
+    if (!drawSample(trial, usedPt, poseMin)) {
+      continue;
+    }
 
-// Pick a point randomly
-#if defined(_WIN32) && (defined(_MSC_VER) || defined(__MINGW32__)) || defined(ANDROID)
-      unsigned int r_ = (unsigned int)rand() % size;
-#else
-      unsigned int r_ = (unsigned int)rand_r(&m_initial_seed) % size;
-#endif
+    bool is_valid = false;
+    double r = DBL_MAX;
+    if (m_useP3P) {
+      // The three first points of the sample give up to four solutions, the
+      // fourth point selects the right one
+      try {
+        poseMin.poseP3P(cMo_tmp);
+        r = poseMin.computeResidual(cMo_tmp);
+        is_valid = !vpMath::isNaN(r);
+      } catch (...) { }
+    } else {
+      // Flags set if pose computation is OK
+      bool is_valid_lagrange = false;
+      bool is_valid_dementhon = false;
 
-      while (usedPt[r_]) {
-// If already picked, pick another point randomly
-#if defined(_WIN32) && (defined(_MSC_VER) || defined(__MINGW32__)) || defined(ANDROID)
-        r_ = (unsigned int)rand() % size;
-#else
-        r_ = (unsigned int)rand_r(&m_initial_seed) % size;
-#endif
-      }
-      // Mark this point as already picked
-      usedPt[r_] = true;
-      vpPoint pt = m_listOfUniquePoints[r_];
-
-      bool degenerate = false;
-      if (m_checkDegeneratePoints) {
-        if (std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=
-            poseMin.listOfPoints.end()) {
-          degenerate = true;
-        }
-      }
+      // Set maximum value for residuals
+      double r_lagrange = DBL_MAX;
+      double r_dementhon = DBL_MAX;
 
-      if (!degenerate) {
-        poseMin.addPoint(pt);
-        cur_randoms.push_back(r_);
-        // Increment the number of points picked
-        i++;
-      }
-    }
+      try {
+        poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
+        r_lagrange = poseMin.computeResidual(cMo_lagrange);
+        is_valid_lagrange = true;
+      } catch (...) { }
 
-    if (poseMin.npt < nbMinRandom) {
-      nbTrials++;
-      continue;
-    }
+      try {
+        poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
+        r_dementhon = poseMin.computeResidual(cMo_dementhon);
+        is_valid_dementhon = true;
+      } catch (...) { }
 
-    // Flags set if pose computation is OK
-    bool is_valid_lagrange = false;
-    bool is_valid_dementhon = false;
-
-    // Set maximum value for residuals
-    double r_lagrange = DBL_MAX;
-    double r_dementhon = DBL_MAX;
-
-    try {
-      poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
-      r_lagrange = poseMin.computeResidual(cMo_lagrange);
-      is_valid_lagrange = true;
-    } catch (...) { }
-
-    try {
-      poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
-      r_dementhon = poseMin.computeResidual(cMo_dementhon);
-      is_valid_dementhon = true;
-    } catch (...) { }
-
-    // If residual returned is not a number (NAN), set valid to false
-    if (vpMath::isNaN(r_lagrange)) {
-      is_valid_lagrange = false;
-      r_lagrange = DBL_MAX;
-    }
+      // If residual returned is not a number (NAN), set valid to false
+      if (vpMath::isNaN(r_lagrange)) {
+        is_valid_lagrange = false;
+        r_lagrange = DBL_MAX;
+      }
 
-    if (vpMath::isNaN(r_dementhon)) {
-      is_valid_dementhon = false;
-      r_dementhon = DBL_MAX;
+      if (vpMath::isNaN(r_dementhon)) {
+        is_valid_dementhon = false;
+        r_dementhon = DBL_MAX;
+      }
+
+      if (is_valid_lagrange || is_valid_dementhon) {
+        is_valid = true;
+        if (r_lagrange < r_dementhon) {
+          r = r_lagrange;
+          cMo_tmp = cMo_lagrange;
+        } else {
+          r = r_dementhon;
+          cMo_tmp = cMo_dementhon;
+        }
+      }
     }
 
     // If at least one pose computation is OK,
     // we can continue, otherwise pick another random set
-    if (is_valid_lagrange || is_valid_dementhon) {
-      double r;
-      if (r_lagrange < r_dementhon) {
-        r = r_lagrange;
-        cMo_tmp = cMo_lagrange;
-      } else {
-        r = r_dementhon;
-        cMo_tmp = cMo_dementhon;
-      }
+    if (is_valid) {
       r = sqrt(r) / (double)nbMinRandom;
 
       // Filter the pose using some criterion (orientation angles,
@@ -261,17 +453,28 @@ bool vpPose::RansacFunctor::poseRansacImpl()
 
       if (isPoseValid && r < m_ransacThreshold) {
         unsigned int nbInliersCur = 0;
-        unsigned int iter = 0;
-        for (std::vector<vpPoint>::const_iterator it = m_listOfUniquePoints.begin(); it != m_listOfUniquePoints.end();
-             ++it, iter++) {
-          p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-          p.track(m_cMo);
+        unsigned int bestNbInliers = getBestNbInliers();
+
+        const double *cMo = m_cMo.data;
+        for (unsigned int iter = 0; iter < size; iter++) {
+          // Preemptive scoring: stop as soon as the hypothesis cannot beat
+          // the best one
+          if (nbInliersCur + (size - iter) <= bestNbInliers) {
+            break;
+          }
+
+          double X = cMo[0] * m_oX[iter] + cMo[1] * m_oY[iter] + cMo[2] * m_oZ[iter] + cMo[3];
+          double Y = cMo[4] * m_oX[iter] + cMo[5] * m_oY[iter] + cMo[6] * m_oZ[iter] + cMo[7];
+          double Z = cMo[8] * m_oX[iter] + cMo[9] * m_oY[iter] + cMo[10] * m_oZ[iter] + cMo[11];
+          double dx = X / Z - m_x[iter];
+          double dy = Y / Z - m_y[iter];
 
-          double error = sqrt(vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y()));
+          double error = sqrt(dx * dx + dy * dy);
           if (error < m_ransacThreshold) {
             bool degenerate = false;
             if (m_checkDegeneratePoints) {
-              if (std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(*it)) != cur_inliers.end()) {
+              if (std::find_if(cur_inliers.begin(), cur_inliers.end(),
+                               FindDegeneratePoint(m_listOfUniquePoints[iter])) != cur_inliers.end()) {
                 degenerate = true;
               }
             }
@@ -281,12 +484,10 @@ bool vpPose::RansacFunctor::poseRansacImpl()
               // threshold
               nbInliersCur++;
               cur_consensus.push_back(iter);
-              cur_inliers.push_back(*it);
-            } else {
-              cur_outliers.push_back(iter);
+              if (m_checkDegeneratePoints) {
+                cur_inliers.push_back(m_listOfUniquePoints[iter]);
+              }
             }
-          } else {
-            cur_outliers.push_back(iter);
           }
         }
 
@@ -294,29 +495,35 @@ bool vpPose::RansacFunctor::poseRansacImpl()
           foundSolution = true;
           m_best_consensus = cur_consensus;
           m_nbInliers = nbInliersCur;
+          updateBestNbInliers(nbInliersCur);
         }
 
-        nbTrials++;
-
-        if (nbTrials >= m_ransacMaxTrials) {
+        if (trial + 1 >= m_ransacMaxTrials) {
           foundSolution = true;
         }
-      } else {
-        nbTrials++;
       }
-    } else {
-      nbTrials++;
     }
   }
 
-#ifdef VISP_HAVE_CPP11_COMPATIBILITY
-  if (m_nbInliers >= m_ransacNbInlierConsensus)
-    m_abort = true;
-#endif
-
   return foundSolution;
 }
 
+/*!
+  Set the matching score of each point, the higher the score the more
+  confident the 2D/3D match. When scores are set, poseRansac() uses the PROSAC
+  ordered sampling: the samples are first drawn among the points with the
+  best scores, the sampling set being progressively enlarged to all the
+  points. This drastically reduces the number of trials when the matches with
+  the best scores are likely to be inliers.
+
+  \param scores : Scores of the points in the order they were added with
+  addPoint() or addPoints(). An empty vector disables the PROSAC sampling.
+
+  \note The scores are cleared by clearPoint().
+  \sa setUseAdaptiveRansac
+*/
+void vpPose::setRansacScores(const std::vector<double> &scores) { ransacScores = scores; }
+
 /*!
   Compute the pose using the Ransac approach.
 
@@ -329,6 +536,11 @@ bool vpPose::RansacFunctor::poseRansacImpl()
   \note You can enable a multithreaded version if you have C++11 enabled using \e setUseParallelRansac
   The number of threads used can then be set with \e setNbParallelRansacThreads
   Filter flag can be used  with \e setRansacFilterFlag
+  \note The number of trials can be adapted to the best consensus found so
+  far using \e setUseAdaptiveRansac and the samples can be drawn from the
+  best matches first using \e setRansacScores.
+  \note The hypotheses can be computed with the P3P minimal solver and the
+  final pose initialized with EPnP using \e setUseP3PRansac.
 */
 bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneousMatrix &))
 {
@@ -394,6 +606,33 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
     throw(vpPoseException(vpPoseException::notInitializedError, "Not enough point to compute the pose"));
   }
 
+  // PROSAC ordered sampling when the matching scores are available
+  std::vector<int> prosacGrowth;
+  if (!ransacScores.empty()) {
+    if (ransacScores.size() != listOfPoints.size()) {
+      throw(vpPoseException(vpPoseException::poseError, "The number of RANSAC scores (%d) differs from the number of "
+                                                       "points (%d)",
+                            (int)ransacScores.size(), (int)listOfPoints.size()));
+    }
+
+    std::vector<std::pair<double, size_t> > scores(listOfUniquePoints.size());
+    for (size_t i = 0; i < listOfUniquePoints.size(); i++) {
+      scores[i] = std::make_pair(-ransacScores[mapOfUniquePointIndex[i]], i);
+    }
+    std::stable_sort(scores.begin(), scores.end());
+
+    std::vector<vpPoint> listOfSortedPoints(listOfUniquePoints.size());
+    std::map<size_t, size_t> mapOfSortedPointIndex;
+    for (size_t i = 0; i < scores.size(); i++) {
+      listOfSortedPoints[i] = listOfUniquePoints[scores[i].second];
+      mapOfSortedPointIndex[i] = mapOfUniquePointIndex[scores[i].second];
+    }
+    listOfUniquePoints.swap(listOfSortedPoints);
+    mapOfUniquePointIndex.swap(mapOfSortedPointIndex);
+
+    computeProsacGrowth((unsigned int)listOfUniquePoints.size(), ransacMaxTrials, prosacGrowth);
+  }
+
   bool executeParallelVersion = useParallelRansac;
 #ifdef VISP_HAVE_CPP11_COMPATIBILITY
   unsigned int nbThreads = 1;
@@ -406,10 +645,12 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
     if (nbParallelRansacThreads <= 0) {
       // Get number of CPU threads
       nbThreads = std::thread::hardware_concurrency();
-      if (nbThreads <= 1) {
-        nbThreads = 1;
-        executeParallelVersion = false;
-      }
+    } else {
+      nbThreads = (unsigned int)nbParallelRansacThreads;
+    }
+    if (nbThreads <= 1) {
+      nbThreads = 1;
+      executeParallelVersion = false;
     }
 #endif
   }
@@ -418,22 +659,22 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
 
   if (executeParallelVersion) {
 #ifdef VISP_HAVE_CPP11_COMPATIBILITY
+    // The workers share the trial counter, the best number of inliers and the
+    // number of trials to perform, such that the threads stop all together as
+    // soon as the consensus is reached or the adaptive criterion is satisfied
+    RansacSharedState sharedState(ransacMaxTrials);
     std::vector<std::thread> threadpool;
     std::vector<RansacFunctor> ransacWorkers;
-    const unsigned int nthreads = std::thread::hardware_concurrency();
 
-    int splitTrials = ransacMaxTrials / nthreads;
-    std::atomic<bool> abort{false};
-    for (size_t i = 0; i < (size_t)nthreads; i++) {
+    for (size_t i = 0; i < (size_t)nbThreads; i++) {
       unsigned int initial_seed = (unsigned int)i; //((unsigned int) time(NULL) ^ i);
-      if (i < (size_t)nthreads - 1) {
-        ransacWorkers.emplace_back(cMo, ransacNbInlierConsensus, splitTrials, ransacThreshold, initial_seed,
-                                   checkDegeneratePoints, listOfUniquePoints, func, abort);
-      } else {
-        int maxTrialsRemainder = ransacMaxTrials - splitTrials * (nbThreads - 1);
-        ransacWorkers.emplace_back(cMo, ransacNbInlierConsensus, maxTrialsRemainder, ransacThreshold, initial_seed,
-                                   checkDegeneratePoints, listOfUniquePoints, func, abort);
+      ransacWorkers.emplace_back(cMo, ransacNbInlierConsensus, ransacMaxTrials, ransacThreshold, initial_seed,
+                                 checkDegeneratePoints, listOfUniquePoints, func, &sharedState);
+      if (useAdaptiveRansac) {
+        ransacWorkers.back().setAdaptiveTermination(ransacProbability);
       }
+      ransacWorkers.back().setProsacSampling(prosacGrowth);
+      ransacWorkers.back().setP3PHypotheses(useP3PRansac);
     }
 
     for (auto& worker : ransacWorkers) {
@@ -462,15 +703,13 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
 #endif
   } else {
     // Sequential RANSAC
-#ifdef VISP_HAVE_CPP11_COMPATIBILITY
-    std::atomic<bool> abort{false};
-#endif
     RansacFunctor sequentialRansac(cMo, ransacNbInlierConsensus, ransacMaxTrials, ransacThreshold, 0,
-                                   checkDegeneratePoints, listOfUniquePoints, func
-                               #ifdef VISP_HAVE_CPP11_COMPATIBILITY
-                                   , abort
-                               #endif
-                                   );
+                                   checkDegeneratePoints, listOfUniquePoints, func);
+    if (useAdaptiveRansac) {
+      sequentialRansac.setAdaptiveTermination(ransacProbability);
+    }
+    sequentialRansac.setProsacSampling(prosacGrowth);
+    sequentialRansac.setP3PHypotheses(useP3PRansac);
     sequentialRansac();
     foundSolution = sequentialRansac.getResult();
 
@@ -531,17 +770,28 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
       double r_lagrange = DBL_MAX;
       double r_dementhon = DBL_MAX;
 
-      try {
-        pose.computePose(vpPose::LAGRANGE, cMo_lagrange);
-        r_lagrange = pose.computeResidual(cMo_lagrange);
-        is_valid_lagrange = true;
-      } catch (...) { }
+      bool is_valid_epnp = false;
+      if (useP3PRansac) {
+        // EPnP initialization, linear in the number of inliers
+        try {
+          pose.computePose(vpPose::EPNP, cMo);
+          is_valid_epnp = !vpMath::isNaN(pose.computeResidual(cMo));
+        } catch (...) { }
+      }
 
-      try {
-        pose.computePose(vpPose::DEMENTHON, cMo_dementhon);
-        r_dementhon = pose.computeResidual(cMo_dementhon);
-        is_valid_dementhon = true;
-      } catch (...) { }
+      if (!is_valid_epnp) {
+        try {
+          pose.computePose(vpPose::LAGRANGE, cMo_lagrange);
+          r_lagrange = pose.computeResidual(cMo_lagrange);
+          is_valid_lagrange = true;
+        } catch (...) { }
+
+        try {
+          pose.computePose(vpPose::DEMENTHON, cMo_dementhon);
+          r_dementhon = pose.computeResidual(cMo_dementhon);
+          is_valid_dementhon = true;
+        } catch (...) { }
+      }
 
       // If residual returned is not a number (NAN), set valid to false
       if (vpMath::isNaN(r_lagrange)) {
@@ -554,11 +804,13 @@ bool vpPose::poseRansac(vpHomogeneousMatrix &cMo, bool (*func)(const vpHomogeneo
         r_dementhon = DBL_MAX;
       }
 
-      if (is_valid_lagrange || is_valid_dementhon) {
-        if (r_lagrange < r_dementhon) {
-          cMo = cMo_lagrange;
-        } else {
-          cMo = cMo_dementhon;
+      if (is_valid_epnp || is_valid_lagrange || is_valid_dementhon) {
+        if (!is_valid_epnp) {
+          if (r_lagrange < r_dementhon) {
+            cMo = cMo_lagrange;
+          } else {
+            cMo = cMo_dementhon;
+          }
         }
 
         pose.setCovarianceComputation(computeCovariance);
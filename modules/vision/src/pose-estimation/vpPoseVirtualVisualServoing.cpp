@@ -41,16 +41,264 @@
   \brief Compute the pose using virtual visual servoing approach
 */
 
+#include <cmath>
+#include <float.h> // DBL_EPSILON
+
 #include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpMath.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpRobust.h>
 #include <visp3/vision/vpPose.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+/*
+  Project the points (oX, oY, oZ, x, y) stored in pts with the pose cMo and
+  return the sum of the squared errors between the projected and the
+  measured points. If res is not NULL, the squared error of each point is
+  stored in res. If H is not NULL, the normal equations H = L^T W^2 L and
+  g = L^T W^2 e of the point interaction matrix L and error e are
+  accumulated, with W the weights w of the points (W = I if w is NULL).
+*/
+double computeNormalEquationsVVS(const double *pts, unsigned int nb, const vpHomogeneousMatrix &cMo, const double *w,
+                                 double *res, double H[6][6], double g[6])
+{
+  const double *M = cMo.data;
+  if (H != NULL) {
+    for (unsigned int i = 0; i < 6; i++) {
+      g[i] = 0;
+      for (unsigned int j = 0; j < 6; j++) {
+        H[i][j] = 0;
+      }
+    }
+  }
+
+  double r = 0;
+  for (unsigned int k = 0; k < nb; k++, pts += 5) {
+    double X = M[0] * pts[0] + M[1] * pts[1] + M[2] * pts[2] + M[3];
+    double Y = M[4] * pts[0] + M[5] * pts[1] + M[6] * pts[2] + M[7];
+    double Z = M[8] * pts[0] + M[9] * pts[1] + M[10] * pts[2] + M[11];
+    double x = X / Z;
+    double y = Y / Z;
+    double ex = x - pts[3];
+    double ey = y - pts[4];
+    double e2 = ex * ex + ey * ey;
+    r += e2;
+    if (res != NULL) {
+      res[k] = e2;
+    }
+
+    if (H != NULL) {
+      double Zinv = 1. / Z;
+      double l1[6] = {-Zinv, 0, x * Zinv, x * y, -(1 + x * x), y};
+      double l2[6] = {0, -Zinv, y * Zinv, 1 + y * y, -x * y, -x};
+      double w2 = (w != NULL) ? w[k] * w[k] : 1.;
+      for (unsigned int i = 0; i < 6; i++) {
+        double a1 = w2 * l1[i], a2 = w2 * l2[i];
+        for (unsigned int j = i; j < 6; j++) {
+          H[i][j] += a1 * l1[j] + a2 * l2[j];
+        }
+        g[i] += a1 * ex + a2 * ey;
+      }
+    }
+  }
+
+  if (H != NULL) {
+    for (unsigned int i = 1; i < 6; i++) {
+      for (unsigned int j = 0; j < i; j++) {
+        H[i][j] = H[j][i];
+      }
+    }
+  }
+
+  return r;
+}
+
+/*
+  Solve the 6x6 normal equations H x = g. A Cholesky decomposition is used
+  when H is well conditioned; otherwise the pseudo inverse of H is used.
+  svThreshold is the threshold on the singular values of L, relative to the
+  largest one. Since H = L^T L has the squared singular values of L, the
+  threshold used on H is svThreshold^2, to keep the rank decision of the
+  pseudo inverse of L.
+*/
+void solveNormalEquationsVVS(const double H[6][6], const double g[6], double svThreshold, double x[6])
+{
+  double C[6][6];
+  double max_diag = 0;
+  for (unsigned int i = 0; i < 6; i++) {
+    max_diag = (std::max)(max_diag, H[i][i]);
+  }
+
+  bool positive = max_diag > 0;
+  for (unsigned int j = 0; j < 6 && positive; j++) {
+    double d = H[j][j];
+    for (unsigned int k = 0; k < j; k++) {
+      d -= C[j][k] * C[j][k];
+    }
+    if (d <= 1e3 * DBL_EPSILON * max_diag) {
+      positive = false;
+      break;
+    }
+    C[j][j] = sqrt(d);
+    for (unsigned int i = j + 1; i < 6; i++) {
+      double v = H[i][j];
+      for (unsigned int k = 0; k < j; k++) {
+        v -= C[i][k] * C[j][k];
+      }
+      C[i][j] = v / C[j][j];
+    }
+  }
+
+  if (positive) {
+    double y[6];
+    for (unsigned int i = 0; i < 6; i++) {
+      double v = g[i];
+      for (unsigned int k = 0; k < i; k++) {
+        v -= C[i][k] * y[k];
+      }
+      y[i] = v / C[i][i];
+    }
+    for (int i = 5; i >= 0; i--) {
+      double v = y[i];
+      for (unsigned int k = (unsigned int)i + 1; k < 6; k++) {
+        v -= C[k][i] * x[k];
+      }
+      x[i] = v / C[i][i];
+    }
+  } else {
+    // Rank deficient interaction matrix
+    vpMatrix Hm(6, 6);
+    vpColVector gm(6);
+    for (unsigned int i = 0; i < 6; i++) {
+      gm[i] = g[i];
+      for (unsigned int j = 0; j < 6; j++) {
+        Hm[i][j] = H[i][j];
+      }
+    }
+    vpColVector xm = Hm.pseudoInverse(svThreshold * svThreshold) * gm;
+    for (unsigned int i = 0; i < 6; i++) {
+      x[i] = xm[i];
+    }
+  }
+}
+
+/*
+  cMo = vpExponentialMap::direct(v).inverse() * cMo computed in place.
+*/
+void updatePoseVVS(const double v[6], vpHomogeneousMatrix &cMo)
+{
+  const double *u = v + 3;
+  double theta = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+  double si = sin(theta);
+  double co = cos(theta);
+  double sinc = vpMath::sinc(si, theta);
+  double mcosc = vpMath::mcosc(co, theta);
+  double msinc = vpMath::msinc(si, theta);
+
+  double R[3][3];
+  R[0][0] = co + mcosc * u[0] * u[0];
+  R[0][1] = -sinc * u[2] + mcosc * u[0] * u[1];
+  R[0][2] = sinc * u[1] + mcosc * u[0] * u[2];
+  R[1][0] = sinc * u[2] + mcosc * u[1] * u[0];
+  R[1][1] = co + mcosc * u[1] * u[1];
+  R[1][2] = -sinc * u[0] + mcosc * u[1] * u[2];
+  R[2][0] = -sinc * u[1] + mcosc * u[2] * u[0];
+  R[2][1] = sinc * u[0] + mcosc * u[2] * u[1];
+  R[2][2] = co + mcosc * u[2] * u[2];
+
+  double dt[3];
+  dt[0] = v[0] * (sinc + u[0] * u[0] * msinc) + v[1] * (u[0] * u[1] * msinc - u[2] * mcosc) +
+          v[2] * (u[0] * u[2] * msinc + u[1] * mcosc);
+  dt[1] = v[0] * (u[0] * u[1] * msinc + u[2] * mcosc) + v[1] * (sinc + u[1] * u[1] * msinc) +
+          v[2] * (u[1] * u[2] * msinc - u[0] * mcosc);
+  dt[2] = v[0] * (u[0] * u[2] * msinc - u[1] * mcosc) + v[1] * (u[1] * u[2] * msinc + u[0] * mcosc) +
+          v[2] * (sinc + u[2] * u[2] * msinc);
+
+  // [R dt]^-1 [Rc tc] = [R^T Rc, R^T (tc - dt)]
+  double *M = cMo.data;
+  double Rc[3][4];
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      Rc[i][j] = M[4 * i + j];
+    }
+    Rc[i][3] -= dt[i];
+  }
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 4; j++) {
+      M[4 * i + j] = R[0][i] * Rc[0][j] + R[1][i] * Rc[1][j] + R[2][i] * Rc[2][j];
+    }
+  }
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Copy the coordinates of the points in the contiguous workspace used by the
+  virtual visual servoing and return the number of points.
+*/
+unsigned int vpPose::initVirtualVS()
+{
+  unsigned int nb = (unsigned int)listP.size();
+  vvsPoints.resize(5 * nb);
+  unsigned int k = 0;
+  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it, k += 5) {
+    vvsPoints[k] = it->get_oX();
+    vvsPoints[k + 1] = it->get_oY();
+    vvsPoints[k + 2] = it->get_oZ();
+    vvsPoints[k + 3] = it->get_x();
+    vvsPoints[k + 4] = it->get_y();
+  }
+  return nb;
+}
+
+/*!
+  Compute the interaction matrix \e L and the error \e error of the points
+  for the pose \e cMo. Only used to compute the covariance matrix.
+*/
+void vpPose::computeInteractionMatrixVVS(const vpHomogeneousMatrix &cMo, vpMatrix &L, vpColVector &error)
+{
+  unsigned int nb = (unsigned int)(vvsPoints.size() / 5);
+  L.resize(2 * nb, 6, false);
+  error.resize(2 * nb, false);
+  const double *M = cMo.data;
+  for (unsigned int k = 0; k < nb; k++) {
+    const double *pt = &vvsPoints[5 * k];
+    double X = M[0] * pt[0] + M[1] * pt[1] + M[2] * pt[2] + M[3];
+    double Y = M[4] * pt[0] + M[5] * pt[1] + M[6] * pt[2] + M[7];
+    double Z = M[8] * pt[0] + M[9] * pt[1] + M[10] * pt[2] + M[11];
+    double x = X / Z;
+    double y = Y / Z;
+    error[2 * k] = x - pt[3];
+    error[2 * k + 1] = y - pt[4];
+
+    L[2 * k][0] = -1 / Z;
+    L[2 * k][1] = 0;
+    L[2 * k][2] = x / Z;
+    L[2 * k][3] = x * y;
+    L[2 * k][4] = -(1 + x * x);
+    L[2 * k][5] = y;
+
+    L[2 * k + 1][0] = 0;
+    L[2 * k + 1][1] = -1 / Z;
+    L[2 * k + 1][2] = y / Z;
+    L[2 * k + 1][3] = 1 + y * y;
+    L[2 * k + 1][4] = -x * y;
+    L[2 * k + 1][5] = -x;
+  }
+}
+
 /*!
   \brief Compute the pose using virtual visual servoing approach
 
   This approach is described in \cite Marchand02c.
 
+  The points are stored contiguously in a workspace kept between calls and
+  the velocity is computed from the 6x6 normal equations of the interaction
+  matrix, such that no memory is allocated during the iterations. The
+  minimization stops when the residual change is below the value set with
+  setVvsEpsilon() or after the number of iterations set with setVvsIterMax().
 */
 
 void vpPose::poseVirtualVS(vpHomogeneousMatrix &cMo)
@@ -64,84 +312,36 @@ void vpPose::poseVirtualVS(vpHomogeneousMatrix &cMo)
 
     int iter = 0;
 
-    unsigned int nb = (unsigned int)listP.size();
-    vpMatrix L(2 * nb, 6);
-    vpColVector err(2 * nb);
-    vpColVector sd(2 * nb), s(2 * nb);
-    vpColVector v;
-
-    vpPoint P;
-    std::list<vpPoint> lP;
-
-    // create sd
-    unsigned int k = 0;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it) {
-      P = *it;
-      sd[2 * k] = P.get_x();
-      sd[2 * k + 1] = P.get_y();
-      lP.push_back(P);
-      k++;
-    }
+    unsigned int nb = initVirtualVS();
+    const double *pts = nb > 0 ? &vvsPoints[0] : NULL;
+    double H[6][6], g[6], v[6];
 
     vpHomogeneousMatrix cMoPrev = cMo;
-    // while((int)((residu_1 - r)*1e12) !=0)
-    //    while(std::fabs((residu_1 - r)*1e12) >
-    //    std::numeric_limits<double>::epsilon())
     while (std::fabs(residu_1 - r) > vvsEpsilon) {
       residu_1 = r;
 
-      // Compute the interaction matrix and the error
-      k = 0;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it) {
-        P = *it;
-        // forward projection of the 3D model for a given pose
-        // change frame coordinates
-        // perspective projection
-        P.track(cMo);
-
-        double x = s[2 * k] = P.get_x(); /* point projected from cMo */
-        double y = s[2 * k + 1] = P.get_y();
-        double Z = P.get_Z();
-        L[2 * k][0] = -1 / Z;
-        L[2 * k][1] = 0;
-        L[2 * k][2] = x / Z;
-        L[2 * k][3] = x * y;
-        L[2 * k][4] = -(1 + x * x);
-        L[2 * k][5] = y;
-
-        L[2 * k + 1][0] = 0;
-        L[2 * k + 1][1] = -1 / Z;
-        L[2 * k + 1][2] = y / Z;
-        L[2 * k + 1][3] = 1 + y * y;
-        L[2 * k + 1][4] = -x * y;
-        L[2 * k + 1][5] = -x;
-
-        k += 1;
-      }
-      err = s - sd;
-
-      // compute the residual
-      r = err.sumSquare();
+      // Compute the normal equations of the interaction matrix and the error
+      r = computeNormalEquationsVVS(pts, nb, cMo, NULL, NULL, H, g);
 
-      // compute the pseudo inverse of the interaction matrix
-      vpMatrix Lp;
-      L.pseudoInverse(Lp, 1e-16);
-
-      // compute the VVS control law
-      v = -lambda * Lp * err;
+      // compute the VVS control law v = -lambda (L^T L)^-1 L^T e
+      solveNormalEquationsVVS(H, g, 1e-16, v);
+      for (unsigned int i = 0; i < 6; i++) {
+        v[i] *= -lambda;
+      }
 
-      // std::cout << "r=" << r <<std::endl ;
       // update the pose
-
       cMoPrev = cMo;
-      cMo = vpExponentialMap::direct(v).inverse() * cMo;
-      ;
+      updatePoseVVS(v, cMo);
       if (iter++ > vvsIterMax)
         break;
     }
 
-    if (computeCovariance)
+    if (computeCovariance) {
+      vpMatrix L;
+      vpColVector err;
+      computeInteractionMatrixVVS(cMoPrev, L, err);
       covarianceMatrix = vpMatrix::computeCovarianceMatrixVVS(cMoPrev, err, L);
+    }
   }
 
   catch (...) {
@@ -156,6 +356,8 @@ void vpPose::poseVirtualVS(vpHomogeneousMatrix &cMo)
 
   This approach is described in \cite Comport06b.
 
+  As for poseVirtualVS(), no memory is allocated during the iterations.
+
 */
 void vpPose::poseVirtualVSrobust(vpHomogeneousMatrix &cMo)
 {
@@ -165,102 +367,60 @@ void vpPose::poseVirtualVSrobust(vpHomogeneousMatrix &cMo)
     double r = 1e8 - 1;
 
     // we stop the minimization when the error is bellow 1e-8
-    vpMatrix W;
-    vpRobust robust((unsigned int)(2 * listP.size()));
-    robust.setThreshold(0.0000);
-    vpColVector w, res;
-
-    unsigned int nb = (unsigned int)listP.size();
-    vpMatrix L(2 * nb, 6);
-    vpColVector error(2 * nb);
-    vpColVector sd(2 * nb), s(2 * nb);
-    vpColVector v;
-
-    listP.front();
-    vpPoint P;
-    std::list<vpPoint> lP;
-
-    // create sd
-    unsigned int k_ = 0;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it) {
-      P = *it;
-      sd[2 * k_] = P.get_x();
-      sd[2 * k_ + 1] = P.get_y();
-      lP.push_back(P);
-      k_++;
-    }
+    vvsRobust.setThreshold(0.0000);
+
+    unsigned int nb = initVirtualVS();
+    const double *pts = nb > 0 ? &vvsPoints[0] : NULL;
+    vvsResiduals.resize(nb, false);
+    vvsWeights.resize(nb, false);
+    vvsWeights = 1;
+    double H[6][6], g[6], v[6] = {0, 0, 0, 0, 0, 0};
+
     int iter = 0;
-    res.resize(s.getRows() / 2);
-    w.resize(s.getRows() / 2);
-    W.resize(s.getRows(), s.getRows());
-    w = 1;
+    vpHomogeneousMatrix cMoPrev = cMo;
 
     // while((int)((residu_1 - r)*1e12) !=0)
     while (std::fabs((residu_1 - r) * 1e12) > std::numeric_limits<double>::epsilon()) {
       residu_1 = r;
 
-      // Compute the interaction matrix and the error
-      k_ = 0;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it) {
-        P = *it;
-        // forward projection of the 3D model for a given pose
-        // change frame coordinates
-        // perspective projection
-        P.track(cMo);
-
-        double x = s[2 * k_] = P.get_x(); // point projected from cMo
-        double y = s[2 * k_ + 1] = P.get_y();
-        double Z = P.get_Z();
-        L[2 * k_][0] = -1 / Z;
-        L[2 * k_][1] = 0;
-        L[2 * k_][2] = x / Z;
-        L[2 * k_][3] = x * y;
-        L[2 * k_][4] = -(1 + x * x);
-        L[2 * k_][5] = y;
-
-        L[2 * k_ + 1][0] = 0;
-        L[2 * k_ + 1][1] = -1 / Z;
-        L[2 * k_ + 1][2] = y / Z;
-        L[2 * k_ + 1][3] = 1 + y * y;
-        L[2 * k_ + 1][4] = -x * y;
-        L[2 * k_ + 1][5] = -x;
-
-        k_++;
-      }
-      error = s - sd;
+      // Compute the error and the weights
+      r = computeNormalEquationsVVS(pts, nb, cMo, NULL, vvsResiduals.data, NULL, NULL);
+      vvsRobust.setIteration(0);
+      vvsRobust.MEstimator(vpRobust::TUKEY, vvsResiduals, vvsWeights);
 
-      // compute the residual
-      r = error.sumSquare();
-
-      for (unsigned int k = 0; k < error.getRows() / 2; k++) {
-        res[k] = vpMath::sqr(error[2 * k]) + vpMath::sqr(error[2 * k + 1]);
-      }
-      robust.setIteration(0);
-      robust.MEstimator(vpRobust::TUKEY, res, w);
+      // Compute the weighted normal equations of the interaction matrix
+      computeNormalEquationsVVS(pts, nb, cMo, vvsWeights.data, NULL, H, g);
 
-      // compute the pseudo inverse of the interaction matrix
-      for (unsigned int k = 0; k < error.getRows() / 2; k++) {
-        W[2 * k][2 * k] = w[k];
-        W[2 * k + 1][2 * k + 1] = w[k];
+      // compute the VVS control law v = -lambda (L^T W^2 L)^-1 L^T W^2 e
+      solveNormalEquationsVVS(H, g, 1e-6, v);
+      for (unsigned int i = 0; i < 6; i++) {
+        v[i] *= -lambda;
       }
-      // compute the pseudo inverse of the interaction matrix
-      vpMatrix Lp;
-      (W * L).pseudoInverse(Lp, 1e-6);
 
-      // compute the VVS control law
-      v = -lambda * Lp * W * error;
-
-      cMo = vpExponentialMap::direct(v).inverse() * cMo;
-      ;
+      cMoPrev = cMo;
+      updatePoseVVS(v, cMo);
       if (iter++ > vvsIterMax)
         break;
     }
 
-    if (computeCovariance)
+    if (computeCovariance) {
+      vpMatrix L;
+      vpColVector error;
+      computeInteractionMatrixVVS(cMoPrev, L, error);
+      vpMatrix W(2 * nb, 2 * nb);
+      for (unsigned int k = 0; k < nb; k++) {
+        W[2 * k][2 * k] = vvsWeights[k];
+        W[2 * k + 1][2 * k + 1] = vvsWeights[k];
+      }
+      vpColVector vel(6);
+      for (unsigned int i = 0; i < 6; i++) {
+        vel[i] = v[i];
+      }
       covarianceMatrix =
-          vpMatrix::computeCovarianceMatrix(L, v, -lambda * error, W * W); // Remark: W*W = W*W.t() since the
-                                                                           // matrix is diagonale, but using W*W
-                                                                           // is more efficient.
+          vpMatrix::computeCovarianceMatrix(L, vel, -lambda * error, W * W); // Remark: W*W = W*W.t() since the
+                                                                             // matrix is diagonale, but using W*W
+                                                                             // is more efficient.
+    }
   } catch (...) {
     vpERROR_TRACE(" ");
     throw;
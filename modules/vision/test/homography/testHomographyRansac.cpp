@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test robust homography estimation with outliers.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testHomographyRansac.cpp
+
+  \brief Test vpHomography::ransac() and vpHomography::robust() on synthetic
+  points corrupted by outliers.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpGaussRand.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpHomography.h>
+
+namespace
+{
+void generatePoints(const vpHomography &aHb, unsigned int n, double outlierRatio, vpUniRand &rand,
+                    std::vector<double> &xb, std::vector<double> &yb, std::vector<double> &xa,
+                    std::vector<double> &ya, std::vector<bool> &isOutlier)
+{
+  xb.resize(n);
+  yb.resize(n);
+  xa.resize(n);
+  ya.resize(n);
+  isOutlier.resize(n);
+  for (unsigned int i = 0; i < n; i++) {
+    xb[i] = rand() - 0.5;
+    yb[i] = rand() - 0.5;
+    isOutlier[i] = (i < outlierRatio * n);
+    if (isOutlier[i]) {
+      xa[i] = rand() - 0.5;
+      ya[i] = rand() - 0.5;
+    } else {
+      double z = aHb[2][0] * xb[i] + aHb[2][1] * yb[i] + aHb[2][2];
+      xa[i] = (aHb[0][0] * xb[i] + aHb[0][1] * yb[i] + aHb[0][2]) / z;
+      ya[i] = (aHb[1][0] * xb[i] + aHb[1][1] * yb[i] + aHb[1][2]) / z;
+    }
+  }
+}
+
+bool compareHomography(const vpHomography &H1, const vpHomography &H2, double eps)
+{
+  for (unsigned int i = 0; i < 9; i++) {
+    if (std::fabs(H1.data[i] / H1.data[8] - H2.data[i] / H2.data[8]) > eps) {
+      std::cout << "Estimated homography:\n" << H1 << "\ndiffers from:\n" << H2 << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpHomogeneousMatrix aMb(0.1, -0.05, 0.2, vpMath::rad(10), vpMath::rad(-15), vpMath::rad(20));
+    vpPlane bP(0.1, -0.2, 1, -1.5);
+    vpHomography aHb(aMb, bP);
+    aHb /= aHb[2][2];
+
+    vpUniRand rand(1234);
+    std::vector<double> xb, yb, xa, ya;
+    std::vector<bool> isOutlier, inliers;
+    unsigned int n = 500;
+    double threshold = 1e-3;
+
+    double t_ransac = 0.;
+    unsigned int nbTrials = 20;
+    for (unsigned int trial = 0; trial < nbTrials; trial++) {
+      generatePoints(aHb, n, 0.4, rand, xb, yb, xa, ya, isOutlier);
+
+      vpHomography aHb_est;
+      double residual = 0.;
+      double t = vpTime::measureTimeMs();
+      bool success = vpHomography::ransac(xb, yb, xa, ya, aHb_est, inliers, residual, (unsigned int)(0.55 * n),
+                                          threshold, true);
+      t_ransac += vpTime::measureTimeMs() - t;
+
+      if (!success) {
+        std::cout << "vpHomography::ransac() failed at trial " << trial << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (unsigned int i = 0; i < n; i++) {
+        if (!isOutlier[i] && !inliers[i]) {
+          std::cout << "Point " << i << " should be an inlier" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      if (residual > 1e-8 || !compareHomography(aHb_est, aHb, 1e-6)) {
+        std::cout << "Bad homography estimated by ransac(), residual: " << residual << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << "Mean computation time (ms) of ransac() with " << n << " points: " << t_ransac / nbTrials
+              << std::endl;
+
+    // Without normalization
+    {
+      generatePoints(aHb, n, 0.3, rand, xb, yb, xa, ya, isOutlier);
+      vpHomography aHb_est;
+      double residual = 0.;
+      if (!vpHomography::ransac(xb, yb, xa, ya, aHb_est, inliers, residual, (unsigned int)(0.65 * n), threshold,
+                                false) ||
+          !compareHomography(aHb_est, aHb, 1e-6)) {
+        std::cout << "vpHomography::ransac() without normalization failed" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Not enough inliers to reach the consensus
+    {
+      generatePoints(aHb, n, 0.6, rand, xb, yb, xa, ya, isOutlier);
+      vpHomography aHb_est;
+      double residual = 0.;
+      if (vpHomography::ransac(xb, yb, xa, ya, aHb_est, inliers, residual, (unsigned int)(0.5 * n), threshold)) {
+        std::cout << "vpHomography::ransac() should not reach the consensus" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Robust estimation with a small ratio of outliers
+    {
+      generatePoints(aHb, n, 0.1, rand, xb, yb, xa, ya, isOutlier);
+      vpHomography aHb_est;
+      double residual = 0.;
+      double t = vpTime::measureTimeMs();
+      vpHomography::robust(xb, yb, xa, ya, aHb_est, inliers, residual);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Computation time (ms) of robust() with " << n << " points: " << t << std::endl;
+      unsigned int nbBadInliers = 0;
+      for (unsigned int i = 0; i < n; i++) {
+        if (!isOutlier[i] && !inliers[i]) {
+          nbBadInliers++;
+        }
+      }
+      if (nbBadInliers > 0 || !compareHomography(aHb_est, aHb, 1e-4)) {
+        std::cout << "vpHomography::robust() failed, " << nbBadInliers << " inliers rejected" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::cout << "testHomographyRansac succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,235 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the Hamming distance matcher for binary descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testBinaryDescriptorMatcher.cpp
+
+  \brief Test vpBinaryDescriptorMatcher against a naive brute force matching
+  on random descriptors.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpBinaryDescriptorMatcher.h>
+
+namespace
+{
+const unsigned int descriptorSize = 32;
+
+unsigned int naiveDistance(const unsigned char *a, const unsigned char *b)
+{
+  static std::vector<unsigned int> nbBits;
+  if (nbBits.empty()) {
+    nbBits.resize(256, 0);
+    for (unsigned int v = 0; v < 256; v++) {
+      for (unsigned int x = v; x; x >>= 1) {
+        nbBits[v] += x & 1;
+      }
+    }
+  }
+
+  unsigned int d = 0;
+  for (unsigned int i = 0; i < descriptorSize; i++) {
+    d += nbBits[a[i] ^ b[i]];
+  }
+  return d;
+}
+
+// Best and second best train descriptors, ties broken by the lowest index
+void naiveKnn(const std::vector<unsigned char> &train, const unsigned char *query, unsigned int &idx1,
+              unsigned int &d1, unsigned int &idx2, unsigned int &d2)
+{
+  d1 = d2 = 1000;
+  idx1 = idx2 = 0;
+  unsigned int n = (unsigned int)(train.size() / descriptorSize);
+  for (unsigned int i = 0; i < n; i++) {
+    unsigned int d = naiveDistance(&train[i * descriptorSize], query);
+    if (d < d1) {
+      d2 = d1;
+      idx2 = idx1;
+      d1 = d;
+      idx1 = i;
+    } else if (d < d2) {
+      d2 = d;
+      idx2 = i;
+    }
+  }
+}
+
+bool checkKnn(vpBinaryDescriptorMatcher &matcher, const std::vector<unsigned char> &train,
+              const std::vector<unsigned char> &queries, double &time)
+{
+  unsigned int nbQueries = (unsigned int)(queries.size() / descriptorSize);
+  std::vector<std::vector<vpBinaryDescriptorMatcher::vpDescriptorMatch> > knn;
+  time = vpTime::measureTimeMs();
+  matcher.knnMatch(&queries[0], nbQueries, 0, 2, knn);
+  time = vpTime::measureTimeMs() - time;
+
+  for (unsigned int i = 0; i < nbQueries; i++) {
+    unsigned int idx1, d1, idx2, d2;
+    naiveKnn(train, &queries[i * descriptorSize], idx1, d1, idx2, d2);
+    if (knn[i].size() != 2 || knn[i][0].queryIdx != i || knn[i][0].trainIdx != idx1 || knn[i][0].distance != d1 ||
+        knn[i][1].trainIdx != idx2 || knn[i][1].distance != d2) {
+      std::cout << "Bad nearest neighbors for query " << i << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    srand(1234);
+    unsigned int nbTrain = 30000;
+    std::vector<unsigned char> train(nbTrain * descriptorSize);
+    for (size_t i = 0; i < train.size(); i++) {
+      train[i] = (unsigned char)(rand() % 256);
+    }
+
+    // The first queries are noisy copies of train descriptors, the last ones
+    // are random
+    unsigned int nbQueries = 400, nbNoisyQueries = 300;
+    std::vector<unsigned char> queries(nbQueries * descriptorSize);
+    std::vector<unsigned int> sourceIdx(nbNoisyQueries);
+    for (unsigned int i = 0; i < nbQueries; i++) {
+      unsigned char *q = &queries[i * descriptorSize];
+      if (i < nbNoisyQueries) {
+        sourceIdx[i] = (unsigned int)(rand() % nbTrain);
+        for (unsigned int j = 0; j < descriptorSize; j++) {
+          q[j] = train[sourceIdx[i] * descriptorSize + j];
+        }
+        unsigned int nbFlips = i % 40;
+        for (unsigned int j = 0; j < nbFlips; j++) {
+          unsigned int bit = (unsigned int)(rand() % (8 * descriptorSize));
+          q[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+        }
+      } else {
+        for (unsigned int j = 0; j < descriptorSize; j++) {
+          q[j] = (unsigned char)(rand() % 256);
+        }
+      }
+    }
+
+    if (vpBinaryDescriptorMatcher::hammingDistance(&train[0], &queries[0], descriptorSize) !=
+        naiveDistance(&train[0], &queries[0])) {
+      std::cout << "Bad Hamming distance" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    vpBinaryDescriptorMatcher matcher;
+    // Add the descriptors in two times with a non contiguous layout for the
+    // second part
+    unsigned int nbFirst = nbTrain / 3;
+    matcher.addTrainDescriptors(&train[0], nbFirst, descriptorSize);
+    std::vector<unsigned char> strided((nbTrain - nbFirst) * 2 * descriptorSize);
+    for (unsigned int i = nbFirst; i < nbTrain; i++) {
+      for (unsigned int j = 0; j < descriptorSize; j++) {
+        strided[(i - nbFirst) * 2 * descriptorSize + j] = train[i * descriptorSize + j];
+      }
+    }
+    matcher.addTrainDescriptors(&strided[0], nbTrain - nbFirst, descriptorSize, 2 * descriptorSize);
+
+    double t_brute_force = 0., t_hashing = 0.;
+    matcher.setMultiIndexHashing(false);
+    if (!checkKnn(matcher, train, queries, t_brute_force)) {
+      return EXIT_FAILURE;
+    }
+
+    matcher.setMultiIndexHashing(true, 1000);
+    matcher.train();
+    if (!matcher.isHashingUsed() || !checkKnn(matcher, train, queries, t_hashing)) {
+      return EXIT_FAILURE;
+    }
+    std::cout << "knnMatch() of " << nbQueries << " queries in " << nbTrain
+              << " descriptors (ms): brute force " << t_brute_force << ", multi-index hashing " << t_hashing
+              << std::endl;
+
+    // Filtered matches: only the queries with few flipped bits are kept
+    matcher.setRatioThreshold(0.7);
+    matcher.setMaxDistance(40);
+    std::vector<vpBinaryDescriptorMatcher::vpDescriptorMatch> matches, matches_brute_force;
+    t_hashing = vpTime::measureTimeMs();
+    matcher.match(&queries[0], nbQueries, 0, matches);
+    t_hashing = vpTime::measureTimeMs() - t_hashing;
+    matcher.setMultiIndexHashing(false);
+    t_brute_force = vpTime::measureTimeMs();
+    matcher.match(&queries[0], nbQueries, 0, matches_brute_force);
+    t_brute_force = vpTime::measureTimeMs() - t_brute_force;
+    matcher.setMultiIndexHashing(true, 1000);
+    std::cout << "match() with ratio test and maximal distance (ms): brute force " << t_brute_force
+              << ", multi-index hashing " << t_hashing << std::endl;
+    std::cout << "Matches kept with the ratio test: " << matches.size() << std::endl;
+    if (matches.size() != matches_brute_force.size()) {
+      std::cout << "The filtered matches depend on the multi-index hashing" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (matches.size() < nbNoisyQueries / 2) {
+      std::cout << "Not enough matches kept with the ratio test" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < matches.size(); i++) {
+      if (matches[i].queryIdx >= nbNoisyQueries || matches[i].trainIdx != sourceIdx[matches[i].queryIdx] ||
+          matches[i].distance > 40 || matches[i].queryIdx != matches_brute_force[i].queryIdx ||
+          matches[i].trainIdx != matches_brute_force[i].trainIdx) {
+        std::cout << "Bad match kept for query " << matches[i].queryIdx << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Cross check: two identical queries cannot be both kept
+    std::vector<unsigned char> twoQueries(2 * descriptorSize);
+    for (unsigned int j = 0; j < descriptorSize; j++) {
+      twoQueries[j] = twoQueries[descriptorSize + j] = train[5 * descriptorSize + j];
+    }
+    matcher.setRatioThreshold(0.);
+    matcher.setCrossCheck(true);
+    matcher.match(&twoQueries[0], 2, 0, matches);
+    if (matches.size() != 1 || matches[0].queryIdx != 0 || matches[0].trainIdx != 5 || matches[0].distance != 0) {
+      std::cout << "Bad cross check filtering" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testBinaryDescriptorMatcher succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
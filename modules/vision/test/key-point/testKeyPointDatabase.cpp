@@ -0,0 +1,295 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the memory-mapped keypoint database.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKeyPointDatabase.cpp
+
+  \brief Write a vpKeyPointDatabase, map it and select the keypoints of some
+  classes and images. With OpenCV, load it in vpKeyPoint and check that the
+  train descriptors keep the database open.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpKeyPoint.h>
+#include <visp3/vision/vpKeyPointDatabase.h>
+
+namespace
+{
+const unsigned int descriptorSize = 61; // AKAZE like, not a multiple of 16
+
+// Check the keypoint stored at \e index in the database against the source
+// keypoint \e src
+bool checkKeyPoint(const vpKeyPointDatabase &db, unsigned int index,
+                   const std::vector<vpKeyPointDatabase::vpKeyPointRecord> &keyPoints,
+                   const std::vector<unsigned char> &descriptors, const std::vector<float> &points, unsigned int src)
+{
+  const vpKeyPointDatabase::vpKeyPointRecord &a = db.getKeyPoints()[index], &b = keyPoints[src];
+  if (a.u != b.u || a.v != b.v || a.size != b.size || a.angle != b.angle || a.response != b.response ||
+      a.octave != b.octave || a.classId != b.classId || a.imageId != b.imageId) {
+    std::cout << "Bad keypoint " << index << std::endl;
+    return false;
+  }
+  if (memcmp(db.getDescriptors() + index * db.getDescriptorStep(), &descriptors[src * descriptorSize],
+             descriptorSize) != 0) {
+    std::cout << "Bad descriptor " << index << std::endl;
+    return false;
+  }
+  for (unsigned int j = 0; j < 3; j++) {
+    if (db.getPoints()[3 * index + j] != points[3 * src + j]) {
+      std::cout << "Bad 3D point " << index << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+#if defined(_WIN32)
+    std::string opath = "C:/temp";
+#else
+    std::string opath = "/tmp";
+#endif
+    if (!vpIoTools::checkDirectory(opath)) {
+      vpIoTools::makeDirectory(opath);
+    }
+    std::string filename = vpIoTools::createFilePath(opath, "testKeyPointDatabase.bin");
+
+    // Keypoints of 4 classes seen in 10 images, given in a shuffled order
+    srand(1234);
+    unsigned int nbKeyPoints = 20000, nbClasses = 4, nbImages = 10;
+    std::vector<vpKeyPointDatabase::vpKeyPointRecord> keyPoints(nbKeyPoints);
+    std::vector<unsigned char> descriptors(nbKeyPoints * descriptorSize);
+    std::vector<float> points(3 * nbKeyPoints);
+    for (unsigned int i = 0; i < nbKeyPoints; i++) {
+      vpKeyPointDatabase::vpKeyPointRecord &kpt = keyPoints[i];
+      kpt.u = (float)(rand() % 640);
+      kpt.v = (float)(rand() % 480);
+      kpt.size = 31.f;
+      kpt.angle = (float)(rand() % 360);
+      kpt.response = (float)rand() / RAND_MAX;
+      kpt.octave = (int)(i % 8);
+      kpt.classId = (int)(rand() % nbClasses);
+      kpt.imageId = (int)(rand() % nbImages);
+      for (unsigned int j = 0; j < descriptorSize; j++) {
+        descriptors[i * descriptorSize + j] = (unsigned char)(rand() % 256);
+      }
+      for (unsigned int j = 0; j < 3; j++) {
+        points[3 * i + j] = (float)rand() / RAND_MAX;
+      }
+    }
+    std::map<int, std::string> imagePaths;
+    imagePaths[3] = "train_image_003.png";
+    imagePaths[7] = "train_image_007.png";
+
+    double t = vpTime::measureTimeMs();
+    vpKeyPointDatabase::write(filename, keyPoints, &descriptors[0], descriptorSize, descriptorSize, descriptorSize, 0,
+                              &points[0], imagePaths);
+    std::cout << "Write " << nbKeyPoints << " keypoints (ms): " << vpTime::measureTimeMs() - t << std::endl;
+
+    vpKeyPointDatabase db;
+    t = vpTime::measureTimeMs();
+    db.open(filename);
+    std::cout << "Open the database (ms): " << vpTime::measureTimeMs() - t << ", memory-mapped: " << db.isMapped()
+              << std::endl;
+
+    if (db.getNbKeyPoints() != nbKeyPoints || db.getDescriptorRowSize() != descriptorSize ||
+        db.getDescriptorStep() % 16 != 0 || !db.has3DPoints() || db.getNbGroups() != nbClasses * nbImages ||
+        (size_t)db.getDescriptors() % 16 != 0 || db.getImagePath(7) != "train_image_007.png" ||
+        !db.getImagePath(5).empty()) {
+      std::cout << "Bad database header" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The keypoints of a group keep their relative order
+    for (unsigned int g = 0; g < db.getNbGroups(); g++) {
+      const vpKeyPointDatabase::vpGroupRecord &group = db.getGroups()[g];
+      if (g > 0 && (group.classId < db.getGroups()[g - 1].classId ||
+                    group.first != db.getGroups()[g - 1].first + db.getGroups()[g - 1].count)) {
+        std::cout << "Groups are not sorted" << std::endl;
+        return EXIT_FAILURE;
+      }
+      unsigned int src = 0;
+      for (unsigned int i = group.first; i < group.first + group.count; i++, src++) {
+        while (keyPoints[src].classId != group.classId || keyPoints[src].imageId != group.imageId) {
+          src++;
+        }
+        if (!checkKeyPoint(db, i, keyPoints, descriptors, points, src)) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Partial selections
+    std::vector<std::pair<unsigned int, unsigned int> > ranges;
+    std::vector<int> classIds, imageIds;
+    classIds.push_back(2);
+    db.getRanges(classIds, imageIds, ranges);
+    unsigned int nbSelected = 0;
+    for (unsigned int i = 0; i < nbKeyPoints; i++) {
+      nbSelected += keyPoints[i].classId == 2 ? 1 : 0;
+    }
+    if (ranges.size() != 1 || ranges[0].second != nbSelected) {
+      std::cout << "Bad selection of a class" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    imageIds.push_back(3);
+    imageIds.push_back(7);
+    classIds.push_back(0);
+    db.getRanges(classIds, imageIds, ranges);
+    nbSelected = 0;
+    for (unsigned int i = 0; i < nbKeyPoints; i++) {
+      nbSelected += (keyPoints[i].classId == 2 || keyPoints[i].classId == 0) &&
+                            (keyPoints[i].imageId == 3 || keyPoints[i].imageId == 7)
+                        ? 1
+                        : 0;
+    }
+    unsigned int nbInRanges = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      for (unsigned int j = ranges[i].first; j < ranges[i].first + ranges[i].second; j++, nbInRanges++) {
+        const vpKeyPointDatabase::vpKeyPointRecord &kpt = db.getKeyPoints()[j];
+        if ((kpt.classId != 2 && kpt.classId != 0) || (kpt.imageId != 3 && kpt.imageId != 7)) {
+          std::cout << "Bad keypoint selected" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    if (ranges.size() != 4 || nbInRanges != nbSelected) {
+      std::cout << "Bad selection of classes and images" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A second instance shares the same file
+    vpKeyPointDatabase db2;
+    db2.open(filename);
+    if (db2.getNbKeyPoints() != nbKeyPoints ||
+        memcmp(db2.getDescriptors(), db.getDescriptors(), nbKeyPoints * db.getDescriptorStep()) != 0) {
+      std::cout << "Bad second instance" << std::endl;
+      return EXIT_FAILURE;
+    }
+    db.close();
+    db2.close();
+
+    // A truncated database is rejected
+    {
+      std::ifstream in(filename.c_str(), std::ifstream::binary);
+      std::vector<char> content(4096);
+      in.read(&content[0], (std::streamsize)content.size());
+      std::string truncated = vpIoTools::createFilePath(opath, "testKeyPointDatabase_truncated.bin");
+      std::ofstream out(truncated.c_str(), std::ofstream::binary);
+      out.write(&content[0], (std::streamsize)content.size());
+      out.close();
+      try {
+        db.open(truncated);
+        std::cout << "A truncated database should not be opened" << std::endl;
+        return EXIT_FAILURE;
+      } catch (const vpException &e) {
+        std::cout << "Truncated database: " << e.getStringMessage() << std::endl;
+      }
+      vpIoTools::remove(truncated);
+    }
+
+#if (VISP_HAVE_OPENCV_VERSION >= 0x030000)
+    // The descriptors of a single class are used in place by vpKeyPoint
+    {
+      std::string cvFilename = vpIoTools::createFilePath(opath, "testKeyPointDatabase_cv.bin");
+      vpKeyPointDatabase::write(cvFilename, keyPoints, &descriptors[0], descriptorSize, descriptorSize,
+                                descriptorSize, CV_8U, &points[0]);
+      db.open(cvFilename);
+      std::vector<int> cvClassIds(1, 2);
+      db.getRanges(cvClassIds, std::vector<int>(), ranges);
+
+      vpKeyPoint keypoint("ORB", "ORB", "BruteForce-Hamming");
+      keypoint.loadLearningDatabase(cvFilename, cvClassIds);
+      cv::Mat trainDescriptors = keypoint.getTrainDescriptors();
+      if (ranges.size() != 1 || trainDescriptors.rows != (int)ranges[0].second ||
+          trainDescriptors.step[0] != db.getDescriptorStep()) {
+        std::cout << "The descriptors of a class are not used in place" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // The copy of the train descriptors keeps the database open after
+      // the reset, and closes it when it is released
+      keypoint.reset();
+      for (int i = 0; i < trainDescriptors.rows; i++) {
+        const unsigned char *row = db.getDescriptors() + (ranges[0].first + (unsigned int)i) * db.getDescriptorStep();
+        if (memcmp(trainDescriptors.ptr(i), row, descriptorSize) != 0) {
+          std::cout << "Bad train descriptor " << i << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      trainDescriptors.release();
+
+      // The descriptors of several classes are copied
+      vpKeyPoint keypoint2("ORB", "ORB", "BruteForce-Hamming");
+      cvClassIds.push_back(0);
+      keypoint2.loadLearningDatabase(cvFilename, cvClassIds);
+      trainDescriptors = keypoint2.getTrainDescriptors();
+      db.getRanges(cvClassIds, std::vector<int>(), ranges);
+      if (ranges.size() != 2 || trainDescriptors.rows != (int)(ranges[0].second + ranges[1].second) ||
+          trainDescriptors.step[0] != descriptorSize) {
+        std::cout << "Bad copy of the descriptors of several classes" << std::endl;
+        return EXIT_FAILURE;
+      }
+      trainDescriptors.release();
+      keypoint2.reset();
+
+      db.close();
+      // The file can only be removed on Windows when no mapping is left
+      if (!vpIoTools::remove(cvFilename)) {
+        std::cout << "The database is still open" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+#endif
+
+    vpIoTools::remove(filename);
+    std::cout << "testKeyPointDatabase succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,158 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the spatial index of the predicted keypoint locations.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKeyPointPrediction.cpp
+
+  \brief Test the regions of interest and the candidate search of
+  vpKeyPointPrediction.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpKeyPointPrediction.h>
+
+int main()
+{
+  try {
+    // Predicted locations of an object covering the center of a 1080p image,
+    // a few of them being outside the image
+    srand(1234);
+    unsigned int width = 1920, height = 1080, nbPredictions = 5000;
+    double radius = 15.;
+    std::vector<double> u(nbPredictions), v(nbPredictions);
+    std::vector<unsigned int> trainIndexes(nbPredictions);
+    for (unsigned int i = 0; i < nbPredictions; i++) {
+      u[i] = 700. + (rand() % 50000) / 100.;
+      v[i] = 300. + (rand() % 40000) / 100.;
+      trainIndexes[i] = 3 * i;
+    }
+    u[0] = -10.;
+    u[1] = -40.;
+    v[2] = height + 5.;
+
+    vpKeyPointPrediction prediction(radius, 32);
+    prediction.setPredictions(width, height, u, v, trainIndexes);
+    if (prediction.getNbPredictions() != nbPredictions - 1) {
+      std::cout << "Bad number of predictions: " << prediction.getNbPredictions() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The core regions are disjoint and cover the neighborhood of the
+    // predicted locations
+    unsigned int overlap = 20;
+    std::vector<vpKeyPointTiling::vpTile> rois;
+    double t = vpTime::measureTimeMs();
+    prediction.computeRois(overlap, rois);
+    t = vpTime::measureTimeMs() - t;
+    std::vector<unsigned int> count((size_t)width * height, 0);
+    size_t area = 0;
+    for (size_t r = 0; r < rois.size(); r++) {
+      const vpKeyPointTiling::vpTile &roi = rois[r];
+      int o = (int)overlap;
+      if (roi.coreLeft >= roi.coreRight || roi.coreTop >= roi.coreBottom || roi.left != std::max(roi.coreLeft - o, 0) ||
+          roi.right != std::min(roi.coreRight + o, (int)width) || roi.top != std::max(roi.coreTop - o, 0) ||
+          roi.bottom != std::min(roi.coreBottom + o, (int)height)) {
+        std::cout << "Bad region of interest " << r << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (int y = roi.coreTop; y < roi.coreBottom; y++) {
+        for (int x = roi.coreLeft; x < roi.coreRight; x++) {
+          count[(size_t)y * width + x]++;
+        }
+      }
+      area += (size_t)(roi.right - roi.left) * (roi.bottom - roi.top);
+    }
+    for (unsigned int i = 0; i < nbPredictions; i++) {
+      for (int y = std::max((int)(v[i] - radius), 0); y < std::min((int)(v[i] + radius), (int)height); y++) {
+        for (int x = std::max((int)(u[i] - radius), 0); x < std::min((int)(u[i] + radius), (int)width); x++) {
+          if (count[(size_t)y * width + x] != 1) {
+            std::cout << "Pixel (" << x << ", " << y << ") is covered " << count[(size_t)y * width + x]
+                      << " times" << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+    std::cout << rois.size() << " regions of interest computed in " << t << " ms, "
+              << 100. * area / ((double)width * height) << "% of the image" << std::endl;
+    if (area > (size_t)width * height / 4) {
+      std::cout << "The regions of interest are too large" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Candidates against an exhaustive search
+    std::vector<unsigned int> candidates, expected;
+    t = vpTime::measureTimeMs();
+    size_t nbCandidates = 0;
+    for (unsigned int q = 0; q < 2000; q++) {
+      double qu = (rand() % 200000) / 100. - 40., qv = (rand() % 120000) / 100. - 40.;
+      prediction.getCandidates(qu, qv, candidates);
+      nbCandidates += candidates.size();
+      expected.clear();
+      for (unsigned int i = 0; i < nbPredictions; i++) {
+        if (i != 1 && (u[i] - qu) * (u[i] - qu) + (v[i] - qv) * (v[i] - qv) <= radius * radius) {
+          expected.push_back(trainIndexes[i]);
+        }
+      }
+      std::sort(candidates.begin(), candidates.end());
+      if (candidates != expected) {
+        std::cout << "Bad candidates for (" << qu << ", " << qv << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    std::cout << "2000 candidate searches (ms): " << vpTime::measureTimeMs() - t << ", " << nbCandidates
+              << " candidates" << std::endl;
+
+    prediction.clear();
+    prediction.computeRois(overlap, rois);
+    prediction.getCandidates(u[10], v[10], candidates);
+    if (!rois.empty() || !candidates.empty()) {
+      std::cout << "The predictions are not cleared" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testKeyPointPrediction succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the tiling used for parallel keypoint detection.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testKeyPointTiling.cpp
+
+  \brief Test the tiles, the per tile selection and the non-maximum
+  suppression of vpKeyPointTiling. With OpenCV, test the tiled detection and
+  extraction of vpKeyPoint with one and several threads.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/vision/vpKeyPoint.h>
+#include <visp3/vision/vpKeyPointTiling.h>
+
+namespace
+{
+bool checkTiles(const vpKeyPointTiling &tiling, unsigned int width, unsigned int height)
+{
+  std::vector<vpKeyPointTiling::vpTile> tiles;
+  tiling.computeTiles(width, height, tiles);
+  std::vector<unsigned int> count(width * height, 0);
+  int overlap = (int)tiling.getOverlap();
+  for (size_t t = 0; t < tiles.size(); t++) {
+    const vpKeyPointTiling::vpTile &tile = tiles[t];
+    if (tile.left != std::max(tile.coreLeft - overlap, 0) || tile.top != std::max(tile.coreTop - overlap, 0) ||
+        tile.right != std::min(tile.coreRight + overlap, (int)width) ||
+        tile.bottom != std::min(tile.coreBottom + overlap, (int)height) || tile.coreLeft >= tile.coreRight ||
+        tile.coreTop >= tile.coreBottom) {
+      std::cout << "Bad tile " << t << std::endl;
+      return false;
+    }
+    for (int v = tile.coreTop; v < tile.coreBottom; v++) {
+      for (int u = tile.coreLeft; u < tile.coreRight; u++) {
+        count[(size_t)v * width + (size_t)u]++;
+      }
+    }
+  }
+  for (size_t i = 0; i < count.size(); i++) {
+    if (count[i] != 1) {
+      std::cout << "The core regions are not a partition of a " << width << "x" << height << " image" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Greedy suppression in quadratic time
+void naiveNms(const std::vector<vpKeyPointTiling::vpTileKeyPoint> &keyPoints, double radius,
+              std::vector<unsigned int> &kept)
+{
+  std::vector<std::pair<float, unsigned int> > order;
+  for (unsigned int i = 0; i < keyPoints.size(); i++) {
+    // Decreasing response then increasing index
+    order.push_back(std::make_pair(-keyPoints[i].response, i));
+  }
+  std::sort(order.begin(), order.end());
+  kept.clear();
+  for (size_t k = 0; k < order.size(); k++) {
+    const vpKeyPointTiling::vpTileKeyPoint &a = keyPoints[order[k].second];
+    bool suppressed = false;
+    for (size_t j = 0; j < kept.size() && !suppressed; j++) {
+      const vpKeyPointTiling::vpTileKeyPoint &b = keyPoints[kept[j]];
+      suppressed = (a.u - b.u) * (a.u - b.u) + (a.v - b.v) * (a.v - b.v) < radius * radius;
+    }
+    if (!suppressed) {
+      kept.push_back(order[k].second);
+    }
+  }
+  std::sort(kept.begin(), kept.end());
+}
+}
+
+int main()
+{
+  try {
+    vpKeyPointTiling tiling(4, 3, 16);
+    if (!checkTiles(tiling, 640, 480) || !checkTiles(tiling, 101, 37) || !checkTiles(tiling, 3, 2)) {
+      return EXIT_FAILURE;
+    }
+
+    // Keypoints concentrated in the top left corner of a 4K image
+    srand(1234);
+    unsigned int width = 3840, height = 2160;
+    std::vector<vpKeyPointTiling::vpTileKeyPoint> keyPoints(20000);
+    for (size_t i = 0; i < keyPoints.size(); i++) {
+      bool textured = i < keyPoints.size() * 3 / 4;
+      keyPoints[i].u = (float)(rand() % (textured ? width / 4 : width)) + 0.5f;
+      keyPoints[i].v = (float)(rand() % (textured ? height / 3 : height)) + 0.5f;
+      keyPoints[i].response = (float)(rand() % 1000);
+    }
+
+    // Per tile budget
+    tiling.setMaxKeyPointsPerTile(100);
+    std::vector<vpKeyPointTiling::vpTile> tiles;
+    tiling.computeTiles(width, height, tiles);
+    std::vector<unsigned int> selected;
+    unsigned int nbSelected = 0;
+    for (size_t t = 0; t < tiles.size(); t++) {
+      const vpKeyPointTiling::vpTile &tile = tiles[t];
+      tiling.selectKeyPoints(tile, keyPoints, selected);
+
+      std::vector<float> responses;
+      for (size_t i = 0; i < keyPoints.size(); i++) {
+        if (keyPoints[i].u >= tile.coreLeft && keyPoints[i].u < tile.coreRight && keyPoints[i].v >= tile.coreTop &&
+            keyPoints[i].v < tile.coreBottom) {
+          responses.push_back(keyPoints[i].response);
+        }
+      }
+      std::sort(responses.begin(), responses.end(), std::greater<float>());
+      if (selected.size() != std::min<size_t>(responses.size(), 100)) {
+        std::cout << "Bad number of keypoints selected in tile " << t << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < selected.size(); i++) {
+        if (keyPoints[selected[i]].response != responses[i]) {
+          std::cout << "Bad keypoint selected in tile " << t << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      nbSelected += (unsigned int)selected.size();
+    }
+    std::cout << nbSelected << " keypoints selected in " << tiles.size() << " tiles" << std::endl;
+
+    // Non-maximum suppression
+    tiling.setNmsRadius(10.);
+    std::vector<unsigned int> kept, keptNaive;
+    double t = vpTime::measureTimeMs();
+    tiling.nonMaximumSuppression(keyPoints, kept);
+    t = vpTime::measureTimeMs() - t;
+    naiveNms(keyPoints, 10., keptNaive);
+    std::cout << "Non-maximum suppression of " << keyPoints.size() << " keypoints (ms): " << t << ", "
+              << kept.size() << " kept" << std::endl;
+    if (kept != keptNaive) {
+      std::cout << "The non-maximum suppression differs from the greedy one" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Duplicates found by two tiles are merged
+    std::vector<vpKeyPointTiling::vpTileKeyPoint> duplicates(2, keyPoints[0]);
+    duplicates[1].u += 0.5f;
+    duplicates[1].response += 1.f;
+    tiling.nonMaximumSuppression(duplicates, kept);
+    if (kept.size() != 1 || kept[0] != 1) {
+      std::cout << "Duplicates are not merged" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    tiling.setNmsRadius(0.);
+    tiling.nonMaximumSuppression(duplicates, kept);
+    if (kept.size() != 2) {
+      std::cout << "The suppression should be disabled" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+#if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
+    // Tiled detection and extraction in a noisy checkerboard
+    {
+      vpImage<unsigned char> I(480, 640);
+      for (unsigned int i = 0; i < I.getHeight(); i++) {
+        for (unsigned int j = 0; j < I.getWidth(); j++) {
+          I[i][j] = (unsigned char)(((i / 24 + j / 24) % 2 ? 40 : 200) + rand() % 30);
+        }
+      }
+
+      vpKeyPoint keypoint("FAST", "ORB", "BruteForce-Hamming");
+      keypoint.setUseTiledDetection(true);
+      keypoint.getTiling().setNbTiles(4, 3);
+      keypoint.getTiling().setMaxKeyPointsPerTile(50);
+
+      std::vector<cv::KeyPoint> serialKeyPoints, parallelKeyPoints;
+      cv::Mat serialDescriptors, parallelDescriptors;
+      double elapsedTime;
+      keypoint.getTiling().setNbThreads(1);
+      keypoint.detect(I, serialKeyPoints, elapsedTime);
+      keypoint.extract(I, serialKeyPoints, serialDescriptors, elapsedTime);
+
+      keypoint.getTiling().setNbThreads(4);
+      t = vpTime::measureTimeMs();
+      keypoint.detect(I, parallelKeyPoints, elapsedTime);
+      keypoint.extract(I, parallelKeyPoints, parallelDescriptors, elapsedTime);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Tiled detection and extraction of " << parallelKeyPoints.size() << " keypoints (ms): " << t
+                << std::endl;
+
+      if (parallelKeyPoints.empty() || parallelKeyPoints.size() > 4 * 3 * 50 ||
+          parallelDescriptors.rows != (int)parallelKeyPoints.size()) {
+        std::cout << "Bad tiled detection or extraction" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (serialKeyPoints.size() != parallelKeyPoints.size()) {
+        std::cout << "The tiled detection depends on the number of threads" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (size_t i = 0; i < parallelKeyPoints.size(); i++) {
+        if (serialKeyPoints[i].pt.x != parallelKeyPoints[i].pt.x ||
+            serialKeyPoints[i].pt.y != parallelKeyPoints[i].pt.y ||
+            cv::norm(serialDescriptors.row((int)i), parallelDescriptors.row((int)i), cv::NORM_HAMMING) > 0) {
+          std::cout << "The tiled detection depends on the number of threads" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+#endif
+
+    std::cout << "testKeyPointTiling succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,191 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Compute the pose with the P3P and EPnP solvers and compare them with the
+ * Lagrange and Dementhon approaches.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPoseP3PEPnP.cpp
+
+  Compute the pose of planar and non planar objects with the P3P and EPnP
+  approaches, use them in a RANSAC scheme and compare their computation times
+  with the ones of the Lagrange and Dementhon approaches.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpPose.h>
+
+namespace
+{
+// Random points in a 0.2 meter box, or in the oZ=0 plane
+std::vector<vpPoint> generatePoints(vpUniRand &rng, unsigned int nb, bool planar, const vpHomogeneousMatrix &cMo)
+{
+  std::vector<vpPoint> points(nb);
+  for (unsigned int i = 0; i < nb; i++) {
+    double X = 0.2 * (rng() - 0.5), Y = 0.2 * (rng() - 0.5), Z = planar ? 0. : 0.2 * (rng() - 0.5);
+    points[i].setWorldCoordinates(X, Y, Z);
+    points[i].project(cMo);
+  }
+  return points;
+}
+
+bool comparePose(const vpHomogeneousMatrix &cMo_ref, const vpHomogeneousMatrix &cMo_est, double tolerance,
+                 const std::string &legend)
+{
+  vpHomogeneousMatrix cdMc = cMo_ref * cMo_est.inverse();
+  vpPoseVector error(cdMc);
+  bool fail = false;
+  for (unsigned int i = 0; i < 6; i++) {
+    if (std::fabs(error[i]) > tolerance || vpMath::isNaN(error[i])) {
+      fail = true;
+    }
+  }
+  if (fail) {
+    std::cout << legend << " is badly estimated, error: " << error.t() << std::endl;
+  }
+  return !fail;
+}
+
+double benchmark(const std::vector<vpPoint> &points, vpPose::vpPoseMethodType method, unsigned int nb_iter)
+{
+  vpPose pose;
+  pose.addPoints(points);
+  vpHomogeneousMatrix cMo;
+  double t = vpTime::measureTimeMs();
+  for (unsigned int i = 0; i < nb_iter; i++) {
+    pose.computePose(method, cMo);
+  }
+  return (vpTime::measureTimeMs() - t) / nb_iter;
+}
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(12345);
+    bool success = true;
+
+    // Accuracy on noise-free data
+    for (unsigned int trial = 0; trial < 50; trial++) {
+      vpHomogeneousMatrix cMo_ref(0.1 * (rng() - 0.5), 0.1 * (rng() - 0.5), 0.5 + 0.5 * rng(), vpMath::rad(30 * rng()),
+                                  vpMath::rad(30 * rng()), vpMath::rad(180 * (rng() - 0.5)));
+      for (int planar = 0; planar < 2; planar++) {
+        std::string type = planar ? " (planar)" : " (non planar)";
+
+        vpPose pose_p3p;
+        pose_p3p.addPoints(generatePoints(rng, 4, planar != 0, cMo_ref));
+        vpHomogeneousMatrix cMo;
+        pose_p3p.computePose(vpPose::P3P, cMo);
+        success = comparePose(cMo_ref, cMo, 1e-6, "P3P" + type) && success;
+
+        unsigned int sizes[3] = {6, 50, 500};
+        for (unsigned int i = 0; i < 3; i++) {
+          vpPose pose_epnp;
+          pose_epnp.addPoints(generatePoints(rng, sizes[i], planar != 0, cMo_ref));
+          pose_epnp.computePose(vpPose::EPNP, cMo);
+          success = comparePose(cMo_ref, cMo, 1e-6, "EPnP" + type) && success;
+          pose_epnp.computePose(vpPose::EPNP_VIRTUAL_VS, cMo);
+          success = comparePose(cMo_ref, cMo, 1e-6, "EPnP + VVS" + type) && success;
+        }
+      }
+    }
+    std::cout << "Accuracy on noise-free data: " << (success ? "ok" : "failed") << std::endl;
+
+    // RANSAC with P3P hypotheses and EPnP initialization on data with outliers
+    vpHomogeneousMatrix cMo_ref(0.02, -0.01, 0.6, vpMath::rad(10), vpMath::rad(-15), vpMath::rad(40));
+    std::vector<vpPoint> points = generatePoints(rng, 300, false, cMo_ref);
+    for (size_t i = 0; i < points.size(); i++) {
+      if (i % 3 == 0) {
+        // Outlier
+        points[i].set_x(points[i].get_x() + 0.01 + 0.02 * rng());
+        points[i].set_y(points[i].get_y() - 0.01 - 0.02 * rng());
+      }
+    }
+
+    double t_ransac[2];
+    for (int use_p3p = 0; use_p3p < 2; use_p3p++) {
+      vpPose pose;
+      pose.addPoints(points);
+      pose.setUseP3PRansac(use_p3p != 0);
+      pose.setRansacNbInliersToReachConsensus(200);
+      pose.setRansacThreshold(0.001);
+      pose.setRansacMaxTrials(1000);
+      vpHomogeneousMatrix cMo;
+      t_ransac[use_p3p] = vpTime::measureTimeMs();
+      bool found = pose.computePose(vpPose::RANSAC, cMo);
+      t_ransac[use_p3p] = vpTime::measureTimeMs() - t_ransac[use_p3p];
+      std::string legend = use_p3p ? "RANSAC (P3P + EPnP)" : "RANSAC (Lagrange / Dementhon)";
+      if (!found || pose.getRansacNbInliers() != 200) {
+        std::cout << legend << " found " << pose.getRansacNbInliers() << " inliers instead of 200" << std::endl;
+        success = false;
+      }
+      success = comparePose(cMo_ref, cMo, 1e-6, legend) && success;
+    }
+
+    // Benchmark
+    const unsigned int nb_iter = 200;
+    std::vector<vpPoint> points_4 = generatePoints(rng, 4, false, cMo_ref);
+    std::vector<vpPoint> points_100 = generatePoints(rng, 100, false, cMo_ref);
+    std::vector<vpPoint> points_1000 = generatePoints(rng, 1000, false, cMo_ref);
+    std::cout << "Mean computation time (ms):" << std::endl;
+    std::cout << "  4 points:    Lagrange " << benchmark(points_4, vpPose::LAGRANGE, nb_iter) << " Dementhon "
+              << benchmark(points_4, vpPose::DEMENTHON, nb_iter) << " P3P "
+              << benchmark(points_4, vpPose::P3P, nb_iter) << std::endl;
+    std::cout << "  100 points:  Lagrange " << benchmark(points_100, vpPose::LAGRANGE, nb_iter) << " Dementhon "
+              << benchmark(points_100, vpPose::DEMENTHON, nb_iter) << " EPnP "
+              << benchmark(points_100, vpPose::EPNP, nb_iter) << std::endl;
+    std::cout << "  1000 points: Lagrange " << benchmark(points_1000, vpPose::LAGRANGE, nb_iter / 10) << " Dementhon "
+              << benchmark(points_1000, vpPose::DEMENTHON, nb_iter / 10) << " EPnP "
+              << benchmark(points_1000, vpPose::EPNP, nb_iter / 10) << std::endl;
+    std::cout << "  RANSAC:      Lagrange / Dementhon " << t_ransac[0] << " P3P + EPnP " << t_ransac[1] << std::endl;
+
+    if (!success) {
+      std::cout << "Pose estimation with P3P and EPnP failed" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Pose estimation with P3P and EPnP succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
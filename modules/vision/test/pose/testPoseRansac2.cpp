@@ -45,6 +45,7 @@
 #include <visp3/core/vpIoTools.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpUniRand.h>
 #include <visp3/vision/vpPose.h>
 
 // Stanford Bunny Model points
@@ -1932,6 +1933,33 @@ bool testRansac(const std::vector<vpPoint> &bunnyModelPoints_original,
   double r_RANSAC_estimated_2 = ground_truth_pose.computeResidual(cMo_estimated_RANSAC_2);
   std::cout << "Corresponding residual (" << ransac_iterations << " iterations): " << r_RANSAC_estimated_2 << std::endl;
 
+  // Adaptive RANSAC with PROSAC sampling, the matching scores of the inliers
+  // being most of the time better than the ones of the outliers
+  vpPose pose_ransac_adaptive;
+  pose_ransac_adaptive.setRansacFilterFlag(vpPose::PREFILTER_DEGENERATE_POINTS);
+  pose_ransac_adaptive.addPoints(bunnyModelPoints_noisy);
+  vpUniRand uniform_rand;
+  std::vector<double> scores(bunnyModelPoints_noisy.size());
+  for (size_t i = 0; i < scores.size(); i++) {
+    scores[i] = vectorOfOutlierFlags[i] ? 0.6 * uniform_rand() : 0.3 + 0.7 * uniform_rand();
+  }
+  pose_ransac_adaptive.setRansacScores(scores);
+  pose_ransac_adaptive.setUseAdaptiveRansac(true);
+  pose_ransac_adaptive.setRansacNbInliersToReachConsensus(nbInlierToReachConsensus);
+  pose_ransac_adaptive.setRansacThreshold(threshold);
+  pose_ransac_adaptive.setRansacMaxTrials(10000);
+
+  vpHomogeneousMatrix cMo_estimated_RANSAC_adaptive;
+  t_RANSAC = vpTime::measureTimeMs();
+  pose_ransac_adaptive.computePose(vpPose::RANSAC, cMo_estimated_RANSAC_adaptive);
+  t_RANSAC = vpTime::measureTimeMs() - t_RANSAC;
+
+  std::cout << "\ncMo estimated with adaptive PROSAC on noisy data:\n" << cMo_estimated_RANSAC_adaptive << std::endl;
+  std::cout << "Computation time: " << t_RANSAC << " ms" << std::endl;
+
+  double r_RANSAC_estimated_adaptive = ground_truth_pose.computeResidual(cMo_estimated_RANSAC_adaptive);
+  std::cout << "Corresponding residual (adaptive PROSAC): " << r_RANSAC_estimated_adaptive << std::endl;
+
   pose.computePose(vpPose::DEMENTHON, cMo_dementhon);
   pose.computePose(vpPose::LAGRANGE, cMo_lagrange);
   r_dementhon = pose.computeResidual(cMo_dementhon);
@@ -2066,6 +2094,19 @@ bool testRansac(const std::vector<vpPoint> &bunnyModelPoints_original,
   }
 #endif
 
+  // Check inlier points returned by the adaptive PROSAC
+  std::vector<unsigned int> vectorOfFoundInlierIndex_adaptive = pose_ransac_adaptive.getRansacInlierIndex();
+  if (!checkInlierPoints(pose_ransac_adaptive.getRansacInliers(), vectorOfFoundInlierIndex_adaptive,
+                         bunnyModelPoints_noisy)) {
+    return false;
+  }
+
+  if (r_RANSAC_estimated_adaptive > threshold) {
+    std::cerr << "The pose estimated with the adaptive PROSAC method is badly estimated!" << std::endl;
+    std::cerr << "r_RANSAC_estimated_adaptive=" << r_RANSAC_estimated_adaptive << std::endl;
+    return false;
+  }
+
   if (r_RANSAC_estimated > threshold /*|| r_RANSAC_estimated_2 > threshold*/) {
     std::cerr << "The pose estimated with the RANSAC method is badly estimated!" << std::endl;
     std::cerr << "r_RANSAC_estimated=" << r_RANSAC_estimated << std::endl;
@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Compare the virtual visual servoing pose refinement with a reference
+ * implementation based on the pseudo inverse of the interaction matrix.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPoseVirtualVS.cpp
+
+  Check that vpPose::poseVirtualVS() and vpPose::poseVirtualVSrobust() give
+  the same pose as the classical virtual visual servoing scheme that computes
+  the pseudo inverse of the interaction matrix at each iteration, and
+  measure their computation time.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpRobust.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpPose.h>
+
+namespace
+{
+// Classical virtual visual servoing, robust or not
+void referenceVirtualVS(const std::vector<vpPoint> &points, vpHomogeneousMatrix &cMo, bool robust)
+{
+  const double lambda = 0.25, epsilon = 1e-8;
+  const int iterMax = 200;
+  unsigned int nb = (unsigned int)points.size();
+  vpMatrix L(2 * nb, 6), W(2 * nb, 2 * nb);
+  vpColVector error(2 * nb), res(nb), w(nb);
+  vpRobust estimator(nb);
+  estimator.setThreshold(0.);
+  w = 1;
+
+  double residu_1 = 1e8, r = 1e8 - 1;
+  int iter = 0;
+  vpPoint P;
+  while (robust ? std::fabs((residu_1 - r) * 1e12) > std::numeric_limits<double>::epsilon()
+                : std::fabs(residu_1 - r) > epsilon) {
+    residu_1 = r;
+    for (unsigned int k = 0; k < nb; k++) {
+      P = points[k];
+      P.track(cMo);
+      double x = P.get_x(), y = P.get_y(), Z = P.get_Z();
+      error[2 * k] = x - points[k].get_x();
+      error[2 * k + 1] = y - points[k].get_y();
+      double Lx[6] = {-1 / Z, 0, x / Z, x * y, -(1 + x * x), y};
+      double Ly[6] = {0, -1 / Z, y / Z, 1 + y * y, -x * y, -x};
+      for (unsigned int j = 0; j < 6; j++) {
+        L[2 * k][j] = Lx[j];
+        L[2 * k + 1][j] = Ly[j];
+      }
+      res[k] = vpMath::sqr(error[2 * k]) + vpMath::sqr(error[2 * k + 1]);
+    }
+    r = error.sumSquare();
+
+    vpColVector v;
+    if (robust) {
+      estimator.MEstimator(vpRobust::TUKEY, res, w);
+      for (unsigned int k = 0; k < nb; k++) {
+        W[2 * k][2 * k] = W[2 * k + 1][2 * k + 1] = w[k];
+      }
+      v = -lambda * (W * L).pseudoInverse(1e-6) * W * error;
+    } else {
+      v = -lambda * L.pseudoInverse(1e-16) * error;
+    }
+    cMo = vpExponentialMap::direct(v).inverse() * cMo;
+    if (iter++ > iterMax)
+      break;
+  }
+}
+
+bool comparePose(const vpHomogeneousMatrix &cMo_ref, const vpHomogeneousMatrix &cMo, double tolerance,
+                 const std::string &legend)
+{
+  vpPoseVector error(cMo_ref * cMo.inverse());
+  for (unsigned int i = 0; i < 6; i++) {
+    if (!(std::fabs(error[i]) <= tolerance)) {
+      std::cout << legend << " differs, error: " << error.t() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpUniRand rng(4321);
+    bool success = true;
+
+    for (unsigned int trial = 0; trial < 20; trial++) {
+      vpHomogeneousMatrix cMo_true(0.1 * (rng() - 0.5), 0.1 * (rng() - 0.5), 0.6 + 0.4 * rng(),
+                                   vpMath::rad(40 * (rng() - 0.5)), vpMath::rad(40 * (rng() - 0.5)),
+                                   vpMath::rad(180 * (rng() - 0.5)));
+      // Initial pose: perturbation of the true pose
+      vpHomogeneousMatrix cMo_init =
+          vpHomogeneousMatrix(0.02 * (rng() - 0.5), 0.02 * (rng() - 0.5), 0.05 * (rng() - 0.5),
+                              vpMath::rad(5 * (rng() - 0.5)), vpMath::rad(5 * (rng() - 0.5)),
+                              vpMath::rad(5 * (rng() - 0.5))) *
+          cMo_true;
+
+      // Noisy points, 10% of outliers
+      std::vector<vpPoint> points(50);
+      for (size_t i = 0; i < points.size(); i++) {
+        points[i].setWorldCoordinates(0.2 * (rng() - 0.5), 0.2 * (rng() - 0.5), 0.2 * (rng() - 0.5));
+        points[i].project(cMo_true);
+        double noise = (i % 10 == 0) ? 0.02 : 0.0005;
+        points[i].set_x(points[i].get_x() + noise * (rng() - 0.5));
+        points[i].set_y(points[i].get_y() + noise * (rng() - 0.5));
+      }
+
+      vpPose pose;
+      pose.addPoints(points);
+      for (int robust = 0; robust < 2; robust++) {
+        vpHomogeneousMatrix cMo_ref = cMo_init, cMo = cMo_init;
+        referenceVirtualVS(points, cMo_ref, robust != 0);
+        if (robust) {
+          pose.poseVirtualVSrobust(cMo);
+        } else {
+          pose.poseVirtualVS(cMo);
+        }
+        success = comparePose(cMo_ref, cMo, 1e-8, robust ? "Robust VVS" : "VVS") && success;
+
+      }
+    }
+    std::cout << "Comparison with the reference implementation: " << (success ? "ok" : "failed") << std::endl;
+
+    // Computation time for 200 points
+    std::vector<vpPoint> points(200);
+    vpHomogeneousMatrix cMo_true(0.01, 0.02, 0.8, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    vpHomogeneousMatrix cMo_init = vpHomogeneousMatrix(0.01, -0.01, 0.02, 0.02, 0.01, -0.02) * cMo_true;
+    for (size_t i = 0; i < points.size(); i++) {
+      points[i].setWorldCoordinates(0.2 * (rng() - 0.5), 0.2 * (rng() - 0.5), 0.2 * (rng() - 0.5));
+      points[i].project(cMo_true);
+    }
+    vpPose pose;
+    pose.addPoints(points);
+    const unsigned int nb_iter = 20;
+    double t_ref = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nb_iter; i++) {
+      vpHomogeneousMatrix cMo = cMo_init;
+      referenceVirtualVS(points, cMo, false);
+    }
+    t_ref = (vpTime::measureTimeMs() - t_ref) / nb_iter;
+    double t_vvs = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nb_iter; i++) {
+      vpHomogeneousMatrix cMo = cMo_init;
+      pose.poseVirtualVS(cMo);
+    }
+    t_vvs = (vpTime::measureTimeMs() - t_vvs) / nb_iter;
+    std::cout << "Mean computation time (ms) for 200 points: reference " << t_ref << " poseVirtualVS " << t_vvs
+              << std::endl;
+
+    if (!success) {
+      return EXIT_FAILURE;
+    }
+    std::cout << "testPoseVirtualVS succeed" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -39,6 +39,8 @@
 #ifndef vpFeatureLuminance_h
 #define vpFeatureLuminance_h
 
+#include <vector>
+
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpMatrix.h>
 #include <visp3/visual_features/vpBasicFeature.h>
@@ -50,15 +52,19 @@
   For more details see \cite Collewet08c.
 */
 
+#if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
   \class vpLuminance
   \brief Class that defines the luminance and gradient of a point
 
+  \deprecated This class is no more used by vpFeatureLuminance, that stores
+  the coordinates and the gradients of the pixels as separate arrays.
+
   \sa vpFeatureLuminance
 */
-class VISP_EXPORT vpLuminance
+class VISP_EXPORT vp_deprecated vpLuminance
 {
 public:
   double x, y;   // point coordinates (in meter)
@@ -67,6 +73,7 @@ public:
   double Z;      // pixel depth
 };
 #endif
+#endif
 
 /*!
   \class vpFeatureLuminance
@@ -74,6 +81,27 @@ public:
   \brief Class that defines the image luminance visual feature
 
   For more details see \cite Collewet08c.
+
+  Since every pixel is a feature, the interaction matrix has as many rows as
+  pixels. For the photometric visual servoing, computeNormalEquations()
+  rather accumulates \f$ {\bf L}^\top {\bf L} \f$ and \f$ {\bf L}^\top
+  {\bf e} \f$ directly from the luminance of the pixels, without forming the
+  interaction matrix, so that the control law only has to solve a 6 by 6
+  system:
+
+  \code
+  vpMatrix LtL, H(6, 6);
+  vpColVector Lte;
+  sI.buildFrom(I);
+  sI.computeNormalEquations(sId, LtL, Lte, true); // Interaction matrix at the desired position
+  for (unsigned int i = 0; i < 6; i++)
+    H[i][i] = mu * LtL[i][i];
+  vpColVector v = -lambda * (LtL + H).inverseByLU() * Lte;
+  \endcode
+
+  The pixels used by computeNormalEquations() can be subsampled (see
+  setSubsampling()) or restricted to the pixels with a high gradient (see
+  setGradientThreshold()).
 */
 
 class VISP_EXPORT vpFeatureLuminance : public vpBasicFeature
@@ -90,9 +118,20 @@ protected:
   //! Border size.
   unsigned int bord;
 
-  //! Store the image (as a vector with intensity and gradient I, Ix, Iy)
-  vpLuminance *pixInfo;
+  //! Metric coordinates of the pixels, computed from the camera parameters
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  //! Image gradient of the pixels, scaled by the focal lengths
+  std::vector<double> m_Ix;
+  std::vector<double> m_Iy;
   int firstTimeIn;
+  //! Step between the rows and the columns of the pixels used in the normal
+  //! equations
+  unsigned int m_step;
+  //! Minimal norm of the gradient of the pixels used in the normal equations
+  double m_gradientThreshold;
+  //! Normal equations of the rows of pixels
+  std::vector<double> m_rowSums;
 
 public:
   vpFeatureLuminance();
@@ -102,6 +141,9 @@ public:
 
   void buildFrom(vpImage<unsigned char> &I);
 
+  void computeNormalEquations(const vpFeatureLuminance &s_star, vpMatrix &LtL, vpColVector &Lte,
+                              bool desiredInteraction = false);
+
   void display(const vpCameraParameters &cam, const vpImage<unsigned char> &I, const vpColor &color = vpColor::green,
                unsigned int thickness = 1) const;
   void display(const vpCameraParameters &cam, const vpImage<vpRGBa> &I, const vpColor &color = vpColor::green,
@@ -114,6 +156,16 @@ public:
   //! Compute the error between a visual features and zero
   vpColVector error(const unsigned int select = FEATURE_ALL);
 
+  /*!
+    Return the minimal norm of the image gradient, in gray levels per pixel,
+    of the pixels used by computeNormalEquations().
+  */
+  inline double getGradientThreshold() const { return m_gradientThreshold; }
+  /*!
+    Return the step between the rows and the columns of the pixels used by
+    computeNormalEquations().
+  */
+  inline unsigned int getSubsampling() const { return m_step; }
   double get_Z() const;
 
   void init();
@@ -126,6 +178,8 @@ public:
   void print(const unsigned int select = FEATURE_ALL) const;
 
   void setCameraParameters(vpCameraParameters &_cam);
+  void setGradientThreshold(double threshold);
+  void setSubsampling(unsigned int step);
   void set_Z(const double Z);
 
 public:
@@ -158,9 +158,15 @@ int main()
 */
 class VISP_EXPORT vpFeatureMoment : public vpBasicFeature
 {
+private:
+  //! Indexes in the moment database of the moments read with getMoment(),
+  //! -1 when not searched yet
+  mutable std::vector<int> dependencyIndexes;
+
 protected:
   const vpMoment *moment;
   const vpMoment &getMoment() const { return *moment; }
+  const vpMoment &getMoment(unsigned int dependency, const char *type, bool &found) const;
   vpMomentDatabase &moments;
   vpFeatureMomentDatabase *featureMomentsDataBase;
   std::vector<vpMatrix> interaction_matrices;
@@ -203,7 +209,7 @@ public:
   */
   vpFeatureMoment(vpMomentDatabase &data_base, double A_ = 0.0, double B_ = 0.0, double C_ = 0.0,
                   vpFeatureMomentDatabase *featureMoments = NULL, unsigned int nbmatrices = 1)
-    : vpBasicFeature(), moment(NULL), moments(data_base), featureMomentsDataBase(featureMoments),
+    : vpBasicFeature(), dependencyIndexes(), moment(NULL), moments(data_base), featureMomentsDataBase(featureMoments),
       interaction_matrices(nbmatrices), A(A_), B(B_), C(C_), _name()
   {
   }
@@ -239,6 +245,7 @@ public:
   void update(double A, double B, double C);
 
   //@}
+  friend class vpFeatureMomentDatabase;
   friend VISP_EXPORT std::ostream &operator<<(std::ostream &os, const vpFeatureMoment &featM);
 };
 
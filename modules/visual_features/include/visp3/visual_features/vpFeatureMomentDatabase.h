@@ -47,9 +47,11 @@
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <vector>
 #include <visp3/core/vpConfig.h>
 
 class vpFeatureMoment;
+class vpMomentDatabase;
 class vpMomentObject;
 /*!
   \class vpFeatureMomentDatabase
@@ -154,6 +156,21 @@ int main()
   return 0;
 }
 \endcode
+
+  The database can also update the features itself with updateAll() and
+update(). In that case, the features a feature reads with get() while it is
+updated are recorded as its dependencies, and are updated before it. The
+moments used by the features are computed on demand by their moment database
+(see vpMomentDatabase::setLazyEvaluation()). With update(), only the requested
+feature and the features and moments it depends on are computed, at most once
+for a given plane and a given update of the moment database. In the example
+above, the moment and feature computations can be replaced by
+\code
+    mdb.updateAll(obj);
+    fmdb.update("vpFeatureMomentCInvariant", 0., 0., 1.);
+\endcode
+  which computes bm, gc, mc, ci, fmb, fmc and fci in the order of their
+dependencies.
 */
 class VISP_EXPORT vpFeatureMomentDatabase
 {
@@ -162,18 +179,42 @@ private:
     bool operator()(const char *a, const char *b) const { return std::strcmp(a, b) < 0; }
     char *operator=(const char *) { return NULL; } // Only to avoid a warning under Visual with /Wall flag
   };
-  std::map<const char *, vpFeatureMoment *, cmp_str> featureMomentsDataBase;
+  //! Index of the features in featureList from their name
+  std::map<const char *, unsigned int, cmp_str> featureMomentsDataBase;
+  //! Features in their registration order
+  std::vector<vpFeatureMoment *> featureList;
+  //! Indexes of the features each feature depends on
+  std::vector<std::vector<unsigned int> > dependencies;
+  //! Update for which each feature is updated
+  std::vector<unsigned int> updatedAt;
+  //! Indexes of the features being updated by the database
+  std::vector<unsigned int> updating;
+  //! Number of updates, starting at 1
+  unsigned int updateCount;
+  //! Plane of the current update
+  double planeA, planeB, planeC;
+  //! Moment database and its update count for the current update
+  const vpMomentDatabase *momentDatabase;
+  unsigned int momentUpdateCount;
+
   void add(vpFeatureMoment &featureMoment, char *name);
+  void startUpdate(const vpMomentDatabase &moments, double A, double B, double C);
+  void updateFeature(unsigned int index);
 
 public:
   /*!
     Default constructor.
   */
-  vpFeatureMomentDatabase() : featureMomentsDataBase() {}
+  vpFeatureMomentDatabase()
+    : featureMomentsDataBase(), featureList(), dependencies(), updatedAt(), updating(), updateCount(1), planeA(0.),
+      planeB(0.), planeC(0.), momentDatabase(NULL), momentUpdateCount(0)
+  {
+  }
   /*!
     Virtual destructor that does nothing.
   */
   virtual ~vpFeatureMomentDatabase() {}
+  void update(const char *type, double A = 0.0, double B = 0.0, double C = 1.0);
   virtual void updateAll(double A = 0.0, double B = 0.0, double C = 1.0);
 
   vpFeatureMoment &get(const char *type, bool &found);
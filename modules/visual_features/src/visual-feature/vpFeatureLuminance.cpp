@@ -36,6 +36,8 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpException.h>
 #include <visp3/core/vpHomogeneousMatrix.h>
@@ -46,6 +48,11 @@
 
 #include <visp3/visual_features/vpFeatureLuminance.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VISP_HAVE_SSE2 1
+#endif
+
 /*!
   \file vpFeatureLuminance.cpp
   \brief Class that defines the image luminance visual feature
@@ -53,6 +60,129 @@
   For more details see \cite Collewet08c.
 */
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Accumulate the upper triangle of L^T L in H (6x6, row major) and L^T e in
+// b over the selected pixels of a row
+void accumulateRow(const double *x, const double *y, const double *Ix, const double *Iy, double Zinv,
+                   const double *s, const double *s_star, unsigned int width, unsigned int step, double threshold2,
+                   double scaleU2, double scaleV2, double *H, double *b)
+{
+#if VISP_HAVE_SSE2
+  __m128d h00 = _mm_setzero_pd(), h01 = _mm_setzero_pd(), h02 = _mm_setzero_pd();
+  __m128d h10 = _mm_setzero_pd(), h11 = _mm_setzero_pd(), h12 = _mm_setzero_pd();
+  __m128d h21 = _mm_setzero_pd(), h22 = _mm_setzero_pd(), h31 = _mm_setzero_pd(), h32 = _mm_setzero_pd();
+  __m128d h42 = _mm_setzero_pd(), h52 = _mm_setzero_pd();
+  __m128d b0 = _mm_setzero_pd(), b1 = _mm_setzero_pd(), b2 = _mm_setzero_pd();
+#else
+  std::fill(H, H + 36, 0.);
+  std::fill(b, b + 6, 0.);
+#endif
+  for (unsigned int j = 0; j < width; j += step) {
+    if (threshold2 > 0. && Ix[j] * Ix[j] * scaleU2 + Iy[j] * Iy[j] * scaleV2 < threshold2) {
+      continue;
+    }
+    double xy = x[j] * y[j];
+    double L[6];
+    L[0] = Ix[j] * Zinv;
+    L[1] = Iy[j] * Zinv;
+    L[2] = -(x[j] * Ix[j] + y[j] * Iy[j]) * Zinv;
+    L[3] = -Ix[j] * xy - (1 + y[j] * y[j]) * Iy[j];
+    L[4] = (1 + x[j] * x[j]) * Ix[j] + Iy[j] * xy;
+    L[5] = Iy[j] * x[j] - Ix[j] * y[j];
+    double e = s[j] - s_star[j];
+#if VISP_HAVE_SSE2
+    __m128d l01 = _mm_loadu_pd(L), l23 = _mm_loadu_pd(L + 2), l45 = _mm_loadu_pd(L + 4);
+    __m128d v = _mm_set1_pd(L[0]);
+    h00 = _mm_add_pd(h00, _mm_mul_pd(l01, v));
+    h01 = _mm_add_pd(h01, _mm_mul_pd(l23, v));
+    h02 = _mm_add_pd(h02, _mm_mul_pd(l45, v));
+    v = _mm_set1_pd(L[1]);
+    h10 = _mm_add_pd(h10, _mm_mul_pd(l01, v));
+    h11 = _mm_add_pd(h11, _mm_mul_pd(l23, v));
+    h12 = _mm_add_pd(h12, _mm_mul_pd(l45, v));
+    v = _mm_set1_pd(L[2]);
+    h21 = _mm_add_pd(h21, _mm_mul_pd(l23, v));
+    h22 = _mm_add_pd(h22, _mm_mul_pd(l45, v));
+    v = _mm_set1_pd(L[3]);
+    h31 = _mm_add_pd(h31, _mm_mul_pd(l23, v));
+    h32 = _mm_add_pd(h32, _mm_mul_pd(l45, v));
+    h42 = _mm_add_pd(h42, _mm_mul_pd(l45, _mm_set1_pd(L[4])));
+    h52 = _mm_add_pd(h52, _mm_mul_pd(l45, _mm_set1_pd(L[5])));
+    v = _mm_set1_pd(e);
+    b0 = _mm_add_pd(b0, _mm_mul_pd(l01, v));
+    b1 = _mm_add_pd(b1, _mm_mul_pd(l23, v));
+    b2 = _mm_add_pd(b2, _mm_mul_pd(l45, v));
+#else
+    for (unsigned int r = 0; r < 6; r++) {
+      for (unsigned int c = r; c < 6; c++) {
+        H[r * 6 + c] += L[r] * L[c];
+      }
+      b[r] += L[r] * e;
+    }
+#endif
+  }
+#if VISP_HAVE_SSE2
+  std::fill(H, H + 36, 0.);
+  _mm_storeu_pd(H, h00);
+  _mm_storeu_pd(H + 2, h01);
+  _mm_storeu_pd(H + 4, h02);
+  _mm_storeu_pd(H + 6, h10);
+  _mm_storeu_pd(H + 8, h11);
+  _mm_storeu_pd(H + 10, h12);
+  _mm_storeu_pd(H + 14, h21);
+  _mm_storeu_pd(H + 16, h22);
+  _mm_storeu_pd(H + 20, h31);
+  _mm_storeu_pd(H + 22, h32);
+  _mm_storeu_pd(H + 28, h42);
+  _mm_storeu_pd(H + 34, h52);
+  _mm_storeu_pd(b, b0);
+  _mm_storeu_pd(b + 2, b1);
+  _mm_storeu_pd(b + 4, b2);
+#endif
+}
+
+// Derivative of n pixels along the rows (stride 1) or the columns (stride of
+// the image), with the filter of vpImageFilter::derivativeFilterX(), scaled
+// by a focal length
+void derivative(const unsigned char *p, int stride, unsigned int n, double scale, double *d)
+{
+  unsigned int k = 0;
+#if VISP_HAVE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c12 = _mm_set_epi16(913, 2047, 913, 2047, 913, 2047, 913, 2047);
+  const __m128i c3 = _mm_set_epi16(0, 112, 0, 112, 0, 112, 0, 112);
+  const __m128d norm = _mm_set1_pd(8418.), vscale = _mm_set1_pd(scale);
+  for (; k + 8 <= n; k += 8) {
+    // Differences of the pixels at 1, 2 and 3 pixels, weighted in 32 bits
+    __m128i diff[3];
+    for (int o = 1; o <= 3; o++) {
+      __m128i next = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + k + o * stride)), zero);
+      __m128i prev = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + k - o * stride)), zero);
+      diff[o - 1] = _mm_sub_epi16(next, prev);
+    }
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(diff[0], diff[1]), c12),
+                               _mm_madd_epi16(_mm_unpacklo_epi16(diff[2], zero), c3));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(diff[0], diff[1]), c12),
+                               _mm_madd_epi16(_mm_unpackhi_epi16(diff[2], zero), c3));
+    // Same operations as the scalar code for the same rounding
+    _mm_storeu_pd(d + k, _mm_mul_pd(vscale, _mm_div_pd(_mm_cvtepi32_pd(lo), norm)));
+    _mm_storeu_pd(d + k + 2, _mm_mul_pd(vscale, _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), norm)));
+    _mm_storeu_pd(d + k + 4, _mm_mul_pd(vscale, _mm_div_pd(_mm_cvtepi32_pd(hi), norm)));
+    _mm_storeu_pd(d + k + 6, _mm_mul_pd(vscale, _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), norm)));
+  }
+#endif
+  for (; k < n; k++) {
+    const unsigned char *c = p + k;
+    d[k] = scale * ((2047.0 * (c[stride] - c[-stride]) + 913.0 * (c[2 * stride] - c[-2 * stride]) +
+                     112.0 * (c[3 * stride] - c[-3 * stride])) /
+                    8418.0);
+  }
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Initialize the memory space requested for vpFeatureLuminance visual feature.
 */
@@ -86,11 +216,10 @@ void vpFeatureLuminance::init(unsigned int _nbr, unsigned int _nbc, double _Z)
   dim_s = (nbr - 2 * bord) * (nbc - 2 * bord);
 
   s.resize(dim_s);
-
-  if (pixInfo != NULL)
-    delete[] pixInfo;
-
-  pixInfo = new vpLuminance[dim_s];
+  m_x.resize(dim_s);
+  m_y.resize(dim_s);
+  m_Ix.resize(dim_s);
+  m_Iy.resize(dim_s);
 
   Z = _Z;
 }
@@ -98,7 +227,9 @@ void vpFeatureLuminance::init(unsigned int _nbr, unsigned int _nbc, double _Z)
 /*!
   Default constructor that build a visual feature.
 */
-vpFeatureLuminance::vpFeatureLuminance() : Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), cam()
+vpFeatureLuminance::vpFeatureLuminance()
+  : Z(1), nbr(0), nbc(0), bord(10), m_x(), m_y(), m_Ix(), m_Iy(), firstTimeIn(0), m_step(1), m_gradientThreshold(0.),
+    m_rowSums(), cam()
 {
   nbParameters = 1;
   dim_s = 0;
@@ -111,7 +242,8 @@ vpFeatureLuminance::vpFeatureLuminance() : Z(1), nbr(0), nbc(0), bord(10), pixIn
  Copy constructor.
  */
 vpFeatureLuminance::vpFeatureLuminance(const vpFeatureLuminance &f)
-  : vpBasicFeature(f), Z(1), nbr(0), nbc(0), bord(10), pixInfo(NULL), firstTimeIn(0), cam()
+  : vpBasicFeature(f), Z(1), nbr(0), nbc(0), bord(10), m_x(), m_y(), m_Ix(), m_Iy(), firstTimeIn(0), m_step(1),
+    m_gradientThreshold(0.), m_rowSums(), cam()
 {
   *this = f;
 }
@@ -126,23 +258,20 @@ vpFeatureLuminance &vpFeatureLuminance::operator=(const vpFeatureLuminance &f)
   nbc = f.nbc;
   bord = f.bord;
   firstTimeIn = f.firstTimeIn;
+  m_step = f.m_step;
+  m_gradientThreshold = f.m_gradientThreshold;
   cam = f.cam;
-  if (pixInfo)
-    delete[] pixInfo;
-  pixInfo = new vpLuminance[dim_s];
-  for (unsigned int i = 0; i < dim_s; i++)
-    pixInfo[i] = f.pixInfo[i];
+  m_x = f.m_x;
+  m_y = f.m_y;
+  m_Ix = f.m_Ix;
+  m_Iy = f.m_Iy;
   return (*this);
 }
 
 /*!
   Destructor that free allocated memory.
 */
-vpFeatureLuminance::~vpFeatureLuminance()
-{
-  if (pixInfo != NULL)
-    delete[] pixInfo;
-}
+vpFeatureLuminance::~vpFeatureLuminance() {}
 
 /*!
   Set the value of \f$ Z \f$ which represents the depth in the 3D camera
@@ -164,7 +293,45 @@ void vpFeatureLuminance::set_Z(const double Z_)
 */
 double vpFeatureLuminance::get_Z() const { return Z; }
 
-void vpFeatureLuminance::setCameraParameters(vpCameraParameters &_cam) { cam = _cam; }
+/*!
+  Set the camera parameters. The metric coordinates of the pixels are
+  computed again at the next call to buildFrom().
+*/
+void vpFeatureLuminance::setCameraParameters(vpCameraParameters &_cam)
+{
+  cam = _cam;
+  firstTimeIn = 0;
+}
+
+/*!
+  Restrict the pixels used by computeNormalEquations() to the pixels whose
+  image gradient is at least \e threshold gray levels per pixel. The
+  pixels with a low gradient hardly constrain the camera motion. By default
+  0, all the pixels are used.
+
+  \exception vpException::badValue : The threshold is negative.
+*/
+void vpFeatureLuminance::setGradientThreshold(double threshold)
+{
+  if (threshold < 0.) {
+    throw vpException(vpException::badValue, "Bad gradient threshold: %f", threshold);
+  }
+  m_gradientThreshold = threshold;
+}
+
+/*!
+  Use one pixel every \e step rows and every \e step columns in
+  computeNormalEquations(). By default 1, all the pixels are used.
+
+  \exception vpException::badValue : The step is null.
+*/
+void vpFeatureLuminance::setSubsampling(unsigned int step)
+{
+  if (step == 0) {
+    throw vpException(vpException::badValue, "Bad subsampling step: %u", step);
+  }
+  m_step = step;
+}
 
 /*!
 
@@ -173,47 +340,113 @@ void vpFeatureLuminance::setCameraParameters(vpCameraParameters &_cam) { cam = _
 
 void vpFeatureLuminance::buildFrom(vpImage<unsigned char> &I)
 {
-  unsigned int l = 0;
-  double Ix, Iy;
+  if (I.getHeight() < nbr || I.getWidth() < nbc) {
+    throw vpException(vpException::dimensionError, "Cannot build a luminance feature of size %ux%u from a %ux%u image",
+                      nbr, nbc, I.getHeight(), I.getWidth());
+  }
 
-  double px = cam.get_px();
-  double py = cam.get_py();
+  const unsigned int width = nbc - 2 * bord;
+  const int height = (int)(nbr - 2 * bord);
 
+  // The metric coordinates only depend on the camera parameters
   if (firstTimeIn == 0) {
     firstTimeIn = 1;
-    l = 0;
-    for (unsigned int i = bord; i < nbr - bord; i++) {
-      //   cout << i << endl ;
-      for (unsigned int j = bord; j < nbc - bord; j++) {
-        double x = 0, y = 0;
-        vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
-
-        pixInfo[l].x = x;
-        pixInfo[l].y = y;
-
-        pixInfo[l].Z = Z;
-
-        l++;
+    for (int i = 0; i < height; i++) {
+      size_t l = (size_t)i * width;
+      for (unsigned int j = 0; j < width; j++) {
+        vpPixelMeterConversion::convertPoint(cam, j + bord, i + bord, m_x[l + j], m_y[l + j]);
       }
     }
   }
 
-  l = 0;
-  for (unsigned int i = bord; i < nbr - bord; i++) {
-    //   cout << i << endl ;
-    for (unsigned int j = bord; j < nbc - bord; j++) {
-      // cout << dim_s <<" " <<l <<"  " <<i << "  " << j <<endl ;
-      Ix = px * vpImageFilter::derivativeFilterX(I, i, j);
-      Iy = py * vpImageFilter::derivativeFilterY(I, i, j);
+  const double px = cam.get_px();
+  const double py = cam.get_py();
+  const int stride = (int)I.getWidth();
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int i = 0; i < height; i++) {
+    size_t l = (size_t)i * width;
+    const unsigned char *row = I[(unsigned int)i + bord] + bord;
+    derivative(row, 1, width, px, &m_Ix[l]);
+    derivative(row, stride, width, py, &m_Iy[l]);
+    for (unsigned int j = 0; j < width; j++) {
+      s[(unsigned int)l + j] = row[j];
+    }
+  }
+}
+
+/*!
+  Compute the normal equations of the photometric visual servoing, that is
+  \f$ {\bf L}^\top {\bf L} \f$ and \f$ {\bf L}^\top (I - I^*) \f$,
+  without forming the interaction matrix \f$ \bf L \f$.
+
+  The sums are accumulated over the pixels selected by setSubsampling() and
+  setGradientThreshold(), in parallel over the rows of pixels when ViSP is
+  built with OpenMP. They are summed in the order of the rows so that the
+  result does not depend on the number of threads.
+
+  \param s_star : Desired visual feature, built from an image of the same
+  size.
+  \param LtL : The 6 by 6 matrix \f$ {\bf L}^\top {\bf L} \f$.
+  \param Lte : The 6 dimension vector \f$ {\bf L}^\top (I - I^*) \f$.
+  \param desiredInteraction : If true, the interaction matrix is computed
+  from the desired feature. The pixels are then also selected on their
+  gradient in the desired image, and \e LtL does not change from one
+  iteration to the other when the pixel selection is done by subsampling
+  only. Otherwise the interaction matrix is computed from the current
+  feature.
+
+  \exception vpException::dimensionError : The features do not have the same
+  size.
+*/
+void vpFeatureLuminance::computeNormalEquations(const vpFeatureLuminance &s_star, vpMatrix &LtL, vpColVector &Lte,
+                                                bool desiredInteraction)
+{
+  if (s_star.dim_s != dim_s) {
+    throw vpException(vpException::dimensionError, "Cannot compute the normal equations of features of size %u and %u",
+                      dim_s, s_star.dim_s);
+  }
 
-      // Calcul de Z
+  LtL.resize(6, 6);
+  Lte.resize(6);
+  if (dim_s == 0) {
+    return;
+  }
 
-      pixInfo[l].I = I[i][j];
-      s[l] = I[i][j];
-      pixInfo[l].Ix = Ix;
-      pixInfo[l].Iy = Iy;
+  const vpFeatureLuminance &f = desiredInteraction ? s_star : *this;
+  const double Zinv = 1. / f.Z;
+  const unsigned int width = nbc - 2 * bord, height = nbr - 2 * bord;
+  const int nbRows = (int)((height + m_step - 1) / m_step);
+  const size_t rowSize = 42;
+  m_rowSums.resize(nbRows * rowSize);
+  // The gradients are scaled by the focal lengths
+  const double scaleU2 = 1. / (cam.get_px() * cam.get_px()), scaleV2 = 1. / (cam.get_py() * cam.get_py());
+  const double threshold2 = m_gradientThreshold * m_gradientThreshold;
+
+#ifdef VISP_HAVE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (int r = 0; r < nbRows; r++) {
+    size_t offset = (size_t)r * m_step * width;
+    double *sums = &m_rowSums[(size_t)r * rowSize];
+    accumulateRow(&f.m_x[offset], &f.m_y[offset], &f.m_Ix[offset], &f.m_Iy[offset], Zinv, s.data + offset,
+                  s_star.s.data + offset, width, m_step, threshold2, scaleU2, scaleV2, sums, sums + 36);
+  }
 
-      l++;
+  for (int r = 0; r < nbRows; r++) {
+    const double *sums = &m_rowSums[(size_t)r * rowSize];
+    for (unsigned int i = 0; i < 6; i++) {
+      for (unsigned int j = i; j < 6; j++) {
+        LtL[i][j] += sums[i * 6 + j];
+      }
+      Lte[i] += sums[36 + i];
+    }
+  }
+  for (unsigned int i = 1; i < 6; i++) {
+    for (unsigned int j = 0; j < i; j++) {
+      LtL[i][j] = LtL[j][i];
     }
   }
 }
@@ -227,13 +460,13 @@ void vpFeatureLuminance::interaction(vpMatrix &L)
 {
   L.resize(dim_s, 6);
 
+  double Zinv = 1 / Z;
   for (unsigned int m = 0; m < L.getRows(); m++) {
-    double Ix = pixInfo[m].Ix;
-    double Iy = pixInfo[m].Iy;
+    double Ix = m_Ix[m];
+    double Iy = m_Iy[m];
 
-    double x = pixInfo[m].x;
-    double y = pixInfo[m].y;
-    double Zinv = 1 / pixInfo[m].Z;
+    double x = m_x[m];
+    double y = m_y[m];
 
     {
       L[m][0] = Ix * Zinv;
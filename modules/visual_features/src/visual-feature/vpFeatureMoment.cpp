@@ -253,6 +253,26 @@ void vpFeatureMoment::linkTo(vpFeatureMomentDatabase &featureMoments)
   featureMoments.add(*this, _name);
 }
 
+/*!
+  Retrieves a moment the feature depends on from the moment database. The
+  moment is searched by its name only at the first call, its index in the
+  database being kept for the next ones.
+
+  \param dependency : Number of the dependency, from 0 to the number of
+  moments read by the derived class minus one, that identifies \e type.
+  \param type : Name of the moment's class.
+  \param found : true if the moment's type exists in the database, false
+  otherwise.
+  \return Moment corresponding to \e type.
+*/
+const vpMoment &vpFeatureMoment::getMoment(unsigned int dependency, const char *type, bool &found) const
+{
+  if (dependency >= dependencyIndexes.size()) {
+    dependencyIndexes.resize(dependency + 1, -1);
+  }
+  return moments.get(type, dependencyIndexes[dependency], found);
+}
+
 void vpFeatureMoment::compute_interaction() {}
 
 vpFeatureMoment::~vpFeatureMoment() {}
@@ -61,7 +61,7 @@ void vpFeatureMomentAlpha::compute_interaction()
   bool found_FeatureMoment_centered;
 
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered)));
   vpFeatureMomentCentered &featureMomentCentered = (static_cast<vpFeatureMomentCentered &>(
       featureMomentsDataBase->get("vpFeatureMomentCentered", found_FeatureMoment_centered)));
 
@@ -97,9 +97,9 @@ void vpFeatureMomentAlpha::compute_interaction()
   bool found_moment_gravity;
 
   const vpMomentCentered &momentCentered =
-      static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered));
+      static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(1, "vpMomentGravityCenter", found_moment_gravity));
   const vpMomentObject &momentObject = moment->getObject();
 
   if (!found_moment_centered)
@@ -78,12 +78,12 @@ void vpFeatureMomentArea::compute_interaction()
     // Get Xg and Yg
     bool found_xgyg;
     const vpMomentGravityCenter &momentGravity =
-        static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_xgyg));
+        static_cast<const vpMomentGravityCenter &>(getMoment(0, "vpMomentGravityCenter", found_xgyg));
     if (!found_xgyg)
       throw vpException(vpException::notInitialized, "vpMomentGravityCenter not found");
 
     bool found_m00;
-    const vpMomentArea &areamoment = static_cast<const vpMomentArea &>(moments.get("vpMomentArea", found_m00));
+    const vpMomentArea &areamoment = static_cast<const vpMomentArea &>(getMoment(1, "vpMomentArea", found_m00));
     if (!found_m00)
       throw vpException(vpException::notInitialized, "vpMomentArea not found");
 
@@ -69,10 +69,10 @@ void vpFeatureMomentAreaNormalized::compute_interaction()
       featureMomentsDataBase->get("vpFeatureMomentBasic", found_featuremoment_basic)));
 
   const vpMomentCentered &momentCentered =
-      static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered));
+      static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered));
   const vpMomentObject &momentObject = moment->getObject();
   const vpMomentAreaNormalized &momentSurfaceNormalized = static_cast<const vpMomentAreaNormalized &>(
-      moments.get("vpMomentAreaNormalized", found_moment_surface_normalized));
+      getMoment(1, "vpMomentAreaNormalized", found_moment_surface_normalized));
   vpFeatureMomentCentered &featureMomentCentered = (static_cast<vpFeatureMomentCentered &>(
       featureMomentsDataBase->get("vpFeatureMomentCentered", found_FeatureMoment_centered)));
 
@@ -129,12 +129,12 @@ void vpFeatureMomentAreaNormalized::compute_interaction()
   bool found_moment_gravity;
 
   const vpMomentCentered &momentCentered =
-      static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered));
+      static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(2, "vpMomentGravityCenter", found_moment_gravity));
   const vpMomentObject &momentObject = moment->getObject();
   const vpMomentAreaNormalized &momentSurfaceNormalized = static_cast<const vpMomentAreaNormalized &>(
-      moments.get("vpMomentAreaNormalized", found_moment_surface_normalized));
+      getMoment(1, "vpMomentAreaNormalized", found_moment_surface_normalized));
 
   if (!found_moment_surface_normalized)
     throw vpException(vpException::notInitialized, "vpMomentAreaNormalized not found");
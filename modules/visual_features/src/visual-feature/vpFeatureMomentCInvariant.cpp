@@ -67,9 +67,9 @@ void vpFeatureMomentCInvariant::compute_interaction()
 
   const vpMomentObject &momentObject = moment->getObject();
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered)));
   const vpMomentCInvariant &momentCInvariant =
-      (static_cast<const vpMomentCInvariant &>(moments.get("vpMomentCInvariant", found_moment_cinvariant)));
+      (static_cast<const vpMomentCInvariant &>(getMoment(1, "vpMomentCInvariant", found_moment_cinvariant)));
   vpFeatureMomentCentered &featureMomentCentered = (static_cast<vpFeatureMomentCentered &>(
       featureMomentsDataBase->get("vpFeatureMomentCentered", found_FeatureMoment_centered)));
 
@@ -446,9 +446,9 @@ void vpFeatureMomentCInvariant::compute_interaction()
 
   const vpMomentObject &momentObject = moment->getObject();
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered)));
   const vpMomentCInvariant &momentCInvariant =
-      (static_cast<const vpMomentCInvariant &>(moments.get("vpMomentCInvariant", found_moment_cinvariant)));
+      (static_cast<const vpMomentCInvariant &>(getMoment(1, "vpMomentCInvariant", found_moment_cinvariant)));
 
   vpFeatureMomentCentered &featureMomentCentered = (static_cast<vpFeatureMomentCentered &>(
       featureMomentsDataBase->get("vpFeatureMomentCentered", found_FeatureMoment_centered)));
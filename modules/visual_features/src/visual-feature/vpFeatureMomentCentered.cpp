@@ -152,7 +152,7 @@ void vpFeatureMomentCentered::compute_interaction()
 
   bool found_moment_gravity;
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(0, "vpMomentGravityCenter", found_moment_gravity));
   if (!found_moment_gravity)
     throw vpException(vpException::notInitialized, "vpMomentGravityCenter not found");
   double xg = momentGravity.get()[0];
@@ -168,7 +168,7 @@ void vpFeatureMomentCentered::compute_interaction()
 
   bool found_moment_basic;
   const vpMomentBasic &momentbasic =
-      static_cast<const vpMomentBasic &>(moments.get("vpMomentBasic", found_moment_basic));
+      static_cast<const vpMomentBasic &>(getMoment(1, "vpMomentBasic", found_moment_basic));
   if (!found_moment_basic)
     throw vpException(vpException::notInitialized, "vpMomentBasic not found");
 
@@ -190,9 +190,9 @@ void vpFeatureMomentCentered::compute_interaction()
   bool found_moment_gravity;
 
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(2, "vpMomentCentered", found_moment_centered)));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(0, "vpMomentGravityCenter", found_moment_gravity));
 
   if (!found_moment_centered)
     throw vpException(vpException::notInitialized, "vpMomentCentered not found");
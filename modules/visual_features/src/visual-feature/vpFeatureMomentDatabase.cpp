@@ -36,12 +36,27 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <typeinfo>
 #include <visp3/core/vpConfig.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMomentDatabase.h>
 #include <visp3/visual_features/vpFeatureMoment.h>
 #include <visp3/visual_features/vpFeatureMomentDatabase.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+// Feature returned by vpFeatureMomentDatabase::get() for a type that is not
+// in the database
+vpMomentDatabase emptyMomentDatabase;
+vpMomentGenericFeature featureNotFound(emptyMomentDatabase, 0., 0., 0., NULL, NULL);
+}
+#endif
+
 /*!
   Add a moment and it's corresponding name to the database
   \param featureMoment : database for moment features
@@ -50,7 +65,13 @@
 */
 void vpFeatureMomentDatabase::add(vpFeatureMoment &featureMoment, char *name)
 {
-  featureMomentsDataBase.insert(std::pair<const char *, vpFeatureMoment *>((const char *)name, &featureMoment));
+  if (featureMomentsDataBase
+          .insert(std::pair<const char *, unsigned int>((const char *)name, (unsigned int)featureList.size()))
+          .second) {
+    featureList.push_back(&featureMoment);
+    dependencies.push_back(std::vector<unsigned int>());
+    updatedAt.push_back(0);
+  }
 }
 
 /*!
@@ -59,15 +80,121 @@ void vpFeatureMomentDatabase::add(vpFeatureMoment &featureMoment, char *name)
   \param found : true if the type string is found inside the database, false
   otherwise
 
+  When it is called by a feature updated by the database (see update()), the
+  feature is updated before being returned if it is not updated yet.
+
   \return the moment feature corresponding to the type string
 */
 vpFeatureMoment &vpFeatureMomentDatabase::get(const char *type, bool &found)
 {
-  std::map<const char *, vpFeatureMoment *, vpFeatureMomentDatabase::cmp_str>::const_iterator it =
+  std::map<const char *, unsigned int, vpFeatureMomentDatabase::cmp_str>::const_iterator it =
       featureMomentsDataBase.find(type);
 
   found = (it != featureMomentsDataBase.end());
-  return *(it->second);
+  if (!found) {
+    return featureNotFound;
+  }
+
+  unsigned int index = it->second;
+  if (!updating.empty()) {
+    std::vector<unsigned int> &deps = dependencies[updating.back()];
+    if (std::find(deps.begin(), deps.end(), index) == deps.end()) {
+      deps.push_back(index);
+    }
+    if (updatedAt[index] != updateCount) {
+      updateFeature(index);
+    }
+  }
+  return *featureList[index];
+}
+
+/*!
+  Starts a new update of the features when the plane or the update of the
+  moment database changed.
+*/
+void vpFeatureMomentDatabase::startUpdate(const vpMomentDatabase &moments, double A, double B, double C)
+{
+  if (&moments != momentDatabase || moments.getUpdateCount() != momentUpdateCount ||
+      std::fabs(A - planeA) > std::numeric_limits<double>::epsilon() ||
+      std::fabs(B - planeB) > std::numeric_limits<double>::epsilon() ||
+      std::fabs(C - planeC) > std::numeric_limits<double>::epsilon()) {
+    momentDatabase = &moments;
+    momentUpdateCount = moments.getUpdateCount();
+    planeA = A;
+    planeB = B;
+    planeC = C;
+    updateCount++;
+  }
+}
+
+/*!
+  Updates a feature after the features it depends on that are not updated
+  yet. The moments are computed on demand by the moment database.
+*/
+void vpFeatureMomentDatabase::updateFeature(unsigned int index)
+{
+  vpFeatureMoment &feature = *featureList[index];
+  if (std::find(updating.begin(), updating.end(), index) != updating.end()) {
+    updating.clear();
+    throw vpException(vpException::fatalError, "Cyclic dependency of the feature %s", feature.name());
+  }
+
+  bool outermost = updating.empty();
+  bool lazy = feature.moments.getLazyEvaluation();
+  feature.moments.setLazyEvaluation(true);
+  updating.push_back(index);
+  try {
+    for (size_t i = 0; i < dependencies[index].size(); i++) {
+      unsigned int dep = dependencies[index][i];
+      if (updatedAt[dep] != updateCount) {
+        updateFeature(dep);
+      }
+    }
+    // The feature reads its primitive moment only when it is not set
+    if (feature.momentName() != NULL) {
+      bool found;
+      feature.moments.get(feature.momentName(), found);
+    }
+    feature.update(planeA, planeB, planeC);
+  } catch (...) {
+    feature.moments.setLazyEvaluation(lazy);
+    if (outermost) {
+      updating.clear();
+    }
+    throw;
+  }
+  feature.moments.setLazyEvaluation(lazy);
+  updatedAt[index] = updateCount;
+  updating.pop_back();
+}
+
+/*!
+  Updates a moment feature of the database with plane coefficients, after the
+  features and the moments it depends on.
+
+  Nothing is computed if the feature is already updated by the database for
+  the same plane and the same update of its moment database (see
+  vpMomentDatabase::updateAll()). This allows to update only the features of
+  a visual servoing task, and only once per image.
+
+  \param type : the name of the feature, the one specified when using add
+  \param A : first plane coefficient for a plane equation of the following
+  type Ax+By+C=1/Z \param B : second plane coefficient for a plane equation of
+  the following type Ax+By+C=1/Z \param C : third plane coefficient for a
+  plane equation of the following type Ax+By+C=1/Z
+*/
+void vpFeatureMomentDatabase::update(const char *type, double A, double B, double C)
+{
+  std::map<const char *, unsigned int, vpFeatureMomentDatabase::cmp_str>::const_iterator it =
+      featureMomentsDataBase.find(type);
+  if (it == featureMomentsDataBase.end()) {
+    throw vpException(vpException::badValue, "Feature %s not found in the database", type);
+  }
+
+  startUpdate(featureList[it->second]->moments, A, B, C);
+  if (updatedAt[it->second] != updateCount) {
+    updateFeature(it->second);
+  }
 }
 
 /*!
@@ -76,26 +203,21 @@ vpFeatureMoment &vpFeatureMomentDatabase::get(const char *type, bool &found)
   type Ax+By+C=1/Z \param B : second plane coefficient for a plane equation of
   the following type Ax+By+C=1/Z \param C : third plane coefficient for a
   plane equation of the following type Ax+By+C=1/Z
+
+  Each feature is updated after the features and the moments it depends on.
 */
 void vpFeatureMomentDatabase::updateAll(double A, double B, double C)
 {
-  std::map<const char *, vpFeatureMoment *, vpFeatureMomentDatabase::cmp_str>::const_iterator itr;
-#ifdef VISP_HAVE_OPENMP
-  std::vector<vpFeatureMoment *> values;
-  values.reserve(featureMomentsDataBase.size());
-  for (itr = featureMomentsDataBase.begin(); itr != featureMomentsDataBase.end(); ++itr) {
-    values.push_back((*itr).second);
+  if (featureList.empty()) {
+    return;
   }
-#pragma omp parallel for shared(A, B, C)
-  for (int i = 0; i < (int)values.size(); i++) {
-    unsigned int i_ = static_cast<unsigned int>(i);
-    values[i_]->update(A, B, C);
-  }
-#else
-  for (itr = featureMomentsDataBase.begin(); itr != featureMomentsDataBase.end(); ++itr) {
-    (*itr).second->update(A, B, C);
+  startUpdate(featureList[0]->moments, A, B, C);
+  updateCount++;
+  for (unsigned int i = 0; i < featureList.size(); i++) {
+    if (updatedAt[i] != updateCount) {
+      updateFeature(i);
+    }
   }
-#endif
 }
 
 /*
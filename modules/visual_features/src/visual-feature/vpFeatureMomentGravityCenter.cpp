@@ -104,9 +104,9 @@ void vpFeatureMomentGravityCenter::compute_interaction()
   bool found_moment_gravity;
 
   const vpMomentCentered &momentCentered =
-      (static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered)));
+      (static_cast<const vpMomentCentered &>(getMoment(0, "vpMomentCentered", found_moment_centered)));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(1, "vpMomentGravityCenter", found_moment_gravity));
 
   const vpMomentObject &momentObject = moment->getObject();
 
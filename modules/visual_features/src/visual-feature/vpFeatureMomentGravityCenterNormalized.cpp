@@ -70,9 +70,9 @@ void vpFeatureMomentGravityCenterNormalized::compute_interaction()
   bool found_featuremoment_surfacenormalized;
 
   const vpMomentAreaNormalized &momentSurfaceNormalized = static_cast<const vpMomentAreaNormalized &>(
-      moments.get("vpMomentAreaNormalized", found_moment_surface_normalized));
+      getMoment(0, "vpMomentAreaNormalized", found_moment_surface_normalized));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(1, "vpMomentGravityCenter", found_moment_gravity));
   vpFeatureMomentGravityCenter &featureMomentGravity = (static_cast<vpFeatureMomentGravityCenter &>(
       featureMomentsDataBase->get("vpFeatureMomentGravityCenter", found_featuremoment_gravity)));
   vpFeatureMomentAreaNormalized featureMomentAreaNormalized = (static_cast<vpFeatureMomentAreaNormalized &>(
@@ -125,11 +125,11 @@ void vpFeatureMomentGravityCenterNormalized::compute_interaction()
   bool found_moment_centered;
 
   const vpMomentCentered &momentCentered =
-      static_cast<const vpMomentCentered &>(moments.get("vpMomentCentered", found_moment_centered));
+      static_cast<const vpMomentCentered &>(getMoment(2, "vpMomentCentered", found_moment_centered));
   const vpMomentGravityCenter &momentGravity =
-      static_cast<const vpMomentGravityCenter &>(moments.get("vpMomentGravityCenter", found_moment_gravity));
+      static_cast<const vpMomentGravityCenter &>(getMoment(1, "vpMomentGravityCenter", found_moment_gravity));
   const vpMomentAreaNormalized &momentSurfaceNormalized = static_cast<const vpMomentAreaNormalized &>(
-      moments.get("vpMomentAreaNormalized", found_moment_surface_normalized));
+      getMoment(0, "vpMomentAreaNormalized", found_moment_surface_normalized));
 
   if (!found_moment_surface_normalized)
     throw vpException(vpException::notInitialized, "vpMomentAreaNormalized not found");
@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the luminance feature and its normal equations.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testFeatureLuminance.cpp
+
+  \brief Test vpFeatureLuminance against the derivative filters of
+  vpImageFilter, and its normal equations against the interaction matrix.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/visual_features/vpFeatureLuminance.h>
+
+namespace
+{
+void texture(vpImage<unsigned char> &I, double du, double dv)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double u = j - du, v = i - dv;
+      I[i][j] = (unsigned char)(128 + 60 * sin(0.05 * u + 0.02 * v) + 50 * cos(0.07 * v - 0.01 * u) +
+                                10 * sin(0.3 * u) * cos(0.25 * v));
+    }
+  }
+}
+
+// Normal equations from the interaction matrix, on the pixels selected by
+// the subsampling step and the gradient threshold
+void referenceNormalEquations(vpFeatureLuminance &sL, vpFeatureLuminance &s, vpFeatureLuminance &s_star,
+                              const vpImage<unsigned char> &IL, unsigned int step, double threshold, vpMatrix &LtL,
+                              vpColVector &Lte)
+{
+  vpMatrix L;
+  vpColVector e;
+  sL.interaction(L);
+  s.error(s_star, e);
+  unsigned int bord = 10, width = IL.getWidth() - 2 * bord;
+  LtL.resize(6, 6);
+  Lte.resize(6);
+  for (unsigned int k = 0; k < L.getRows(); k++) {
+    unsigned int i = k / width, j = k % width;
+    if (i % step != 0 || j % step != 0) {
+      continue;
+    }
+    double Iu = vpImageFilter::derivativeFilterX(IL, i + bord, j + bord);
+    double Iv = vpImageFilter::derivativeFilterY(IL, i + bord, j + bord);
+    if (threshold > 0. && Iu * Iu + Iv * Iv < threshold * threshold) {
+      continue;
+    }
+    for (unsigned int r = 0; r < 6; r++) {
+      for (unsigned int c = 0; c < 6; c++) {
+        LtL[r][c] += L[k][r] * L[k][c];
+      }
+      Lte[r] += L[k][r] * e[k];
+    }
+  }
+}
+
+// Check the feature and its interaction matrix against the derivative
+// filters of vpImageFilter
+bool checkFeature(vpFeatureLuminance &s, const vpImage<unsigned char> &I, const vpCameraParameters &cam, double Z)
+{
+  vpMatrix L;
+  s.interaction(L);
+  vpColVector luminance = s.get_s();
+  unsigned int bord = 10, width = I.getWidth() - 2 * bord;
+  for (unsigned int k = 0; k < L.getRows(); k++) {
+    unsigned int i = k / width + bord, j = k % width + bord;
+    double Ix = cam.get_px() * vpImageFilter::derivativeFilterX(I, i, j);
+    double Iy = cam.get_py() * vpImageFilter::derivativeFilterY(I, i, j);
+    double x = 0, y = 0;
+    vpPixelMeterConversion::convertPoint(cam, j, i, x, y);
+    double Lref[6] = {Ix / Z, Iy / Z, -(x * Ix + y * Iy) / Z, -Ix * x * y - (1 + y * y) * Iy,
+                      (1 + x * x) * Ix + Iy * x * y, Iy * x - Ix * y};
+    if (luminance[k] != I[i][j]) {
+      std::cerr << "Bad luminance at pixel (" << i << ", " << j << ")" << std::endl;
+      return false;
+    }
+    for (unsigned int c = 0; c < 6; c++) {
+      if (std::fabs(L[k][c] - Lref[c]) > 1e-9 * (1. + std::fabs(Lref[c]))) {
+        std::cerr << "Bad interaction matrix at pixel (" << i << ", " << j << "): " << L[k][c] << " instead of "
+                  << Lref[c] << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool compare(const vpMatrix &LtL, const vpColVector &Lte, const vpMatrix &LtLref, const vpColVector &Lteref)
+{
+  double maxH = 0., maxB = 0.;
+  for (unsigned int r = 0; r < 6; r++) {
+    for (unsigned int c = 0; c < 6; c++) {
+      maxH = std::max(maxH, std::fabs(LtLref[r][c]));
+    }
+    maxB = std::max(maxB, std::fabs(Lteref[r]));
+  }
+  for (unsigned int r = 0; r < 6; r++) {
+    for (unsigned int c = 0; c < 6; c++) {
+      if (std::fabs(LtL[r][c] - LtLref[r][c]) > 1e-9 * maxH) {
+        std::cerr << "Bad LtL[" << r << "][" << c << "]: " << LtL[r][c] << " instead of " << LtLref[r][c] << std::endl;
+        return false;
+      }
+    }
+    if (std::fabs(Lte[r] - Lteref[r]) > 1e-9 * maxB) {
+      std::cerr << "Bad Lte[" << r << "]: " << Lte[r] << " instead of " << Lteref[r] << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    unsigned int height = 240, width = 320;
+    vpCameraParameters cam(400, 400, width / 2., height / 2.);
+    vpImage<unsigned char> I(height, width), Id(height, width);
+    texture(I, 3.2, -1.5);
+    texture(Id, 0., 0.);
+
+    vpFeatureLuminance sI, sId;
+    sI.init(height, width, 1.2);
+    sI.setCameraParameters(cam);
+    double t = vpTime::measureTimeMs();
+    sI.buildFrom(I);
+    t = vpTime::measureTimeMs() - t;
+    sId.init(height, width, 1.2);
+    sId.setCameraParameters(cam);
+    sId.buildFrom(Id);
+    std::cout << "Feature built in " << t << " ms" << std::endl;
+    if (!checkFeature(sI, I, cam, 1.2) || !checkFeature(sId, Id, cam, 1.2)) {
+      return EXIT_FAILURE;
+    }
+
+    vpMatrix LtL, LtLref;
+    vpColVector Lte, Lteref;
+    unsigned int steps[3] = {1, 1, 3};
+    double thresholds[3] = {0., 20., 20.};
+    for (unsigned int t = 0; t < 3; t++) {
+      for (unsigned int desired = 0; desired < 2; desired++) {
+        sI.setSubsampling(steps[t]);
+        sI.setGradientThreshold(thresholds[t]);
+        double t0 = vpTime::measureTimeMs();
+        sI.computeNormalEquations(sId, LtL, Lte, desired != 0);
+        double t1 = vpTime::measureTimeMs();
+        referenceNormalEquations(desired ? sId : sI, sI, sId, desired ? Id : I, steps[t], thresholds[t], LtLref,
+                                 Lteref);
+        double t2 = vpTime::measureTimeMs();
+        std::cout << "Step " << steps[t] << ", gradient threshold " << thresholds[t]
+                  << (desired ? ", desired" : ", current") << " interaction: normal equations in " << t1 - t0
+                  << " ms, from the interaction matrix in " << t2 - t1 << " ms" << std::endl;
+        if (!compare(LtL, Lte, LtLref, Lteref)) {
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // The Gauss-Newton step from the normal equations is mainly a
+    // translation in the direction of the motion of the texture
+    sI.setSubsampling(1);
+    sI.setGradientThreshold(0.);
+    sI.computeNormalEquations(sId, LtL, Lte, true);
+    vpColVector v = -1. * LtL.pseudoInverse() * Lte;
+    std::cout << "Gauss-Newton step: " << v.t() << std::endl;
+    double ratio = (v[0] / v[1]) / (3.2 / -1.5);
+    if (ratio < 0.8 || ratio > 1.25 || std::fabs(v[0]) < 5. * std::fabs(v[2])) {
+      std::cerr << "Bad Gauss-Newton step" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testFeatureLuminance is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,357 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the computation of the moments and moment features by their databases.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testFeatureMomentDatabase.cpp
+
+  \brief Test that the moments and the moment features computed by their
+  databases in the order of their dependencies, and only when they are
+  requested, are the same as when they are computed one by one.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMomentAlpha.h>
+#include <visp3/core/vpMomentArea.h>
+#include <visp3/core/vpMomentAreaNormalized.h>
+#include <visp3/core/vpMomentBasic.h>
+#include <visp3/core/vpMomentCInvariant.h>
+#include <visp3/core/vpMomentCentered.h>
+#include <visp3/core/vpMomentCommon.h>
+#include <visp3/core/vpMomentDatabase.h>
+#include <visp3/core/vpMomentGravityCenter.h>
+#include <visp3/core/vpMomentGravityCenterNormalized.h>
+#include <visp3/core/vpMomentObject.h>
+#include <visp3/core/vpPlane.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/visual_features/vpFeatureMomentAlpha.h>
+#include <visp3/visual_features/vpFeatureMomentArea.h>
+#include <visp3/visual_features/vpFeatureMomentAreaNormalized.h>
+#include <visp3/visual_features/vpFeatureMomentBasic.h>
+#include <visp3/visual_features/vpFeatureMomentCInvariant.h>
+#include <visp3/visual_features/vpFeatureMomentCentered.h>
+#include <visp3/visual_features/vpFeatureMomentDatabase.h>
+#include <visp3/visual_features/vpFeatureMomentGravityCenter.h>
+#include <visp3/visual_features/vpFeatureMomentGravityCenterNormalized.h>
+
+namespace
+{
+// Moment counting its computations, that reads another moment
+class vpMomentCounter : public vpMoment
+{
+public:
+  vpMomentCounter(const std::string &name, const std::string &dependency)
+    : vpMoment(), m_name(name), m_dependency(dependency), m_count(0)
+  {
+    values.resize(1);
+  }
+
+  void compute()
+  {
+    m_count++;
+    if (!m_dependency.empty()) {
+      bool found;
+      const vpMoment &dependency = getMoments().get(m_dependency.c_str(), found);
+      if (!found) {
+        throw vpException(vpException::notInitialized, "%s not found", m_dependency.c_str());
+      }
+      values[0] = dependency.get()[0];
+    }
+  }
+  unsigned int getCount() const { return m_count; }
+  const char *name() const { return m_name.c_str(); }
+
+private:
+  std::string m_name, m_dependency;
+  unsigned int m_count;
+};
+
+// Feature counting its updates, that reads the gravity center feature
+class vpFeatureMomentCounter : public vpFeatureMoment
+{
+public:
+  explicit vpFeatureMomentCounter(vpMomentDatabase &moments) : vpFeatureMoment(moments), m_count(0), m_xg(0.) {}
+
+  void compute_interaction()
+  {
+    m_count++;
+    bool found;
+    vpFeatureMoment &gravity = featureMomentsDataBase->get("vpFeatureMomentGravityCenter", found);
+    if (!found) {
+      throw vpException(vpException::notInitialized, "vpFeatureMomentGravityCenter not found");
+    }
+    m_xg = gravity.get_s()[0];
+  }
+  unsigned int getCount() const { return m_count; }
+  double getXg() const { return m_xg; }
+  const char *momentName() const { return "vpMomentCounter"; }
+  const char *name() const { return "vpFeatureMomentCounter"; }
+
+private:
+  unsigned int m_count;
+  double m_xg;
+};
+
+void polygon(const vpHomogeneousMatrix &cMo, vpMomentObject &obj)
+{
+  double x[5] = {0.2, 0.25, -0.1, -0.2, 0.05};
+  double y[5] = {-0.1, 0.15, 0.2, -0.05, -0.2};
+  std::vector<vpPoint> points;
+  for (unsigned int i = 0; i < 5; i++) {
+    vpPoint p(x[i], y[i], 0.0);
+    p.track(cMo);
+    points.push_back(p);
+  }
+  obj.setType(vpMomentObject::DENSE_POLYGON);
+  obj.fromVector(points);
+}
+
+void plane(const vpHomogeneousMatrix &cMo, double &A, double &B, double &C)
+{
+  vpPlane pl;
+  pl.setABCD(0, 0, 1.0, 0);
+  pl.changeFrame(cMo);
+  A = -pl.getA() / pl.getD();
+  B = -pl.getB() / pl.getD();
+  C = -pl.getC() / pl.getD();
+}
+
+bool equal(const vpArray2D<double> &M, const vpArray2D<double> &Mref)
+{
+  if (M.getRows() != Mref.getRows() || M.getCols() != Mref.getCols()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < M.getRows(); i++) {
+    for (unsigned int j = 0; j < M.getCols(); j++) {
+      if (std::fabs(M[i][j] - Mref[i][j]) > 1e-12 * (1. + std::fabs(Mref[i][j]))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool check(vpFeatureMomentDatabase &db, vpFeatureMomentDatabase &ref, const char *type)
+{
+  bool found, found_ref;
+  vpFeatureMoment &feature = db.get(type, found);
+  vpFeatureMoment &feature_ref = ref.get(type, found_ref);
+  if (!found || !found_ref) {
+    std::cerr << type << " not found" << std::endl;
+    return false;
+  }
+  // vpFeatureMomentBasic and vpFeatureMomentCentered hide the interaction
+  // matrix of all the moments
+  if (!equal(feature.get_s(), feature_ref.get_s()) ||
+      !equal(feature.vpFeatureMoment::interaction(), feature_ref.vpFeatureMoment::interaction())) {
+    std::cerr << "Bad " << type << std::endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    vpHomogeneousMatrix cdMo(0.0, 0.0, 1.0, 0., 0., 0.);
+    vpMomentObject dst(6), obj(6);
+    polygon(cdMo, dst);
+    double surface = vpMomentCommon::getSurface(dst);
+    std::vector<double> mu3 = vpMomentCommon::getMu3(dst);
+    double alpha = vpMomentCommon::getAlpha(dst);
+
+    // Reference moments and features, computed one by one in the order of
+    // their dependencies
+    vpMomentDatabase mdb_ref;
+    vpMomentBasic mb_ref;
+    vpMomentGravityCenter mg_ref;
+    vpMomentCentered mc_ref;
+    vpMomentGravityCenterNormalized mgn_ref;
+    vpMomentAreaNormalized man_ref(surface, 1.0);
+    vpMomentCInvariant mci_ref;
+    vpMomentAlpha malpha_ref(mu3, alpha);
+    vpMomentArea marea_ref;
+    vpMoment *moments_ref[8] = {&mb_ref, &mg_ref, &mc_ref, &malpha_ref, &mci_ref, &man_ref, &mgn_ref, &marea_ref};
+    for (unsigned int i = 0; i < 8; i++) {
+      moments_ref[i]->linkTo(mdb_ref);
+    }
+    vpFeatureMomentDatabase fdb_ref;
+    vpFeatureMomentBasic fb_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentGravityCenter fg_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentCentered fc_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentAreaNormalized fan_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentGravityCenterNormalized fgn_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentCInvariant fci_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentAlpha falpha_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMomentArea farea_ref(mdb_ref, 0., 0., 1.);
+    vpFeatureMoment *features_ref[8] = {&fb_ref,  &fg_ref,  &fc_ref,     &fan_ref,
+                                        &fgn_ref, &fci_ref, &falpha_ref, &farea_ref};
+    for (unsigned int i = 0; i < 8; i++) {
+      features_ref[i]->linkTo(fdb_ref);
+    }
+
+    // Moments and features registered in the reverse order of their
+    // dependencies, computed by their databases
+    vpMomentCommon mdb(surface, mu3, alpha, 1.0);
+    vpMomentCounter mcounter("vpMomentCounter", "vpMomentGravityCenter");
+    mcounter.linkTo(mdb);
+    vpFeatureMomentDatabase fdb;
+    vpFeatureMomentCounter fcounter(mdb);
+    vpFeatureMomentArea farea(mdb, 0., 0., 1.);
+    vpFeatureMomentAlpha falpha(mdb, 0., 0., 1.);
+    vpFeatureMomentCInvariant fci(mdb, 0., 0., 1.);
+    vpFeatureMomentGravityCenterNormalized fgn(mdb, 0., 0., 1.);
+    vpFeatureMomentAreaNormalized fan(mdb, 0., 0., 1.);
+    vpFeatureMomentCentered fc(mdb, 0., 0., 1.);
+    vpFeatureMomentGravityCenter fg(mdb, 0., 0., 1.);
+    vpFeatureMomentBasic fb(mdb, 0., 0., 1.);
+    vpFeatureMoment *features[9] = {&fcounter, &farea, &falpha, &fci, &fgn, &fan, &fc, &fg, &fb};
+    for (unsigned int i = 0; i < 9; i++) {
+      features[i]->linkTo(fdb);
+    }
+
+    for (unsigned int iter = 0; iter < 10; iter++) {
+      vpHomogeneousMatrix cMo(0.05 * iter - 0.2, 0.1 - 0.02 * iter, 0.8 + 0.05 * iter, vpMath::rad(2. * iter),
+                              vpMath::rad(-3. + iter), vpMath::rad(10. * iter));
+      polygon(cMo, obj);
+      double A, B, C;
+      plane(cMo, A, B, C);
+
+      mdb_ref.updateAll(obj);
+      for (unsigned int i = 0; i < 8; i++) {
+        moments_ref[i]->compute();
+      }
+      for (unsigned int i = 0; i < 8; i++) {
+        features_ref[i]->update(A, B, C);
+      }
+
+      // Only the requested features and what they depend on are computed
+      mdb.vpMomentDatabase::updateAll(obj);
+      unsigned int mcount = mcounter.getCount(), fcount = fcounter.getCount();
+      fdb.update("vpFeatureMomentCInvariant", A, B, C);
+      fdb.update("vpFeatureMomentAlpha", A, B, C);
+      fdb.update("vpFeatureMomentCInvariant", A, B, C);
+      if (!check(fdb, fdb_ref, "vpFeatureMomentCInvariant") || !check(fdb, fdb_ref, "vpFeatureMomentAlpha")) {
+        return EXIT_FAILURE;
+      }
+      if (mcounter.getCount() != mcount || fcounter.getCount() != fcount) {
+        std::cerr << "Moment or feature computed while not requested" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // The counter feature is updated once, after the gravity center
+      // feature, and its moment once, after the gravity center
+      fdb.update("vpFeatureMomentCounter", A, B, C);
+      fdb.updateAll(A, B, C);
+      for (unsigned int i = 0; i < 8; i++) {
+        if (!check(fdb, fdb_ref, features_ref[i]->name())) {
+          return EXIT_FAILURE;
+        }
+      }
+      if (mcounter.getCount() != mcount + 1 || fcounter.getCount() != fcount + 2) {
+        std::cerr << "Bad number of computations of the counters" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (mcounter.get()[0] != mg_ref.get()[0] || fcounter.getXg() != fg_ref.get_s()[0]) {
+        std::cerr << "Counters computed before their dependencies" << std::endl;
+        return EXIT_FAILURE;
+      }
+      mdb.computeAll();
+      if (mcounter.getCount() != mcount + 1) {
+        std::cerr << "Moment computed twice for the same object" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The moments computed by vpMomentCommon::updateAll()
+    mdb.updateAll(obj);
+    for (unsigned int i = 0; i < 8; i++) {
+      bool found;
+      if (!equal(vpColVector(mdb.get(moments_ref[i]->name(), found).get()), vpColVector(moments_ref[i]->get()))) {
+        std::cerr << "Bad " << moments_ref[i]->name() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The index handles give the moments found by their names
+    for (unsigned int i = 0; i < 8; i++) {
+      bool found, foundByIndex;
+      int index = -1;
+      const vpMoment &moment = mdb.get(moments_ref[i]->name(), found);
+      if (&mdb.get(moments_ref[i]->name(), index, foundByIndex) != &moment || !foundByIndex || index < 0 ||
+          &mdb.get(moments_ref[i]->name(), index, foundByIndex) != &moment || !foundByIndex) {
+        std::cerr << "Bad index of " << moments_ref[i]->name() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    int unknownIndex = -1;
+    bool unknownFound;
+    mdb.get("vpMomentUnknown", unknownIndex, unknownFound);
+    if (unknownFound || unknownIndex != -1) {
+      std::cerr << "Unknown moment found" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Cyclic dependencies are detected
+    vpMomentDatabase cyclic;
+    vpMomentCounter m1("vpMomentCounter1", "vpMomentCounter2"), m2("vpMomentCounter2", "vpMomentCounter1");
+    m1.linkTo(cyclic);
+    m2.linkTo(cyclic);
+    cyclic.updateAll(obj);
+    bool thrown = false;
+    try {
+      cyclic.computeAll();
+    } catch (const vpException &) {
+      thrown = true;
+    }
+    if (!thrown) {
+      std::cerr << "Cyclic dependency not detected" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    std::cout << "testFeatureMomentDatabase is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -266,6 +266,11 @@ public:
   // compute the interaction matrix related to the set of visual features
   vpMatrix computeInteractionMatrix();
 
+  /*!
+    Return true if the parts of the control law that do not change between
+    two iterations are cached, see setControlLawCaching().
+  */
+  bool getControlLawCaching() const { return controlLawCaching; }
   // Return the task dimension.
   unsigned int getDimension() const;
   /*!
@@ -361,6 +366,7 @@ error vector is updated after a call of computeError() or computeControlLaw().
                                                const double &rho1 = 0.3, const double &lambda_tune = 0.7) const;
 
   void setCameraDoF(const vpColVector &dof);
+  void setControlLawCaching(bool caching);
 
   /*!
     Set a variable which enables to compute the interaction matrix at each
@@ -538,6 +544,9 @@ protected:
     Compute the classic projetion operator and the large projection operator.
    */
   void computeProjectionOperators();
+  void computePrimaryTask();
+  void updateError();
+  void updateInteractionMatrix();
 
 public:
   //! Interaction matrix
@@ -674,6 +683,30 @@ protected:
   //! A diag matrix used to determine which are the degrees of freedom that
   //! are controlled in the camera frame
   vpMatrix cJc;
+
+  /*
+    Control law cache
+  */
+
+  //! true if the parts of the control law that do not change are cached.
+  bool controlLawCaching;
+  //! true if J1, J1p, WpW, I_WpW and WpWJ1p are computed from cacheL,
+  //! cache_cVa and cache_aJe.
+  bool cacheValid;
+  //! Interaction matrix, twist transformation matrix and Jacobian of the
+  //! cached task Jacobian.
+  vpMatrix cacheL;
+  vpMatrix cache_cVa;
+  vpMatrix cache_aJe;
+  //! Product \f${\bf W^+W} {J_1}^{+}\f$ giving the primary task when
+  //! \f$J_1\f$ is not full rank.
+  vpMatrix WpWJ1p;
+  //! Twist transformation matrix and Jacobian of the control law.
+  vpVelocityTwistMatrix cVa;
+  vpMatrix aJe;
+  //! Product \f${J_1}^\top {\bf e}\f$ used in the large projection
+  //! operator.
+  vpColVector J1te;
 };
 
 #endif
@@ -40,6 +40,8 @@
 
 #include <visp3/vs/vpServo.h>
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 // Exception
@@ -72,7 +74,8 @@ vpServo::vpServo()
     interactionMatrixType(DESIRED), inversionType(PSEUDO_INVERSE), cVe(), init_cVe(false), cVf(), init_cVf(false),
     fVe(), init_fVe(false), eJe(), init_eJe(false), fJe(), init_fJe(false), errorComputed(false),
     interactionMatrixComputed(false), dim_task(0), taskWasKilled(false), forceInteractionMatrixComputation(false),
-    WpW(), I_WpW(), P(), sv(), mu(4.), e1_initial(), iscJcIdentity(true), cJc(6, 6)
+    WpW(), I_WpW(), P(), sv(), mu(4.), e1_initial(), iscJcIdentity(true), cJc(6, 6), controlLawCaching(false),
+    cacheValid(false), cacheL(), cache_cVa(), cache_aJe(), WpWJ1p(), cVa(), aJe(), J1te()
 {
   cJc.eye();
 }
@@ -97,7 +100,8 @@ vpServo::vpServo(vpServoType servo_type)
     inversionType(PSEUDO_INVERSE), cVe(), init_cVe(false), cVf(), init_cVf(false), fVe(), init_fVe(false), eJe(),
     init_eJe(false), fJe(), init_fJe(false), errorComputed(false), interactionMatrixComputed(false), dim_task(0),
     taskWasKilled(false), forceInteractionMatrixComputation(false), WpW(), I_WpW(), P(), sv(), mu(4), e1_initial(),
-    iscJcIdentity(true), cJc(6, 6)
+    iscJcIdentity(true), cJc(6, 6), controlLawCaching(false), cacheValid(false), cacheL(), cache_cVa(), cache_aJe(),
+    WpWJ1p(), cVa(), aJe(), J1te()
 {
   cJc.eye();
 }
@@ -171,6 +175,8 @@ void vpServo::init()
   forceInteractionMatrixComputation = false;
 
   rankJ1 = 0;
+
+  cacheValid = false;
 }
 
 /*!
@@ -212,6 +218,7 @@ void vpServo::kill()
     featureList.clear();
     desiredFeatureList.clear();
     taskWasKilled = true;
+    cacheValid = false;
   }
 }
 
@@ -223,6 +230,7 @@ void vpServo::kill()
 void vpServo::setServo(const vpServoType &servo_type)
 {
   this->servoType = servo_type;
+  cacheValid = false;
 
   if ((servoType == EYEINHAND_CAMERA) || (servoType == EYEINHAND_L_cVe_eJe))
     signInteractionMatrix = 1;
@@ -289,6 +297,7 @@ int main()
 void vpServo::setCameraDoF(const vpColVector &dof)
 {
   if (dof.size() == 6) {
+    cacheValid = false;
     iscJcIdentity = true;
     for (unsigned int i = 0; i < 6; i++) {
       if (std::fabs(dof[i]) > std::numeric_limits<double>::epsilon()) {
@@ -499,6 +508,7 @@ void vpServo::addFeature(vpBasicFeature &s_cur, vpBasicFeature &s_star, unsigned
   featureList.push_back(&s_cur);
   desiredFeatureList.push_back(&s_star);
   featureSelectionList.push_back(select);
+  cacheValid = false;
 }
 
 /*!
@@ -554,6 +564,7 @@ void vpServo::addFeature(vpBasicFeature &s_cur, unsigned int select)
 
   desiredFeatureList.push_back(s_star);
   featureSelectionList.push_back(select);
+  cacheValid = false;
 }
 
 //! Return the task dimension.
@@ -576,6 +587,41 @@ void vpServo::setInteractionMatrixType(const vpServoIteractionMatrixType &intera
 {
   this->interactionMatrixType = interactionMatrix_type;
   this->inversionType = interactionMatrixInversion;
+  cacheValid = false;
+}
+
+/*!
+  Enable or disable the cache of the parts of the control law that do not
+  change between two iterations.
+
+  With the interaction matrix computed from the desired features (see
+  setInteractionMatrixType()), the task Jacobian \f$J_1\f$ only changes with
+  the velocity twist transformation matrix and the robot Jacobian. With the
+  cache enabled, computeControlLaw() compares them with the ones of the
+  previous iteration and only computes \f$J_1\f$, its pseudo inverse and the
+  projection operators when one of them changed. The other iterations only
+  compute the error and a few matrix-vector products in buffers allocated at
+  the first iteration, which is useful for high rate control loops with
+  many visual features, as with vpFeatureLuminance.
+
+  The cache is refreshed when the task is modified with addFeature(),
+  setServo(), setInteractionMatrixType() or setCameraDoF(). It costs a copy
+  of the interaction matrix, so that the cache is not useful when the
+  interaction matrix changes at each iteration, that is when it is computed
+  from the current features.
+
+  \param caching : true to enable the cache, false to compute all the control
+  law at each iteration (default).
+*/
+void vpServo::setControlLawCaching(bool caching)
+{
+  controlLawCaching = caching;
+  cacheValid = false;
+  if (!caching) {
+    cacheL.resize(0, 0);
+    cache_cVa.resize(0, 0);
+    cache_aJe.resize(0, 0);
+  }
 }
 
 static void computeInteractionMatrixFromList(const std::list<vpBasicFeature *> &featureList,
@@ -652,6 +698,16 @@ static void computeInteractionMatrixFromList(const std::list<vpBasicFeature *> &
   control law specified using setServo().
 */
 vpMatrix vpServo::computeInteractionMatrix()
+{
+  updateInteractionMatrix();
+  return L;
+}
+
+/*!
+  Compute the interaction matrix \f${\widehat {\bf L}}_e\f$ in \e L, without
+  copying it.
+*/
+void vpServo::updateInteractionMatrix()
 {
   try {
 
@@ -702,7 +758,6 @@ vpMatrix vpServo::computeInteractionMatrix()
   } catch (...) {
     throw;
   }
-  return L;
 }
 
 /*!
@@ -714,6 +769,15 @@ vpMatrix vpServo::computeInteractionMatrix()
 
 */
 vpColVector vpServo::computeError()
+{
+  updateError();
+  return error;
+}
+
+/*!
+  Compute the error \f$\bf e =(s - s^*)\f$ in \e error, without copying it.
+*/
+void vpServo::updateError()
 {
   if (featureList.empty()) {
     vpERROR_TRACE("feature list empty, cannot compute Ls");
@@ -826,7 +890,6 @@ vpColVector vpServo::computeError()
   } catch (...) {
     throw;
   }
-  return error;
 }
 
 bool vpServo::testInitialization()
@@ -937,9 +1000,6 @@ vpColVector vpServo::computeControlLaw()
   static int iteration = 0;
 
   try {
-    vpVelocityTwistMatrix cVa; // Twist transformation matrix
-    vpMatrix aJe;              // Jacobian
-
     if (iteration == 0) {
       if (testInitialization() == false) {
         vpERROR_TRACE("All the matrices are not correctly initialized");
@@ -952,93 +1012,14 @@ vpColVector vpServo::computeControlLaw()
       vpERROR_TRACE("All the matrices are not correctly updated");
     }
 
-    // test if all the required initialization have been done
-    switch (servoType) {
-    case NONE:
-      vpERROR_TRACE("No control law have been yet defined");
-      throw(vpServoException(vpServoException::servoError, "No control law have been yet defined"));
-      break;
-    case EYEINHAND_CAMERA:
-    case EYEINHAND_L_cVe_eJe:
-    case EYETOHAND_L_cVe_eJe:
-
-      cVa = cVe;
-      aJe = eJe;
-
-      init_cVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fVe_eJe:
-      cVa = cVf * fVe;
-      aJe = eJe;
-      init_fVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fJe:
-      cVa = cVf;
-      aJe = fJe;
-      init_fJe = false;
-      break;
-    }
-
-    computeInteractionMatrix();
-    computeError();
-
-    // compute  task Jacobian
-    if (iscJcIdentity)
-      J1 = L * cVa * aJe;
-    else
-      J1 = L * cJc * cVa * aJe;
-
-    // handle the eye-in-hand eye-to-hand case
-    J1 *= signInteractionMatrix;
-
-    // pseudo inverse of the task Jacobian
-    // and rank of the task Jacobian
-    // the image of J1 is also computed to allows the computation
-    // of the projection operator
-    vpMatrix imJ1t, imJ1;
-    bool imageComputed = false;
-
-    if (inversionType == PSEUDO_INVERSE) {
-      rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t);
-
-      imageComputed = true;
-    } else
-      J1p = J1.t();
-
-    if (rankJ1 == J1.getCols()) {
-      /* if no degrees of freedom remains (rank J1 = ndof)
-       WpW = I, multiply by WpW is useless
-    */
-      e1 = J1p * error; // primary task
-
-      WpW.eye(J1.getCols(), J1.getCols());
-    } else {
-      if (imageComputed != true) {
-        vpMatrix Jtmp;
-        // image of J1 is computed to allows the computation
-        // of the projection operator
-        rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t);
-      }
-      WpW = imJ1t * imJ1t.t();
+    computePrimaryTask();
 
-#ifdef DEBUG
-      std::cout << "rank J1: " << rankJ1 << std::endl;
-      imJ1t.print(std::cout, 10, "imJ1t");
-      imJ1.print(std::cout, 10, "imJ1");
-
-      WpW.print(std::cout, 10, "WpW");
-      J1.print(std::cout, 10, "J1");
-      J1p.print(std::cout, 10, "J1p");
-#endif
-      e1 = WpW * J1p * error;
+    // e = -lambda e1
+    double gain = lambda(e1);
+    e.resize(e1.getRows(), false);
+    for (unsigned int i = 0; i < e1.getRows(); i++) {
+      e[i] = -gain * e1[i];
     }
-    e = -lambda(e1) * e1;
-
-    vpMatrix I;
-
-    I.eye(J1.getCols(), J1.getCols());
 
     computeProjectionOperators();
 
@@ -1090,9 +1071,6 @@ vpColVector vpServo::computeControlLaw(double t)
   // static vpColVector e1_initial;
 
   try {
-    vpVelocityTwistMatrix cVa; // Twist transformation matrix
-    vpMatrix aJe;              // Jacobian
-
     if (iteration == 0) {
       if (testInitialization() == false) {
         vpERROR_TRACE("All the matrices are not correctly initialized");
@@ -1105,85 +1083,7 @@ vpColVector vpServo::computeControlLaw(double t)
       vpERROR_TRACE("All the matrices are not correctly updated");
     }
 
-    // test if all the required initialization have been done
-    switch (servoType) {
-    case NONE:
-      vpERROR_TRACE("No control law have been yet defined");
-      throw(vpServoException(vpServoException::servoError, "No control law have been yet defined"));
-      break;
-    case EYEINHAND_CAMERA:
-    case EYEINHAND_L_cVe_eJe:
-    case EYETOHAND_L_cVe_eJe:
-
-      cVa = cVe;
-      aJe = eJe;
-
-      init_cVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fVe_eJe:
-      cVa = cVf * fVe;
-      aJe = eJe;
-      init_fVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fJe:
-      cVa = cVf;
-      aJe = fJe;
-      init_fJe = false;
-      break;
-    }
-
-    computeInteractionMatrix();
-    computeError();
-
-    // compute  task Jacobian
-    J1 = L * cVa * aJe;
-
-    // handle the eye-in-hand eye-to-hand case
-    J1 *= signInteractionMatrix;
-
-    // pseudo inverse of the task Jacobian
-    // and rank of the task Jacobian
-    // the image of J1 is also computed to allows the computation
-    // of the projection operator
-    vpMatrix imJ1t, imJ1;
-    bool imageComputed = false;
-
-    if (inversionType == PSEUDO_INVERSE) {
-      rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t);
-
-      imageComputed = true;
-    } else
-      J1p = J1.t();
-
-    if (rankJ1 == J1.getCols()) {
-      /* if no degrees of freedom remains (rank J1 = ndof)
-       WpW = I, multiply by WpW is useless
-    */
-      e1 = J1p * error; // primary task
-
-      WpW.eye(J1.getCols(), J1.getCols());
-    } else {
-      if (imageComputed != true) {
-        vpMatrix Jtmp;
-        // image of J1 is computed to allows the computation
-        // of the projection operator
-        rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t);
-      }
-      WpW = imJ1t * imJ1t.t();
-
-#ifdef DEBUG
-      std::cout << "rank J1 " << rankJ1 << std::endl;
-      std::cout << "imJ1t" << std::endl << imJ1t;
-      std::cout << "imJ1" << std::endl << imJ1;
-
-      std::cout << "WpW" << std::endl << WpW;
-      std::cout << "J1" << std::endl << J1;
-      std::cout << "J1p" << std::endl << J1p;
-#endif
-      e1 = WpW * J1p * error;
-    }
+    computePrimaryTask();
 
     // memorize the initial e1 value if the function is called the first time
     // or if the time given as parameter is equal to 0.
@@ -1195,11 +1095,12 @@ vpColVector vpServo::computeControlLaw(double t)
     if (e1_initial.getRows() != e1.getRows())
       e1_initial = e1;
 
-    e = -lambda(e1) * e1 + lambda(e1) * e1_initial * exp(-mu * t);
-
-    vpMatrix I;
-
-    I.eye(J1.getCols(), J1.getCols());
+    double gain = lambda(e1);
+    double decay = exp(-mu * t);
+    e.resize(e1.getRows(), false);
+    for (unsigned int i = 0; i < e1.getRows(); i++) {
+      e[i] = -gain * e1[i] + gain * e1_initial[i] * decay;
+    }
 
     computeProjectionOperators();
   } catch (...) {
@@ -1250,9 +1151,6 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
   static int iteration = 0;
 
   try {
-    vpVelocityTwistMatrix cVa; // Twist transformation matrix
-    vpMatrix aJe;              // Jacobian
-
     if (iteration == 0) {
       if (testInitialization() == false) {
         vpERROR_TRACE("All the matrices are not correctly initialized");
@@ -1265,40 +1163,99 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
       vpERROR_TRACE("All the matrices are not correctly updated");
     }
 
-    // test if all the required initialization have been done
-    switch (servoType) {
-    case NONE:
-      vpERROR_TRACE("No control law have been yet defined");
-      throw(vpServoException(vpServoException::servoError, "No control law have been yet defined"));
-      break;
-    case EYEINHAND_CAMERA:
-    case EYEINHAND_L_cVe_eJe:
-    case EYETOHAND_L_cVe_eJe:
+    computePrimaryTask();
 
-      cVa = cVe;
-      aJe = eJe;
+    // memorize the initial e1 value if the function is called the first time
+    // or if the time given as parameter is equal to 0.
+    if (iteration == 0 || std::fabs(t) < std::numeric_limits<double>::epsilon()) {
+      e1_initial = e1;
+    }
+    // Security check. If size of e1_initial and e1 differ, that means that
+    // e1_initial was not set
+    if (e1_initial.getRows() != e1.getRows())
+      e1_initial = e1;
 
-      init_cVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fVe_eJe:
-      cVa = cVf * fVe;
-      aJe = eJe;
-      init_fVe = false;
-      init_eJe = false;
-      break;
-    case EYETOHAND_L_cVf_fJe:
-      cVa = cVf;
-      aJe = fJe;
-      init_fJe = false;
-      break;
+    if (e_dot_init.getRows() != e1.getRows()) {
+      throw(vpException(vpException::dimensionError,
+                        "Cannot compute the control law with a (%d) initial task derivative", e_dot_init.getRows()));
     }
+    double gain = lambda(e1);
+    double decay = exp(-mu * t);
+    e.resize(e1.getRows(), false);
+    for (unsigned int i = 0; i < e1.getRows(); i++) {
+      e[i] = -gain * e1[i] + (e_dot_init[i] + gain * e1_initial[i]) * decay;
+    }
+
+    computeProjectionOperators();
+  } catch (...) {
+    throw;
+  }
 
-    computeInteractionMatrix();
-    computeError();
+  iteration++;
+  return e;
+}
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
+{
+bool sameArray(const vpArray2D<double> &A, const vpArray2D<double> &B)
+{
+  return A.getRows() == B.getRows() && A.getCols() == B.getCols() && std::equal(A.data, A.data + A.size(), B.data);
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Compute the interaction matrix, the error and the primary task
+  \f${\bf e}_1 = {\bf W^+W} {J_1}^{+} {\bf e}\f$ of the control law.
+
+  The task Jacobian \f$J_1\f$, its pseudo inverse and the projection operator
+  \f$\bf I-W^+W\f$ are only computed when the cache is disabled or when the
+  interaction matrix, the twist transformation matrix or the robot Jacobian
+  changed since the previous iteration (see setControlLawCaching()).
+*/
+void vpServo::computePrimaryTask()
+{
+  switch (servoType) {
+  case NONE:
+    vpERROR_TRACE("No control law have been yet defined");
+    throw(vpServoException(vpServoException::servoError, "No control law have been yet defined"));
+    break;
+  case EYEINHAND_CAMERA:
+  case EYEINHAND_L_cVe_eJe:
+  case EYETOHAND_L_cVe_eJe:
+
+    cVa = cVe;
+    aJe = eJe;
+
+    init_cVe = false;
+    init_eJe = false;
+    break;
+  case EYETOHAND_L_cVf_fVe_eJe:
+    cVa = cVf * fVe;
+    aJe = eJe;
+    init_fVe = false;
+    init_eJe = false;
+    break;
+  case EYETOHAND_L_cVf_fJe:
+    cVa = cVf;
+    aJe = fJe;
+    init_fJe = false;
+    break;
+  }
+
+  updateInteractionMatrix();
+  updateError();
+
+  bool refresh = !controlLawCaching || !cacheValid || !sameArray(L, cacheL) || !sameArray(cVa, cache_cVa) ||
+                 !sameArray(aJe, cache_aJe);
+
+  if (refresh) {
     // compute  task Jacobian
-    J1 = L * cVa * aJe;
+    if (iscJcIdentity)
+      J1 = L * cVa * aJe;
+    else
+      J1 = L * cJc * cVa * aJe;
 
     // handle the eye-in-hand eye-to-hand case
     J1 *= signInteractionMatrix;
@@ -1317,13 +1274,12 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
     } else
       J1p = J1.t();
 
-    if (rankJ1 == J1.getCols()) {
+    unsigned int n = J1.getCols();
+    if (rankJ1 == n) {
       /* if no degrees of freedom remains (rank J1 = ndof)
        WpW = I, multiply by WpW is useless
     */
-      e1 = J1p * error; // primary task
-
-      WpW.eye(J1.getCols(), J1.getCols());
+      WpW.eye(n, n);
     } else {
       if (imageComputed != true) {
         vpMatrix Jtmp;
@@ -1332,55 +1288,47 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
         rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t);
       }
       WpW = imJ1t * imJ1t.t();
+      WpWJ1p = WpW * J1p;
 
 #ifdef DEBUG
-      std::cout << "rank J1 " << rankJ1 << std::endl;
-      std::cout << "imJ1t" << std::endl << imJ1t;
-      std::cout << "imJ1" << std::endl << imJ1;
+      std::cout << "rank J1: " << rankJ1 << std::endl;
+      imJ1t.print(std::cout, 10, "imJ1t");
+      imJ1.print(std::cout, 10, "imJ1");
 
-      std::cout << "WpW" << std::endl << WpW;
-      std::cout << "J1" << std::endl << J1;
-      std::cout << "J1p" << std::endl << J1p;
+      WpW.print(std::cout, 10, "WpW");
+      J1.print(std::cout, 10, "J1");
+      J1p.print(std::cout, 10, "J1p");
 #endif
-      e1 = WpW * J1p * error;
     }
 
-    // memorize the initial e1 value if the function is called the first time
-    // or if the time given as parameter is equal to 0.
-    if (iteration == 0 || std::fabs(t) < std::numeric_limits<double>::epsilon()) {
-      e1_initial = e1;
+    // Classical projection operator
+    I_WpW.resize(n, n, false);
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        I_WpW[i][j] = (i == j ? 1. : 0.) - WpW[i][j];
+      }
     }
-    // Security check. If size of e1_initial and e1 differ, that means that
-    // e1_initial was not set
-    if (e1_initial.getRows() != e1.getRows())
-      e1_initial = e1;
 
-    e = -lambda(e1) * e1 + (e_dot_init + lambda(e1) * e1_initial) * exp(-mu * t);
-
-    vpMatrix I;
-
-    I.eye(J1.getCols(), J1.getCols());
-
-    computeProjectionOperators();
-  } catch (...) {
-    throw;
+    if (controlLawCaching) {
+      cacheL = L;
+      cache_cVa = cVa;
+      cache_aJe = aJe;
+      cacheValid = true;
+    }
   }
 
-  iteration++;
-  return e;
+  // primary task
+  if (rankJ1 == J1.getCols())
+    vpMatrix::multMatrixVector(J1p, error, e1);
+  else
+    vpMatrix::multMatrixVector(WpWJ1p, error, e1);
 }
 
 void vpServo::computeProjectionOperators()
 {
   // Initialization
   unsigned int n = J1.getCols();
-  P.resize(n, n);
-
-  vpMatrix I;
-  I.eye(n);
-
-  // Compute classical projection operator
-  I_WpW = (I - WpW);
+  P.resize(n, n, false);
 
   // Compute gain depending by the task error to ensure a smooth change
   // between the operators.
@@ -1396,19 +1344,25 @@ void vpServo::computeProjectionOperators()
   else
     sig = 0.0;
 
-  vpMatrix J1t = J1.transpose();
-
-  double pp = (error.t() * (J1 * J1t) * error);
-
-  vpMatrix ee_t(n, n);
-  ee_t = error * error.t();
-
-  vpMatrix P_norm_e(n, n);
-  P_norm_e = I - (1.0 / pp) * J1t * ee_t * J1;
-
-  P = sig * P_norm_e + (1 - sig) * I_WpW;
+  // With w = J1^T e, e^T J1 J1^T e = w^T w and J1^T e e^T J1 = w w^T, which
+  // avoids the e e^T matrix of the size of the task
+  J1te.resize(n);
+  for (unsigned int i = 0; i < J1.getRows(); i++) {
+    const double *J1i = J1[i];
+    for (unsigned int j = 0; j < n; j++) {
+      J1te[j] += J1i[j] * error[i];
+    }
+  }
+  double pp = J1te.sumSquare();
+  // P_norm_e is the identity when J1^T e is null
+  double inv_pp = pp > std::numeric_limits<double>::epsilon() ? 1.0 / pp : 0.0;
 
-  return;
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      double P_norm_e = (i == j ? 1. : 0.) - inv_pp * J1te[i] * J1te[j];
+      P[i][j] = sig * P_norm_e + (1 - sig) * I_WpW[i][j];
+    }
+  }
 }
 
 /*!
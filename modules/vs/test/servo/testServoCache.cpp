@@ -0,0 +1,184 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the cache of the control law of vpServo.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testServoCache.cpp
+
+  \brief Test that the control law computed with the cache of vpServo is the
+  same as without cache, for full rank and rank deficient tasks.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/visual_features/vpFeatureBuilder.h>
+#include <visp3/visual_features/vpFeaturePoint.h>
+#include <visp3/vs/vpServo.h>
+
+namespace
+{
+bool equal(const vpArray2D<double> &A, const vpArray2D<double> &B, double threshold)
+{
+  if (A.getRows() != B.getRows() || A.getCols() != B.getCols()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < A.getRows(); i++) {
+    for (unsigned int j = 0; j < A.getCols(); j++) {
+      if (std::fabs(A[i][j] - B[i][j]) > threshold) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Large projection operator computed with the e e^T matrix
+vpMatrix largeProjectionOperator(const vpServo &task)
+{
+  vpMatrix J1 = task.getTaskJacobian();
+  vpColVector e = task.getError();
+  unsigned int n = J1.getCols();
+  vpMatrix I;
+  I.eye(n);
+  double norm_e = e.euclideanNorm();
+  double sig = 0.;
+  if (norm_e > 0.7)
+    sig = 1.;
+  else if (norm_e >= 0.1)
+    sig = 1. / (1. + exp(-12. * ((norm_e - 0.1) / 0.6) + 6.));
+  double pp = e.t() * (J1 * J1.t()) * e;
+  vpMatrix P_norm_e = I - (1. / pp) * J1.t() * (e * e.t()) * J1;
+  return sig * P_norm_e + (1 - sig) * task.getI_WpW();
+}
+
+// Servo a camera with point features, with and without cache. The robot
+// Jacobian changes with the iterations when varyingJacobian is true.
+bool servo(unsigned int nbPoints, bool varyingJacobian)
+{
+  std::vector<vpPoint> points;
+  points.push_back(vpPoint(-0.1, -0.1, 0));
+  points.push_back(vpPoint(0.1, -0.1, 0));
+  points.push_back(vpPoint(0.1, 0.1, 0));
+  points.push_back(vpPoint(-0.1, 0.1, 0));
+  points.resize(nbPoints);
+
+  vpHomogeneousMatrix cdMo(0, 0, 0.75, 0, 0, 0);
+  vpHomogeneousMatrix cMo(0.15, -0.1, 1., vpMath::rad(10), vpMath::rad(-10), vpMath::rad(50));
+
+  std::vector<vpFeaturePoint> p(nbPoints), pd(nbPoints);
+  vpServo task[2];
+  for (unsigned int t = 0; t < 2; t++) {
+    task[t].setServo(varyingJacobian ? vpServo::EYEINHAND_L_cVe_eJe : vpServo::EYEINHAND_CAMERA);
+    task[t].setInteractionMatrixType(vpServo::DESIRED);
+    task[t].setLambda(0.5);
+    task[t].setControlLawCaching(t == 1);
+    if (varyingJacobian) {
+      task[t].set_cVe(vpVelocityTwistMatrix());
+    }
+  }
+  for (unsigned int i = 0; i < nbPoints; i++) {
+    points[i].track(cdMo);
+    vpFeatureBuilder::create(pd[i], points[i]);
+    for (unsigned int t = 0; t < 2; t++) {
+      task[t].addFeature(p[i], pd[i]);
+    }
+  }
+
+  double time[2] = {0., 0.};
+  for (unsigned int iter = 0; iter < 100; iter++) {
+    for (unsigned int i = 0; i < nbPoints; i++) {
+      points[i].track(cMo);
+      vpFeatureBuilder::create(p[i], points[i]);
+    }
+    vpMatrix eJe;
+    eJe.eye(6);
+    if (varyingJacobian) {
+      eJe[0][0] = eJe[1][1] = 1. + 0.1 * (iter % 3);
+    }
+
+    vpColVector v[2];
+    for (unsigned int t = 0; t < 2; t++) {
+      if (varyingJacobian) {
+        task[t].set_eJe(eJe);
+      }
+      double t0 = vpTime::measureTimeMs();
+      v[t] = task[t].computeControlLaw();
+      time[t] += vpTime::measureTimeMs() - t0;
+    }
+    if (!equal(v[0], v[1], 1e-12)) {
+      std::cerr << "Different velocities at iteration " << iter << ":\n" << v[0].t() << "\n" << v[1].t() << std::endl;
+      return false;
+    }
+    if (!equal(task[0].getLargeP(), task[1].getLargeP(), 1e-12) || !equal(task[0].getWpW(), task[1].getWpW(), 1e-12)) {
+      std::cerr << "Different projection operators at iteration " << iter << std::endl;
+      return false;
+    }
+    if (!equal(task[1].getLargeP(), largeProjectionOperator(task[1]), 1e-9)) {
+      std::cerr << "Bad large projection operator at iteration " << iter << std::endl;
+      return false;
+    }
+    cMo = vpExponentialMap::direct(v[0], 0.04).inverse() * cMo;
+  }
+
+  std::cout << nbPoints << " points" << (varyingJacobian ? ", varying Jacobian" : "") << ", rank "
+            << task[1].getTaskRank() << ": " << time[0] << " ms without cache, " << time[1] << " ms with cache"
+            << std::endl;
+
+  for (unsigned int t = 0; t < 2; t++) {
+    task[t].kill();
+  }
+  return true;
+}
+}
+
+int main()
+{
+  try {
+    if (!servo(4, false) || !servo(2, false) || !servo(4, true) || !servo(2, true)) {
+      return EXIT_FAILURE;
+    }
+    std::cout << "testServoCache is ok" << std::endl;
+    return EXIT_SUCCESS;
+  } catch (const vpException &e) {
+    std::cerr << "Catch an exception: " << e.getMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+}